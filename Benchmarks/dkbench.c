@@ -0,0 +1,1245 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+// runs the benchmarks of DrawKit's portable engines: the geometry, the BSP index that DKBSPObjectStorage files objects under, and the SVG
+// stream that drawings are written out through. Those of its Cocoa subsystems - the storage classes themselves, archiving, undo and the
+// rest - are run by TestDKBenchmarks in the framework's tests, through the same suite, so their results and baselines have the same form.
+
+#include "DKBSPIndex.h"
+#include "DKBenchmark.h"
+#include "DKPathMeasure.h"
+#include "DKPathStroke.h"
+#include "DKPathWarp.h"
+#include "DKSVGStream.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SEED 0x5EEDD4A3ull
+#define BENCH_CANVAS 10000.0
+
+// what DKBSPDirectObjectStorage keeps at each leaf of its index: the objects that touch it
+
+typedef struct {
+	size_t* items;
+	size_t count;
+	size_t capacity;
+} BenchLeaf;
+
+typedef struct {
+	DKBenchmarkRect* rects;
+	DKBenchmarkRect* queryRects;
+	const DKBenchmarkRect* query;
+	DKPathPoint* points;
+	DKPathPoint* warpedPoints;
+	size_t count;
+	size_t queryCount;
+	size_t pointCount;
+	DKBSPIndex index;
+	BenchLeaf* leaves;
+	uint32_t* stamps;
+	uint32_t stamp;
+	size_t item;
+	DKPathBuffer path;
+	DKPathBuffer result;
+	DKPathMeasure measure;
+	DKPathStrokeStyle style;
+	DKPathOffsetOptions offsetOptions;
+	DKPathWarp warp;
+	DKPathPoint envelope[4];
+	DKPathPoint origin;
+	double width;
+	double height;
+	double tolerance;
+	double offset;
+	double pattern[4];
+	size_t patternCount;
+	size_t frames;
+	size_t hits;
+	size_t found;
+	uint64_t bytes;
+} BenchContext;
+
+static void usage(const char* program)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  --filter TEXT      run only benchmarks whose name or variant contains TEXT\n"
+		"  --scale N          multiply the sizes of the benchmarks by N (default 1)\n"
+		"  --samples N        timed runs of each benchmark (default 15)\n"
+		"  --time-limit S     stop sampling a benchmark after S seconds (default 10)\n"
+		"  --baseline FILE    compare with the results in FILE\n"
+		"  --output FILE      write the results to FILE, for use as a baseline\n"
+		"  --tolerance F      how much slower than the baseline, as a fraction, is a regression (default 0.1)\n",
+		program);
+}
+
+#pragma mark - shapes
+
+// a serpentine of <count> curves, rows of them running back and forth across the canvas like a long wire
+
+static void benchMakeWire(DKPathBuffer* path, size_t count)
+{
+	const size_t perRow = 500;
+	const double step = BENCH_CANVAS / perRow;
+	size_t i;
+
+	DKPathBufferClear(path);
+	DKPathBufferMoveTo(path, (DKPathPoint){ 0, 0 });
+
+	for (i = 0; i < count; ++i) {
+		size_t row = i / perRow, column = i % perRow;
+		double dir = (row & 1) ? -1.0 : 1.0;
+		double x0 = (row & 1) ? BENCH_CANVAS - column * step : column * step;
+		double y = row * 40.0;
+		double bulge = (i & 1) ? 8.0 : -8.0;
+
+		if (column == perRow - 1) {
+			// turn round to the next row
+			DKPathBufferCurveTo(path, (DKPathPoint){ x0 + dir * step, y }, (DKPathPoint){ x0 + dir * step, y + 40.0 }, (DKPathPoint){ x0, y + 40.0 });
+		} else
+			DKPathBufferCurveTo(path, (DKPathPoint){ x0 + dir * step / 3, y + bulge }, (DKPathPoint){ x0 + dir * step * 2 / 3, y + bulge },
+				(DKPathPoint){ x0 + dir * step, y });
+	}
+}
+
+// <count> circles round the middle of the canvas, out to its edges, each of four cubic arcs. Arcs this long bend well away from the
+// cubics their warped points make
+
+static void benchMakeRings(DKPathBuffer* path, size_t count)
+{
+	const double k = 4.0 / 3.0 * (M_SQRT2 - 1.0);
+	const double centre = BENCH_CANVAS / 2;
+	size_t i;
+	int q;
+
+	DKPathBufferClear(path);
+
+	for (i = 0; i < count; ++i) {
+		double r = centre * (i + 1) / count;
+
+		DKPathBufferMoveTo(path, (DKPathPoint){ centre + r, centre });
+
+		for (q = 0; q < 4; ++q) {
+			double c0 = cos(q * M_PI_2), s0 = sin(q * M_PI_2), c1 = cos((q + 1) * M_PI_2), s1 = sin((q + 1) * M_PI_2);
+
+			DKPathBufferCurveTo(path, (DKPathPoint){ centre + r * (c0 - k * s0), centre + r * (s0 + k * c0) },
+				(DKPathPoint){ centre + r * (c1 + k * s1), centre + r * (s1 - k * c1) }, (DKPathPoint){ centre + r * c1, centre + r * s1 });
+		}
+
+		DKPathBufferClose(path);
+	}
+}
+
+// the bounds of the path's points, as DKDistortionTransform takes the rect it warps from
+
+static void benchPathBounds(const DKPathBuffer* path, DKPathPoint* origin, double* width, double* height)
+{
+	DKPathPoint least = path->points[0], most = path->points[0];
+	size_t i;
+
+	for (i = 1; i < path->pointCount; ++i) {
+		least.x = fmin(least.x, path->points[i].x);
+		least.y = fmin(least.y, path->points[i].y);
+		most.x = fmax(most.x, path->points[i].x);
+		most.y = fmax(most.y, path->points[i].y);
+	}
+
+	*origin = least;
+	*width = most.x - least.x;
+	*height = most.y - least.y;
+}
+
+// a circle of <count> arcs, each a cubic
+
+static void benchMakeCircle(DKPathBuffer* path, size_t count, double radius)
+{
+	double sweep = 2.0 * M_PI / count;
+	double k = 4.0 / 3.0 * tan(sweep / 4.0) * radius;
+	size_t i;
+
+	DKPathBufferClear(path);
+	DKPathBufferMoveTo(path, (DKPathPoint){ radius, 0 });
+
+	for (i = 0; i < count; ++i) {
+		double a0 = i * sweep, a1 = (i + 1) * sweep;
+
+		DKPathBufferCurveTo(path, (DKPathPoint){ radius * cos(a0) - k * sin(a0), radius * sin(a0) + k * cos(a0) },
+			(DKPathPoint){ radius * cos(a1) + k * sin(a1), radius * sin(a1) - k * cos(a1) }, (DKPathPoint){ radius * cos(a1), radius * sin(a1) });
+	}
+
+	DKPathBufferClose(path);
+}
+
+// <count> smooth closed blobs in a grid, each a circle whose radius rises and falls in 3 to 6 lobes, of cubics running anticlockwise. Many
+// lobes bend more tightly than the offsets they are given, at their tips or between them, so offsetting them either way leaves loops to
+// remove
+
+#define BENCH_BLOB_ARCS 32
+
+static void benchMakeBlobs(DKPathBuffer* path, size_t count, uint64_t seed)
+{
+	const double cell = 400, radius = 100, sweep = 2.0 * M_PI / BENCH_BLOB_ARCS;
+	const size_t perRow = (size_t)(BENCH_CANVAS / cell);
+	uint64_t state = seed;
+	size_t i;
+	int s;
+
+	DKPathBufferClear(path);
+
+	for (i = 0; i < count; ++i) {
+		double cx = (i % perRow + 0.5) * cell, cy = (i / perRow + 0.5) * cell;
+		double lobes = 3 + DKBenchmarkRandom(&state) % 4, depth = 0.1 + DKBenchmarkRandomUnit(&state) * 0.15;
+		double phase = DKBenchmarkRandomUnit(&state) * 2.0 * M_PI;
+		DKPathPoint p[BENCH_BLOB_ARCS + 1], handle[BENCH_BLOB_ARCS + 1];
+
+		// points on the curve, and the handles that give each arc the curve's tangent at its ends
+
+		for (s = 0; s <= BENCH_BLOB_ARCS; ++s) {
+			double a = s * sweep, r = radius * (1 + depth * sin(lobes * a + phase)), dr = radius * depth * lobes * cos(lobes * a + phase);
+
+			p[s] = (DKPathPoint){ cx + r * cos(a), cy + r * sin(a) };
+			handle[s] = (DKPathPoint){ (dr * cos(a) - r * sin(a)) * sweep / 3, (dr * sin(a) + r * cos(a)) * sweep / 3 };
+		}
+
+		DKPathBufferMoveTo(path, p[0]);
+
+		for (s = 0; s < BENCH_BLOB_ARCS; ++s)
+			DKPathBufferCurveTo(path, (DKPathPoint){ p[s].x + handle[s].x, p[s].y + handle[s].y },
+				(DKPathPoint){ p[s + 1].x - handle[s + 1].x, p[s + 1].y - handle[s + 1].y }, p[s + 1]);
+
+		DKPathBufferClose(path);
+	}
+}
+
+// the greatest difference between the distance from the origin of the path's points, sampled along its curves, and <radius>
+
+static double benchMaxRadialError(const DKPathBuffer* path, double radius)
+{
+	DKPathPoint current = { 0, 0 }, start = { 0, 0 };
+	const DKPathPoint* p = path->points;
+	double error = 0;
+	size_t i;
+
+	for (i = 0; i < path->verbCount; ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			current = start = *p++;
+			break;
+
+		case kDKPathLineTo:
+			current = *p++;
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, p[0], p[1], p[2] };
+			int s;
+
+			for (s = 1; s <= 8; ++s) {
+				DKPathPoint q = DKCubicPointAt(c, s / 8.0);
+
+				error = fmax(error, fabs(hypot(q.x, q.y) - radius));
+			}
+
+			current = p[2];
+			p += 3;
+			break;
+		}
+
+		case kDKPathClose:
+			current = start;
+			break;
+		}
+
+		error = fmax(error, fabs(hypot(current.x, current.y) - radius));
+	}
+
+	return error;
+}
+
+// calls <function> for each line of a path, with each curve cut into <steps> lines and each closed subpath closed by a line
+
+typedef void (*BenchLineFunction)(DKPathPoint a, DKPathPoint b, void* info);
+
+static void benchFlattenPath(const DKPathBuffer* path, size_t steps, BenchLineFunction function, void* info)
+{
+	DKPathPoint current = { 0, 0 }, start = { 0, 0 };
+	const DKPathPoint* p = path->points;
+	size_t i, s;
+
+	for (i = 0; i < path->verbCount; p += DKPathVerbPointCount(path->verbs[i]), ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			current = start = p[0];
+			break;
+
+		case kDKPathLineTo:
+			function(current, p[0], info);
+			current = p[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, p[0], p[1], p[2] };
+
+			for (s = 1; s <= steps; ++s) {
+				DKPathPoint q = s == steps ? c[3] : DKCubicPointAt(c, (double)s / steps);
+
+				function(current, q, info);
+				current = q;
+			}
+			break;
+		}
+
+		case kDKPathClose:
+			if (current.x != start.x || current.y != start.y)
+				function(current, start, info);
+			current = start;
+			break;
+		}
+	}
+}
+
+static inline double benchDistanceToLine(DKPathPoint p, DKPathPoint a, DKPathPoint b)
+{
+	double dx = b.x - a.x, dy = b.y - a.y, lengthSquared = dx * dx + dy * dy;
+	double t = lengthSquared > 0 ? fmin(fmax(((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared, 0), 1) : 0;
+
+	return hypot(a.x + dx * t - p.x, a.y + dy * t - p.y);
+}
+
+// the lines of a finely flattened path, filed in a grid of cells each listing the lines that come within <reach> of it, so a point need
+// only be measured against the lines listed in its own cell to find any nearer than that
+
+typedef struct {
+	DKPathPoint* ends;
+	size_t count;
+	size_t capacity;
+	DKPathPoint origin;
+	double cellSize;
+	double reach;
+	size_t columns;
+	size_t rows;
+	size_t* cellStarts;
+	size_t* cellLines;
+} BenchLineGrid;
+
+static void benchAddLine(DKPathPoint a, DKPathPoint b, void* info)
+{
+	BenchLineGrid* grid = info;
+
+	if (grid->count == grid->capacity) {
+		size_t capacity = grid->capacity ? grid->capacity * 2 : 1024;
+		DKPathPoint* ends = realloc(grid->ends, capacity * 2 * sizeof(DKPathPoint));
+
+		if (ends == NULL)
+			return;
+
+		grid->ends = ends;
+		grid->capacity = capacity;
+	}
+
+	grid->ends[grid->count * 2] = a;
+	grid->ends[grid->count * 2 + 1] = b;
+	++grid->count;
+}
+
+static void benchLineCells(const BenchLineGrid* grid, size_t line, size_t* column0, size_t* row0, size_t* column1, size_t* row1)
+{
+	DKPathPoint a = grid->ends[line * 2], b = grid->ends[line * 2 + 1];
+
+	*column0 = (size_t)((fmin(a.x, b.x) - grid->reach - grid->origin.x) / grid->cellSize);
+	*row0 = (size_t)((fmin(a.y, b.y) - grid->reach - grid->origin.y) / grid->cellSize);
+	*column1 = (size_t)fmin((fmax(a.x, b.x) + grid->reach - grid->origin.x) / grid->cellSize, grid->columns - 1);
+	*row1 = (size_t)fmin((fmax(a.y, b.y) + grid->reach - grid->origin.y) / grid->cellSize, grid->rows - 1);
+}
+
+static void benchLineGridInit(BenchLineGrid* grid, const DKPathBuffer* path, double reach)
+{
+	DKPathPoint least = { INFINITY, INFINITY }, most = { -INFINITY, -INFINITY };
+	size_t i, c, r, c0, r0, c1, r1;
+
+	memset(grid, 0, sizeof(BenchLineGrid));
+	benchFlattenPath(path, 32, benchAddLine, grid);
+
+	for (i = 0; i < grid->count * 2; ++i) {
+		least.x = fmin(least.x, grid->ends[i].x);
+		least.y = fmin(least.y, grid->ends[i].y);
+		most.x = fmax(most.x, grid->ends[i].x);
+		most.y = fmax(most.y, grid->ends[i].y);
+	}
+
+	if (grid->count == 0)
+		return;
+
+	// the cells are no smaller than the reach, and about 1000 to a side at most
+
+	grid->reach = reach;
+	grid->origin = (DKPathPoint){ least.x - reach, least.y - reach };
+	grid->cellSize = fmax(reach, fmax(most.x - least.x, most.y - least.y) / 1000.0);
+	grid->columns = (size_t)((most.x - least.x + 2 * reach) / grid->cellSize) + 1;
+	grid->rows = (size_t)((most.y - least.y + 2 * reach) / grid->cellSize) + 1;
+	grid->cellStarts = calloc(grid->columns * grid->rows + 1, sizeof(size_t));
+
+	for (i = 0; i < grid->count; ++i) {
+		benchLineCells(grid, i, &c0, &r0, &c1, &r1);
+
+		for (r = r0; r <= r1; ++r)
+			for (c = c0; c <= c1; ++c)
+				++grid->cellStarts[r * grid->columns + c + 1];
+	}
+
+	for (i = 0; i < grid->columns * grid->rows; ++i)
+		grid->cellStarts[i + 1] += grid->cellStarts[i];
+
+	size_t* filled = calloc(grid->columns * grid->rows, sizeof(size_t));
+
+	grid->cellLines = malloc(grid->cellStarts[grid->columns * grid->rows] * sizeof(size_t));
+
+	for (i = 0; i < grid->count; ++i) {
+		benchLineCells(grid, i, &c0, &r0, &c1, &r1);
+
+		for (r = r0; r <= r1; ++r)
+			for (c = c0; c <= c1; ++c) {
+				size_t cell = r * grid->columns + c;
+
+				grid->cellLines[grid->cellStarts[cell] + filled[cell]++] = i;
+			}
+	}
+
+	free(filled);
+}
+
+static void benchLineGridFree(BenchLineGrid* grid)
+{
+	free(grid->ends);
+	free(grid->cellStarts);
+	free(grid->cellLines);
+}
+
+// the distance from a point to the nearest line, looked up in the grid if it is within reach and found the long way if not
+
+static double benchLineGridDistance(const BenchLineGrid* grid, DKPathPoint p)
+{
+	double nearest = INFINITY;
+	size_t i;
+
+	if (grid->count == 0)
+		return nearest;
+
+	double column = (p.x - grid->origin.x) / grid->cellSize, row = (p.y - grid->origin.y) / grid->cellSize;
+
+	if (column >= 0 && row >= 0 && column < grid->columns && row < grid->rows) {
+		size_t cell = (size_t)row * grid->columns + (size_t)column;
+
+		for (i = grid->cellStarts[cell]; i < grid->cellStarts[cell + 1]; ++i) {
+			size_t line = grid->cellLines[i];
+
+			nearest = fmin(nearest, benchDistanceToLine(p, grid->ends[line * 2], grid->ends[line * 2 + 1]));
+		}
+	}
+
+	if (nearest <= grid->reach)
+		return nearest;
+
+	for (i = 0; i < grid->count; ++i)
+		nearest = fmin(nearest, benchDistanceToLine(p, grid->ends[i * 2], grid->ends[i * 2 + 1]));
+
+	return nearest;
+}
+
+// the greatest difference between the offset distance and the distance from the path of points along its offset, taking at most
+// <limit> points spread evenly over it. Every point of a true offset, trimmed where it crosses itself, is that far from the path, so
+// this is how far the result strays wherever it is, not just where it is known in closed form
+
+typedef struct {
+	const BenchLineGrid* grid;
+	double offset;
+	size_t stride;
+	size_t next;
+	double error;
+} BenchOffsetError;
+
+static void benchCountLine(DKPathPoint a, DKPathPoint b, void* info)
+{
+	(void)a;
+	(void)b;
+	++*(size_t*)info;
+}
+
+static void benchMeasureOffsetLine(DKPathPoint a, DKPathPoint b, void* info)
+{
+	BenchOffsetError* measure = info;
+
+	(void)a;
+
+	if (measure->next++ % measure->stride == 0)
+		measure->error = fmax(measure->error, fabs(benchLineGridDistance(measure->grid, b) - measure->offset));
+}
+
+static double benchMaxOffsetError(const DKPathBuffer* path, const DKPathBuffer* offsetPath, double offset, size_t limit)
+{
+	BenchLineGrid grid;
+	BenchOffsetError measure;
+	size_t count = 0;
+
+	benchFlattenPath(offsetPath, 8, benchCountLine, &count);
+	benchLineGridInit(&grid, path, fabs(offset) * 1.5 + 1.0);
+
+	measure.grid = &grid;
+	measure.offset = fabs(offset);
+	measure.stride = count > limit ? (count + limit - 1) / limit : 1;
+	measure.next = 0;
+	measure.error = 0;
+	benchFlattenPath(offsetPath, 8, benchMeasureOffsetLine, &measure);
+
+	benchLineGridFree(&grid);
+	return measure.error;
+}
+
+#pragma mark - benchmarks
+
+static void benchBuildRects(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	DKPathBufferClear(&context->path);
+
+	for (i = 0; i < context->count; ++i) {
+		const DKBenchmarkRect* r = &context->rects[i];
+
+		DKPathBufferMoveTo(&context->path, (DKPathPoint){ r->x, r->y });
+		DKPathBufferLineTo(&context->path, (DKPathPoint){ r->x + r->width, r->y });
+		DKPathBufferLineTo(&context->path, (DKPathPoint){ r->x + r->width, r->y + r->height });
+		DKPathBufferLineTo(&context->path, (DKPathPoint){ r->x, r->y + r->height });
+		DKPathBufferClose(&context->path);
+	}
+}
+
+static void benchWindingRects(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	context->hits = 0;
+
+	for (i = 0; i < context->pointCount; ++i) {
+		if (DKPathBufferWindingNumber(&context->path, context->points[i], 0.1) != 0)
+			++context->hits;
+	}
+}
+
+static bool benchDiscardSVG(const char* bytes, size_t length, void* info)
+{
+	(void)bytes;
+	*(uint64_t*)info += length;
+	return true;
+}
+
+static void benchWriteSVG(void* info)
+{
+	BenchContext* context = info;
+	DKSVGStream stream;
+	uint64_t discarded = 0;
+	size_t i;
+
+	// each object as a path of one of 16 shared style classes, through the default 64KB buffer
+
+	DKSVGStreamInit(&stream, 65536, 2, benchDiscardSVG, &discarded);
+	DKSVGStreamAppendString(&stream, "<svg xmlns=\"http://www.w3.org/2000/svg\">\n<g>\n");
+
+	for (i = 0; i < context->count; ++i) {
+		const DKBenchmarkRect* r = &context->rects[i];
+		char name[24];
+
+		snprintf(name, sizeof(name), "<path class=\"s%zu\" d=\"", i % 16 + 1);
+		DKSVGStreamAppendString(&stream, name);
+		DKSVGStreamBeginPath(&stream);
+		DKSVGStreamMoveTo(&stream, r->x, r->y);
+		DKSVGStreamLineTo(&stream, r->x + r->width, r->y);
+		DKSVGStreamLineTo(&stream, r->x + r->width, r->y + r->height);
+		DKSVGStreamLineTo(&stream, r->x, r->y + r->height);
+		DKSVGStreamClose(&stream);
+		DKSVGStreamAppendString(&stream, "\"/>\n");
+	}
+
+	DKSVGStreamAppendString(&stream, "</g>\n</svg>\n");
+	DKSVGStreamFlush(&stream);
+	DKSVGStreamFree(&stream);
+
+	context->bytes = discarded;
+}
+
+// the wire's curves as the path data of one SVG element
+
+static void benchWritePathSVG(void* info)
+{
+	BenchContext* context = info;
+	DKSVGStream stream;
+	uint64_t discarded = 0;
+
+	DKSVGStreamInit(&stream, 65536, 2, benchDiscardSVG, &discarded);
+	DKSVGStreamAppendString(&stream, "<svg xmlns=\"http://www.w3.org/2000/svg\">\n<path class=\"s1\" d=\"");
+	DKSVGStreamBeginPath(&stream);
+	DKSVGStreamAppendPathBuffer(&stream, &context->path);
+	DKSVGStreamAppendString(&stream, "\"/>\n</svg>\n");
+	DKSVGStreamFlush(&stream);
+	DKSVGStreamFree(&stream);
+
+	context->bytes = discarded;
+}
+
+// objects filed under a BSP index as DKBSPDirectObjectStorage files them: each in a list at every leaf it touches. A rect query stamps
+// each object it looks at, so one in several leaves is only looked at once, as the storage marks them
+
+static size_t benchStorageDepth(size_t count)
+{
+	// as DKBSPObjectStorage chooses it, with its minimum of 10
+
+	return count > 0 ? (size_t)fmax(ceil(log((double)count)) / log(2.0), 10) : 0;
+}
+
+static void benchFreeLeaves(BenchContext* context)
+{
+	size_t i;
+
+	if (context->leaves) {
+		for (i = 0; i < context->index.leafCount; ++i)
+			free(context->leaves[i].items);
+	}
+
+	free(context->leaves);
+	context->leaves = NULL;
+}
+
+static void benchMakeStorage(void* info)
+{
+	BenchContext* context = info;
+
+	benchFreeLeaves(context);
+	DKBSPIndexSetDepth(&context->index, BENCH_CANVAS, BENCH_CANVAS, benchStorageDepth(context->count));
+	context->leaves = calloc(context->index.leafCount, sizeof(BenchLeaf));
+}
+
+static void benchInsertInLeaf(size_t leaf, void* info)
+{
+	BenchContext* context = info;
+	BenchLeaf* l = &context->leaves[leaf];
+
+	if (l->count == l->capacity) {
+		size_t capacity = l->capacity ? l->capacity * 2 : 4;
+		size_t* items = realloc(l->items, capacity * sizeof(size_t));
+
+		if (items == NULL)
+			return;
+
+		l->items = items;
+		l->capacity = capacity;
+	}
+
+	l->items[l->count++] = context->item;
+}
+
+static void benchStorageInsert(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	for (i = 0; i < context->count; ++i) {
+		const DKBenchmarkRect* r = &context->rects[i];
+
+		context->item = i;
+		DKBSPIndexVisitRect(&context->index, r->x, r->y, r->width, r->height, benchInsertInLeaf, context);
+	}
+}
+
+static void benchFindInLeaf(size_t leaf, void* info)
+{
+	BenchContext* context = info;
+	const BenchLeaf* l = &context->leaves[leaf];
+	const DKBenchmarkRect* q = context->query;
+	size_t i;
+
+	for (i = 0; i < l->count; ++i) {
+		size_t item = l->items[i];
+
+		if (context->stamps[item] != context->stamp) {
+			const DKBenchmarkRect* r = &context->rects[item];
+
+			context->stamps[item] = context->stamp;
+
+			if (r->x < q->x + q->width && q->x < r->x + r->width && r->y < q->y + q->height && q->y < r->y + r->height)
+				++context->found;
+		}
+	}
+}
+
+static void benchStorageRectQuery(void* info)
+{
+	BenchContext* context = info;
+	size_t q;
+
+	context->found = 0;
+
+	for (q = 0; q < context->queryCount; ++q) {
+		if (++context->stamp == 0) {
+			memset(context->stamps, 0, context->count * sizeof(uint32_t));
+			context->stamp = 1;
+		}
+
+		context->query = &context->queryRects[q];
+		DKBSPIndexVisitRect(&context->index, context->query->x, context->query->y, context->query->width, context->query->height, benchFindInLeaf,
+			context);
+	}
+}
+
+static void benchStoragePointQuery(void* info)
+{
+	BenchContext* context = info;
+	size_t q, i;
+
+	context->found = 0;
+
+	for (q = 0; q < context->pointCount; ++q) {
+		DKPathPoint p = context->points[q];
+		const BenchLeaf* l = &context->leaves[DKBSPIndexLeafAtPoint(&context->index, p.x, p.y)];
+
+		for (i = 0; i < l->count; ++i) {
+			const DKBenchmarkRect* r = &context->rects[l->items[i]];
+
+			if (p.x >= r->x && p.x < r->x + r->width && p.y >= r->y && p.y < r->y + r->height)
+				++context->found;
+		}
+	}
+}
+
+static void benchClearResult(void* info)
+{
+	BenchContext* context = info;
+
+	DKPathBufferClear(&context->result);
+}
+
+static void benchDashRemeasured(void* info)
+{
+	BenchContext* context = info;
+	size_t f;
+
+	for (f = 0; f < context->frames; ++f) {
+		DKPathBufferClear(&context->result);
+		DKPathDash(&context->path, context->pattern, context->patternCount, f * 1.5, 0.1, &context->result);
+	}
+}
+
+static void benchDashMeasured(void* info)
+{
+	BenchContext* context = info;
+	size_t f;
+
+	for (f = 0; f < context->frames; ++f) {
+		DKPathBufferClear(&context->result);
+		DKPathMeasureDash(&context->measure, context->pattern, context->patternCount, f * 1.5, &context->result);
+	}
+}
+
+static void benchOffset(void* info)
+{
+	BenchContext* context = info;
+
+	DKPathOffset(&context->path, context->offset, &context->offsetOptions, &context->result);
+}
+
+static void benchStroke(void* info)
+{
+	BenchContext* context = info;
+
+	DKPathStroke(&context->path, &context->style, &context->result);
+}
+
+static void benchStrokeHitTest(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	context->hits = 0;
+
+	for (i = 0; i < context->pointCount; ++i) {
+		if (DKPathStrokeContainsPoint(&context->path, &context->style, context->points[i]))
+			++context->hits;
+	}
+}
+
+// the point mapping DKDistortionTransform used before it kept a warp: for every point, the lines across the envelope through it are
+// interpolated and intersected
+
+static inline double benchDeterminant(double a, double b, double c, double d)
+{
+	return a * d - b * c;
+}
+
+static DKPathPoint benchMapByIntersection(DKPathPoint p, double width, double height, const DKPathPoint q[4])
+{
+	double x1 = ((height - p.y) * q[0].x + p.y * q[3].x) / height, y1 = ((height - p.y) * q[0].y + p.y * q[3].y) / height;
+	double x2 = ((height - p.y) * q[1].x + p.y * q[2].x) / height, y2 = ((height - p.y) * q[1].y + p.y * q[2].y) / height;
+	double x3 = ((width - p.x) * q[0].x + p.x * q[1].x) / width, y3 = ((width - p.x) * q[0].y + p.x * q[1].y) / width;
+	double x4 = ((width - p.x) * q[3].x + p.x * q[2].x) / width, y4 = ((width - p.x) * q[3].y + p.x * q[2].y) / width;
+	double d = benchDeterminant(x1 - x2, y1 - y2, x3 - x4, y3 - y4);
+
+	if (d == 0.0)
+		d = 1.0;
+
+	return (DKPathPoint){ benchDeterminant(benchDeterminant(x1, y1, x2, y2), x1 - x2, benchDeterminant(x3, y3, x4, y4), x3 - x4) / d,
+		benchDeterminant(benchDeterminant(x1, y1, x2, y2), y1 - y2, benchDeterminant(x3, y3, x4, y4), y3 - y4) / d };
+}
+
+static void benchWarpPointsByIntersection(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	for (i = 0; i < context->pointCount; ++i) {
+		DKPathPoint p = { context->points[i].x - context->origin.x, context->points[i].y - context->origin.y };
+
+		context->warpedPoints[i] = benchMapByIntersection(p, context->width, context->height, context->envelope);
+	}
+}
+
+static void benchWarpPointsScalar(void* info)
+{
+	BenchContext* context = info;
+	size_t i;
+
+	for (i = 0; i < context->pointCount; ++i)
+		context->warpedPoints[i] = DKPathWarpPoint(&context->warp, context->points[i]);
+}
+
+static void benchWarpPointsBatch(void* info)
+{
+	BenchContext* context = info;
+
+	DKPathWarpPoints(&context->warp, context->points, context->pointCount, context->warpedPoints);
+}
+
+static void benchWarpPath(void* info)
+{
+	BenchContext* context = info;
+
+	DKPathWarpPath(&context->warp, &context->path, context->tolerance, &context->result);
+}
+
+// the greatest distance from the true warp of points along the path's curves to its warp at <tolerance>. Each curve is warped on its own,
+// as DKPathWarpPath() does within a path, so the points are only measured against the part of the result that curve became
+
+static double benchMaxWarpError(const DKPathWarp* warp, const DKPathBuffer* path, double tolerance)
+{
+	DKPathBuffer curve, warped;
+	DKPathPoint current = { 0, 0 };
+	const DKPathPoint* p = path->points;
+	double error = 0;
+	size_t i;
+
+	DKPathBufferInit(&curve);
+	DKPathBufferInit(&warped);
+
+	for (i = 0; i < path->verbCount; p += DKPathVerbPointCount(path->verbs[i]), ++i) {
+		if (path->verbs[i] == kDKPathMoveTo)
+			current = p[0];
+
+		if (path->verbs[i] != kDKPathCurveTo)
+			continue;
+
+		DKPathPoint c[4] = { current, p[0], p[1], p[2] };
+		int s;
+
+		DKPathBufferClear(&curve);
+		DKPathBufferClear(&warped);
+		DKPathBufferMoveTo(&curve, c[0]);
+		DKPathBufferCurveTo(&curve, c[1], c[2], c[3]);
+		DKPathWarpPath(warp, &curve, tolerance, &warped);
+
+		for (s = 1; s < 32; ++s) {
+			DKPathPoint truth = DKPathWarpPoint(warp, DKCubicPointAt(c, s / 32.0));
+			DKPathPoint from = warped.points[0];
+			const DKPathPoint* w = warped.points + 1;
+			double nearest = INFINITY;
+			size_t v;
+
+			for (v = 1; v < warped.verbCount; ++v) {
+				DKPathPoint e[4] = { from, from, *w, *w };
+				int k;
+
+				if (warped.verbs[v] == kDKPathCurveTo) {
+					e[1] = w[0];
+					e[2] = w[1];
+					e[3] = w[2];
+				}
+
+				for (k = 0; k < 64; ++k) {
+					DKPathPoint a = DKCubicPointAt(e, k / 64.0), b = DKCubicPointAt(e, (k + 1) / 64.0);
+					double dx = b.x - a.x, dy = b.y - a.y, lengthSquared = dx * dx + dy * dy;
+					double t = lengthSquared > 0 ? fmin(fmax(((truth.x - a.x) * dx + (truth.y - a.y) * dy) / lengthSquared, 0), 1) : 0;
+
+					nearest = fmin(nearest, hypot(a.x + dx * t - truth.x, a.y + dy * t - truth.y));
+				}
+
+				from = e[3];
+				w += DKPathVerbPointCount(warped.verbs[v]);
+			}
+
+			error = fmax(error, nearest);
+		}
+
+		current = c[3];
+	}
+
+	DKPathBufferFree(&curve);
+	DKPathBufferFree(&warped);
+	return error;
+}
+
+#pragma mark -
+
+static void runGeometryBenchmarks(DKBenchmarkSuite* suite, BenchContext* context)
+{
+	DKBenchmarkResult* result;
+	uint64_t state = BENCH_SEED;
+	size_t i;
+	int d;
+
+	// building paths from drawings of each distribution, and hit testing them by winding number
+
+	for (d = 0; d < kDKBenchmarkDistributionCount; ++d) {
+		const char* variant = DKBenchmarkDistributionName((DKBenchmarkDistribution)d);
+
+		context->count = DKBenchmarkSuiteScaledSize(suite, 100000);
+		context->rects = malloc(context->count * sizeof(DKBenchmarkRect));
+		DKBenchmarkGenerateRects((DKBenchmarkDistribution)d, context->count, BENCH_CANVAS, BENCH_CANVAS, BENCH_SEED, context->rects);
+
+		DKBenchmarkSuiteRun(suite, "path-build-rects", variant, context->count, NULL, benchBuildRects, context);
+
+		// writing the same drawing as SVG, in constant memory however large it is
+
+		result = DKBenchmarkSuiteRun(suite, "svg-write", variant, context->count, NULL, benchWriteSVG, context);
+
+		if (result) {
+			result->metric = (double)context->bytes / context->count;
+			snprintf(result->metricName, sizeof(result->metricName), "bytes/object");
+		}
+
+		// filing the same drawing under a BSP index, then finding objects in windows onto it, half of them centred on an object, and
+		// under points in objects, as TestDKBenchmarks does with the storage classes
+
+		char storageVariant[32];
+
+		snprintf(storageVariant, sizeof(storageVariant), "bsp-index/%s", variant);
+		context->queryCount = 200;
+		context->pointCount = 1000;
+		context->queryRects = malloc(context->queryCount * sizeof(DKBenchmarkRect));
+		context->points = malloc(context->pointCount * sizeof(DKPathPoint));
+		context->stamps = calloc(context->count, sizeof(uint32_t));
+		context->stamp = 0;
+
+		for (i = 0; i < context->queryCount; ++i) {
+			const DKBenchmarkRect* r = &context->rects[DKBenchmarkRandom(&state) % context->count];
+			DKPathPoint c = (i & 1) ? (DKPathPoint){ DKBenchmarkRandomUnit(&state) * BENCH_CANVAS, DKBenchmarkRandomUnit(&state) * BENCH_CANVAS }
+									: (DKPathPoint){ r->x + r->width * 0.5, r->y + r->height * 0.5 };
+
+			context->queryRects[i] = (DKBenchmarkRect){ c.x - BENCH_CANVAS / 20, c.y - BENCH_CANVAS / 20, BENCH_CANVAS / 10, BENCH_CANVAS / 10, 0, 0 };
+		}
+
+		for (i = 0; i < context->pointCount; ++i) {
+			const DKBenchmarkRect* r = &context->rects[DKBenchmarkRandom(&state) % context->count];
+
+			context->points[i] = (DKPathPoint){ r->x + r->width * DKBenchmarkRandomUnit(&state), r->y + r->height * DKBenchmarkRandomUnit(&state) };
+		}
+
+		if (DKBenchmarkSuiteRun(suite, "storage-insert", storageVariant, context->count, benchMakeStorage, benchStorageInsert, context) == NULL) {
+			benchMakeStorage(context);
+			benchStorageInsert(context);
+		}
+
+		result = DKBenchmarkSuiteRun(suite, "storage-rect-query", storageVariant, context->count, NULL, benchStorageRectQuery, context);
+
+		if (result) {
+			result->metric = (double)context->found / context->queryCount;
+			snprintf(result->metricName, sizeof(result->metricName), "found/query");
+		}
+
+		result = DKBenchmarkSuiteRun(suite, "storage-point-query", storageVariant, context->count, NULL, benchStoragePointQuery, context);
+
+		if (result) {
+			result->metric = (double)context->found / context->pointCount;
+			snprintf(result->metricName, sizeof(result->metricName), "found/query");
+		}
+
+		benchFreeLeaves(context);
+		DKBSPIndexFree(&context->index);
+		free(context->stamps);
+		free(context->queryRects);
+		free(context->points);
+		context->stamps = NULL;
+		context->queryRects = NULL;
+		context->points = NULL;
+
+		// half the points are inside an object and half anywhere on the canvas
+
+		context->count = DKBenchmarkSuiteScaledSize(suite, 1000);
+		context->pointCount = DKBenchmarkSuiteScaledSize(suite, 2000);
+		context->points = malloc(context->pointCount * sizeof(DKPathPoint));
+		DKBenchmarkGenerateRects((DKBenchmarkDistribution)d, context->count, BENCH_CANVAS, BENCH_CANVAS, BENCH_SEED, context->rects);
+		benchBuildRects(context);
+
+		for (i = 0; i < context->pointCount; ++i) {
+			const DKBenchmarkRect* r = &context->rects[DKBenchmarkRandom(&state) % context->count];
+
+			if (i & 1)
+				context->points[i] = (DKPathPoint){ DKBenchmarkRandomUnit(&state) * BENCH_CANVAS, DKBenchmarkRandomUnit(&state) * BENCH_CANVAS };
+			else
+				context->points[i] = (DKPathPoint){ r->x + r->width * DKBenchmarkRandomUnit(&state), r->y + r->height * DKBenchmarkRandomUnit(&state) };
+		}
+
+		result = DKBenchmarkSuiteRun(suite, "path-winding", variant, context->count, NULL, benchWindingRects, context);
+
+		if (result) {
+			result->metric = (double)context->hits / context->pointCount;
+			snprintf(result->metricName, sizeof(result->metricName), "hit rate");
+		}
+
+		free(context->points);
+		free(context->rects);
+		context->points = NULL;
+		context->rects = NULL;
+	}
+
+	// dashing a long wire at a run of animated phases, measuring it for each frame or once for all of them
+
+	context->pattern[0] = 12;
+	context->pattern[1] = 4;
+	context->pattern[2] = 2;
+	context->pattern[3] = 4;
+	context->patternCount = 4;
+	context->frames = 10;
+	benchMakeWire(&context->path, DKBenchmarkSuiteScaledSize(suite, 10000));
+
+	// writing the wire as SVG, where nearly every byte is a coordinate
+
+	result = DKBenchmarkSuiteRun(suite, "svg-write", "wire", context->path.verbCount - 1, NULL, benchWritePathSVG, context);
+
+	if (result) {
+		result->metric = (double)context->bytes / (context->path.verbCount - 1);
+		snprintf(result->metricName, sizeof(result->metricName), "bytes/curve");
+	}
+
+	DKBenchmarkSuiteRun(suite, "dash-10-frames", "remeasured", context->path.verbCount - 1, NULL, benchDashRemeasured, context);
+
+	if (DKBenchmarkSuiteWants(suite, "dash-10-frames", "measured")) {
+		DKPathMeasureSetPath(&context->measure, &context->path, 0.1);
+		DKBenchmarkSuiteRun(suite, "dash-10-frames", "measured", context->path.verbCount - 1, NULL, benchDashMeasured, context);
+	}
+
+	// stroking the wire, solid and dashed, and hit testing the stroke near it
+
+	context->style = DKPathStrokeDefaultStyle();
+	context->style.width = 6;
+	context->style.join = kDKPathJoinRound;
+	context->style.cap = kDKPathCapRound;
+
+	DKBenchmarkSuiteRun(suite, "stroke-outline", "solid-round", context->path.verbCount - 1, benchClearResult, benchStroke, context);
+
+	context->style.dash = context->pattern;
+	context->style.dashCount = context->patternCount;
+	context->style.join = kDKPathJoinMiter;
+	context->style.cap = kDKPathCapButt;
+
+	DKBenchmarkSuiteRun(suite, "stroke-outline", "dashed-miter", context->path.verbCount - 1, benchClearResult, benchStroke, context);
+
+	context->style.dash = NULL;
+	context->style.dashCount = 0;
+	context->pointCount = DKBenchmarkSuiteScaledSize(suite, 200);
+	context->points = malloc(context->pointCount * sizeof(DKPathPoint));
+
+	for (i = 0; i < context->pointCount; ++i) {
+		const DKPathPoint* p = &context->path.points[DKBenchmarkRandom(&state) % context->path.pointCount];
+
+		context->points[i] = (DKPathPoint){ p->x + DKBenchmarkRandomUnit(&state) * 10 - 5, p->y + DKBenchmarkRandomUnit(&state) * 10 - 5 };
+	}
+
+	result = DKBenchmarkSuiteRun(suite, "stroke-hit-test", "solid-round", context->path.verbCount - 1, NULL, benchStrokeHitTest, context);
+
+	if (result) {
+		result->metric = (double)context->hits / context->pointCount;
+		snprintf(result->metricName, sizeof(result->metricName), "hit rate");
+	}
+
+	free(context->points);
+	context->points = NULL;
+
+	// offsetting the wire, whose tight turns leave loops to remove, a fine circle, whose offset is known exactly, and blobs offset both
+	// ways, each leaving loops of its own. The wire's curves meet at corners, so they are joined round, keeping every point of the
+	// offset the same distance from the wire. Both closed shapes run anticlockwise, so a positive offset moves them inwards.
+
+	context->offsetOptions = DKPathOffsetDefaultOptions();
+	context->offsetOptions.join = kDKPathJoinRound;
+	context->offset = 12;
+
+	result = DKBenchmarkSuiteRun(suite, "offset", "wire", context->path.verbCount - 1, benchClearResult, benchOffset, context);
+
+	if (result) {
+		result->metric = benchMaxOffsetError(&context->path, &context->result, context->offset, 20000);
+		snprintf(result->metricName, sizeof(result->metricName), "max error");
+	}
+
+	benchMakeCircle(&context->path, DKBenchmarkSuiteScaledSize(suite, 10000), 1000);
+	context->offset = 25;
+
+	result = DKBenchmarkSuiteRun(suite, "offset", "circle", context->path.verbCount - 2, benchClearResult, benchOffset, context);
+
+	if (result) {
+		result->metric = benchMaxRadialError(&context->result, 975);
+		snprintf(result->metricName, sizeof(result->metricName), "max error");
+	}
+
+	benchMakeBlobs(&context->path, DKBenchmarkSuiteScaledSize(suite, 400), BENCH_SEED);
+
+	for (d = 0; d < 2; ++d) {
+		context->offset = d == 0 ? 20 : -20;
+
+		result = DKBenchmarkSuiteRun(suite, "offset", d == 0 ? "blobs-inset" : "blobs-outset", context->path.verbCount / (BENCH_BLOB_ARCS + 2) * BENCH_BLOB_ARCS,
+			benchClearResult, benchOffset, context);
+
+		if (result) {
+			result->metric = benchMaxOffsetError(&context->path, &context->result, context->offset, 20000);
+			snprintf(result->metricName, sizeof(result->metricName), "max error");
+		}
+	}
+
+	// warping into a keystone: random points across rings of curves, one at a time as the old intersection of lines and as the warp
+	// does it, and the rings themselves at tolerances from 1/2000 of the envelope's size to 1/200000, with the error each leaves
+
+	benchMakeRings(&context->path, DKBenchmarkSuiteScaledSize(suite, 500));
+	benchPathBounds(&context->path, &context->origin, &context->width, &context->height);
+	context->envelope[0] = (DKPathPoint){ context->origin.x, context->origin.y };
+	context->envelope[1] = (DKPathPoint){ context->origin.x + context->width * 1.1, context->origin.y + context->height * 0.3 };
+	context->envelope[2] = (DKPathPoint){ context->origin.x + context->width * 0.9, context->origin.y + context->height * 1.4 };
+	context->envelope[3] = (DKPathPoint){ context->origin.x + context->width * 0.05, context->origin.y + context->height };
+	DKPathWarpInit(&context->warp, context->origin, context->width, context->height, context->envelope);
+
+	context->pointCount = DKBenchmarkSuiteScaledSize(suite, 1000000);
+	context->points = malloc(context->pointCount * sizeof(DKPathPoint));
+
+	for (i = 0; i < context->pointCount; ++i)
+		context->points[i] = (DKPathPoint){ context->origin.x + DKBenchmarkRandomUnit(&state) * context->width,
+			context->origin.y + DKBenchmarkRandomUnit(&state) * context->height };
+
+	context->warpedPoints = malloc(context->pointCount * sizeof(DKPathPoint));
+
+	DKBenchmarkSuiteRun(suite, "warp-points", "intersection", context->pointCount, NULL, benchWarpPointsByIntersection, context);
+	DKBenchmarkSuiteRun(suite, "warp-points", "scalar", context->pointCount, NULL, benchWarpPointsScalar, context);
+	DKBenchmarkSuiteRun(suite, "warp-points", "batch", context->pointCount, NULL, benchWarpPointsBatch, context);
+
+	free(context->points);
+	free(context->warpedPoints);
+	context->points = NULL;
+	context->warpedPoints = NULL;
+
+	const double flatness[3] = { 1.0 / 2000.0, 1.0 / 20000.0, 1.0 / 200000.0 };
+	const double size = fmax(context->width * 1.1, context->height * 1.4);
+
+	for (d = 0; d < 3; ++d) {
+		char variant[32];
+
+		context->tolerance = size * flatness[d];
+		snprintf(variant, sizeof(variant), "tolerance-%g", context->tolerance);
+
+		result = DKBenchmarkSuiteRun(suite, "warp-path", variant, context->path.verbCount / 6 * 4, benchClearResult, benchWarpPath, context);
+
+		if (result) {
+			result->metric = benchMaxWarpError(&context->warp, &context->path, context->tolerance);
+			snprintf(result->metricName, sizeof(result->metricName), "max error");
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	DKBenchmarkOptions options = DKBenchmarkDefaultOptions();
+	const char* baselinePath = NULL;
+	const char* outputPath = NULL;
+	double tolerance = 0.1;
+	int i;
+
+	for (i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+			usage(argv[0]);
+			return 0;
+		}
+
+		if (value == NULL) {
+			usage(argv[0]);
+			return 2;
+		}
+
+		if (strcmp(arg, "--filter") == 0)
+			options.filter = value;
+		else if (strcmp(arg, "--scale") == 0)
+			options.scale = atof(value);
+		else if (strcmp(arg, "--samples") == 0)
+			options.samples = (size_t)atol(value);
+		else if (strcmp(arg, "--time-limit") == 0)
+			options.timeLimit = atof(value);
+		else if (strcmp(arg, "--baseline") == 0)
+			baselinePath = value;
+		else if (strcmp(arg, "--output") == 0)
+			outputPath = value;
+		else if (strcmp(arg, "--tolerance") == 0)
+			tolerance = atof(value);
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+
+		++i;
+	}
+
+	DKBenchmarkSuite* suite = DKBenchmarkSuiteCreate(&options);
+	BenchContext context;
+
+	if (baselinePath && !DKBenchmarkSuiteLoadBaseline(suite, baselinePath)) {
+		fprintf(stderr, "can't read baseline %s\n", baselinePath);
+		return 2;
+	}
+
+	memset(&context, 0, sizeof(context));
+	DKPathBufferInit(&context.path);
+	DKPathBufferInit(&context.result);
+	DKPathMeasureInit(&context.measure);
+	DKBSPIndexInit(&context.index);
+
+	runGeometryBenchmarks(suite, &context);
+
+	DKPathMeasureFree(&context.measure);
+	DKPathBufferFree(&context.result);
+	DKPathBufferFree(&context.path);
+
+	size_t regressions = DKBenchmarkSuiteReport(suite, tolerance, stdout);
+
+	if (!DKBenchmarkCountsAllocations())
+		printf("\nallocations are not counted in this build\n");
+
+	if (outputPath && !DKBenchmarkSuiteWriteResults(suite, outputPath)) {
+		fprintf(stderr, "can't write results to %s\n", outputPath);
+		return 2;
+	}
+
+	if (regressions > 0)
+		printf("\n%zu regression%s against %s\n", regressions, regressions == 1 ? "" : "s", baselinePath);
+
+	DKBenchmarkSuiteFree(suite);
+	return regressions > 0 ? 1 : 0;
+}
@@ -470,12 +470,14 @@ NSString* const kDKDimensionUnitsKey = @"DKDimensionUnits";
 	[shaft setLineCapStyle:[self lineCapStyle]];
 	[shaft setLineJoinStyle:[self lineJoinStyle]];
 
+	[shaft setLineDash:NULL
+				 count:0
+				 phase:0.0];
+
+	// a dashed shaft is split into its dashes first, which are cached so that redrawing the same shaft doesn't measure it again
+
 	if ([self dash])
-		[[self dash] applyToPath:shaft];
-	else
-		[shaft setLineDash:NULL
-					 count:0
-					 phase:0.0];
+		shaft = [[self dash] dashedPathForPath:shaft];
 
 	// convert the shaft to its outline:
 
@@ -700,6 +702,13 @@ NSString* const kDKDimensionUnitsKey = @"DKDimensionUnits";
 		@"dimensionToleranceOption"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"arrowHeadAtStart", @"arrowHeadAtEnd", @"arrowHeadWidth", @"arrowHeadLength",
+		@"dimensioningLineOptions", @"outlineColour", @"outlineWidth", @"textAttributes", @"formatter", @"dimensionTextKind",
+		@"dimensionToleranceOption"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -5,6 +5,7 @@
 */
 
 #import "DKBSPDirectObjectStorage.h"
+#import "DKInstrumentation.h"
 
 // if this is set to 1, various iterations are done using the much faster CFArrayApplyFunction and CFArraySortValues methods
 
@@ -62,6 +63,8 @@ static inline NSUInteger depthForObjectCount(NSUInteger n)
 {
 #pragma unused(options)
 
+	DK_INSTRUMENT_SCOPE("storage", "direct BSP rect query");
+
 	NSMutableArray* results;
 
 	if (aView) {
@@ -85,6 +88,8 @@ static inline NSUInteger depthForObjectCount(NSUInteger n)
 
 	//NSLog(@"returning %d object(s)", [results count]);
 
+	DK_INSTRUMENT_VALUE("storage", "direct BSP objects found", (int64_t)[results count]);
+
 	// warning, the results returned is the actual mutable array owned by the tree. This is for performance reasons. The client should not
 	// expect the array content to remain stable across each event loop. The client must make a copy if they wish to keep this list (in practice unlikely).
 
@@ -93,6 +98,8 @@ static inline NSUInteger depthForObjectCount(NSUInteger n)
 
 - (NSArray*)objectsContainingPoint:(NSPoint)aPoint
 {
+	DK_INSTRUMENT_SCOPE("storage", "direct BSP point query");
+
 	NSMutableArray* objects = [mTree objectsIntersectingPoint:aPoint];
 
 	[self sortObjectsByZ:objects];
@@ -441,8 +448,8 @@ static void unmarkFunc(const void* value, void* context)
 // these are implemented by DKBSPIndexTree as private methods, re-prototyped here so
 // we can make use of them in this subclass
 
-- (void)recursivelySearchWithRect:(NSRect)rect index:(NSUInteger)indx;
-- (void)recursivelySearchWithPoint:(NSPoint)pt index:(NSUInteger)indx;
+- (void)searchWithRect:(NSRect)rect;
+- (void)searchWithPoint:(NSPoint)pt;
 - (void)operateOnLeaf:(id)leaf;
 - (void)removeObject:(id<DKStorableObject>)obj;
 
@@ -454,14 +461,13 @@ static void unmarkFunc(const void* value, void* context)
 
 - (void)insertItem:(id<DKStorableObject>)obj withRect:(NSRect)rect
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return;
 
 	if (obj && !NSIsEmptyRect(rect)) {
 		mOp = kDKOperationInsert;
 		mObj = obj;
-		[self recursivelySearchWithRect:rect
-								  index:0];
+		[self searchWithRect:rect];
 
 		++mObjectCount;
 	} else
@@ -474,7 +480,7 @@ static void unmarkFunc(const void* value, void* context)
 {
 #pragma unused(rect)
 	/*
- if ([mNodes count] == 0)
+ if (DKBSPIndexIsEmpty(&mIndex))
         return;
 
 	if( obj && !NSIsEmptyRect( rect ))
@@ -482,7 +488,7 @@ static void unmarkFunc(const void* value, void* context)
 		[obj setMarked:NO];
 		mOp = kDKOperationDelete;
 		mObj = obj;
-		[self recursivelySearchWithRect:rect index:0];
+		[self searchWithRect:rect];
 		
 		if( mObjectCount > 0 )
 			--mObjectCount;
@@ -506,7 +512,7 @@ static void unmarkFunc(const void* value, void* context)
 {
 	// this may be used in conjunction with NSView's -getRectsBeingDrawn:count: to find those objects that intersect the non-rectangular update region.
 
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mViewRef = aView;
@@ -514,15 +520,14 @@ static void unmarkFunc(const void* value, void* context)
 	[mFoundObjects removeAllObjects];
 
 	for (NSUInteger i = 0; i < count; ++i)
-		[self recursivelySearchWithRect:rects[i]
-								  index:0];
+		[self searchWithRect:rects[i]];
 
 	return mFoundObjects;
 }
 
 - (NSMutableArray*)objectsIntersectingRect:(NSRect)rect
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mRect = rect;
@@ -530,22 +535,20 @@ static void unmarkFunc(const void* value, void* context)
 	mOp = kDKOperationAccumulate;
 	[mFoundObjects removeAllObjects];
 
-	[self recursivelySearchWithRect:rect
-							  index:0];
+	[self searchWithRect:rect];
 	return mFoundObjects;
 }
 
 - (NSMutableArray*)objectsIntersectingPoint:(NSPoint)point
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mRect = NSMakeRect(point.x, point.y, 1e-3, 1e-3);
 	mOp = kDKOperationAccumulate;
 	[mFoundObjects removeAllObjects];
 
-	[self recursivelySearchWithPoint:point
-							   index:0];
+	[self searchWithPoint:point];
 
 	return mFoundObjects;
 }
@@ -0,0 +1,122 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKBSPIndex.h"
+#include <stdlib.h>
+
+void DKBSPIndexInit(DKBSPIndex* index)
+{
+	index->splits = NULL;
+	index->depth = 0;
+	index->leafCount = 0;
+	index->width = 0;
+	index->height = 0;
+}
+
+void DKBSPIndexFree(DKBSPIndex* index)
+{
+	free(index->splits);
+	DKBSPIndexInit(index);
+}
+
+// each node splits its rect in half across the axis it tests, and its children split their halves across the other one
+
+static void DKBSPIndexPartition(DKBSPIndex* index, size_t node, double x, double y, double width, double height, bool acrossY)
+{
+	if (node >= index->leafCount - 1)
+		return;
+
+	size_t child = 2 * node + 1;
+
+	if (acrossY) {
+		double lower = height * 0.5;
+
+		index->splits[node] = y + lower;
+		DKBSPIndexPartition(index, child, x, y, width, lower, false);
+		DKBSPIndexPartition(index, child + 1, x, y + lower, width, height - lower, false);
+	} else {
+		double left = width * 0.5;
+
+		index->splits[node] = x + left;
+		DKBSPIndexPartition(index, child, x, y, left, height, true);
+		DKBSPIndexPartition(index, child + 1, x + left, y, width - left, height, true);
+	}
+}
+
+bool DKBSPIndexSetDepth(DKBSPIndex* index, double width, double height, size_t depth)
+{
+	DKBSPIndexFree(index);
+
+	if (depth >= sizeof(size_t) * 8 - 1)
+		return false;
+
+	size_t leafCount = (size_t)1 << depth;
+
+	// a single leaf needs no splits, but malloc(0) may give NULL, so there is always room for one
+
+	index->splits = malloc(sizeof(double) * (leafCount > 1 ? leafCount - 1 : 1));
+
+	if (index->splits == NULL)
+		return false;
+
+	index->depth = depth;
+	index->leafCount = leafCount;
+	index->width = width;
+	index->height = height;
+
+	DKBSPIndexPartition(index, 0, 0, 0, width, height, true);
+	return true;
+}
+
+// a rect that straddles a split goes down both sides: the lower side by recursion, the upper by carrying on round the loop
+
+static void DKBSPIndexVisitNode(const DKBSPIndex* index, size_t node, bool acrossY, double minX, double minY, double maxX, double maxY,
+	DKBSPLeafFunction function, void* info)
+{
+	size_t firstLeaf = index->leafCount - 1;
+
+	while (node < firstLeaf) {
+		double split = index->splits[node];
+		double least = acrossY ? minY : minX;
+		double most = acrossY ? maxY : maxX;
+		size_t child = 2 * node + 1;
+
+		if (least < split) {
+			if (most >= split) {
+				DKBSPIndexVisitNode(index, child, !acrossY, minX, minY, maxX, maxY, function, info);
+				node = child + 1;
+			} else
+				node = child;
+		} else
+			node = child + 1;
+
+		acrossY = !acrossY;
+	}
+
+	function(node - firstLeaf, info);
+}
+
+void DKBSPIndexVisitRect(const DKBSPIndex* index, double x, double y, double width, double height, DKBSPLeafFunction function, void* info)
+{
+	if (DKBSPIndexIsEmpty(index))
+		return;
+
+	DKBSPIndexVisitNode(index, 0, true, x, y, x + width, y + height, function, info);
+}
+
+size_t DKBSPIndexLeafAtPoint(const DKBSPIndex* index, double x, double y)
+{
+	size_t firstLeaf = index->leafCount - 1;
+	size_t node = 0;
+	bool acrossY = true;
+
+	while (node < firstLeaf) {
+		node = 2 * node + ((acrossY ? y : x) < index->splits[node] ? 1 : 2);
+		acrossY = !acrossY;
+	}
+
+	return node - firstLeaf;
+}
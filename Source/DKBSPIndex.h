@@ -0,0 +1,60 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKBSPIndex_h
+#define DKBSPIndex_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief The partition of a canvas that DKBSPObjectStorage files its objects under.
+
+ The canvas is halved across y, each half across x, and so on alternately, <depth> times, giving 2^depth leaves of equal size. The nodes
+ form a complete binary tree held breadth first, so a node's children are at 2n + 1 and 2n + 2 and only the coordinate each node splits
+ at need be kept. Leaves are numbered from 0 in the same order. What is kept at each leaf is up to the caller: the index only finds the
+ leaves a rect or point falls in.
+
+ Like a path buffer, an index is a value that must be set up with DKBSPIndexInit() and released with DKBSPIndexFree(). Once made it is
+ only read, so it can be searched from several threads.
+ */
+typedef struct {
+	double* splits; ///< the coordinate each node other than a leaf splits at, breadth first
+	size_t depth;
+	size_t leafCount; ///< 0 until the index is set up
+	double width;
+	double height;
+} DKBSPIndex;
+
+void DKBSPIndexInit(DKBSPIndex* index);
+void DKBSPIndexFree(DKBSPIndex* index);
+
+/** @brief Partitions a canvas <depth> times, replacing any earlier partition.
+ @return false if memory ran out, when the index is left empty */
+bool DKBSPIndexSetDepth(DKBSPIndex* index, double width, double height, size_t depth);
+
+static inline bool DKBSPIndexIsEmpty(const DKBSPIndex* index)
+{
+	return index->leafCount == 0;
+}
+
+/** @brief Called for each leaf a search reaches. */
+typedef void (*DKBSPLeafFunction)(size_t leaf, void* info);
+
+/** @brief Calls <function> for every leaf a rect touches, including those it only meets along an edge. */
+void DKBSPIndexVisitRect(const DKBSPIndex* index, double x, double y, double width, double height, DKBSPLeafFunction function, void* info);
+
+/** @brief Returns the leaf a point lies in. A point on a split goes to the leaf above or right of it. The index must not be empty. */
+size_t DKBSPIndexLeafAtPoint(const DKBSPIndex* index, double x, double y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKBSPIndex_h */
@@ -6,12 +6,13 @@
 
 #import <Cocoa/Cocoa.h>
 #import "DKLinearObjectStorage.h"
+#import "DKBSPIndex.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class DKBSPIndexTree;
 
-/// node types
+/// node types. The partition itself is kept by a DKBSPIndex, whose nodes are not objects.
 typedef NS_ENUM(NSInteger, DKLeafType) {
 	kNodeHorizontal,
 	kNodeVertical,
@@ -51,6 +52,8 @@ typedef NS_ENUM(NSInteger, DKBSPOperation) {
  is the indexes of all objects that intersect the rect. Using -objectsAtIndexes: on the linear array then returns the relevant objects sorted by Z-order. The tree only
  stores the indexes of visible objects, thus it doesn't need to test for visibility - the storage will manage adding and removing indexes as object visibility changes.
 
+ the canvas is partitioned by a DKBSPIndex, which finds the leaves a rect or point falls in; this object keeps what is stored at each leaf.
+
  note that this is equivalent to a binary search in 2 dimensions. The purpose is to weed out as many irrelevant objects as possible in advance of returning them to the
  client for drawing. Internally it is tuned for speed but it relies heavily on the performance of Cocoa's NSIndexSet class, and -addIndexes: in particular. If these turn
  out to be slow, this may be detrimental to drawing performance.
@@ -58,7 +61,7 @@ typedef NS_ENUM(NSInteger, DKBSPOperation) {
 @interface DKBSPIndexTree : NSObject {
 @protected
 	NSMutableArray* mLeaves;
-	NSMutableArray* mNodes;
+	DKBSPIndex mIndex;
 	NSMutableIndexSet* mResults;
 	NSSize mCanvasSize;
 	DKBSPOperation mOp;
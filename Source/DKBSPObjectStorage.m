@@ -5,6 +5,7 @@
 */
 
 #import "DKBSPObjectStorage.h"
+#import "DKInstrumentation.h"
 #import "LogEvent.h"
 
 // utility functions:
@@ -14,11 +15,6 @@ static inline NSUInteger depthForObjectCount(NSUInteger n)
 	return (n > 0 ? MAX((NSUInteger)ceil(log((CGFloat)n)) / log(2.0), kDKMinimumDepth) : 0);
 }
 
-static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
-{
-	return (nodeIndex << 1) + 1;
-}
-
 @interface DKBSPObjectStorage ()
 
 - (void)setDepthAndLoadTree:(NSUInteger)aDepth;
@@ -54,6 +50,8 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 {
 #pragma unused(options)
 
+	DK_INSTRUMENT_SCOPE("storage", "BSP rect query");
+
 	NSIndexSet* indexes;
 
 	if (aView) {
@@ -85,11 +83,15 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 
 	//NSLog(@"returning %d object(s)", [array count]);
 
+	DK_INSTRUMENT_VALUE("storage", "BSP objects found", (int64_t)[array count]);
+
 	return array;
 }
 
 - (NSArray*)objectsContainingPoint:(NSPoint)aPoint
 {
+	DK_INSTRUMENT_SCOPE("storage", "BSP point query");
+
 	NSIndexSet* indexes = [mTree itemsIntersectingPoint:aPoint];
 
 	//NSLog(@"indexes returned for hit: %@", indexes );
@@ -308,58 +310,11 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 
 #pragma mark -
 
-@interface DKBSPNode : NSObject {
-@public
-	DKLeafType mType;
-	union {
-		CGFloat mOffset;
-		NSUInteger mIndex;
-	} u;
-}
-
-/**  */
-@property DKLeafType type;
-
-@property NSUInteger leafIndex;
-
-@property CGFloat offset;
-
-@end
-
-#pragma mark -
-
-@implementation DKBSPNode
-@synthesize type = mType;
-
-- (void)setLeafIndex:(NSUInteger)indx
-{
-	u.mIndex = indx;
-}
-
-- (NSUInteger)leafIndex
-{
-	return u.mIndex;
-}
-
-- (void)setOffset:(CGFloat)offset
-{
-	u.mOffset = offset;
-}
-
-- (CGFloat)offset
-{
-	return u.mOffset;
-}
-
-@end
-
-#pragma mark -
-
 @interface DKBSPIndexTree ()
 
-- (void)partition:(NSRect)rect depth:(NSUInteger)depth index:(NSUInteger)indx;
-- (void)recursivelySearchWithRect:(NSRect)rect index:(NSUInteger)indx;
-- (void)recursivelySearchWithPoint:(NSPoint)pt index:(NSUInteger)indx;
+- (void)appendDivisionsOfRect:(NSRect)rect depth:(NSUInteger)depth acrossY:(BOOL)acrossY;
+- (void)searchWithRect:(NSRect)rect;
+- (void)searchWithPoint:(NSPoint)pt;
 - (void)operateOnLeaf:(id)leaf;
 - (void)removeNodesAndLeaves;
 - (void)allocateLeaves:(NSUInteger)howMany;
@@ -381,7 +336,7 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 	self = [super init];
 	if (self) {
 		mCanvasSize = size;
-		mNodes = [[NSMutableArray alloc] init];
+		DKBSPIndexInit(&mIndex);
 		mLeaves = [[NSMutableArray alloc] init];
 		mResults = [[NSMutableIndexSet alloc] init];
 		mDebugPath = [[NSBezierPath alloc] init];
@@ -403,36 +358,20 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 	if (kDKMaximumDepth != 0)
 		depth = MIN(depth, kDKMaximumDepth);
 
-	NSUInteger i, nodeCount = ((1 << (depth + 1)) - 1);
-
-	// prefill the nodes array
-
-	for (i = 0; i < nodeCount; ++i) {
-		DKBSPNode* node = [[DKBSPNode alloc] init];
-		[mNodes addObject:node];
-	}
-
-	[self allocateLeaves:(1 << depth)];
-
-	NSRect canvasRect = NSZeroRect;
-	canvasRect.size = [self canvasSize];
+	if (DKBSPIndexSetDepth(&mIndex, mCanvasSize.width, mCanvasSize.height, depth))
+		[self allocateLeaves:mIndex.leafCount];
 
-	[self partition:canvasRect
-			  depth:depth
-			  index:0];
-
-	LogEvent_(kInfoEvent, @"%@ <%p> (re)inited BSP, size = %@, depth = %lu, nodes = %lu, leaves = %lu", NSStringFromClass([self class]), self, NSStringFromSize(mCanvasSize), (unsigned long)depth, (unsigned long)[mNodes count], (unsigned long)[mLeaves count]);
+	LogEvent_(kInfoEvent, @"%@ <%p> (re)inited BSP, size = %@, depth = %lu, nodes = %lu, leaves = %lu", NSStringFromClass([self class]), self, NSStringFromSize(mCanvasSize), (unsigned long)depth, (unsigned long)(mIndex.leafCount * 2 - 1), (unsigned long)[mLeaves count]);
 }
 
 - (void)insertItemIndex:(NSUInteger)idx withRect:(NSRect)rect
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return;
 
 	mOp = kDKOperationInsert;
 	mOpIndex = idx;
-	[self recursivelySearchWithRect:rect
-							  index:0];
+	[self searchWithRect:rect];
 
 	//NSLog(@"inserted index = %d, bounds = %@", idx, NSStringFromRect( rect ));
 }
@@ -440,12 +379,12 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 - (void)removeItemIndex:(NSUInteger)idx withRect:(NSRect)rect
 {
 #pragma unused(rect)
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return;
 	/*
 	mOp = kDKOperationDelete;
 	mOpIndex = idx;
-	[self recursivelySearchWithRect:rect index:0];
+	[self searchWithRect:rect];
 	 */
 
 	[self removeIndex:idx];
@@ -455,7 +394,7 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 {
 	// this may be used in conjunction with NSView's -getRectsBeingDrawn:count: to find those objects that intersect the non-rectangular update region.
 
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mOp = kDKOperationAccumulate;
@@ -464,35 +403,32 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 	NSUInteger i;
 
 	for (i = 0; i < count; ++i)
-		[self recursivelySearchWithRect:rects[i]
-								  index:0];
+		[self searchWithRect:rects[i]];
 
 	return mResults;
 }
 
 - (NSIndexSet*)itemsIntersectingRect:(NSRect)rect
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mOp = kDKOperationAccumulate;
 	[mResults removeAllIndexes];
 
-	[self recursivelySearchWithRect:rect
-							  index:0];
+	[self searchWithRect:rect];
 	return mResults;
 }
 
 - (NSIndexSet*)itemsIntersectingPoint:(NSPoint)point
 {
-	if ([mNodes count] == 0)
+	if (DKBSPIndexIsEmpty(&mIndex))
 		return nil;
 
 	mOp = kDKOperationAccumulate;
 	[mResults removeAllIndexes];
 
-	[self recursivelySearchWithPoint:point
-							   index:0];
+	[self searchWithPoint:point];
 	return mResults;
 }
 
@@ -513,7 +449,16 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 
 - (NSBezierPath*)debugStorageDivisions
 {
-	// returns a path consisting of all the BSP rect divisions
+	// returns a path consisting of all the BSP rect divisions. It's only wanted for debugging, so it's made when first asked for
+
+	if ([mDebugPath isEmpty] && !DKBSPIndexIsEmpty(&mIndex)) {
+		NSRect canvasRect = NSZeroRect;
+		canvasRect.size = [self canvasSize];
+
+		[self appendDivisionsOfRect:canvasRect
+							  depth:mIndex.depth
+							acrossY:YES];
+	}
 
 	return mDebugPath;
 }
@@ -521,171 +466,49 @@ static inline NSUInteger childNodeAtIndex(NSUInteger nodeIndex)
 #pragma mark -
 #pragma mark - private
 
-static NSUInteger sLeafCount = 0;
-
-- (void)partition:(NSRect)rect depth:(NSUInteger)depth index:(NSUInteger)indx
+- (void)appendDivisionsOfRect:(NSRect)rect depth:(NSUInteger)depth acrossY:(BOOL)acrossY
 {
-	// recursively subdivide the total canvas size into equal halves in alternating horizontal and vertical directions.
-	// This is done once when the tree is built or rebuilt.
-
-	DKBSPNode* node = [mNodes objectAtIndex:indx];
-
-	if (indx == 0) {
-		[node setType:kNodeHorizontal];
-		[node setOffset:NSMidX(rect)];
-		sLeafCount = 0;
-
-		[mDebugPath removeAllPoints];
-	}
+	// the rect of every node, halved in alternating directions just as the index partitions the canvas
 
 	[mDebugPath appendBezierPathWithRect:rect];
 
 	if (depth > 0) {
-		DKLeafType type;
 		NSRect ra, rb;
-		CGFloat oa, ob;
 
-		if ([node type] == kNodeHorizontal) {
-			type = kNodeVertical;
+		if (acrossY) {
 			ra = NSMakeRect(NSMinX(rect), NSMinY(rect), NSWidth(rect), NSHeight(rect) * 0.5);
 			rb = NSMakeRect(NSMinX(rect), NSMaxY(ra), NSWidth(rect), NSHeight(rect) - NSHeight(ra));
-			oa = NSMidX(ra);
-			ob = NSMidX(rb);
 		} else {
-			type = kNodeHorizontal;
 			ra = NSMakeRect(NSMinX(rect), NSMinY(rect), NSWidth(rect) * 0.5, NSHeight(rect));
 			rb = NSMakeRect(NSMaxX(ra), NSMinY(rect), NSWidth(rect) - NSWidth(ra), NSHeight(rect));
-			oa = NSMidY(ra);
-			ob = NSMidY(rb);
 		}
 
-		NSUInteger chIdx = childNodeAtIndex(indx);
-
-		DKBSPNode* child = [mNodes objectAtIndex:chIdx];
-		[child setType:type];
-		[child setOffset:oa];
-
-		child = [mNodes objectAtIndex:chIdx + 1];
-		[child setType:type];
-		[child setOffset:ob];
-
-		[self partition:ra
-				  depth:depth - 1
-				  index:chIdx];
-		[self partition:rb
-				  depth:depth - 1
-				  index:chIdx + 1];
-	} else {
-		[node setType:kNodeLeaf];
-		[node setLeafIndex:sLeafCount++];
+		[self appendDivisionsOfRect:ra
+							  depth:depth - 1
+							acrossY:!acrossY];
+		[self appendDivisionsOfRect:rb
+							  depth:depth - 1
+							acrossY:!acrossY];
 	}
 }
 
-	// if set to 1, recursive function avoids obj-C message dispatch for slightly more performance
-
-#define qUseImpCaching 1
-
-- (void)recursivelySearchWithRect:(NSRect)rect index:(NSUInteger)indx
-{
-#if qUseImpCaching
-	static void (*sfunc)(id, SEL, NSRect, NSUInteger) = nil;
-
-	if (sfunc == nil)
-		sfunc = (void (*)(id, SEL, NSRect, NSUInteger))[[self class] instanceMethodForSelector:_cmd];
-#endif
-
-	DKBSPNode* node = [mNodes objectAtIndex:indx];
-	NSUInteger subnode = childNodeAtIndex(indx);
-
-	switch (node->mType) {
-	case kNodeHorizontal:
-		if (NSMinY(rect) < node->u.mOffset) {
-#if qUseImpCaching
-			sfunc(self, _cmd, rect, subnode);
-#else
-			[self recursivelySearchWithRect:rect
-									  index:subnode];
-#endif
-			if (NSMaxY(rect) >= node->u.mOffset)
-#if qUseImpCaching
-				sfunc(self, _cmd, rect, subnode + 1);
-#else
-				[self recursivelySearchWithRect:rect
-										  index:subnode + 1];
-#endif
-		} else
-#if qUseImpCaching
-			sfunc(self, _cmd, rect, subnode + 1);
-#else
-			[self recursivelySearchWithRect:rect
-									  index:subnode + 1];
-#endif
-		break;
-
-	case kNodeVertical:
-		if (NSMinX(rect) < node->u.mOffset) {
-#if qUseImpCaching
-			sfunc(self, _cmd, rect, subnode);
-#else
-			[self recursivelySearchWithRect:rect
-									  index:subnode];
-#endif
-			if (NSMaxX(rect) >= node->u.mOffset)
-#if qUseImpCaching
-				sfunc(self, _cmd, rect, subnode + 1);
-#else
-				[self recursivelySearchWithRect:rect
-										  index:subnode + 1];
-#endif
-		} else
-#if qUseImpCaching
-			sfunc(self, _cmd, rect, subnode + 1);
-#else
-			[self recursivelySearchWithRect:rect
-									  index:subnode + 1];
-#endif
-		break;
+// the index finds the leaves, and the tree does the current operation on what is kept at each one
 
-	case kNodeLeaf:
-		[self operateOnLeaf:[mLeaves objectAtIndex:node->u.mIndex]];
-		break;
+static void operateOnLeafFunc(size_t leaf, void* context)
+{
+	DKBSPIndexTree* tree = (__bridge DKBSPIndexTree*)context;
 
-	default:
-		break;
-	}
+	[tree operateOnLeaf:[tree->mLeaves objectAtIndex:leaf]];
 }
 
-- (void)recursivelySearchWithPoint:(NSPoint)pt index:(NSUInteger)indx
+- (void)searchWithRect:(NSRect)rect
 {
-	DKBSPNode* node = [mNodes objectAtIndex:indx];
-	NSUInteger subnode = childNodeAtIndex(indx);
-
-	switch ([node type]) {
-	case kNodeLeaf:
-		[self operateOnLeaf:[mLeaves objectAtIndex:[node leafIndex]]];
-		break;
-
-	case kNodeVertical:
-		if (pt.x < [node offset])
-			[self recursivelySearchWithPoint:pt
-									   index:subnode];
-		else
-			[self recursivelySearchWithPoint:pt
-									   index:subnode + 1];
-		break;
-
-	case kNodeHorizontal:
-		if (pt.y < [node offset])
-			[self recursivelySearchWithPoint:pt
-									   index:subnode];
-		else
-			[self recursivelySearchWithPoint:pt
-									   index:subnode + 1];
-		break;
+	DKBSPIndexVisitRect(&mIndex, NSMinX(rect), NSMinY(rect), NSWidth(rect), NSHeight(rect), operateOnLeafFunc, (__bridge void*)self);
+}
 
-	default:
-		break;
-	}
+- (void)searchWithPoint:(NSPoint)pt
+{
+	[self operateOnLeaf:[mLeaves objectAtIndex:DKBSPIndexLeafAtPoint(&mIndex, pt.x, pt.y)]];
 }
 
 - (void)operateOnLeaf:(id)leaf
@@ -712,8 +535,9 @@ static NSUInteger sLeafCount = 0;
 
 - (void)removeNodesAndLeaves
 {
-	[mNodes removeAllObjects];
+	DKBSPIndexFree(&mIndex);
 	[mLeaves removeAllObjects];
+	[mDebugPath removeAllPoints];
 }
 
 - (void)allocateLeaves:(NSUInteger)howMany
@@ -737,6 +561,11 @@ static NSUInteger sLeafCount = 0;
 #pragma mark -
 #pragma mark - as a NSObject
 
+- (void)dealloc
+{
+	DKBSPIndexFree(&mIndex);
+}
+
 - (NSString*)description
 {
 	// warning: description string can be very large, as it enumerates the leaves
@@ -0,0 +1,572 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKBenchmark.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCHMARK_DEEP_GROUP_DEPTH 6
+#define BENCHMARK_OBJECTS_PER_CLUSTER 500
+
+struct DKBenchmarkSuite {
+	DKBenchmarkOptions options;
+	DKBenchmarkResult* results;
+	size_t resultCount;
+	size_t resultCapacity;
+	DKBenchmarkResult* baseline;
+	size_t baselineCount;
+	double* samples;
+	size_t sampleCapacity;
+};
+
+#pragma mark - allocation counting
+
+static _Atomic(uint64_t) sAllocationCount = 0;
+static _Atomic(uint64_t) sAllocatedBytes = 0;
+
+#ifdef DK_BENCHMARK_WRAP_MALLOC
+
+// linked with --wrap=malloc and friends, calls to them from the other objects come here first
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+	atomic_fetch_add_explicit(&sAllocationCount, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&sAllocatedBytes, size, memory_order_relaxed);
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+	atomic_fetch_add_explicit(&sAllocationCount, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&sAllocatedBytes, count * size, memory_order_relaxed);
+	return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+	atomic_fetch_add_explicit(&sAllocationCount, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&sAllocatedBytes, size, memory_order_relaxed);
+	return __real_realloc(ptr, size);
+}
+
+bool DKBenchmarkCountsAllocations(void)
+{
+	return true;
+}
+
+#else
+
+bool DKBenchmarkCountsAllocations(void)
+{
+	return false;
+}
+
+#endif
+
+void DKBenchmarkGetAllocations(uint64_t* count, uint64_t* bytes)
+{
+	*count = atomic_load_explicit(&sAllocationCount, memory_order_relaxed);
+	*bytes = atomic_load_explicit(&sAllocatedBytes, memory_order_relaxed);
+}
+
+#pragma mark - generators
+
+uint64_t DKBenchmarkRandom(uint64_t* state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+double DKBenchmarkRandomUnit(uint64_t* state)
+{
+	return (DKBenchmarkRandom(state) >> 11) * 0x1.0p-53;
+}
+
+static double DKBenchmarkRandomRange(uint64_t* state, double lo, double hi)
+{
+	return lo + (hi - lo) * DKBenchmarkRandomUnit(state);
+}
+
+static double DKBenchmarkRandomGaussian(uint64_t* state)
+{
+	double u = DKBenchmarkRandomUnit(state);
+	double v = DKBenchmarkRandomUnit(state);
+
+	return sqrt(-2.0 * log(1.0 - u)) * cos(2.0 * M_PI * v);
+}
+
+const char* DKBenchmarkDistributionName(DKBenchmarkDistribution distribution)
+{
+	switch (distribution) {
+	case kDKBenchmarkUniform:
+		return "uniform";
+	case kDKBenchmarkClustered:
+		return "clustered";
+	case kDKBenchmarkDenseOverlap:
+		return "dense-overlap";
+	case kDKBenchmarkDeepGroup:
+		return "deep-group";
+	}
+
+	return "unknown";
+}
+
+// sets a rect of the given size centred on a point, moved inside the canvas
+
+static void DKBenchmarkPlaceRect(DKBenchmarkRect* r, double cx, double cy, double w, double h, double width, double height)
+{
+	w = fmin(w, width);
+	h = fmin(h, height);
+	r->width = w;
+	r->height = h;
+	r->x = fmin(fmax(cx - w * 0.5, 0), width - w);
+	r->y = fmin(fmax(cy - h * 0.5, 0), height - h);
+	r->group = 0;
+	r->depth = 0;
+}
+
+void DKBenchmarkGenerateRects(DKBenchmarkDistribution distribution, size_t count, double width, double height, uint64_t seed, DKBenchmarkRect* rects)
+{
+	uint64_t state = seed;
+	double side = sqrt(width * height / (double)(count ? count : 1));
+	size_t i;
+
+	switch (distribution) {
+	default:
+	case kDKBenchmarkUniform:
+		for (i = 0; i < count; ++i) {
+			double s = side * DKBenchmarkRandomRange(&state, 0.25, 1.0);
+			double a = exp(DKBenchmarkRandomRange(&state, -0.7, 0.7));
+
+			DKBenchmarkPlaceRect(&rects[i], DKBenchmarkRandomUnit(&state) * width, DKBenchmarkRandomUnit(&state) * height, s * a, s / a, width, height);
+		}
+		break;
+
+	case kDKBenchmarkClustered: {
+		size_t clusters = count / BENCHMARK_OBJECTS_PER_CLUSTER + 1;
+		double spread = fmin(width, height) * 0.02;
+		double* centres = malloc(clusters * 2 * sizeof(double));
+
+		for (i = 0; i < clusters; ++i) {
+			centres[i * 2] = DKBenchmarkRandomUnit(&state) * width;
+			centres[i * 2 + 1] = DKBenchmarkRandomUnit(&state) * height;
+		}
+
+		for (i = 0; i < count; ++i) {
+			size_t c = DKBenchmarkRandom(&state) % clusters;
+			double s = side * DKBenchmarkRandomRange(&state, 0.1, 0.5);
+
+			DKBenchmarkPlaceRect(&rects[i], centres[c * 2] + DKBenchmarkRandomGaussian(&state) * spread,
+				centres[c * 2 + 1] + DKBenchmarkRandomGaussian(&state) * spread, s, s, width, height);
+		}
+
+		free(centres);
+		break;
+	}
+
+	case kDKBenchmarkDenseOverlap: {
+		double m = fmin(width, height);
+
+		for (i = 0; i < count; ++i) {
+			double cx = width * DKBenchmarkRandomRange(&state, 0.45, 0.55);
+			double cy = height * DKBenchmarkRandomRange(&state, 0.45, 0.55);
+
+			DKBenchmarkPlaceRect(&rects[i], cx, cy, m * DKBenchmarkRandomRange(&state, 0.05, 0.2), m * DKBenchmarkRandomRange(&state, 0.05, 0.2), width,
+				height);
+		}
+		break;
+	}
+
+	case kDKBenchmarkDeepGroup: {
+		// each object's group at each level is found from its index, so consecutive objects share groups, and each group's box is chosen by
+		// hashing its level and index, so every object in it agrees on where it is
+
+		unsigned depth = BENCHMARK_DEEP_GROUP_DEPTH;
+		size_t branching = (size_t)ceil(pow((double)(count ? count : 1), 1.0 / depth));
+		size_t leaves = 1;
+		unsigned level;
+
+		if (branching < 2)
+			branching = 2;
+
+		for (level = 0; level < depth; ++level)
+			leaves *= branching;
+
+		for (i = 0; i < count; ++i) {
+			double bx = 0, by = 0, bw = width, bh = height;
+			size_t levelStart = 0, levelSize = 1, span = leaves, index = 0;
+
+			for (level = 1; level <= depth; ++level) {
+				levelStart += levelSize;
+				levelSize *= branching;
+				span /= branching;
+				index = i / span;
+
+				uint64_t groupState = seed ^ ((uint64_t)level << 56) ^ (index * 0x9E3779B97F4A7C15ull);
+
+				bx += DKBenchmarkRandomUnit(&groupState) * bw * 2.0 / 3.0;
+				by += DKBenchmarkRandomUnit(&groupState) * bh * 2.0 / 3.0;
+				bw /= 3.0;
+				bh /= 3.0;
+			}
+
+			double w = bw * DKBenchmarkRandomRange(&state, 0.2, 0.6);
+			double h = bh * DKBenchmarkRandomRange(&state, 0.2, 0.6);
+
+			rects[i].x = bx + DKBenchmarkRandomUnit(&state) * (bw - w);
+			rects[i].y = by + DKBenchmarkRandomUnit(&state) * (bh - h);
+			rects[i].width = w;
+			rects[i].height = h;
+			rects[i].group = levelStart + index;
+			rects[i].depth = depth;
+		}
+		break;
+	}
+	}
+}
+
+#pragma mark - running
+
+double DKBenchmarkTime(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+DKBenchmarkOptions DKBenchmarkDefaultOptions(void)
+{
+	DKBenchmarkOptions options;
+
+	options.warmups = 1;
+	options.samples = 15;
+	options.timeLimit = 10.0;
+	options.scale = 1.0;
+	options.filter = NULL;
+
+	return options;
+}
+
+DKBenchmarkSuite* DKBenchmarkSuiteCreate(const DKBenchmarkOptions* options)
+{
+	DKBenchmarkSuite* suite = calloc(1, sizeof(DKBenchmarkSuite));
+
+	if (suite)
+		suite->options = options ? *options : DKBenchmarkDefaultOptions();
+
+	return suite;
+}
+
+void DKBenchmarkSuiteFree(DKBenchmarkSuite* suite)
+{
+	if (suite) {
+		free(suite->results);
+		free(suite->baseline);
+		free(suite->samples);
+		free(suite);
+	}
+}
+
+const DKBenchmarkOptions* DKBenchmarkSuiteOptions(const DKBenchmarkSuite* suite)
+{
+	return &suite->options;
+}
+
+size_t DKBenchmarkSuiteScaledSize(const DKBenchmarkSuite* suite, size_t size)
+{
+	double scaled = floor(size * suite->options.scale + 0.5);
+
+	return scaled < 1 ? 1 : (size_t)scaled;
+}
+
+bool DKBenchmarkSuiteWants(const DKBenchmarkSuite* suite, const char* name, const char* variant)
+{
+	const char* filter = suite->options.filter;
+
+	if (filter == NULL || *filter == 0)
+		return true;
+
+	return strstr(name, filter) != NULL || (variant && strstr(variant, filter) != NULL);
+}
+
+static int DKBenchmarkCompareDoubles(const void* a, const void* b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+DKBenchmarkResult* DKBenchmarkSuiteRun(DKBenchmarkSuite* suite, const char* name, const char* variant, size_t size, DKBenchmarkSetupFunction setup,
+	DKBenchmarkFunction body, void* context)
+{
+	if (!DKBenchmarkSuiteWants(suite, name, variant))
+		return NULL;
+
+	const DKBenchmarkOptions* options = &suite->options;
+	size_t i, n = options->samples ? options->samples : 1;
+
+	if (suite->resultCount == suite->resultCapacity) {
+		size_t capacity = suite->resultCapacity ? suite->resultCapacity * 2 : 32;
+		DKBenchmarkResult* results = realloc(suite->results, capacity * sizeof(DKBenchmarkResult));
+
+		if (results == NULL)
+			return NULL;
+
+		suite->results = results;
+		suite->resultCapacity = capacity;
+	}
+
+	if (suite->sampleCapacity < n) {
+		double* samples = realloc(suite->samples, n * sizeof(double));
+
+		if (samples == NULL)
+			return NULL;
+
+		suite->samples = samples;
+		suite->sampleCapacity = n;
+	}
+
+	for (i = 0; i < options->warmups; ++i) {
+		if (setup)
+			setup(context);
+		body(context);
+	}
+
+	// allocations are counted over the timed runs only, not their setup
+
+	uint64_t allocations = 0, bytes = 0, a0, b0, a1, b1;
+	double spent = 0;
+	size_t taken = 0;
+
+	while (taken < n) {
+		if (setup)
+			setup(context);
+
+		DKBenchmarkGetAllocations(&a0, &b0);
+		double start = DKBenchmarkTime();
+		body(context);
+		double elapsed = DKBenchmarkTime() - start;
+		DKBenchmarkGetAllocations(&a1, &b1);
+
+		allocations += a1 - a0;
+		bytes += b1 - b0;
+		suite->samples[taken++] = elapsed;
+		spent += elapsed;
+
+		if (taken >= 3 && spent > options->timeLimit)
+			break;
+	}
+
+	qsort(suite->samples, taken, sizeof(double), DKBenchmarkCompareDoubles);
+
+	DKBenchmarkResult* r = &suite->results[suite->resultCount++];
+
+	memset(r, 0, sizeof(DKBenchmarkResult));
+	snprintf(r->name, sizeof(r->name), "%s", name);
+	snprintf(r->variant, sizeof(r->variant), "%s", variant ? variant : "");
+	r->size = size;
+	r->samples = taken;
+	r->median = (taken & 1) ? suite->samples[taken / 2] : (suite->samples[taken / 2 - 1] + suite->samples[taken / 2]) * 0.5;
+	r->p95 = suite->samples[(size_t)ceil(0.95 * taken) - 1];
+	r->min = suite->samples[0];
+	r->mean = spent / taken;
+	r->allocations = DKBenchmarkCountsAllocations() ? (double)allocations / taken : -1;
+	r->bytes = DKBenchmarkCountsAllocations() ? (double)bytes / taken : -1;
+	r->metric = NAN;
+
+	return r;
+}
+
+size_t DKBenchmarkSuiteResultCount(const DKBenchmarkSuite* suite)
+{
+	return suite->resultCount;
+}
+
+const DKBenchmarkResult* DKBenchmarkSuiteResult(const DKBenchmarkSuite* suite, size_t index)
+{
+	return index < suite->resultCount ? &suite->results[index] : NULL;
+}
+
+#pragma mark - baselines and reports
+
+// the variant is written as "-" when empty so that every line has the same number of fields
+
+bool DKBenchmarkSuiteWriteResults(const DKBenchmarkSuite* suite, const char* path)
+{
+	FILE* file = fopen(path, "w");
+	size_t i;
+
+	if (file == NULL)
+		return false;
+
+	fprintf(file, "# name\tvariant\tsize\tsamples\tmedian\tp95\tmin\tmean\tallocations\tbytes\tmetric\tmetric name\n");
+
+	for (i = 0; i < suite->resultCount; ++i) {
+		const DKBenchmarkResult* r = &suite->results[i];
+
+		fprintf(file, "%s\t%s\t%zu\t%zu\t%.9g\t%.9g\t%.9g\t%.9g\t%.9g\t%.9g\t%.9g\t%s\n", r->name, r->variant[0] ? r->variant : "-", r->size, r->samples,
+			r->median, r->p95, r->min, r->mean, r->allocations, r->bytes, r->metric, r->metricName[0] ? r->metricName : "-");
+	}
+
+	return fclose(file) == 0;
+}
+
+bool DKBenchmarkSuiteLoadBaseline(DKBenchmarkSuite* suite, const char* path)
+{
+	FILE* file = fopen(path, "r");
+	char line[512];
+	size_t capacity = 0;
+
+	if (file == NULL)
+		return false;
+
+	suite->baselineCount = 0;
+
+	while (fgets(line, sizeof(line), file)) {
+		char* fields[12];
+		char* save = NULL;
+		char* field = strtok_r(line, "\t\n", &save);
+		size_t n = 0;
+
+		while (field && n < 12) {
+			fields[n++] = field;
+			field = strtok_r(NULL, "\t\n", &save);
+		}
+
+		if (n < 12 || fields[0][0] == '#')
+			continue;
+
+		if (suite->baselineCount == capacity) {
+			size_t newCapacity = capacity ? capacity * 2 : 32;
+			DKBenchmarkResult* baseline = realloc(suite->baseline, newCapacity * sizeof(DKBenchmarkResult));
+
+			if (baseline == NULL)
+				break;
+
+			suite->baseline = baseline;
+			capacity = newCapacity;
+		}
+
+		DKBenchmarkResult* r = &suite->baseline[suite->baselineCount++];
+
+		memset(r, 0, sizeof(DKBenchmarkResult));
+		snprintf(r->name, sizeof(r->name), "%s", fields[0]);
+		snprintf(r->variant, sizeof(r->variant), "%s", strcmp(fields[1], "-") ? fields[1] : "");
+		r->size = (size_t)strtoull(fields[2], NULL, 10);
+		r->samples = (size_t)strtoull(fields[3], NULL, 10);
+		r->median = strtod(fields[4], NULL);
+		r->p95 = strtod(fields[5], NULL);
+		r->min = strtod(fields[6], NULL);
+		r->mean = strtod(fields[7], NULL);
+		r->allocations = strtod(fields[8], NULL);
+		r->bytes = strtod(fields[9], NULL);
+		r->metric = strtod(fields[10], NULL);
+		snprintf(r->metricName, sizeof(r->metricName), "%s", strcmp(fields[11], "-") ? fields[11] : "");
+	}
+
+	fclose(file);
+	return true;
+}
+
+const DKBenchmarkResult* DKBenchmarkSuiteBaselineFor(const DKBenchmarkSuite* suite, const DKBenchmarkResult* result)
+{
+	size_t i;
+
+	for (i = 0; i < suite->baselineCount; ++i) {
+		const DKBenchmarkResult* b = &suite->baseline[i];
+
+		if (b->size == result->size && strcmp(b->name, result->name) == 0 && strcmp(b->variant, result->variant) == 0)
+			return b;
+	}
+
+	return NULL;
+}
+
+bool DKBenchmarkSuiteResultRegressed(const DKBenchmarkSuite* suite, const DKBenchmarkResult* result, double tolerance)
+{
+	const DKBenchmarkResult* b = DKBenchmarkSuiteBaselineFor(suite, result);
+
+	if (b == NULL || b->median <= 0)
+		return false;
+
+	if (result->median > b->median * (1.0 + tolerance))
+		return true;
+
+	// allocation counts are near enough exact, so half an allocation is allowed only for rounding
+	return result->allocations >= 0 && b->allocations >= 0 && result->allocations > b->allocations * (1.0 + tolerance) + 0.5;
+}
+
+static void DKBenchmarkFormatTime(char* buffer, size_t length, double seconds)
+{
+	if (seconds < 1.0e-6)
+		snprintf(buffer, length, "%.1fns", seconds * 1.0e9);
+	else if (seconds < 1.0e-3)
+		snprintf(buffer, length, "%.2fus", seconds * 1.0e6);
+	else if (seconds < 1.0)
+		snprintf(buffer, length, "%.2fms", seconds * 1.0e3);
+	else
+		snprintf(buffer, length, "%.3fs", seconds);
+}
+
+size_t DKBenchmarkSuiteReport(const DKBenchmarkSuite* suite, double tolerance, FILE* file)
+{
+	size_t i, regressions = 0;
+	char median[24], p95[24], allocs[24], metric[48], base[24], change[32];
+
+	if (file)
+		fprintf(file, "%-28s %-16s %9s %10s %10s %10s  %-22s %10s %s\n", "benchmark", "variant", "size", "median", "p95", "allocs", "metric", "baseline",
+			"change");
+
+	for (i = 0; i < suite->resultCount; ++i) {
+		const DKBenchmarkResult* r = &suite->results[i];
+		const DKBenchmarkResult* b = DKBenchmarkSuiteBaselineFor(suite, r);
+		bool regressed = false;
+
+		DKBenchmarkFormatTime(median, sizeof(median), r->median);
+		DKBenchmarkFormatTime(p95, sizeof(p95), r->p95);
+
+		if (r->allocations >= 0)
+			snprintf(allocs, sizeof(allocs), "%.0f", r->allocations);
+		else
+			snprintf(allocs, sizeof(allocs), "-");
+
+		if (!isnan(r->metric))
+			snprintf(metric, sizeof(metric), "%s=%.6g", r->metricName, r->metric);
+		else
+			snprintf(metric, sizeof(metric), "-");
+
+		if (b && b->median > 0) {
+			double ratio = r->median / b->median;
+
+			regressed = DKBenchmarkSuiteResultRegressed(suite, r, tolerance);
+			DKBenchmarkFormatTime(base, sizeof(base), b->median);
+			snprintf(change, sizeof(change), "%+.1f%%%s", (ratio - 1.0) * 100.0, regressed ? " REGRESSED" : "");
+		} else {
+			snprintf(base, sizeof(base), "-");
+			change[0] = 0;
+		}
+
+		if (regressed)
+			++regressions;
+
+		if (file)
+			fprintf(file, "%-28s %-16s %9zu %10s %10s %10s  %-22s %10s %s\n", r->name, r->variant[0] ? r->variant : "-", r->size, median, p95, allocs, metric,
+				base, change);
+	}
+
+	return regressions;
+}
@@ -0,0 +1,145 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKBenchmark_h
+#define DKBenchmark_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief How the synthetic drawings made by DKBenchmarkGenerateRects() are laid out. */
+typedef enum {
+	kDKBenchmarkUniform = 0, ///< objects spread evenly over the canvas
+	kDKBenchmarkClustered = 1, ///< objects gathered tightly around one point for every 500 objects
+	kDKBenchmarkDenseOverlap = 2, ///< large objects piled up in the middle of the canvas, nearly all overlapping
+	kDKBenchmarkDeepGroup = 3 ///< objects in groups nested several deep, each group inside a third of its parent
+} DKBenchmarkDistribution;
+
+#define kDKBenchmarkDistributionCount 4
+
+/** @brief The bounds of one synthetic object. */
+typedef struct {
+	double x, y, width, height;
+	size_t group; ///< for deep groups, the innermost group the object is in, numbered across all levels; otherwise 0
+	unsigned depth; ///< for deep groups, how many groups the object is nested in; otherwise 0
+} DKBenchmarkRect;
+
+const char* DKBenchmarkDistributionName(DKBenchmarkDistribution distribution);
+
+/** @brief Lays out <count> objects on a canvas. The same seed always gives the same objects. */
+void DKBenchmarkGenerateRects(DKBenchmarkDistribution distribution, size_t count, double width, double height, uint64_t seed, DKBenchmarkRect* rects);
+
+/** @brief Returns the next value of a splitmix64 sequence. */
+uint64_t DKBenchmarkRandom(uint64_t* state);
+
+/** @brief Returns a value in [0, 1) from a splitmix64 sequence. */
+double DKBenchmarkRandomUnit(uint64_t* state);
+
+/** @brief Returns a monotonic time in seconds. */
+double DKBenchmarkTime(void);
+
+/** @brief Whether this build counts allocations. They are counted where the benchmark is linked with malloc, calloc and realloc wrapped. */
+bool DKBenchmarkCountsAllocations(void);
+
+/** @brief The number of allocations, and bytes requested by them, since the program started. Both are 0 if not counted. */
+void DKBenchmarkGetAllocations(uint64_t* count, uint64_t* bytes);
+
+#pragma mark -
+
+/** @brief The measurements of one benchmark. Times are in seconds for one sample. */
+typedef struct {
+	char name[64];
+	char variant[32]; ///< the distribution, algorithm or setting being compared, or empty
+	size_t size; ///< the number of objects, points or segments
+	size_t samples;
+	double median;
+	double p95;
+	double min;
+	double mean;
+	double allocations; ///< per sample, or -1 if not counted
+	double bytes; ///< allocated per sample, or -1 if not counted
+	double metric; ///< a figure of merit the benchmark reports, such as an error or a tour length, or NAN
+	char metricName[24];
+} DKBenchmarkResult;
+
+typedef struct {
+	size_t warmups; ///< untimed runs before sampling. Default 1.
+	size_t samples; ///< timed runs. Default 15.
+	double timeLimit; ///< sampling stops early once this many seconds have been spent, after at least 3 samples. Default 10.
+	double scale; ///< a factor for benchmarks to scale their sizes by. Default 1.
+	const char* filter; ///< if set, only benchmarks whose name or variant contains this are run
+} DKBenchmarkOptions;
+
+DKBenchmarkOptions DKBenchmarkDefaultOptions(void);
+
+/** @brief Runs before each run of a benchmark, untimed, to set up what the run uses up. */
+typedef void (*DKBenchmarkSetupFunction)(void* context);
+
+/** @brief One run of a benchmark. */
+typedef void (*DKBenchmarkFunction)(void* context);
+
+/** @brief Runs benchmarks, collects their results and compares them with a baseline. */
+typedef struct DKBenchmarkSuite DKBenchmarkSuite;
+
+DKBenchmarkSuite* DKBenchmarkSuiteCreate(const DKBenchmarkOptions* options);
+void DKBenchmarkSuiteFree(DKBenchmarkSuite* suite);
+
+const DKBenchmarkOptions* DKBenchmarkSuiteOptions(const DKBenchmarkSuite* suite);
+
+/** @brief Returns <size> multiplied by the suite's scale, at least 1. */
+size_t DKBenchmarkSuiteScaledSize(const DKBenchmarkSuite* suite, size_t size);
+
+/** @brief Returns whether a benchmark passes the suite's filter, so its setup can be skipped if not. */
+bool DKBenchmarkSuiteWants(const DKBenchmarkSuite* suite, const char* name, const char* variant);
+
+/** @brief Runs a benchmark and records its result.
+ @param suite the suite
+ @param name the benchmark's name
+ @param variant what is being compared, or NULL
+ @param size the number of objects, points or segments it works on
+ @param setup a function to run before each run, untimed, or NULL
+ @param body the function timed
+ @param context passed to both functions
+ @return the result, which stays valid until the next run, or NULL if the benchmark was filtered out
+ */
+DKBenchmarkResult* DKBenchmarkSuiteRun(DKBenchmarkSuite* suite, const char* name, const char* variant, size_t size, DKBenchmarkSetupFunction setup,
+	DKBenchmarkFunction body, void* context);
+
+size_t DKBenchmarkSuiteResultCount(const DKBenchmarkSuite* suite);
+const DKBenchmarkResult* DKBenchmarkSuiteResult(const DKBenchmarkSuite* suite, size_t index);
+
+/** @brief Reads a baseline written by DKBenchmarkSuiteWriteResults(). Returns false if the file can't be read. */
+bool DKBenchmarkSuiteLoadBaseline(DKBenchmarkSuite* suite, const char* path);
+
+/** @brief Returns the baseline result matching a result's name, variant and size, or NULL. */
+const DKBenchmarkResult* DKBenchmarkSuiteBaselineFor(const DKBenchmarkSuite* suite, const DKBenchmarkResult* result);
+
+/** @brief Writes the results as tab-separated text, which can be loaded as a baseline. */
+bool DKBenchmarkSuiteWriteResults(const DKBenchmarkSuite* suite, const char* path);
+
+/** @brief Returns whether a result is slower than its baseline, or makes more allocations, by more than <tolerance> as a fraction. A result with
+ no baseline has not regressed. */
+bool DKBenchmarkSuiteResultRegressed(const DKBenchmarkSuite* suite, const DKBenchmarkResult* result, double tolerance);
+
+/** @brief Prints the results as a table, with the change from the baseline where there is one.
+ @param suite the suite
+ @param tolerance how much slower, or how many more allocations, as a fraction, counts as a regression
+ @param file where to print, or NULL for none
+ @return the number of regressions
+ */
+size_t DKBenchmarkSuiteReport(const DKBenchmarkSuite* suite, double tolerance, FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKBenchmark_h */
@@ -5,6 +5,7 @@
  */
 
 #import "DKBezierLayoutManager.h"
+#import "DKTextLayoutCache.h"
 
 @implementation DKBezierLayoutManager
 @synthesize textPath = mPath;
@@ -26,6 +27,7 @@
 	if (aSize)
 		*aSize = [self usedRectForTextContainer:container].size;
 
+	DKTextLayoutCache* outlines = [DKTextLayoutCache sharedTextLayoutCache];
 	NSBezierPath* temp;
 	NSRect fragRect;
 	NSRange grange;
@@ -45,7 +47,6 @@
 												  effectiveRange:&grange];
 
 				for (g = grange.location; g < grange.location + grange.length; ++g) {
-					temp = [NSBezierPath bezierPath];
 					ploc = gloc = [self locationForGlyphAtIndex:g];
 
 					ploc.x -= fragRect.origin.x;
@@ -54,9 +55,10 @@
 					font = [[[self textStorage] attributesAtIndex:g
 												   effectiveRange:NULL] objectForKey:NSFontAttributeName];
 
-					[temp moveToPoint:ploc];
-					[temp appendBezierPathWithGlyph:[self glyphAtIndex:g]
-											 inFont:font];
+					// glyph outlines are shared and have their origin at 0,0, so copy and move into place.
+
+					temp = [[outlines outlineForGlyph:[self glyphAtIndex:g]
+											   inFont:font] copy];
 
 					// need to vertically flip and offset each glyph as it is created. The glyph is flipped around its given location to
 					// ensure that any unusual baseline requirements are taken into consideration.
@@ -66,8 +68,6 @@
 									yBy:ploc.y];
 					[xform scaleXBy:1.0
 								yBy:-1.0];
-					[xform translateXBy:-ploc.x
-									yBy:-ploc.y];
 					[temp transformUsingAffineTransform:xform];
 
 					[array addObject:temp];
@@ -52,6 +52,11 @@
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"filter", @"arguments"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"filter", @"arguments"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -302,7 +302,7 @@ static id sDearchivingHelper = nil;
 
 - (BOOL)containsKey:(NSString*)key
 {
-	return [[m_masterList allKeys] containsObject:[key lowercaseString]];
+	return [m_masterList objectForKey:[key lowercaseString]] != nil;
 }
 
 - (NSUInteger)count
@@ -8,6 +8,26 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/** @brief Describes a buffer of 8-bit pixels whose red, green and blue samples are consecutive bytes.
+
+ The quantizers read pixels directly from such a buffer rather than through \c NSBitmapImageRep accessors. Any alpha is ignored.
+ */
+typedef struct {
+	const uint8_t* data; ///< the first byte of the first row
+	NSUInteger width; ///< in pixels
+	NSUInteger height; ///< in pixels
+	NSUInteger bytesPerRow;
+	NSUInteger bytesPerPixel; ///< 3 or 4
+	NSUInteger redOffset; ///< offset of the red sample within each pixel - 0 for RGB or RGBA, 1 for ARGB
+} DKPixelBuffer;
+
+/** @brief Describes the pixels of a bitmap, if they are meshed 8-bit RGB or RGBA.
+ @param rep the bitmap
+ @param buffer receives the description
+ @return YES if the bitmap's pixels can be read directly, NO otherwise
+ */
+FOUNDATION_EXTERN BOOL DKPixelBufferFromBitmapImageRep(NSBitmapImageRep* rep, DKPixelBuffer* buffer);
+
 /** @brief generic interface and simple quantizer which performs uniform quantization.
 
  Results with this quantizer are generally only barely acceptable - colours may be mapped
@@ -20,6 +40,7 @@ NS_ASSUME_NONNULL_BEGIN
 	NSUInteger m_nBits;
 	NSSize m_imageSize;
 	NSMutableArray<NSColor*>* m_cTable;
+	uint8_t* _Nullable m_nearestTable; // nearest palette index for each 15-bit colour, built on demand
 }
 
 - (instancetype)initWithBitmapImageRep:(NSBitmapImageRep*)rep maxColours:(NSUInteger)maxColours colourBits:(NSUInteger)nBits;
@@ -28,8 +49,31 @@ NS_ASSUME_NONNULL_BEGIN
 @property (readonly, strong) NSArray<NSColor*>* colourTable;
 @property (readonly) NSUInteger numberOfColours;
 
+/** @brief Analyses the pixels of a bitmap.
+
+ Bitmaps that are not meshed 8-bit RGB are first converted. Subclasses should override \c -analysePixelBuffer: rather than this.
+ */
 - (void)analyse:(NSBitmapImageRep*)rep;
 
+/** @brief Analyses the pixels in a buffer, building the palette. The uniform quantizer does nothing here.
+ */
+- (void)analysePixelBuffer:(DKPixelBuffer)buffer;
+
+/** @brief Returns the index of the palette colour nearest to a colour.
+
+ The answer comes from a table covering every 15-bit colour, built the first time it is needed, so it may differ from the exact nearest
+ colour by the rounding to 15 bits.
+ @param rgb the colour, with components in the range 0..255
+ @return the palette index
+ */
+- (NSUInteger)nearestIndexForRGB:(const NSUInteger[_Nonnull 3])rgb;
+
+/** @brief Maps every pixel in a buffer to the index of its nearest palette colour. Rows are mapped concurrently.
+ @param buffer the pixels
+ @param indexes receives one index per pixel, <buffer.width> per row
+ */
+- (void)mapPixelBuffer:(DKPixelBuffer)buffer toIndexes:(uint8_t*)indexes;
+
 @end
 
 #pragma mark -
@@ -37,6 +81,10 @@ NS_ASSUME_NONNULL_BEGIN
 // octree quantizer which does a much better job
 // this code is mostly a port of CQuantizer (c)  1996-1997 Jeff Prosise
 
+// nodes are allocated from blocks of this many, and reduced nodes are reused rather than freed
+
+#define kDKOctreeNodeBlockSize 1024
+
 typedef struct _NODE {
 	BOOL bIsLeaf; // YES if node has no children
 	NSUInteger nPixelCount; // Number of pixels represented by this leaf
@@ -58,12 +106,19 @@ typedef struct _rgb_triple {
 /** @brief octree quantizer which does a much better job than DKColourQuantizer
  
  This code is mostly a port of CQuantizer © 1996-1997 Jeff Prosise
+
+ Rather than adding each pixel to the tree, the image is first reduced to a histogram of 15-bit colours, counted on several threads at
+ once, and each occupied histogram entry is added to the tree with its pixel count and colour sums. Nodes come from a pool.
  */
 @interface DKOctreeQuantizer : DKColourQuantizer {
 	NODE* m_pTree;
 	NSUInteger m_nLeafCount;
 	NODE* m_pReducibleNodes[9];
 	NSUInteger m_nOutputMaxColors;
+	NODE* _Nullable* _Nullable m_nodeBlocks; // the node pool
+	NSUInteger m_nodeBlockCount;
+	NSUInteger m_nodesUsedInBlock; // nodes handed out from the last block
+	NODE* _Nullable m_freeNodes; // nodes returned to the pool, linked by pNext
 }
 
 - (void)addNode:(NODE* _Nullable* _Nonnull)ppNode colour:(NSUInteger[_Nonnull 4])rgb level:(NSUInteger)level leafCount:(NSUInteger*)leafCount reducibleNodes:(NODE* _Nonnull* _Nonnull)redNodes;
@@ -75,4 +130,23 @@ typedef struct _rgb_triple {
 
 @end
 
+#pragma mark -
+
+/** @brief median cut quantizer, with optional k-means refinement.
+
+ Works on the same 15-bit colour histogram as the octree quantizer. The colour box with the most pixels spread over the widest range is
+ repeatedly split at the pixel median of its longest side, until there are as many boxes as colours. Each palette colour is the mean of
+ the pixels in its box. The palette can then be refined by a few rounds of k-means over the histogram, which lowers the error further
+ at some extra cost.
+ */
+@interface DKMedianCutQuantizer : DKColourQuantizer {
+	NSUInteger m_refinementIterations;
+}
+
+/** @brief The number of k-means rounds used to refine the median cut palette. The default is 2; 0 turns refinement off.
+ */
+@property NSUInteger refinementIterations;
+
+@end
+
 NS_ASSUME_NONNULL_END
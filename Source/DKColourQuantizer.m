@@ -8,6 +8,7 @@
 
 #import "DKDrawKitMacros.h"
 #import "LogEvent.h"
+#import <simd/simd.h>
 
 // colour mapping macros rgb->index->rgb. Note that these only do the most primitive colour mapping which is bit truncation and concatenation.
 // TODO: try the same using a YUV colourspace???
@@ -63,6 +64,314 @@ static inline void indexToRGB_332(NSUInteger i, NSUInteger rgb[3])
 	rgb[2] = ((i & 0x03) << 6) | ((i & 0x03) << 4) | ((i & 0x03) << 2) | (i & 0x03);
 }
 
+#pragma mark -
+#pragma mark Histograms
+
+// a histogram has an entry for each 15-bit colour holding the sums of the red, green and blue samples of the pixels that fall in it,
+// and their count. Entries are vectors, so a pixel is added with a single vector add.
+
+#define kDKHistogramSize 32768
+
+typedef simd_ulong4 DKHistogramEntry;
+
+static inline NSUInteger DKHistogramIndex(NSUInteger r, NSUInteger g, NSUInteger b)
+{
+	return ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+}
+
+BOOL DKPixelBufferFromBitmapImageRep(NSBitmapImageRep* rep, DKPixelBuffer* buffer)
+{
+	NSCParameterAssert(rep != nil);
+	NSCParameterAssert(buffer != NULL);
+
+	NSString* space = [rep colorSpaceName];
+	NSBitmapFormat format = [rep bitmapFormat];
+	NSInteger bpp = [rep bitsPerPixel];
+
+	if ([rep bitsPerSample] != 8 || [rep isPlanar] || [rep bitmapData] == NULL)
+		return NO;
+
+	if ((format & (NSBitmapFormatFloatingPointSamples | NSBitmapFormatSixteenBitLittleEndian | NSBitmapFormatThirtyTwoBitLittleEndian)) != 0)
+		return NO;
+
+	if (![space isEqualToString:NSCalibratedRGBColorSpace] && ![space isEqualToString:NSDeviceRGBColorSpace])
+		return NO;
+
+	if (([rep samplesPerPixel] != 3 && [rep samplesPerPixel] != 4) || (bpp != 24 && bpp != 32))
+		return NO;
+
+	buffer->data = [rep bitmapData];
+	buffer->width = [rep pixelsWide];
+	buffer->height = [rep pixelsHigh];
+	buffer->bytesPerRow = [rep bytesPerRow];
+	buffer->bytesPerPixel = bpp / 8;
+	buffer->redOffset = ([rep hasAlpha] && (format & NSBitmapFormatAlphaFirst) != 0) ? 1 : 0;
+
+	return YES;
+}
+
+static DKHistogramEntry* DKHistogramOfPixelBuffer(DKPixelBuffer buffer)
+{
+	// each band of rows is counted into a histogram of its own on its own thread, then the histograms are summed. The entries are
+	// vectors, which malloc doesn't necessarily align well enough.
+
+	NSUInteger bands = MIN((NSUInteger)[[NSProcessInfo processInfo] activeProcessorCount], MAX(buffer.height / 64, (NSUInteger)1));
+	DKHistogramEntry* histograms = NULL;
+
+	bands = MAX(bands, (NSUInteger)1);
+
+	if (posix_memalign((void**)&histograms, sizeof(DKHistogramEntry), sizeof(DKHistogramEntry) * kDKHistogramSize * bands) != 0)
+		return NULL;
+
+	memset(histograms, 0, sizeof(DKHistogramEntry) * kDKHistogramSize * bands);
+
+	dispatch_apply(bands, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t band) {
+		DKHistogramEntry* histogram = histograms + band * kDKHistogramSize;
+		NSUInteger row, col, lastRow = buffer.height * (band + 1) / bands;
+
+		for (row = buffer.height * band / bands; row < lastRow; ++row) {
+			const uint8_t* p = buffer.data + row * buffer.bytesPerRow + buffer.redOffset;
+
+			for (col = 0; col < buffer.width; ++col, p += buffer.bytesPerPixel)
+				histogram[DKHistogramIndex(p[0], p[1], p[2])] += (DKHistogramEntry){ p[0], p[1], p[2], 1 };
+		}
+	});
+
+	NSUInteger band, i;
+
+	for (band = 1; band < bands; ++band) {
+		const DKHistogramEntry* other = histograms + band * kDKHistogramSize;
+
+		for (i = 0; i < kDKHistogramSize; ++i)
+			histograms[i] += other[i];
+	}
+
+	return histograms;
+}
+
+#pragma mark -
+#pragma mark Median Cut
+
+// an occupied histogram entry, with its mean colour
+
+typedef struct {
+	uint64_t sum[3];
+	uint64_t count;
+	uint8_t mean[3];
+} DKColourSample;
+
+// a run of samples and the range of their mean colours
+
+typedef struct {
+	NSUInteger first;
+	NSUInteger count;
+	uint64_t pixels;
+	uint8_t min[3];
+	uint8_t max[3];
+} DKColourBox;
+
+static NSUInteger DKColourSamplesFromHistogram(const DKHistogramEntry* histogram, DKColourSample* samples)
+{
+	NSUInteger i, c, count = 0;
+
+	for (i = 0; i < kDKHistogramSize; ++i) {
+		DKHistogramEntry entry = histogram[i];
+
+		if (entry[3] == 0)
+			continue;
+
+		for (c = 0; c < 3; ++c) {
+			samples[count].sum[c] = entry[c];
+			samples[count].mean[c] = (uint8_t)((entry[c] + entry[3] / 2) / entry[3]);
+		}
+
+		samples[count++].count = entry[3];
+	}
+
+	return count;
+}
+
+static void DKShrinkColourBox(DKColourBox* box, const DKColourSample* samples)
+{
+	NSUInteger i, c;
+
+	box->pixels = 0;
+
+	for (c = 0; c < 3; ++c) {
+		box->min[c] = 255;
+		box->max[c] = 0;
+	}
+
+	for (i = box->first; i < box->first + box->count; ++i) {
+		box->pixels += samples[i].count;
+
+		for (c = 0; c < 3; ++c) {
+			box->min[c] = MIN(box->min[c], samples[i].mean[c]);
+			box->max[c] = MAX(box->max[c], samples[i].mean[c]);
+		}
+	}
+}
+
+// splits <box> on <axis> at the pixel median, putting the upper part in <upper>. The box must span more than one value on that axis.
+
+static void DKSplitColourBox(DKColourBox* box, DKColourBox* upper, NSUInteger axis, DKColourSample* samples)
+{
+	uint64_t counts[256] = { 0 };
+	NSUInteger i, end = box->first + box->count;
+
+	for (i = box->first; i < end; ++i)
+		counts[samples[i].mean[axis]] += samples[i].count;
+
+	// find the median value, but stop short of the maximum so that neither part is empty
+
+	NSUInteger v = box->min[axis];
+	uint64_t running = counts[v];
+
+	while (running < box->pixels / 2 && v + 1 < box->max[axis])
+		running += counts[++v];
+
+	i = box->first;
+
+	while (i < end) {
+		if (samples[i].mean[axis] <= v)
+			++i;
+		else {
+			DKColourSample temp = samples[i];
+			samples[i] = samples[--end];
+			samples[end] = temp;
+		}
+	}
+
+	upper->first = i;
+	upper->count = box->first + box->count - i;
+	box->count = i - box->first;
+
+	DKShrinkColourBox(box, samples);
+	DKShrinkColourBox(upper, samples);
+}
+
+// builds a palette of at most <maxColours> colours, in the range 0..255, and returns the number of colours
+
+static NSUInteger DKMedianCut(DKColourSample* samples, NSUInteger sampleCount, NSUInteger maxColours, simd_float4* palette)
+{
+	if (sampleCount == 0)
+		return 0;
+
+	DKColourBox* boxes = malloc(sizeof(DKColourBox) * maxColours);
+	NSUInteger i, c, boxCount = 1;
+
+	boxes[0].first = 0;
+	boxes[0].count = sampleCount;
+	DKShrinkColourBox(&boxes[0], samples);
+
+	while (boxCount < maxColours) {
+		// split the box with the most pixels spread over the widest range
+
+		NSUInteger best = NSNotFound, bestAxis = 0;
+		double bestScore = 0;
+
+		for (i = 0; i < boxCount; ++i) {
+			NSUInteger axis = 0;
+
+			for (c = 1; c < 3; ++c) {
+				if (boxes[i].max[c] - boxes[i].min[c] > boxes[i].max[axis] - boxes[i].min[axis])
+					axis = c;
+			}
+
+			double score = (double)boxes[i].pixels * (boxes[i].max[axis] - boxes[i].min[axis]);
+
+			if (score > bestScore) {
+				bestScore = score;
+				best = i;
+				bestAxis = axis;
+			}
+		}
+
+		if (best == NSNotFound)
+			break;
+
+		DKSplitColourBox(&boxes[best], &boxes[boxCount++], bestAxis, samples);
+	}
+
+	for (i = 0; i < boxCount; ++i) {
+		double sum[3] = { 0, 0, 0 };
+		NSUInteger k;
+
+		for (k = boxes[i].first; k < boxes[i].first + boxes[i].count; ++k) {
+			for (c = 0; c < 3; ++c)
+				sum[c] += samples[k].sum[c];
+		}
+
+		palette[i] = simd_make_float4(sum[0] / boxes[i].pixels, sum[1] / boxes[i].pixels, sum[2] / boxes[i].pixels, 0);
+	}
+
+	free(boxes);
+
+	return boxCount;
+}
+
+static inline NSUInteger DKNearestPaletteIndex(const simd_float4* palette, NSUInteger count, simd_float4 colour)
+{
+	NSUInteger i, nearest = 0;
+	float bestDistance = HUGE_VALF;
+
+	for (i = 0; i < count; ++i) {
+		float d = simd_distance_squared(palette[i], colour);
+
+		if (d < bestDistance) {
+			bestDistance = d;
+			nearest = i;
+		}
+	}
+
+	return nearest;
+}
+
+// k-means: moves each palette colour to the mean of the samples nearest to it. Colours that no sample is nearest to are left alone.
+
+static void DKRefinePalette(const DKColourSample* samples, NSUInteger sampleCount, simd_float4* palette, NSUInteger paletteCount, NSUInteger iterations)
+{
+	uint8_t* nearest = malloc(MAX(sampleCount, (NSUInteger)1));
+	NSUInteger chunks = (sampleCount + 1023) / 1024;
+	NSUInteger iteration, i, c;
+
+	for (iteration = 0; iteration < iterations; ++iteration) {
+		dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+			NSUInteger k, last = MIN(sampleCount, (chunk + 1) * 1024);
+
+			for (k = chunk * 1024; k < last; ++k) {
+				simd_float4 colour = simd_make_float4(samples[k].mean[0], samples[k].mean[1], samples[k].mean[2], 0);
+				nearest[k] = (uint8_t)DKNearestPaletteIndex(palette, paletteCount, colour);
+			}
+		});
+
+		double sums[256][3] = { { 0 } };
+		uint64_t counts[256] = { 0 };
+
+		for (i = 0; i < sampleCount; ++i) {
+			for (c = 0; c < 3; ++c)
+				sums[nearest[i]][c] += samples[i].sum[c];
+
+			counts[nearest[i]] += samples[i].count;
+		}
+
+		for (i = 0; i < paletteCount; ++i) {
+			if (counts[i] > 0)
+				palette[i] = simd_make_float4(sums[i][0] / counts[i], sums[i][1] / counts[i], sums[i][2] / counts[i], 0);
+		}
+	}
+
+	free(nearest);
+}
+
+#pragma mark -
+@interface DKColourQuantizer ()
+
+- (const uint8_t*)nearestTable;
+- (void)invalidateNearestTable;
+
+@end
+
 #pragma mark -
 @implementation DKColourQuantizer
 #pragma mark As a DKColourQuantizer
@@ -163,14 +472,127 @@ static inline void indexToRGB_332(NSUInteger i, NSUInteger rgb[3])
 #pragma mark -
 - (void)analyse:(NSBitmapImageRep*)rep
 {
-#pragma unused(rep)
+	NSAssert(rep != nil, @"Expected valid rep");
+
+	DKPixelBuffer buffer;
+	NSBitmapImageRep* converted = nil;
+
+	if (!DKPixelBufferFromBitmapImageRep(rep, &buffer)) {
+		// draw anything else into a meshed 8-bit RGBA bitmap first
+
+		converted = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+															pixelsWide:[rep pixelsWide]
+															pixelsHigh:[rep pixelsHigh]
+														 bitsPerSample:8
+													   samplesPerPixel:4
+															  hasAlpha:YES
+															  isPlanar:NO
+														colorSpaceName:NSCalibratedRGBColorSpace
+														   bytesPerRow:0
+														  bitsPerPixel:32];
+
+		[NSGraphicsContext saveGraphicsState];
+		[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithBitmapImageRep:converted]];
+		[rep drawInRect:NSMakeRect(0, 0, [rep pixelsWide], [rep pixelsHigh])];
+		[NSGraphicsContext restoreGraphicsState];
+
+		if (!DKPixelBufferFromBitmapImageRep(converted, &buffer))
+			return;
+	}
+
+	[self analysePixelBuffer:buffer];
+}
+
+- (void)analysePixelBuffer:(DKPixelBuffer)buffer
+{
+#pragma unused(buffer)
 
 	// the basic quantizer does no analysis of the image - it only works on the size of the RGB space. Override for more
 	// sophisticated quantizers. Upside: it's very fast ;-)
 }
 
+- (NSUInteger)nearestIndexForRGB:(const NSUInteger[3])rgb
+{
+	return [self nearestTable][DKHistogramIndex(rgb[0] & 0xFF, rgb[1] & 0xFF, rgb[2] & 0xFF)];
+}
+
+- (void)mapPixelBuffer:(DKPixelBuffer)buffer toIndexes:(uint8_t*)indexes
+{
+	NSAssert(indexes != NULL, @"no index buffer");
+
+	const uint8_t* table = [self nearestTable];
+	NSUInteger chunks = (buffer.height + 63) / 64;
+
+	dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+		NSUInteger row, col, lastRow = MIN(buffer.height, (chunk + 1) * 64);
+
+		for (row = chunk * 64; row < lastRow; ++row) {
+			const uint8_t* p = buffer.data + row * buffer.bytesPerRow + buffer.redOffset;
+			uint8_t* q = indexes + row * buffer.width;
+
+			for (col = 0; col < buffer.width; ++col, p += buffer.bytesPerPixel)
+				q[col] = table[DKHistogramIndex(p[0], p[1], p[2])];
+		}
+	});
+}
+
+- (const uint8_t*)nearestTable
+{
+	if (m_nearestTable == NULL) {
+		// for each 15-bit colour, find the nearest palette colour to the centre of the colour's cell
+
+		NSArray* colours = [self colourTable];
+		NSUInteger i, count = MIN([colours count], (NSUInteger)256);
+		simd_float4* palette = malloc(sizeof(simd_float4) * MAX(count, (NSUInteger)1));
+		uint8_t* table = calloc(kDKHistogramSize, sizeof(uint8_t));
+
+		for (i = 0; i < count; ++i) {
+			NSColor* colour = [[colours objectAtIndex:i] colorUsingColorSpace:[NSColorSpace genericRGBColorSpace]];
+			palette[i] = simd_make_float4([colour redComponent] * 255.0, [colour greenComponent] * 255.0, [colour blueComponent] * 255.0, 0);
+		}
+
+		if (count > 0) {
+			dispatch_apply(32, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t r) {
+				NSUInteger g, b;
+
+				for (g = 0; g < 32; ++g) {
+					for (b = 0; b < 32; ++b) {
+						simd_float4 centre = simd_make_float4(r * 8 + 3.5f, g * 8 + 3.5f, b * 8 + 3.5f, 0);
+						table[(r << 10) | (g << 5) | b] = (uint8_t)DKNearestPaletteIndex(palette, count, centre);
+					}
+				}
+			});
+		}
+
+		free(palette);
+		m_nearestTable = table;
+	}
+
+	return m_nearestTable;
+}
+
+- (void)invalidateNearestTable
+{
+	free(m_nearestTable);
+	m_nearestTable = NULL;
+}
+
 #pragma mark -
 #pragma mark As an NSObject
+- (void)dealloc
+{
+	free(m_nearestTable);
+}
+
+@end
+
+#pragma mark -
+
+@interface DKOctreeQuantizer ()
+
+- (nullable NODE*)newNode;
+- (void)releaseNode:(NODE*)pnode;
+- (void)addColour:(const NSUInteger[3])rgb count:(NSUInteger)count sums:(const uint64_t[3])sums;
 
 @end
 
@@ -221,7 +643,7 @@ static const NSUInteger mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x
 
 - (NODE*)createNodeAtLevel:(NSUInteger)level leafCount:(NSUInteger*)leafCount reducibleNodes:(NODE**)redNodes
 {
-	NODE* pnode = (NODE*)calloc(1, sizeof(NODE));
+	NODE* pnode = [self newNode];
 
 	if (pnode == NULL)
 		return NULL;
@@ -267,7 +689,7 @@ static const NSUInteger mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x
 			nAlphaSum += pnode->pChild[i]->nAlphaSum;
 			pnode->nPixelCount += pnode->pChild[i]->nPixelCount;
 
-			free(pnode->pChild[i]);
+			[self releaseNode:pnode->pChild[i]];
 			pnode->pChild[i] = NULL;
 
 			nChildren++;
@@ -292,10 +714,86 @@ static const NSUInteger mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x
 			[self deleteTree:&((*ppNode)->pChild[i])];
 	}
 
-	free(*ppNode);
+	[self releaseNode:*ppNode];
 	*ppNode = NULL;
 }
 
+- (NODE*)newNode
+{
+	// take a node from the free list, or failing that from the last block of the pool, adding a block if it is full
+
+	NODE* pnode = m_freeNodes;
+
+	if (pnode != NULL)
+		m_freeNodes = pnode->pNext;
+	else {
+		if (m_nodeBlockCount == 0 || m_nodesUsedInBlock == kDKOctreeNodeBlockSize) {
+			NODE** blocks = realloc(m_nodeBlocks, sizeof(NODE*) * (m_nodeBlockCount + 1));
+
+			if (blocks == NULL)
+				return NULL;
+
+			m_nodeBlocks = blocks;
+			m_nodeBlocks[m_nodeBlockCount] = malloc(sizeof(NODE) * kDKOctreeNodeBlockSize);
+
+			if (m_nodeBlocks[m_nodeBlockCount] == NULL)
+				return NULL;
+
+			m_nodeBlockCount++;
+			m_nodesUsedInBlock = 0;
+		}
+
+		pnode = &m_nodeBlocks[m_nodeBlockCount - 1][m_nodesUsedInBlock++];
+	}
+
+	memset(pnode, 0, sizeof(NODE));
+
+	return pnode;
+}
+
+- (void)releaseNode:(NODE*)pnode
+{
+	pnode->pNext = m_freeNodes;
+	m_freeNodes = pnode;
+}
+
+- (void)addColour:(const NSUInteger[3])rgb count:(NSUInteger)count sums:(const uint64_t[3])sums
+{
+	// as addNode:..., but adds <count> pixels of colour <rgb> at once, whose samples total <sums>
+
+	NODE** ppNode = &m_pTree;
+	NSUInteger level = 0;
+
+	while (YES) {
+		if (*ppNode == NULL)
+			*ppNode = [self createNodeAtLevel:level
+									leafCount:&m_nLeafCount
+							   reducibleNodes:m_pReducibleNodes];
+
+		if (*ppNode == NULL) {
+			[NSException raise:NSInternalInconsistencyException format:@"CreateNode... failed: *ppNode was nil after creation."];
+			return;
+		}
+
+		NODE* pnode = *ppNode;
+
+		if (pnode->bIsLeaf) {
+			pnode->nPixelCount += count;
+			pnode->nRedSum += sums[0];
+			pnode->nGreenSum += sums[1];
+			pnode->nBlueSum += sums[2];
+			pnode->nAlphaSum += 0xFF * count;
+			return;
+		}
+
+		NSInteger shift = 7 - level;
+		NSInteger nIndex = (((rgb[0] & mask[level]) >> shift) << 2) | (((rgb[1] & mask[level]) >> shift) << 1) | ((rgb[2] & mask[level]) >> shift);
+
+		ppNode = &pnode->pChild[nIndex];
+		++level;
+	}
+}
+
 - (void)paletteColour:(NODE*)pTree index:(NSUInteger*)pindex colour:(rgb_triple[])rgb
 {
 	if (pTree) {
@@ -341,30 +839,53 @@ static const NSUInteger mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x
 
 #pragma mark -
 #pragma mark As a DKColourQuantizer
-- (void)analyse:(NSBitmapImageRep*)rep
+- (void)analysePixelBuffer:(DKPixelBuffer)buffer
 {
-	NSInteger i, j;
-	NSUInteger rgb[4];
-
 	[m_cTable removeAllObjects];
+	[self invalidateNearestTable];
+
+	// start again with an empty tree
+
+	if (m_pTree != NULL)
+		[self deleteTree:&m_pTree];
+
+	m_nLeafCount = 0;
 
-	for (i = 0; i < m_imageSize.height; ++i) {
-		for (j = 0; j < m_imageSize.width; ++j) {
-			[rep getPixel:rgb
-					  atX:j
-						y:i];
-
-			[self addNode:&m_pTree
-						colour:rgb
-						 level:0
-					 leafCount:&m_nLeafCount
-				reducibleNodes:m_pReducibleNodes];
-
-			while (m_nLeafCount > m_maxColours)
-				[self reduceTreeLeafCount:&m_nLeafCount
-						   reducibleNodes:m_pReducibleNodes];
+	for (NSInteger i = 0; i < 9; ++i)
+		m_pReducibleNodes[i] = NULL;
+
+	// add each colour in the histogram to the tree, reducing it as needed
+
+	DKHistogramEntry* histogram = DKHistogramOfPixelBuffer(buffer);
+	NSUInteger i, c;
+
+	if (histogram == NULL)
+		return;
+
+	for (i = 0; i < kDKHistogramSize; ++i) {
+		DKHistogramEntry entry = histogram[i];
+
+		if (entry[3] == 0)
+			continue;
+
+		NSUInteger rgb[3];
+		uint64_t sums[3];
+
+		for (c = 0; c < 3; ++c) {
+			sums[c] = entry[c];
+			rgb[c] = (NSUInteger)((entry[c] + entry[3] / 2) / entry[3]);
 		}
+
+		[self addColour:rgb
+				  count:(NSUInteger)entry[3]
+				   sums:sums];
+
+		while (m_nLeafCount > m_maxColours)
+			[self reduceTreeLeafCount:&m_nLeafCount
+					   reducibleNodes:m_pReducibleNodes];
 	}
+
+	free(histogram);
 }
 
 - (NSArray*)colourTable
@@ -442,9 +963,80 @@ static const NSUInteger mask[8] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x
 #pragma mark As an NSObject
 - (void)dealloc
 {
-	if (m_pTree != NULL) {
-		[self deleteTree:&m_pTree];
+	// the tree's nodes all belong to the pool
+
+	for (NSUInteger i = 0; i < m_nodeBlockCount; ++i)
+		free(m_nodeBlocks[i]);
+
+	free(m_nodeBlocks);
+}
+
+@end
+
+#pragma mark -
+
+@implementation DKMedianCutQuantizer
+
+- (instancetype)initWithBitmapImageRep:(NSBitmapImageRep*)rep maxColours:(NSUInteger)maxColours colourBits:(NSUInteger)nBits
+{
+	self = [super initWithBitmapImageRep:rep
+							  maxColours:maxColours
+							  colourBits:nBits];
+	if (self != nil) {
+		m_refinementIterations = 2;
 	}
+
+	return self;
+}
+
+@synthesize refinementIterations = m_refinementIterations;
+
+#pragma mark -
+#pragma mark As a DKColourQuantizer
+- (void)analysePixelBuffer:(DKPixelBuffer)buffer
+{
+	[m_cTable removeAllObjects];
+	[self invalidateNearestTable];
+
+	DKHistogramEntry* histogram = DKHistogramOfPixelBuffer(buffer);
+
+	if (histogram == NULL)
+		return;
+
+	DKColourSample* samples = malloc(sizeof(DKColourSample) * kDKHistogramSize);
+	NSUInteger sampleCount = DKColourSamplesFromHistogram(histogram, samples);
+
+	free(histogram);
+
+	simd_float4* palette = malloc(sizeof(simd_float4) * m_maxColours);
+	NSUInteger i, count = DKMedianCut(samples, sampleCount, m_maxColours, palette);
+
+	if (m_refinementIterations > 0 && count > 0)
+		DKRefinePalette(samples, sampleCount, palette, count, m_refinementIterations);
+
+	for (i = 0; i < count; ++i)
+		[m_cTable addObject:[NSColor colorWithCalibratedRed:palette[i].x / 255.0
+													  green:palette[i].y / 255.0
+													   blue:palette[i].z / 255.0
+													  alpha:1.0]];
+
+	free(palette);
+	free(samples);
+}
+
+- (NSUInteger)indexForRGB:(const NSUInteger[3])rgb
+{
+	return [self nearestIndexForRGB:rgb];
+}
+
+- (NSArray*)colourTable
+{
+	return m_cTable;
+}
+
+- (NSUInteger)numberOfColours
+{
+	return [m_cTable count];
 }
 
 @end
@@ -20,6 +20,7 @@ can be used in a similar way.
 @interface DKDistortionTransform : NSObject <NSCoding, NSCopying> {
 	NSPoint m_q[4];
 	BOOL m_inverted;
+	CGFloat m_flatness;
 }
 
 + (DKDistortionTransform*)transformWithInitialRect:(NSRect)rect;
@@ -40,7 +41,22 @@ can be used in a similar way.
 
 - (void)invert;
 
+/** @brief How closely transformed paths follow the true distortion, as a fraction of the envelope's size.
+
+ Lines and curves bend under a distortion, so paths are subdivided until they are within this distance of where the distortion takes
+ them. Smaller values follow the distortion more closely at the cost of more path elements. Default is 1/2000.
+ */
+@property CGFloat flatness;
+
+/** @brief Maps a point from its position within a rect to the same position within the envelope.
+
+ The envelope's corners are interpolated bilinearly, so the rect's edges go to the envelope's edges. The warp from the rect is set up once
+ and kept until the rect or envelope change, so transforming many points from the same rect costs a few multiplications each.
+ */
 - (NSPoint)transformPoint:(NSPoint)p fromRect:(NSRect)rect;
+
+/** @brief Maps a path from its control point bounds to the envelope, subdividing it to within the flatness so that its lines and curves
+ bend with the distortion. */
 - (NSBezierPath*)transformBezierPath:(NSBezierPath*)path;
 
 @end
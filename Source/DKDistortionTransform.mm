@@ -6,6 +6,9 @@
 
 #import "DKDistortionTransform.h"
 
+#import "NSBezierPath+Geometry.h"
+#import "DKPathWarp.h"
+
 extern "C" {
 #import "DKGeometryUtilities.h"
 }
@@ -16,40 +19,22 @@ extern "C" {
 #import "agg_trans_perspective.h"
 #endif
 
-#pragma mark Static Functions
-static inline CGFloat MMul(CGFloat a, CGFloat b, CGFloat c, CGFloat d)
-{
-	return a * d - b * c;
-}
-
-static inline void VP(CGFloat* px, CGFloat* py, CGFloat x1, CGFloat y1, CGFloat x2, CGFloat y2, CGFloat x3, CGFloat y3, CGFloat x4, CGFloat y4)
-{
-	CGFloat d = MMul(x1 - x2, y1 - y2, x3 - x4, y3 - y4);
-
-	if (d == 0.0)
-		d = 1.0;
-
-	*px = MMul(MMul(x1, y1, x2, y2), x1 - x2, MMul(x3, y3, x4, y4), x3 - x4) / d;
-	*py = MMul(MMul(x1, y1, x2, y2), y1 - y2, MMul(x3, y3, x4, y4), y3 - y4) / d;
-}
-
-static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
-{
-	// maps a point <inPoint> within a rect from 0,0 to <sourceSize> to a point within the quadrilateral defined by the four points in <quad>.
+#pragma mark Static Variables
+static const CGFloat kDKDistortionDefaultFlatness = 1.0 / 2000.0;
 
-	NSPoint p;
+@interface DKDistortionTransform ()
 
-	VP((CGFloat*)&p.x, (CGFloat*)&p.y,
-	   (CGFloat)((sourceSize.height - inPoint.y) * quad[0].x + (inPoint.y) * quad[3].x) / sourceSize.height, (CGFloat)((sourceSize.height - inPoint.y) * quad[0].y + inPoint.y * quad[3].y) / sourceSize.height,
-	   (CGFloat)((sourceSize.height - inPoint.y) * quad[1].x + (inPoint.y) * quad[2].x) / sourceSize.height, (CGFloat)((sourceSize.height - inPoint.y) * quad[1].y + inPoint.y * quad[2].y) / sourceSize.height,
-	   (CGFloat)((sourceSize.width - inPoint.x) * quad[0].x + (inPoint.x) * quad[1].x) / sourceSize.width, (CGFloat)((sourceSize.width - inPoint.x) * quad[0].y + inPoint.x * quad[1].y) / sourceSize.width,
-	   (CGFloat)((sourceSize.width - inPoint.x) * quad[3].x + (inPoint.x) * quad[2].x) / sourceSize.width, (CGFloat)((sourceSize.width - inPoint.x) * quad[3].y + inPoint.x * quad[2].y) / sourceSize.width);
+- (const DKPathWarp*)warpFromRect:(NSRect)rect;
 
-	return p;
-}
+@end
 
 #pragma mark -
-@implementation DKDistortionTransform
+@implementation DKDistortionTransform {
+	// the warp from the rect last transformed from, set up on first use and until the envelope or rect changes
+	DKPathWarp m_warp;
+	NSRect m_warpRect;
+	BOOL m_warpValid;
+}
 #pragma mark As a DKDistortionTransform
 
 + (DKDistortionTransform*)transformWithInitialRect:(NSRect)rect
@@ -77,6 +62,7 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	self = [super init];
 	if (self != nil) {
 		[self setEnvelopePoints:points];
+		m_flatness = kDKDistortionDefaultFlatness;
 		NSAssert(!m_inverted, @"Expected init to NO");
 	}
 
@@ -90,6 +76,7 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	m_q[1] = points[1];
 	m_q[2] = points[2];
 	m_q[3] = points[3];
+	m_warpValid = NO;
 }
 
 - (void)getEnvelopePoints:(out NSPoint[4])points
@@ -124,6 +111,7 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	m_q[1].y += dy;
 	m_q[2].y += dy;
 	m_q[3].y += dy;
+	m_warpValid = NO;
 }
 
 - (void)shearHorizontallyBy:(CGFloat)dx
@@ -132,6 +120,7 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	m_q[1].x += dx;
 	m_q[2].x -= dx;
 	m_q[3].x -= dx;
+	m_warpValid = NO;
 }
 
 - (void)shearVerticallyBy:(CGFloat)dy
@@ -140,6 +129,7 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	m_q[3].y -= dy;
 	m_q[1].y += dy;
 	m_q[2].y += dy;
+	m_warpValid = NO;
 }
 
 - (void)differentialPerspectiveBy:(CGFloat)delta
@@ -148,8 +138,11 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	m_q[1].y -= delta;
 	m_q[2].y += delta;
 	m_q[3].y -= delta;
+	m_warpValid = NO;
 }
 
+@synthesize flatness = m_flatness;
+
 #pragma mark -
 - (void)invert
 {
@@ -201,69 +194,80 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 	return p;
 
 #else
-	NSPoint np = p;
+	DKPathPoint dp = { p.x, p.y };
 
-	np.x -= rect.origin.x;
-	np.y -= rect.origin.y;
+	dp = DKPathWarpPoint([self warpFromRect:rect], dp);
 
-	return Map(np, rect.size, m_q);
+	return NSMakePoint(dp.x, dp.y);
 #endif
 }
 
 - (NSBezierPath*)transformBezierPath:(NSBezierPath*)path
 {
-	// transforms every point in the path, making a new path
+	// warps the path from its control point bounds to the envelope, subdividing it so that lines and curves bend as they should. The
+	// tolerance is the flatness in proportion to the envelope's size, so it doesn't depend on the units the envelope is in
 
 	NSBezierPath* newPath = [path copy];
-	NSPoint ap[3];
-	NSBezierPathElement elem;
-	NSInteger i, ec;
-	NSRect bounds = [path controlPointBounds];
 
 	[newPath removeAllPoints];
-	ec = [path elementCount];
-
-	for (i = 0; i < ec; ++i) {
-		elem = [path elementAtIndex:i
-				   associatedPoints:ap];
-
-		if (elem == NSCurveToBezierPathElement) {
-			ap[0] = [self transformPoint:ap[0]
-								fromRect:bounds];
-			ap[1] = [self transformPoint:ap[1]
-								fromRect:bounds];
-			ap[2] = [self transformPoint:ap[2]
-								fromRect:bounds];
-
-			[newPath curveToPoint:ap[2]
-					controlPoint1:ap[0]
-					controlPoint2:ap[1]];
-		} else {
-			ap[0] = [self transformPoint:ap[0]
-								fromRect:bounds];
-
-			switch (elem) {
-			case NSMoveToBezierPathElement:
-				[newPath moveToPoint:ap[0]];
-				break;
-
-			case NSLineToBezierPathElement:
-				[newPath lineToPoint:ap[0]];
-				break;
-
-			case NSClosePathBezierPathElement:
-				[newPath closePath];
-				break;
-
-			default:
-				break;
-			}
-		}
+
+	if ([path isEmpty])
+		return newPath;
+
+	CGFloat minX = m_q[0].x, maxX = m_q[0].x, minY = m_q[0].y, maxY = m_q[0].y;
+	NSInteger i;
+
+	for (i = 1; i < 4; ++i) {
+		minX = MIN(minX, m_q[i].x);
+		maxX = MAX(maxX, m_q[i].x);
+		minY = MIN(minY, m_q[i].y);
+		maxY = MAX(maxY, m_q[i].y);
 	}
 
+	CGFloat tolerance = MAX(maxX - minX, maxY - minY) * [self flatness];
+	const DKPathWarp* warp = [self warpFromRect:[path controlPointBounds]];
+	DKPathBuffer source, warped;
+
+	DKPathBufferInit(&source);
+	DKPathBufferInit(&warped);
+
+	[path appendElementsToPathBuffer:&source];
+
+	if (tolerance > 0.0 && DKPathWarpPath(warp, &source, tolerance, &warped))
+		[newPath appendPathBuffer:&warped];
+	else {
+		// a degenerate envelope has no size to measure a tolerance against, and there is no subdivided path if memory ran out, so only
+		// the points are warped
+
+		DKPathWarpPoints(warp, source.points, source.pointCount, source.points);
+		[newPath appendPathBuffer:&source];
+	}
+
+	DKPathBufferFree(&source);
+	DKPathBufferFree(&warped);
+
 	return newPath;
 }
 
+/** @brief Returns the warp from a rect to the envelope, setting it up only if the rect or envelope have changed since it was last used.
+ */
+- (const DKPathWarp*)warpFromRect:(NSRect)rect
+{
+	if (!m_warpValid || !NSEqualRects(rect, m_warpRect)) {
+		DKPathPoint envelope[4];
+		NSInteger i;
+
+		for (i = 0; i < 4; ++i)
+			envelope[i] = (DKPathPoint){ m_q[i].x, m_q[i].y };
+
+		DKPathWarpInit(&m_warp, (DKPathPoint){ NSMinX(rect), NSMinY(rect) }, NSWidth(rect), NSHeight(rect), envelope);
+		m_warpRect = rect;
+		m_warpValid = YES;
+	}
+
+	return &m_warp;
+}
+
 #pragma mark -
 #pragma mark As part of NSCoding Protocol
 - (instancetype)initWithCoder:(NSCoder*)coder
@@ -276,6 +280,11 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 		m_q[2] = [coder decodePointForKey:@"q2"];
 		m_q[3] = [coder decodePointForKey:@"q3"];
 		m_inverted = [coder decodeBoolForKey:@"inverted"];
+
+		if ([coder containsValueForKey:@"flatness"])
+			m_flatness = [coder decodeDoubleForKey:@"flatness"];
+		else
+			m_flatness = kDKDistortionDefaultFlatness;
 	}
 	return self;
 }
@@ -293,13 +302,19 @@ static NSPoint Map(NSPoint inPoint, NSSize sourceSize, NSPoint quad[4])
 				forKey:@"q3"];
 	[coder encodeBool:m_inverted
 			   forKey:@"inverted"];
+	[coder encodeDouble:m_flatness
+				 forKey:@"flatness"];
 }
 
 #pragma mark -
 #pragma mark As part of NSCopying Protocol
 - (id)copyWithZone:(NSZone*)zone
 {
-	return [[[self class] allocWithZone:zone] initWithEnvelope:m_q];
+	DKDistortionTransform* copy = [[[self class] allocWithZone:zone] initWithEnvelope:m_q];
+
+	[copy setFlatness:m_flatness];
+
+	return copy;
 }
 
 @end
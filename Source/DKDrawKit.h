@@ -19,6 +19,8 @@ FOUNDATION_EXPORT const unsigned char DKDrawKitVersionString[];
 
 #import "DKObjectStorageProtocol.h"
 #import "DKLinearObjectStorage.h"
+#import "DKSnapIndex.h"
+#import "DKMarqueeSelection.h"
 #import "DKBSPObjectStorage.h"
 #import "DKBSPDirectObjectStorage.h"
 
@@ -72,6 +74,7 @@ FOUNDATION_EXPORT const unsigned char DKDrawKitVersionString[];
 #import "DKZigZagFill.h"
 #import "DKCIFilterRastGroup.h"
 #import "DKTextAdornment.h"
+#import "DKTextLayoutCache.h"
 #import "DKPathDecorator.h"
 #import "DKQuartzBlendRastGroup.h"
 #import "DKImageAdornment.h"
@@ -97,6 +100,20 @@ FOUNDATION_EXPORT const unsigned char DKDrawKitVersionString[];
 #import "DKHandle.h"
 #import "DKKnob.h"
 #import "DKRouteFinder.h"
+#import "DKRouteOptimiser.h"
+#import "DKColourQuantizer.h"
+#import "DKTaskScheduler.h"
+#import "GCThreadQueue.h"
+#import "DKRenderScheduler.h"
+#import "DKInstrumentation.h"
+#import "DKBSPIndex.h"
+#import "DKPathBuffer.h"
+#import "DKPathMeasure.h"
+#import "DKPathOffset.h"
+#import "DKPathStroke.h"
+#import "DKPathWarp.h"
+#import "DKSVGStream.h"
+#import "DKSVGExporter.h"
 
 #ifdef qUseCurveFit
 #import "CurveFit.h"
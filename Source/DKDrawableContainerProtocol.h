@@ -28,6 +28,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (DKMetadataItem*)metadataItemForKey:(NSString*)key;
 - (id)metadataObjectForKey:(NSString*)key;
 
+/** @brief Informs the container that one of its objects changed its appearance or geometry, e.g. so that it can discard a cache. */
+- (void)drawableDidChangeVisually:(DKDrawableObject*)obj;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -82,8 +82,28 @@ typedef NS_ENUM(NSInteger, DKMetadataSchema) {
 - (NSSize)sizeForKey:(NSString*)key;
 
 - (void)updateMetadataKeys;
+
+/** @brief A number that changes whenever this object's own metadata changes.
+
+ Changes made through this API update the version. If you modify metadata items or the dictionary returned by \c -metadata directly,
+ bracket the change with \c -metadataWillChangeKey: and \c -metadataDidChangeKey: so that the change is detected.
+ */
+@property (readonly) NSUInteger metadataVersion;
+
+/** @brief A number that changes whenever the metadata of this object or any of its containers changes.
+
+ This is derived from the metadata versions of the object and its containers, so it is an inexpensive way to detect changes. It is
+ cached, and forgotten by \c -invalidateMetadataChecksum when anything it is derived from changes, so it needn't look at the containers
+ each time.
+ */
 @property (readonly) NSUInteger metadataChecksum;
 
+/** @brief Forgets the cached metadata checksum, and those of anything contained in this object.
+
+ Called when the object's metadata or its container changes. Groups pass it on to the objects they contain.
+ */
+- (void)invalidateMetadataChecksum;
+
 - (void)metadataWillChangeKey:(nullable NSString*)key;
 - (void)metadataDidChangeKey:(nullable NSString*)key;
 
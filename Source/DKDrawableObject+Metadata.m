@@ -16,6 +16,12 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 
 #define USE_107_OR_LATER_SCHEMA 1
 
+@interface DKDrawableObject (MetadataPrivate)
+
+- (DKMetadataItem*)localMetadataItemForChangingKey:(NSString*)key copied:(BOOL*)copied;
+
+@end
+
 @implementation DKDrawableObject (Metadata)
 #pragma mark As a DKDrawableObject
 
@@ -97,7 +103,7 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 
 		item = [item copy];
 		[[self metadata] setObject:item
-							forKey:[key lowercaseString]];
+							forKey:DKMetadataCanonicalKey(key)];
 
 		[self notifyVisualChange];
 		[self metadataDidChangeKey:key];
@@ -112,10 +118,33 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 
 - (DKMetadataItem*)metadataItemForKey:(NSString*)key limitToLocalSearch:(BOOL)local
 {
-	DKMetadataItem* item = [[self metadata] objectForKey:[key lowercaseString]];
+	NSString* canonicalKey = DKMetadataCanonicalKey(key);
+	DKMetadataItem* item = [[self metadata] objectForKey:canonicalKey];
+
+	if (item == nil && !local && [self container] != nil && ([self container] != (id)self)) {
+		// items found (or not found) further up the containment hierarchy are remembered until the metadata of this object
+		// or any of its containers changes, which is detected by the checksum changing.
+
+		NSUInteger checksum = [self metadataChecksum];
+
+		if (mResolvedMetadataCache == nil || checksum != mResolvedMetadataChecksum) {
+			if (mResolvedMetadataCache == nil)
+				mResolvedMetadataCache = [[NSMutableDictionary alloc] init];
+			else
+				[mResolvedMetadataCache removeAllObjects];
+
+			mResolvedMetadataChecksum = checksum;
+		}
+
+		id resolved = [mResolvedMetadataCache objectForKey:canonicalKey];
 
-	if (item == nil && !local && ([self container] != (id)self))
-		item = [[self container] metadataItemForKey:key];
+		if (resolved == nil) {
+			item = [[self container] metadataItemForKey:canonicalKey];
+			[mResolvedMetadataCache setObject:item ? item : [NSNull null]
+									   forKey:canonicalKey];
+		} else if (resolved != [NSNull null])
+			item = resolved;
+	}
 
 	return item;
 }
@@ -145,18 +174,48 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 	return result;
 }
 
+- (DKMetadataItem*)localMetadataItemForChangingKey:(NSString*)key copied:(BOOL*)copied
+{
+	// returns this object's own item for <key>. An item inherited from a container is shared with its siblings, and only this object's
+	// version is bumped when it changes, so it is copied into this object first rather than being changed where it is.
+
+	DKMetadataItem* item = [self metadataItemForKey:key
+								 limitToLocalSearch:YES];
+
+	*copied = NO;
+
+	if (item == nil) {
+		item = [[self metadataItemForKey:key] copy];
+
+		if (item) {
+			[self setupMetadata];
+			[[self metadata] setObject:item
+								forKey:DKMetadataCanonicalKey(key)];
+			*copied = YES;
+		}
+	}
+
+	return item;
+}
+
 - (void)setMetadataItemValue:(id)value forKey:(NSString*)key
 {
 	// if an item exists for <key> its value is set to <value>. This records the old value for Undo if enabled. It does nothing if the
-	// item doesn't exist already.
+	// item doesn't exist already. An inherited item is copied into this object and the copy is changed.
 
 	if (![self locked]) {
-		DKMetadataItem* item = [self metadataItemForKey:key];
+		BOOL copied;
+		DKMetadataItem* item = [self localMetadataItemForChangingKey:key
+															  copied:&copied];
 
 		if (item) {
-			if ([[self class] metadataChangesAreUndoable])
-				[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItemValue:[item value]
-																					 forKey:key];
+			if ([[self class] metadataChangesAreUndoable]) {
+				if (copied)
+					[[[self undoManager] prepareWithInvocationTarget:self] removeMetadataForKey:key];
+				else
+					[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItemValue:[item value]
+																						 forKey:key];
+			}
 
 			[self metadataWillChangeKey:key];
 			[item setValue:value];
@@ -169,18 +228,25 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 - (void)setMetadataItemType:(DKMetadataType)type forKey:(NSString*)key
 {
 	// undoably sets the type of an item. Note tha changing types can be lossy - this does not care whether that is the case. You can
-	// query an item to see if a type change would be lossy before calling this if necessary.
+	// query an item to see if a type change would be lossy before calling this if necessary. An inherited item is copied into this
+	// object and the copy is changed.
 
 	if (![self locked]) {
-		DKMetadataItem* item = [self metadataItemForKey:key];
+		BOOL copied;
+		DKMetadataItem* item = [self localMetadataItemForChangingKey:key
+															  copied:&copied];
 
 		if (item) {
 			if ([[self class] metadataChangesAreUndoable]) {
-				// so that undo can revert a lossy change, the entire item is copied
-
-				DKMetadataItem* oldItem = [item copy];
-				[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItem:oldItem
-																				forKey:key];
+				if (copied)
+					[[[self undoManager] prepareWithInvocationTarget:self] removeMetadataForKey:key];
+				else {
+					// so that undo can revert a lossy change, the entire item is copied
+
+					DKMetadataItem* oldItem = [item copy];
+					[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItem:oldItem
+																					forKey:key];
+				}
 			}
 
 			[self metadataWillChangeKey:key];
@@ -205,7 +271,7 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 	// at which point the search gives up and returns nil.
 
 	@try {
-		if ([key length] > 1 && [[key substringWithRange:NSMakeRange(0, 1)] isEqualToString:@"$"]) {
+		if ([key length] > 1 && [key characterAtIndex:0] == '$') {
 			NSString* keyPath = [key substringFromIndex:1];
 			return [self valueForKeyPath:keyPath];
 		}
@@ -224,7 +290,7 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 
 #else
 
-	id object = [[self metadata] objectForKey:[key lowercaseString]];
+	id object = [[self metadata] objectForKey:DKMetadataCanonicalKey(key)];
 
 	// search upwards through the containment hierarchy for the data. If it is anywhere between here and the root drawing, it will be found.
 	// normally the container can't legally be self, but this prevents a infinite recursion bug if it is wrongly set.
@@ -270,7 +336,7 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 #endif
 
 	[self metadataWillChangeKey:key];
-	[[self metadata] removeObjectForKey:[key lowercaseString]];
+	[[self metadata] removeObjectForKey:DKMetadataCanonicalKey(key)];
 	[self metadataDidChangeKey:key];
 }
 
@@ -492,37 +558,44 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 #endif
 }
 
+- (NSUInteger)metadataVersion
+{
+	// versions are assigned lazily so that every object has a distinct one, even if its metadata has never been changed
+
+	if (mMetadataVersion == 0)
+		mMetadataVersion = DKMetadataNextVersion();
+
+	return mMetadataVersion;
+}
+
 - (NSUInteger)metadataChecksum
 {
-	// returns a number that is derived from the content of the metadata. If it changes, it means the metadata changed in some way. Don't interpret or store
-	// this number, only compare it to an earlier value.
+	// returns a number that changes whenever the metadata of this object or any of its containers changes. Don't interpret or store
+	// this number, only compare it to an earlier value. This is derived from the metadata versions, not the content, and is kept until
+	// the object or a container invalidates it, so is cheap to call.
 
-	NSUInteger cs = 1873176417; // arbitrary
+	if (mMetadataChecksum == 0) {
+		NSUInteger containerChecksum = 0;
 
-	NSMutableArray* array = [[[self metadata] allKeys] mutableCopy];
-	[array sortUsingSelector:@selector(compare:)];
+		if ([self container] && [self container] != (id)self)
+			containerChecksum = [(id)[self container] metadataChecksum];
 
-	for (NSString* key in array) {
-		id value;
-#if USE_107_OR_LATER_SCHEMA
-		value = [[self metadataItemForKey:key] value];
-#else
-		value = [self metadataObjectForKey:key];
-#endif
-		cs ^= [key hash] ^ [value hash];
+		mMetadataChecksum = DKMetadataCombinedChecksum([self metadataVersion], containerChecksum);
 	}
 
-	if ([self container])
-		cs ^= [(id)[self container] metadataChecksum];
+	return mMetadataChecksum;
+}
 
-	return cs;
+- (void)invalidateMetadataChecksum
+{
+	mMetadataChecksum = 0;
 }
 
 - (void)metadataWillChangeKey:(NSString*)key
 {
 	NSDictionary* userInfo = nil;
 	if (key)
-		userInfo = @{ @"key": [key lowercaseString] };
+		userInfo = @{ @"key": DKMetadataCanonicalKey(key) };
 	[[NSNotificationCenter defaultCenter] postNotificationName:kDKMetadataWillChangeNotification
 														object:self
 													  userInfo:userInfo];
@@ -530,9 +603,12 @@ NSString* const kDKUndoableChangesUserDefaultsKey = @"DKMetadataChangesAreNotUnd
 
 - (void)metadataDidChangeKey:(NSString*)key
 {
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
+
 	NSDictionary* userInfo = nil;
 	if (key)
-		userInfo = @{ @"key": [key lowercaseString] };
+		userInfo = @{ @"key": DKMetadataCanonicalKey(key) };
 	[[NSNotificationCenter defaultCenter] postNotificationName:kDKMetadataDidChangeNotification
 														object:self
 													  userInfo:userInfo];
@@ -585,7 +661,7 @@ NSString* const kDKPrivateShapeOriginalText = @"Original Text";
 		// if the key already exists, enforce the data type of the value. This allows this method to
 		// be connected to a table view for editing without changing any edited value into a string.
 		
-		id oldValue = [[self metadata] objectForKey:[key lowercaseString]];
+		id oldValue = [[self metadata] objectForKey:DKMetadataCanonicalKey(key)];
 		
 		// optionally make the change undoable
 		
@@ -645,7 +721,7 @@ NSString* const kDKPrivateShapeOriginalText = @"Original Text";
 		
 		[self metadataWillChangeKey:key];
 		[[self metadata] setObject:obj
-							forKey:[key lowercaseString]];
+							forKey:DKMetadataCanonicalKey(key)];
 		[self notifyVisualChange];
 		[self metadataDidChangeKey:key];
 	}
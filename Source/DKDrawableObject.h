@@ -50,6 +50,10 @@ NS_ASSUME_NONNULL_BEGIN
 	BOOL mGhosted; // YES if object is drawn ghosted
 	BOOL mIsHitTesting; // YES when drawContent is called for the purposes of hit-testing
 	NSMutableDictionary* mRenderingCache; // a dictionary to support general caching by renderers
+	NSUInteger mMetadataVersion; // changes whenever the metadata changes (see DKDrawableObject+Metadata)
+	NSUInteger mMetadataChecksum; // cached metadata checksum of this object and its containers, or 0 if not known
+	NSUInteger mResolvedMetadataChecksum; // the metadata checksum that the resolved metadata cache is valid for
+	NSMutableDictionary* mResolvedMetadataCache; // items found in containers for keys not in local metadata
 @protected
 	BOOL m_showBBox : 1; // debugging - display the object's bounding box
 	BOOL m_clipToBBox : 1; // debugging - force clip region to the bbox
@@ -226,6 +226,7 @@ static NSDictionary<NSString*, Class>* s_interconversionTable = nil;
 		}
 
 		mContainerRef = aContainer;
+		[self invalidateMetadataChecksum];
 
 		// make sure any attached style is aware of the undo manager used by the drawing/layers
 
@@ -494,6 +495,11 @@ static NSDictionary<NSString*, Class>* s_interconversionTable = nil;
 
 - (void)notifyVisualChange
 {
+	id<DKDrawableContainer> container = [self container];
+
+	if ([container respondsToSelector:@selector(drawableDidChangeVisually:)])
+		[container drawableDidChangeVisually:self];
+
 	if ([self layer])
 		[[self layer] drawable:self
 			needsDisplayInRect:[self bounds]];
@@ -1283,6 +1289,8 @@ static NSRect s_oldBounds;
 		mUserInfo = [[NSMutableDictionary alloc] init];
 
 	[mUserInfo setDictionary:info];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 	[self notifyStatusChange];
 }
 
@@ -1294,6 +1302,8 @@ static NSRect s_oldBounds;
 	NSDictionary* deepCopy = [info deepCopy];
 
 	[mUserInfo addEntriesFromDictionary:deepCopy];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 	[self notifyStatusChange];
 }
 
@@ -1317,6 +1327,8 @@ static NSRect s_oldBounds;
 
 	[mUserInfo setObject:obj
 				  forKey:key];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 	[self notifyStatusChange];
 }
 
@@ -7,6 +7,7 @@
 #import "DKDrawablePath.h"
 #import "CurveFit.h"
 #import "DKDrawing.h"
+#import "DKFill.h"
 #import "DKKnob.h"
 #import "DKObjectDrawingLayer.h"
 #import "DKShapeGroup.h"
@@ -2159,6 +2160,66 @@ finish:
 	return pc;
 }
 
+/** @brief Tests whether a point hits the path as drawn
+
+ Styles made only of plain fills and strokes are tested against the geometry of the path, which is much quicker than drawing them
+ into the hit-testing bitmap and needs no graphics context. As with the style -drawContent substitutes when hit testing, each stroke
+ is taken as centre-aligned, untrimmed and at least 4pt wide, and fills and strokes that draw nothing are ignored. Any other style is
+ tested by drawing it.
+ @param p a point
+ @return YES if the point hits the path as drawn, NO otherwise */
+- (BOOL)pointHitsPath:(NSPoint)p
+{
+	if (!NSPointInRect(p, [self bounds]))
+		return NO;
+
+	DKStyle* style = [self style];
+	NSArray<DKRasterizer*>* renderers = [style renderList];
+
+	if ([renderers count] == 0 || [style clipping] != kDKClippingNone)
+		return [super pointHitsPath:p];
+
+	for (DKRasterizer* rast in renderers) {
+		if (([rast class] != [DKStroke class] && [rast class] != [DKFill class]) || [rast clipping] != kDKClippingNone)
+			return [super pointHitsPath:p];
+	}
+
+	NSBezierPath* path = [self renderingPath];
+
+	for (DKRasterizer* rast in renderers) {
+		if (![rast enabled])
+			continue;
+
+		if ([rast class] == [DKFill class]) {
+			DKFill* fill = (DKFill*)rast;
+			BOOL drawsFill = [fill gradient] != nil || ([fill colour] != nil && [[fill colour] alphaComponent] > 0);
+
+			if (drawsFill && [path containsPoint:p])
+				return YES;
+		} else {
+			DKStroke* stroke = (DKStroke*)rast;
+
+			if ([stroke colour] == nil || [[stroke colour] alphaComponent] <= 0)
+				continue;
+
+			NSBezierPath* hitPath = [path copy];
+
+			[hitPath setLineWidth:MAX(4, [stroke width])];
+			[hitPath setLineCapStyle:[stroke lineCapStyle]];
+			[hitPath setLineJoinStyle:[stroke lineJoinStyle]];
+			[hitPath setMiterLimit:[stroke miterLimit]];
+			[hitPath setLineDash:NULL
+						   count:0
+						   phase:0];
+
+			if ([hitPath strokedPathContainsPoint:p])
+				return YES;
+		}
+	}
+
+	return NO;
+}
+
 /** @brief Determines the partcode hit by a given point
 
  Partcodes apart from 0 and -1 are private to this object
@@ -133,6 +133,24 @@ This uses Image I/O to perform the data encoding.
  */
 - (nullable NSData*)multipartTIFFDataWithResolution:(NSUInteger)dpi;
 
+// vector export:
+
+/** @brief Returns the drawing as an SVG document, or nil if there was a problem
+
+ The document is written by a \c DKSVGExporter with its default settings. Use one directly to change them.
+ @return SVG data
+ */
+- (nullable NSData*)SVGData;
+
+/** @brief Writes the drawing to a file as an SVG document
+
+ The document is streamed to the file as it is written, so memory use does not grow with the size of the drawing.
+ @param url the file to write
+ @param error set if the file couldn't be written
+ @return YES if the document was written
+ */
+- (BOOL)writeSVGToURL:(NSURL*)url error:(NSError**)error;
+
 @end
 
 extern NSBitmapImageRepPropertyKey const kDKExportPropertiesResolution;
@@ -6,6 +6,7 @@
 
 #import "DKDrawing+Export.h"
 #import "DKLayer+Metadata.h"
+#import "DKSVGExporter.h"
 #import "DKSelectionPDFView.h"
 #import "LogEvent.h"
 
@@ -544,4 +545,17 @@ NSString* const kDKExportedImageRelativeScale = @"kDKExportedImageRelativeScale"
 	return [NSBitmapImageRep TIFFRepresentationOfImageRepsInArray:[self layerBitmapsWithDPI:dpi]];
 }
 
+#pragma mark -
+
+- (NSData*)SVGData
+{
+	return [[[DKSVGExporter alloc] initWithDrawing:self] SVGData];
+}
+
+- (BOOL)writeSVGToURL:(NSURL*)url error:(NSError**)error
+{
+	return [[[DKSVGExporter alloc] initWithDrawing:self] writeToURL:url
+															  error:error];
+}
+
 @end
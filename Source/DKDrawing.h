@@ -6,7 +6,7 @@
 
 #import "DKLayerGroup.h"
 
-@class DKGridLayer, DKGuideLayer, DKKnob, DKViewController, DKImageDataManager, DKUndoManager;
+@class DKGridLayer, DKGuideLayer, DKKnob, DKViewController, DKImageDataManager, DKRenderScheduler, DKUndoManager;
 @protocol DKDrawingDelegate;
 
 typedef NSString* DKDrawingUnits NS_TYPED_EXTENSIBLE_ENUM;
@@ -49,13 +49,12 @@ NS_ASSUME_NONNULL_BEGIN
 	BOOL m_snapsToGrid; /**< YES if grid snapping enabled */
 	BOOL m_snapsToGuides; /**< YES if guide snapping enabled */
 	BOOL m_useQandDRendering; /**< if YES, renderers have the option to use a fast but low quality drawing method */
-	BOOL m_isForcedHQUpdate; /**< YES while refreshing to HQ after a LQ series */
 	BOOL m_qualityModEnabled; /**< YES if the quality modulation is enabled */
 	BOOL mPaperColourIsPrinted; /**< YES if paper colour should be printed (default is NO) */
-	NSTimer* m_renderQualityTimer; /**< a timer used to set up high or low quality rendering dynamically */
+	NSTimer* m_renderQualityTimer; /**< a timer that refines drafted areas at high quality, one frame at a time */
 	NSTimeInterval m_lastRenderTime; /**< time the last render operation occurred */
 	NSTimeInterval mTriggerPeriod; /**< the time interval to use to trigger low quality rendering */
-	NSRect m_lastRectUpdated; /**< for refresh in HQ mode */
+	DKRenderScheduler* mRenderScheduler; /**< decides the quality of each update and what to refine afterwards */
 	NSMutableSet<DKViewController*>* mControllers; /**< the set of current controllers */
 	DKImageDataManager* mImageManager; /**< internal object used to substantially improve efficiency of image archiving */
 	id<DKDrawingDelegate> __weak mDelegateRef; /**< delegate, if any */
@@ -371,15 +370,34 @@ NS_ASSUME_NONNULL_BEGIN
 @property BOOL lowRenderingQuality;
 
 /** @brief Dynamically check if low or high quality should be used
- 
- Called from the drawing method, this starts or extends a timer which will set high quality after
- a delay. Thus if rapid updates are happening, it will switch to low quality, and switch to high
- quality after a delay.
+
+ Called from the drawing method, this asks the render scheduler whether the update should be drawn
+ at low quality. An update that is too expensive to draw at high quality within a frame is drawn at
+ low quality, and the areas drawn that way are refined at high quality once they have not been
+ updated for \c lowQualityTriggerInterval. This checks an update of the whole drawing.
  */
 - (void)checkIfLowQualityRequired;
+
+/** @brief Dynamically check if low or high quality should be used for an update of <rect>. */
+- (void)checkIfLowQualityRequiredInRect:(NSRect)rect;
+
+/** @brief Refines the next areas waiting to be drawn at high quality.
+
+ Called by a timer once per frame while there are areas waiting, this marks as many of them for
+ redisplay as the render scheduler expects to draw within its frame budget, visible areas near
+ the mouse first. The timer stops once nothing is left to refine.
+ */
 - (void)qualityTimerCallback:(NSTimer*)timer;
+
+/** @brief How long an area drawn at low quality must go without being updated before it is refined. */
 @property NSTimeInterval lowQualityTriggerInterval;
 
+/** @brief The scheduler that decides the quality of each update and which areas to refine.
+
+ Its cost model, frame budget and clock can be replaced to tune the refinement.
+ */
+@property (readonly, strong) DKRenderScheduler* renderScheduler;
+
 /** @} */
 /** @name setting the undo manager:
  @{ */
@@ -13,10 +13,12 @@
 #import "DKGridLayer.h"
 #import "DKGuideLayer.h"
 #import "DKImageDataManager.h"
+#import "DKInstrumentation.h"
 #import "DKKeyedUnarchiver.h"
 #import "DKKnob.h"
 #import "DKLayer+Metadata.h"
 #import "DKObjectDrawingLayer.h"
+#import "DKRenderScheduler.h"
 #import "DKStyle.h"
 #import "DKStyleRegistry.h"
 #import "DKUnarchivingHelper.h"
@@ -82,6 +84,24 @@ NSString* const DKDrawingUnitsMiles = @"miles";
 
 static id sDearchivingHelper = nil;
 
+// the render scheduler's tile size, in drawing units, and how often drafted areas are refined while any are waiting
+
+#define DRAWING_RENDER_TILE_SIZE 256.0
+#define DRAWING_REFINEMENT_INTERVAL (1.0 / 60.0)
+
+@interface DKDrawing ()
+
+/** @brief Starts the refinement timer if any areas are waiting to be refined. */
+- (void)scheduleRefinement;
+- (void)stopRefinement;
+
+/** @brief Tells the render scheduler which parts of the drawing the views show, and where the mouse is.
+ @return NO if no view is showing the drawing
+ */
+- (BOOL)updateRenderSchedulerFromViews;
+
+@end
+
 #pragma mark -
 @implementation DKDrawing
 #pragma mark As a DKDrawing
@@ -209,6 +229,9 @@ static id sDearchivingHelper = nil;
 	NSAssert(drawingData != nil, @"drawing data was nil - unable to proceed");
 	NSAssert([drawingData length] > 0, @"drawing data was empty - unable to proceed");
 
+	DK_INSTRUMENT_SCOPE("archive", "decode drawing");
+	DK_INSTRUMENT_VALUE("archive", "bytes decoded", (int64_t)[drawingData length]);
+
 	// using DKKeyedUnarchiver allows passing of image data manager to dearchiving methods for certain objects
 
 	DKKeyedUnarchiver* unarch = [[DKKeyedUnarchiver alloc] initForReadingWithData:drawingData];
@@ -668,54 +691,123 @@ static id sDearchivingHelper = nil;
 
 - (void)checkIfLowQualityRequired
 {
-	// if this is being called frequently, set low quality and start a timer to restore high quality after a delay. If the timer is
-	// already running, retrigger it.
+	[self checkIfLowQualityRequiredInRect:[[self renderScheduler] bounds]];
+}
 
+- (void)checkIfLowQualityRequiredInRect:(NSRect)rect
+{
 	// if not drawing to screen, don't do this - always use HQ
 
-	if (![[NSGraphicsContext currentContext] isDrawingToScreen]) {
+	if (![[NSGraphicsContext currentContext] isDrawingToScreen] || ![self dynamicQualityModulationEnabled]) {
 		[self setLowRenderingQuality:NO];
 		return;
 	}
 
-	if ([self dynamicQualityModulationEnabled]) {
-
-		[self setLowRenderingQuality:YES];
-
-		if (m_renderQualityTimer == nil) {
-			// start the timer:
-
-			m_renderQualityTimer = [NSTimer scheduledTimerWithTimeInterval:mTriggerPeriod
-																	target:self
-																  selector:@selector(qualityTimerCallback:)
-																  userInfo:nil
-																   repeats:YES];
-			[[NSRunLoop currentRunLoop] addTimer:m_renderQualityTimer
-										 forMode:NSEventTrackingRunLoopMode];
-		} else {
-			// already running - retrigger it:
+	// the scheduler drafts an update that won't fit in a frame, and draws a refinement it asked for at high quality
 
-			[m_renderQualityTimer setFireDate:[NSDate dateWithTimeIntervalSinceNow:mTriggerPeriod]];
-		}
-	} else
-		[self setLowRenderingQuality:NO];
+	[self setLowRenderingQuality:[[self renderScheduler] qualityForDrawingRect:rect] == kDKRenderQualityDraft];
 }
 
 - (void)qualityTimerCallback:(NSTimer*)timer
 {
 #pragma unused(timer)
 
-	// if the timer ever fires it calls this, so we simply invalidate it and set high quality
+	// with nothing to show the drawing, or modulation turned off, there is nothing worth refining
 
+	if (![self dynamicQualityModulationEnabled] || ![self updateRenderSchedulerFromViews]) {
+		[mRenderScheduler cancelAllRefinements];
+		[self stopRefinement];
+		return;
+	}
+
+	for (NSValue* value in [mRenderScheduler rectsToRefine])
+		[self setNeedsDisplayInRect:[value rectValue]];
+
+	if (![mRenderScheduler hasPendingRefinements])
+		[self stopRefinement];
+}
+
+- (void)scheduleRefinement
+{
+	if (m_renderQualityTimer == nil && [mRenderScheduler hasPendingRefinements]) {
+		m_renderQualityTimer = [NSTimer scheduledTimerWithTimeInterval:DRAWING_REFINEMENT_INTERVAL
+																target:self
+															  selector:@selector(qualityTimerCallback:)
+															  userInfo:nil
+															   repeats:YES];
+		[[NSRunLoop currentRunLoop] addTimer:m_renderQualityTimer
+									 forMode:NSEventTrackingRunLoopMode];
+	}
+}
+
+- (void)stopRefinement
+{
 	[m_renderQualityTimer invalidate];
 	m_renderQualityTimer = nil;
-	[self setLowRenderingQuality:NO];
-	m_isForcedHQUpdate = YES;
-	[self setNeedsDisplayInRect:m_lastRectUpdated];
-	m_lastRectUpdated = NSZeroRect;
 }
 
-@synthesize lowQualityTriggerInterval = mTriggerPeriod;
+- (BOOL)updateRenderSchedulerFromViews
+{
+	NSMutableArray<NSValue*>* visible = [NSMutableArray array];
+	BOOL foundCursor = NO;
+
+	// views of a drawing are in drawing coordinates, so their visible rects can be used directly
+
+	for (DKViewController* controller in [self controllers]) {
+		NSView* view = [controller view];
+
+		if ([view window] == nil)
+			continue;
+
+		NSRect vr = [view visibleRect];
+
+		if (NSIsEmptyRect(vr))
+			continue;
+
+		[visible addObject:[NSValue valueWithRect:vr]];
+
+		if (!foundCursor) {
+			NSPoint p = [view convertPoint:[[view window] mouseLocationOutsideOfEventStream]
+								  fromView:nil];
+
+			if (NSPointInRect(p, vr)) {
+				[mRenderScheduler setCursorPoint:p];
+				foundCursor = YES;
+			}
+		}
+	}
+
+	[mRenderScheduler setVisibleRects:visible];
+
+	return [visible count] > 0;
+}
+
+- (NSTimeInterval)lowQualityTriggerInterval
+{
+	return mTriggerPeriod;
+}
+
+- (void)setLowQualityTriggerInterval:(NSTimeInterval)interval
+{
+	mTriggerPeriod = interval;
+	[mRenderScheduler setQuietInterval:interval];
+}
+
+- (DKRenderScheduler*)renderScheduler
+{
+	NSRect bounds = NSMakeRect(0, 0, m_size.width, m_size.height);
+
+	if (mRenderScheduler == nil) {
+		mRenderScheduler = [[DKRenderScheduler alloc] initWithBounds:bounds
+															tileSize:DRAWING_RENDER_TILE_SIZE];
+
+		if (mTriggerPeriod > 0)
+			[mRenderScheduler setQuietInterval:mTriggerPeriod];
+	} else
+		[mRenderScheduler setBounds:bounds];
+
+	return mRenderScheduler;
+}
 
 #pragma mark -
 #pragma mark - setting the undo manager
@@ -1229,6 +1321,8 @@ static id sDearchivingHelper = nil;
 	NSAssert(key != nil, @"key cannot be nil");
 	NSAssert([key length] > 0, @"key cannot be empty");
 
+	DK_INSTRUMENT_SCOPE("archive", "encode drawing");
+
 	NSMutableData* data = [[NSMutableData alloc] init];
 
 	NSAssert(data != nil, @"couldn't create data for archiving");
@@ -1243,6 +1337,8 @@ static id sDearchivingHelper = nil;
 				 forKey:key];
 	[karch finishEncoding];
 
+	DK_INSTRUMENT_VALUE("archive", "bytes encoded", (int64_t)[data length]);
+
 	return [data copy];
 }
 
@@ -1253,8 +1349,15 @@ static id sDearchivingHelper = nil;
  */
 - (NSData*)drawingData
 {
+	DK_INSTRUMENT_SCOPE("archive", "encode drawing");
+
 	[self finalizePriorToSaving];
-	return [NSKeyedArchiver archivedDataWithRootObject:self];
+
+	NSData* data = [NSKeyedArchiver archivedDataWithRootObject:self];
+
+	DK_INSTRUMENT_VALUE("archive", "bytes encoded", (int64_t)[data length]);
+
+	return data;
 }
 
 /** @brief The entire drawing in PDF format
@@ -1355,6 +1458,8 @@ static id sDearchivingHelper = nil;
  */
 - (void)drawRect:(NSRect)rect inView:(DKDrawingView*)aView
 {
+	DK_INSTRUMENT_SCOPE("draw", "drawing");
+
 	// save the graphics context on entry so that we can restore it when we return. This allows recovery from an exception
 	// that could leave the context stack unbalanced.
 
@@ -1371,12 +1476,12 @@ static id sDearchivingHelper = nil;
 		// if no layers, nothing to draw
 
 		if ([self visible] && [self countOfLayers] > 0) {
-			// if not forcing a high quality render, set low quality and start the timer
+			// ask the render scheduler whether this update should be a draft, and time it so the scheduler can learn what drawing costs
 
-			if (!m_isForcedHQUpdate) {
-				[self checkIfLowQualityRequired];
-				m_lastRectUpdated = NSUnionRect(m_lastRectUpdated, rect);
-			}
+			BOOL scheduled = [self dynamicQualityModulationEnabled] && [NSGraphicsContext currentContextDrawingToScreen];
+			NSTimeInterval started = scheduled ? [[self renderScheduler] currentTime] : 0;
+
+			[self checkIfLowQualityRequiredInRect:rect];
 
 			if ([self knobsShouldAdjustToViewScale] && aView != nil)
 				[[self knobs] setControlKnobSizeForViewScale:[aView scale]];
@@ -1395,6 +1500,13 @@ static id sDearchivingHelper = nil;
 					 inView:aView];
 			[self endDrawing];
 
+			if (scheduled) {
+				[mRenderScheduler didDrawRect:rect
+									  quality:[self lowRenderingQuality] ? kDKRenderQualityDraft : kDKRenderQualityFull
+									 duration:[mRenderScheduler currentTime] - started];
+				[self scheduleRefinement];
+			}
+
 			if ([[self delegate] respondsToSelector:@selector(drawing:
 															  didDrawRect:
 															  inView:)])
@@ -1406,9 +1518,6 @@ static id sDearchivingHelper = nil;
 	@catch (id exc) {
 		NSLog(@"### DK: An exception occurred while drawing - (%@) - will be ignored ###", exc);
 	}
-	@finally {
-		m_isForcedHQUpdate = NO;
-	}
 
 	[NSGraphicsContext setCurrentContext:topContext];
 }
@@ -1532,10 +1641,7 @@ static id sDearchivingHelper = nil;
 	m_activeLayerRef = nil;
 	mDelegateRef = nil;
 
-	if (m_renderQualityTimer != nil) {
-		[m_renderQualityTimer invalidate];
-		m_renderQualityTimer = nil;
-	}
+	[self stopRefinement];
 }
 
 - (instancetype)init
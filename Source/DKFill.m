@@ -84,6 +84,11 @@
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"shadow", @"tracksObjectAngle", @"gradient"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"shadow", @"tracksObjectAngle", @"gradient"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -9,12 +9,20 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class DKQuartzCache;
+
 /** @brief This object represents a pattern consisting of a repeated motif spaced out at intervals within a larger shape.
 
  This object represents a pattern consisting of a repeated motif spaced out at intervals within a larger shape.
 
  This subclasses \c DKPathDecorator which carries out the bulk of the work - it stores the image and caches it, this
  just sets up the path clipping and calls the rendering method for each location of the repeating pattern.
+
+ When the pattern is regular (no wobble, scale or angle randomness and no suppression of clipped elements), the repeating cell of the
+ pattern - 2 x 2 motifs, including the alternate offsets and motif rotation - is pre-rendered into a cached tile at the current device
+ scale, and the path is filled by blitting that tile, which is much faster than drawing every motif individually. The tile gives the same
+ motif orientation and compositing as placing each motif does. Irregular patterns, and drawing to non-screen contexts (printing, PDF
+ export), fall back to placing each motif, skipping those that lie outside the path.
 */
 @interface DKFillPattern : DKPathDecorator <NSCoding, NSCopying> {
 @private
@@ -27,7 +35,15 @@ NS_ASSUME_NONNULL_BEGIN
 	BOOL m_angleRelativeToObject;
 	BOOL m_motifAngleRelativeToPattern;
 	BOOL m_noClippedElements;
-	NSMutableArray* mMotifAngleRandCache;
+	DKQuartzCache* mTileCache;
+	NSImage* mTileImage;
+	NSSize mTileCellSize;
+	NSSize mTileAltOffset;
+	CGFloat mTileMotifAngle;
+	CGFloat mTileMotifScale;
+	CGFloat mTileLateralOffset;
+	CGFloat mTileDeviceScale;
+	CGFloat mTileMotifRotation;
 }
 
 /** return the default pattern, which is based on some image - unlikely to be really useful so might be
@@ -7,11 +7,21 @@
 #import "DKFillPattern.h"
 #import "DKDrawKitMacros.h"
 #import "DKGeometryUtilities.h"
+#import "DKQuartzCache.h"
 #import "DKRandom.h"
 #import "LogEvent.h"
 #import "NSBezierPath+Text.h"
 #import "NSBezierPath-OAExtensions.h"
 
+@interface DKFillPattern ()
+
+- (BOOL)patternRequiresPerMotifDrawing;
+- (BOOL)drawTiledPatternInPath:(NSBezierPath*)aPath centre:(NSPoint)cp interval:(NSSize)interval angle:(CGFloat)angle motifAngle:(CGFloat)mangle;
+- (void)drawMotifsInPatternCell:(NSSize)cell interval:(NSSize)interval motifAngle:(CGFloat)mangle motifRotation:(CGFloat)rotation;
+- (void)invalidatePatternTile;
+
+@end
+
 @implementation DKFillPattern
 #pragma mark As a DKFillPattern
 
@@ -108,6 +118,18 @@
 	if ([self motifAngleIsRelativeToPattern])
 		mangle += [self angle];
 
+	// a regular pattern is drawn by tiling a pre-rendered pattern cell. Only when each motif can differ from the next (randomness, or
+	// suppression of clipped elements) or when the output should stay resolution-independent (printing, PDF) are motifs placed one by one.
+
+	if (![self patternRequiresPerMotifDrawing]) {
+		if ([self drawTiledPatternInPath:aPath
+								  centre:cp
+								interval:NSMakeSize(dx, dy)
+								   angle:angle
+							  motifAngle:mangle])
+			return;
+	}
+
 	// how many rows and columns of the motif will we need to fill the rect?
 	// n.b. div by 2 because we go from -cols to +cols etc
 
@@ -125,6 +147,16 @@
 	motifBounds.size.width = mb.width * [self scale];
 	motifBounds.size.height = mb.height * [self scale];
 
+	// for culling, any motif whose worst-case (rotated, wobbled, scaled up) extent around its placement point misses both the path and the
+	// area being drawn can be skipped without drawing it at all. The flattened path makes the finer test cheaper.
+
+	CGFloat motifRadius = hypot(motifBounds.size.width, motifBounds.size.height) * 0.5 * (1.0 + [self scaleRandomness]) + ABS([self lateralOffset]) + (hypot(dx, dy) + [self interval] * M_SQRT2) * [self wobblyness];
+	NSRect cullRect = NSInsetRect(NSIntersectionRect([aPath bounds], NSRectFromCGRect(CGContextGetClipBoundingBox([[NSGraphicsContext currentContext] graphicsPort]))), -motifRadius, -motifRadius);
+	NSBezierPath* flatPath = nil;
+	NSRect extent;
+
+	extent.size.width = extent.size.height = motifRadius * 2.0;
+
 	@autoreleasepool {
 
 		// set up a transform that will transform each motif point to allow for the object's
@@ -149,29 +181,17 @@
 					mp.y = (y * dy) + cp.y;
 
 				if ([self wobblyness] > 0.0) {
-					// wobblyness is a randomising positioning factor from 0..1. Cached to avoid recalculation on every redraw.
-
-					if (mPlacementCount < [mWobbleCache count])
-						wobblePoint = [[mWobbleCache objectAtIndex:mPlacementCount] pointValue];
-					else {
-						wobblePoint.x = [DKRandom randomPositiveOrNegativeNumber] * dx * [self wobblyness];
-						wobblePoint.y = [DKRandom randomPositiveOrNegativeNumber] * dy * [self wobblyness];
-						[mWobbleCache addObject:[NSValue valueWithPoint:wobblePoint]];
-					}
+					// wobblyness is a randomising positioning factor from 0..1, derived from the placement count so it is the same on every redraw.
+
+					wobblePoint.x = DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomWobbleX)) * dx * [self wobblyness];
+					wobblePoint.y = DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomWobbleY)) * dy * [self wobblyness];
 
 					mp.x += wobblePoint.x;
 					mp.y += wobblePoint.y;
 				}
 
 				if ([self motifAngleRandomness] > 0.0) {
-					CGFloat ra = 0.0;
-
-					if (mPlacementCount < [mMotifAngleRandCache count])
-						ra = [[mMotifAngleRandCache objectAtIndex:mPlacementCount] doubleValue];
-					else {
-						ra = [DKRandom randomPositiveOrNegativeNumber] * 2.0 * M_PI * [self motifAngleRandomness];
-						[mMotifAngleRandCache addObject:@(ra)];
-					}
+					CGFloat ra = DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomAngle)) * 2.0 * M_PI * [self motifAngleRandomness];
 					tempAngle = mangle;
 					tempAngle += ra;
 				}
@@ -179,6 +199,26 @@
 				tp = [tfm transformPoint:mp];
 				++mPlacementCount;
 
+				// cull motifs that can't touch the visible part of the path. The placement count is still advanced as if the motif was drawn
+				// so that the random values stay associated with the same motifs whatever area is being updated.
+
+				extent = CentreRectOnPoint(extent, tp);
+
+				if (!NSIntersectsRect(extent, cullRect)) {
+					++mPlacementCount;
+					continue;
+				}
+
+				if (!NSContainsRect(extent, [aPath bounds])) {
+					if (flatPath == nil)
+						flatPath = [aPath bezierPathByFlatteningPath];
+
+					if (![flatPath containsPoint:tp] && ![flatPath intersectsRect:extent]) {
+						++mPlacementCount;
+						continue;
+					}
+				}
+
 				if (m_noClippedElements) {
 					// if this option is set, we don't draw pattern images that intersect the path. To detect whether that happens, the bounding rect
 					// of the element is calculated in position and intersected with the path. The text for intersection can be potentially intensive,
@@ -212,6 +252,209 @@
 	}
 }
 
+- (BOOL)patternRequiresPerMotifDrawing
+{
+	// motifs must be drawn individually if any of them can differ from the others, or if the output should not be rasterized
+
+	if ([self wobblyness] > 0.0 || [self scaleRandomness] > 0.0 || [self motifAngleRandomness] > 0.0)
+		return YES;
+
+	if ([self drawingOfClippedElementsSupressed] || [self usesChainMethod])
+		return YES;
+
+	return ![[NSGraphicsContext currentContext] isDrawingToScreen];
+}
+
+#define MAX_PATTERN_TILE_PIXELS (2048 * 2048)
+
+- (BOOL)drawTiledPatternInPath:(NSBezierPath*)aPath centre:(NSPoint)cp interval:(NSSize)interval angle:(CGFloat)angle motifAngle:(CGFloat)mangle
+{
+	// fills the (already clipped) area of <aPath> by blitting a cached image of the repeating pattern cell. The pattern is periodic over
+	// two rows and two columns because of the alternate offsets, so the cell holds 2 x 2 motifs. Returns NO if the tile can't be used.
+
+	CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
+
+	if (context == NULL)
+		return NO;
+
+	// the tile is rendered at the device scale, bucketed into quarter-octave steps so that continuous zooming doesn't rebuild it constantly
+
+	CGAffineTransform dt = CGContextGetUserSpaceToDeviceSpaceTransform(context);
+	CGFloat deviceScale = sqrt(ABS(dt.a * dt.d - dt.b * dt.c));
+
+	if (deviceScale <= 0.0)
+		return NO;
+
+	deviceScale = pow(2.0, ceil(log2(deviceScale) * 4.0) / 4.0);
+
+	NSSize cell = NSMakeSize(interval.width * 2.0, interval.height * 2.0);
+
+	if ((cell.width * deviceScale) * (cell.height * deviceScale) > MAX_PATTERN_TILE_PIXELS)
+		return NO;
+
+	// the tile is drawn in the rotated pattern space, so the motifs within it are rotated relative to the pattern. The fill pattern advances
+	// the placement count twice per motif, so the decorator always sees an odd count and alternating offsets flip every motif.
+
+	CGFloat cellMotifAngle = mangle - angle;
+
+	if ([self lateralOffsetAlternates])
+		cellMotifAngle += M_PI;
+
+	// the decorator only turns a motif to its angle when it is normal to the path. Otherwise the motif stays upright on the page, so in the
+	// tile it is turned back by the pattern angle, which the tile is rotated by when drawn
+
+	CGFloat cellMotifRotation = [self normalToPath] ? cellMotifAngle : -angle;
+
+	if (mTileCache == nil || mTileImage != [self image] || !NSEqualSizes(cell, mTileCellSize) || !NSEqualSizes([self patternAlternateOffset], mTileAltOffset) || cellMotifAngle != mTileMotifAngle || [self scale] != mTileMotifScale || [self lateralOffset] != mTileLateralOffset || cellMotifRotation != mTileMotifRotation || deviceScale != mTileDeviceScale) {
+		[self invalidatePatternTile];
+
+		NSSize tileSize = NSMakeSize(ceil(cell.width * deviceScale), ceil(cell.height * deviceScale));
+
+		mTileCache = [[DKQuartzCache cacheForCurrentContextWithSize:tileSize] retain];
+		mTileImage = [[self image] retain];
+		mTileCellSize = cell;
+		mTileAltOffset = [self patternAlternateOffset];
+		mTileMotifAngle = cellMotifAngle;
+		mTileMotifScale = [self scale];
+		mTileLateralOffset = [self lateralOffset];
+		mTileMotifRotation = cellMotifRotation;
+		mTileDeviceScale = deviceScale;
+
+		[mTileCache lockFocusFlipped:NO];
+
+		NSAffineTransform* st = [NSAffineTransform transform];
+		[st scaleXBy:tileSize.width / cell.width
+				 yBy:tileSize.height / cell.height];
+		[st concat];
+
+		[self drawMotifsInPatternCell:cell
+							 interval:interval
+						   motifAngle:cellMotifAngle
+						motifRotation:cellMotifRotation];
+
+		[mTileCache unlockFocus];
+	}
+
+	// work out which cells are needed - only those covering the part of the path that is actually being drawn. This is done in
+	// pattern space, i.e. with the rotation of the pattern undone and the pattern centre at the origin.
+
+	NSRect area = NSIntersectionRect([aPath bounds], NSRectFromCGRect(CGContextGetClipBoundingBox(context)));
+
+	if (NSIsEmptyRect(area))
+		return YES;
+
+	NSAffineTransform* tfm = RotationTransform(angle, cp);
+	[tfm translateXBy:cp.x
+				  yBy:cp.y];
+
+	NSAffineTransform* inv = [[tfm copy] autorelease];
+	[inv invert];
+
+	NSPoint corners[4];
+	corners[0] = [inv transformPoint:NSMakePoint(NSMinX(area), NSMinY(area))];
+	corners[1] = [inv transformPoint:NSMakePoint(NSMaxX(area), NSMinY(area))];
+	corners[2] = [inv transformPoint:NSMakePoint(NSMaxX(area), NSMaxY(area))];
+	corners[3] = [inv transformPoint:NSMakePoint(NSMinX(area), NSMaxY(area))];
+
+	NSRect patternArea = NSRectFromTwoPoints(corners[0], corners[2]);
+	patternArea = NSUnionRect(patternArea, NSRectFromTwoPoints(corners[1], corners[3]));
+
+	NSInteger col, row, minCol, maxCol, minRow, maxRow;
+
+	minCol = floor(NSMinX(patternArea) / cell.width);
+	maxCol = floor(NSMaxX(patternArea) / cell.width);
+	minRow = floor(NSMinY(patternArea) / cell.height);
+	maxRow = floor(NSMaxY(patternArea) / cell.height);
+
+	// the tile is composited the way -placeObjectAtPoint:... composites each motif. Its motifs are drawn over each other within it, and drawing
+	// that combination source-atop gives the same pixels as drawing each motif source-atop in turn
+
+	SAVE_GRAPHICS_CONTEXT
+
+		[tfm concat];
+	CGContextSetBlendMode(context, [self motifBlendMode]);
+
+	for (row = minRow; row <= maxRow; ++row) {
+		for (col = minCol; col <= maxCol; ++col)
+			[mTileCache drawInRect:NSMakeRect(col * cell.width, row * cell.height, cell.width, cell.height)];
+	}
+
+	RESTORE_GRAPHICS_CONTEXT
+
+	return YES;
+}
+
+- (void)drawMotifsInPatternCell:(NSSize)cell interval:(NSSize)interval motifAngle:(CGFloat)mangle motifRotation:(CGFloat)rotation
+{
+	// draws all the motifs that touch the cell {0, 0, cell} into the current context. Motifs in neighbouring cells that overlap the cell are
+	// included so that the tiles join up seamlessly. The motif transform matches -placeObjectAtPoint:... in DKPathDecorator, with <mangle>
+	// setting the direction of the lateral offset and <rotation> the turn of each motif, both in pattern space.
+
+	NSImage* img = [self image];
+	NSSize iSize = [img size];
+	CGFloat slope = mangle;
+	CGFloat lx = [self lateralOffset] * cos(slope + HALF_PI);
+	CGFloat ly = [self lateralOffset] * sin(slope + HALF_PI);
+	CGFloat radius = hypot(iSize.width, iSize.height) * 0.5 * [self scale] + ABS([self lateralOffset]);
+	NSInteger nx = ceil(radius / interval.width) + 1;
+	NSInteger ny = ceil(radius / interval.height) + 1;
+	NSRect cellRect = NSMakeRect(0, 0, cell.width, cell.height);
+	NSRect extent = NSMakeRect(0, 0, radius * 2.0, radius * 2.0);
+	NSInteger x, y;
+	NSPoint mp;
+
+	for (y = -ny; y < 2 + ny; ++y) {
+		for (x = -nx; x < 2 + nx; ++x) {
+			if (y & 1)
+				mp.x = interval.width * (x + m_altXOffset);
+			else
+				mp.x = x * interval.width;
+
+			if (x & 1)
+				mp.y = interval.height * (y + m_altYOffset);
+			else
+				mp.y = y * interval.height;
+
+			mp.x += lx;
+			mp.y += ly;
+
+			extent = CentreRectOnPoint(extent, mp);
+
+			if (!NSIntersectsRect(extent, cellRect))
+				continue;
+
+			NSAffineTransform* tfm = [NSAffineTransform transform];
+
+			[tfm translateXBy:mp.x
+						  yBy:mp.y];
+			[tfm scaleXBy:[self scale]
+					  yBy:[self scale] * -1.0];
+
+			[tfm rotateByRadians:-rotation];
+			[tfm translateXBy:-(iSize.width / 2)
+						  yBy:-(iSize.height / 2)];
+
+			SAVE_GRAPHICS_CONTEXT
+
+				[tfm concat];
+			[img drawAtPoint:NSZeroPoint
+					fromRect:NSZeroRect
+				   operation:NSCompositeSourceOver
+					fraction:1.0];
+
+			RESTORE_GRAPHICS_CONTEXT
+		}
+	}
+}
+
+- (void)invalidatePatternTile
+{
+	[mTileCache release];
+	mTileCache = nil;
+	[mTileImage release];
+	mTileImage = nil;
+}
+
 #pragma mark -
 @synthesize angle = m_angle;
 
@@ -254,14 +497,7 @@
 {
 	maRand = LIMIT(maRand, 0, 1);
 
-	if (maRand != mMotifAngleRandomness) {
-		mMotifAngleRandomness = maRand;
-
-		if (mMotifAngleRandCache == nil)
-			mMotifAngleRandCache = [[NSMutableArray alloc] init];
-
-		[mMotifAngleRandCache removeAllObjects];
-	}
+	mMotifAngleRandomness = maRand;
 }
 
 @synthesize motifAngleRandomness = mMotifAngleRandomness;
@@ -293,6 +529,12 @@
 		@"motifAngleRandomness"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"angle", @"angleIsRelativeToObject", @"patternAlternateOffset",
+		@"motifAngle", @"motifAngleRandomness", @"motifAngleIsRelativeToPattern", @"drawingOfClippedElementsSupressed"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -328,7 +570,8 @@
 
 - (void)dealloc
 {
-	[mMotifAngleRandCache release];
+	[mTileCache release];
+	[mTileImage release];
 	[super dealloc];
 }
 
@@ -289,6 +289,12 @@ typedef NS_ENUM(NSInteger, DKGradientInterpolation) {
  */
 @property (nonatomic) CGFloat position;
 
+/** @brief A hash of the stop's colour and position, for comparing gradients with \c -isEquivalentToObject:. */
+@property (readonly) NSUInteger equivalenceHash;
+
+/** @brief Whether another stop has the same colour and position. */
+- (BOOL)isEquivalentToObject:(nullable id)object;
+
 @end
 
 // notifications sent by DKGradient:
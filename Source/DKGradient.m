@@ -784,6 +784,13 @@ static inline void resolveHSV(CGFloat* color1, CGFloat* color2);
 #pragma mark -
 #pragma mark As a GCObservableObject
 
++ (NSArray*)equivalenceKeyPaths
+{
+	// a gradient doesn't publish observable key paths - it sets up its own KVO below - so list what decides how it draws
+
+	return @[@"colorStops", @"angle", @"gradientType", @"gradientBlending", @"gradientInterpolation"];
+}
+
 /** @brief Sets up KVO for handling undo when this object is used as part of a renderer tree
  @param object the nominated observer
  */
@@ -1051,6 +1058,23 @@ static inline void resolveHSV(CGFloat* color1, CGFloat* color2);
 #pragma mark -
 @synthesize owner = m_ownerRef;
 
+#pragma mark -
+
+- (NSUInteger)equivalenceHash
+{
+	return GCHashCombine([[self color] hash], [@([self position]) hash]);
+}
+
+- (BOOL)isEquivalentToObject:(id)object
+{
+	if (![object isKindOfClass:[DKColorStop class]])
+		return NO;
+
+	DKColorStop* stop = object;
+
+	return [stop position] == [self position] && [[stop color] isEqual:[self color]];
+}
+
 #pragma mark -
 #pragma mark As an NSObject
 
@@ -43,7 +43,9 @@ typedef NS_ENUM(NSInteger, DKGridMeasurementSystem) {
 
  General-purpose "snap to grid" type methods are implemented by \c DKDrawing using the grid as a basis - the grid itself doesn't implement snapping.
 
- Note: caching in a \c CGLayer is not recommended - the code is here but it doesn't draw nicely at high zooms. Turned off by default.
+ On screen, the grid is drawn from tiles rendered at the view's scale, in quarter-octave steps, and kept in a cache until the grid
+ changes. Only the tiles covering the area being updated are drawn, so scrolling costs the same however large the drawing is. When
+ printing or making a PDF the grid is stroked from paths as before.
 */
 @interface DKGridLayer : DKLayer <NSCoding> {
 @private
@@ -68,6 +70,7 @@ typedef NS_ENUM(NSInteger, DKGridMeasurementSystem) {
 	CGFloat mSpanSupressionScale; // scale below which span is not drawn at all (default = 0.1)
 	CGFloat mSpanCycleChangeThreshold; // scale below which span cycle is incremented
 	CGFloat mCachedViewScale; // view scale cache currently set up for
+	NSCache* mTileCache; // pre-rendered tiles of the grid, keyed by scale, place in the grid's repeat and colours
 @protected
 	CGFloat mSpanMultiplier; // the span is unit distance x this (usually 1.0)
 	NSUInteger m_divisionsPerSpan; // the number of divisions per span
@@ -367,7 +370,7 @@ typedef NS_ENUM(NSInteger, DKGridMeasurementSystem) {
  */
 - (void)adjustSpanCycleForViewScale:(CGFloat)scale;
 
-/** @brief Removes the cached paths used to draw the grid when a grid parameter is changed
+/** @brief Removes the cached paths and tiles used to draw the grid when a grid parameter is changed
  
  The grid is cached to help speed up drawing, and is only recalculated when necessary.
  */
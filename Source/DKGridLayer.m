@@ -8,11 +8,86 @@
 #import "DKDrawKitMacros.h"
 #import "DKDrawing.h"
 #import "DKDrawingView.h"
+#import "DKInstrumentation.h"
 #import "LogEvent.h"
 #import "NSBezierPath+Geometry.h"
 #import "NSColor+DKAdditions.h"
+#import "DKQuartzCache.h"
 #include <tgmath.h>
 
+// grid tiles are rendered at about this many device pixels square, and the cache of them is limited to this many bytes
+
+#define GRID_TILE_PIXELS 512
+#define GRID_TILE_CACHE_LIMIT (32 * 1024 * 1024)
+
+/** key for a pre-rendered grid tile: the scale bucket it was rendered at, its size and its place within the grid's repeat, and how it was
+ drawn. */
+@interface DKGridTileKey : NSObject <NSCopying> {
+@public
+	CGFloat mScale;
+	CGFloat mLength;
+	NSInteger mColumn;
+	NSInteger mRow;
+	NSColor* mDivisionColour;
+	NSColor* mSpanColour;
+	NSColor* mMajorColour;
+	NSUInteger mFlags;
+}
+@end
+
+@implementation DKGridTileKey
+
+- (NSUInteger)hash
+{
+	return [@(mScale) hash] ^ ([@(mLength) hash] * 31) ^ ((NSUInteger)mColumn * 2654435761U) ^ ((NSUInteger)mRow * 40503U) ^ mFlags;
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKGridTileKey class]])
+		return NO;
+
+	DKGridTileKey* other = object;
+	return other->mScale == mScale && other->mLength == mLength && other->mColumn == mColumn && other->mRow == mRow && other->mFlags == mFlags
+		&& [other->mDivisionColour isEqual:mDivisionColour] && [other->mSpanColour isEqual:mSpanColour] && [other->mMajorColour isEqual:mMajorColour];
+}
+
+- (id)copyWithZone:(NSZone*)zone
+{
+#pragma unused(zone)
+	return self;
+}
+
+@end
+
+enum {
+	kDKGridTileDrawsDivisions = 1 << 0,
+	kDKGridTileDrawsSpans = 1 << 1,
+	kDKGridTileDrawsMajors = 1 << 2
+};
+
+static NSUInteger GridHCF(NSUInteger a, NSUInteger b)
+{
+	while (b != 0) {
+		NSUInteger r = a % b;
+		a = b;
+		b = r;
+	}
+
+	return a;
+}
+
+@interface DKGridLayer ()
+
+- (void)getLineWidthsForScale:(CGFloat)zoom divisions:(CGFloat*)dlw spans:(CGFloat*)slw majors:(CGFloat*)mlw;
+- (BOOL)drawTilesInRect:(NSRect)rect interior:(NSRect)mr divisionColour:(NSColor*)dc majorColour:(NSColor*)mc flags:(NSUInteger)flags view:(DKDrawingView*)aView;
+- (void)drawGridLinesInTileAtOrigin:(NSPoint)origin length:(CGFloat)length scale:(CGFloat)zoom divisionColour:(NSColor*)dc majorColour:(NSColor*)mc flags:(NSUInteger)flags;
+
+@end
+
 #pragma mark Contants(Non - localized)
 NSString* const kDKGridDrawingLayerStandardMetric = @"DK_std_metric";
 NSString* const kDKGridDrawingLayerStandardImperial = @"DK_std_imperial";
@@ -511,6 +586,7 @@ static NSColor* sMajorColour = nil;
 	m_divsCache = nil;
 	m_spanCache = nil;
 	m_majorsCache = nil;
+	[mTileCache removeAllObjects];
 
 	if (m_cgl)
 		CGLayerRelease(m_cgl);
@@ -618,6 +694,234 @@ static NSColor* sMajorColour = nil;
 	}
 }
 
+- (void)getLineWidthsForScale:(CGFloat)zoom divisions:(CGFloat*)dlw spans:(CGFloat*)slw majors:(CGFloat*)mlw
+{
+	// line widths are set so the grid looks much the same at any zoom. A width that would be wider than a pixel is drawn as a hairline.
+
+	*dlw = LIMIT(m_divisionLineWidth / zoom, 0.05, 1.0);
+	*slw = MIN(m_spanLineWidth / zoom, 1.0);
+	*mlw = MIN(m_majorLineWidth / zoom, 1.0);
+
+	if (zoom * *dlw > 1.0)
+		*dlw = 0;
+
+	if (zoom * *slw > 1.0)
+		*slw = 0;
+
+	if (zoom * *mlw > 1.0)
+		*mlw = 0;
+}
+
+- (BOOL)drawTilesInRect:(NSRect)rect interior:(NSRect)mr divisionColour:(NSColor*)dc majorColour:(NSColor*)mc flags:(NSUInteger)flags view:(DKDrawingView*)aView
+{
+	// draws the part of the grid within <rect> by blitting pre-rendered tiles. The grid repeats every so many spans (where a major line
+	// comes round again on a drawn span), so the repeat is cut into a whole number of tiles, or a tile holds a whole number of repeats,
+	// and a tile is identified by the scale it is rendered at and its place within the repeat. Returns NO if tiles can't be used.
+
+	CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
+	CGFloat zoom = [aView scale];
+
+	if (context == NULL || zoom <= 0.0 || m_divisionsPerSpan == 0 || m_spansPerMajor == 0)
+		return NO;
+
+	// tiles are rendered at the device scale, bucketed into quarter-octave steps so that continuous zooming doesn't rebuild them constantly.
+	// The line widths are those the grid would have at the bucket's zoom, so they scale with the tile.
+
+	CGAffineTransform dt = CGContextGetUserSpaceToDeviceSpaceTransform(context);
+	CGFloat deviceScale = sqrt(ABS(dt.a * dt.d - dt.b * dt.c));
+
+	if (deviceScale <= 0.0)
+		return NO;
+
+	CGFloat bucket = pow(2.0, ceil(log2(deviceScale) * 4.0) / 4.0);
+	CGFloat bucketZoom = zoom * bucket / deviceScale;
+
+	NSUInteger cycle = MAX(mSpanCycle, 1u);
+	NSUInteger spansPerRepeat = cycle / GridHCF(cycle, m_spansPerMajor) * m_spansPerMajor;
+	CGFloat divs = [self divisionDistance];
+	CGFloat repeat = divs * m_divisionsPerSpan * spansPerRepeat;
+	CGFloat repeatPixels = repeat * bucket;
+
+	if (!(repeatPixels > 0.0) || !isfinite(repeatPixels))
+		return NO;
+
+	NSInteger phases = 1;
+	CGFloat length = repeat;
+
+	if (repeatPixels > GRID_TILE_PIXELS)
+		phases = (NSInteger)ceil(repeatPixels / GRID_TILE_PIXELS);
+	else
+		length = repeat * floor(GRID_TILE_PIXELS / repeatPixels);
+
+	length /= phases;
+
+	// only the tiles covering the update area are drawn, clipped to the interior allowing for the lines along its edges
+
+	CGFloat dlw, slw, mlw;
+	[self getLineWidthsForScale:zoom
+					  divisions:&dlw
+						  spans:&slw
+						 majors:&mlw];
+
+	CGFloat outset = MAX(MAX(MAX(dlw, slw), mlw), 1.0 / deviceScale) * 0.5;
+	NSRect clip = NSInsetRect(mr, -outset, -outset);
+	NSRect area = NSIntersectionRect(rect, clip);
+
+	if (NSIsEmptyRect(area))
+		return YES;
+
+	NSInteger minCol = floor((NSMinX(area) - NSMinX(mr)) / length);
+	NSInteger maxCol = floor((NSMaxX(area) - NSMinX(mr)) / length);
+	NSInteger minRow = floor((NSMinY(area) - NSMinY(mr)) / length);
+	NSInteger maxRow = floor((NSMaxY(area) - NSMinY(mr)) / length);
+	NSInteger col, row;
+	CGFloat tilePixels = ceil(length * bucket);
+
+	if (mTileCache == nil) {
+		mTileCache = [[NSCache alloc] init];
+		[mTileCache setName:@"DKGridLayer.tiles"];
+		[mTileCache setTotalCostLimit:GRID_TILE_CACHE_LIMIT];
+	}
+
+	SAVE_GRAPHICS_CONTEXT
+
+		NSRectClip(area);
+
+	// adjacent tiles share their edges exactly, so antialiasing is turned off to stop their edges showing as seams
+
+	CGContextSetShouldAntialias(context, false);
+
+	for (row = minRow; row <= maxRow; ++row) {
+		for (col = minCol; col <= maxCol; ++col) {
+			DKGridTileKey* key = [[DKGridTileKey alloc] init];
+
+			key->mScale = bucket;
+			key->mLength = length;
+			key->mColumn = ((col % phases) + phases) % phases;
+			key->mRow = ((row % phases) + phases) % phases;
+			key->mDivisionColour = dc;
+			key->mSpanColour = m_spanColour;
+			key->mMajorColour = mc;
+			key->mFlags = flags;
+
+			DKQuartzCache* tile = [mTileCache objectForKey:key];
+
+			if (tile)
+				DK_INSTRUMENT_COUNT("cache", "grid tile hits", 1);
+			else {
+				DK_INSTRUMENT_COUNT("cache", "grid tile misses", 1);
+
+				tile = [DKQuartzCache cacheForCurrentContextWithSize:NSMakeSize(tilePixels, tilePixels)];
+
+				[tile lockFocusFlipped:NO];
+
+				NSAffineTransform* st = [NSAffineTransform transform];
+				[st scaleBy:tilePixels / length];
+				[st concat];
+
+				[self drawGridLinesInTileAtOrigin:NSMakePoint(key->mColumn * length, key->mRow * length)
+										   length:length
+											scale:bucketZoom
+								   divisionColour:dc
+									  majorColour:mc
+											flags:flags];
+				[tile unlockFocus];
+
+				[mTileCache setObject:tile
+							   forKey:key
+								 cost:(NSUInteger)(tilePixels * tilePixels * 4)];
+			}
+
+			[tile drawInRect:NSMakeRect(NSMinX(mr) + col * length, NSMinY(mr) + row * length, length, length)];
+		}
+	}
+
+	RESTORE_GRAPHICS_CONTEXT
+
+	return YES;
+}
+
+- (void)drawGridLinesInTileAtOrigin:(NSPoint)origin length:(CGFloat)length scale:(CGFloat)zoom divisionColour:(NSColor*)dc majorColour:(NSColor*)mc flags:(NSUInteger)flags
+{
+	// draws the grid lines crossing the square {origin, length}, measured from the grid's origin, with the square drawn at {0, 0}. Lines
+	// are numbered by division from the grid's origin: every division is drawn, and at the start of each drawn span cycle is a span or
+	// major line, as -createGridCacheInRect: lays them out. Lines just outside the square are included so their edges join up with the
+	// neighbouring tiles.
+
+	NSBezierPath* divsPath = [NSBezierPath bezierPath];
+	NSBezierPath* spanPath = [NSBezierPath bezierPath];
+	NSBezierPath* majorsPath = [NSBezierPath bezierPath];
+	CGFloat divs = [self divisionDistance];
+	NSUInteger cycle = MAX(mSpanCycle, 1u);
+	NSUInteger perCycle = m_divisionsPerSpan * cycle;
+	CGFloat dlw, slw, mlw;
+
+	[self getLineWidthsForScale:zoom
+					  divisions:&dlw
+						  spans:&slw
+						 majors:&mlw];
+
+	CGFloat margin = MAX(MAX(dlw, slw), mlw) + 1.0 / zoom;
+	NSInteger axis, k;
+
+	for (axis = 0; axis < 2; ++axis) {
+		CGFloat start = axis == 0 ? origin.x : origin.y;
+		NSInteger first = ceil((start - margin) / divs);
+		NSInteger last = floor((start + length + margin) / divs);
+
+		for (k = first; k <= last; ++k) {
+			CGFloat p = k * divs - start;
+			NSPoint a, b;
+
+			if (axis == 0) {
+				a = NSMakePoint(p, -margin);
+				b = NSMakePoint(p, length + margin);
+			} else {
+				a = NSMakePoint(-margin, p);
+				b = NSMakePoint(length + margin, p);
+			}
+
+			[divsPath moveToPoint:a];
+			[divsPath lineToPoint:b];
+
+			NSUInteger index = (NSUInteger)((k % (NSInteger)perCycle + (NSInteger)perCycle) % (NSInteger)perCycle);
+
+			if (index == 0) {
+				// the span number of the line, within the spans it takes for a major line to come round again
+
+				NSInteger step = (k - (NSInteger)index) / (NSInteger)perCycle;
+				NSInteger m = (step * (NSInteger)cycle) % (NSInteger)m_spansPerMajor;
+
+				if (m == 0) {
+					[majorsPath moveToPoint:a];
+					[majorsPath lineToPoint:b];
+				} else {
+					[spanPath moveToPoint:a];
+					[spanPath lineToPoint:b];
+				}
+			}
+		}
+	}
+
+	if (flags & kDKGridTileDrawsDivisions) {
+		[divsPath setLineWidth:dlw];
+		[dc setStroke];
+		[divsPath stroke];
+	}
+
+	if (flags & kDKGridTileDrawsSpans) {
+		[spanPath setLineWidth:slw];
+		[m_spanColour setStroke];
+		[spanPath stroke];
+	}
+
+	if (flags & kDKGridTileDrawsMajors) {
+		[majorsPath setLineWidth:mlw];
+		[mc setStroke];
+		[majorsPath stroke];
+	}
+}
+
 - (void)drawBorderOutline:(DKDrawingView*)aView
 {
 	CGFloat zoom = [aView scale];
@@ -659,17 +963,12 @@ static NSColor* sMajorColour = nil;
  */
 - (void)drawRect:(NSRect)rect inView:(DKDrawingView*)aView
 {
-#pragma unused(rect)
-
 	// if the view scale has crossed the threshold for span cycle change, invalidate the cache
 
 	[self adjustSpanCycleForViewScale:[aView scale]];
 
 	NSRect mr = [[self drawing] interior];
 
-	if (m_divsCache == nil)
-		[self createGridCacheInRect:mr];
-
 	// be smart about colour: if the drawing has a dark background, switch the divs and majors colours to give better contrast
 	// this is very rarely required but for some unusual situations gives a more usable/visible grid.
 
@@ -683,37 +982,56 @@ static NSColor* sMajorColour = nil;
 		dc = m_majorColour;
 	}
 
+	CGFloat zoom = [aView scale];
+	NSUInteger flags = 0;
+
+	if (mDrawsDivisions && zoom >= mDivsSupressionScale)
+		flags |= kDKGridTileDrawsDivisions;
+
+	if (mDrawsSpans && zoom >= mSpanSupressionScale)
+		flags |= kDKGridTileDrawsSpans;
+
+	if (mDrawsMajors)
+		flags |= kDKGridTileDrawsMajors;
+
+	// on screen, the grid is blitted from pre-rendered tiles covering only the area being updated. The paths are still used for printing
+	// and PDF output, where the grid should stay resolution-independent.
+
+	if ([[NSGraphicsContext currentContext] isDrawingToScreen] && [self drawTilesInRect:rect
+																			interior:mr
+																	  divisionColour:dc
+																		 majorColour:mc
+																			   flags:flags
+																				view:aView]) {
+		[self drawBorderOutline:aView];
+		return;
+	}
+
+	if (m_divsCache == nil)
+		[self createGridCacheInRect:mr];
+
 	// draw directly from the cache. Apply the linewidth accounting for the view's scale factor
 
-	CGFloat zoom = [aView scale];
 	CGFloat dlw, slw, mlw;
 
-	dlw = LIMIT(m_divisionLineWidth / zoom, 0.05, 1.0);
-	slw = MIN(m_spanLineWidth / zoom, 1.0);
-	mlw = MIN(m_majorLineWidth / zoom, 1.0);
-
-	if (mDrawsDivisions && zoom >= mDivsSupressionScale) {
-		if (zoom * dlw > 1.0)
-			dlw = 0;
+	[self getLineWidthsForScale:zoom
+					  divisions:&dlw
+						  spans:&slw
+						 majors:&mlw];
 
+	if (flags & kDKGridTileDrawsDivisions) {
 		[m_divsCache setLineWidth:dlw];
 		[dc setStroke];
 		[m_divsCache stroke];
 	}
 
-	if (mDrawsSpans && zoom >= mSpanSupressionScale) {
-		if (zoom * slw > 1.0)
-			slw = 0;
-
+	if (flags & kDKGridTileDrawsSpans) {
 		[m_spanCache setLineWidth:slw];
 		[m_spanColour setStroke];
 		[m_spanCache stroke];
 	}
 
-	if (mDrawsMajors) {
-		if (zoom * mlw > 1.0)
-			mlw = 0;
-
+	if (flags & kDKGridTileDrawsMajors) {
 		[m_majorsCache setLineWidth:mlw];
 		[mc setStroke];
 		[m_majorsCache stroke];
@@ -35,6 +35,9 @@ NS_ASSUME_NONNULL_BEGIN
 	CGFloat m_snapTolerance; // the current snap tolerance value
 	NSRect mGuideDeletionZone; // guides dragged outside this rect are deleted
 	BOOL mDrawGuidesInClipView; // if YES, guides are extended to be drawn in the clip view of an enclosing scroller
+	NSMutableData* mSortedVGuides; // vertical guides sorted by position, for nearest guide searches
+	NSMutableData* mSortedHGuides; // horizontal guides sorted by position, for nearest guide searches
+	BOOL mSortedGuidesValid; // NO once guides have been added or removed since the sorted lists were built
 }
 
 // default snapping tolerance:
@@ -264,6 +267,7 @@ NS_ASSUME_NONNULL_BEGIN
 	CGFloat m_position;
 	BOOL m_isVertical;
 	NSColor* m_colour;
+	DKGuideLayer* __weak mLayerRef; // the layer the guide is in, which is told when it moves
 }
 
 /** @brief Sets the position of the guide
@@ -25,9 +25,127 @@
  */
 - (void)repositionGuide:(DKGuide*)guide atPoint:(NSPoint)p inView:(NSView*)aView;
 - (NSRect)guideRectOfGuide:(DKGuide*)guide forEnclosingClipViewOfView:(NSView*)aView;
+- (void)updateSortedGuides;
+- (void)guide:(DKGuide*)guide didMoveFromPosition:(CGFloat)oldPosition;
 
 @end
 
+@interface DKGuide ()
+
+@property (weak, nullable) DKGuideLayer* layer;
+
+@end
+
+// a guide in a list sorted by position. The guide is retained by the layer's guide lists.
+
+typedef struct {
+	CGFloat position;
+	__unsafe_unretained DKGuide* guide;
+} DKSortedGuide;
+
+static int DKCompareSortedGuides(const void* a, const void* b)
+{
+	CGFloat pa = ((const DKSortedGuide*)a)->position;
+	CGFloat pb = ((const DKSortedGuide*)b)->position;
+
+	return (pa > pb) - (pa < pb);
+}
+
+static NSMutableData* DKSortedGuideList(NSArray<DKGuide*>* guides)
+{
+	NSMutableData* list = [NSMutableData dataWithLength:[guides count] * sizeof(DKSortedGuide)];
+	DKSortedGuide* sg = [list mutableBytes];
+	NSUInteger i = 0;
+
+	for (DKGuide* guide in guides) {
+		sg[i].position = [guide guidePosition];
+		sg[i++].guide = guide;
+	}
+
+	qsort(sg, i, sizeof(DKSortedGuide), DKCompareSortedGuides);
+	return list;
+}
+
+// the index in a sorted list at which a guide at <pos> would be inserted, after any guides already there
+
+static NSUInteger DKSortedGuideInsertionIndex(const DKSortedGuide* sg, NSUInteger count, CGFloat pos)
+{
+	NSUInteger lo = 0, hi = count;
+
+	while (lo < hi) {
+		NSUInteger mid = (lo + hi) / 2;
+
+		if (sg[mid].position <= pos)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+// moves a guide that was at <oldPosition> to its new place in a sorted list, shifting the guides in between along by one. Returns NO if
+// the guide isn't in the list at that position.
+
+static BOOL DKMoveSortedGuide(NSMutableData* list, DKGuide* guide, CGFloat oldPosition)
+{
+	DKSortedGuide* sg = [list mutableBytes];
+	NSUInteger count = [list length] / sizeof(DKSortedGuide);
+	NSUInteger from = DKSortedGuideInsertionIndex(sg, count, oldPosition);
+
+	// the guide is the last at its old position or, where others share it, one of those before
+
+	while (from > 0 && sg[from - 1].guide != guide && sg[from - 1].position == oldPosition)
+		--from;
+
+	if (from == 0 || sg[from - 1].guide != guide)
+		return NO;
+
+	DKSortedGuide moved = sg[--from];
+
+	memmove(sg + from, sg + from + 1, (count - from - 1) * sizeof(DKSortedGuide));
+	moved.position = [guide guidePosition];
+
+	NSUInteger to = DKSortedGuideInsertionIndex(sg, count - 1, moved.position);
+
+	memmove(sg + to + 1, sg + to, (count - 1 - to) * sizeof(DKSortedGuide));
+	sg[to] = moved;
+	return YES;
+}
+
+// finds the guide nearest to <pos> by binary search, or nil if none is nearer than <tolerance>
+
+static DKGuide* DKNearestSortedGuide(NSData* list, CGFloat pos, CGFloat tolerance)
+{
+	const DKSortedGuide* sg = [list bytes];
+	NSUInteger lo = 0, hi = [list length] / sizeof(DKSortedGuide);
+	NSUInteger count = hi;
+
+	while (lo < hi) {
+		NSUInteger mid = (lo + hi) / 2;
+
+		if (sg[mid].position < pos)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	// the nearest is either the first guide at or after <pos>, or the one before it
+
+	DKGuide* nearestGuide = nil;
+	CGFloat nearestDistance = tolerance;
+
+	if (lo < count && fabs(sg[lo].position - pos) < nearestDistance) {
+		nearestDistance = fabs(sg[lo].position - pos);
+		nearestGuide = sg[lo].guide;
+	}
+
+	if (lo > 0 && fabs(sg[lo - 1].position - pos) < nearestDistance)
+		nearestGuide = sg[lo - 1].guide;
+
+	return nearestGuide;
+}
+
 #pragma mark Static Vars
 static CGFloat sSnapTolerance = 6.0;
 
@@ -74,6 +192,9 @@ static BOOL sWasInside = NO;
 	else
 		[m_hGuides addObject:guide];
 
+	[guide setLayer:self];
+	mSortedGuidesValid = NO;
+
 	[guide setGuideColour:[self guideColour]];
 	[self refreshGuide:guide];
 
@@ -97,6 +218,11 @@ static BOOL sWasInside = NO;
 	else
 		[m_hGuides removeObject:guide];
 
+	if ([guide layer] == self)
+		[guide setLayer:nil];
+
+	mSortedGuidesValid = NO;
+
 	if (!([[self undoManager] isUndoing] || [[self undoManager] isRedoing]))
 		[[self undoManager] setActionName:NSLocalizedString(@"Delete Guide", @"undo action for Remove Guide")];
 }
@@ -108,8 +234,13 @@ static BOOL sWasInside = NO;
 	if (![self locked]) {
 		[[[self undoManager] prepareWithInvocationTarget:self] setGuides:[self guides]];
 
+		[m_vGuides makeObjectsPerformSelector:@selector(setLayer:)
+								   withObject:nil];
+		[m_hGuides makeObjectsPerformSelector:@selector(setLayer:)
+								   withObject:nil];
 		[m_vGuides removeAllObjects];
 		[m_hGuides removeAllObjects];
+		mSortedGuidesValid = NO;
 		[self setNeedsDisplay:YES];
 	}
 }
@@ -122,19 +253,8 @@ static BOOL sWasInside = NO;
  */
 - (DKGuide*)nearestVerticalGuideToPosition:(CGFloat)pos
 {
-	DKGuide* nearestGuide = nil;
-	CGFloat nearestDistance = 10000, distance;
-
-	for (DKGuide* guide in [self verticalGuides]) {
-		distance = fabs(pos - [guide guidePosition]);
-
-		if (distance < [self snapTolerance] && distance < nearestDistance) {
-			nearestDistance = distance;
-			nearestGuide = guide;
-		}
-	}
-
-	return nearestGuide;
+	[self updateSortedGuides];
+	return DKNearestSortedGuide(mSortedVGuides, pos, [self snapTolerance]);
 }
 
 /** @brief Locates the nearest guide to the given position, if position is within the snap tolerance
@@ -143,19 +263,31 @@ static BOOL sWasInside = NO;
  */
 - (DKGuide*)nearestHorizontalGuideToPosition:(CGFloat)pos
 {
-	DKGuide* nearestGuide = nil;
-	CGFloat nearestDistance = 10000, distance;
-
-	for (DKGuide* guide in [self horizontalGuides]) {
-		distance = fabs(pos - [guide guidePosition]);
+	[self updateSortedGuides];
+	return DKNearestSortedGuide(mSortedHGuides, pos, [self snapTolerance]);
+}
 
-		if (distance < [self snapTolerance] && distance < nearestDistance) {
-			nearestDistance = distance;
-			nearestGuide = guide;
-		}
+/** @brief Rebuilds the sorted guide lists if any guide has been added or removed since they were last built
+ */
+- (void)updateSortedGuides
+{
+	if (!mSortedGuidesValid) {
+		mSortedVGuides = DKSortedGuideList(m_vGuides);
+		mSortedHGuides = DKSortedGuideList(m_hGuides);
+		mSortedGuidesValid = YES;
 	}
+}
 
-	return nearestGuide;
+/** @brief Keeps the sorted guide lists in order when one of the layer's guides is moved
+
+ Only the moved guide's entry is shifted, so dragging a guide doesn't sort all of the guides again on every mouse event.
+ @param guide the guide that moved
+ @param oldPosition where it was
+ */
+- (void)guide:(DKGuide*)guide didMoveFromPosition:(CGFloat)oldPosition
+{
+	if (mSortedGuidesValid && !DKMoveSortedGuide([guide isVerticalGuide] ? mSortedVGuides : mSortedHGuides, guide, oldPosition))
+		mSortedGuidesValid = NO;
 }
 
 /** @brief Returns the list of vertical guides
@@ -1029,6 +1161,10 @@ static BOOL sWasInside = NO;
 	if (self != nil) {
 		m_hGuides = [[coder decodeObjectForKey:@"horizontalguides"] mutableCopy];
 		m_vGuides = [[coder decodeObjectForKey:@"verticalguides"] mutableCopy];
+		[m_hGuides makeObjectsPerformSelector:@selector(setLayer:)
+								   withObject:self];
+		[m_vGuides makeObjectsPerformSelector:@selector(setLayer:)
+								   withObject:self];
 
 		m_snapToGrid = [coder decodeBoolForKey:@"snapstogrid"];
 		m_showDragInfo = [coder decodeBoolForKey:@"showdraginfo"];
@@ -1068,8 +1204,23 @@ static BOOL sWasInside = NO;
 @implementation DKGuide
 #pragma mark As a DKGuide
 
-@synthesize guidePosition = m_position;
+- (CGFloat)guidePosition
+{
+	return m_position;
+}
+
+- (void)setGuidePosition:(CGFloat)position
+{
+	CGFloat oldPosition = m_position;
+
+	m_position = position;
+
+	if (position != oldPosition)
+		[mLayerRef guide:self
+			didMoveFromPosition:oldPosition];
+}
 @synthesize isVerticalGuide = m_isVertical;
+@synthesize layer = mLayerRef;
 @synthesize guideColour = m_colour;
 
 /** @brief Draws the guide
@@ -44,6 +44,16 @@ DKHandle is a base class for all handles, which are the knobs attached to shapes
 
 - (void)drawAtPoint:(NSPoint)point;
 - (void)drawAtPoint:(NSPoint)point angle:(CGFloat)radians;
+
+/** @brief Draws the handle at many points with a single graphics state setup.
+
+ Handles that lie outside the current clip, or that would land on the same device pixel as one already drawn by this call, are skipped.
+ Each handle is placed and sized as -drawAtPoint:angle: would place it, but drawn with the context's current alpha and blend mode.
+ @param points the handle centres
+ @param angles the angle of each handle, or NULL if none are rotated
+ @param count the number of points
+ */
+- (void)drawAtPoints:(const NSPoint*)points angles:(nullable const CGFloat*)angles count:(NSUInteger)count;
 - (BOOL)hitTestPoint:(NSPoint)point inHandleAtPoint:(NSPoint)hp;
 
 @end
@@ -16,6 +16,7 @@
 @interface DKHandle ()
 
 + (NSString*)keyForKnobType:(DKKnobType)type;
+- (DKQuartzCache*)cache;
 
 @end
 
@@ -179,8 +180,10 @@ static NSMutableDictionary* s_handleInstancesTable = nil;
 				angle:0];
 }
 
-- (void)drawAtPoint:(NSPoint)point angle:(CGFloat)radians
+- (DKQuartzCache*)cache
 {
+	// the handle is rendered once into a cache at its screen size, and all subsequent drawing uses the cache
+
 	if (mCache == nil) {
 		mCache = [DKQuartzCache cacheForCurrentContextWithSize:[self size]];
 
@@ -207,6 +210,13 @@ static NSMutableDictionary* s_handleInstancesTable = nil;
 		[mCache unlockFocus];
 	}
 
+	return mCache;
+}
+
+- (void)drawAtPoint:(NSPoint)point angle:(CGFloat)radians
+{
+	DKQuartzCache* cache = [self cache];
+
 	// offset the point to the top, left of the bounds
 
 	SAVE_GRAPHICS_CONTEXT
@@ -229,9 +239,93 @@ static NSMutableDictionary* s_handleInstancesTable = nil;
 	newTfm = CGAffineTransformTranslate(newTfm, -[self size].width * 0.5, -[self size].height * 0.5);
 	CGContextConcatCTM(context, newTfm);
 
-	[mCache drawAtPoint:NSZeroPoint];
+	[cache drawAtPoint:NSZeroPoint];
+
+	RESTORE_GRAPHICS_CONTEXT
+}
+
+- (void)drawAtPoints:(const NSPoint*)points angles:(const CGFloat*)angles count:(NSUInteger)count
+{
+	if (count == 0)
+		return;
+
+	// handles that land on the same device pixel are drawn once. The pixels already drawn are kept in a small open-addressed hash set,
+	// zero marking an empty slot (so real keys have their top bit set).
+
+	NSUInteger slots = 64;
+
+	while (slots < count * 2)
+		slots <<= 1;
+
+	uint64_t* drawn = calloc(slots, sizeof(uint64_t));
+
+	if (drawn == NULL)
+		return;
+
+	DKQuartzCache* cache = [self cache];
+
+	SAVE_GRAPHICS_CONTEXT
+
+	CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
+	CGAffineTransform ctm = CGContextGetCTM(context);
+	CGFloat compScale = 1.0 / ctm.a;
+	NSSize size = [self size];
+
+	// anything further than the half-diagonal from the clip can't be seen, whatever its angle
+
+	CGFloat reach = hypot(size.width, size.height) * compScale * 0.5;
+	CGRect visible = CGRectInset(CGContextGetClipBoundingBox(context), -reach, -reach);
+
+	NSUInteger i;
+
+	for (i = 0; i < count; ++i) {
+		NSPoint p = points[i];
+		CGFloat radians = angles ? angles[i] : 0.0;
+
+		if (!CGRectContainsPoint(visible, p))
+			continue;
+
+		if (radians == 0.0) {
+			CGPoint dp = CGPointApplyAffineTransform(p, ctm);
+			uint64_t key = ((uint64_t)(uint32_t)(int32_t)floor(dp.x) << 32) | (uint32_t)(int32_t)floor(dp.y);
+			key |= 1ULL << 63;
+
+			NSUInteger h = (NSUInteger)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (slots - 1);
+			BOOL seen = NO;
+
+			while (drawn[h] != 0) {
+				if (drawn[h] == key) {
+					seen = YES;
+					break;
+				}
+				h = (h + 1) & (slots - 1);
+			}
+
+			if (seen)
+				continue;
+
+			drawn[h] = key;
+		}
+
+		// placed exactly as -drawAtPoint:angle: places it, but drawn with the context's own alpha and blend mode
+
+		CGAffineTransform tfm = CGAffineTransformMakeTranslation(p.x, p.y);
+
+		if (radians != 0.0)
+			tfm = CGAffineTransformRotate(tfm, radians);
+
+		tfm = CGAffineTransformScale(tfm, compScale, compScale);
+		tfm = CGAffineTransformTranslate(tfm, -size.width * 0.5, -size.height * 0.5);
+
+		CGContextSaveGState(context);
+		CGContextConcatCTM(context, tfm);
+		[cache drawInRect:NSMakeRect(0, 0, size.width, size.height)];
+		CGContextRestoreGState(context);
+	}
 
 	RESTORE_GRAPHICS_CONTEXT
+
+	free(drawn);
 }
 
 - (BOOL)hitTestPoint:(NSPoint)point inHandleAtPoint:(NSPoint)hp
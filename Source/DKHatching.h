@@ -6,6 +6,7 @@
 
 #import <Cocoa/Cocoa.h>
 #import "DKDashable.h"
+#import "DKRandom.h"
 #import "DKRasterizer.h"
 
 NS_ASSUME_NONNULL_BEGIN
@@ -19,14 +20,17 @@ NS_ASSUME_NONNULL_BEGIN
 
  Can be set as a fill style in a \c DKStyle object.
 
- The hatch is cached in an \c NSBezierPath object based on the bounds of the path. If another path is hatched that is smaller
- than the cached size, it is not rebuilt. It is rebuilt if the angle or spacing changes or a bigger path is hatched. Linewidth also
- doesn't change the cache.
+ The hatch lines are intersected directly with the path being hatched, so only the spans that lie inside the path are generated.
+ The result is exact, which also makes it suitable for vector export and plotting (see \c -hatchPathForPath:objectAngle:). When
+ rendering a \c DKRenderable that provides a rendering cache, the hatch for that object is cached there until the object's geometry or
+ the hatch parameters change. The dash and line width are among them, since a dash scaled to the line width sets where the hatch lines
+ are broken.
 */
 @interface DKHatching : DKRasterizer <NSCoding, NSCopying, DKDashable> {
 @private
-	NSBezierPath* m_cache;
-	NSBezierPath* mRoughenedCache;
+	NSUInteger mGeneration;
+	NSUInteger mRoughGeneration;
+	DKRandomSeed mWobbleSeed;
 	NSColor* m_hatchColour;
 	DKStrokeDash* m_hatchDash;
 	NSLineCapStyle m_cap;
@@ -87,6 +91,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)hatchPath:(NSBezierPath*)path objectAngle:(CGFloat)oa;
 
+/** @brief Return the hatch lines that lie within the path.
+
+ The hatch line family is intersected with the flattened path using the path's winding rule, and only the interior spans are
+ returned, as a series of separate straight line subpaths. If the hatching is dashed, each span is extended back to the nearest
+ start of the dash pattern so that dashes (and dots) stay aligned from line to line - this can place a small part of a span just
+ outside the path, which is hidden by clipping to the path.
+ @param path The path to fill.
+ @param oa The additional angle to apply, in radians.
+ @return A path consisting of the hatch line spans, or \c nil if the path is empty.
+ */
+- (nullable NSBezierPath*)hatchPathForPath:(NSBezierPath*)path objectAngle:(CGFloat)oa;
+
 /** @brief The angle of the hatching, in radians.
  */
 @property (nonatomic) CGFloat angle;
@@ -111,13 +127,15 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic) CGFloat roughness;
 @property (nonatomic) CGFloat wobblyness;
 
+/** @brief The seed from which the wobble and roughening are derived. New hatchings get an unpredictable seed; it is archived and copied. */
+@property (nonatomic) DKRandomSeed seed;
+
 - (void)invalidateCache;
-/**
- this does the actual work of calculating the hatch. Given the rect, we build a series of lines at the origin in a square
- based on the largest side of <code>rect *~ sqrt(2)</code>. Then we transform the cache to the current angle. This is much simpler than
- calculating where to start and end each line.
-*/
-- (void)calcHatchInRect:(NSRect)rect;
+
+/** @brief Formerly made a square of hatch lines big enough to cover the rect, for clipping to the path.
+ @deprecated no longer does anything - hatches are made to fit each path by \c -hatchPathForPath:objectAngle:
+ */
+- (void)calcHatchInRect:(NSRect)rect DEPRECATED_ATTRIBUTE;
 @end
 
 NS_ASSUME_NONNULL_END
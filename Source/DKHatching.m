@@ -10,9 +10,52 @@
 #import "DKStrokeDash.h"
 #import "NSBezierPath+Geometry.h"
 
+static NSString* const kDKHatchingCacheGenerationKey = @"DKHatching_generation";
+static NSString* const kDKHatchingCacheRoughGenerationKey = @"DKHatching_roughGeneration";
+static NSString* const kDKHatchingCacheAngleKey = @"DKHatching_angle";
+static NSString* const kDKHatchingCacheBoundsKey = @"DKHatching_bounds";
+static NSString* const kDKHatchingCacheChecksumKey = @"DKHatching_checksum";
+static NSString* const kDKHatchingCacheDashKey = @"DKHatching_dash";
+static NSString* const kDKHatchingCachePathKey = @"DKHatching_path";
+static NSString* const kDKHatchingCacheRoughPathKey = @"DKHatching_roughPath";
+
+// generations are unique across all hatchings, so a cache entry can never be mistaken for one made by another (or earlier) hatching
+
+static NSUInteger sHatchGeneration = 0;
+
+typedef struct {
+	CGFloat t; // position along the hatch line, 0..1
+	NSInteger dir; // +1 or -1 depending on which way the path edge crosses the line
+} DKHatchCrossing;
+
+static int CompareHatchCrossings(const void* a, const void* b)
+{
+	CGFloat ta = ((const DKHatchCrossing*)a)->t;
+	CGFloat tb = ((const DKHatchCrossing*)b)->t;
+
+	return (ta < tb) ? -1 : ((ta > tb) ? 1 : 0);
+}
+
+static CGFloat HatchWobble(DKRandomSeed seed, NSInteger line, NSUInteger end)
+{
+	// a value in -0.5..0.5 that depends only on the seed and the line number, so each line keeps the same wobble however the hatched shape changes
+
+	return DKRandomSignedValue(seed, (uint64_t)line * 2 + end);
+}
+
+static void HatchLinesNearEdge(NSPoint p, NSPoint q, CGFloat leadIn, CGFloat spacing, CGFloat maxWobble, NSInteger* first, NSInteger* last)
+{
+	// the numbers of the first and last hatch lines that could cross the edge pq, however far they wobble
+
+	*first = floor((MIN(p.x, q.x) - maxWobble - leadIn) / spacing);
+	*last = ceil((MAX(p.x, q.x) + maxWobble - leadIn) / spacing);
+}
+
 @interface DKHatching ()
 
 - (void)invalidateRoughnessCache;
+- (void)strokeHatch:(NSBezierPath*)hatch roughHatch:(NSBezierPath*)roughHatch clippedToPath:(NSBezierPath*)path;
+- (NSBezierPath*)roughHatchForHatch:(NSBezierPath*)hatch;
 
 @end
 
@@ -116,90 +159,284 @@
  */
 - (void)hatchPath:(NSBezierPath*)path objectAngle:(CGFloat)oa
 {
-	// if the bounds size of <path> is larger than the cached hatch, then we'll need to enlarge the cache, so invalidate
-	// it.
+	NSBezierPath* hatch = [self hatchPathForPath:path
+									 objectAngle:oa];
+
+	if (hatch)
+		[self strokeHatch:hatch
+			   roughHatch:mRoughenStrokes ? [self roughHatchForHatch:hatch] : nil
+			clippedToPath:path];
+}
+
+/** @brief Return the hatch lines that lie within the path
+
+ The path is flattened and rotated into the hatch's frame, where the hatch lines are parallel to the y axis and spaced along
+ x from the centre of the path's bounds. Each line is then intersected with every edge that spans it, recording the direction
+ of each crossing, and the crossings sorted along the line give the interior spans according to the path's winding rule -
+ the same principle as -intersectingPointsWithHorizontalLineAtY:, but flattening only once for the whole family of lines.
+ @param path the path to fill
+ @param oa the additional angle to apply, in radians
+ @return the hatch spans, or nil
+ */
+- (NSBezierPath*)hatchPathForPath:(NSBezierPath*)path objectAngle:(CGFloat)oa
+{
+	if (path == nil || [path isEmpty] || [self spacing] <= 0.0)
+		return nil;
+
+	NSRect br = [path bounds];
+	NSPoint cp = NSMakePoint(NSMidX(br), NSMidY(br));
+
+	NSAffineTransform* toHatch = [NSAffineTransform transform];
+	[toHatch rotateByRadians:-([self angle] + oa)];
+	[toHatch translateXBy:-cp.x
+					  yBy:-cp.y];
 
-	NSRect cr, br = [path bounds];
+	NSBezierPath* flat = [[toHatch transformBezierPath:path] bezierPathByFlatteningPath];
+	NSInteger i, m = [flat elementCount];
+
+	if (m < 2)
+		return nil;
 
-	if (m_cache) {
-		cr = [m_cache bounds];
+	// gather the edges. Subpaths are implicitly closed, as they are when filled.
 
-		if ((br.size.width * 1.5) > cr.size.width || (br.size.height * 1.5) > cr.size.height)
-			[self invalidateCache];
+	NSPoint* edges = malloc(sizeof(NSPoint) * 2 * (m + 1));
+	NSInteger edgeCount = 0;
+	NSPoint ap[3], fp, lp, p, q;
+	NSBezierPathElement element;
+
+	fp = lp = NSZeroPoint;
+
+	for (i = 0; i <= m; ++i) {
+		element = (i < m) ? [flat elementAtIndex:i
+								associatedPoints:ap]
+						  : NSMoveToBezierPathElement;
+
+		if (element == NSMoveToBezierPathElement || element == NSClosePathBezierPathElement) {
+			if (!NSEqualPoints(lp, fp)) {
+				edges[edgeCount * 2] = lp;
+				edges[edgeCount * 2 + 1] = fp;
+				++edgeCount;
+			}
+
+			if (element == NSMoveToBezierPathElement)
+				fp = ap[0];
+
+			lp = fp;
+		} else {
+			edges[edgeCount * 2] = lp;
+			edges[edgeCount * 2 + 1] = ap[0];
+			++edgeCount;
+			lp = ap[0];
+		}
 	}
 
-	if (m_cache == nil)
-		[self calcHatchInRect:br];
+	NSRect fb = [flat bounds];
+	CGFloat spacing = [self spacing];
+	CGFloat maxWobble = mWobblyness * spacing;
+	CGFloat dashLength = 0.0;
 
-	NSAssert(m_cache != nil, @"couldn't craete the hatch cache");
+	if ([self dash]) {
+		dashLength = [[self dash] length];
 
-	if (m_cache) {
-		cr = [m_cache bounds];
+		if ([[self dash] scalesToLineWidth])
+			dashLength *= [self width];
+	}
 
-		// now we have a hatch cached, set the clip to the path and draw the hatch. The hatch cache always has its
-		// path centred at the origin so we also need to transform the cache to the drawn position
+	NSInteger firstLine = floor((NSMinX(fb) - maxWobble - m_leadIn) / spacing);
+	NSInteger lastLine = ceil((NSMaxX(fb) + maxWobble - m_leadIn) / spacing);
+	NSInteger lineCount = lastLine - firstLine + 1;
+	NSInteger line, lo, hi, e, c, crossingCount, winding;
 
-		SAVE_GRAPHICS_CONTEXT //[NSGraphicsContext saveGraphicsState];
-			[path addClip];
+	// file each edge under the lines it could reach, allowing for wobble, so that each line is only tested against the edges near it
+	// rather than every edge of the path. The counts are gathered a line ahead, so that after filling, each start has moved up to the
+	// next line's and the starts need only be shifted back.
 
-		// enforce a minimum line width of 0.1 - sizees of zero do not print.
+	NSUInteger* lineStarts = calloc(lineCount + 1, sizeof(NSUInteger));
+	NSUInteger k;
 
-		CGFloat actualLineWidth = [self width];
+	for (e = 0; e < edgeCount; ++e) {
+		p = edges[e * 2];
+		q = edges[e * 2 + 1];
 
-		if (![NSGraphicsContext currentContextDrawingToScreen]) {
-			if (actualLineWidth <= 0.0)
-				actualLineWidth = 0.05; // hairline
+		HatchLinesNearEdge(p, q, m_leadIn, spacing, maxWobble, &lo, &hi);
+
+		for (line = MAX(lo, firstLine); line <= MIN(hi, lastLine); ++line)
+			++lineStarts[line - firstLine + 1];
+	}
+
+	for (line = 0; line < lineCount; ++line)
+		lineStarts[line + 1] += lineStarts[line];
+
+	NSUInteger* lineEdges = malloc(sizeof(NSUInteger) * MAX(lineStarts[lineCount], 1));
+
+	for (e = 0; e < edgeCount; ++e) {
+		p = edges[e * 2];
+		q = edges[e * 2 + 1];
+
+		HatchLinesNearEdge(p, q, m_leadIn, spacing, maxWobble, &lo, &hi);
+
+		for (line = MAX(lo, firstLine); line <= MIN(hi, lastLine); ++line)
+			lineEdges[lineStarts[line - firstLine]++] = e;
+	}
+
+	for (line = lineCount; line > 0; --line)
+		lineStarts[line] = lineStarts[line - 1];
+
+	lineStarts[0] = 0;
+
+	DKHatchCrossing* crossings = malloc(sizeof(DKHatchCrossing) * MAX(edgeCount, 1));
+	NSBezierPath* hatch = [NSBezierPath bezierPath];
+	BOOL evenOdd = ([path windingRule] == NSEvenOddWindingRule);
+	NSPoint a, b, d, pa, pb;
+	CGFloat sp, sq, u, len2, enter, t;
+
+	a.y = NSMinY(fb) - 1.0;
+	b.y = NSMaxY(fb) + 1.0;
+
+	for (line = firstLine; line <= lastLine; ++line) {
+		// wobblyness is a randomising factor 0..1 which displaces the end points of the hatch by an amount relative to the spacing.
+		// It is used to give a more naturalistic type of hatch (esp. in conjunction with roughness).
+
+		a.x = m_leadIn + line * spacing;
+		b.x = a.x;
+
+		if (maxWobble > 0.0) {
+			a.x += HatchWobble(mWobbleSeed, line, 0) * maxWobble;
+			b.x += HatchWobble(mWobbleSeed, line, 1) * maxWobble;
 		}
 
-		[m_cache setLineWidth:actualLineWidth];
+		d.x = b.x - a.x;
+		d.y = b.y - a.y;
+		len2 = d.x * d.x + d.y * d.y;
+		crossingCount = 0;
 
-		if ([self dash])
-			[[self dash] applyToPath:m_cache];
-		else
-			[m_cache setLineDash:nil
-						   count:0
-						   phase:0.0];
+		for (k = lineStarts[line - firstLine]; k < lineStarts[line - firstLine + 1]; ++k) {
+			e = lineEdges[k];
+			p = edges[e * 2];
+			q = edges[e * 2 + 1];
+
+			// trivially reject edges entirely to one side of the line
+
+			if (MAX(p.x, q.x) < MIN(a.x, b.x) || MIN(p.x, q.x) > MAX(a.x, b.x))
+				continue;
+
+			// signed distances of the edge end points from the line. A vertex exactly on the line counts as being on the positive side,
+			// so that an edge chain passing through it is counted once.
+
+			sp = d.x * (p.y - a.y) - d.y * (p.x - a.x);
+			sq = d.x * (q.y - a.y) - d.y * (q.x - a.x);
+
+			if ((sp >= 0.0) == (sq >= 0.0))
+				continue;
+
+			u = sp / (sp - sq);
+			t = ((p.x + u * (q.x - p.x) - a.x) * d.x + (p.y + u * (q.y - p.y) - a.y) * d.y) / len2;
+
+			crossings[crossingCount].t = t;
+			crossings[crossingCount].dir = (sq > sp) ? 1 : -1;
+			++crossingCount;
+		}
+
+		if (crossingCount < 2)
+			continue;
+
+		qsort(crossings, crossingCount, sizeof(DKHatchCrossing), CompareHatchCrossings);
+
+		winding = 0;
+		enter = 0.0;
+
+		for (c = 0; c < crossingCount; ++c) {
+			BOOL wasInside = evenOdd ? (winding & 1) : (winding != 0);
+
+			winding += evenOdd ? 1 : crossings[c].dir;
+
+			BOOL isInside = evenOdd ? (winding & 1) : (winding != 0);
+
+			if (!wasInside && isInside)
+				enter = crossings[c].t;
+			else if (wasInside && !isInside && crossings[c].t > enter) {
+				t = enter;
+
+				// keep dashes in step from line to line by starting each span at a whole number of dash patterns
+
+				if (dashLength > 0.0 && d.y != 0.0) {
+					CGFloat y = a.y + t * d.y;
+					t = (floor(y / dashLength) * dashLength - a.y) / d.y;
+				}
 
-		[m_cache setLineCapStyle:[self lineCapStyle]];
-		[m_cache setLineJoinStyle:[self lineJoinStyle]];
+				pa.x = a.x + t * d.x;
+				pa.y = a.y + t * d.y;
+				pb.x = a.x + crossings[c].t * d.x;
+				pb.y = a.y + crossings[c].t * d.y;
 
-		[[self colour] set];
+				[hatch moveToPoint:pa];
+				[hatch lineToPoint:pb];
+			}
+		}
+	}
+
+	free(crossings);
+	free(lineEdges);
+	free(lineStarts);
+	free(edges);
+
+	if ([hatch isEmpty])
+		return hatch;
+
+	// back to the path's frame
 
-		NSAffineTransform* xform;
+	[toHatch invert];
+	[hatch transformUsingAffineTransform:toHatch];
 
-		xform = [NSAffineTransform transform];
-		[xform translateXBy:NSMidX(br)
-						yBy:NSMidY(br)];
-		[xform concat];
+	return hatch;
+}
 
-		NSBezierPath* hatch;
+- (NSBezierPath*)roughHatchForHatch:(NSBezierPath*)hatch
+{
+	[hatch setLineWidth:[self width]];
+	[hatch setLineCapStyle:[self lineCapStyle]];
+	[hatch setLineJoinStyle:[self lineJoinStyle]];
 
-		// compensate for the object's angle by applying that rotation to the hatch path
+	return [hatch bezierPathWithRoughenedStrokeOutline:[self roughness] * [self width]
+												  seed:DKRandomDeriveSeed(mWobbleSeed, 1)];
+}
 
-		if (oa != 0.0) {
-			xform = [NSAffineTransform transform];
-			[xform rotateByRadians:oa];
-			hatch = [xform transformBezierPath:m_cache];
-		} else
-			hatch = m_cache;
+- (void)strokeHatch:(NSBezierPath*)hatch roughHatch:(NSBezierPath*)roughHatch clippedToPath:(NSBezierPath*)path
+{
+	// the spans are exact, but line caps and widths still extend beyond the path, so the clip is retained
 
-		if (mRoughenStrokes) {
-			NSBezierPath* roughHatch;
+	SAVE_GRAPHICS_CONTEXT //[NSGraphicsContext saveGraphicsState];
+		[path addClip];
 
-			if (mRoughenedCache == nil)
-				mRoughenedCache = [m_cache bezierPathWithRoughenedStrokeOutline:[self roughness] * [self width]];
+	[[self colour] set];
+
+	if (roughHatch)
+		[roughHatch fill];
+	else {
+		// enforce a minimum line width of 0.1 - sizees of zero do not print.
+
+		CGFloat actualLineWidth = [self width];
+
+		if (![NSGraphicsContext currentContextDrawingToScreen]) {
+			if (actualLineWidth <= 0.0)
+				actualLineWidth = 0.05; // hairline
+		}
 
-			if (oa != 0.0)
-				roughHatch = [xform transformBezierPath:mRoughenedCache];
-			else
-				roughHatch = mRoughenedCache;
+		[hatch setLineWidth:actualLineWidth];
 
-			[roughHatch fill];
-		} else
-			[hatch stroke];
+		if ([self dash])
+			[[self dash] applyToPath:hatch];
+		else
+			[hatch setLineDash:nil
+						 count:0
+						 phase:0.0];
 
-		RESTORE_GRAPHICS_CONTEXT //[NSGraphicsContext restoreGraphicsState];
+		[hatch setLineCapStyle:[self lineCapStyle]];
+		[hatch setLineJoinStyle:[self lineJoinStyle]];
+		[hatch stroke];
 	}
+
+	RESTORE_GRAPHICS_CONTEXT //[NSGraphicsContext restoreGraphicsState];
 }
 
 #pragma mark -
@@ -210,14 +447,7 @@
 - (void)setAngle:(CGFloat)radians
 {
 	if (radians != m_angle) {
-		// cache doesn't need rebuilding, just rotating to the new angle.
-
-		if (m_cache) {
-			NSAffineTransform* xform = [NSAffineTransform transform];
-			[xform rotateByRadians:radians - m_angle];
-			[m_cache transformUsingAffineTransform:xform];
-			[mRoughenedCache transformUsingAffineTransform:xform];
-		}
+		// cached hatches record the angle they were made at, so nothing else needs to be invalidated
 
 		m_angle = radians;
 	}
@@ -274,8 +504,12 @@
 #pragma mark -
 - (void)setWidth:(CGFloat)width
 {
-	m_lineWidth = width;
-	[self invalidateRoughnessCache];
+	// the dash can scale with the width, and the hatch is broken up by the dash
+
+	if (width != m_lineWidth) {
+		m_lineWidth = width;
+		[self invalidateCache];
+	}
 }
 
 @synthesize width = m_lineWidth;
@@ -303,7 +537,7 @@
 - (void)setDash:(DKStrokeDash*)dash
 {
 	m_hatchDash = dash;
-	[self invalidateRoughnessCache];
+	[self invalidateCache];
 }
 
 @synthesize dash = m_hatchDash;
@@ -339,57 +573,32 @@
 
 @synthesize wobblyness = mWobblyness;
 
+- (void)setSeed:(DKRandomSeed)seed
+{
+	if (seed != mWobbleSeed) {
+		mWobbleSeed = seed;
+		[self invalidateCache];
+	}
+}
+
+@synthesize seed = mWobbleSeed;
+
 #pragma mark -
 - (void)invalidateCache
 {
-	m_cache = nil;
+	mGeneration = ++sHatchGeneration;
 	[self invalidateRoughnessCache];
 }
 
-- (void)calcHatchInRect:(NSRect)rect
+- (void)invalidateRoughnessCache
 {
-	if (m_cache == nil) {
-		m_cache = [NSBezierPath bezierPath];
-
-		NSRect cr;
-
-		cr.size.width = cr.size.height = (MAX(rect.size.width, rect.size.height) * 1.5);
-		cr.origin.x = cr.origin.y = (cr.size.width * -0.5);
-
-		//LogEvent_(kReactiveEvent,  @"hatch origin rect = {%f, %f},{%f, %f}", cr.origin.x, cr.origin.y, cr.size.width, cr.size.height );
-
-		NSInteger i, m;
-
-		m = lround(cr.size.width / [self spacing]) + 1;
-		NSPoint a, b;
-
-		a.y = NSMinY(cr);
-		b.y = NSMaxY(cr);
-
-		// wobblyness is a randomising factor 0..1 which displaces the end points of the hatch by a random amount
-		// relative to the spacing. It is used to give a more naturalistic type of hatch (esp. in conjunction with roughness).
-
-		CGFloat maxWobble = mWobblyness * [self spacing];
-
-		for (i = 0; i < m; i++) {
-			a.x = cr.origin.x + m_leadIn + (i * [self spacing]) + ([DKRandom randomPositiveOrNegativeNumber] * maxWobble);
-			b.x = cr.origin.x + m_leadIn + (i * [self spacing]) + ([DKRandom randomPositiveOrNegativeNumber] * maxWobble);
-
-			[m_cache moveToPoint:a];
-			[m_cache lineToPoint:b];
-		}
-
-		// now rotate the cache to the current angle
-
-		NSAffineTransform* rot = [NSAffineTransform transform];
-		[rot rotateByRadians:[self angle]];
-		[m_cache transformUsingAffineTransform:rot];
-	}
+	mRoughGeneration = ++sHatchGeneration;
 }
 
-- (void)invalidateRoughnessCache
+- (void)calcHatchInRect:(NSRect)rect
 {
-	mRoughenedCache = nil;
+#pragma unused(rect)
+	// hatches are now made for each path by -hatchPathForPath:objectAngle:, so there is nothing to calculate in advance
 }
 
 #pragma mark -
@@ -405,7 +614,13 @@
 {
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"angle", @"spacing",
 		@"width", @"dash", @"leadIn",
-		@"lineCapStyle", @"lineJoinStyle", @"angleIsRelativeToObject", @"roughness", @"wobblyness"]];
+		@"lineCapStyle", @"lineJoinStyle", @"angleIsRelativeToObject", @"roughness", @"wobblyness", @"seed"]];
+}
+
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"angle", @"angleIsRelativeToObject", @"spacing", @"leadIn",
+		@"width", @"dash", @"lineCapStyle", @"lineJoinStyle", @"roughness", @"wobblyness", @"seed"]];
 }
 
 - (void)registerActionNames
@@ -433,19 +648,18 @@
 			 forKeyPath:@"roughness"];
 	[self setActionName:@"#kind# Hatch Wobble"
 			 forKeyPath:@"wobblyness"];
+	[self setActionName:@"#kind# Hatch Roughness Seed"
+			 forKeyPath:@"seed"];
 }
 
 #pragma mark -
 #pragma mark As an NSObject
-- (void)dealloc
-{
-	[self invalidateCache];
-}
-
 - (instancetype)init
 {
 	self = [super init];
 	if (self != nil) {
+		mWobbleSeed = DKRandomSeedMake();
+		[self invalidateCache];
 		[self setColour:[NSColor blackColor]];
 
 		[self setLeadIn:0.0];
@@ -467,13 +681,77 @@
 		return;
 
 	NSBezierPath* path = [obj renderingPath];
+	CGFloat oa = m_angleRelativeToObject ? [obj angle] : 0.0;
+	NSMutableDictionary* renderCache = nil;
 
-	if (m_angleRelativeToObject)
-		[self hatchPath:path
-			objectAngle:[obj angle]];
-	else
+	if ([obj respondsToSelector:@selector(renderingCache)])
+		renderCache = [obj renderingCache];
+
+	if (renderCache == nil || path == nil) {
 		[self hatchPath:path
-			objectAngle:0.0];
+			objectAngle:oa];
+		return;
+	}
+
+	// the hatch for this object is cached in its rendering cache, which the object clears when its bounds change. The entry also records
+	// what it was made from, so that it is remade if the hatch parameters, angle or object geometry have changed since. The dash can be
+	// edited in place without the hatching being told, so a copy of it is kept and compared.
+
+	NSString* cacheKey = [NSString stringWithFormat:@"DKHatching_%p", (void*)self];
+	NSMutableDictionary* entry = [renderCache objectForKey:cacheKey];
+	NSUInteger checksum = [obj geometryChecksum] ^ [path elementCount];
+	DKStrokeDash* cachedDash = [entry objectForKey:kDKHatchingCacheDashKey];
+	BOOL dashChanged = [self dash] ? ![[self dash] isEquivalentToObject:cachedDash] : (cachedDash != nil);
+	NSBezierPath* hatch;
+
+	if (entry == nil || dashChanged || [[entry objectForKey:kDKHatchingCacheGenerationKey] unsignedIntegerValue] != mGeneration || [[entry objectForKey:kDKHatchingCacheAngleKey] doubleValue] != [self angle] + oa || [[entry objectForKey:kDKHatchingCacheChecksumKey] unsignedIntegerValue] != checksum || !NSEqualRects([[entry objectForKey:kDKHatchingCacheBoundsKey] rectValue], [path bounds])) {
+		hatch = [self hatchPathForPath:path
+						   objectAngle:oa];
+
+		if (hatch == nil)
+			return;
+
+		entry = [NSMutableDictionary dictionary];
+		[entry setObject:hatch
+				  forKey:kDKHatchingCachePathKey];
+		[entry setObject:@(mGeneration)
+				  forKey:kDKHatchingCacheGenerationKey];
+		[entry setObject:@([self angle] + oa)
+				  forKey:kDKHatchingCacheAngleKey];
+		[entry setObject:@(checksum)
+				  forKey:kDKHatchingCacheChecksumKey];
+		[entry setObject:[NSValue valueWithRect:[path bounds]]
+				  forKey:kDKHatchingCacheBoundsKey];
+
+		if ([self dash])
+			[entry setObject:[[self dash] copy]
+					  forKey:kDKHatchingCacheDashKey];
+		[renderCache setObject:entry
+						forKey:cacheKey];
+	} else
+		hatch = [entry objectForKey:kDKHatchingCachePathKey];
+
+	NSBezierPath* roughHatch = nil;
+
+	if (mRoughenStrokes) {
+		if ([[entry objectForKey:kDKHatchingCacheRoughGenerationKey] unsignedIntegerValue] == mRoughGeneration)
+			roughHatch = [entry objectForKey:kDKHatchingCacheRoughPathKey];
+
+		if (roughHatch == nil) {
+			roughHatch = [self roughHatchForHatch:hatch];
+
+			if (roughHatch) {
+				[entry setObject:roughHatch
+						  forKey:kDKHatchingCacheRoughPathKey];
+				[entry setObject:@(mRoughGeneration)
+						  forKey:kDKHatchingCacheRoughGenerationKey];
+			}
+		}
+	}
+
+	[self strokeHatch:hatch
+		   roughHatch:roughHatch
+		clippedToPath:path];
 }
 
 #pragma mark -
@@ -539,6 +817,8 @@
 				 forKey:@"DKHatching_roughness"];
 	[coder encodeDouble:mWobblyness
 				 forKey:@"DKHatching_wobble"];
+	[coder encodeInt64:(int64_t)mWobbleSeed
+				forKey:@"DKHatching_seed"];
 }
 
 - (instancetype)initWithCoder:(NSCoder*)coder
@@ -546,7 +826,12 @@
 	NSAssert(coder != nil, @"Expected valid coder");
 	self = [super initWithCoder:coder];
 	if (self != nil) {
-		NSAssert(m_cache == nil, @"Expected init to zero");
+		if ([coder containsValueForKey:@"DKHatching_seed"])
+			mWobbleSeed = (DKRandomSeed)[coder decodeInt64ForKey:@"DKHatching_seed"];
+		else
+			mWobbleSeed = DKRandomSeedMake();
+
+		[self invalidateCache];
 		[self setColour:[coder decodeObjectForKey:@"colour"]];
 		[self setDash:[coder decodeObjectForKey:@"dash"]];
 
@@ -585,6 +870,7 @@
 	[copy setAngleIsRelativeToObject:[self angleIsRelativeToObject]];
 	[copy setRoughness:[self roughness]];
 	[copy setWobblyness:[self wobblyness]];
+	[copy setSeed:[self seed]];
 
 	return copy;
 }
@@ -164,6 +164,12 @@
 										   @[@"image", @"opacity", @"scale", @"fittingOption", @"angle", @"operation"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"image", @"opacity", @"scale", @"fittingOption", @"origin",
+		@"angle", @"operation"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
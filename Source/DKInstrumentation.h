@@ -0,0 +1,151 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** @brief What a metric measures. */
+typedef NS_ENUM(NSInteger, DKInstrumentKind) {
+	kDKInstrumentTimer = 0, ///< how long a scope takes, kept as a distribution and as trace events
+	kDKInstrumentCounter = 1, ///< a running total, such as cache hits
+	kDKInstrumentHistogram = 2 ///< a distribution of values, such as the number of objects a query finds
+};
+
+/** @brief Identifies a metric. 0 is no metric, and recording to it does nothing. */
+typedef uint32_t DKInstrumentMetric;
+
+/** @brief A timed scope in progress. */
+typedef struct {
+	DKInstrumentMetric metric;
+	uint64_t start;
+} DKInstrumentScope;
+
+/** @brief YES while instrumentation is recording. Read by the macros below so that a disabled probe costs one test and branch. */
+extern BOOL gDKInstrumentationEnabled;
+
+/** @brief Returns the metric with the given category and name, registering it the first time.
+
+ Names are copied, so they need not outlive the call. Up to 256 metrics can be registered; after that 0 is returned.
+ */
+DKInstrumentMetric DKInstrumentMetricNamed(const char* category, const char* name, DKInstrumentKind kind);
+
+/** @brief Returns the metric named for a class in the given category, such as the time each kind of layer takes to draw.
+ @param category a string that must stay valid, normally a literal
+ */
+DKInstrumentMetric DKInstrumentMetricForClass(const char* category, Class cls, DKInstrumentKind kind);
+
+DKInstrumentScope DKInstrumentScopeBegin(DKInstrumentMetric metric);
+void DKInstrumentScopeFinish(const DKInstrumentScope* scope);
+
+/** @brief Ends a timed scope, recording its duration. Does nothing for a scope begun while instrumentation was disabled. */
+NS_INLINE void DKInstrumentScopeEnd(DKInstrumentScope* scope)
+{
+	if (scope->metric != 0)
+		DKInstrumentScopeFinish(scope);
+}
+
+/** @brief Begins timing a scope under the metric named for <cls>, if instrumentation is enabled. */
+NS_INLINE DKInstrumentScope DKInstrumentScopeBeginForClass(const char* category, Class cls)
+{
+	if (!gDKInstrumentationEnabled)
+		return (DKInstrumentScope){ 0, 0 };
+
+	return DKInstrumentScopeBegin(DKInstrumentMetricForClass(category, cls, kDKInstrumentTimer));
+}
+
+/** @brief Adds <delta> to a counter. */
+void DKInstrumentAdd(DKInstrumentMetric metric, int64_t delta);
+
+/** @brief Adds a value to a histogram. */
+void DKInstrumentRecord(DKInstrumentMetric metric, int64_t value);
+
+#define DK_INSTRUMENT_JOIN_(a, b) a##b
+#define DK_INSTRUMENT_JOIN(a, b) DK_INSTRUMENT_JOIN_(a, b)
+
+/** @brief Looks up a metric once per call site. */
+#define DK_INSTRUMENT_METRIC(category, name, kind) ({                \
+	static DKInstrumentMetric sDKInstrumentMetric = 0;               \
+	if (sDKInstrumentMetric == 0)                                    \
+		sDKInstrumentMetric = DKInstrumentMetricNamed(category, name, kind); \
+	sDKInstrumentMetric;                                             \
+})
+
+/** @brief Times the rest of the enclosing block. Declares a variable, so it must appear where a declaration can. */
+#define DK_INSTRUMENT_SCOPE(category, name)                                                                                     \
+	DKInstrumentScope DK_INSTRUMENT_JOIN(dkInstrumentScope, __LINE__) __attribute__((cleanup(DKInstrumentScopeEnd), unused)) = \
+		gDKInstrumentationEnabled ? DKInstrumentScopeBegin(DK_INSTRUMENT_METRIC(category, name, kDKInstrumentTimer)) : (DKInstrumentScope){ 0, 0 }
+
+#define DK_INSTRUMENT_COUNT(category, name, delta)                                                  \
+	do {                                                                                            \
+		if (gDKInstrumentationEnabled)                                                              \
+			DKInstrumentAdd(DK_INSTRUMENT_METRIC(category, name, kDKInstrumentCounter), (delta)); \
+	} while (0)
+
+#define DK_INSTRUMENT_VALUE(category, name, value)                                                       \
+	do {                                                                                                 \
+		if (gDKInstrumentationEnabled)                                                                   \
+			DKInstrumentRecord(DK_INSTRUMENT_METRIC(category, name, kDKInstrumentHistogram), (value)); \
+	} while (0)
+
+// keys in the dictionaries returned by +[DKInstrumentation statistics]. Times are in seconds.
+
+extern NSString* const kDKInstrumentCategoryKey;
+extern NSString* const kDKInstrumentNameKey;
+extern NSString* const kDKInstrumentKindKey;
+extern NSString* const kDKInstrumentCountKey;
+extern NSString* const kDKInstrumentTotalKey;
+extern NSString* const kDKInstrumentMinimumKey;
+extern NSString* const kDKInstrumentMaximumKey;
+extern NSString* const kDKInstrumentMeanKey;
+extern NSString* const kDKInstrumentMedianKey;
+extern NSString* const kDKInstrumentPercentile90Key;
+extern NSString* const kDKInstrumentPercentile99Key;
+
+#pragma mark -
+
+/** @brief Built-in performance instrumentation: scoped timers, counters and histograms, with trace and summary export.
+
+ The framework's probes - layer drawing, rasterizers, storage queries, hit testing, undo, archiving and its caches - are always compiled in.
+ While instrumentation is disabled, which is the default, each probe costs a test of a global flag. While enabled, a timed scope reads the
+ clock twice and updates its metric with a few relaxed atomic operations, and is also kept as an event in a trace buffer of fixed size
+ that can be exported in the Chrome trace event format, for viewing in chrome://tracing or Perfetto. Events past the buffer's capacity are
+ dropped, though their times are still counted.
+
+ Recording is safe from any thread. Enabling, resetting and exporting are meant to be done from one thread while nothing is being recorded.
+
+ Distributions are kept in buckets a quarter of a power of two wide, so percentiles are accurate to within about 19%.
+*/
+@interface DKInstrumentation : NSObject
+
+/** @brief Whether probes record anything. */
+@property (class) BOOL enabled;
+
+/** @brief The number of timed events the trace buffer holds. Default is 262144. Setting it empties the buffer. */
+@property (class) NSUInteger traceCapacity;
+
+/** @brief The number of events dropped since the last reset because the trace buffer was full. */
+@property (class, readonly) NSUInteger droppedTraceEventCount;
+
+/** @brief Clears every metric's values and the trace buffer. Metrics stay registered. */
++ (void)reset;
+
+/** @brief Returns one dictionary for each metric that has recorded anything, using the keys above. */
++ (NSArray<NSDictionary<NSString*, id>*>*)statistics;
+
+/** @brief Returns the statistics of one metric, or nil if it has recorded nothing. */
++ (nullable NSDictionary<NSString*, id>*)statisticsForMetricNamed:(NSString*)name category:(NSString*)category;
+
+/** @brief Returns the statistics as a table of text, timers first with the most expensive at the top. */
++ (NSString*)summaryTable;
+
+/** @brief Returns the trace buffer as JSON in the Chrome trace event format, with each counter's total as a counter event at the end. */
++ (NSData*)traceData;
++ (BOOL)writeTraceToURL:(NSURL*)url error:(NSError**)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
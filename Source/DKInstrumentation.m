@@ -0,0 +1,637 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKInstrumentation.h"
+#include <mach/mach_time.h>
+#include <objc/runtime.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define INSTRUMENT_MAX_METRICS 256
+#define INSTRUMENT_CLASS_SLOTS 1024
+#define INSTRUMENT_DEFAULT_TRACE_CAPACITY 262144
+
+// bucket 0 holds values <= 0, then there are four buckets to each power of two
+
+#define INSTRUMENT_BUCKETS (1 + 64 * 4)
+
+BOOL gDKInstrumentationEnabled = NO;
+
+NSString* const kDKInstrumentCategoryKey = @"kDKInstrumentCategoryKey";
+NSString* const kDKInstrumentNameKey = @"kDKInstrumentNameKey";
+NSString* const kDKInstrumentKindKey = @"kDKInstrumentKindKey";
+NSString* const kDKInstrumentCountKey = @"kDKInstrumentCountKey";
+NSString* const kDKInstrumentTotalKey = @"kDKInstrumentTotalKey";
+NSString* const kDKInstrumentMinimumKey = @"kDKInstrumentMinimumKey";
+NSString* const kDKInstrumentMaximumKey = @"kDKInstrumentMaximumKey";
+NSString* const kDKInstrumentMeanKey = @"kDKInstrumentMeanKey";
+NSString* const kDKInstrumentMedianKey = @"kDKInstrumentMedianKey";
+NSString* const kDKInstrumentPercentile90Key = @"kDKInstrumentPercentile90Key";
+NSString* const kDKInstrumentPercentile99Key = @"kDKInstrumentPercentile99Key";
+
+typedef struct {
+	char category[32];
+	char name[96];
+	DKInstrumentKind kind;
+	_Atomic(int64_t) count;
+	_Atomic(int64_t) total; // for timers, in clock ticks
+	_Atomic(int64_t) min;
+	_Atomic(int64_t) max;
+	_Atomic(uint32_t) buckets[INSTRUMENT_BUCKETS];
+} DKInstrumentMetricData;
+
+typedef struct {
+	uint64_t start;
+	uint64_t duration;
+	DKInstrumentMetric metric;
+	uint32_t thread;
+} DKInstrumentEvent;
+
+// a slot's metric is stored last, with release ordering, so a reader that sees it set also sees the class, category and kind
+
+typedef struct {
+	Class cls;
+	const char* category;
+	DKInstrumentKind kind;
+	_Atomic(DKInstrumentMetric) metric;
+} DKInstrumentClassSlot;
+
+// metric 0 is unused, so that ids are indexes
+
+static DKInstrumentMetricData sMetrics[INSTRUMENT_MAX_METRICS + 1];
+static uint32_t sMetricCount = 0;
+static DKInstrumentClassSlot sClassSlots[INSTRUMENT_CLASS_SLOTS];
+static pthread_mutex_t sRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+
+static DKInstrumentEvent* sEvents = NULL;
+static size_t sEventCapacity = INSTRUMENT_DEFAULT_TRACE_CAPACITY;
+static _Atomic(size_t) sEventCount = 0;
+static uint64_t sTraceOrigin = 0;
+
+static _Atomic(uint32_t) sThreadCount = 0;
+static uint32_t sMainThread = 0;
+static _Thread_local uint32_t tThread = 0;
+
+#pragma mark -
+
+static double DKInstrumentSecondsPerTick(void)
+{
+	static double sSecondsPerTick = 0;
+	static dispatch_once_t onceToken;
+
+	dispatch_once(&onceToken, ^{
+		mach_timebase_info_data_t info;
+
+		mach_timebase_info(&info);
+		sSecondsPerTick = (double)info.numer / (double)info.denom * 1.0e-9;
+	});
+
+	return sSecondsPerTick;
+}
+
+// threads are numbered in the order they first record something, which reads better in a trace than their ports
+
+static uint32_t DKInstrumentThread(void)
+{
+	if (tThread == 0) {
+		tThread = atomic_fetch_add_explicit(&sThreadCount, 1, memory_order_relaxed) + 1;
+
+		if (pthread_main_np())
+			sMainThread = tThread;
+	}
+
+	return tThread;
+}
+
+static size_t DKInstrumentBucket(int64_t value)
+{
+	if (value <= 0)
+		return 0;
+
+	uint64_t v = (uint64_t)value;
+	unsigned octave = 63 - (unsigned)__builtin_clzll(v);
+	unsigned quarter;
+
+	if (octave >= 2)
+		quarter = (unsigned)(v >> (octave - 2)) & 3;
+	else
+		quarter = octave == 1 ? (unsigned)(v & 1) << 1 : 0;
+
+	return 1 + octave * 4 + quarter;
+}
+
+static void DKInstrumentGetBucketRange(size_t bucket, double* lower, double* upper)
+{
+	if (bucket == 0) {
+		*lower = *upper = 0;
+		return;
+	}
+
+	size_t octave = (bucket - 1) / 4;
+	size_t quarter = (bucket - 1) % 4;
+	double base = ldexp(1.0, (int)octave);
+
+	*lower = base * (1.0 + quarter * 0.25);
+	*upper = base * (1.0 + (quarter + 1) * 0.25);
+}
+
+static void DKInstrumentUpdate(DKInstrumentMetricData* m, int64_t value)
+{
+	atomic_fetch_add_explicit(&m->count, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&m->total, value, memory_order_relaxed);
+
+	int64_t old = atomic_load_explicit(&m->min, memory_order_relaxed);
+
+	while (value < old && !atomic_compare_exchange_weak_explicit(&m->min, &old, value, memory_order_relaxed, memory_order_relaxed))
+		;
+
+	old = atomic_load_explicit(&m->max, memory_order_relaxed);
+
+	while (value > old && !atomic_compare_exchange_weak_explicit(&m->max, &old, value, memory_order_relaxed, memory_order_relaxed))
+		;
+
+	atomic_fetch_add_explicit(&m->buckets[DKInstrumentBucket(value)], 1, memory_order_relaxed);
+}
+
+static void DKInstrumentClearMetric(DKInstrumentMetricData* m)
+{
+	size_t i;
+
+	atomic_store_explicit(&m->count, 0, memory_order_relaxed);
+	atomic_store_explicit(&m->total, 0, memory_order_relaxed);
+	atomic_store_explicit(&m->min, INT64_MAX, memory_order_relaxed);
+	atomic_store_explicit(&m->max, INT64_MIN, memory_order_relaxed);
+
+	for (i = 0; i < INSTRUMENT_BUCKETS; ++i)
+		atomic_store_explicit(&m->buckets[i], 0, memory_order_relaxed);
+}
+
+// must be called with the registry locked
+
+static DKInstrumentMetric DKInstrumentRegister(const char* category, const char* name, DKInstrumentKind kind)
+{
+	uint32_t i;
+
+	for (i = 1; i <= sMetricCount; ++i) {
+		if (strcmp(sMetrics[i].category, category) == 0 && strcmp(sMetrics[i].name, name) == 0)
+			return i;
+	}
+
+	if (sMetricCount == INSTRUMENT_MAX_METRICS)
+		return 0;
+
+	DKInstrumentMetricData* m = &sMetrics[sMetricCount + 1];
+
+	strlcpy(m->category, category, sizeof(m->category));
+	strlcpy(m->name, name, sizeof(m->name));
+	m->kind = kind;
+	DKInstrumentClearMetric(m);
+
+	return ++sMetricCount;
+}
+
+DKInstrumentMetric DKInstrumentMetricNamed(const char* category, const char* name, DKInstrumentKind kind)
+{
+	pthread_mutex_lock(&sRegistryLock);
+	DKInstrumentMetric metric = DKInstrumentRegister(category, name, kind);
+	pthread_mutex_unlock(&sRegistryLock);
+
+	return metric;
+}
+
+DKInstrumentMetric DKInstrumentMetricForClass(const char* category, Class cls, DKInstrumentKind kind)
+{
+	size_t first = (((uintptr_t)cls >> 4) ^ ((uintptr_t)category >> 2) ^ (size_t)kind) & (INSTRUMENT_CLASS_SLOTS - 1);
+	size_t slot = first;
+	size_t probes;
+	DKInstrumentMetric metric;
+
+	// slots are never emptied, so a class already seen is found without locking. The probe stops at the first empty slot, which is
+	// where the class would have been put
+
+	for (probes = 0; probes < INSTRUMENT_CLASS_SLOTS; ++probes) {
+		DKInstrumentClassSlot* s = &sClassSlots[slot];
+
+		metric = atomic_load_explicit(&s->metric, memory_order_acquire);
+
+		if (metric == 0)
+			break;
+
+		if (s->cls == cls && s->category == category && s->kind == kind)
+			return metric;
+
+		slot = (slot + 1) & (INSTRUMENT_CLASS_SLOTS - 1);
+	}
+
+	// not seen yet, so register it under the lock. The probe starts over, since another thread may have filled the slot meanwhile
+
+	slot = first;
+	metric = 0;
+
+	pthread_mutex_lock(&sRegistryLock);
+
+	for (probes = 0; probes < INSTRUMENT_CLASS_SLOTS; ++probes) {
+		DKInstrumentClassSlot* s = &sClassSlots[slot];
+		DKInstrumentMetric existing = atomic_load_explicit(&s->metric, memory_order_relaxed);
+
+		if (existing != 0 && s->cls == cls && s->category == category && s->kind == kind) {
+			metric = existing;
+			break;
+		}
+
+		if (existing == 0) {
+			metric = DKInstrumentRegister(category, class_getName(cls), kind);
+
+			if (metric != 0) {
+				s->cls = cls;
+				s->category = category;
+				s->kind = kind;
+				atomic_store_explicit(&s->metric, metric, memory_order_release);
+			}
+			break;
+		}
+
+		slot = (slot + 1) & (INSTRUMENT_CLASS_SLOTS - 1);
+	}
+
+	pthread_mutex_unlock(&sRegistryLock);
+
+	return metric;
+}
+
+DKInstrumentScope DKInstrumentScopeBegin(DKInstrumentMetric metric)
+{
+	DKInstrumentScope scope = { metric, 0 };
+
+	if (metric != 0)
+		scope.start = mach_absolute_time();
+
+	return scope;
+}
+
+void DKInstrumentScopeFinish(const DKInstrumentScope* scope)
+{
+	uint64_t duration = mach_absolute_time() - scope->start;
+
+	DKInstrumentUpdate(&sMetrics[scope->metric], (int64_t)duration);
+
+	// the count goes on past the capacity so that the number dropped is known
+
+	size_t index = atomic_fetch_add_explicit(&sEventCount, 1, memory_order_relaxed);
+
+	if (index < sEventCapacity && sEvents != NULL) {
+		DKInstrumentEvent* event = &sEvents[index];
+
+		event->start = scope->start;
+		event->duration = duration;
+		event->metric = scope->metric;
+		event->thread = DKInstrumentThread();
+	}
+}
+
+void DKInstrumentAdd(DKInstrumentMetric metric, int64_t delta)
+{
+	if (metric != 0) {
+		atomic_fetch_add_explicit(&sMetrics[metric].count, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&sMetrics[metric].total, delta, memory_order_relaxed);
+	}
+}
+
+void DKInstrumentRecord(DKInstrumentMetric metric, int64_t value)
+{
+	if (metric != 0)
+		DKInstrumentUpdate(&sMetrics[metric], value);
+}
+
+#pragma mark -
+
+static double DKInstrumentPercentile(DKInstrumentMetricData* m, int64_t count, double p)
+{
+	double target = p * count;
+	double cumulative = 0;
+	double lower, upper;
+	double lo = atomic_load_explicit(&m->min, memory_order_relaxed);
+	double hi = atomic_load_explicit(&m->max, memory_order_relaxed);
+	size_t i;
+
+	for (i = 0; i < INSTRUMENT_BUCKETS; ++i) {
+		uint32_t c = atomic_load_explicit(&m->buckets[i], memory_order_relaxed);
+
+		if (c == 0)
+			continue;
+
+		if (cumulative + c >= target) {
+			DKInstrumentGetBucketRange(i, &lower, &upper);
+
+			double v = lower + (upper - lower) * (target - cumulative) / c;
+
+			return MIN(MAX(v, lo), hi);
+		}
+
+		cumulative += c;
+	}
+
+	return hi;
+}
+
+static void DKInstrumentAppendJSONString(NSMutableData* data, const char* str)
+{
+	[data appendBytes:"\""
+			   length:1];
+
+	for (; *str; ++str) {
+		unsigned char c = (unsigned char)*str;
+		char escaped[8];
+
+		if (c == '"' || c == '\\') {
+			escaped[0] = '\\';
+			escaped[1] = (char)c;
+			[data appendBytes:escaped
+					   length:2];
+		} else if (c < 0x20) {
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			[data appendBytes:escaped
+					   length:6];
+		} else
+			[data appendBytes:&c
+					   length:1];
+	}
+
+	[data appendBytes:"\""
+			   length:1];
+}
+
+static void DKInstrumentAppendFormat(NSMutableData* data, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void DKInstrumentAppendFormat(NSMutableData* data, const char* format, ...)
+{
+	char buffer[256];
+	va_list args;
+
+	va_start(args, format);
+	int n = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (n > 0)
+		[data appendBytes:buffer
+				   length:MIN((size_t)n, sizeof(buffer) - 1)];
+}
+
+#pragma mark -
+
+@interface DKInstrumentation ()
+
++ (nullable NSDictionary<NSString*, id>*)statisticsForMetric:(DKInstrumentMetric)metric;
+
+@end
+
+#pragma mark -
+
+@implementation DKInstrumentation
+
++ (BOOL)enabled
+{
+	return gDKInstrumentationEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled
+{
+	if (enabled && sEvents == NULL) {
+		sEvents = calloc(sEventCapacity, sizeof(DKInstrumentEvent));
+		atomic_store(&sEventCount, 0);
+		sTraceOrigin = mach_absolute_time();
+	}
+
+	gDKInstrumentationEnabled = enabled;
+}
+
++ (NSUInteger)traceCapacity
+{
+	return sEventCapacity;
+}
+
++ (void)setTraceCapacity:(NSUInteger)capacity
+{
+	free(sEvents);
+	sEvents = NULL;
+	sEventCapacity = capacity;
+	atomic_store(&sEventCount, 0);
+
+	if (gDKInstrumentationEnabled)
+		sEvents = calloc(sEventCapacity, sizeof(DKInstrumentEvent));
+}
+
++ (NSUInteger)droppedTraceEventCount
+{
+	size_t count = atomic_load(&sEventCount);
+
+	return count > sEventCapacity ? count - sEventCapacity : 0;
+}
+
++ (void)reset
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&sRegistryLock);
+
+	for (i = 1; i <= sMetricCount; ++i)
+		DKInstrumentClearMetric(&sMetrics[i]);
+
+	pthread_mutex_unlock(&sRegistryLock);
+
+	atomic_store(&sEventCount, 0);
+	sTraceOrigin = mach_absolute_time();
+}
+
++ (NSDictionary<NSString*, id>*)statisticsForMetric:(DKInstrumentMetric)metric
+{
+	DKInstrumentMetricData* m = &sMetrics[metric];
+	int64_t count = atomic_load_explicit(&m->count, memory_order_relaxed);
+
+	if (count == 0)
+		return nil;
+
+	int64_t total = atomic_load_explicit(&m->total, memory_order_relaxed);
+	NSMutableDictionary* stats = [NSMutableDictionary dictionary];
+
+	stats[kDKInstrumentCategoryKey] = @(m->category);
+	stats[kDKInstrumentNameKey] = @(m->name);
+	stats[kDKInstrumentKindKey] = @(m->kind);
+	stats[kDKInstrumentCountKey] = @(count);
+
+	if (m->kind == kDKInstrumentCounter) {
+		stats[kDKInstrumentTotalKey] = @(total);
+		return stats;
+	}
+
+	// timers are kept in clock ticks and reported in seconds
+
+	double scale = m->kind == kDKInstrumentTimer ? DKInstrumentSecondsPerTick() : 1.0;
+
+	stats[kDKInstrumentTotalKey] = @(total * scale);
+	stats[kDKInstrumentMinimumKey] = @(atomic_load_explicit(&m->min, memory_order_relaxed) * scale);
+	stats[kDKInstrumentMaximumKey] = @(atomic_load_explicit(&m->max, memory_order_relaxed) * scale);
+	stats[kDKInstrumentMeanKey] = @((double)total / count * scale);
+	stats[kDKInstrumentMedianKey] = @(DKInstrumentPercentile(m, count, 0.5) * scale);
+	stats[kDKInstrumentPercentile90Key] = @(DKInstrumentPercentile(m, count, 0.9) * scale);
+	stats[kDKInstrumentPercentile99Key] = @(DKInstrumentPercentile(m, count, 0.99) * scale);
+
+	return stats;
+}
+
++ (NSArray<NSDictionary<NSString*, id>*>*)statistics
+{
+	NSMutableArray* result = [NSMutableArray array];
+	uint32_t i, count;
+
+	pthread_mutex_lock(&sRegistryLock);
+	count = sMetricCount;
+	pthread_mutex_unlock(&sRegistryLock);
+
+	for (i = 1; i <= count; ++i) {
+		NSDictionary* stats = [self statisticsForMetric:i];
+
+		if (stats)
+			[result addObject:stats];
+	}
+
+	return result;
+}
+
++ (NSDictionary<NSString*, id>*)statisticsForMetricNamed:(NSString*)name category:(NSString*)category
+{
+	DKInstrumentMetric metric = 0;
+	uint32_t i;
+
+	pthread_mutex_lock(&sRegistryLock);
+
+	for (i = 1; i <= sMetricCount; ++i) {
+		if (strcmp(sMetrics[i].category, [category UTF8String]) == 0 && strcmp(sMetrics[i].name, [name UTF8String]) == 0) {
+			metric = i;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&sRegistryLock);
+
+	return metric ? [self statisticsForMetric:metric] : nil;
+}
+
++ (NSString*)summaryTable
+{
+	NSArray* stats = [[self statistics] sortedArrayUsingComparator:^NSComparisonResult(NSDictionary* a, NSDictionary* b) {
+		NSComparisonResult order = [a[kDKInstrumentKindKey] compare:b[kDKInstrumentKindKey]];
+
+		if (order == NSOrderedSame && [a[kDKInstrumentKindKey] integerValue] == kDKInstrumentTimer)
+			order = [b[kDKInstrumentTotalKey] compare:a[kDKInstrumentTotalKey]];
+
+		if (order == NSOrderedSame)
+			order = [a[kDKInstrumentNameKey] compare:b[kDKInstrumentNameKey]];
+
+		return order;
+	}];
+
+	NSMutableString* table = [NSMutableString string];
+
+	[table appendFormat:@"%-10s %-36s %10s %12s %12s %12s %12s %12s %12s\n", "category", "name", "count", "total", "mean", "p50", "p90", "p99", "max"];
+
+	for (NSDictionary* s in stats) {
+		DKInstrumentKind kind = [s[kDKInstrumentKindKey] integerValue];
+		const char* category = [s[kDKInstrumentCategoryKey] UTF8String];
+		const char* name = [s[kDKInstrumentNameKey] UTF8String];
+		long long count = [s[kDKInstrumentCountKey] longLongValue];
+
+		if (kind == kDKInstrumentCounter) {
+			[table appendFormat:@"%-10s %-36s %10lld %12lld\n", category, name, count, [s[kDKInstrumentTotalKey] longLongValue]];
+		} else {
+			// times are shown in milliseconds
+
+			double scale = kind == kDKInstrumentTimer ? 1000.0 : 1.0;
+			const char* unit = kind == kDKInstrumentTimer ? "ms" : "";
+
+			[table appendFormat:@"%-10s %-36s %10lld %10.3f%-2s %10.3f%-2s %10.3f%-2s %10.3f%-2s %10.3f%-2s %10.3f%-2s\n", category, name, count,
+				   [s[kDKInstrumentTotalKey] doubleValue] * scale, unit,
+				   [s[kDKInstrumentMeanKey] doubleValue] * scale, unit,
+				   [s[kDKInstrumentMedianKey] doubleValue] * scale, unit,
+				   [s[kDKInstrumentPercentile90Key] doubleValue] * scale, unit,
+				   [s[kDKInstrumentPercentile99Key] doubleValue] * scale, unit,
+				   [s[kDKInstrumentMaximumKey] doubleValue] * scale, unit];
+		}
+	}
+
+	NSUInteger dropped = [self droppedTraceEventCount];
+
+	if (dropped > 0)
+		[table appendFormat:@"(%lu trace events dropped)\n", (unsigned long)dropped];
+
+	return table;
+}
+
++ (NSData*)traceData
+{
+	NSMutableData* data = [NSMutableData data];
+	double microsecondsPerTick = DKInstrumentSecondsPerTick() * 1.0e6;
+	size_t i, count = MIN(atomic_load(&sEventCount), sEvents ? sEventCapacity : 0);
+	int pid = getpid();
+	uint64_t end = sTraceOrigin;
+
+	DKInstrumentAppendFormat(data, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	DKInstrumentAppendFormat(data, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":", pid);
+	DKInstrumentAppendJSONString(data, [[[NSProcessInfo processInfo] processName] UTF8String]);
+	DKInstrumentAppendFormat(data, "}}");
+
+	if (sMainThread != 0)
+		DKInstrumentAppendFormat(data, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"main\"}}", pid, sMainThread);
+
+	for (i = 0; i < count; ++i) {
+		const DKInstrumentEvent* event = &sEvents[i];
+		const DKInstrumentMetricData* m = &sMetrics[event->metric];
+
+		// events are written as they finish, so one may have started before the trace was reset
+
+		double ts = ((double)event->start - (double)sTraceOrigin) * microsecondsPerTick;
+
+		DKInstrumentAppendFormat(data, ",\n{\"name\":");
+		DKInstrumentAppendJSONString(data, m->name);
+		DKInstrumentAppendFormat(data, ",\"cat\":");
+		DKInstrumentAppendJSONString(data, m->category);
+		DKInstrumentAppendFormat(data, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}", ts, event->duration * microsecondsPerTick, pid, event->thread);
+
+		end = MAX(end, event->start + event->duration);
+	}
+
+	// counters are not traced as they change, only their totals at the end
+
+	uint32_t metric;
+
+	for (metric = 1; metric <= sMetricCount; ++metric) {
+		const DKInstrumentMetricData* m = &sMetrics[metric];
+
+		if (m->kind != kDKInstrumentCounter || atomic_load_explicit(&m->count, memory_order_relaxed) == 0)
+			continue;
+
+		DKInstrumentAppendFormat(data, ",\n{\"name\":");
+		DKInstrumentAppendJSONString(data, m->name);
+		DKInstrumentAppendFormat(data, ",\"cat\":");
+		DKInstrumentAppendJSONString(data, m->category);
+		DKInstrumentAppendFormat(data, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":0,\"args\":{\"value\":%lld}}", (end - sTraceOrigin) * microsecondsPerTick, pid,
+								 (long long)atomic_load_explicit(&m->total, memory_order_relaxed));
+	}
+
+	DKInstrumentAppendFormat(data, "\n]}\n");
+
+	return data;
+}
+
++ (BOOL)writeTraceToURL:(NSURL*)url error:(NSError**)error
+{
+	return [[self traceData] writeToURL:url
+								options:NSDataWritingAtomic
+								  error:error];
+}
+
+@end
@@ -43,6 +43,9 @@ might include the shape of a knob, its colours, whether stroked or filled or bot
 	NSColor* mControlBarColour; // colour of control bars
 	NSSize mControlKnobSize; // control knob size
 	CGFloat mControlBarWidth; // control bar width
+	NSUInteger mBatchLevel; // nesting count of -beginKnobBatch calls
+	NSMutableArray* mBatchHandles; // handles used by the current batch, in order of first use
+	NSMapTable* mBatchPlacements; // handle -> buffer of positions and angles for the current batch
 }
 
 /**  */
@@ -66,6 +69,17 @@ might include the shape of a knob, its colours, whether stroked or filled or bot
 
 - (BOOL)hitTestPoint:(NSPoint)p inKnobAtPoint:(NSPoint)kp ofType:(DKKnobType)knobType userInfo:(nullable id)userInfo;
 
+/** @brief Starts collecting knobs instead of drawing them.
+
+ Between -beginKnobBatch and -flushKnobBatch, the knob drawing methods record each knob's handle, position and angle in a buffer. Flushing
+ draws all the knobs that use the same handle in one pass, skipping those outside the update area or that would overlap exactly at the
+ current scale. Knobs are drawn on top of anything drawn during the batch, such as control bars. Calls may be nested; only the outermost
+ flush draws. Batches must begin and end within a single drawing pass, on the thread doing the drawing.
+ */
+- (void)beginKnobBatch;
+- (void)flushKnobBatch;
+@property (readonly, getter=isBatchingKnobs) BOOL batchingKnobs;
+
 /** colour of control bars
  */
 @property (copy) NSColor* controlBarColour;
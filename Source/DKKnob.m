@@ -12,6 +12,13 @@
 
 #define USE_DK_HANDLES 1
 
+// one knob recorded while batching
+
+typedef struct {
+	NSPoint point;
+	CGFloat angle;
+} DKKnobPlacement;
+
 NSString* const kDKKnobPreferredHighlightColour = @"kDKKnobPreferredHighlightColour";
 
 static NSColor* sKnobColour = nil;
@@ -22,6 +29,12 @@ static NSColor* sBarColour = nil;
 static CGFloat sBarWidth = 0.0;
 static NSSize sKnobSize = { 6.0, 6.0 };
 
+@interface DKKnob ()
+
+- (void)addHandle:(DKHandle*)handle atPoint:(NSPoint)p angle:(CGFloat)radians;
+
+@end
+
 @implementation DKKnob
 #pragma mark As a DKKnob
 
@@ -76,8 +89,14 @@ static NSSize sKnobSize = { 6.0, 6.0 };
 	if (ahs.width >= 1.0 || ahs.height >= 1.0) {
 		DKHandle* handle = [self handleForType:knobType
 										colour:aColour];
-		[handle drawAtPoint:p
+
+		if (mBatchLevel > 0)
+			[self addHandle:handle
+					atPoint:p
 					  angle:radians];
+		else
+			[handle drawAtPoint:p
+						  angle:radians];
 	}
 	return;
 #else
@@ -177,8 +196,14 @@ static NSSize sKnobSize = { 6.0, 6.0 };
 
 	if (ahs.width >= 1.0 || ahs.height >= 1.0) {
 		DKHandle* handle = [self handleForType:knobType];
-		[handle drawAtPoint:p
+
+		if (mBatchLevel > 0)
+			[self addHandle:handle
+					atPoint:p
 					  angle:radians];
+		else
+			[handle drawAtPoint:p
+						  angle:radians];
 	}
 	return;
 #else
@@ -250,6 +275,87 @@ static NSSize sKnobSize = { 6.0, 6.0 };
 #endif
 }
 
+- (void)beginKnobBatch
+{
+	if (mBatchLevel++ == 0) {
+		if (mBatchHandles == nil) {
+			mBatchHandles = [[NSMutableArray alloc] init];
+			mBatchPlacements = [NSMapTable strongToStrongObjectsMapTable];
+		}
+	}
+}
+
+- (void)flushKnobBatch
+{
+	NSAssert(mBatchLevel > 0, @"-flushKnobBatch called without a matching -beginKnobBatch");
+
+	if (mBatchLevel == 0 || --mBatchLevel > 0)
+		return;
+
+	for (DKHandle* handle in mBatchHandles) {
+		NSMutableData* buffer = [mBatchPlacements objectForKey:handle];
+		const DKKnobPlacement* placements = [buffer bytes];
+		NSUInteger i, count = [buffer length] / sizeof(DKKnobPlacement);
+		NSPoint* points = malloc(sizeof(NSPoint) * count);
+		CGFloat* angles = NULL;
+
+		if (points == NULL)
+			continue;
+
+		for (i = 0; i < count; ++i) {
+			points[i] = placements[i].point;
+
+			// angles are only passed if at least one knob is rotated
+
+			if (placements[i].angle != 0.0 && angles == NULL)
+				angles = calloc(count, sizeof(CGFloat));
+
+			if (angles)
+				angles[i] = placements[i].angle;
+		}
+
+		[handle drawAtPoints:points
+					  angles:angles
+					   count:count];
+
+		free(points);
+		free(angles);
+	}
+
+	// keep the buffers' storage for the next batch
+
+	for (NSMutableData* buffer in [mBatchPlacements objectEnumerator])
+		[buffer setLength:0];
+
+	[mBatchHandles removeAllObjects];
+}
+
+- (BOOL)isBatchingKnobs
+{
+	return mBatchLevel > 0;
+}
+
+- (void)addHandle:(DKHandle*)handle atPoint:(NSPoint)p angle:(CGFloat)radians
+{
+	if (handle == nil)
+		return;
+
+	NSMutableData* buffer = [mBatchPlacements objectForKey:handle];
+
+	if (buffer == nil) {
+		buffer = [NSMutableData data];
+		[mBatchPlacements setObject:buffer
+							 forKey:handle];
+	}
+
+	if ([buffer length] == 0)
+		[mBatchHandles addObject:handle];
+
+	DKKnobPlacement placement = { p, radians };
+	[buffer appendBytes:&placement
+				 length:sizeof(placement)];
+}
+
 - (void)drawControlBarFromPoint:(NSPoint)a toPoint:(NSPoint)b
 {
 	BOOL active = YES;
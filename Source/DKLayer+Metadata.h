@@ -60,8 +60,26 @@ typedef NS_ENUM(NSInteger, DKLayerMetadataSchema) {
 - (NSSize)sizeForKey:(NSString*)key;
 
 - (void)updateMetadataKeys;
+
+/** @brief A number that changes whenever this layer's own metadata changes.
+
+ If you modify metadata items directly, bracket the change with \c -metadataWillChangeKey: and \c -metadataDidChangeKey:
+ so that the change is detected.
+ */
+@property (readonly) NSUInteger metadataVersion;
+
+/** @brief A number that changes whenever the metadata of this layer or any of its enclosing groups changes.
+
+ It is cached, and forgotten by \c -invalidateMetadataChecksum when anything it is derived from changes.
+ */
 @property (readonly) NSUInteger metadataChecksum;
 
+/** @brief Forgets the cached metadata checksum, and those of the layers and objects within this one.
+
+ Called when the layer's metadata or its group changes. Layer groups pass it on to their layers, and object layers to their objects.
+ */
+- (void)invalidateMetadataChecksum;
+
 /** Subclasses that want to prevent access to metadata for a layer can override this to return NO. Controllers that provide
  UI to metadata need to check this - it is not honoured at this level.
  */
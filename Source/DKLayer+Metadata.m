@@ -13,6 +13,12 @@
 NSString* const kDKLayerMetadataUserInfoKey = @"kDKLayerMetadataUserInfoKey";
 NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetadataUndoableChangesUserDefaultsKey";
 
+@interface DKLayer (MetadataPrivate)
+
+- (DKMetadataItem*)localMetadataItemForChangingKey:(NSString*)key copied:(BOOL*)copied;
+
+@end
+
 @implementation DKLayer (Metadata)
 #pragma mark As a DKLayer
 
@@ -80,7 +86,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 		[self metadataWillChangeKey:key];
 		item = [item copy];
 		[[self metadata] setObject:item
-							forKey:[key lowercaseString]];
+							forKey:DKMetadataCanonicalKey(key)];
 
 		[self metadataDidChangeKey:key];
 	}
@@ -88,7 +94,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 
 - (DKMetadataItem*)metadataItemForKey:(NSString*)key
 {
-	DKMetadataItem* item = [[self metadata] objectForKey:[key lowercaseString]];
+	DKMetadataItem* item = [[self metadata] objectForKey:DKMetadataCanonicalKey(key)];
 
 	if (item == nil)
 		item = [[self layerGroup] metadataItemForKey:key];
@@ -96,18 +102,47 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 	return item;
 }
 
+- (DKMetadataItem*)localMetadataItemForChangingKey:(NSString*)key copied:(BOOL*)copied
+{
+	// returns this layer's own item for <key>. An item inherited from the layer group is shared with the other layers in it, and only this
+	// layer's version is bumped when it changes, so it is copied into this layer first rather than being changed where it is.
+
+	DKMetadataItem* item = [[self metadata] objectForKey:DKMetadataCanonicalKey(key)];
+
+	*copied = NO;
+
+	if (item == nil) {
+		item = [[self metadataItemForKey:key] copy];
+
+		if (item) {
+			[self setupMetadata];
+			[[self metadata] setObject:item
+								forKey:DKMetadataCanonicalKey(key)];
+			*copied = YES;
+		}
+	}
+
+	return item;
+}
+
 - (void)setMetadataItemValue:(id)value forKey:(NSString*)key
 {
 	// if an item exists for <key> its value is set to <value>. This records the old value for Undo if enabled. It does nothing if the
-	// item doesn't exist already.
+	// item doesn't exist already. An inherited item is copied into this layer and the copy is changed.
 
 	if (![self locked]) {
-		DKMetadataItem* item = [self metadataItemForKey:key];
+		BOOL copied;
+		DKMetadataItem* item = [self localMetadataItemForChangingKey:key
+															  copied:&copied];
 
 		if (item) {
-			if ([[self class] metadataChangesAreUndoable])
-				[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItemValue:[item value]
-																					 forKey:key];
+			if ([[self class] metadataChangesAreUndoable]) {
+				if (copied)
+					[[[self undoManager] prepareWithInvocationTarget:self] removeMetadataForKey:key];
+				else
+					[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItemValue:[item value]
+																						 forKey:key];
+			}
 
 			[self metadataWillChangeKey:key];
 			[item setValue:value];
@@ -119,18 +154,25 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 - (void)setMetadataItemType:(DKMetadataType)type forKey:(NSString*)key
 {
 	// undoably sets the type of an item. Note tha changing types can be lossy - this does not care whether that is the case. You can
-	// query an item to see if a type change would be lossy before calling this if necessary.
+	// query an item to see if a type change would be lossy before calling this if necessary. An inherited item is copied into this
+	// layer and the copy is changed.
 
 	if (![self locked]) {
-		DKMetadataItem* item = [self metadataItemForKey:key];
+		BOOL copied;
+		DKMetadataItem* item = [self localMetadataItemForChangingKey:key
+															  copied:&copied];
 
 		if (item) {
 			if ([[self class] metadataChangesAreUndoable]) {
-				// so that undo can revert a lossy change, the entire item is copied
-
-				DKMetadataItem* oldItem = [item copy];
-				[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItem:oldItem
-																				forKey:key];
+				if (copied)
+					[[[self undoManager] prepareWithInvocationTarget:self] removeMetadataForKey:key];
+				else {
+					// so that undo can revert a lossy change, the entire item is copied
+
+					DKMetadataItem* oldItem = [item copy];
+					[[[self undoManager] prepareWithInvocationTarget:self] setMetadataItem:oldItem
+																					forKey:key];
+				}
 			}
 
 			[self metadataWillChangeKey:key];
@@ -199,7 +241,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 
 #else
 
-	id object = [[self metadata] objectForKey:[key lowercaseString]];
+	id object = [[self metadata] objectForKey:DKMetadataCanonicalKey(key)];
 
 	// search upwards through the containment hierarchy for the data. If it is anywhere between here and the root drawing, it will be found.
 
@@ -242,7 +284,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 	}
 #endif
 	[self metadataWillChangeKey:key];
-	[[self metadata] removeObjectForKey:[key lowercaseString]];
+	[[self metadata] removeObjectForKey:DKMetadataCanonicalKey(key)];
 	[self metadataDidChangeKey:key];
 }
 
@@ -360,7 +402,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 {
 	NSDictionary* userInfo = nil;
 	if (key)
-		userInfo = @{ @"key": [key lowercaseString] };
+		userInfo = @{ @"key": DKMetadataCanonicalKey(key) };
 	[[NSNotificationCenter defaultCenter] postNotificationName:kDKMetadataWillChangeNotification
 														object:self
 													  userInfo:userInfo];
@@ -368,9 +410,12 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 
 - (void)metadataDidChangeKey:(NSString*)key
 {
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
+
 	NSDictionary* userInfo = nil;
 	if (key)
-		userInfo = @{ @"key": [key lowercaseString] };
+		userInfo = @{ @"key": DKMetadataCanonicalKey(key) };
 	[[NSNotificationCenter defaultCenter] postNotificationName:kDKMetadataDidChangeNotification
 														object:self
 													  userInfo:userInfo];
@@ -416,34 +461,39 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 		value = [[metaDict objectForKey:key] retain];
 		[metaDict removeObjectForKey:key];
 		[metaDict setObject:value
-					 forKey:[key lowercaseString]];
+					 forKey:DKMetadataCanonicalKey(key)];
 		[value release];
 	}
 #endif
 }
 
+- (NSUInteger)metadataVersion
+{
+	if (mMetadataVersion == 0)
+		mMetadataVersion = DKMetadataNextVersion();
+
+	return mMetadataVersion;
+}
+
 - (NSUInteger)metadataChecksum
 {
-	NSUInteger cs = 319162352; // arbitrary
+	// derived from the metadata versions of this layer and its enclosing groups, and kept until one of them changes
 
-	NSMutableArray* array = [[[self metadata] allKeys] mutableCopy];
-	[array sortUsingSelector:@selector(compare:)];
+	if (mMetadataChecksum == 0) {
+		NSUInteger groupChecksum = 0;
 
-	id value;
+		if ([self layerGroup])
+			groupChecksum = [[self layerGroup] metadataChecksum];
 
-	for (NSString* key in array) {
-#if USE_107_OR_LATER_SCHEMA
-		value = [[self metadataItemForKey:key] value];
-#else
-		value = [self metadataObjectForKey:key];
-#endif
-		cs ^= [key hash] ^ [value hash];
+		mMetadataChecksum = DKMetadataCombinedChecksum([self metadataVersion], groupChecksum);
 	}
 
-	if ([self layerGroup])
-		cs ^= [[self layerGroup] metadataChecksum];
+	return mMetadataChecksum;
+}
 
-	return cs;
+- (void)invalidateMetadataChecksum
+{
+	mMetadataChecksum = 0;
 }
 
 - (BOOL)supportsMetadata
@@ -470,7 +520,7 @@ NSString* const kDKLayerMetadataUndoableChangesUserDefaultsKey = @"kDKLayerMetad
 		[self setupMetadata];
 		[self metadataWillChangeKey:key];
 		[[self metadata] setObject:obj
-							forKey:[key lowercaseString]];
+							forKey:DKMetadataCanonicalKey(key)];
 		[self metadataDidChangeKey:key];
 	}
 }
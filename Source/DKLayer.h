@@ -48,7 +48,9 @@ NS_ASSUME_NONNULL_BEGIN
 	DKLayerGroup* __weak m_groupRef; // group we are contained by (or drawing)
 	BOOL m_clipToInterior; // YES to clip drawing to inside the interior region
 	NSMutableDictionary* mUserInfo; // metadata
-	NSUInteger mReserved[3]; // unused
+	NSUInteger mMetadataVersion; // changes whenever the metadata changes
+	NSUInteger mMetadataChecksum; // cached metadata checksum of this layer and its groups, or 0 if not known
+	NSUInteger mReserved[1]; // unused
 	NSString* mLayerUniqueKey; // unique ID for the layer
 	CGFloat mAlpha; // alpha value applied to layer as a whole
 }
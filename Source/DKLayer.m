@@ -168,6 +168,17 @@ static NSArray* s_selectionColours = nil;
 
 @synthesize layerGroup = m_groupRef;
 
+- (void)setLayerGroup:(DKLayerGroup*)group
+{
+	if (group != m_groupRef) {
+		m_groupRef = group;
+
+		// the metadata the layer inherits comes from its group
+
+		[self invalidateMetadataChecksum];
+	}
+}
+
 /** @brief Gets the layer's index within the group that the layer is contained in
 
  If the layer isn't in a group yet, result is 0. This is intended for debugging mostly.
@@ -679,6 +690,8 @@ static NSArray* s_selectionColours = nil;
 - (void)setUserInfo:(NSMutableDictionary*)info
 {
 	mUserInfo = [info mutableCopy];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 }
 
 /** @brief Add a dictionary of metadata to the object
@@ -694,6 +707,8 @@ static NSArray* s_selectionColours = nil;
 	NSDictionary* deepCopy = [info deepCopy];
 
 	[mUserInfo addEntriesFromDictionary:deepCopy];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 }
 
 /** @brief Return the attached user info
@@ -731,6 +746,8 @@ static NSArray* s_selectionColours = nil;
 
 	[[self userInfo] setObject:obj
 						forKey:key];
+	mMetadataVersion = DKMetadataNextVersion();
+	[self invalidateMetadataChecksum];
 }
 
 #pragma mark -
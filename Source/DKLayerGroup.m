@@ -7,6 +7,8 @@
 #import "DKLayerGroup.h"
 #import "DKDrawKitMacros.h"
 #import "DKDrawing.h"
+#import "DKInstrumentation.h"
+#import "DKLayer+Metadata.h"
 #import "LogEvent.h"
 
 #pragma mark Constants(Non - localized)
@@ -790,6 +792,14 @@ NSString* const kDKLayerGroupDidReorderLayers = @"kDKLayerGroupDidReorderLayers"
 #pragma mark -
 #pragma mark As a DKLayer
 
+/** @brief Forgets the cached metadata checksums of the group and of every layer within it, as they inherit the group's metadata
+ */
+- (void)invalidateMetadataChecksum
+{
+	[super invalidateMetadataChecksum];
+	[[self layers] makeObjectsPerformSelector:_cmd];
+}
+
 /** @brief Propagates the undo manager to all contained layers
  @param um the drawing's undo manager
  */
@@ -825,6 +835,8 @@ NSString* const kDKLayerGroupDidReorderLayers = @"kDKLayerGroupDidReorderLayers"
 			layer = [self objectInLayersAtIndex:n];
 
 			if ([layer visible] && !(printing && ![layer shouldDrawToPrinter])) {
+				DKInstrumentScope scope = DKInstrumentScopeBeginForClass("draw", [layer class]);
+
 				@try {
 					[NSGraphicsContext saveGraphicsState];
 
@@ -841,6 +853,7 @@ NSString* const kDKLayerGroupDidReorderLayers = @"kDKLayerGroupDidReorderLayers"
 				}
 				@finally {
 					[NSGraphicsContext restoreGraphicsState];
+					DKInstrumentScopeEnd(&scope);
 				}
 			}
 		}
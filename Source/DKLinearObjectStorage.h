@@ -16,10 +16,16 @@ Basic storage class stores objects in a standard array. For many uses this will
  a brief period (beta 5), the storage was archived. To support files written at that time, this class and its derivatives currently support NSCoding (for reading)
  so that the files can be correctly dearchived. Re-saving the files will update to the new approach. Archiving of the storage isn't curremtly done, and attempting to
  archive will throw an exception.
+
+ Z-order lookups (-indexOfObject:) use a map from object to index, so they take constant time rather than searching the array. Inserting or
+ removing objects only marks the entries above the change as stale; they are repaired lazily, in one pass, by the next lookup that needs them.
+ Moving an object renumbers just the range it moved across.
 */
 @interface DKLinearObjectStorage : NSObject <DKObjectStorage, NSCoding> {
 @private
 	NSMutableArray<id<DKStorableObject>>* mObjects;
+	NSMapTable* mIndexMap; // object -> index + 1, keyed by identity
+	NSUInteger mIndexMapValidCount; // entries for indexes below this are known to be correct
 }
 
 @end
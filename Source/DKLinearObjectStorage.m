@@ -5,14 +5,35 @@
 */
 
 #import "DKLinearObjectStorage.h"
+#import "DKInstrumentation.h"
 #import "LogEvent.h"
 
+@interface DKLinearObjectStorage ()
+
+- (void)invalidateIndexMapFromIndex:(NSUInteger)indx;
+- (void)updateIndexMapInRange:(NSRange)range;
+- (void)repairIndexMap;
+- (NSUInteger)mappedIndexOfObject:(id<DKStorableObject>)object;
+
+@end
+
+// the map doesn't retain the objects - the array does that
+
+static NSMapTable* DKNewIndexMap(void)
+{
+	return [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality
+									 valueOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality
+										 capacity:0];
+}
+
 @implementation DKLinearObjectStorage
 
 #pragma mark - as implementor of the DKObjectStorage protocol
 
 - (NSArray*)objectsIntersectingRect:(NSRect)aRect inView:(NSView*)aView options:(DKObjectStorageOptions)options
 {
+	DK_INSTRUMENT_SCOPE("storage", "linear rect query");
+
 	NSMutableArray* temp = [NSMutableArray array];
 	NSEnumerator* iter;
 
@@ -39,6 +60,8 @@
 		}
 	}
 
+	DK_INSTRUMENT_VALUE("storage", "linear objects found", (int64_t)[temp count]);
+
 	return temp;
 }
 
@@ -55,6 +78,8 @@
 	LogEvent_(kReactiveEvent, @"storage setting %lu objects %@", (unsigned long)[objects count], self);
 
 	mObjects = [objects mutableCopy];
+	[mIndexMap removeAllItems];
+	mIndexMapValidCount = 0;
 
 	[mObjects makeObjectsPerformSelector:@selector(setStorage:)
 							  withObject:self];
@@ -67,28 +92,29 @@
 
 - (NSUInteger)countOfObjects
 {
-	return [[self objects] count];
+	return [mObjects count];
 }
 
 - (id<DKStorableObject>)objectInObjectsAtIndex:(NSUInteger)indx
 {
 	NSAssert(indx < [self countOfObjects], @"error - index is beyond bounds");
 
-	return [[self objects] objectAtIndex:indx];
+	return [mObjects objectAtIndex:indx];
 }
 
 - (NSArray*)objectsAtIndexes:(NSIndexSet*)set
 {
-	return [[self objects] objectsAtIndexes:set];
+	return [mObjects objectsAtIndexes:set];
 }
 
 - (void)insertObject:(id<DKStorableObject>)obj inObjectsAtIndex:(NSUInteger)indx
 {
 	NSAssert(obj != nil, @"attempt to add a nil object to the storage");
 
-	if (![[self objects] containsObject:obj]) {
+	if (![self containsObject:obj]) {
 		[mObjects insertObject:obj
 					   atIndex:indx];
+		[self invalidateIndexMapFromIndex:indx];
 		[obj setStorage:self];
 	}
 }
@@ -99,7 +125,9 @@
 
 	id<DKStorableObject> obj = [mObjects objectAtIndex:indx];
 	[obj setStorage:nil];
+	NSMapRemove(mIndexMap, (__bridge const void*)obj);
 	[mObjects removeObjectAtIndex:indx];
+	[self invalidateIndexMapFromIndex:indx];
 }
 
 - (void)replaceObjectInObjectsAtIndex:(NSUInteger)indx withObject:(id<DKStorableObject>)obj
@@ -109,8 +137,10 @@
 
 	id<DKStorableObject> oldObj = [mObjects objectAtIndex:indx];
 	[oldObj setStorage:nil];
+	NSMapRemove(mIndexMap, (__bridge const void*)oldObj);
 	[mObjects replaceObjectAtIndex:indx
 						withObject:obj];
+	[self updateIndexMapInRange:NSMakeRange(indx, 1)];
 	[obj setStorage:self];
 }
 
@@ -125,6 +155,7 @@
 							  withObject:self];
 		[mObjects insertObjects:objs
 					  atIndexes:set];
+		[self invalidateIndexMapFromIndex:[set firstIndex]];
 	}
 }
 
@@ -138,18 +169,51 @@
 		NSArray* objs = [mObjects objectsAtIndexes:set];
 		[objs makeObjectsPerformSelector:@selector(setStorage:)
 							  withObject:nil];
+
+		for (id<DKStorableObject> obj in objs)
+			NSMapRemove(mIndexMap, (__bridge const void*)obj);
+
 		[mObjects removeObjectsAtIndexes:set];
+		[self invalidateIndexMapFromIndex:[set firstIndex]];
 	}
 }
 
 - (BOOL)containsObject:(id<DKStorableObject>)object
 {
-	return [mObjects containsObject:object];
+	return [self indexOfObject:object] != NSNotFound;
 }
 
 - (NSUInteger)indexOfObject:(id<DKStorableObject>)object
 {
-	return [[self objects] indexOfObjectIdenticalTo:object];
+	if (object == nil)
+		return NSNotFound;
+
+	NSUInteger indx = [self mappedIndexOfObject:object];
+
+	if (indx == NSNotFound && mIndexMapValidCount < [mObjects count]) {
+		[self repairIndexMap];
+		indx = [self mappedIndexOfObject:object];
+	}
+
+	return indx;
+}
+
+- (NSIndexSet*)indexesOfObjects:(NSArray*)objs
+{
+	NSMutableIndexSet* indexes = [NSMutableIndexSet indexSet];
+
+	// bring the map up to date once, then every lookup is direct
+
+	[self repairIndexMap];
+
+	for (id<DKStorableObject> obj in objs) {
+		NSUInteger indx = [self mappedIndexOfObject:obj];
+
+		if (indx != NSNotFound)
+			[indexes addIndex:indx];
+	}
+
+	return indexes;
 }
 
 - (void)moveObject:(id<DKStorableObject>)obj toIndex:(NSUInteger)indx
@@ -162,12 +226,54 @@
 	NSUInteger old = [self indexOfObject:obj];
 
 	if (old != indx) {
-		[mObjects removeObject:obj];
+		[mObjects removeObjectAtIndex:old];
 		[mObjects insertObject:obj
 					   atIndex:indx];
+
+		// only the objects between the old and new positions have changed index
+
+		[self updateIndexMapInRange:NSMakeRange(MIN(old, indx), (MAX(old, indx) - MIN(old, indx)) + 1)];
+	}
+}
+
+#pragma mark -
+#pragma mark - index map
+
+- (void)invalidateIndexMapFromIndex:(NSUInteger)indx
+{
+	mIndexMapValidCount = MIN(mIndexMapValidCount, indx);
+}
+
+- (void)updateIndexMapInRange:(NSRange)range
+{
+	NSUInteger i;
+
+	for (i = range.location; i < NSMaxRange(range); ++i)
+		NSMapInsert(mIndexMap, (__bridge const void*)[mObjects objectAtIndex:i], (const void*)(i + 1));
+}
+
+- (void)repairIndexMap
+{
+	NSUInteger count = [mObjects count];
+
+	if (mIndexMapValidCount < count) {
+		[self updateIndexMapInRange:NSMakeRange(mIndexMapValidCount, count - mIndexMapValidCount)];
+		mIndexMapValidCount = count;
 	}
 }
 
+- (NSUInteger)mappedIndexOfObject:(id<DKStorableObject>)object
+{
+	// a stale entry is harmless: it is only trusted if the object is still at that index
+
+	NSUInteger entry = (NSUInteger)NSMapGet(mIndexMap, (__bridge const void*)object);
+
+	if (entry > 0 && entry <= [mObjects count] && [mObjects objectAtIndex:entry - 1] == object)
+		return entry - 1;
+
+	return NSNotFound;
+}
+
 - (void)object:(id<DKStorableObject>)obj didChangeBoundsFrom:(NSRect)oldBounds
 {
 #pragma unused(obj, oldBounds)
@@ -195,6 +301,7 @@
 {
 	// b6: for backward comptibility only
 
+	mIndexMap = DKNewIndexMap();
 	[self setObjects:[aCoder decodeObjectForKey:@"DKLinearStorage_objects"]];
 	return self;
 }
@@ -219,6 +326,7 @@
 	self = [super init];
 	if (self) {
 		mObjects = [[NSMutableArray alloc] init];
+		mIndexMap = DKNewIndexMap();
 	}
 
 	return self;
@@ -226,8 +334,8 @@
 
 - (void)dealloc
 {
-	[[self objects] makeObjectsPerformSelector:@selector(setStorage:)
-									withObject:nil];
+	[mObjects makeObjectsPerformSelector:@selector(setStorage:)
+							  withObject:nil];
 }
 
 @end
@@ -0,0 +1,68 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class DKObjectDrawingLayer;
+
+/** @brief Keeps a layer's selection up to date with a marquee as it is dragged, working only on the objects the marquee's edges pass over.
+
+ Each time the marquee changes, the objects to look at are those in the regions it has just entered or left. Objects elsewhere are in
+ the marquee both before and after, or in neither, so they are left alone. Only the candidates found by the layer's storage in those
+ regions are tested with \c -intersectsRect:, and the selection is changed by selecting the objects that came into the marquee and
+ deselecting those that left it. A small drag therefore costs in proportion to the strips it sweeps, not to the marquee or the selection.
+
+ Without extending, the selection is what is in the marquee. Extending keeps the objects that were selected when the marquee began as
+ well; the two can be switched between from one change to the next, as when shift is pressed during a drag.
+
+ Ruler marker updates are disabled while the marquee is in use, since they would need the bounds of the whole selection every time.
+ -finish restores them and shows the markers for the final selection.
+*/
+@interface DKMarqueeSelection : NSObject {
+@private
+	DKObjectDrawingLayer* mLayer;
+	NSRect mRect; // the marquee as of the last change
+	NSHashTable* mObjects; // the objects in the marquee
+	NSHashTable* mInitialSelection; // the objects selected when the marquee began
+	BOOL mExtending; // YES if the initial selection is currently kept
+	BOOL mRulerMarkersWereEnabled;
+	NSUInteger mTestCount;
+}
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/** @brief Starts a marquee selection in a layer, from the layer's current selection.
+ @param layer the layer
+ @return the marquee selection
+ */
+- (instancetype)initWithLayer:(DKObjectDrawingLayer*)layer NS_DESIGNATED_INITIALIZER;
+
+@property (readonly, strong) DKObjectDrawingLayer* layer;
+
+/** @brief The marquee as of the last change. Empty until the first change. */
+@property (readonly) NSRect rect;
+
+/** @brief The number of objects in the marquee, whether or not they agreed to be selected. */
+@property (readonly) NSUInteger countOfObjects;
+
+/** @brief The number of objects tested against the marquee by the last change. */
+@property (readonly) NSUInteger countOfObjectsTested;
+
+/** @brief Moves the marquee, changing the layer's selection to match.
+ @param rect the new marquee
+ @param extend YES to keep the objects that were selected when the marquee began as well as those in it
+ @return YES if the selection changed
+ */
+- (BOOL)setRect:(NSRect)rect extendingSelection:(BOOL)extend;
+
+/** @brief Ends the marquee selection, re-enabling ruler marker updates if they were enabled when it began. */
+- (void)finish;
+
+@end
+
+NS_ASSUME_NONNULL_END
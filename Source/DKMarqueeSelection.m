@@ -0,0 +1,123 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKMarqueeSelection.h"
+#import "DKDrawableObject.h"
+#import "DKGeometryUtilities.h"
+#import "DKObjectDrawingLayer.h"
+
+@implementation DKMarqueeSelection
+
+- (instancetype)initWithLayer:(DKObjectDrawingLayer*)layer
+{
+	NSAssert(layer != nil, @"can't select in a nil layer");
+
+	self = [super init];
+	if (self) {
+		mLayer = layer;
+		mRect = NSZeroRect;
+		mObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality capacity:0];
+		mInitialSelection = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+														capacity:[layer countOfSelection]];
+
+		for (DKDrawableObject* od in [layer selection])
+			[mInitialSelection addObject:od];
+
+		// the initial selection is what is selected until the first change, as if extending an empty marquee
+
+		mExtending = YES;
+		mRulerMarkersWereEnabled = [layer rulerMarkerUpdatesEnabled];
+		[layer setRulerMarkerUpdatesEnabled:NO];
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	[self finish];
+}
+
+@synthesize layer = mLayer;
+@synthesize rect = mRect;
+@synthesize countOfObjectsTested = mTestCount;
+
+- (NSUInteger)countOfObjects
+{
+	return [mObjects count];
+}
+
+- (BOOL)setRect:(NSRect)rect extendingSelection:(BOOL)extend
+{
+	NSMutableArray* entered = [NSMutableArray array];
+	NSMutableArray* exited = [NSMutableArray array];
+	NSMutableArray* deselected;
+
+	mTestCount = 0;
+
+	// an object can only have come in or gone out if it touches a region that is in one marquee and not the other. One that spans
+	// several of the regions is found more than once, but by then it has been moved to its new side and is left there
+
+	for (NSValue* region in DifferenceOfTwoRects(mRect, rect)) {
+		for (DKDrawableObject* od in [mLayer objectsForUpdateRect:[region rectValue] inView:nil]) {
+			BOOL inside = [od intersectsRect:rect];
+			BOOL wasInside = [mObjects containsObject:od];
+
+			++mTestCount;
+
+			if (inside && !wasInside) {
+				[mObjects addObject:od];
+				[entered addObject:od];
+			} else if (!inside && wasInside) {
+				[mObjects removeObject:od];
+				[exited addObject:od];
+			}
+		}
+	}
+
+	mRect = rect;
+
+	if (extend) {
+		// objects that were already selected stay so when the marquee leaves them
+
+		deselected = [NSMutableArray arrayWithCapacity:[exited count]];
+
+		for (DKDrawableObject* od in exited) {
+			if (![mInitialSelection containsObject:od])
+				[deselected addObject:od];
+		}
+	} else
+		deselected = exited;
+
+	if (extend != mExtending) {
+		for (DKDrawableObject* od in mInitialSelection) {
+			if ([mObjects containsObject:od])
+				continue;
+
+			if (extend)
+				[entered addObject:od];
+			else
+				[deselected addObject:od];
+		}
+
+		mExtending = extend;
+	}
+
+	return [mLayer changeSelectionByAddingObjectsFromArray:entered
+									removingObjectsInArray:deselected];
+}
+
+- (void)finish
+{
+	if (mRulerMarkersWereEnabled && ![mLayer rulerMarkerUpdatesEnabled]) {
+		[mLayer setRulerMarkerUpdatesEnabled:YES];
+		[mLayer updateRulerMarkersForRect:[mLayer selectionLogicalBounds]];
+	}
+
+	mRulerMarkersWereEnabled = NO;
+}
+
+@end
@@ -183,6 +183,28 @@ DKMetadataItems are used to store metadata (attribute) values in user info dicti
 extern NSPasteboardType DKSingleMetadataItemPBoardType NS_SWIFT_NAME(dkSingleMetadataItem);
 extern NSPasteboardType DKMultipleMetadataItemsPBoardType NS_SWIFT_NAME(dkMultipleMetadataItems);
 
+/** @brief Returns the canonical form of a metadata key.
+
+ Metadata keys are case-insensitive and are stored lowercase. This returns the lowercase form of \c key, interned so that every
+ use of the same key shares one string instance, and caches the mapping so that repeated lookups with the same key don't need to
+ lowercase it again.
+ @param key A metadata key in any case.
+ @return The canonical (lowercase, interned) key. */
+NSString* DKMetadataCanonicalKey(NSString* key);
+
+/** @brief Returns a new metadata version number.
+
+ Each call returns a number greater than any returned before. Objects that store metadata tag themselves with a new version
+ whenever their metadata changes, so change detection is an integer comparison.
+ @return A unique version number, never 0. */
+NSUInteger DKMetadataNextVersion(void);
+
+/** @brief Combines an object's own metadata version with the checksum of its container's metadata.
+ @param version The object's own version.
+ @param containerChecksum The container's metadata checksum, or 0 if there is no container.
+ @return A checksum that changes if either argument changes. */
+NSUInteger DKMetadataCombinedChecksum(NSUInteger version, NSUInteger containerChecksum);
+
 //! objects can optionally implement any of the following to assist with additional conversions:
 @protocol DKMetadataItemConversions <NSObject>
 
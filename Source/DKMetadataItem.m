@@ -5,10 +5,72 @@
 */
 
 #import "DKMetadataItem.h"
+#import <stdatomic.h>
 
 NSString* DKSingleMetadataItemPBoardType = @"com.apptree.dk.meta";
 NSString* DKMultipleMetadataItemsPBoardType = @"com.apptree.dk.multimeta";
 
+// canonical keys are cached by the key as passed in; the table is simply emptied if it grows unreasonably large
+
+#define MAX_CANONICAL_METADATA_KEYS 4096
+
+NSString* DKMetadataCanonicalKey(NSString* key)
+{
+	static NSMutableDictionary* sCanonicalKeys = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sCanonicalKeys = [[NSMutableDictionary alloc] init];
+	});
+
+	if (key == nil)
+		return nil;
+
+	NSString* canonical;
+
+	@synchronized(sCanonicalKeys)
+	{
+		canonical = [sCanonicalKeys objectForKey:key];
+
+		if (canonical == nil) {
+			if ([sCanonicalKeys count] >= MAX_CANONICAL_METADATA_KEYS)
+				[sCanonicalKeys removeAllObjects];
+
+			// the lowercase form maps to itself, which interns it
+
+			NSString* lower = [key lowercaseString];
+
+			canonical = [sCanonicalKeys objectForKey:lower];
+
+			if (canonical == nil) {
+				canonical = [lower copy];
+				[sCanonicalKeys setObject:canonical
+								   forKey:canonical];
+			}
+
+			[sCanonicalKeys setObject:canonical
+							   forKey:[key copy]];
+		}
+	}
+
+	return canonical;
+}
+
+NSUInteger DKMetadataNextVersion(void)
+{
+	static _Atomic(NSUInteger) sMetadataVersion = 0;
+
+	return atomic_fetch_add(&sMetadataVersion, 1) + 1;
+}
+
+NSUInteger DKMetadataCombinedChecksum(NSUInteger version, NSUInteger containerChecksum)
+{
+	// versions are unique, so mixing the container's checksum in with a multiply-rotate is enough to make any change in the chain visible
+
+	NSUInteger mixed = containerChecksum * (NSUInteger)0x9E3779B97F4A7C15ULL;
+
+	return version ^ ((mixed << 17) | (mixed >> (sizeof(NSUInteger) * 8 - 17)));
+}
+
 @interface DKMetadataItem ()
 
 - (void)assignValue:(id)aValue;
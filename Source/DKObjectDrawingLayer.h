@@ -252,6 +252,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)exchangeSelectionWithObjectsFromArray:(NSArray<DKDrawableObject*>*)sel;
 
+/** @brief Selects some objects and deselects others as a single change to the selection
+
+ Where the caller already knows which objects are entering and leaving the selection, as during a marquee drag, this changes only
+ those objects, however many others are selected, and notifies the change once. Objects that refuse selection are not added. Ruler
+ markers are only updated if their updates are enabled, so a caller making many changes in a row can disable them until it is done.
+ @param addObjs the objects to select
+ @param removeObjs the objects to deselect
+ @return YES if the selection changed, NO if it did not
+ */
+- (BOOL)changeSelectionByAddingObjectsFromArray:(NSArray<DKDrawableObject*>*)addObjs removingObjectsInArray:(NSArray<DKDrawableObject*>*)removeObjs;
+
 /** @brief Scrolls one or all views attached to the drawing so that the selection within this layer is visible
  @param aView if not nil, the view to scroll. If nil, scrolls all views
  */
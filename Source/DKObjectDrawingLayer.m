@@ -9,6 +9,7 @@
 #import "DKDrawing.h"
 #import "DKGeometryUtilities.h"
 #import "DKImageShape.h"
+#import "DKKnob.h"
 #import "DKObjectDrawingLayer+Alignment.h"
 #import "DKPasteboardInfo.h"
 #import "DKRuntimeHelper.h"
@@ -663,6 +664,56 @@ enum {
 	return didChange;
 }
 
+- (BOOL)changeSelectionByAddingObjectsFromArray:(NSArray*)addObjs removingObjectsInArray:(NSArray*)removeObjs
+{
+	NSAssert(addObjs != nil, @"attempt to add a nil array to the selection");
+	NSAssert(removeObjs != nil, @"attempt to remove a nil array from the selection");
+
+	BOOL didChange = NO;
+
+	if ([self lockedOrHidden])
+		return NO;
+
+	if ([self isBufferingSelectionChanges]) {
+		[self bufferObject:addObjs
+			forSelectionOp:kObjectArrayAdd];
+		[self bufferObject:removeObjs
+			forSelectionOp:kObjectArrayRemove];
+		return NO;
+	}
+
+	for (DKDrawableObject* od in removeObjs) {
+		if ([m_selection containsObject:od]) {
+			[od objectIsNoLongerSelected];
+			[od notifyVisualChange];
+			[m_selection removeObject:od];
+			didChange = YES;
+		}
+	}
+
+	for (DKDrawableObject* od in addObjs) {
+		if (![m_selection containsObject:od] && [od objectMayBecomeSelected]) {
+			[m_selection addObject:od];
+			[od objectDidBecomeSelected];
+			[od notifyVisualChange];
+			didChange = YES;
+		}
+	}
+
+	if (didChange) {
+		mSelBoundsCached = NSZeroRect;
+		[[NSNotificationCenter defaultCenter] postNotificationName:kDKLayerSelectionDidChange
+															object:self];
+
+		// the selection's bounds cost a pass over all of it, so they are only worked out if they will be used
+
+		if ([self rulerMarkerUpdatesEnabled])
+			[self updateRulerMarkersForRect:[self selectionLogicalBounds]];
+	}
+
+	return didChange;
+}
+
 /** @brief Scrolls one or all views attached to the drawing so that the selection within this layer is visible
  @param aView if not nil, the view to scroll. If nil, scrolls all views
  */
@@ -2180,18 +2231,38 @@ enum {
 
 				} else {
 
+					// each selected object's knobs are batched so that they are drawn together, above its outline and control bars
+
+					DKKnob* knobs = [self knobs];
+
 					for (DKDrawableObject* obj in objectsToDraw) {
-						[obj drawContentWithSelectedState:[self isSelectedObject:obj]];
+						if ([self isSelectedObject:obj]) {
+							[knobs beginKnobBatch];
+							@try {
+								[obj drawContentWithSelectedState:YES];
+							}
+							@finally {
+								[knobs flushKnobBatch];
+							}
+						} else
+							[obj drawContentWithSelectedState:NO];
 					}
 				}
 
-				// draw the selection on top if set to do so
+				// draw the selection on top if set to do so. All knobs for the whole selection are collected and drawn in one batch.
 
 				if ([self drawsSelectionHighlightsOnTop] && drawSelected) {
-
-					for (DKDrawableObject* obj in objectsToDraw) {
-						if ([self isSelectedObject:obj])
-							[obj drawSelectedState];
+					DKKnob* knobs = [self knobs];
+
+					[knobs beginKnobBatch];
+					@try {
+						for (DKDrawableObject* obj in objectsToDraw) {
+							if ([self isSelectedObject:obj])
+								[obj drawSelectedState];
+						}
+					}
+					@finally {
+						[knobs flushKnobBatch];
 					}
 				}
 			}
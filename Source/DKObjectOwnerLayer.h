@@ -11,7 +11,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class DKDrawableObject, DKStyle;
+@class DKDrawableObject, DKSnapIndex, DKStyle;
 
 /** @brief caching options
  */
@@ -63,6 +63,7 @@ application needs.
 	BOOL m_recordPasteOffset; // set to YES following a paste, and NO following a drag. When YES, paste offset is recorded.
 	NSInteger mPasteboardLastChange; // last change count recorded during a paste
 	NSInteger mPasteCount; // number of repeated paste operations since last new paste
+	DKSnapIndex* mSnapIndex; // index of the objects' snapping points, built on first use
 @protected
 	BOOL mShowStorageDebugging; // if YES, draws the debugging path for the storage on top (debugging feature only)
 }
@@ -660,8 +661,9 @@ application needs.
 /** @brief Snap a point to any existing object control point within tolerance.
 
  If snap to object is not set for this layer, this simply returns the original point unmodified.
- currently uses hitPart to test for a hit, so tolerance is ignored and objects apply their internal
- hit testing tolerance.
+ The nearest of the objects' snapping points (vertices, handles and so on) is found using a spatial index, so the cost doesn't grow with the number
+ of objects. The tolerance is never less than twice the control knob size. If no snapping point is close enough, the few objects near the point are
+ hit tested for snap detection, which allows snapping to any point along a path.
  @param p a point
  @param except Don't snap to this object (intended to be the one being snapped).
  @param tol Has to be within this distance to snap.
@@ -7,15 +7,19 @@
 #import "DKObjectOwnerLayer.h"
 #import "DKBSPObjectStorage.h"
 #import "DKDrawKitMacros.h"
+#import "DKDrawableObject+Metadata.h"
 #import "DKDrawing.h"
 #import "DKDrawingView.h"
 #import "DKGeometryUtilities.h"
 #import "DKGridLayer.h"
 #import "DKImageDataManager.h"
 #import "DKImageShape.h"
+#import "DKInstrumentation.h"
+#import "DKKnob.h"
 #import "DKLayer+Metadata.h"
 #import "DKPasteboardInfo.h"
 #import "DKSelectionPDFView.h"
+#import "DKSnapIndex.h"
 #import "DKStyle.h"
 #import "DKTextShape.h"
 #import "DKUndoManager.h"
@@ -93,6 +97,7 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 															object:self];
 
 		[[self storage] setObjects:objs];
+		mSnapIndex = nil;
 
 		[[self objects] makeObjectsPerformSelector:@selector(setContainer:)
 										withObject:self];
@@ -252,6 +257,9 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 {
 	NSAssert(objs != nil, @"can't get indexes for a nil array");
 
+	if ([[self storage] respondsToSelector:@selector(indexesOfObjects:)])
+		return [[self storage] indexesOfObjects:objs];
+
 	NSMutableIndexSet* mset = [[NSMutableIndexSet alloc] init];
 
 	for (DKDrawableObject* o in objs) {
@@ -550,7 +558,9 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 
 - (void)drawable:(DKDrawableObject*)obj needsDisplayInRect:(NSRect)rect
 {
-#pragma unused(obj)
+	// any visual change might have moved the object's snapping points
+
+	[mSnapIndex objectDidChange:obj];
 
 	// if the layer is cached, invalidate it. This forces the cache to get rebuilt when a change occurs while inactive,
 	// for example an undo was performed on a contained object that changed its appearance
@@ -934,6 +944,8 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 
 - (DKDrawableObject*)hitTest:(NSPoint)point partCode:(NSInteger*)part
 {
+	DK_INSTRUMENT_SCOPE("hit test", "layer hit test");
+
 	NSInteger partcode;
 	NSArray* objects = [[self storage] objectsContainingPoint:point];
 
@@ -987,15 +999,34 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 
 - (NSPoint)snapPoint:(NSPoint)p toAnyObjectExcept:(DKDrawableObject*)except snapTolerance:(CGFloat)tol
 {
-#pragma unused(tol)
-
 	if ([self allowsSnapToObjects]) {
-		NSInteger pc;
-		NSEnumerator* iter;
+		tol = MAX(tol, [[self knobs] controlKnobSize].width * 2.0);
+
+		if (mSnapIndex == nil) {
+			mSnapIndex = [[DKSnapIndex alloc] initWithCellSize:MAX(tol * 4.0, 32.0)];
+			[mSnapIndex setLayer:self];
+
+			for (DKDrawableObject* obj in [self objects])
+				[mSnapIndex addObject:obj];
+		}
 
-		iter = [[self objects] reverseObjectEnumerator];
+		DKDrawableObject* snapObject = nil;
+		NSPoint sp = [mSnapIndex nearestPointToPoint:p
+										   tolerance:tol
+									 excludingObject:except
+											  object:&snapObject];
+		if (snapObject)
+			return sp;
 
-		for (DKDrawableObject* ho in iter) {
+		// nothing close enough in the index - let the objects near the point do their own snap detection, e.g. to the nearest point along a path
+
+		NSRect nearRect = NSInsetRect(NSMakeRect(p.x, p.y, 0, 0), -tol, -tol);
+		NSArray* nearObjects = [[self storage] objectsIntersectingRect:nearRect
+																inView:nil
+															   options:kDKReverseOrder];
+		NSInteger pc;
+
+		for (DKDrawableObject* ho in nearObjects) {
 			if (ho != except) {
 				pc = [ho hitSelectedPart:p
 						forSnapDetection:YES];
@@ -1132,6 +1163,15 @@ static DKLayerCacheOption sDefaultCacheOption = kDKLayerCacheNone;
 #pragma mark -
 #pragma mark As a DKLayer
 
+/** @brief Forgets the cached metadata checksums of the layer and of the objects it owns, as they inherit the layer's metadata
+ */
+- (void)invalidateMetadataChecksum
+{
+	[super invalidateMetadataChecksum];
+	[[self objects] makeObjectsPerformSelector:_cmd];
+	[mNewObjectPending invalidateMetadataChecksum];
+}
+
 /** @brief Called when the drawing's undo manager is changed - this gives objects that cache the UM a chance
  to update their references
 
@@ -90,6 +90,9 @@ typedef NS_OPTIONS(NSUInteger, DKObjectStorageOptions) {
 @optional
 - (NSBezierPath*)debugStorageDivisions;
 
+/** @brief Returns the indexes of all of the given objects that are in the storage, in a single pass. Objects not in the storage are ignored. */
+- (NSIndexSet*)indexesOfObjects:(NSArray<__kindof id<DKStorableObject>>*)objs;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,452 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKPathBuffer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kDKPathBufferMinimumCapacity 16
+
+void DKPathBufferInit(DKPathBuffer* path)
+{
+	memset(path, 0, sizeof(DKPathBuffer));
+}
+
+void DKPathBufferFree(DKPathBuffer* path)
+{
+	free(path->verbs);
+	free(path->points);
+	memset(path, 0, sizeof(DKPathBuffer));
+}
+
+void DKPathBufferClear(DKPathBuffer* path)
+{
+	path->verbCount = 0;
+	path->pointCount = 0;
+	path->failed = false;
+}
+
+static bool DKPathBufferGrow(void** storage, size_t* capacity, size_t needed, size_t itemSize)
+{
+	if (needed <= *capacity)
+		return true;
+
+	size_t newCapacity = *capacity < kDKPathBufferMinimumCapacity ? kDKPathBufferMinimumCapacity : *capacity;
+
+	while (newCapacity < needed)
+		newCapacity += newCapacity / 2;
+
+	void* grown = realloc(*storage, newCapacity * itemSize);
+
+	if (grown == NULL)
+		return false;
+
+	*storage = grown;
+	*capacity = newCapacity;
+	return true;
+}
+
+bool DKPathBufferReserve(DKPathBuffer* path, size_t verbs, size_t points)
+{
+	if (DKPathBufferGrow((void**)&path->verbs, &path->verbCapacity, path->verbCount + verbs, sizeof(uint8_t))
+		&& DKPathBufferGrow((void**)&path->points, &path->pointCapacity, path->pointCount + points, sizeof(DKPathPoint)))
+		return true;
+
+	path->failed = true;
+	return false;
+}
+
+static inline DKPathPoint* DKPathBufferAppendVerb(DKPathBuffer* path, DKPathVerb verb, size_t points)
+{
+	if (path->verbCount >= path->verbCapacity || path->pointCount + points > path->pointCapacity) {
+		if (!DKPathBufferReserve(path, 1, points))
+			return NULL;
+	}
+
+	DKPathPoint* pp = path->points + path->pointCount;
+
+	path->verbs[path->verbCount++] = (uint8_t)verb;
+	path->pointCount += points;
+	return pp;
+}
+
+void DKPathBufferMoveTo(DKPathBuffer* path, DKPathPoint p)
+{
+	DKPathPoint* pp = DKPathBufferAppendVerb(path, kDKPathMoveTo, 1);
+
+	if (pp)
+		pp[0] = p;
+}
+
+void DKPathBufferLineTo(DKPathBuffer* path, DKPathPoint p)
+{
+	DKPathPoint* pp = DKPathBufferAppendVerb(path, kDKPathLineTo, 1);
+
+	if (pp)
+		pp[0] = p;
+}
+
+void DKPathBufferCurveTo(DKPathBuffer* path, DKPathPoint c1, DKPathPoint c2, DKPathPoint p)
+{
+	DKPathPoint* pp = DKPathBufferAppendVerb(path, kDKPathCurveTo, 3);
+
+	if (pp) {
+		pp[0] = c1;
+		pp[1] = c2;
+		pp[2] = p;
+	}
+}
+
+void DKPathBufferClose(DKPathBuffer* path)
+{
+	DKPathBufferAppendVerb(path, kDKPathClose, 0);
+}
+
+void DKPathBufferAppend(DKPathBuffer* path, const DKPathBuffer* other)
+{
+	if (other->verbCount == 0 || !DKPathBufferReserve(path, other->verbCount, other->pointCount))
+		return;
+
+	memcpy(path->verbs + path->verbCount, other->verbs, other->verbCount);
+	memcpy(path->points + path->pointCount, other->points, other->pointCount * sizeof(DKPathPoint));
+	path->verbCount += other->verbCount;
+	path->pointCount += other->pointCount;
+}
+
+void DKPathBufferAppendReversed(DKPathBuffer* path, const DKPathBuffer* other)
+{
+	size_t first = 0, firstPoint = 0;
+
+	if (!DKPathBufferReserve(path, other->verbCount + 1, other->pointCount + 1))
+		return;
+
+	// each subpath runs from verb <first> to just before the next move, or up to its close. Its elements are written out backwards,
+	// each ending where it used to start: at the last point of the element before it, or at the start of the subpath.
+
+	DKPathPoint start = { 0, 0 };
+
+	while (first < other->verbCount) {
+		size_t last = first, lastPoint = firstPoint;
+		bool closed = false;
+
+		if (other->verbs[first] == kDKPathMoveTo) {
+			start = other->points[firstPoint];
+			++last;
+			++lastPoint;
+		}
+
+		size_t elementsStart = last, elementsStartPoint = lastPoint;
+
+		while (last < other->verbCount && other->verbs[last] != kDKPathMoveTo) {
+			lastPoint += DKPathVerbPointCount(other->verbs[last]);
+
+			if (other->verbs[last++] == kDKPathClose) {
+				closed = true;
+				break;
+			}
+		}
+
+		size_t elementsEnd = closed ? last - 1 : last;
+		DKPathPoint end = elementsEnd > elementsStart ? other->points[lastPoint - 1] : start;
+
+		if (closed) {
+			DKPathBufferMoveTo(path, start);
+
+			if (end.x != start.x || end.y != start.y)
+				DKPathBufferLineTo(path, end);
+		} else
+			DKPathBufferMoveTo(path, end);
+
+		size_t v = elementsEnd, pi = lastPoint;
+
+		while (v > elementsStart) {
+			uint8_t verb = other->verbs[--v];
+			size_t count = DKPathVerbPointCount(verb);
+			const DKPathPoint* pp = other->points + pi - count;
+			DKPathPoint previous = pi - count == elementsStartPoint ? start : pp[-1];
+
+			if (verb == kDKPathCurveTo)
+				DKPathBufferCurveTo(path, pp[1], pp[0], previous);
+			else
+				DKPathBufferLineTo(path, previous);
+
+			pi -= count;
+		}
+
+		if (closed)
+			DKPathBufferClose(path);
+
+		first = last;
+		firstPoint = lastPoint;
+	}
+}
+
+static inline uint64_t DKPathChecksumMix(uint64_t h, uint64_t v)
+{
+	h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+	h ^= h >> 31;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	return h;
+}
+
+uint64_t DKPathBufferChecksum(const DKPathBuffer* path)
+{
+	uint64_t h = DKPathChecksumMix(0, path->verbCount);
+	size_t i;
+
+	for (i = 0; i < path->verbCount; ++i)
+		h = DKPathChecksumMix(h, path->verbs[i]);
+
+	for (i = 0; i < path->pointCount; ++i) {
+		// +0.0 turns -0.0 into 0.0, so coordinates that compare equal hash the same
+
+		double xy[2] = { path->points[i].x + 0.0, path->points[i].y + 0.0 };
+		uint64_t bits[2];
+
+		memcpy(bits, xy, sizeof(bits));
+		h = DKPathChecksumMix(h, bits[0]);
+		h = DKPathChecksumMix(h, bits[1]);
+	}
+
+	return h;
+}
+
+bool DKPathBufferIsEqual(const DKPathBuffer* path, const DKPathBuffer* other)
+{
+	size_t i;
+
+	if (path->verbCount != other->verbCount || path->pointCount != other->pointCount)
+		return false;
+
+	if (path->verbCount > 0 && memcmp(path->verbs, other->verbs, path->verbCount) != 0)
+		return false;
+
+	for (i = 0; i < path->pointCount; ++i)
+		if (path->points[i].x != other->points[i].x || path->points[i].y != other->points[i].y)
+			return false;
+
+	return true;
+}
+
+double DKPathBufferSignedArea(const DKPathBuffer* path)
+{
+	const DKPathPoint* pp = path->points;
+	DKPathPoint start = { 0, 0 }, current = { 0, 0 };
+	double twice = 0.0;
+	size_t i, k;
+
+	// the shoelace sum over each subpath, with curves flattened finely enough that the area is good to a small fraction
+
+	for (i = 0; i < path->verbCount; ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			twice += current.x * start.y - start.x * current.y;
+			start = current = pp[0];
+			break;
+
+		case kDKPathLineTo:
+			twice += current.x * pp[0].y - pp[0].x * current.y;
+			current = pp[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, pp[0], pp[1], pp[2] };
+
+			for (k = 1; k <= 16; ++k) {
+				DKPathPoint p = DKCubicPointAt(c, k / 16.0);
+
+				twice += current.x * p.y - p.x * current.y;
+				current = p;
+			}
+			current = pp[2];
+			break;
+		}
+
+		case kDKPathClose:
+			twice += current.x * start.y - start.x * current.y;
+			current = start;
+			break;
+		}
+
+		pp += DKPathVerbPointCount(path->verbs[i]);
+	}
+
+	twice += current.x * start.y - start.x * current.y;
+	return 0.5 * twice;
+}
+
+// the signed number of times the edge from <a> to <b> crosses the ray running right from <p>
+
+static inline int DKWindingCrossing(DKPathPoint a, DKPathPoint b, DKPathPoint p)
+{
+	if (a.y <= p.y) {
+		if (b.y > p.y && (b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y) > 0.0)
+			return 1;
+	} else if (b.y <= p.y && (b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y) < 0.0)
+		return -1;
+
+	return 0;
+}
+
+int DKPathBufferWindingNumber(const DKPathBuffer* path, DKPathPoint point, double tolerance)
+{
+	const DKPathPoint* pp = path->points;
+	DKPathPoint start = { 0, 0 }, current = { 0, 0 };
+	int winding = 0;
+	size_t i, k;
+
+	for (i = 0; i < path->verbCount; ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			winding += DKWindingCrossing(current, start, point);
+			start = current = pp[0];
+			break;
+
+		case kDKPathLineTo:
+			winding += DKWindingCrossing(current, pp[0], point);
+			current = pp[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, pp[0], pp[1], pp[2] };
+			double minX = c[0].x, minY = c[0].y, maxY = c[0].y;
+
+			for (k = 1; k < 4; ++k) {
+				minX = fmin(minX, c[k].x);
+				minY = fmin(minY, c[k].y);
+				maxY = fmax(maxY, c[k].y);
+			}
+
+			// a curve that is wholly above, below or to the right of the point crosses the ray just as its chord does
+
+			if (minY > point.y || maxY < point.y || minX > point.x)
+				winding += DKWindingCrossing(c[0], c[3], point);
+			else {
+				size_t steps = DKCubicFlatteningSteps(c, tolerance);
+
+				for (k = 1; k <= steps; ++k) {
+					DKPathPoint p = k == steps ? c[3] : DKCubicPointAt(c, (double)k / steps);
+
+					winding += DKWindingCrossing(current, p, point);
+					current = p;
+				}
+			}
+			current = c[3];
+			break;
+		}
+
+		case kDKPathClose:
+			winding += DKWindingCrossing(current, start, point);
+			current = start;
+			break;
+		}
+
+		pp += DKPathVerbPointCount(path->verbs[i]);
+	}
+
+	return winding + DKWindingCrossing(current, start, point);
+}
+
+#pragma mark -
+
+DKPathPoint DKCubicPointAt(const DKPathPoint c[4], double t)
+{
+	double mt = 1.0 - t;
+	double a = mt * mt * mt, b = 3.0 * mt * mt * t, d = 3.0 * mt * t * t, e = t * t * t;
+	DKPathPoint p = { a * c[0].x + b * c[1].x + d * c[2].x + e * c[3].x, a * c[0].y + b * c[1].y + d * c[2].y + e * c[3].y };
+
+	return p;
+}
+
+DKPathPoint DKCubicDerivativeAt(const DKPathPoint c[4], double t)
+{
+	double mt = 1.0 - t;
+	double a = 3.0 * mt * mt, b = 6.0 * mt * t, d = 3.0 * t * t;
+	DKPathPoint p = { a * (c[1].x - c[0].x) + b * (c[2].x - c[1].x) + d * (c[3].x - c[2].x),
+		a * (c[1].y - c[0].y) + b * (c[2].y - c[1].y) + d * (c[3].y - c[2].y) };
+
+	return p;
+}
+
+static inline DKPathPoint DKLerp(DKPathPoint a, DKPathPoint b, double t)
+{
+	DKPathPoint p = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+	return p;
+}
+
+void DKCubicSplit(const DKPathPoint c[4], double t, DKPathPoint left[4], DKPathPoint right[4])
+{
+	DKPathPoint p01 = DKLerp(c[0], c[1], t);
+	DKPathPoint p12 = DKLerp(c[1], c[2], t);
+	DKPathPoint p23 = DKLerp(c[2], c[3], t);
+	DKPathPoint p012 = DKLerp(p01, p12, t);
+	DKPathPoint p123 = DKLerp(p12, p23, t);
+	DKPathPoint mid = DKLerp(p012, p123, t);
+	DKPathPoint c0 = c[0], c3 = c[3];
+
+	left[0] = c0;
+	left[1] = p01;
+	left[2] = p012;
+	left[3] = mid;
+	right[0] = mid;
+	right[1] = p123;
+	right[2] = p23;
+	right[3] = c3;
+}
+
+void DKCubicSubsegment(const DKPathPoint c[4], double t0, double t1, DKPathPoint result[4])
+{
+	DKPathPoint scratch[4];
+
+	if (t0 <= 0.0) {
+		if (t1 >= 1.0)
+			memcpy(result, c, 4 * sizeof(DKPathPoint));
+		else
+			DKCubicSplit(c, t1, result, scratch);
+		return;
+	}
+
+	DKCubicSplit(c, t0, scratch, result);
+
+	if (t1 < 1.0)
+		DKCubicSplit(result, (t1 - t0) / (1.0 - t0), result, scratch);
+}
+
+size_t DKCubicFlatteningSteps(const DKPathPoint c[4], double tolerance)
+{
+	// Wang's formula: the second differences of the control points bound how far the curve strays from its chords
+
+	double ax = c[0].x - 2.0 * c[1].x + c[2].x, ay = c[0].y - 2.0 * c[1].y + c[2].y;
+	double bx = c[1].x - 2.0 * c[2].x + c[3].x, by = c[1].y - 2.0 * c[2].y + c[3].y;
+	double m = sqrt(fmax(ax * ax + ay * ay, bx * bx + by * by));
+
+	if (tolerance <= 0.0 || m <= 0.0)
+		return 1;
+
+	double n = ceil(sqrt(0.75 * m / tolerance));
+
+	return n < 1.0 ? 1 : (n > 65536.0 ? 65536 : (size_t)n);
+}
+
+static double DKCubicLengthRecursive(const DKPathPoint c[4], double tolerance, int depth)
+{
+	double chord = hypot(c[3].x - c[0].x, c[3].y - c[0].y);
+	double polygon = hypot(c[1].x - c[0].x, c[1].y - c[0].y) + hypot(c[2].x - c[1].x, c[2].y - c[1].y) + hypot(c[3].x - c[2].x, c[3].y - c[2].y);
+
+	if (polygon - chord <= tolerance || depth >= 16)
+		return (2.0 * chord + polygon) / 3.0;
+
+	DKPathPoint left[4], right[4];
+
+	DKCubicSplit(c, 0.5, left, right);
+	return DKCubicLengthRecursive(left, tolerance * 0.5, depth + 1) + DKCubicLengthRecursive(right, tolerance * 0.5, depth + 1);
+}
+
+double DKCubicLength(const DKPathPoint c[4], double tolerance)
+{
+	return DKCubicLengthRecursive(c, tolerance > 0.0 ? tolerance : 1e-3, 0);
+}
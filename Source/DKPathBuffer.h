@@ -0,0 +1,116 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKPathBuffer_h
+#define DKPathBuffer_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief A point in a path buffer. It has the same layout as a 64-bit NSPoint or CGPoint. */
+typedef struct {
+	double x, y;
+} DKPathPoint;
+
+/** @brief The kinds of element in a path buffer, with the number of points each one uses. */
+typedef enum {
+	kDKPathMoveTo = 0, ///< 1 point
+	kDKPathLineTo = 1, ///< 1 point
+	kDKPathCurveTo = 2, ///< 3 points: the two control points, then the end point
+	kDKPathClose = 3 ///< no points. Like NSBezierPath, the next element starts from the subpath's first point.
+} DKPathVerb;
+
+/** @brief A path held as plain arrays of verbs and points, so the geometry engines can work on it without Cocoa.
+
+ A buffer is a value: it can be declared on the stack and must be set up with DKPathBufferInit() and released with DKPathBufferFree().
+ If memory runs out while appending, the element is dropped and <failed> is set, so callers can check once at the end.
+ */
+typedef struct {
+	uint8_t* verbs;
+	size_t verbCount;
+	size_t verbCapacity;
+	DKPathPoint* points;
+	size_t pointCount;
+	size_t pointCapacity;
+	bool failed; ///< set if an append could not get memory
+} DKPathBuffer;
+
+void DKPathBufferInit(DKPathBuffer* path);
+void DKPathBufferFree(DKPathBuffer* path);
+
+/** @brief Empties a buffer but keeps its memory for reuse. */
+void DKPathBufferClear(DKPathBuffer* path);
+
+/** @brief Makes sure a buffer can take the given number of further verbs and points without growing. */
+bool DKPathBufferReserve(DKPathBuffer* path, size_t verbs, size_t points);
+
+void DKPathBufferMoveTo(DKPathBuffer* path, DKPathPoint p);
+void DKPathBufferLineTo(DKPathBuffer* path, DKPathPoint p);
+void DKPathBufferCurveTo(DKPathBuffer* path, DKPathPoint c1, DKPathPoint c2, DKPathPoint p);
+void DKPathBufferClose(DKPathBuffer* path);
+
+/** @brief Appends all the elements of another buffer. */
+void DKPathBufferAppend(DKPathBuffer* path, const DKPathBuffer* other);
+
+/** @brief Appends each subpath of another buffer running the other way. Closed subpaths stay closed and start from the same point. */
+void DKPathBufferAppendReversed(DKPathBuffer* path, const DKPathBuffer* other);
+
+static inline bool DKPathBufferIsEmpty(const DKPathBuffer* path)
+{
+	return path->verbCount == 0;
+}
+
+/** @brief Returns the number of points used by a verb. */
+static inline size_t DKPathVerbPointCount(uint8_t verb)
+{
+	return verb == kDKPathCurveTo ? 3 : (verb == kDKPathClose ? 0 : 1);
+}
+
+/** @brief Returns a hash of a buffer's verbs and point coordinates. Equal paths always give the same value. */
+uint64_t DKPathBufferChecksum(const DKPathBuffer* path);
+
+/** @brief Returns whether two buffers have the same verbs and points. Coordinates are compared as numbers, so -0.0 equals 0.0 just as
+ DKPathBufferChecksum() treats them alike. */
+bool DKPathBufferIsEqual(const DKPathBuffer* path, const DKPathBuffer* other);
+
+/** @brief Returns the area enclosed by a buffer's subpaths, each taken as closed. The area is positive where the subpaths run anticlockwise
+ in unflipped coordinates, and subpaths running the other way subtract from it. */
+double DKPathBufferSignedArea(const DKPathBuffer* path);
+
+/** @brief Returns the winding number of a buffer's subpaths, each taken as closed, about a point. Curves are flattened to within
+ <tolerance>; the point lies inside under the nonzero rule if the result is not 0, and under the even-odd rule if it is odd. */
+int DKPathBufferWindingNumber(const DKPathBuffer* path, DKPathPoint point, double tolerance);
+
+// cubic segments
+
+/** @brief Returns the point at <t> on the cubic bezier segment <c>. */
+DKPathPoint DKCubicPointAt(const DKPathPoint c[4], double t);
+
+/** @brief Returns the first derivative at <t> of the cubic bezier segment <c>. */
+DKPathPoint DKCubicDerivativeAt(const DKPathPoint c[4], double t);
+
+/** @brief Splits a cubic bezier segment at <t> into <left> and <right>, either of which may alias <c>. */
+void DKCubicSplit(const DKPathPoint c[4], double t, DKPathPoint left[4], DKPathPoint right[4]);
+
+/** @brief Returns the part of a cubic bezier segment between <t0> and <t1>. */
+void DKCubicSubsegment(const DKPathPoint c[4], double t0, double t1, DKPathPoint result[4]);
+
+/** @brief Returns the number of line segments needed to flatten a cubic bezier segment so that no point is further than <tolerance> from it. */
+size_t DKCubicFlatteningSteps(const DKPathPoint c[4], double tolerance);
+
+/** @brief Returns the length of a cubic bezier segment, to within roughly <tolerance>. */
+double DKCubicLength(const DKPathPoint c[4], double tolerance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKPathBuffer_h */
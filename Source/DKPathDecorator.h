@@ -6,11 +6,26 @@
 
 #import <Cocoa/Cocoa.h>
 #import "DKRasterizer.h"
+#import "DKRandom.h"
 #import "NSBezierPath+Text.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class DKQuartzCache;
+@class DKQuartzCache, DKStrokeDash;
+
+/** the random values used for each motif placement, each of which has its own counter in the decorator's random stream */
+typedef NS_ENUM(NSUInteger, DKPlacementRandomValue) {
+	kDKPlacementRandomWobbleX = 0,
+	kDKPlacementRandomWobbleY = 1,
+	kDKPlacementRandomScale = 2,
+	kDKPlacementRandomAngle = 3,
+	kDKPlacementRandomValueCount = 4
+};
+
+NS_INLINE uint64_t DKPlacementRandomCounter(NSUInteger placement, DKPlacementRandomValue value)
+{
+	return (uint64_t)placement * kDKPlacementRandomValueCount + value;
+}
 
 /** @brief This renderer draws the image along the path of another object spaced at \c interval distance.
 
@@ -37,10 +52,10 @@ NS_ASSUME_NONNULL_BEGIN
 	BOOL m_useChainMethod;
 	DKQuartzCache* mDKCache;
 	BOOL m_lowQuality;
+	DKStrokeDash* mDash;
 @protected
 	NSUInteger mPlacementCount;
-	NSMutableArray* mWobbleCache;
-	NSMutableArray* mScaleRandCache;
+	DKRandomSeed mRandomSeed;
 }
 
 + (DKPathDecorator*)pathDecoratorWithImage:(nullable NSImage*)image;
@@ -52,6 +67,9 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)setUpCache;
 - (void)setPDFImageRep:(NSPDFImageRep*)rep;
 
+/** @brief The blend mode each motif is drawn with: source-atop for an image, normal for a PDF or when drawing from the low quality cache. */
+@property (readonly) CGBlendMode motifBlendMode;
+
 @property (nonatomic) CGFloat scale;
 
 @property (nonatomic) CGFloat scaleRandomness;
@@ -65,8 +83,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic) CGFloat wobblyness;
 
+/** @brief The seed from which the wobble and scale randomness of each motif is derived.
+
+ The random values for a motif depend only on the seed and the motif's placement count, so the result is the same on every redraw and on
+ any thread. New decorators get an unpredictable seed; it is archived and copied.
+ */
+@property DKRandomSeed randomSeed;
+
 @property BOOL normalToPath;
 
+/** @brief An optional dash that breaks the path up, so that motifs are only placed along the dashes.
+
+ The spacing starts afresh at the start of each dash. The pattern is taken in points, as for a line 1 point wide, and the dashes of a path
+ are cached so that redrawing it doesn't dash it again.
+ */
+@property (strong, nullable) DKStrokeDash* dash;
+
 @property CGFloat leadInLength;
 @property CGFloat leadOutLength;
 
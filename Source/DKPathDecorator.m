@@ -12,6 +12,7 @@
 #import "DKGeometryUtilities.h"
 #import "DKQuartzCache.h"
 #import "DKRandom.h"
+#import "DKStrokeDash.h"
 #import "LogEvent.h"
 #import "NSBezierPath+Geometry.h"
 #import "NSBezierPath+Shapes.h"
@@ -34,6 +35,7 @@
 		m_scale = 1.0;
 		m_interval = 50.0;
 		m_normalToPath = YES;
+		mRandomSeed = DKRandomSeedMake();
 	}
 	return self;
 }
@@ -143,6 +145,16 @@
 	}
 }
 
+- (CGBlendMode)motifBlendMode
+{
+	// must agree with how -placeObjectAtPoint:... draws each motif
+
+	if (mDKCache != nil && m_lowQuality)
+		return kCGBlendModeNormal;
+
+	return m_pdf != nil ? kCGBlendModeNormal : kCGBlendModeSourceAtop;
+}
+
 #pragma mark -
 - (void)setScale:(CGFloat)scale
 {
@@ -157,14 +169,7 @@
 {
 	scRand = LIMIT(scRand, 0, 1.0);
 
-	if (scRand != mScaleRandomness) {
-		mScaleRandomness = scRand;
-
-		if (mScaleRandCache == nil)
-			mScaleRandCache = [[NSMutableArray alloc] init];
-
-		[mScaleRandCache removeAllObjects];
-	}
+	mScaleRandomness = scRand;
 }
 
 @synthesize scaleRandomness = mScaleRandomness;
@@ -181,17 +186,11 @@
 {
 	wobble = LIMIT(wobble, 0, 1);
 
-	if (wobble != mWobblyness) {
-		mWobblyness = wobble;
-
-		if (mWobbleCache == nil)
-			mWobbleCache = [[NSMutableArray alloc] init];
-
-		[mWobbleCache removeAllObjects];
-	}
+	mWobblyness = wobble;
 }
 
 @synthesize wobblyness = mWobblyness;
+@synthesize randomSeed = mRandomSeed;
 
 #pragma mark -
 @synthesize normalToPath = m_normalToPath;
@@ -221,6 +220,7 @@
 
 #pragma mark -
 @synthesize usesChainMethod = m_useChainMethod;
+@synthesize dash = mDash;
 
 #pragma mark -
 #pragma mark As a GCObservableObject
@@ -234,7 +234,28 @@
 		@"lateralOffset",
 		@"lateralOffsetAlternates",
 		@"wobblyness",
-		@"scaleRandomness"]];
+		@"scaleRandomness",
+		@"randomSeed",
+		@"dash"]];
+}
+
++ (NSArray*)equivalenceKeyPaths
+{
+	// the lead-in and lead-out lengths taper the motifs at the ends of the path, and the seed places the random ones
+
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"image", @"scale", @"scaleRandomness", @"interval", @"leaderDistance",
+		@"fixedLeadInAndOutLengths", @"leadInAndOutLengthProportion", @"normalToPath", @"usesChainMethod", @"lateralOffset",
+		@"lateralOffsetAlternates", @"wobblyness", @"randomSeed", @"dash"]];
+}
+
+- (NSArray*)fixedLeadInAndOutLengths
+{
+	// when the lengths are a proportion of the path they are set again each time the decorator draws, so only the proportion counts
+
+	if ([self leadInAndOutLengthProportion] != 0)
+		return @[];
+
+	return @[@([self leadInLength]), @([self leadOutLength])];
 }
 
 - (void)registerActionNames
@@ -262,6 +283,10 @@
 			 forKeyPath:@"wobblyness"];
 	[self setActionName:@"#kind# Scale Randomness"
 			 forKeyPath:@"scaleRandomness"];
+	[self setActionName:@"#kind# Random Seed"
+			 forKeyPath:@"randomSeed"];
+	[self setActionName:@"#kind# Dash"
+			 forKeyPath:@"dash"];
 }
 
 #pragma mark -
@@ -315,16 +340,11 @@
 		NSPoint wobblePoint = NSZeroPoint;
 
 		if ([self wobblyness] > 0.0) {
-			// wobblyness is a randomising positioning factor from 0..1 that is scaled by the spacing and offset by half. This is
-			// cached so that the wobble positions are not recalculated unless the wobble factor itself changes.
-
-			if (mPlacementCount < [mWobbleCache count])
-				wobblePoint = [[mWobbleCache objectAtIndex:mPlacementCount] pointValue];
-			else {
-				wobblePoint.x = [DKRandom randomPositiveOrNegativeNumber] * [self interval] * [self wobblyness];
-				wobblePoint.y = [DKRandom randomPositiveOrNegativeNumber] * [self interval] * [self wobblyness];
-				[mWobbleCache addObject:[NSValue valueWithPoint:wobblePoint]];
-			}
+			// wobblyness is a randomising positioning factor from 0..1 that is scaled by the spacing and offset by half. The random
+			// values are derived from the placement count, so each motif keeps the same wobble on every redraw.
+
+			wobblePoint.x = DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomWobbleX)) * [self interval] * [self wobblyness];
+			wobblePoint.y = DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomWobbleY)) * [self interval] * [self wobblyness];
 		}
 
 		CGFloat randScale = 1.0;
@@ -333,12 +353,7 @@
 			// scale randomness is a randomising factor applied to the scale of the motif. Scale max is always
 			// set to the normal scale, the randomising factor makes the scale relatively smaller
 
-			if (mPlacementCount < [mScaleRandCache count])
-				randScale = [[mScaleRandCache objectAtIndex:mPlacementCount] doubleValue];
-			else {
-				randScale = 1.0 + ([DKRandom randomPositiveOrNegativeNumber] * [self scaleRandomness]);
-				[mScaleRandCache addObject:@(randScale)];
-			}
+			randScale = 1.0 + (DKRandomSignedValue(mRandomSeed, DKPlacementRandomCounter(mPlacementCount, kDKPlacementRandomScale)) * [self scaleRandomness]);
 		}
 
 		[tfm translateXBy:p.x + dx + wobblePoint.x
@@ -485,23 +500,67 @@
 	if ([self interval] <= 0.0)
 		return;
 
-	if ([self usesChainMethod]) {
-		NSInteger pass = 0;
+	if ([self dash]) {
+		// the dash pattern is in points, so it's applied as if to a line 1 point wide
+
+		if ([path lineWidth] != 1.0 && [[self dash] scalesToLineWidth]) {
+			path = [path copy];
+			[path setLineWidth:1.0];
+		}
+
+		NSBezierPath* dashes = [[self dash] dashedPathForPath:path];
+
+		if ([self usesChainMethod]) {
+			for (NSBezierPath* dash in [dashes subPaths])
+				[self placeLinksOnPath:dash];
+		} else {
+			// each dash is spaced afresh, but the positions run on along the dashed path so that the lead-in and lead-out still taper
+			// its ends
 
-		[path placeLinksOnPathWithLinkLength:[self interval]
-							   factoryObject:self
-									userInfo:&pass];
+			CGFloat start = 0.0;
 
-		++pass;
-		[path placeLinksOnPathWithLinkLength:[self interval]
-							   factoryObject:self
-									userInfo:&pass];
-	} else
+			for (NSBezierPath* dash in [dashes subPaths]) {
+				CGFloat length = [dash length];
+				CGFloat distance, slope;
+
+				for (distance = 0.0; distance <= length; distance += [self interval]) {
+					NSPoint p = [dash pointOnPathAtLength:distance
+													slope:&slope];
+
+					[self placeObjectAtPoint:p
+									  onPath:dashes
+									position:start + distance
+									   slope:slope
+									userInfo:NULL];
+				}
+
+				start += length;
+			}
+		}
+	} else if ([self usesChainMethod])
+		[self placeLinksOnPath:path];
+	else
 		[path placeObjectsOnPathAtInterval:[self interval]
 							 factoryObject:self
 								  userInfo:NULL];
 }
 
+- (void)placeLinksOnPath:(NSBezierPath*)path
+{
+	// the links are drawn in two passes so that the odd links lie over the even ones
+
+	NSInteger pass = 0;
+
+	[path placeLinksOnPathWithLinkLength:[self interval]
+						   factoryObject:self
+								userInfo:&pass];
+
+	++pass;
+	[path placeLinksOnPathWithLinkLength:[self interval]
+						   factoryObject:self
+								userInfo:&pass];
+}
+
 #pragma mark -
 #pragma mark As part of NSCoding Protocol
 - (void)encodeWithCoder:(NSCoder*)coder
@@ -545,6 +604,10 @@
 				 forKey:@"DKPathDecorator_wobblyness"];
 	[coder encodeDouble:mScaleRandomness
 				 forKey:@"DKPathDecorator_scaleRandomness"];
+	[coder encodeInt64:(int64_t)mRandomSeed
+				forKey:@"DKPathDecorator_randomSeed"];
+	[coder encodeObject:[self dash]
+				 forKey:@"DKPathDecorator_dash"];
 }
 
 - (instancetype)initWithCoder:(NSCoder*)coder
@@ -582,6 +645,13 @@
 		mAlternateLateralOffsets = [coder decodeBoolForKey:@"DKPathDecorator_alternateLaterals"];
 		mWobblyness = [coder decodeDoubleForKey:@"DKPathDecorator_wobblyness"];
 		mScaleRandomness = [coder decodeDoubleForKey:@"DKPathDecorator_scaleRandomness"];
+
+		if ([coder containsValueForKey:@"DKPathDecorator_randomSeed"])
+			mRandomSeed = (DKRandomSeed)[coder decodeInt64ForKey:@"DKPathDecorator_randomSeed"];
+		else
+			mRandomSeed = DKRandomSeedMake();
+
+		mDash = [[coder decodeObjectForKey:@"DKPathDecorator_dash"] copy];
 	}
 	return self;
 }
@@ -613,6 +683,8 @@
 
 	dc->mLateralOffset = mLateralOffset;
 	dc->mAlternateLateralOffsets = mAlternateLateralOffsets;
+	dc->mRandomSeed = mRandomSeed;
+	dc->mDash = [mDash copyWithZone:zone];
 
 	return dc;
 }
@@ -0,0 +1,431 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKPathMeasure.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kDKPathMeasureMinimumCapacity 16
+
+void DKPathMeasureInit(DKPathMeasure* measure)
+{
+	memset(measure, 0, sizeof(DKPathMeasure));
+}
+
+void DKPathMeasureFree(DKPathMeasure* measure)
+{
+	free(measure->segments);
+	free(measure->stations);
+	free(measure->subpaths);
+	memset(measure, 0, sizeof(DKPathMeasure));
+}
+
+size_t DKPathMeasureMemorySize(const DKPathMeasure* measure)
+{
+	return sizeof(DKPathMeasure) + measure->segmentCapacity * sizeof(DKPathMeasureSegment) + measure->stationCapacity * sizeof(DKPathMeasureStation) + measure->subpathCapacity * sizeof(DKPathMeasureSubpath);
+}
+
+#pragma mark - measuring
+
+static bool DKPathMeasureGrow(void** storage, size_t* capacity, size_t needed, size_t itemSize)
+{
+	if (needed <= *capacity)
+		return true;
+
+	size_t newCapacity = *capacity < kDKPathMeasureMinimumCapacity ? kDKPathMeasureMinimumCapacity : *capacity;
+
+	while (newCapacity < needed)
+		newCapacity *= 2;
+
+	void* grown = realloc(*storage, newCapacity * itemSize);
+
+	if (grown == NULL)
+		return false;
+
+	*storage = grown;
+	*capacity = newCapacity;
+	return true;
+}
+
+// starts a new subpath, reusing the last one if nothing was measured along it
+
+static void DKPathMeasureBeginSubpath(DKPathMeasure* measure)
+{
+	if (measure->subpathCount > 0 && measure->subpaths[measure->subpathCount - 1].segmentCount == 0)
+		return;
+
+	if (!DKPathMeasureGrow((void**)&measure->subpaths, &measure->subpathCapacity, measure->subpathCount + 1, sizeof(DKPathMeasureSubpath))) {
+		measure->failed = true;
+		return;
+	}
+
+	DKPathMeasureSubpath* subpath = &measure->subpaths[measure->subpathCount++];
+
+	subpath->firstSegment = measure->segmentCount;
+	subpath->segmentCount = 0;
+	subpath->firstStation = measure->stationCount;
+	subpath->stationCount = 0;
+	subpath->length = 0.0;
+	subpath->closed = false;
+}
+
+static void DKPathMeasureAddSegment(DKPathMeasure* measure, const DKPathPoint c[4], bool line)
+{
+	size_t k, steps = line ? 1 : DKCubicFlatteningSteps(c, measure->tolerance);
+
+	if (measure->failed || measure->subpathCount == 0)
+		return;
+
+	if (!DKPathMeasureGrow((void**)&measure->segments, &measure->segmentCapacity, measure->segmentCount + 1, sizeof(DKPathMeasureSegment))
+		|| !DKPathMeasureGrow((void**)&measure->stations, &measure->stationCapacity, measure->stationCount + steps, sizeof(DKPathMeasureStation))) {
+		measure->failed = true;
+		return;
+	}
+
+	DKPathMeasureSubpath* subpath = &measure->subpaths[measure->subpathCount - 1];
+	DKPathMeasureSegment* segment = &measure->segments[measure->segmentCount];
+	DKPathPoint previous = c[0];
+	double distance = subpath->length;
+
+	memcpy(segment->c, c, 4 * sizeof(DKPathPoint));
+	segment->start = distance;
+	segment->firstStation = measure->stationCount;
+	segment->line = line;
+
+	for (k = 1; k <= steps; ++k) {
+		double t = (double)k / steps;
+		DKPathPoint p = k == steps ? c[3] : DKCubicPointAt(c, t);
+		DKPathMeasureStation* station = &measure->stations[measure->stationCount++];
+
+		distance += hypot(p.x - previous.x, p.y - previous.y);
+		station->distance = distance;
+		station->t = t;
+		station->segment = measure->segmentCount;
+		previous = p;
+	}
+
+	measure->segmentCount++;
+	measure->length += distance - subpath->length;
+	subpath->length = distance;
+	subpath->segmentCount++;
+	subpath->stationCount += steps;
+}
+
+// sets up a line as a cubic whose parameter runs evenly along it
+
+static void DKPathMeasureAddLine(DKPathMeasure* measure, DKPathPoint a, DKPathPoint b)
+{
+	DKPathPoint c[4];
+
+	c[0] = a;
+	c[1].x = a.x + (b.x - a.x) / 3.0;
+	c[1].y = a.y + (b.y - a.y) / 3.0;
+	c[2].x = a.x + (b.x - a.x) * 2.0 / 3.0;
+	c[2].y = a.y + (b.y - a.y) * 2.0 / 3.0;
+	c[3] = b;
+
+	DKPathMeasureAddSegment(measure, c, true);
+}
+
+bool DKPathMeasureSetPath(DKPathMeasure* measure, const DKPathBuffer* path, double tolerance)
+{
+	DKPathPoint start = { 0, 0 }, current = { 0, 0 };
+	const DKPathPoint* pp = path->points;
+	bool restart = true;
+	size_t i;
+
+	measure->segmentCount = 0;
+	measure->stationCount = 0;
+	measure->subpathCount = 0;
+	measure->length = 0.0;
+	measure->tolerance = tolerance > 0.0 ? tolerance : 0.1;
+	measure->failed = false;
+
+	// a subpath without a move of its own begins after the close of the one before
+
+	for (i = 0; i < path->verbCount && !measure->failed; ++i) {
+		if (restart && path->verbs[i] != kDKPathMoveTo)
+			DKPathMeasureBeginSubpath(measure);
+
+		restart = false;
+
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			start = current = pp[0];
+			DKPathMeasureBeginSubpath(measure);
+			break;
+
+		case kDKPathLineTo:
+			DKPathMeasureAddLine(measure, current, pp[0]);
+			current = pp[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, pp[0], pp[1], pp[2] };
+
+			DKPathMeasureAddSegment(measure, c, false);
+			current = pp[2];
+			break;
+		}
+
+		case kDKPathClose:
+			if (current.x != start.x || current.y != start.y)
+				DKPathMeasureAddLine(measure, current, start);
+
+			if (measure->subpathCount > 0)
+				measure->subpaths[measure->subpathCount - 1].closed = true;
+
+			current = start;
+			restart = true;
+			break;
+		}
+
+		pp += DKPathVerbPointCount(path->verbs[i]);
+	}
+
+	// drop a trailing subpath that has nothing in it
+
+	if (measure->subpathCount > 0 && measure->subpaths[measure->subpathCount - 1].segmentCount == 0)
+		measure->subpathCount--;
+
+	return !measure->failed;
+}
+
+#pragma mark - pieces
+
+typedef struct {
+	DKPathBuffer* result;
+	bool pending; // the next piece must start with a move
+	size_t hint; // the chord, counted from the start of the subpath, that the last distance was found in
+	bool hasNear; // if set, only pieces of segments whose control points come within <margin> of <near> are added
+	DKPathPoint near;
+	double margin;
+} DKPathMeasureEmitter;
+
+// finds the segment and parameter at a distance along a subpath. The chord found is the first that ends beyond the distance, so a
+// distance that falls on a joint belongs to the segment after it. Dashes are found in order along the subpath, so the search gallops on
+// from the chord found last time, given by <hint>, rather than starting over.
+
+static void DKPathMeasureLocate(const DKPathMeasure* measure, const DKPathMeasureSubpath* subpath, double distance, size_t* hint, size_t* segmentIndex, double* t)
+{
+	const DKPathMeasureStation* stations = measure->stations + subpath->firstStation;
+	size_t lo = 0, hi = subpath->stationCount;
+
+	if (*hint < hi && stations[*hint].distance <= distance) {
+		size_t step = 1;
+
+		lo = *hint + 1;
+
+		while (lo + step < hi && stations[lo + step].distance <= distance) {
+			lo += step + 1;
+			step *= 2;
+		}
+
+		if (lo + step < hi)
+			hi = lo + step + 1;
+	} else if (*hint < hi)
+		hi = *hint + 1;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (stations[mid].distance > distance)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	*hint = lo;
+
+	if (lo == subpath->stationCount) {
+		*segmentIndex = subpath->firstSegment + subpath->segmentCount - 1;
+		*t = 1.0;
+		return;
+	}
+
+	const DKPathMeasureStation* station = &stations[lo];
+	const DKPathMeasureSegment* segment = &measure->segments[station->segment];
+	size_t k = subpath->firstStation + lo;
+	double d0 = k == segment->firstStation ? segment->start : measure->stations[k - 1].distance;
+	double t0 = k == segment->firstStation ? 0.0 : measure->stations[k - 1].t;
+
+	*segmentIndex = station->segment;
+	*t = t0 + (station->t - t0) * (distance - d0) / (station->distance - d0);
+}
+
+static bool DKPathMeasureSegmentIsNear(const DKPathMeasureEmitter* emitter, const DKPathPoint c[4])
+{
+	double minX = fmin(fmin(c[0].x, c[1].x), fmin(c[2].x, c[3].x)), maxX = fmax(fmax(c[0].x, c[1].x), fmax(c[2].x, c[3].x));
+	double minY = fmin(fmin(c[0].y, c[1].y), fmin(c[2].y, c[3].y)), maxY = fmax(fmax(c[0].y, c[1].y), fmax(c[2].y, c[3].y));
+	DKPathPoint p = emitter->near;
+
+	return p.x >= minX - emitter->margin && p.x <= maxX + emitter->margin && p.y >= minY - emitter->margin && p.y <= maxY + emitter->margin;
+}
+
+static void DKPathMeasureEmitPiece(DKPathMeasureEmitter* emitter, const DKPathMeasureSegment* segment, double t0, double t1)
+{
+	DKPathPoint piece[4];
+
+	if (emitter->hasNear && !DKPathMeasureSegmentIsNear(emitter, segment->c)) {
+		emitter->pending = true;
+		return;
+	}
+
+	DKCubicSubsegment(segment->c, t0, t1, piece);
+
+	if (emitter->pending) {
+		DKPathBufferMoveTo(emitter->result, piece[0]);
+		emitter->pending = false;
+	}
+
+	if (segment->line)
+		DKPathBufferLineTo(emitter->result, piece[3]);
+	else
+		DKPathBufferCurveTo(emitter->result, piece[1], piece[2], piece[3]);
+}
+
+static void DKPathMeasureEmitRange(const DKPathMeasure* measure, const DKPathMeasureSubpath* subpath, double from, double to, DKPathMeasureEmitter* emitter)
+{
+	size_t a, b, s;
+	double ta, tb;
+
+	DKPathMeasureLocate(measure, subpath, from, &emitter->hint, &a, &ta);
+	DKPathMeasureLocate(measure, subpath, to, &emitter->hint, &b, &tb);
+
+	emitter->pending = true;
+
+	if (a == b) {
+		DKPathMeasureEmitPiece(emitter, &measure->segments[a], ta, tb);
+		return;
+	}
+
+	DKPathMeasureEmitPiece(emitter, &measure->segments[a], ta, 1.0);
+
+	for (s = a + 1; s < b; ++s)
+		DKPathMeasureEmitPiece(emitter, &measure->segments[s], 0.0, 1.0);
+
+	DKPathMeasureEmitPiece(emitter, &measure->segments[b], 0.0, tb);
+}
+
+bool DKPathMeasureAppendPiece(const DKPathMeasure* measure, size_t subpath, double from, double to, DKPathBuffer* result)
+{
+	if (subpath >= measure->subpathCount)
+		return true;
+
+	const DKPathMeasureSubpath* sp = &measure->subpaths[subpath];
+	DKPathMeasureEmitter emitter = { result, true, 0, false, { 0, 0 }, 0.0 };
+
+	from = fmin(fmax(from, 0.0), sp->length);
+	to = fmin(fmax(to, from), sp->length);
+
+	DKPathMeasureEmitRange(measure, sp, from, to, &emitter);
+	return !result->failed;
+}
+
+#pragma mark - dashing
+
+double DKPathDashPatternLength(const double* pattern, size_t count)
+{
+	double total = 0.0;
+	size_t i;
+
+	if (pattern == NULL || count == 0)
+		return 0.0;
+
+	for (i = 0; i < count; ++i) {
+		if (!(pattern[i] >= 0.0) || !isfinite(pattern[i]))
+			return 0.0;
+
+		total += pattern[i];
+	}
+
+	if (!(total > 0.0) || !isfinite(total))
+		return 0.0;
+
+	return (count & 1) ? total * 2.0 : total;
+}
+
+static void DKPathMeasureDashSubpath(const DKPathMeasure* measure, const DKPathMeasureSubpath* subpath, const double* pattern, size_t count, double total, double phase, DKPathMeasureEmitter* emitter)
+{
+	size_t cycle = (count & 1) ? count * 2 : count;
+	size_t index = 0;
+	double remaining = pattern[0];
+	double position = 0.0, dashStart = 0.0;
+
+	// find where in the pattern the subpath starts
+
+	phase = fmod(phase, total);
+
+	if (phase < 0.0)
+		phase += total;
+
+	while (phase > 0.0 && phase >= remaining) {
+		phase -= remaining;
+		index = (index + 1) % cycle;
+		remaining = pattern[index % count];
+	}
+
+	remaining -= phase;
+
+	// step from one end of a dash or gap to the next. A dash still going at the end of the subpath stops there.
+
+	while (!emitter->result->failed) {
+		bool on = (index & 1) == 0;
+		double end = position + remaining;
+
+		if (!(end < subpath->length)) {
+			if (on)
+				DKPathMeasureEmitRange(measure, subpath, dashStart, subpath->length, emitter);
+			break;
+		}
+
+		if (on)
+			DKPathMeasureEmitRange(measure, subpath, dashStart, end, emitter);
+		else
+			dashStart = end;
+
+		position = end;
+		index = (index + 1) % cycle;
+		remaining = pattern[index % count];
+	}
+}
+
+static bool DKPathMeasureDashWithEmitter(const DKPathMeasure* measure, const double* pattern, size_t count, double phase, DKPathMeasureEmitter* emitter)
+{
+	double total = DKPathDashPatternLength(pattern, count);
+	size_t i;
+
+	if (!isfinite(phase))
+		total = 0.0;
+
+	for (i = 0; i < measure->subpathCount && !emitter->result->failed; ++i) {
+		const DKPathMeasureSubpath* subpath = &measure->subpaths[i];
+
+		emitter->hint = 0;
+
+		if (total > 0.0)
+			DKPathMeasureDashSubpath(measure, subpath, pattern, count, total, phase, emitter);
+		else
+			DKPathMeasureEmitRange(measure, subpath, 0.0, subpath->length, emitter);
+	}
+
+	return !emitter->result->failed;
+}
+
+bool DKPathMeasureDash(const DKPathMeasure* measure, const double* pattern, size_t count, double phase, DKPathBuffer* result)
+{
+	DKPathMeasureEmitter emitter = { result, true, 0, false, { 0, 0 }, 0.0 };
+
+	return DKPathMeasureDashWithEmitter(measure, pattern, count, phase, &emitter);
+}
+
+bool DKPathMeasureDashNear(const DKPathMeasure* measure, const double* pattern, size_t count, double phase, DKPathPoint point, double margin, DKPathBuffer* result)
+{
+	DKPathMeasureEmitter emitter = { result, true, 0, true, point, margin };
+
+	return DKPathMeasureDashWithEmitter(measure, pattern, count, phase, &emitter);
+}
@@ -0,0 +1,111 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKPathMeasure_h
+#define DKPathMeasure_h
+
+#include "DKPathBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief One line or curve of a measured path. Lines are held as cubics whose parameter runs evenly along them. */
+typedef struct {
+	DKPathPoint c[4];
+	double start; ///< the distance along the subpath to the start of the segment
+	size_t firstStation; ///< the station at the end of the segment's first chord
+	bool line;
+} DKPathMeasureSegment;
+
+/** @brief The end of one chord of a flattened segment. */
+typedef struct {
+	double distance; ///< the distance along the subpath to this point
+	double t; ///< the parameter of this point on its segment
+	size_t segment;
+} DKPathMeasureStation;
+
+/** @brief One subpath of a measured path. The close of a closed subpath is measured as a line back to its start. */
+typedef struct {
+	size_t firstSegment;
+	size_t segmentCount;
+	size_t firstStation;
+	size_t stationCount;
+	double length;
+	bool closed;
+} DKPathMeasureSubpath;
+
+/** @brief A path measured once along its length, so that the piece between any two distances can be found without measuring it again.
+
+ Each curve is flattened to within the tolerance and the distance to the end of every chord kept, so a distance is turned into a segment and
+ parameter by a binary search. Like a path buffer, a measure is a value that must be set up with DKPathMeasureInit() and released with
+ DKPathMeasureFree(). Once made it is only read, so it can be shared between threads.
+ */
+typedef struct {
+	DKPathMeasureSegment* segments;
+	size_t segmentCount;
+	size_t segmentCapacity;
+	DKPathMeasureStation* stations;
+	size_t stationCount;
+	size_t stationCapacity;
+	DKPathMeasureSubpath* subpaths;
+	size_t subpathCount;
+	size_t subpathCapacity;
+	double length; ///< the total length of all the subpaths
+	double tolerance;
+	bool failed; ///< set if memory ran out while measuring
+} DKPathMeasure;
+
+void DKPathMeasureInit(DKPathMeasure* measure);
+void DKPathMeasureFree(DKPathMeasure* measure);
+
+/** @brief Measures a path, replacing anything measured before.
+ @param measure the measure to fill in
+ @param path the path to measure
+ @param tolerance how far the chords curves are measured along may stray from them. Must be > 0.
+ @return false if memory ran out
+ */
+bool DKPathMeasureSetPath(DKPathMeasure* measure, const DKPathBuffer* path, double tolerance);
+
+/** @brief Returns roughly how many bytes a measure holds, for costing it in a cache. */
+size_t DKPathMeasureMemorySize(const DKPathMeasure* measure);
+
+/** @brief Appends the part of a subpath between two distances along it as a new open subpath.
+
+ The piece keeps the original lines and curves, cut where needed. Distances are limited to the length of the subpath.
+ @return false if memory ran out
+ */
+bool DKPathMeasureAppendPiece(const DKPathMeasure* measure, size_t subpath, double from, double to, DKPathBuffer* result);
+
+/** @brief Returns the length of a dash pattern before it repeats with a dash first, or 0 if the pattern is empty, has no length, or has a
+ negative or infinite length in it. A pattern of an odd number of lengths repeats after twice its sum. */
+double DKPathDashPatternLength(const double* pattern, size_t count);
+
+/** @brief Breaks a measured path into its dashes.
+
+ The dashes are the same as DKPathDash() finds, but each end is found by a binary search, so dashing a measured path again at another phase
+ costs only the dashes themselves. The pattern starts again, <phase> into it, at the start of each subpath. If the pattern is empty, or has
+ no length, or has a negative length in it, each subpath is copied whole, as an open subpath.
+ @param measure the measured path
+ @param pattern the lengths of the alternate dashes and gaps, starting with a dash
+ @param count the number of lengths in <pattern>
+ @param phase how far into the pattern each subpath starts
+ @param result a buffer the dashes are appended to
+ @return false if memory ran out
+ */
+bool DKPathMeasureDash(const DKPathMeasure* measure, const double* pattern, size_t count, double phase, DKPathBuffer* result);
+
+/** @brief Like DKPathMeasureDash(), but only keeps the parts of dashes along segments whose control points come within <margin> of <point>.
+
+ This is all a hit test needs. A dash that leaves the neighbourhood and comes back into it is split in two.
+ */
+bool DKPathMeasureDashNear(const DKPathMeasure* measure, const double* pattern, size_t count, double phase, DKPathPoint point, double margin, DKPathBuffer* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKPathMeasure_h */
@@ -0,0 +1,1582 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKPathOffset.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the deepest a cubic is split while looking for an offset within tolerance: at most 1024 pieces per input curve
+
+#define kDKOffsetMaxDepth 10
+
+// lengths below this are treated as zero
+
+#define kDKOffsetEpsilon 1e-9
+
+// crossings closer together than this along the path enclose nothing
+
+#define kDKOffsetParameterEpsilon 1e-7
+
+DKPathOffsetOptions DKPathOffsetDefaultOptions(void)
+{
+	DKPathOffsetOptions options = { 0.1, kDKPathJoinMiter, 10.0, true };
+	return options;
+}
+
+#pragma mark - vectors
+
+static inline DKPathPoint DKVec(double x, double y)
+{
+	DKPathPoint p = { x, y };
+	return p;
+}
+
+static inline DKPathPoint DKVecAdd(DKPathPoint a, DKPathPoint b)
+{
+	return DKVec(a.x + b.x, a.y + b.y);
+}
+
+static inline DKPathPoint DKVecSub(DKPathPoint a, DKPathPoint b)
+{
+	return DKVec(a.x - b.x, a.y - b.y);
+}
+
+static inline DKPathPoint DKVecScale(DKPathPoint a, double s)
+{
+	return DKVec(a.x * s, a.y * s);
+}
+
+static inline double DKVecDot(DKPathPoint a, DKPathPoint b)
+{
+	return a.x * b.x + a.y * b.y;
+}
+
+static inline double DKVecCross(DKPathPoint a, DKPathPoint b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+static inline double DKVecLength(DKPathPoint a)
+{
+	return hypot(a.x, a.y);
+}
+
+// the normal on the left of the direction of travel
+
+static inline DKPathPoint DKVecNormal(DKPathPoint t)
+{
+	return DKVec(-t.y, t.x);
+}
+
+static inline bool DKVecUnit(DKPathPoint a, DKPathPoint* unit)
+{
+	double len = DKVecLength(a);
+
+	if (len <= kDKOffsetEpsilon)
+		return false;
+
+	*unit = DKVecScale(a, 1.0 / len);
+	return true;
+}
+
+#pragma mark - segment lists
+
+// a line or cubic. Lines only use p[0] and p[3], but keep p[1] and p[2] on the chord so they can be treated as cubics.
+
+typedef struct {
+	DKPathPoint p[4];
+	bool line;
+} DKOffsetSegment;
+
+typedef struct {
+	DKOffsetSegment* items;
+	size_t count;
+	size_t capacity;
+	bool failed;
+} DKSegmentList;
+
+static DKOffsetSegment* DKSegmentListAppend(DKSegmentList* list)
+{
+	if (list->count >= list->capacity) {
+		size_t capacity = list->capacity < 16 ? 16 : list->capacity + list->capacity / 2;
+		DKOffsetSegment* items = realloc(list->items, capacity * sizeof(DKOffsetSegment));
+
+		if (items == NULL) {
+			list->failed = true;
+			return NULL;
+		}
+
+		list->items = items;
+		list->capacity = capacity;
+	}
+
+	return &list->items[list->count++];
+}
+
+static void DKSegmentListAddLine(DKSegmentList* list, DKPathPoint a, DKPathPoint b)
+{
+	DKOffsetSegment* s = DKSegmentListAppend(list);
+
+	if (s) {
+		s->p[0] = a;
+		s->p[1] = DKVecAdd(a, DKVecScale(DKVecSub(b, a), 1.0 / 3.0));
+		s->p[2] = DKVecAdd(a, DKVecScale(DKVecSub(b, a), 2.0 / 3.0));
+		s->p[3] = b;
+		s->line = true;
+	}
+}
+
+static void DKSegmentListAddCurve(DKSegmentList* list, const DKPathPoint c[4])
+{
+	DKOffsetSegment* s = DKSegmentListAppend(list);
+
+	if (s) {
+		memcpy(s->p, c, sizeof(s->p));
+		s->line = false;
+	}
+}
+
+static inline DKPathPoint DKSegmentListEnd(const DKSegmentList* list)
+{
+	return list->items[list->count - 1].p[3];
+}
+
+// the direction of travel at each end of a segment, skipping control points that coincide with the end point
+
+static DKPathPoint DKSegmentStartTangent(const DKOffsetSegment* s)
+{
+	DKPathPoint t = DKVec(1, 0);
+
+	if (s->line || !DKVecUnit(DKVecSub(s->p[1], s->p[0]), &t))
+		if (!DKVecUnit(DKVecSub(s->p[2], s->p[0]), &t))
+			DKVecUnit(DKVecSub(s->p[3], s->p[0]), &t);
+
+	return t;
+}
+
+static DKPathPoint DKSegmentEndTangent(const DKOffsetSegment* s)
+{
+	DKPathPoint t = DKVec(1, 0);
+
+	if (s->line || !DKVecUnit(DKVecSub(s->p[3], s->p[2]), &t))
+		if (!DKVecUnit(DKVecSub(s->p[3], s->p[1]), &t))
+			DKVecUnit(DKVecSub(s->p[3], s->p[0]), &t);
+
+	return t;
+}
+
+#pragma mark - offsetting curves
+
+static inline DKPathPoint DKCubicSecondDerivativeAt(const DKPathPoint c[4], double t)
+{
+	double ax = c[2].x - 2.0 * c[1].x + c[0].x, ay = c[2].y - 2.0 * c[1].y + c[0].y;
+	double bx = c[3].x - 2.0 * c[2].x + c[1].x, by = c[3].y - 2.0 * c[2].y + c[1].y;
+
+	return DKVec(6.0 * ((1.0 - t) * ax + t * bx), 6.0 * ((1.0 - t) * ay + t * by));
+}
+
+/** finds a cubic that starts and ends on the offset of <c> with the same tangents as <c>, and passes through the offset of the middle of <c>.
+ Returns false if there is no such cubic, which happens near cusps of the offset.
+ */
+static bool DKApproximateOffset(const DKPathPoint c[4], double d, DKPathPoint q[4])
+{
+	DKOffsetSegment s = { { c[0], c[1], c[2], c[3] }, false };
+	DKPathPoint t0 = DKSegmentStartTangent(&s);
+	DKPathPoint t3 = DKSegmentEndTangent(&s);
+	DKPathPoint tm;
+
+	if (!DKVecUnit(DKCubicDerivativeAt(c, 0.5), &tm))
+		return false;
+
+	DKPathPoint p0 = DKVecAdd(c[0], DKVecScale(DKVecNormal(t0), d));
+	DKPathPoint p3 = DKVecAdd(c[3], DKVecScale(DKVecNormal(t3), d));
+	DKPathPoint m = DKVecAdd(DKCubicPointAt(c, 0.5), DKVecScale(DKVecNormal(tm), d));
+
+	// the middle of the cubic is (p0 + p3) / 2 + 3/8 (a t0 - b t3), for handle lengths a and b
+
+	DKPathPoint r = DKVecScale(DKVecSub(m, DKVecScale(DKVecAdd(p0, p3), 0.5)), 8.0 / 3.0);
+	double det = DKVecCross(t3, t0);
+	double a, b;
+
+	if (fabs(det) > 1e-6) {
+		a = DKVecCross(t3, r) / det;
+		b = DKVecCross(t0, r) / det;
+	} else {
+		// the end tangents are parallel, so the middle only fixes a combination of the handle lengths. Keep the original handles'
+		// proportions and scale them to fit the middle as closely as possible.
+
+		double k0 = DKVecLength(DKVecSub(c[1], c[0]));
+		double k3 = DKVecLength(DKVecSub(c[3], c[2]));
+		DKPathPoint h = DKVecSub(DKVecScale(t0, k0), DKVecScale(t3, k3));
+		double hh = DKVecDot(h, h);
+		double scale;
+
+		if (hh > kDKOffsetEpsilon)
+			scale = DKVecDot(r, h) / hh;
+		else {
+			double chord = DKVecLength(DKVecSub(c[3], c[0]));
+			scale = chord > kDKOffsetEpsilon ? DKVecLength(DKVecSub(p3, p0)) / chord : 1.0;
+		}
+
+		a = k0 * scale;
+		b = k3 * scale;
+	}
+
+	// where the offset is larger than the radius of curvature it runs backwards, so both handles point backwards too. Handles that
+	// disagree mean a cusp in between.
+
+	if ((a < 0.0) != (b < 0.0) || !isfinite(a) || !isfinite(b))
+		return false;
+
+	q[0] = p0;
+	q[1] = DKVecAdd(p0, DKVecScale(t0, a));
+	q[2] = DKVecSub(p3, DKVecScale(t3, b));
+	q[3] = p3;
+	return true;
+}
+
+/** measures how far <q> strays from the true offset of <c>: for points along <q>, the difference between their distance from <c> and
+ the offset distance. A point on the wrong side of <c> counts as the whole distance across.
+ */
+static double DKOffsetError(const DKPathPoint c[4], double d, const DKPathPoint q[4], double tolerance)
+{
+	static const double samples[] = { 0.125, 0.25, 0.375, 0.625, 0.75, 0.875 };
+	double worst = 0.0;
+	size_t i;
+	int k;
+
+	for (i = 0; i < sizeof(samples) / sizeof(samples[0]); ++i) {
+		DKPathPoint target = DKCubicPointAt(q, samples[i]);
+		double u = samples[i];
+
+		// Newton's method for the nearest point on c, starting from the matching parameter
+
+		for (k = 0; k < 4; ++k) {
+			DKPathPoint diff = DKVecSub(DKCubicPointAt(c, u), target);
+			DKPathPoint d1 = DKCubicDerivativeAt(c, u);
+			DKPathPoint d2 = DKCubicSecondDerivativeAt(c, u);
+			double denominator = DKVecDot(d1, d1) + DKVecDot(diff, d2);
+
+			if (fabs(denominator) <= kDKOffsetEpsilon)
+				break;
+
+			u -= DKVecDot(diff, d1) / denominator;
+			u = u < 0.0 ? 0.0 : (u > 1.0 ? 1.0 : u);
+		}
+
+		DKPathPoint foot = DKCubicPointAt(c, u);
+		DKPathPoint away = DKVecSub(target, foot);
+		double distance = DKVecLength(away);
+		double side = DKVecCross(DKCubicDerivativeAt(c, u), away);
+		double error;
+
+		if (distance > kDKOffsetEpsilon && side * d < 0.0)
+			error = distance + fabs(d);
+		else
+			error = fabs(distance - fabs(d));
+
+		if (error > worst) {
+			worst = error;
+
+			if (worst > tolerance)
+				break;
+		}
+	}
+
+	return worst;
+}
+
+static void DKOffsetCubic(const DKPathPoint c[4], double d, double tolerance, int depth, DKSegmentList* out)
+{
+	DKPathPoint q[4];
+	bool approximated = DKApproximateOffset(c, d, q);
+
+	if (approximated && (depth >= kDKOffsetMaxDepth || DKOffsetError(c, d, q, tolerance) <= tolerance)) {
+		DKSegmentListAddCurve(out, q);
+		return;
+	}
+
+	if (depth >= kDKOffsetMaxDepth) {
+		// a cusp too small to matter: bridge it with a line between the offset ends
+
+		DKOffsetSegment s = { { c[0], c[1], c[2], c[3] }, false };
+		DKPathPoint p0 = DKVecAdd(c[0], DKVecScale(DKVecNormal(DKSegmentStartTangent(&s)), d));
+		DKPathPoint p3 = DKVecAdd(c[3], DKVecScale(DKVecNormal(DKSegmentEndTangent(&s)), d));
+
+		DKSegmentListAddLine(out, p0, p3);
+		return;
+	}
+
+	DKPathPoint left[4], right[4];
+
+	DKCubicSplit(c, 0.5, left, right);
+	DKOffsetCubic(left, d, tolerance, depth + 1, out);
+	DKOffsetCubic(right, d, tolerance, depth + 1, out);
+}
+
+static void DKOffsetSegmentAppend(const DKOffsetSegment* s, double d, double tolerance, DKSegmentList* out)
+{
+	if (s->line) {
+		DKPathPoint n = DKVecScale(DKVecNormal(DKSegmentStartTangent(s)), d);
+		DKSegmentListAddLine(out, DKVecAdd(s->p[0], n), DKVecAdd(s->p[3], n));
+	} else
+		DKOffsetCubic(s->p, d, tolerance, 0, out);
+}
+
+#pragma mark - joins
+
+// appends a circular arc about <centre> from the current end of <out> to <to>, turning through <sweep> radians, as cubics of at most 90 degrees
+
+static void DKAppendArc(DKSegmentList* out, DKPathPoint centre, DKPathPoint to, double sweep)
+{
+	DKPathPoint r0 = DKVecSub(DKSegmentListEnd(out), centre);
+	int i, pieces = (int)ceil(fabs(sweep) / M_PI_2 - 1e-9);
+
+	if (pieces < 1)
+		pieces = 1;
+
+	double step = sweep / pieces;
+	double k = 4.0 / 3.0 * tan(step / 4.0);
+	double cs = cos(step), sn = sin(step);
+
+	for (i = 0; i < pieces; ++i) {
+		DKPathPoint r1 = DKVec(r0.x * cs - r0.y * sn, r0.x * sn + r0.y * cs);
+		DKPathPoint c[4];
+
+		c[0] = DKVecAdd(centre, r0);
+		c[3] = (i == pieces - 1) ? to : DKVecAdd(centre, r1);
+		c[1] = DKVecAdd(c[0], DKVecScale(DKVecNormal(r0), k));
+		c[2] = DKVecSub(c[3], DKVecScale(DKVecNormal(r1), k));
+		DKSegmentListAddCurve(out, c);
+		r0 = r1;
+	}
+}
+
+/** connects the current end of <out>, which is the offset of the end of a segment arriving at <vertex> along <tin>, to <to>, the offset
+ of the start of the next segment, which leaves along <tout>.
+ */
+static void DKOffsetJoin(DKSegmentList* out, DKPathPoint vertex, DKPathPoint tin, DKPathPoint tout, DKPathPoint to, double d, const DKPathOffsetOptions* options, bool pivot)
+{
+	DKPathPoint from = DKSegmentListEnd(out);
+
+	if (DKVecLength(DKVecSub(to, from)) <= kDKOffsetEpsilon)
+		return;
+
+	double cross = DKVecCross(tin, tout);
+	double dot = DKVecDot(tin, tout);
+	bool reversed = fabs(cross) <= 1e-9 && dot < 0.0;
+
+	// on the inside of a corner the offsets overlap. Joining them directly leaves a loop, which loop removal cuts away. The side of a
+	// stroke goes back through the corner instead, so that the outline covers the whole of the corner when filled.
+
+	if (!reversed && cross * d >= 0.0) {
+		if (pivot) {
+			DKSegmentListAddLine(out, from, vertex);
+			DKSegmentListAddLine(out, vertex, to);
+		} else
+			DKSegmentListAddLine(out, from, to);
+		return;
+	}
+
+	switch (options->join) {
+	case kDKPathJoinMiter: {
+		// the miter is 1 / cos(half the turn) times the offset distance
+
+		double halfCos = sqrt((1.0 + dot) * 0.5);
+
+		if (!reversed && halfCos > kDKOffsetEpsilon && 1.0 / halfCos <= options->miterLimit) {
+			DKPathPoint tip = DKVecAdd(vertex, DKVecScale(DKVecAdd(DKVecNormal(tin), DKVecNormal(tout)), d / (1.0 + dot)));
+
+			DKSegmentListAddLine(out, from, tip);
+			DKSegmentListAddLine(out, tip, to);
+		} else
+			DKSegmentListAddLine(out, from, to);
+		break;
+	}
+
+	case kDKPathJoinRound: {
+		DKPathPoint u = DKVecSub(from, vertex), w = DKVecSub(to, vertex);
+		double sweep = atan2(fabs(DKVecCross(u, w)), DKVecDot(u, w));
+
+		// the outside of a corner is always on the right of a left offset, so the arc turns the opposite way to <d>
+
+		DKAppendArc(out, vertex, to, d > 0.0 ? -sweep : sweep);
+		break;
+	}
+
+	default:
+		DKSegmentListAddLine(out, from, to);
+		break;
+	}
+}
+
+static void DKOffsetSubpath(const DKSegmentList* source, bool closed, double d, const DKPathOffsetOptions* options, bool pivot, DKSegmentList* out)
+{
+	size_t k;
+
+	for (k = 0; k < source->count; ++k) {
+		const DKOffsetSegment* s = &source->items[k];
+
+		if (k > 0) {
+			DKPathPoint tout = DKSegmentStartTangent(s);
+			DKPathPoint to = DKVecAdd(s->p[0], DKVecScale(DKVecNormal(tout), d));
+
+			DKOffsetJoin(out, s->p[0], DKSegmentEndTangent(&source->items[k - 1]), tout, to, d, options, pivot);
+		}
+
+		DKOffsetSegmentAppend(s, d, options->tolerance, out);
+	}
+
+	if (closed && out->count > 0)
+		DKOffsetJoin(out, source->items[0].p[0], DKSegmentEndTangent(&source->items[source->count - 1]), DKSegmentStartTangent(&source->items[0]), out->items[0].p[0], d, options, pivot);
+}
+
+#pragma mark - distance from the original path
+
+// the original subpath flattened into short lines, filed by grid cell, for asking whether a point is nearer to it than some distance
+
+typedef struct {
+	uint64_t key;
+	uint32_t line;
+} DKGridEntry;
+
+// the most points of the original that one line of the grid can stand in for
+
+#define kDKGridMaxPending 64
+
+typedef struct {
+	DKPathPoint* points; // line i runs from points[i] to points[i + 1]
+	size_t pointCount;
+	size_t pointCapacity;
+	DKGridEntry* entries;
+	size_t entryCount;
+	double cellSize;
+	DKPathPoint pending[kDKGridMaxPending]; // points passed over while simplifying
+	size_t pendingCount;
+	double simplification;
+	bool failed;
+} DKDistanceGrid;
+
+static inline int64_t DKGridCoordinate(double v, double cellSize)
+{
+	double c = floor(v / cellSize);
+	return (int64_t)fmax(fmin(c, (double)INT32_MAX), (double)INT32_MIN);
+}
+
+// keys sort by column, then row, so the cells of a column can be scanned as one run
+
+static inline uint64_t DKGridKey(int64_t cx, int64_t cy)
+{
+	return ((uint64_t)(cx + INT32_MAX + 1) << 32) | (uint64_t)(cy + INT32_MAX + 1);
+}
+
+static void DKDistanceGridAddPoint(DKDistanceGrid* grid, DKPathPoint p)
+{
+	if (grid->pointCount >= grid->pointCapacity) {
+		size_t capacity = grid->pointCapacity < 64 ? 64 : grid->pointCapacity * 2;
+		DKPathPoint* points = realloc(grid->points, capacity * sizeof(DKPathPoint));
+
+		if (points == NULL) {
+			grid->failed = true;
+			return;
+		}
+
+		grid->points = points;
+		grid->pointCapacity = capacity;
+	}
+
+	grid->points[grid->pointCount++] = p;
+}
+
+// adds a line to <p>, broken into pieces no longer than a cell so that each piece touches at most four cells
+
+static void DKDistanceGridLineTo(DKDistanceGrid* grid, DKPathPoint p)
+{
+	DKPathPoint from = grid->points[grid->pointCount - 1];
+	double length = DKVecLength(DKVecSub(p, from));
+	size_t i, pieces = (size_t)ceil(length / grid->cellSize);
+
+	for (i = 1; i < pieces; ++i)
+		DKDistanceGridAddPoint(grid, DKVecAdd(from, DKVecScale(DKVecSub(p, from), (double)i / pieces)));
+
+	DKDistanceGridAddPoint(grid, p);
+}
+
+static inline double DKSquaredDistanceToLine(DKPathPoint p, DKPathPoint a, DKPathPoint b)
+{
+	DKPathPoint ab = DKVecSub(b, a), ap = DKVecSub(p, a);
+	double len2 = DKVecDot(ab, ab);
+	double t = len2 > 0.0 ? DKVecDot(ap, ab) / len2 : 0.0;
+
+	t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+
+	DKPathPoint diff = DKVecSub(ap, DKVecScale(ab, t));
+	return DKVecDot(diff, diff);
+}
+
+// adds a point of the original, merging runs of points that lie within the simplification distance of a single line. Dense polylines
+// otherwise fill each cell with many tiny lines, all of which a query has to measure.
+
+static void DKDistanceGridFeed(DKDistanceGrid* grid, DKPathPoint p)
+{
+	if (grid->pendingCount > 0) {
+		DKPathPoint anchor = grid->points[grid->pointCount - 1];
+		double limit = grid->simplification * grid->simplification;
+		bool fits = grid->pendingCount < kDKGridMaxPending;
+		size_t i;
+
+		for (i = 0; i < grid->pendingCount && fits; ++i)
+			fits = DKSquaredDistanceToLine(grid->pending[i], anchor, p) <= limit;
+
+		if (!fits) {
+			DKDistanceGridLineTo(grid, grid->pending[grid->pendingCount - 1]);
+			grid->pendingCount = 0;
+		}
+	}
+
+	grid->pending[grid->pendingCount++] = p;
+}
+
+static void DKDistanceGridFlush(DKDistanceGrid* grid)
+{
+	if (grid->pendingCount > 0) {
+		DKDistanceGridLineTo(grid, grid->pending[grid->pendingCount - 1]);
+		grid->pendingCount = 0;
+	}
+}
+
+static int DKGridEntryCompare(const void* a, const void* b)
+{
+	uint64_t ka = ((const DKGridEntry*)a)->key, kb = ((const DKGridEntry*)b)->key;
+	return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+static bool DKDistanceGridBuild(DKDistanceGrid* grid, const DKSegmentList* source, bool closed, double cellSize, double tolerance)
+{
+	size_t k, i;
+
+	memset(grid, 0, sizeof(DKDistanceGrid));
+	grid->cellSize = cellSize;
+	grid->simplification = tolerance;
+	DKDistanceGridAddPoint(grid, source->items[0].p[0]);
+
+	for (k = 0; k < source->count && !grid->failed; ++k) {
+		const DKOffsetSegment* s = &source->items[k];
+
+		if (s->line)
+			DKDistanceGridFeed(grid, s->p[3]);
+		else {
+			size_t steps = DKCubicFlatteningSteps(s->p, tolerance);
+
+			for (i = 1; i <= steps; ++i)
+				DKDistanceGridFeed(grid, i == steps ? s->p[3] : DKCubicPointAt(s->p, (double)i / steps));
+		}
+	}
+
+	if (closed)
+		DKDistanceGridFeed(grid, source->items[0].p[0]);
+
+	DKDistanceGridFlush(grid);
+
+	if (grid->failed || grid->pointCount < 2)
+		return !grid->failed;
+
+	size_t lineCount = grid->pointCount - 1;
+
+	grid->entries = malloc(lineCount * 4 * sizeof(DKGridEntry));
+
+	if (grid->entries == NULL) {
+		grid->failed = true;
+		return false;
+	}
+
+	for (i = 0; i < lineCount; ++i) {
+		DKPathPoint a = grid->points[i], b = grid->points[i + 1];
+		int64_t x0 = DKGridCoordinate(fmin(a.x, b.x), cellSize), x1 = DKGridCoordinate(fmax(a.x, b.x), cellSize);
+		int64_t y0 = DKGridCoordinate(fmin(a.y, b.y), cellSize), y1 = DKGridCoordinate(fmax(a.y, b.y), cellSize);
+		int64_t cx, cy;
+
+		for (cx = x0; cx <= x1 && cx <= x0 + 1; ++cx)
+			for (cy = y0; cy <= y1 && cy <= y0 + 1; ++cy) {
+				grid->entries[grid->entryCount].key = DKGridKey(cx, cy);
+				grid->entries[grid->entryCount].line = (uint32_t)i;
+				grid->entryCount++;
+			}
+	}
+
+	qsort(grid->entries, grid->entryCount, sizeof(DKGridEntry), DKGridEntryCompare);
+	return true;
+}
+
+static void DKDistanceGridFree(DKDistanceGrid* grid)
+{
+	free(grid->points);
+	free(grid->entries);
+}
+
+// whether any part of the flattened original is nearer to <p> than <radius>, which must be no more than half the cell size
+
+static bool DKDistanceGridIsNear(const DKDistanceGrid* grid, DKPathPoint p, double radius)
+{
+	int64_t x0 = DKGridCoordinate(p.x - radius, grid->cellSize), x1 = DKGridCoordinate(p.x + radius, grid->cellSize);
+	int64_t y0 = DKGridCoordinate(p.y - radius, grid->cellSize), y1 = DKGridCoordinate(p.y + radius, grid->cellSize);
+	double r2 = radius * radius;
+	int64_t cx;
+
+	for (cx = x0; cx <= x1; ++cx) {
+		uint64_t first = DKGridKey(cx, y0), last = DKGridKey(cx, y1);
+		size_t lo = 0, hi = grid->entryCount;
+
+		while (lo < hi) {
+			size_t mid = (lo + hi) / 2;
+
+			if (grid->entries[mid].key < first)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		for (; lo < grid->entryCount && grid->entries[lo].key <= last; ++lo) {
+			uint32_t line = grid->entries[lo].line;
+
+			if (DKSquaredDistanceToLine(p, grid->points[line], grid->points[line + 1]) < r2)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+#pragma mark - loop removal
+
+typedef struct {
+	double lo, hi; // along the sweep axis
+	double lo2, hi2; // across it
+	size_t index;
+} DKSweepBox;
+
+typedef struct {
+	double a, b; // positions along the offset path, as segment index + parameter, a < b
+} DKLoopHit;
+
+typedef struct {
+	DKLoopHit* items;
+	size_t count;
+	size_t capacity;
+	bool failed;
+} DKLoopHitList;
+
+static void DKLoopHitListAdd(DKLoopHitList* list, double a, double b)
+{
+	if (list->count >= list->capacity) {
+		size_t capacity = list->capacity < 16 ? 16 : list->capacity * 2;
+		DKLoopHit* items = realloc(list->items, capacity * sizeof(DKLoopHit));
+
+		if (items == NULL) {
+			list->failed = true;
+			return;
+		}
+
+		list->items = items;
+		list->capacity = capacity;
+	}
+
+	list->items[list->count].a = a;
+	list->items[list->count].b = b;
+	list->count++;
+}
+
+static int DKSweepBoxCompare(const void* a, const void* b)
+{
+	double la = ((const DKSweepBox*)a)->lo, lb = ((const DKSweepBox*)b)->lo;
+	return la < lb ? -1 : (la > lb ? 1 : 0);
+}
+
+static int DKLoopHitCompare(const void* a, const void* b)
+{
+	const DKLoopHit* ha = a;
+	const DKLoopHit* hb = b;
+
+	if (ha->a != hb->a)
+		return ha->a < hb->a ? -1 : 1;
+
+	return ha->b < hb->b ? -1 : (ha->b > hb->b ? 1 : 0);
+}
+
+static inline void DKCubicBounds(const DKPathPoint c[4], DKPathPoint* lo, DKPathPoint* hi)
+{
+	*lo = *hi = c[0];
+
+	for (int i = 1; i < 4; ++i) {
+		lo->x = fmin(lo->x, c[i].x);
+		lo->y = fmin(lo->y, c[i].y);
+		hi->x = fmax(hi->x, c[i].x);
+		hi->y = fmax(hi->y, c[i].y);
+	}
+}
+
+static inline bool DKCubicIsFlat(const DKPathPoint c[4], double flatness)
+{
+	DKPathPoint chord = DKVecSub(c[3], c[0]);
+	double len = DKVecLength(chord);
+
+	if (len <= kDKOffsetEpsilon)
+		return DKVecLength(DKVecSub(c[1], c[0])) <= flatness && DKVecLength(DKVecSub(c[2], c[0])) <= flatness;
+
+	return fabs(DKVecCross(chord, DKVecSub(c[1], c[0]))) / len <= flatness && fabs(DKVecCross(chord, DKVecSub(c[2], c[0]))) / len <= flatness;
+}
+
+static bool DKLineIntersection(DKPathPoint a0, DKPathPoint a1, DKPathPoint b0, DKPathPoint b1, double* ta, double* tb)
+{
+	DKPathPoint r = DKVecSub(a1, a0), s = DKVecSub(b1, b0);
+	double denominator = DKVecCross(r, s);
+
+	if (fabs(denominator) <= 1e-12 * (DKVecDot(r, r) + DKVecDot(s, s)))
+		return false;
+
+	DKPathPoint qp = DKVecSub(b0, a0);
+	double t = DKVecCross(qp, s) / denominator;
+	double u = DKVecCross(qp, r) / denominator;
+
+	if (t < -1e-12 || t > 1.0 + 1e-12 || u < -1e-12 || u > 1.0 + 1e-12)
+		return false;
+
+	*ta = fmin(fmax(t, 0.0), 1.0);
+	*tb = fmin(fmax(u, 0.0), 1.0);
+	return true;
+}
+
+typedef struct {
+	DKLoopHitList* hits;
+	double flatness;
+	size_t i, j;
+	bool adjacent; // j follows i
+	bool wraps; // i is the first segment and j the last of a closed path
+} DKIntersectionContext;
+
+static void DKRecordIntersection(DKIntersectionContext* ctx, double ti, double tj)
+{
+	// the shared end of neighbouring segments is not a crossing
+
+	if (ctx->adjacent && ti > 1.0 - 1e-6 && tj < 1e-6)
+		return;
+
+	if (ctx->wraps && ti < 1e-6 && tj > 1.0 - 1e-6)
+		return;
+
+	DKLoopHitListAdd(ctx->hits, ctx->i + ti, ctx->j + tj);
+}
+
+static void DKIntersectCubics(DKIntersectionContext* ctx, const DKPathPoint a[4], double a0, double a1, const DKPathPoint b[4], double b0, double b1, int depth)
+{
+	DKPathPoint aLo, aHi, bLo, bHi;
+
+	DKCubicBounds(a, &aLo, &aHi);
+	DKCubicBounds(b, &bLo, &bHi);
+
+	if (aHi.x < bLo.x || bHi.x < aLo.x || aHi.y < bLo.y || bHi.y < aLo.y)
+		return;
+
+	bool aFlat = DKCubicIsFlat(a, ctx->flatness);
+	bool bFlat = DKCubicIsFlat(b, ctx->flatness);
+
+	if ((aFlat && bFlat) || depth >= 48) {
+		double ta, tb;
+
+		if (DKLineIntersection(a[0], a[3], b[0], b[3], &ta, &tb))
+			DKRecordIntersection(ctx, a0 + (a1 - a0) * ta, b0 + (b1 - b0) * tb);
+		return;
+	}
+
+	DKPathPoint left[4], right[4];
+
+	// split whichever is larger
+
+	if (!aFlat && (bFlat || (aHi.x - aLo.x) + (aHi.y - aLo.y) >= (bHi.x - bLo.x) + (bHi.y - bLo.y))) {
+		double am = (a0 + a1) * 0.5;
+
+		DKCubicSplit(a, 0.5, left, right);
+		DKIntersectCubics(ctx, left, a0, am, b, b0, b1, depth + 1);
+		DKIntersectCubics(ctx, right, am, a1, b, b0, b1, depth + 1);
+	} else {
+		double bm = (b0 + b1) * 0.5;
+
+		DKCubicSplit(b, 0.5, left, right);
+		DKIntersectCubics(ctx, a, a0, a1, left, b0, bm, depth + 1);
+		DKIntersectCubics(ctx, a, a0, a1, right, bm, b1, depth + 1);
+	}
+}
+
+static void DKIntersectSegments(const DKSegmentList* list, size_t i, size_t j, bool closed, double flatness, DKLoopHitList* hits)
+{
+	const DKOffsetSegment* si = &list->items[i];
+	const DKOffsetSegment* sj = &list->items[j];
+	DKIntersectionContext ctx = { hits, flatness, i, j, j == i + 1, closed && i == 0 && j == list->count - 1 };
+
+	if (si->line && sj->line) {
+		double ti, tj;
+
+		if (DKLineIntersection(si->p[0], si->p[3], sj->p[0], sj->p[3], &ti, &tj))
+			DKRecordIntersection(&ctx, ti, tj);
+	} else
+		DKIntersectCubics(&ctx, si->p, 0.0, 1.0, sj->p, 0.0, 1.0, 0);
+}
+
+// finds every crossing between two segments of <list> by sweeping their bounds along the longer axis of the whole
+
+static bool DKFindSelfIntersections(const DKSegmentList* list, bool closed, double flatness, DKLoopHitList* hits)
+{
+	size_t n = list->count, k, m;
+	DKSweepBox* boxes = malloc(n * sizeof(DKSweepBox));
+	size_t* active = malloc(n * sizeof(size_t));
+
+	if (boxes == NULL || active == NULL) {
+		free(boxes);
+		free(active);
+		return false;
+	}
+
+	DKPathPoint allLo = list->items[0].p[0], allHi = allLo;
+
+	for (k = 0; k < n; ++k) {
+		DKPathPoint lo, hi;
+
+		DKCubicBounds(list->items[k].p, &lo, &hi);
+		boxes[k].lo = lo.x;
+		boxes[k].hi = hi.x;
+		boxes[k].lo2 = lo.y;
+		boxes[k].hi2 = hi.y;
+		boxes[k].index = k;
+		allLo.x = fmin(allLo.x, lo.x);
+		allLo.y = fmin(allLo.y, lo.y);
+		allHi.x = fmax(allHi.x, hi.x);
+		allHi.y = fmax(allHi.y, hi.y);
+	}
+
+	if (allHi.y - allLo.y > allHi.x - allLo.x) {
+		for (k = 0; k < n; ++k) {
+			double lo = boxes[k].lo, hi = boxes[k].hi;
+
+			boxes[k].lo = boxes[k].lo2;
+			boxes[k].hi = boxes[k].hi2;
+			boxes[k].lo2 = lo;
+			boxes[k].hi2 = hi;
+		}
+	}
+
+	qsort(boxes, n, sizeof(DKSweepBox), DKSweepBoxCompare);
+
+	size_t activeCount = 0;
+
+	for (k = 0; k < n && !hits->failed; ++k) {
+		const DKSweepBox* box = &boxes[k];
+		size_t kept = 0;
+
+		for (m = 0; m < activeCount; ++m) {
+			const DKSweepBox* other = &boxes[active[m]];
+
+			if (other->hi < box->lo)
+				continue;
+
+			active[kept++] = active[m];
+
+			if (other->hi2 >= box->lo2 && box->hi2 >= other->lo2) {
+				size_t i = other->index, j = box->index;
+
+				if (i != j)
+					DKIntersectSegments(list, i < j ? i : j, i < j ? j : i, closed, flatness, hits);
+			}
+		}
+
+		activeCount = kept;
+		active[activeCount++] = k;
+	}
+
+	free(boxes);
+	free(active);
+	return !hits->failed;
+}
+
+// the point at a position along a list of segments, as segment index + parameter. Positions past the end wrap round to the start.
+
+static DKPathPoint DKSegmentListPointAt(const DKSegmentList* list, double position)
+{
+	if (position >= (double)list->count)
+		position -= (double)list->count;
+
+	size_t k = position <= 0.0 ? 0 : (size_t)floor(position);
+
+	if (k >= list->count)
+		k = list->count - 1;
+
+	return DKCubicPointAt(list->items[k].p, fmin(position - k, 1.0));
+}
+
+// finds where segment <k> crosses the edge of the zone nearer the original than the offset, between parameter <near> inside it and <far>
+// outside
+
+static double DKZoneExit(const DKSegmentList* list, const DKDistanceGrid* grid, double radius, size_t k, double near, double far)
+{
+	int i;
+
+	for (i = 0; i < 24; ++i) {
+		double t = (near + far) * 0.5;
+
+		if (DKDistanceGridIsNear(grid, DKCubicPointAt(list->items[k].p, t), radius))
+			near = t;
+		else
+			far = t;
+	}
+
+	return far;
+}
+
+// one end of a crossing: where one of the two stretches that cross there passes through it
+
+typedef struct {
+	double position;
+	size_t partner; // the end on the other stretch, by index once the ends are sorted, or SIZE_MAX where an open path enters or leaves the zone
+	size_t original; // the index before sorting
+} DKCrossingEnd;
+
+static int DKCrossingEndCompare(const void* a, const void* b)
+{
+	double pa = ((const DKCrossingEnd*)a)->position, pb = ((const DKCrossingEnd*)b)->position;
+	return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+// an open path can enter or leave the zone nearer the original without crossing itself: where the offset of a tight bend at one end
+// folds back over the original, before the first crossing or after the last, and where the offset passes round either end of the
+// original. Each such place cuts the offset as a crossing does, but has no other stretch to turn onto. Only those stretches are
+// searched, as elsewhere the offset enters the zone only where it crosses itself or grazes it at a bend about as tight as the offset.
+// Entering a loop happens a little way past the crossing, so places within a few tolerances of one of the <count> crossing ends in
+// <ends>, which must be sorted, are left to the crossing. Returns the number of cuts added to <ends> after them, which has room for
+// kDKZoneSamples per segment.
+
+#define kDKZoneSamples 8
+
+static size_t DKAddZoneCuts(const DKSegmentList* list, const DKSegmentList* source, const DKDistanceGrid* grid, double radius, double tolerance, DKCrossingEnd* ends, size_t count)
+{
+	DKPathPoint sourceEnds[2] = { source->items[0].p[0], DKSegmentListEnd(source) };
+	double firstCrossing = count > 0 ? ends[0].position : (double)list->count;
+	double lastCrossing = count > 0 ? ends[count - 1].position : 0.0;
+	double reach = radius + 4.0 * tolerance;
+	size_t k, added = 0;
+	bool wasNear = false, searching = false;
+
+	for (k = 0; k < list->count; ++k) {
+		DKPathPoint segLo, segHi;
+		int i, e;
+		bool search = k < firstCrossing || k + 1 > lastCrossing;
+
+		DKCubicBounds(list->items[k].p, &segLo, &segHi);
+
+		for (e = 0; e < 2 && !search; ++e) {
+			double dx = fmax(fmax(segLo.x - sourceEnds[e].x, sourceEnds[e].x - segHi.x), 0.0);
+			double dy = fmax(fmax(segLo.y - sourceEnds[e].y, sourceEnds[e].y - segHi.y), 0.0);
+
+			search = dx * dx + dy * dy < reach * reach;
+		}
+
+		if (!search) {
+			searching = false;
+			continue;
+		}
+
+		if (!searching)
+			wasNear = DKDistanceGridIsNear(grid, list->items[k].p[0], radius);
+
+		searching = true;
+
+		for (i = 1; i <= kDKZoneSamples; ++i) {
+			double t0 = (double)(i - 1) / kDKZoneSamples, t1 = (double)i / kDKZoneSamples;
+			bool isNear = DKDistanceGridIsNear(grid, DKCubicPointAt(list->items[k].p, t1), radius);
+
+			if (isNear == wasNear)
+				continue;
+
+			double position = k + (wasNear ? DKZoneExit(list, grid, radius, k, t0, t1) : DKZoneExit(list, grid, radius, k, t1, t0));
+			DKPathPoint p = DKSegmentListPointAt(list, position);
+			size_t lo = 0, hi = count;
+
+			wasNear = isNear;
+
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+
+				if (ends[mid].position < position)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+
+			if (lo < count && DKVecLength(DKVecSub(DKSegmentListPointAt(list, ends[lo].position), p)) <= 4.0 * tolerance)
+				continue;
+
+			if (lo > 0 && DKVecLength(DKVecSub(DKSegmentListPointAt(list, ends[lo - 1].position), p)) <= 4.0 * tolerance)
+				continue;
+
+			ends[count + added] = (DKCrossingEnd){ position, SIZE_MAX, count + added };
+			++added;
+		}
+	}
+
+	return added;
+}
+
+// the stretch of the offset between one crossing and the next
+
+typedef struct {
+	double from, to; // positions along the offset. <to> is past the end of a closed path for the piece that wraps round its start.
+	size_t next; // the kept piece that the path carries on along from the end of this one, or SIZE_MAX
+	bool kept; // whether the piece is no nearer the original than the offset
+	bool reached; // whether another kept piece carries on along this one
+	bool emitted;
+} DKOffsetPiece;
+
+static bool DKOffsetPieceIsKept(const DKSegmentList* list, const DKDistanceGrid* grid, double radius, double from, double to)
+{
+	double near = 0.0, far = 0.0, at = from;
+	int samples = to - from < 3.0 ? 3 : 1;
+
+	// a piece lies wholly on one side of the zone nearer the original, so most of its length settles it, even if a crossing grazed too
+	// closely to be found leaves a little of it on the wrong side. Length rather than parameter counts, as the corner of a tight inset
+	// is made of many tiny segments that lie just outside the zone beside the long one that doubles back through it. Each segment is
+	// tried at its middle, or at its quarters if the piece spans few of them.
+
+	while (at < to) {
+		double next = fmin(floor(at) + 1.0, to);
+		DKPathPoint start = DKSegmentListPointAt(list, at);
+		DKPathPoint finish = DKSegmentListPointAt(list, next);
+		double weight = hypot(finish.x - start.x, finish.y - start.y) + 1e-9;
+		int i;
+
+		for (i = 1; i <= samples; ++i) {
+			if (DKDistanceGridIsNear(grid, DKSegmentListPointAt(list, at + (next - at) * i / (samples + 1.0)), radius))
+				near += weight;
+			else
+				far += weight;
+		}
+
+		at = next;
+	}
+
+	return far > near;
+}
+
+// whether no part of a piece is nearer the original than <radius>, tried at the quarters of each segment
+
+static bool DKOffsetPieceIsShallow(const DKSegmentList* list, const DKDistanceGrid* grid, double radius, double from, double to)
+{
+	double at = from;
+
+	if (radius <= 0.0)
+		return true;
+
+	while (at < to) {
+		double next = fmin(floor(at) + 1.0, to);
+		int i;
+
+		for (i = 1; i <= 3; ++i) {
+			if (DKDistanceGridIsNear(grid, DKSegmentListPointAt(list, at + (next - at) * i * 0.25), radius))
+				return false;
+		}
+
+		at = next;
+	}
+
+	return true;
+}
+
+static void DKEmitRange(const DKSegmentList* list, double from, double to, DKPathBuffer* result, bool* started)
+{
+	size_t k, first = (size_t)floor(from), last = (size_t)ceil(to);
+
+	if (last > list->count)
+		last = list->count;
+
+	for (k = first; k < last; ++k) {
+		double t0 = k == first ? from - k : 0.0;
+		double t1 = (double)(k + 1) > to ? to - k : 1.0;
+		const DKOffsetSegment* s = &list->items[k];
+		DKPathPoint c[4];
+
+		if (t1 - t0 <= 1e-12)
+			continue;
+
+		DKCubicSubsegment(s->p, t0, t1, c);
+
+		if (!*started) {
+			DKPathBufferMoveTo(result, c[0]);
+			*started = true;
+		}
+
+		if (s->line)
+			DKPathBufferLineTo(result, c[3]);
+		else
+			DKPathBufferCurveTo(result, c[1], c[2], c[3]);
+	}
+}
+
+// gets the area a closed list of segments encloses, positive where it runs anticlockwise with y up, and the length of its control polygon,
+// which is at least the length of the segments
+
+static void DKSegmentListMeasure(const DKSegmentList* list, double* area, double* length)
+{
+	size_t k;
+
+	*area = 0.0;
+	*length = 0.0;
+
+	for (k = 0; k < list->count; ++k) {
+		const DKPathPoint* p = list->items[k].p;
+
+		*area += (6.0 * DKVecCross(p[0], p[1]) + 3.0 * DKVecCross(p[0], p[2]) + DKVecCross(p[0], p[3]) + 3.0 * DKVecCross(p[1], p[2])
+					 + 3.0 * DKVecCross(p[1], p[3]) + 6.0 * DKVecCross(p[2], p[3]))
+			/ 20.0;
+		*length += DKVecLength(DKVecSub(p[1], p[0])) + DKVecLength(DKVecSub(p[2], p[1])) + DKVecLength(DKVecSub(p[3], p[2]));
+	}
+
+	if (list->count > 0)
+		*area += DKVecCross(list->items[list->count - 1].p[3], list->items[0].p[0]) * 0.5;
+}
+
+// whether the closed subpath appended to <result> from verb <verb> and point <point> on is a true part of the offset <d> of <source>. It
+// isn't if it is thinner than the tolerance everywhere, so that its area is no more than its length times the tolerance, or if it is part
+// of an inset and runs the other way round from the source. An outset can enclose holes that run the other way, where parts of the
+// source come close together, and a source that encloses no area, such as a figure of eight, has no way round, so neither is tested for
+// that.
+
+static bool DKEmittedLoopIsTrue(const DKPathBuffer* result, size_t verb, size_t point, const DKSegmentList* source, double d, double tolerance)
+{
+	DKPathBuffer emitted = *result;
+	double sourceArea, sourceLength, length = 0.0;
+	size_t k;
+
+	emitted.verbs += verb;
+	emitted.verbCount -= verb;
+	emitted.points += point;
+	emitted.pointCount -= point;
+
+	double area = DKPathBufferSignedArea(&emitted);
+
+	for (k = 1; k < emitted.pointCount; ++k)
+		length += DKVecLength(DKVecSub(emitted.points[k], emitted.points[k - 1]));
+
+	if (emitted.pointCount > 1)
+		length += DKVecLength(DKVecSub(emitted.points[0], emitted.points[emitted.pointCount - 1]));
+
+	if (fabs(area) <= length * tolerance)
+		return false;
+
+	DKSegmentListMeasure(source, &sourceArea, &sourceLength);
+
+	// positive offsets are to the left, which is inside a source running anticlockwise
+
+	if (fabs(sourceArea) > sourceLength * tolerance && (d > 0.0) == (sourceArea > 0.0) && (area > 0.0) != (sourceArea > 0.0))
+		return false;
+
+	return true;
+}
+
+// writes <list> to <result>, leaving out the loops that come nearer to the original path than <d>
+
+static void DKEmitWithoutLoops(DKSegmentList* list, bool closed, const DKSegmentList* source, double d, double tolerance, DKPathBuffer* result)
+{
+	double distance = fabs(d);
+	double radius = distance - fmin(tolerance, 0.5 * distance);
+	DKDistanceGrid grid;
+	size_t k, start = 0;
+
+	// cells twice the offset keep each query to at most four cells; a floor on the size keeps small offsets of large paths from
+	// needing a vast number of them
+
+	DKPathPoint lo, hi, segLo, segHi;
+
+	DKCubicBounds(source->items[0].p, &lo, &hi);
+
+	for (k = 1; k < source->count; ++k) {
+		DKCubicBounds(source->items[k].p, &segLo, &segHi);
+		lo.x = fmin(lo.x, segLo.x);
+		lo.y = fmin(lo.y, segLo.y);
+		hi.x = fmax(hi.x, segHi.x);
+		hi.y = fmax(hi.y, segHi.y);
+	}
+
+	double cellSize = fmax(2.0 * distance, fmax(hi.x - lo.x, hi.y - lo.y) / 4096.0);
+
+	if (!DKDistanceGridBuild(&grid, source, closed, cellSize, tolerance * 0.25)) {
+		DKDistanceGridFree(&grid);
+		result->failed = true;
+		return;
+	}
+
+	// a closed path is walked from a point known to be kept where there is one, so that its first piece is whole. The ends of segments
+	// are often at inside corners, so their middles are tried too. A deep inset can keep only a stretch that falls between them, so
+	// finding none is left for the pieces to settle.
+
+	if (closed) {
+		bool split = false;
+
+		for (start = 0; start < list->count; ++start) {
+			if (!DKDistanceGridIsNear(&grid, list->items[start].p[0], radius))
+				break;
+
+			if (!DKDistanceGridIsNear(&grid, DKCubicPointAt(list->items[start].p, 0.5), radius)) {
+				split = true;
+				break;
+			}
+		}
+
+		if (start == list->count)
+			start = 0;
+
+		// rotate the list to begin there, splitting the segment if the start is half way along it
+
+		size_t count = list->count + (split ? 1 : 0);
+		DKOffsetSegment* rotated = malloc(count * sizeof(DKOffsetSegment));
+		size_t tail = list->count - start;
+
+		if (rotated == NULL) {
+			DKDistanceGridFree(&grid);
+			result->failed = true;
+			return;
+		}
+
+		memcpy(rotated, list->items + start, tail * sizeof(DKOffsetSegment));
+		memcpy(rotated + tail, list->items, start * sizeof(DKOffsetSegment));
+
+		if (split) {
+			rotated[count - 1] = rotated[0];
+			DKCubicSplit(list->items[start].p, 0.5, rotated[count - 1].p, rotated[0].p);
+		}
+
+		free(list->items);
+		list->items = rotated;
+		list->count = list->capacity = count;
+	}
+
+	DKLoopHitList hits = { NULL, 0, 0, false };
+
+	if (!DKFindSelfIntersections(list, closed, tolerance * 0.01, &hits)) {
+		free(hits.items);
+		DKDistanceGridFree(&grid);
+		result->failed = true;
+		return;
+	}
+
+	// the crossings cut the offset into pieces, each of which lies wholly nearer the original than the offset or wholly not. The near pieces
+	// are dropped, and what is left is joined up again at the crossings, turning onto the other stretch wherever the one being followed
+	// was dropped. The result is a subpath for each part of the offset, so an inset that splits a shape in two keeps both halves.
+
+	double end = (double)list->count;
+	size_t capacity = 2 * hits.count + (closed ? 0 : kDKZoneSamples * list->count) + 1;
+	DKCrossingEnd* ends = malloc(capacity * sizeof(DKCrossingEnd));
+	size_t* ranks = malloc(capacity * sizeof(size_t));
+	DKOffsetPiece* pieces = malloc(capacity * sizeof(DKOffsetPiece));
+	size_t endCount = 0, pieceCount, j;
+	const DKLoopHit* last = NULL;
+
+	if (ends == NULL || ranks == NULL || pieces == NULL) {
+		free(ends);
+		free(ranks);
+		free(pieces);
+		free(hits.items);
+		DKDistanceGridFree(&grid);
+		result->failed = true;
+		return;
+	}
+
+	if (hits.count > 1)
+		qsort(hits.items, hits.count, sizeof(DKLoopHit), DKLoopHitCompare);
+
+	for (k = 0; k < hits.count; ++k) {
+		const DKLoopHit* hit = &hits.items[k];
+
+		// a crossing on the end of a segment can be found from both segments that share it
+
+		if (hit->b - hit->a <= kDKOffsetParameterEpsilon)
+			continue;
+
+		if (last && hit->a - last->a <= kDKOffsetParameterEpsilon && fabs(hit->b - last->b) <= kDKOffsetParameterEpsilon)
+			continue;
+
+		ends[endCount] = (DKCrossingEnd){ hit->a, endCount + 1, endCount };
+		ends[endCount + 1] = (DKCrossingEnd){ hit->b, endCount, endCount + 1 };
+		endCount += 2;
+		last = hit;
+	}
+
+	qsort(ends, endCount, sizeof(DKCrossingEnd), DKCrossingEndCompare);
+
+	if (!closed) {
+		endCount += DKAddZoneCuts(list, source, &grid, radius, tolerance, ends, endCount);
+		qsort(ends, endCount, sizeof(DKCrossingEnd), DKCrossingEndCompare);
+	}
+
+	for (k = 0; k < endCount; ++k)
+		ranks[ends[k].original] = k;
+
+	for (k = 0; k < endCount; ++k) {
+		if (ends[k].partner != SIZE_MAX)
+			ends[k].partner = ranks[ends[k].partner];
+	}
+
+	// piece <j> of a closed path begins at end <j>, and the last wraps round to the first end; piece <j> of an open path ends at end <j>
+
+	if (closed) {
+		pieceCount = endCount > 0 ? endCount : 1;
+
+		for (j = 0; j < pieceCount; ++j) {
+			pieces[j].from = endCount > 0 ? ends[j].position : 0.0;
+			pieces[j].to = j + 1 < endCount ? ends[j + 1].position : (endCount > 0 ? ends[0].position : 0.0) + end;
+		}
+	} else {
+		pieceCount = endCount + 1;
+
+		for (j = 0; j < pieceCount; ++j) {
+			pieces[j].from = j == 0 ? 0.0 : ends[j - 1].position;
+			pieces[j].to = j == endCount ? end : ends[j].position;
+		}
+	}
+
+	for (j = 0; j < pieceCount; ++j) {
+		pieces[j].kept = pieces[j].to > pieces[j].from && DKOffsetPieceIsKept(list, &grid, radius, pieces[j].from, pieces[j].to);
+		pieces[j].reached = pieces[j].emitted = false;
+		pieces[j].next = SIZE_MAX;
+
+		// an open path that only grazes the zone, at a bend about as tight as the offset, is better kept whole than left with a gap
+
+		if (!closed && !pieces[j].kept && j > 0 && j < endCount && ends[j - 1].partner == SIZE_MAX && ends[j].partner == SIZE_MAX)
+			pieces[j].kept = DKOffsetPieceIsShallow(list, &grid, radius - 2.0 * tolerance, pieces[j].from, pieces[j].to);
+	}
+
+	for (j = 0; j < pieceCount; ++j) {
+		if (!pieces[j].kept || endCount == 0) {
+			if (pieces[j].kept && closed)
+				pieces[j].next = j;
+			continue;
+		}
+
+		if (!closed && j == endCount)
+			continue;
+
+		// at the crossing the piece ends at, the path carries straight on unless the other stretch arrives dropped and leaves kept, as
+		// where a loop has been cut out
+
+		size_t e = closed ? (j + 1) % pieceCount : j;
+		size_t other = ends[e].partner;
+		size_t straight = closed ? e : e + 1;
+
+		if (other == SIZE_MAX) {
+			if (pieces[straight].kept) {
+				pieces[j].next = straight;
+				pieces[straight].reached = true;
+			}
+			continue;
+		}
+
+		size_t turn = closed ? other : other + 1;
+		size_t arriving = closed ? (other + pieceCount - 1) % pieceCount : other;
+
+		if (pieces[turn].kept && !pieces[arriving].kept)
+			pieces[j].next = turn;
+		else if (pieces[straight].kept)
+			pieces[j].next = straight;
+		else if (pieces[turn].kept)
+			pieces[j].next = turn;
+
+		if (pieces[j].next != SIZE_MAX)
+			pieces[pieces[j].next].reached = true;
+	}
+
+	// runs that begin at the start of an open path, or after a dropped piece, are written first, then whatever closes on itself
+
+	int pass;
+
+	for (pass = 0; pass < 2; ++pass) {
+		for (j = 0; j < pieceCount; ++j) {
+			if (!pieces[j].kept || pieces[j].emitted || (pass == 0 && pieces[j].reached))
+				continue;
+
+			bool started = false;
+			size_t verbMark = result->verbCount, pointMark = result->pointCount;
+
+			for (k = j; k != SIZE_MAX && !pieces[k].emitted; k = pieces[k].next) {
+				pieces[k].emitted = true;
+				DKEmitRange(list, pieces[k].from, fmin(pieces[k].to, end), result, &started);
+
+				if (pieces[k].to > end)
+					DKEmitRange(list, 0.0, pieces[k].to - end, result, &started);
+			}
+
+			if (started && (closed || pass == 1)) {
+				DKPathBufferClose(result);
+
+				// an inset of about half a shape's width can leave a sliver, or a scrap of the corners' loops running the wrong way round,
+				// which isn't part of the offset at all
+
+				if (!result->failed && !DKEmittedLoopIsTrue(result, verbMark, pointMark, source, d, tolerance)) {
+					result->verbCount = verbMark;
+					result->pointCount = pointMark;
+				}
+			}
+		}
+	}
+
+	free(ends);
+	free(ranks);
+	free(pieces);
+	free(hits.items);
+	DKDistanceGridFree(&grid);
+}
+
+static void DKEmitSegments(const DKSegmentList* list, bool closed, DKPathBuffer* result)
+{
+	bool started = false;
+
+	DKEmitRange(list, 0.0, (double)list->count, result, &started);
+
+	if (closed && started)
+		DKPathBufferClose(result);
+}
+
+#pragma mark -
+
+// reads the subpath of <path> that starts at verb <*verb> and point <*point> into <source>, leaving out elements of no length, and moves
+// both indexes on to the next subpath. <start> carries the start of the subpath over to the next, which begins there if it has no move.
+
+static bool DKReadSubpath(const DKPathBuffer* path, size_t* verb, size_t* point, DKPathPoint* start, DKSegmentList* source)
+{
+	DKPathPoint current = *start;
+	size_t v = *verb, pi = *point;
+	bool closed = false;
+
+	source->count = 0;
+
+	if (v < path->verbCount && path->verbs[v] == kDKPathMoveTo) {
+		*start = current = path->points[pi++];
+		++v;
+	}
+
+	for (; v < path->verbCount && !closed; ++v) {
+		const DKPathPoint* pp = path->points + pi;
+
+		switch (path->verbs[v]) {
+		case kDKPathMoveTo:
+			*verb = v;
+			*point = pi;
+			return false;
+
+		case kDKPathLineTo:
+			if (DKVecLength(DKVecSub(pp[0], current)) > kDKOffsetEpsilon)
+				DKSegmentListAddLine(source, current, pp[0]);
+			current = pp[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, pp[0], pp[1], pp[2] };
+
+			if (DKVecLength(DKVecSub(c[1], c[0])) > kDKOffsetEpsilon || DKVecLength(DKVecSub(c[2], c[0])) > kDKOffsetEpsilon || DKVecLength(DKVecSub(c[3], c[0])) > kDKOffsetEpsilon)
+				DKSegmentListAddCurve(source, c);
+			current = pp[2];
+			break;
+		}
+
+		case kDKPathClose:
+			if (DKVecLength(DKVecSub(*start, current)) > kDKOffsetEpsilon)
+				DKSegmentListAddLine(source, current, *start);
+			closed = true;
+			break;
+		}
+
+		pi += DKPathVerbPointCount(path->verbs[v]);
+	}
+
+	*verb = v;
+	*point = pi;
+	return closed;
+}
+
+static DKPathOffsetOptions DKValidOptions(const DKPathOffsetOptions* options)
+{
+	DKPathOffsetOptions opts = options ? *options : DKPathOffsetDefaultOptions();
+
+	if (!(opts.tolerance > 0.0))
+		opts.tolerance = 0.1;
+
+	if (opts.miterLimit < 1.0)
+		opts.miterLimit = 1.0;
+
+	return opts;
+}
+
+bool DKPathOffset(const DKPathBuffer* path, double offset, const DKPathOffsetOptions* options, DKPathBuffer* result)
+{
+	DKPathOffsetOptions opts = DKValidOptions(options);
+
+	if (offset == 0.0 || !isfinite(offset)) {
+		DKPathBufferAppend(result, path);
+		return !result->failed;
+	}
+
+	DKSegmentList source = { NULL, 0, 0, false };
+	DKSegmentList scratch = { NULL, 0, 0, false };
+	DKPathPoint start = { 0, 0 };
+	size_t v = 0, pi = 0;
+
+	while (v < path->verbCount && !result->failed) {
+		bool closed = DKReadSubpath(path, &v, &pi, &start, &source);
+
+		if (source.failed) {
+			result->failed = true;
+			break;
+		}
+
+		if (source.count == 0)
+			continue;
+
+		scratch.count = 0;
+		DKOffsetSubpath(&source, closed, offset, &opts, false, &scratch);
+
+		if (scratch.failed)
+			result->failed = true;
+		else if (opts.removeLoops && scratch.count > 1)
+			DKEmitWithoutLoops(&scratch, closed, &source, offset, opts.tolerance, result);
+		else
+			DKEmitSegments(&scratch, closed, result);
+	}
+
+	free(source.items);
+	free(scratch.items);
+	return !result->failed;
+}
+
+bool DKPathOffsetStrokeSide(const DKPathBuffer* path, double offset, const DKPathOffsetOptions* options, DKPathBuffer* result)
+{
+	DKPathOffsetOptions opts = DKValidOptions(options);
+	DKSegmentList source = { NULL, 0, 0, false };
+	DKSegmentList side = { NULL, 0, 0, false };
+	DKPathPoint start = { 0, 0 };
+	size_t v = 0, pi = 0;
+	bool closed = DKReadSubpath(path, &v, &pi, &start, &source);
+
+	if (source.failed)
+		result->failed = true;
+	else if (source.count > 0) {
+		DKOffsetSubpath(&source, closed, offset, &opts, true, &side);
+
+		if (side.failed)
+			result->failed = true;
+		else
+			DKEmitSegments(&side, closed, result);
+	}
+
+	free(source.items);
+	free(side.items);
+	return !result->failed;
+}
@@ -0,0 +1,70 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKPathOffset_h
+#define DKPathOffset_h
+
+#include "DKPathBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief How the offsets of two segments are joined on the outside of a corner. The values match NSLineJoinStyle. */
+typedef enum {
+	kDKPathJoinMiter = 0,
+	kDKPathJoinRound = 1,
+	kDKPathJoinBevel = 2
+} DKPathJoin;
+
+/** @brief Options for DKPathOffset(). */
+typedef struct {
+	double tolerance; ///< the greatest distance the result may stray from the true offset. Must be > 0.
+	DKPathJoin join; ///< the join used on the outside of corners
+	double miterLimit; ///< the longest miter allowed, as a multiple of the offset distance, before a bevel is used instead
+	bool removeLoops; ///< whether to cut out the loops left where the offset is larger than a curve's radius or crosses itself at an inside corner
+} DKPathOffsetOptions;
+
+/** @brief Returns options with a tolerance of 0.1, miter joins with a limit of 10, and loop removal. */
+DKPathOffsetOptions DKPathOffsetDefaultOptions(void);
+
+/** @brief Offsets every subpath of a path by a fixed distance along its normal.
+
+ Each curve is approximated by cubics that meet the true offset at their ends with the same tangent, and that pass through it at their
+ middle. Where the approximation strays further than the tolerance the curve is split and each half offset again. Lines are offset
+ exactly. The outside of each corner is filled with the chosen join; the inside is simply connected, leaving a small loop.
+
+ The result is then cut where it crosses itself, found with one sweep over the bounds of its segments. Pieces that lie nearer the original
+ path than the offset distance are dropped and the rest joined up again at the crossings, so loops that are a true part of the offset,
+ such as where two distant parts of the path come together, are kept.
+
+ Positive distances offset to the left of the direction of travel, which is below or to the right in DrawKit's flipped views.
+ @param path the path to offset
+ @param offset the distance
+ @param options the options, or NULL for the defaults
+ @param result a buffer the offset path is appended to
+ @return false if memory ran out
+ */
+bool DKPathOffset(const DKPathBuffer* path, double offset, const DKPathOffsetOptions* options, DKPathBuffer* result);
+
+/** @brief Offsets the first subpath of a path as one side of a stroke.
+
+ Unlike DKPathOffset(), loops are kept and the inside of each corner is connected by way of the corner itself, so that an outline made
+ from the two sides of a subpath fills the whole stroke under the nonzero winding rule. The offset is appended to <result> as a new
+ subpath, closed if the original was.
+ @param path the path whose first subpath is offset
+ @param offset the distance
+ @param options the options, or NULL for the defaults. <removeLoops> is ignored.
+ @param result a buffer the offset is appended to. Nothing is appended if the subpath has no length.
+ @return false if memory ran out
+ */
+bool DKPathOffsetStrokeSide(const DKPathBuffer* path, double offset, const DKPathOffsetOptions* options, DKPathBuffer* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKPathOffset_h */
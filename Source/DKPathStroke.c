@@ -0,0 +1,524 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKPathStroke.h"
+#include "DKPathMeasure.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the handle length of a quarter circle of unit radius
+
+#define kDKQuarterCircleHandle 0.5522847498307936
+
+DKPathStrokeStyle DKPathStrokeDefaultStyle(void)
+{
+	DKPathStrokeStyle style = { 1.0, kDKPathCapButt, kDKPathJoinMiter, 10.0, NULL, 0, 0.0, 0.1 };
+	return style;
+}
+
+#pragma mark - dashing
+
+bool DKPathDash(const DKPathBuffer* path, const double* pattern, size_t count, double phase, double tolerance, DKPathBuffer* result)
+{
+	if (!(DKPathDashPatternLength(pattern, count) > 0.0) || !isfinite(phase)) {
+		DKPathBufferAppend(result, path);
+		return !result->failed;
+	}
+
+	DKPathMeasure measure;
+	bool ok;
+
+	DKPathMeasureInit(&measure);
+	ok = DKPathMeasureSetPath(&measure, path, tolerance) && DKPathMeasureDash(&measure, pattern, count, phase, result);
+	DKPathMeasureFree(&measure);
+
+	return ok;
+}
+
+#pragma mark - outlines
+
+typedef struct {
+	DKPathStrokeStyle style;
+	DKPathOffsetOptions options;
+	DKPathBuffer subpath;
+	DKPathBuffer reversed;
+	DKPathBuffer side;
+	DKPathBuffer outline;
+	DKPathBuffer run;
+	DKPathBuffer inset; // the inside of a closed subpath, found to tell whether a wide stroke has closed up its hole
+	size_t* offsets; // where each segment of <subpath> starts in its points
+	size_t offsetCapacity;
+	const DKPathPoint* near; // if not NULL, only pieces that might contain this point are outlined
+	double margin; // how far the outline may lie from the control points of its piece
+	DKPathStrokeOutlineFunction function;
+	void* info;
+	bool stopped;
+} DKStroker;
+
+static inline DKPathPoint DKStrokePoint(double x, double y)
+{
+	DKPathPoint p = { x, y };
+	return p;
+}
+
+// adds a quarter circle clockwise about <centre>, from <centre> + <r0>, and returns the radius vector at its end
+
+static DKPathPoint DKStrokeAppendQuarter(DKPathBuffer* outline, DKPathPoint centre, DKPathPoint r0)
+{
+	DKPathPoint r1 = DKStrokePoint(r0.y, -r0.x);
+	double k = kDKQuarterCircleHandle;
+
+	DKPathBufferCurveTo(outline, DKStrokePoint(centre.x + r0.x + k * r1.x, centre.y + r0.y + k * r1.y),
+		DKStrokePoint(centre.x + r1.x + k * r0.x, centre.y + r1.y + k * r0.y),
+		DKStrokePoint(centre.x + r1.x, centre.y + r1.y));
+	return r1;
+}
+
+// joins the end of one side, <a>, to the start of the other, <b>. The end of the stroke lies midway between them, and the stroke runs
+// square to the line between them.
+
+static void DKStrokeAppendCap(DKPathBuffer* outline, DKPathCap cap, DKPathPoint a, DKPathPoint b)
+{
+	DKPathPoint centre = DKStrokePoint((a.x + b.x) * 0.5, (a.y + b.y) * 0.5);
+	DKPathPoint r = DKStrokePoint(a.x - centre.x, a.y - centre.y);
+
+	// <r> turned clockwise points out of the end of the stroke, and is as long as half its width
+
+	DKPathPoint out = DKStrokePoint(r.y, -r.x);
+
+	switch (cap) {
+	case kDKPathCapRound:
+		DKStrokeAppendQuarter(outline, centre, DKStrokeAppendQuarter(outline, centre, r));
+		break;
+
+	case kDKPathCapSquare:
+		DKPathBufferLineTo(outline, DKStrokePoint(a.x + out.x, a.y + out.y));
+		DKPathBufferLineTo(outline, DKStrokePoint(b.x + out.x, b.y + out.y));
+		DKPathBufferLineTo(outline, b);
+		break;
+
+	default:
+		DKPathBufferLineTo(outline, b);
+		break;
+	}
+}
+
+static void DKStrokeAppendDot(DKPathBuffer* outline, DKPathCap cap, DKPathPoint p, double h)
+{
+	if (cap == kDKPathCapRound) {
+		DKPathPoint r = DKStrokePoint(h, 0);
+		int i;
+
+		DKPathBufferMoveTo(outline, DKStrokePoint(p.x + h, p.y));
+
+		for (i = 0; i < 4; ++i)
+			r = DKStrokeAppendQuarter(outline, p, r);
+
+		DKPathBufferClose(outline);
+	} else if (cap == kDKPathCapSquare) {
+		// a dot has no direction, so its square is upright
+
+		DKPathBufferMoveTo(outline, DKStrokePoint(p.x - h, p.y - h));
+		DKPathBufferLineTo(outline, DKStrokePoint(p.x + h, p.y - h));
+		DKPathBufferLineTo(outline, DKStrokePoint(p.x + h, p.y + h));
+		DKPathBufferLineTo(outline, DKStrokePoint(p.x - h, p.y + h));
+		DKPathBufferClose(outline);
+	}
+}
+
+// whether the outline of a line or curve might reach the point being tested: it lies within its control points' bounds grown by the margin
+
+static bool DKStrokerIsNear(const DKStroker* stroker, const DKPathPoint* points, size_t count)
+{
+	const DKPathPoint* p = stroker->near;
+	double minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+	size_t i;
+
+	if (p == NULL)
+		return true;
+
+	for (i = 0; i < count; ++i) {
+		minX = fmin(minX, points[i].x);
+		minY = fmin(minY, points[i].y);
+		maxX = fmax(maxX, points[i].x);
+		maxY = fmax(maxY, points[i].y);
+	}
+
+	return p->x >= minX - stroker->margin && p->x <= maxX + stroker->margin && p->y >= minY - stroker->margin && p->y <= maxY + stroker->margin;
+}
+
+static void DKStrokerEmit(DKStroker* stroker)
+{
+	DKPathBuffer* outline = &stroker->outline;
+
+	if (outline->failed || stroker->reversed.failed || stroker->side.failed || stroker->run.failed || stroker->inset.failed)
+		stroker->stopped = true;
+	else if (outline->verbCount > 0 && !stroker->function(outline, stroker->info))
+		stroker->stopped = true;
+}
+
+// outlines <piece>, which is a single subpath, and passes the outline on
+
+static void DKStrokerOutline(DKStroker* stroker, const DKPathBuffer* piece, bool closed, DKPathCap startCap, DKPathCap endCap)
+{
+	DKPathBuffer* outline = &stroker->outline;
+	DKPathBuffer* side = &stroker->side;
+	double h = stroker->style.width * 0.5;
+
+	DKPathBufferClear(outline);
+	DKPathBufferClear(side);
+	DKPathBufferClear(&stroker->reversed);
+	DKPathOffsetStrokeSide(piece, h, &stroker->options, side);
+
+	if (side->verbCount == 0) {
+		DKStrokeAppendDot(outline, startCap, piece->points[0], h);
+		DKStrokerEmit(stroker);
+		return;
+	}
+
+	DKPathBufferAppendReversed(&stroker->reversed, piece);
+
+	if (closed) {
+		// each side is a closed subpath of its own, connected through the corners on the inside as an open piece's sides are. Where the
+		// stroke is wider than the hole in the middle, the inner side crosses itself, and its loops are kept so that the nonzero fill still
+		// covers everything within half the width of the path. Once the hole has closed up altogether, the inner side of a curved path
+		// can turn right round and cancel the outer one, so it is left out; a polygon's sides cannot, so they need not be checked.
+
+		double area = DKPathBufferSignedArea(piece);
+		bool holeClosed = false;
+
+		if (memchr(piece->verbs, kDKPathCurveTo, piece->verbCount)) {
+			DKPathOffsetOptions inner = stroker->options;
+
+			inner.removeLoops = true;
+			DKPathBufferClear(&stroker->inset);
+			DKPathOffset(area > 0.0 ? piece : &stroker->reversed, h, &inner, &stroker->inset);
+			holeClosed = stroker->inset.verbCount == 0 && !stroker->inset.failed;
+		}
+
+		if (!(holeClosed && area > 0.0))
+			DKPathBufferAppend(outline, side);
+
+		if (!(holeClosed && area < 0.0)) {
+			DKPathBufferClear(side);
+			DKPathOffsetStrokeSide(&stroker->reversed, h, &stroker->options, side);
+			DKPathBufferAppend(outline, side);
+		}
+	} else {
+		DKPathBufferAppend(outline, side);
+		DKPathBufferClear(side);
+		DKPathOffsetStrokeSide(&stroker->reversed, h, &stroker->options, side);
+
+		if (side->verbCount > 0) {
+			DKStrokeAppendCap(outline, endCap, outline->points[outline->pointCount - 1], side->points[0]);
+
+			// the other side carries on from the cap, so its move is left out
+
+			if (DKPathBufferReserve(outline, side->verbCount, side->pointCount)) {
+				memcpy(outline->verbs + outline->verbCount, side->verbs + 1, side->verbCount - 1);
+				memcpy(outline->points + outline->pointCount, side->points + 1, (side->pointCount - 1) * sizeof(DKPathPoint));
+				outline->verbCount += side->verbCount - 1;
+				outline->pointCount += side->pointCount - 1;
+			}
+
+			DKStrokeAppendCap(outline, startCap, outline->points[outline->pointCount - 1], outline->points[0]);
+			DKPathBufferClose(outline);
+		}
+	}
+
+	DKStrokerEmit(stroker);
+}
+
+// the points of segment <k> of <stroker->subpath>, counting its closing line as the last segment. Lines are given as two points.
+
+static size_t DKStrokerSegment(const DKStroker* stroker, size_t k, DKPathPoint c[4])
+{
+	const DKPathBuffer* subpath = &stroker->subpath;
+	size_t pi = stroker->offsets[k];
+
+	c[0] = subpath->points[pi - 1];
+
+	switch (subpath->verbs[k + 1]) {
+	case kDKPathCurveTo:
+		c[1] = subpath->points[pi];
+		c[2] = subpath->points[pi + 1];
+		c[3] = subpath->points[pi + 2];
+		return 4;
+
+	case kDKPathClose:
+		c[1] = subpath->points[0];
+		return 2;
+
+	default:
+		c[1] = subpath->points[pi];
+		return 2;
+	}
+}
+
+// outlines the segments from <first> to <last> of <stroker->subpath>, wrapping round if it is closed, as a subpath of their own
+
+static void DKStrokerOutlineRun(DKStroker* stroker, size_t first, size_t last, size_t count, DKPathCap startCap, DKPathCap endCap)
+{
+	DKPathBuffer* run = &stroker->run;
+	DKPathPoint c[4];
+	size_t k = first;
+
+	DKPathBufferClear(run);
+	DKStrokerSegment(stroker, k, c);
+	DKPathBufferMoveTo(run, c[0]);
+
+	for (;;) {
+		if (DKStrokerSegment(stroker, k, c) == 4)
+			DKPathBufferCurveTo(run, c[1], c[2], c[3]);
+		else
+			DKPathBufferLineTo(run, c[1]);
+
+		if (k == last)
+			break;
+
+		k = (k + 1) % count;
+	}
+
+	DKStrokerOutline(stroker, run, false, startCap, endCap);
+}
+
+// outlines the single subpath in <stroker->subpath>. When testing a point, only the runs of segments that come near it are outlined.
+// Each run takes in the segments either side of it, so that its joins are right, and those segments' far ends are too far from the
+// point for their butt ends to matter.
+
+static void DKStrokerOutlineSubpath(DKStroker* stroker, bool closed)
+{
+	DKPathBuffer* subpath = &stroker->subpath;
+
+	if (subpath->verbCount < 2 || stroker->stopped)
+		return;
+
+	if (stroker->near == NULL || subpath->verbCount < 8) {
+		if (DKStrokerIsNear(stroker, subpath->points, subpath->pointCount))
+			DKStrokerOutline(stroker, subpath, closed, stroker->style.cap, stroker->style.cap);
+		return;
+	}
+
+	// find where each segment's points start
+
+	size_t count = subpath->verbCount - 1, k, pi = 1;
+
+	if (count > stroker->offsetCapacity) {
+		size_t* offsets = realloc(stroker->offsets, count * sizeof(size_t));
+
+		if (offsets == NULL) {
+			stroker->run.failed = true;
+			stroker->stopped = true;
+			return;
+		}
+
+		stroker->offsets = offsets;
+		stroker->offsetCapacity = count;
+	}
+
+	for (k = 0; k < count; ++k) {
+		stroker->offsets[k] = pi;
+		pi += DKPathVerbPointCount(subpath->verbs[k + 1]);
+	}
+
+	// a closed subpath is walked from just after a segment that is not near, so that no run is split by the wrap. If every segment is
+	// near, it is outlined whole.
+
+	size_t begin = 0;
+	DKPathPoint c[4];
+
+	if (closed) {
+		for (k = 0; k < count; ++k) {
+			if (!DKStrokerIsNear(stroker, c, DKStrokerSegment(stroker, k, c)))
+				break;
+		}
+
+		if (k == count) {
+			DKStrokerOutline(stroker, subpath, true, stroker->style.cap, stroker->style.cap);
+			return;
+		}
+
+		begin = k + 1;
+	}
+
+	size_t j, runStart = 0;
+	bool inRun = false;
+
+	for (j = 0; j <= count && !stroker->stopped; ++j) {
+		bool near = false;
+
+		k = (begin + j) % count;
+
+		if (j < count)
+			near = DKStrokerIsNear(stroker, c, DKStrokerSegment(stroker, k, c));
+
+		if (near && !inRun) {
+			runStart = j;
+			inRun = true;
+		} else if (!near && inRun) {
+			// the run is from <runStart> to <j - 1>. Open subpaths keep their own caps where a run reaches their ends.
+
+			bool atStart = !closed && runStart == 0;
+			bool atEnd = !closed && j == count;
+			size_t first = atStart ? begin : (begin + runStart - 1 + count) % count;
+			size_t last = atEnd ? (begin + count - 1) % count : k;
+
+			// a run of all but one segment of a closed subpath would take in that segment at both ends, so the subpath is outlined whole
+
+			if (closed && first == last) {
+				DKStrokerOutline(stroker, subpath, true, stroker->style.cap, stroker->style.cap);
+				break;
+			}
+
+			DKStrokerOutlineRun(stroker, first, last, count, atStart ? stroker->style.cap : kDKPathCapButt, atEnd ? stroker->style.cap : kDKPathCapButt);
+			inRun = false;
+		}
+	}
+}
+
+static bool DKStrokeEnumerateNear(const DKPathBuffer* path, const DKPathStrokeStyle* style, const DKPathPoint* near, DKPathStrokeOutlineFunction function, void* info)
+{
+	DKStroker stroker;
+	DKPathBuffer dashed;
+	const DKPathBuffer* source = path;
+	bool failed = false;
+
+	memset(&stroker, 0, sizeof(stroker));
+	stroker.style = style ? *style : DKPathStrokeDefaultStyle();
+
+	if (!(stroker.style.width > 0.0) || !isfinite(stroker.style.width))
+		return true;
+
+	if (!(stroker.style.tolerance > 0.0))
+		stroker.style.tolerance = 0.1;
+
+	stroker.options = DKPathOffsetDefaultOptions();
+	stroker.options.tolerance = stroker.style.tolerance;
+	stroker.options.join = stroker.style.join;
+	stroker.options.miterLimit = stroker.style.miterLimit;
+	stroker.near = near;
+	stroker.margin = stroker.style.width * 0.5 * (stroker.style.join == kDKPathJoinMiter ? fmax(stroker.style.miterLimit, 1.5) : 1.5) + stroker.style.tolerance;
+	stroker.function = function;
+	stroker.info = info;
+
+	DKPathBufferInit(&dashed);
+
+	// a hit test only needs the dashes near the point, but they must still be counted from the start of each subpath
+
+	if (DKPathDashPatternLength(stroker.style.dash, stroker.style.dashCount) > 0.0 && isfinite(stroker.style.dashPhase)) {
+		DKPathMeasure measure;
+
+		DKPathMeasureInit(&measure);
+
+		if (!DKPathMeasureSetPath(&measure, path, stroker.style.tolerance))
+			dashed.failed = true;
+		else if (near)
+			DKPathMeasureDashNear(&measure, stroker.style.dash, stroker.style.dashCount, stroker.style.dashPhase, *near, stroker.margin, &dashed);
+		else
+			DKPathMeasureDash(&measure, stroker.style.dash, stroker.style.dashCount, stroker.style.dashPhase, &dashed);
+
+		DKPathMeasureFree(&measure);
+		source = &dashed;
+	}
+
+	// copy each subpath out in turn, so the sides can be found and the subpath reversed without touching the rest
+
+	const DKPathPoint* pp = source->points;
+	DKPathPoint start = { 0, 0 };
+	size_t i;
+
+	for (i = 0; i < source->verbCount && !stroker.stopped; ++i) {
+		switch (source->verbs[i]) {
+		case kDKPathMoveTo:
+			DKStrokerOutlineSubpath(&stroker, false);
+			DKPathBufferClear(&stroker.subpath);
+			start = pp[0];
+			DKPathBufferMoveTo(&stroker.subpath, start);
+			break;
+
+		case kDKPathLineTo:
+			if (stroker.subpath.verbCount == 0)
+				DKPathBufferMoveTo(&stroker.subpath, start);
+			DKPathBufferLineTo(&stroker.subpath, pp[0]);
+			break;
+
+		case kDKPathCurveTo:
+			if (stroker.subpath.verbCount == 0)
+				DKPathBufferMoveTo(&stroker.subpath, start);
+			DKPathBufferCurveTo(&stroker.subpath, pp[0], pp[1], pp[2]);
+			break;
+
+		case kDKPathClose:
+			if (stroker.subpath.verbCount == 0)
+				DKPathBufferMoveTo(&stroker.subpath, start);
+			DKPathBufferClose(&stroker.subpath);
+			DKStrokerOutlineSubpath(&stroker, true);
+			DKPathBufferClear(&stroker.subpath);
+			break;
+		}
+
+		pp += DKPathVerbPointCount(source->verbs[i]);
+
+		if (stroker.subpath.failed)
+			stroker.stopped = true;
+	}
+
+	DKStrokerOutlineSubpath(&stroker, false);
+
+	failed = dashed.failed || stroker.subpath.failed || stroker.reversed.failed || stroker.side.failed || stroker.outline.failed || stroker.run.failed || stroker.inset.failed;
+
+	DKPathBufferFree(&dashed);
+	DKPathBufferFree(&stroker.subpath);
+	DKPathBufferFree(&stroker.reversed);
+	DKPathBufferFree(&stroker.side);
+	DKPathBufferFree(&stroker.outline);
+	DKPathBufferFree(&stroker.run);
+	DKPathBufferFree(&stroker.inset);
+	free(stroker.offsets);
+
+	return !failed;
+}
+
+bool DKPathStrokeEnumerate(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathStrokeOutlineFunction function, void* info)
+{
+	return DKStrokeEnumerateNear(path, style, NULL, function, info);
+}
+
+static bool DKStrokeAppendOutline(const DKPathBuffer* outline, void* info)
+{
+	DKPathBuffer* result = info;
+
+	DKPathBufferAppend(result, outline);
+	return !result->failed;
+}
+
+bool DKPathStroke(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathBuffer* result)
+{
+	return DKStrokeEnumerateNear(path, style, NULL, DKStrokeAppendOutline, result) && !result->failed;
+}
+
+typedef struct {
+	DKPathPoint point;
+	double tolerance;
+	bool hit;
+} DKStrokeHitTest;
+
+static bool DKStrokeTestOutline(const DKPathBuffer* outline, void* info)
+{
+	DKStrokeHitTest* test = info;
+
+	test->hit = DKPathBufferWindingNumber(outline, test->point, test->tolerance) != 0;
+	return !test->hit;
+}
+
+bool DKPathStrokeContainsPoint(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathPoint point)
+{
+	DKStrokeHitTest test = { point, style && style->tolerance > 0.0 ? style->tolerance : 0.1, false };
+
+	DKStrokeEnumerateNear(path, style, &test.point, DKStrokeTestOutline, &test);
+	return test.hit;
+}
@@ -0,0 +1,90 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKPathStroke_h
+#define DKPathStroke_h
+
+#include "DKPathOffset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief How the open ends of a stroke are finished. The values match NSLineCapStyle. */
+typedef enum {
+	kDKPathCapButt = 0,
+	kDKPathCapRound = 1,
+	kDKPathCapSquare = 2
+} DKPathCap;
+
+/** @brief The settings a path is stroked with, as set on an NSBezierPath. */
+typedef struct {
+	double width; ///< the stroke width. Nothing is stroked if this is not > 0.
+	DKPathCap cap;
+	DKPathJoin join;
+	double miterLimit; ///< the longest miter allowed, as a multiple of the width, before a bevel is used instead
+	const double* dash; ///< the lengths of the alternate dashes and gaps, starting with a dash, or NULL for a solid stroke
+	size_t dashCount;
+	double dashPhase; ///< how far into the dash pattern each subpath starts
+	double tolerance; ///< the greatest distance the outline may stray from the true edge of the stroke. Must be > 0.
+} DKPathStrokeStyle;
+
+/** @brief Returns a solid style 1 wide, with butt caps, miter joins with a limit of 10, and a tolerance of 0.1. */
+DKPathStrokeStyle DKPathStrokeDefaultStyle(void);
+
+/** @brief Receives the outline of each dash, or of each subpath of a solid stroke, in turn.
+
+ The buffer is reused for the next outline, so must be copied if it is to be kept.
+ @return false to stop before the next outline */
+typedef bool (*DKPathStrokeOutlineFunction)(const DKPathBuffer* outline, void* info);
+
+/** @brief Finds the outline of a stroked path, one piece at a time.
+
+ Each piece is the outline of one dash, or of one subpath when the stroke is solid, and is filled with the nonzero winding rule. An open
+ piece is outlined by one subpath running out along one side, round the end cap and back along the other side. A closed subpath is
+ outlined by two closed subpaths, one for each side. Sides are found by DKPathOffsetStrokeSide(), so curves stay curves and joins are
+ exact. A piece of no length becomes a dot if the caps are round or square.
+
+ Pieces are built in buffers that are reused from one to the next, so a path of any number of dashes is outlined in the same memory.
+ @param path the path to stroke
+ @param style the stroke settings, or NULL for the defaults
+ @param function called with each piece of the outline
+ @param info passed to <function>
+ @return false if memory ran out
+ */
+bool DKPathStrokeEnumerate(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathStrokeOutlineFunction function, void* info);
+
+/** @brief Appends the whole outline of a stroked path to <result>. The outline must be filled with the nonzero winding rule.
+ @return false if memory ran out */
+bool DKPathStroke(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathBuffer* result);
+
+/** @brief Returns whether a point lies within the outline of a stroked path.
+
+ Only the pieces of the outline whose neighbourhood includes the point are built, and each is discarded once it has been tested.
+ */
+bool DKPathStrokeContainsPoint(const DKPathBuffer* path, const DKPathStrokeStyle* style, DKPathPoint point);
+
+/** @brief Breaks a path into its dashes.
+
+ Each dash becomes an open subpath of <result>, made of the parts of the original's lines and curves that it covers. The pattern starts
+ again, <phase> into it, at the start of each subpath. A dash of no length becomes a subpath of no length, which a stroker can show as a dot.
+ If the pattern is empty, or has no length, or has a negative length in it, the path is copied unchanged. The path is measured afresh on
+ each call; to dash the same path at many phases, measure it once with DKPathMeasureSetPath() and use DKPathMeasureDash().
+ @param path the path to dash
+ @param pattern the lengths of the alternate dashes and gaps, starting with a dash
+ @param count the number of lengths in <pattern>
+ @param phase how far into the pattern each subpath starts
+ @param tolerance how closely curve lengths are measured
+ @param result a buffer the dashes are appended to
+ @return false if memory ran out
+ */
+bool DKPathDash(const DKPathBuffer* path, const double* pattern, size_t count, double phase, double tolerance, DKPathBuffer* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKPathStroke_h */
@@ -0,0 +1,205 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKPathWarp.h"
+#include <math.h>
+#include <string.h>
+
+// the deepest a segment is split while looking for a warp within tolerance: at most 4096 pieces per input segment
+
+#define kDKWarpMaxDepth 12
+
+#if defined(__GNUC__) || defined(__clang__)
+// a point's x and y in one register, which SSE2 and NEON have natively. Wider vectors of two points cost more in shuffles than they save,
+// and without AVX the compiler splits them anyway
+typedef double DKWarpVector __attribute__((vector_size(16)));
+#define kDKWarpUsesVectors 1
+#else
+#define kDKWarpUsesVectors 0
+#endif
+
+void DKPathWarpInit(DKPathWarp* warp, DKPathPoint origin, double width, double height, const DKPathPoint envelope[4])
+{
+	// in the fractions u and v of the way across and down, the warp is q0 + (q1 - q0) u + (q3 - q0) v + (q0 - q1 + q2 - q3) u v. With
+	// u = su x + tu and v = sv y + tv, that expands into terms in 1, x, y and x y
+
+	double su = width != 0.0 ? 1.0 / width : 0.0;
+	double tu = width != 0.0 ? -origin.x / width : 0.5;
+	double sv = height != 0.0 ? 1.0 / height : 0.0;
+	double tv = height != 0.0 ? -origin.y / height : 0.5;
+
+	DKPathPoint q0 = envelope[0], q1 = envelope[1], q2 = envelope[2], q3 = envelope[3];
+	DKPathPoint b = { q1.x - q0.x, q1.y - q0.y };
+	DKPathPoint c = { q3.x - q0.x, q3.y - q0.y };
+	DKPathPoint d = { q0.x - q1.x + q2.x - q3.x, q0.y - q1.y + q2.y - q3.y };
+
+	warp->constant.x = q0.x + b.x * tu + c.x * tv + d.x * tu * tv;
+	warp->constant.y = q0.y + b.y * tu + c.y * tv + d.y * tu * tv;
+	warp->perX.x = (b.x + d.x * tv) * su;
+	warp->perX.y = (b.y + d.y * tv) * su;
+	warp->perY.x = (c.x + d.x * tu) * sv;
+	warp->perY.y = (c.y + d.y * tu) * sv;
+	warp->perXY.x = d.x * su * sv;
+	warp->perXY.y = d.y * su * sv;
+}
+
+void DKPathWarpPoints(const DKPathWarp* warp, const DKPathPoint* points, size_t count, DKPathPoint* result)
+{
+	size_t i;
+
+#if kDKWarpUsesVectors
+	const DKWarpVector constant = { warp->constant.x, warp->constant.y };
+	const DKWarpVector perX = { warp->perX.x, warp->perX.y };
+	const DKWarpVector perY = { warp->perY.x, warp->perY.y };
+	const DKWarpVector perXY = { warp->perXY.x, warp->perXY.y };
+
+	for (i = 0; i < count; ++i) {
+		DKWarpVector x = { points[i].x, points[i].x };
+		DKWarpVector y = { points[i].y, points[i].y };
+		DKWarpVector p = constant + perX * x + perY * y + perXY * (x * y);
+
+		memcpy(&result[i], &p, sizeof(p));
+	}
+#else
+	for (i = 0; i < count; ++i)
+		result[i] = DKPathWarpPoint(warp, points[i]);
+#endif
+}
+
+#pragma mark - subdivision
+
+// the warp of a small step <v> taken from <p>, by the warp's derivatives there
+
+static inline DKPathPoint DKWarpVectorAt(const DKPathWarp* warp, DKPathPoint p, DKPathPoint v)
+{
+	double dxx = warp->perX.x + warp->perXY.x * p.y, dxy = warp->perX.y + warp->perXY.y * p.y;
+	double dyx = warp->perY.x + warp->perXY.x * p.x, dyy = warp->perY.y + warp->perXY.y * p.x;
+
+	return (DKPathPoint){ dxx * v.x + dyx * v.y, dxy * v.x + dyy * v.y };
+}
+
+static inline double DKWarpSquaredDistance(DKPathPoint a, DKPathPoint b)
+{
+	double dx = a.x - b.x, dy = a.y - b.y;
+	return dx * dx + dy * dy;
+}
+
+static inline double DKWarpSquaredDistanceToChord(DKPathPoint p, DKPathPoint a, DKPathPoint b)
+{
+	double dx = b.x - a.x, dy = b.y - a.y;
+	double lengthSquared = dx * dx + dy * dy;
+	double t = lengthSquared > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared : 0.0;
+
+	t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+	return DKWarpSquaredDistance(p, (DKPathPoint){ a.x + dx * t, a.y + dy * t });
+}
+
+// warps the cubic <c>, whose ends are already warped to <start> and <end>, appending it to <result> as lines and curves. Half the tolerance
+// is allowed for the cubic's approximation and half for taking a flat one as a line
+
+static void DKWarpCubic(const DKPathWarp* warp, const DKPathPoint c[4], DKPathPoint start, DKPathPoint end, double tolerance, unsigned depth,
+	DKPathBuffer* result)
+{
+	static const double samples[3] = { 0.25, 0.5, 0.75 };
+	double limit = tolerance * tolerance * 0.25;
+	DKPathPoint m[4];
+	DKPathPoint d1 = DKWarpVectorAt(warp, c[0], (DKPathPoint){ c[1].x - c[0].x, c[1].y - c[0].y });
+	DKPathPoint d2 = DKWarpVectorAt(warp, c[3], (DKPathPoint){ c[3].x - c[2].x, c[3].y - c[2].y });
+	int i;
+
+	m[0] = start;
+	m[1] = (DKPathPoint){ start.x + d1.x, start.y + d1.y };
+	m[2] = (DKPathPoint){ end.x - d2.x, end.y - d2.y };
+	m[3] = end;
+
+	if (depth < kDKWarpMaxDepth) {
+		for (i = 0; i < 3; ++i) {
+			DKPathPoint truth = DKPathWarpPoint(warp, DKCubicPointAt(c, samples[i]));
+
+			if (DKWarpSquaredDistance(truth, DKCubicPointAt(m, samples[i])) > limit) {
+				DKPathPoint left[4], right[4];
+				DKPathPoint middle;
+
+				DKCubicSplit(c, 0.5, left, right);
+				middle = DKPathWarpPoint(warp, left[3]);
+
+				DKWarpCubic(warp, left, start, middle, tolerance, depth + 1, result);
+				DKWarpCubic(warp, right, middle, end, tolerance, depth + 1, result);
+				return;
+			}
+		}
+	}
+
+	if (DKWarpSquaredDistanceToChord(m[1], m[0], m[3]) <= limit && DKWarpSquaredDistanceToChord(m[2], m[0], m[3]) <= limit)
+		DKPathBufferLineTo(result, end);
+	else
+		DKPathBufferCurveTo(result, m[1], m[2], end);
+}
+
+static void DKWarpLine(const DKPathWarp* warp, DKPathPoint a, DKPathPoint b, DKPathPoint start, double tolerance, DKPathBuffer* result)
+{
+	DKPathPoint c[4] = { a, { a.x + (b.x - a.x) / 3.0, a.y + (b.y - a.y) / 3.0 }, { b.x - (b.x - a.x) / 3.0, b.y - (b.y - a.y) / 3.0 }, b };
+
+	DKWarpCubic(warp, c, start, DKPathWarpPoint(warp, b), tolerance, 0, result);
+}
+
+bool DKPathWarpPath(const DKPathWarp* warp, const DKPathBuffer* path, double tolerance, DKPathBuffer* result)
+{
+	const DKPathPoint* p = path->points;
+	DKPathPoint current = { 0, 0 }, first = { 0, 0 };
+	DKPathPoint warpedCurrent = DKPathWarpPoint(warp, current), warpedFirst = warpedCurrent;
+	size_t i;
+
+	for (i = 0; i < path->verbCount; ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			current = first = p[0];
+			warpedCurrent = warpedFirst = DKPathWarpPoint(warp, p[0]);
+			DKPathBufferMoveTo(result, warpedCurrent);
+			break;
+
+		case kDKPathLineTo:
+			DKWarpLine(warp, current, p[0], warpedCurrent, tolerance, result);
+			current = p[0];
+			warpedCurrent = DKPathWarpPoint(warp, current);
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, p[0], p[1], p[2] };
+			DKPathPoint end = DKPathWarpPoint(warp, p[2]);
+
+			DKWarpCubic(warp, c, warpedCurrent, end, tolerance, 0, result);
+			current = p[2];
+			warpedCurrent = end;
+			break;
+		}
+
+		default:
+			// the line a close draws back to the start bends too, so it is drawn explicitly before closing, unless it stays a single line,
+			// which the close draws anyway
+
+			if (current.x != first.x || current.y != first.y) {
+				size_t verbCount = result->verbCount;
+
+				DKWarpLine(warp, current, first, warpedCurrent, tolerance, result);
+
+				if (!result->failed && result->verbCount == verbCount + 1 && result->verbs[verbCount] == kDKPathLineTo) {
+					result->verbCount -= 1;
+					result->pointCount -= 1;
+				}
+			}
+
+			DKPathBufferClose(result);
+			current = first;
+			warpedCurrent = warpedFirst;
+			break;
+		}
+
+		p += DKPathVerbPointCount(path->verbs[i]);
+	}
+
+	return !result->failed;
+}
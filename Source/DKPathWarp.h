@@ -0,0 +1,69 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKPathWarp_h
+#define DKPathWarp_h
+
+#include "DKPathBuffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief A warp from a rectangle to a quadrilateral envelope, set up once so that each point costs a few multiplications.
+
+ A point at fractions u across and v down the rectangle goes to the same fractions of the envelope by bilinear interpolation, so the
+ rectangle's edges go to the envelope's edges and its centre to the average of the envelope's corners. The warp is held as the coefficients
+ of p' = constant + perX x + perY y + perXY x y, with the rectangle's origin and size folded in.
+ */
+typedef struct {
+	DKPathPoint constant;
+	DKPathPoint perX;
+	DKPathPoint perY;
+	DKPathPoint perXY;
+} DKPathWarp;
+
+/** @brief Sets up a warp.
+ @param warp the warp
+ @param origin the corner of the rectangle with the least x and y
+ @param width the width of the rectangle. If 0, every point is taken to be halfway across.
+ @param height the height of the rectangle. If 0, every point is taken to be halfway down.
+ @param envelope the corners the rectangle's corners go to, in order from the least x and y corner around by increasing x: the same order
+ as DKDistortionTransform's envelope */
+void DKPathWarpInit(DKPathWarp* warp, DKPathPoint origin, double width, double height, const DKPathPoint envelope[4]);
+
+static inline DKPathPoint DKPathWarpPoint(const DKPathWarp* warp, DKPathPoint p)
+{
+	double xy = p.x * p.y;
+
+	return (DKPathPoint){ warp->constant.x + warp->perX.x * p.x + warp->perY.x * p.y + warp->perXY.x * xy,
+		warp->constant.y + warp->perX.y * p.x + warp->perY.y * p.y + warp->perXY.y * xy };
+}
+
+/** @brief Warps a run of points, working out each point's x and y together in a vector register where the compiler supports vector
+ extensions. <points> and <result> may be the same. */
+void DKPathWarpPoints(const DKPathWarp* warp, const DKPathPoint* points, size_t count, DKPathPoint* result);
+
+/** @brief Warps a path, subdividing it so that the result stays within a tolerance of the true warp.
+
+ Lines and curves bend under a warp that isn't affine, so warping only their points, as DKPathWarpPoints() does, leaves them straight
+ where they should curve. Each segment is instead approximated by a cubic that meets the warped segment at its ends with the same tangent.
+ Where that strays from the warped segment by more than the tolerance, at a quarter, half or three quarters of the way along, the segment
+ is split in half and each half is warped again. A line goes to a parabola, which a cubic matches exactly, so lines are never split, and
+ are kept as lines where their warp is straight to within the tolerance.
+ @param warp the warp
+ @param path the path
+ @param tolerance the greatest distance the result may stray from the true warp. Must be > 0.
+ @param result a buffer the warped path is appended to
+ @return false if memory ran out
+ */
+bool DKPathWarpPath(const DKPathWarp* warp, const DKPathBuffer* path, double tolerance, DKPathBuffer* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKPathWarp_h */
@@ -26,6 +26,11 @@ static CGImageRef CreateMaskFromImage(NSImage* image);
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"blendMode", @"alpha", @"maskImage"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"blendMode", @"alpha", @"maskImage"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -6,7 +6,70 @@
 
 #import <Foundation/Foundation.h>
 
-/** @brief Random number generation. */
+NS_ASSUME_NONNULL_BEGIN
+
+/** @brief A seed for the counter-based random generator.
+
+ The counter-based functions below are stateless: the value for a given (seed, counter) pair is always the same, on any thread and in any
+ order of evaluation. Rasterizers that derive their randomness this way produce output that is a pure function of their seed, the geometry
+ and their parameters, so the output can be cached, compared or computed in parallel.
+ */
+typedef uint64_t DKRandomSeed;
+
+/** @brief Returns a new, unpredictable seed, e.g. for a newly created object. */
+FOUNDATION_EXTERN DKRandomSeed DKRandomSeedMake(void);
+
+/** @brief Returns a seed derived from a string, e.g. an object's unique key. The result is the same on every run. */
+FOUNDATION_EXTERN DKRandomSeed DKRandomSeedFromString(NSString* string);
+
+/** @brief Derives an independent seed for a sub-stream, e.g. a rasterizer seed from an object seed, or a per-path seed from a rasterizer seed. */
+FOUNDATION_EXTERN DKRandomSeed DKRandomDeriveSeed(DKRandomSeed parent, uint64_t stream);
+
+/** @brief Returns 64 random bits for the given seed and counter. */
+FOUNDATION_EXTERN uint64_t DKRandomBits(DKRandomSeed seed, uint64_t counter);
+
+/** @brief Returns a random value in the range \c 0 to \c 1 (exclusive) for the given seed and counter. */
+FOUNDATION_EXTERN CGFloat DKRandomValue(DKRandomSeed seed, uint64_t counter);
+
+/** @brief Returns a random value in the range \c -0.5 to \c 0.5 for the given seed and counter. */
+FOUNDATION_EXTERN CGFloat DKRandomSignedValue(DKRandomSeed seed, uint64_t counter);
+
+/** @brief Fills <values> with the random values for counters <first> to <first + count - 1>, in the range \c 0 to \c 1.
+
+ The result is identical to calling DKRandomValue() for each counter, so a range can be split between threads freely.
+ */
+FOUNDATION_EXTERN void DKRandomFillValues(DKRandomSeed seed, uint64_t first, CGFloat* values, NSUInteger count);
+
+/** @brief As DKRandomFillValues(), but in the range \c -0.5 to \c 0.5. */
+FOUNDATION_EXTERN void DKRandomFillSignedValues(DKRandomSeed seed, uint64_t first, CGFloat* values, NSUInteger count);
+
+/** @brief A sequential view of the counter-based generator, for code that consumes values one after another. */
+typedef struct {
+	DKRandomSeed seed;
+	uint64_t counter;
+} DKRandomStream;
+
+NS_INLINE DKRandomStream DKRandomStreamMake(DKRandomSeed seed)
+{
+	DKRandomStream stream = { seed, 0 };
+	return stream;
+}
+
+NS_INLINE CGFloat DKRandomStreamNextValue(DKRandomStream* stream)
+{
+	return DKRandomValue(stream->seed, stream->counter++);
+}
+
+NS_INLINE CGFloat DKRandomStreamNextSignedValue(DKRandomStream* stream)
+{
+	return DKRandomSignedValue(stream->seed, stream->counter++);
+}
+
+/** @brief Random number generation.
+
+ The class methods draw from a single process-wide stream with an unpredictable seed and are safe to call from any thread. Their results
+ are different every time, so rendering code should prefer the seeded functions above.
+ */
 @interface DKRandom : NSObject
 
 - (instancetype)init UNAVAILABLE_ATTRIBUTE;
@@ -19,3 +82,5 @@
 + (CGFloat)randomPositiveOrNegativeNumber;
 
 @end
+
+NS_ASSUME_NONNULL_END
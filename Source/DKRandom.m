@@ -5,24 +5,103 @@
 */
 
 #import "DKRandom.h"
+#import <stdatomic.h>
+#include <mach/mach_time.h>
+
+// the generator is SplitMix64 evaluated at an arbitrary position: the counter is scaled by the golden ratio increment and added to the seed,
+// and the sum is put through the SplitMix64 finalizer. This passes BigCrush for sequential counters and needs no state.
+
+#define DK_RANDOM_GAMMA 0x9E3779B97F4A7C15ULL
+
+static inline uint64_t DKRandomMix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static inline CGFloat DKRandomUnit(uint64_t bits)
+{
+	// the top 53 bits give a double in [0, 1) with full precision
+
+	return (CGFloat)((double)(bits >> 11) * 0x1.0p-53);
+}
+
+DKRandomSeed DKRandomSeedMake(void)
+{
+	static _Atomic(uint64_t) sCount = 0;
+
+	uint64_t n = atomic_fetch_add(&sCount, 1);
+	return DKRandomMix(mach_absolute_time() ^ DKRandomMix((uint64_t)getpid() + n * DK_RANDOM_GAMMA));
+}
+
+DKRandomSeed DKRandomSeedFromString(NSString* string)
+{
+	// FNV-1a over the UTF-8 bytes, then mixed. NSString's -hash is not guaranteed to be stable between releases, so is not used.
+
+	const unsigned char* s = (const unsigned char*)[string UTF8String];
+	uint64_t h = 0xCBF29CE484222325ULL;
+
+	while (s && *s) {
+		h ^= *s++;
+		h *= 0x100000001B3ULL;
+	}
+
+	return DKRandomMix(h);
+}
+
+DKRandomSeed DKRandomDeriveSeed(DKRandomSeed parent, uint64_t stream)
+{
+	return DKRandomMix(parent ^ DKRandomMix(stream + DK_RANDOM_GAMMA));
+}
+
+uint64_t DKRandomBits(DKRandomSeed seed, uint64_t counter)
+{
+	return DKRandomMix(seed + (counter + 1) * DK_RANDOM_GAMMA);
+}
+
+CGFloat DKRandomValue(DKRandomSeed seed, uint64_t counter)
+{
+	return DKRandomUnit(DKRandomBits(seed, counter));
+}
+
+CGFloat DKRandomSignedValue(DKRandomSeed seed, uint64_t counter)
+{
+	return DKRandomUnit(DKRandomBits(seed, counter)) - 0.5;
+}
+
+void DKRandomFillValues(DKRandomSeed seed, uint64_t first, CGFloat* values, NSUInteger count)
+{
+	// each value is independent of the others, so this loop has no carried dependency and the compiler is free to vectorize it
+
+	for (NSUInteger i = 0; i < count; ++i)
+		values[i] = DKRandomUnit(DKRandomMix(seed + (first + i + 1) * DK_RANDOM_GAMMA));
+}
+
+void DKRandomFillSignedValues(DKRandomSeed seed, uint64_t first, CGFloat* values, NSUInteger count)
+{
+	for (NSUInteger i = 0; i < count; ++i)
+		values[i] = DKRandomUnit(DKRandomMix(seed + (first + i + 1) * DK_RANDOM_GAMMA)) - 0.5;
+}
+
+#pragma mark -
 
 @implementation DKRandom
 #pragma mark As a DKRandom
 
+static DKRandomSeed sGlobalSeed = 0;
+static _Atomic(uint64_t) sGlobalCounter = 0;
+
 + (CGFloat)randomNumber
 {
 	// returns a random value between 0 and 1.
 
-	static unsigned long seed = 0;
-
-	if (seed == 0) {
-		srandom([[NSDate date] timeIntervalSince1970]);
-		seed = 1;
-	}
-	CGFloat randomNum = (CGFloat)random();
-	randomNum /= (randomNum < 0) ? -2147483647.0 : 2147483647.0;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sGlobalSeed = DKRandomSeedMake();
+	});
 
-	return randomNum;
+	return DKRandomValue(sGlobalSeed, atomic_fetch_add(&sGlobalCounter, 1));
 }
 
 + (CGFloat)randomPositiveOrNegativeNumber
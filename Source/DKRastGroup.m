@@ -7,6 +7,7 @@
 #import "DKRastGroup.h"
 #import "DKFill.h"
 #import "DKGradient.h"
+#import "DKInstrumentation.h"
 #import "DKStroke.h"
 #import "LogEvent.h"
 #import "NSDictionary+DeepCopy.h"
@@ -314,6 +315,11 @@
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"renderList"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"renderList"]];
+}
+
 /** @brief Registers the action names for the observable properties published by the object
  */
 - (void)registerActionNames
@@ -408,6 +414,17 @@
 		return;
 
 	SAVE_GRAPHICS_CONTEXT //[NSGraphicsContext saveGraphicsState];
+
+	// when instrumented, each renderer is timed under its class, so the cost of each kind of fill, stroke or effect shows separately
+
+	if (gDKInstrumentationEnabled) {
+		for (DKRasterizer* renderer in [self renderList]) {
+			DKInstrumentScope scope = DKInstrumentScopeBeginForClass("render", [renderer class]);
+
+			[renderer render:object];
+			DKInstrumentScopeEnd(&scope);
+		}
+	} else
 		[[self renderList] makeObjectsPerformSelector:_cmd
 										   withObject:object];
 
@@ -140,6 +140,14 @@ NSString* const kDKRasterizerChangedPropertyKey = @"kDKRasterizerChangedProperty
 	return @[@"name", @"enabled", @"clipping"];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	// renderers that differ only in name draw the same. Subclasses add everything that changes how they draw, which can be more than
+	// they publish for undo
+
+	return @[@"enabled", @"clipping"];
+}
+
 - (NSString*)actionNameForKeyPath:(NSString*)keypath changeKind:(NSKeyValueChange)kind
 {
 	if ([keypath isEqualToString:@"enabled"]) {
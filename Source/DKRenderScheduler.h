@@ -0,0 +1,126 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** @brief How an area of the drawing was, or should be, drawn. */
+typedef NS_ENUM(NSInteger, DKRenderQuality) {
+	kDKRenderQualityDraft = 0, ///< the cheap pass, drawn with \c lowRenderingQuality set so renderers can use bounds, caches and simpler styles
+	kDKRenderQualityFull = 1 ///< drawn at best quality
+};
+
+/** @brief Returns the time in seconds, for the scheduler to measure intervals with. Only differences between times are used. */
+typedef NSTimeInterval (^DKRenderClock)(void);
+
+@class DKRenderScheduler;
+
+/** @brief Estimates how long an area of a drawing takes to draw.
+
+ A scheduler without a cost model learns the average time per unit of area from the draws it is told about, which is good enough for a
+ drawing whose content is spread evenly. A cost model can do better, for example by counting the objects in the area.
+*/
+@protocol DKRenderCostModel <NSObject>
+
+/** @brief Returns the time in seconds that drawing <rect> at <quality> is expected to take. */
+- (NSTimeInterval)renderScheduler:(DKRenderScheduler*)scheduler estimatedTimeToDrawRect:(NSRect)rect quality:(DKRenderQuality)quality;
+
+@optional
+
+/** @brief Tells the model how long a draw actually took. */
+- (void)renderScheduler:(DKRenderScheduler*)scheduler didDrawRect:(NSRect)rect quality:(DKRenderQuality)quality duration:(NSTimeInterval)duration;
+
+@end
+
+#pragma mark -
+
+/** @brief Decides how each update of a drawing is drawn, and which areas to redraw at best quality once updates stop.
+
+ The drawing is divided into square tiles, and the scheduler keeps the tiles that were last drawn as a draft. An update whose full quality
+ draw is expected to fit within \c frameBudget is drawn at full quality straight away. A larger one is drawn as a draft, and its tiles are
+ refined later, once they have not been drawn for \c quietInterval, so that nothing is refined while it is still changing.
+
+ Refinement is spread over idle frames. Each call to \c -rectsToRefine returns the tiles whose full quality draw fits within the frame
+ budget, taking visible tiles near the cursor first and then those that changed most recently. A tile that is drawn as a draft again before
+ its refinement arrives goes back to waiting, and one that is no longer visible is dropped, since it will be drawn afresh when it is
+ scrolled back into view.
+
+ The scheduler does no drawing and sets no timers itself. Its owner asks it for the quality of each draw, tells it how long the draw took,
+ and asks for the tiles to refine on each idle frame, so the scheduling can be driven by a simulated clock.
+*/
+@interface DKRenderScheduler : NSObject
+
+/** @brief Creates a scheduler for a drawing of the given bounds.
+ @param bounds the area of the drawing
+ @param tileSize the side of each tile, in drawing units
+ @return the scheduler
+ */
+- (instancetype)initWithBounds:(NSRect)bounds tileSize:(CGFloat)tileSize NS_DESIGNATED_INITIALIZER;
+
+/** @brief The area of the drawing. Setting it forgets all tiles waiting to be refined. */
+@property (nonatomic) NSRect bounds;
+@property (nonatomic, readonly) CGFloat tileSize;
+
+/** @brief The clock used for all timing. Defaults to the system uptime. */
+@property (nonatomic, copy, null_resettable) DKRenderClock clock;
+
+/** @brief Estimates drawing times. If nil, the scheduler learns its own estimate from the draws it is told about. */
+@property (nonatomic, strong, nullable) id<DKRenderCostModel> costModel;
+
+/** @brief The time each frame may spend drawing, in seconds. Default is 1/120, half of a frame at 60 frames per second. */
+@property (nonatomic) NSTimeInterval frameBudget;
+
+/** @brief How long a tile must go without being drawn before it is refined, in seconds. Default is 0.2. */
+@property (nonatomic) NSTimeInterval quietInterval;
+
+/** @brief The areas that can currently be seen. If empty, every area is treated as visible. */
+@property (nonatomic, copy) NSArray<NSValue*>* visibleRects;
+
+/** @brief Where the cursor is, so that tiles near it are refined first. NSZeroPoint until set. */
+@property (nonatomic) NSPoint cursorPoint;
+@property (nonatomic) BOOL hasCursorPoint;
+
+/** @brief The current time, from \c clock. */
+@property (nonatomic, readonly) NSTimeInterval currentTime;
+
+/** @brief Returns the quality to draw <rect> at.
+
+ Full if every tile it touches is being refined or its full quality draw is expected to fit within the frame budget, otherwise draft.
+ */
+- (DKRenderQuality)qualityForDrawingRect:(NSRect)rect;
+
+/** @brief Records a draw.
+
+ A full quality draw refines the tiles whose visible part it covers completely, since a view clips what it draws to what can be seen. A
+ draft marks every tile it touches as waiting for refinement, cancelling any refinement already requested for it. The duration also goes
+ to the cost model.
+ @param rect the area drawn
+ @param quality the quality it was drawn at
+ @param duration how long the draw took, in seconds
+ */
+- (void)didDrawRect:(NSRect)rect quality:(DKRenderQuality)quality duration:(NSTimeInterval)duration;
+
+/** @brief Returns the areas to redraw at full quality in this frame, in the order they should be drawn.
+
+ Only tiles that have been quiet for \c quietInterval are included, and only as many as fit within the frame budget, though always at least
+ one if any are ready. Tiles returned are marked as being refined, so that \c -qualityForDrawingRect: draws them at full quality.
+ @return an array of NSRect values, empty if nothing is ready
+ */
+- (NSArray<NSValue*>*)rectsToRefine;
+
+/** @brief Whether any tile is still waiting to be drawn at full quality. */
+@property (nonatomic, readonly) BOOL hasPendingRefinements;
+
+/** @brief The number of tiles waiting to be drawn at full quality, including those already requested. */
+@property (nonatomic, readonly) NSUInteger pendingTileCount;
+
+/** @brief Forgets all tiles waiting to be refined. */
+- (void)cancelAllRefinements;
+
+@end
+
+NS_ASSUME_NONNULL_END
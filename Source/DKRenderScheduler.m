@@ -0,0 +1,388 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKRenderScheduler.h"
+
+// a refinement that hasn't been drawn this long after it was requested is assumed lost, and is requested again
+
+#define RENDER_REFINE_TIMEOUT 1.0
+
+// the learned cost per unit area starts at this, and each draw moves it this far towards the cost it measured
+
+#define RENDER_DEFAULT_COST_PER_AREA 1.0e-8
+#define RENDER_COST_SMOOTHING 0.25
+
+// draws smaller than this tell us more about fixed overheads than about cost per area, so aren't learned from
+
+#define RENDER_MIN_LEARNING_AREA 1024.0
+
+#pragma mark -
+
+/** @brief A tile waiting to be drawn at full quality. Tiles that are up to date are not kept. */
+@interface DKRenderTile : NSObject {
+@public
+	NSInteger column;
+	NSInteger row;
+	NSTimeInterval changeTime; // when the tile was last drawn as a draft
+	NSTimeInterval requestTime; // when the tile's refinement was requested, if it has been
+	BOOL requested;
+	double sortDistance;
+}
+@end
+
+@implementation DKRenderTile
+@end
+
+#pragma mark -
+
+@interface DKRenderScheduler ()
+
+- (NSNumber*)keyForColumn:(NSInteger)column row:(NSInteger)row;
+- (NSRect)rectForColumn:(NSInteger)column row:(NSInteger)row;
+
+/** @brief Gets the range of tiles that <rect> touches, returning NO if it touches none. */
+- (BOOL)getColumns:(NSRange*)columns rows:(NSRange*)rows forRect:(NSRect)rect;
+- (NSTimeInterval)estimatedTimeToDrawRect:(NSRect)rect quality:(DKRenderQuality)quality;
+- (BOOL)rectIsVisible:(NSRect)rect;
+- (BOOL)rect:(NSRect)rect coversVisiblePartOfRect:(NSRect)tileRect;
+
+@end
+
+#pragma mark -
+
+@implementation DKRenderScheduler {
+	NSMutableDictionary<NSNumber*, DKRenderTile*>* mTiles;
+	double mCostPerArea[2];
+}
+
+@synthesize bounds = mBounds;
+@synthesize tileSize = mTileSize;
+@synthesize clock = mClock;
+@synthesize costModel = mCostModel;
+@synthesize frameBudget = mFrameBudget;
+@synthesize quietInterval = mQuietInterval;
+@synthesize visibleRects = mVisibleRects;
+@synthesize cursorPoint = mCursorPoint;
+@synthesize hasCursorPoint = mHasCursorPoint;
+
+- (instancetype)initWithBounds:(NSRect)bounds tileSize:(CGFloat)tileSize
+{
+	NSAssert(tileSize > 0, @"tile size must be > 0");
+
+	if (self = [super init]) {
+		mBounds = bounds;
+		mTileSize = tileSize;
+		mTiles = [[NSMutableDictionary alloc] init];
+		mFrameBudget = 1.0 / 120.0;
+		mQuietInterval = 0.2;
+		mVisibleRects = @[];
+		mCostPerArea[kDKRenderQualityFull] = RENDER_DEFAULT_COST_PER_AREA;
+		mCostPerArea[kDKRenderQualityDraft] = RENDER_DEFAULT_COST_PER_AREA * 0.25;
+		[self setClock:nil];
+	}
+
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithBounds:NSZeroRect
+					   tileSize:256];
+}
+
+- (void)setBounds:(NSRect)bounds
+{
+	if (!NSEqualRects(bounds, mBounds)) {
+		mBounds = bounds;
+		[self cancelAllRefinements];
+	}
+}
+
+- (void)setClock:(DKRenderClock)clock
+{
+	if (clock == nil) {
+		clock = ^{
+			return [[NSProcessInfo processInfo] systemUptime];
+		};
+	}
+
+	mClock = [clock copy];
+}
+
+- (NSTimeInterval)currentTime
+{
+	return mClock();
+}
+
+- (void)setCursorPoint:(NSPoint)cursorPoint
+{
+	mCursorPoint = cursorPoint;
+	mHasCursorPoint = YES;
+}
+
+#pragma mark -
+
+- (DKRenderQuality)qualityForDrawingRect:(NSRect)rect
+{
+	NSRange columns, rows;
+
+	if (![self getColumns:&columns
+					 rows:&rows
+				  forRect:rect])
+		return kDKRenderQualityFull;
+
+	// a draw that includes a tile being refined, and no tile still waiting for its turn, is the refinement itself
+
+	BOOL refining = NO, waiting = NO;
+
+	for (NSInteger row = rows.location; row < (NSInteger)NSMaxRange(rows) && !waiting; ++row) {
+		for (NSInteger column = columns.location; column < (NSInteger)NSMaxRange(columns); ++column) {
+			DKRenderTile* tile = mTiles[[self keyForColumn:column
+													   row:row]];
+
+			if (tile == nil)
+				continue;
+
+			if (tile->requested)
+				refining = YES;
+			else {
+				waiting = YES;
+				break;
+			}
+		}
+	}
+
+	if (refining && !waiting)
+		return kDKRenderQualityFull;
+
+	// otherwise it is an update, drawn properly only if that fits in a frame
+
+	if ([self estimatedTimeToDrawRect:NSIntersectionRect(rect, mBounds)
+							  quality:kDKRenderQualityFull]
+		<= mFrameBudget)
+		return kDKRenderQualityFull;
+
+	return kDKRenderQualityDraft;
+}
+
+- (void)didDrawRect:(NSRect)rect quality:(DKRenderQuality)quality duration:(NSTimeInterval)duration
+{
+	NSRect drawn = NSIntersectionRect(rect, mBounds);
+	double area = NSWidth(drawn) * NSHeight(drawn);
+
+	if (mCostModel != nil) {
+		if ([mCostModel respondsToSelector:@selector(renderScheduler:didDrawRect:quality:duration:)])
+			[mCostModel renderScheduler:self
+							didDrawRect:drawn
+								quality:quality
+							   duration:duration];
+	} else if (area >= RENDER_MIN_LEARNING_AREA && duration >= 0)
+		mCostPerArea[quality] += (duration / area - mCostPerArea[quality]) * RENDER_COST_SMOOTHING;
+
+	NSRange columns, rows;
+
+	if (![self getColumns:&columns
+					 rows:&rows
+				  forRect:rect])
+		return;
+
+	NSTimeInterval now = [self currentTime];
+
+	for (NSInteger row = rows.location; row < (NSInteger)NSMaxRange(rows); ++row) {
+		for (NSInteger column = columns.location; column < (NSInteger)NSMaxRange(columns); ++column) {
+			NSNumber* key = [self keyForColumn:column
+										   row:row];
+
+			if (quality == kDKRenderQualityFull) {
+				// only a tile drawn completely is up to date. Tiles are cut to the bounds, so those at the edges can be covered, and views
+				// clip their drawing to what can be seen, so a tile cut by the edge of the view is up to date once its visible part is drawn
+
+				if ([self rect:rect
+						coversVisiblePartOfRect:[self rectForColumn:column
+																row:row]])
+					[mTiles removeObjectForKey:key];
+			} else {
+				DKRenderTile* tile = mTiles[key];
+
+				if (tile == nil) {
+					tile = [[DKRenderTile alloc] init];
+					tile->column = column;
+					tile->row = row;
+					mTiles[key] = tile;
+				}
+
+				tile->changeTime = now;
+				tile->requested = NO;
+			}
+		}
+	}
+}
+
+- (NSArray<NSValue*>*)rectsToRefine
+{
+	NSTimeInterval now = [self currentTime];
+	NSMutableArray<DKRenderTile*>* ready = [NSMutableArray array];
+	NSMutableArray<NSNumber*>* hidden = [NSMutableArray array];
+	NSPoint origin = mBounds.origin;
+
+	[mTiles enumerateKeysAndObjectsUsingBlock:^(NSNumber* key, DKRenderTile* tile, BOOL* stop) {
+#pragma unused(stop)
+		if (tile->requested) {
+			if (now - tile->requestTime < RENDER_REFINE_TIMEOUT)
+				return;
+
+			tile->requested = NO;
+		}
+
+		if (now - tile->changeTime < mQuietInterval)
+			return;
+
+		NSRect tr = [self rectForColumn:tile->column
+									row:tile->row];
+
+		if (![self rectIsVisible:tr]) {
+			[hidden addObject:key];
+			return;
+		}
+
+		// distance from the cursor is counted in whole tiles, so that among tiles equally near it the most recently changed goes first
+
+		if (mHasCursorPoint) {
+			double dx = (origin.x + (tile->column + 0.5) * mTileSize - mCursorPoint.x) / mTileSize;
+			double dy = (origin.y + (tile->row + 0.5) * mTileSize - mCursorPoint.y) / mTileSize;
+
+			tile->sortDistance = floor(hypot(dx, dy));
+		} else
+			tile->sortDistance = 0;
+
+		[ready addObject:tile];
+	}];
+
+	[mTiles removeObjectsForKeys:hidden];
+
+	[ready sortUsingComparator:^NSComparisonResult(DKRenderTile* a, DKRenderTile* b) {
+		if (a->sortDistance != b->sortDistance)
+			return a->sortDistance < b->sortDistance ? NSOrderedAscending : NSOrderedDescending;
+
+		if (a->changeTime != b->changeTime)
+			return a->changeTime > b->changeTime ? NSOrderedAscending : NSOrderedDescending;
+
+		if (a->row != b->row)
+			return a->row < b->row ? NSOrderedAscending : NSOrderedDescending;
+
+		if (a->column != b->column)
+			return a->column < b->column ? NSOrderedAscending : NSOrderedDescending;
+
+		return NSOrderedSame;
+	}];
+
+	NSMutableArray<NSValue*>* rects = [NSMutableArray array];
+	NSTimeInterval spent = 0;
+
+	for (DKRenderTile* tile in ready) {
+		NSRect tr = [self rectForColumn:tile->column
+									row:tile->row];
+		NSTimeInterval cost = [self estimatedTimeToDrawRect:tr
+													quality:kDKRenderQualityFull];
+
+		if ([rects count] > 0 && spent + cost > mFrameBudget)
+			break;
+
+		spent += cost;
+		tile->requested = YES;
+		tile->requestTime = now;
+		[rects addObject:[NSValue valueWithRect:tr]];
+	}
+
+	return rects;
+}
+
+- (BOOL)hasPendingRefinements
+{
+	return [mTiles count] > 0;
+}
+
+- (NSUInteger)pendingTileCount
+{
+	return [mTiles count];
+}
+
+- (void)cancelAllRefinements
+{
+	[mTiles removeAllObjects];
+}
+
+#pragma mark -
+
+- (NSNumber*)keyForColumn:(NSInteger)column row:(NSInteger)row
+{
+	return @(((uint64_t)(uint32_t)row << 32) | (uint32_t)column);
+}
+
+- (NSRect)rectForColumn:(NSInteger)column row:(NSInteger)row
+{
+	NSRect tr = NSMakeRect(NSMinX(mBounds) + column * mTileSize, NSMinY(mBounds) + row * mTileSize, mTileSize, mTileSize);
+
+	return NSIntersectionRect(tr, mBounds);
+}
+
+- (BOOL)getColumns:(NSRange*)columns rows:(NSRange*)rows forRect:(NSRect)rect
+{
+	rect = NSIntersectionRect(rect, mBounds);
+
+	if (NSIsEmptyRect(rect))
+		return NO;
+
+	NSInteger c0 = (NSInteger)floor((NSMinX(rect) - NSMinX(mBounds)) / mTileSize);
+	NSInteger c1 = (NSInteger)ceil((NSMaxX(rect) - NSMinX(mBounds)) / mTileSize);
+	NSInteger r0 = (NSInteger)floor((NSMinY(rect) - NSMinY(mBounds)) / mTileSize);
+	NSInteger r1 = (NSInteger)ceil((NSMaxY(rect) - NSMinY(mBounds)) / mTileSize);
+
+	*columns = NSMakeRange(c0, MAX(c1 - c0, 1));
+	*rows = NSMakeRange(r0, MAX(r1 - r0, 1));
+
+	return YES;
+}
+
+- (NSTimeInterval)estimatedTimeToDrawRect:(NSRect)rect quality:(DKRenderQuality)quality
+{
+	if (mCostModel != nil)
+		return [mCostModel renderScheduler:self
+				   estimatedTimeToDrawRect:rect
+								   quality:quality];
+
+	return NSWidth(rect) * NSHeight(rect) * mCostPerArea[quality];
+}
+
+- (BOOL)rectIsVisible:(NSRect)rect
+{
+	if ([mVisibleRects count] == 0)
+		return YES;
+
+	for (NSValue* value in mVisibleRects) {
+		if (NSIntersectsRect([value rectValue], rect))
+			return YES;
+	}
+
+	return NO;
+}
+
+- (BOOL)rect:(NSRect)rect coversVisiblePartOfRect:(NSRect)tileRect
+{
+	if ([mVisibleRects count] == 0)
+		return NSContainsRect(rect, tileRect);
+
+	for (NSValue* value in mVisibleRects) {
+		NSRect visiblePart = NSIntersectionRect([value rectValue], tileRect);
+
+		if (!NSIsEmptyRect(visiblePart) && !NSContainsRect(rect, visiblePart))
+			return NO;
+	}
+
+	return YES;
+}
+
+@end
@@ -6,6 +6,7 @@
 
 #import <Cocoa/Cocoa.h>
 #import "DKStroke.h"
+#import "DKRandom.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -16,19 +17,24 @@ NS_ASSUME_NONNULL_BEGIN
 
  The nominal width, colour, etc are all inherited from <code>DKStroke</code>. \c roughness is the amount of randomness and is a fraction of the stroke width.
 
- Because a roughened path is both fairly complicated to compute and has a lot of randomness that is different every time, this object caches the roughened
+ The roughening is derived from the stroke's \c seed and the path's cache key, so a given path is always roughened the same way by a given stroke,
+ on any thread. Because a roughened path is fairly complicated to compute, this object caches the roughened
  paths it generates and re-uses them as much as it can. A path is cached based on its bounds, width and length, giving a key that is likely to be unique in practice.
  Paths are cached up to the maximum number set by the constant, after which least used cached paths are discarded.
 */
 @interface DKRoughStroke : DKStroke <NSCoding, NSCopying> {
 @private
 	CGFloat mRoughness;
+	DKRandomSeed mSeed;
 	NSMutableDictionary<NSString*, NSBezierPath*>* mPathCache;
 	NSMutableArray<NSBezierPath*>* mCacheList;
 }
 
 @property (nonatomic) CGFloat roughness;
 
+/** @brief The seed from which all the roughening is derived. New strokes get an unpredictable seed; it is archived and copied. */
+@property (nonatomic) DKRandomSeed seed;
+
 - (NSString*)pathKeyForPath:(NSBezierPath*)path;
 - (void)invalidateCache;
 - (nullable NSBezierPath*)roughPathFromPath:(NSBezierPath*)path;
@@ -21,6 +21,16 @@
 
 @synthesize roughness = mRoughness;
 
+- (void)setSeed:(DKRandomSeed)seed
+{
+	if (seed != mSeed) {
+		mSeed = seed;
+		[self invalidateCache];
+	}
+}
+
+@synthesize seed = mSeed;
+
 - (NSString*)pathKeyForPath:(NSBezierPath*)path
 {
 	// form a simple hash from the path's size, length and current stroke width. Note that the precision is deliberately set to just 1 decimal
@@ -48,7 +58,10 @@
 	if (cp == nil) {
 		// not in the cache, so create it from scratch
 
-		cp = [path bezierPathWithRoughenedStrokeOutline:[self roughness] * [self width]];
+		// the seed for the path is derived from the key, so paths that share a key (and so a cache entry) are roughened identically
+
+		cp = [path bezierPathWithRoughenedStrokeOutline:[self roughness] * [self width]
+												   seed:DKRandomDeriveSeed([self seed], DKRandomSeedFromString(key))];
 
 		if (cp != nil) {
 			// set its origin to 0,0 based on the original path
@@ -105,6 +118,7 @@
 	if (self != nil) {
 		mPathCache = [[NSMutableDictionary alloc] init];
 		mCacheList = [[NSMutableArray alloc] init];
+		mSeed = DKRandomSeedMake();
 		[self setRoughness:0.25];
 	}
 
@@ -147,7 +161,12 @@
 
 + (NSArray*)observableKeyPaths
 {
-	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"roughness"]];
+	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"roughness", @"seed"]];
+}
+
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"roughness", @"seed"]];
 }
 
 - (void)registerActionNames
@@ -155,6 +174,8 @@
 	[super registerActionNames];
 	[self setActionName:@"#kind# Stroke Roughness"
 			 forKeyPath:@"roughness"];
+	[self setActionName:@"#kind# Roughness Seed"
+			 forKeyPath:@"seed"];
 }
 
 #pragma mark -
@@ -165,6 +186,12 @@
 	if (self = [super initWithCoder:coder]) {
 		mPathCache = [[NSMutableDictionary alloc] init];
 		mCacheList = [[NSMutableArray alloc] init];
+
+		if ([coder containsValueForKey:@"DKRoughStroke_seed"])
+			mSeed = (DKRandomSeed)[coder decodeInt64ForKey:@"DKRoughStroke_seed"];
+		else
+			mSeed = DKRandomSeedMake();
+
 		[self setRoughness:[coder decodeDoubleForKey:@"DKRoughStroke_roughness"]];
 	}
 
@@ -176,6 +203,8 @@
 	[super encodeWithCoder:coder];
 	[coder encodeDouble:[self roughness]
 				 forKey:@"DKRoughStroke_roughness"];
+	[coder encodeInt64:(int64_t)[self seed]
+				forKey:@"DKRoughStroke_seed"];
 }
 
 #pragma mark -
@@ -185,6 +214,7 @@
 {
 	DKRoughStroke* rs = [super copyWithZone:zone];
 	[rs setRoughness:[self roughness]];
+	[rs setSeed:[self seed]];
 
 	return rs;
 }
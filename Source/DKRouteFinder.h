@@ -5,6 +5,7 @@
 */
 
 #import <Cocoa/Cocoa.h>
+#import "DKRouteOptimiser.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -12,7 +13,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 typedef NS_ENUM(NSInteger, DKRouteAlgorithmType) {
 	kDKUseSimulatedAnnealing = 1,
-	kDKUseNearestNeighbour = 2
+	kDKUseNearestNeighbour = 2,
+	kDKUseRouteOptimiser = 4
 };
 
 typedef NS_ENUM(NSInteger, DKDirection) {
@@ -32,6 +34,9 @@ typedef NS_ENUM(NSInteger, DKDirection) {
  will be the shortest route as determined by the algorithm. The first point object in both input and output arrays is the same - in other words
  the zeroth element of the input array sets the starting point of the path.
 
+ The default algorithm is \c kDKUseRouteOptimiser, which uses DKRouteOptimiseOpenPath() and is practical for hundreds of thousands of
+ points. The simulated annealing and nearest neighbour algorithms remain available through \c +setAlgorithm:.
+
  For uses with other object types, the \c -shortestRouteOrder might be more useful. This returns an array of integers which is the order of the
  objects. This can then be used to reorder arbitrary objects.
 
@@ -53,6 +58,9 @@ resolves to an \c NSPoint return value, and is given by <code>key</code>. The re
 	// for NN
 	NSMutableArray<NSValue*>* mVisited; // for NN, the list of visited points in visit order
 	DKDirection mDirection; // limit search for NN to this direction
+	// for the route optimiser
+	NSPoint* mPoints; // contiguous list of input points
+	DKRouteOptimiserOptions mOptimiserOptions; // options passed to the optimiser
 }
 
 + (nullable DKRouteFinder*)routeFinderWithArrayOfPoints:(NSArray<NSValue*>*)arrayOfPoints NS_REFINED_FOR_SWIFT;
@@ -79,6 +87,10 @@ resolves to an \c NSPoint return value, and is given by <code>key</code>. The re
 
 @property (weak, nullable) id<DKRouteFinderProgressDelegate> progressDelegate;
 
+/** @brief Options for the \c kDKUseRouteOptimiser algorithm. Must be set before the route is first requested.
+ */
+@property DKRouteOptimiserOptions optimiserOptions;
+
 @end
 
 #define kDKDefaultAnnealingSteps 100
@@ -8,6 +8,7 @@
 
 static CGFloat anneal(CGFloat x[], CGFloat y[], NSInteger iorder[], NSInteger ncity, NSInteger annealingSteps, const void* context);
 static void progressCallback(CGFloat iteration, CGFloat maxIterations, const void* context);
+static void optimiserProgressCallback(CGFloat progress, const void* context);
 static DKDirection directionOfAngle(const CGFloat angle);
 
 @interface DKRouteFinder ()
@@ -24,7 +25,7 @@ static DKDirection directionOfAngle(const CGFloat angle);
 
 #pragma mark -
 
-static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimulatedAnnealing;
+static DKRouteAlgorithmType s_Algorithm = kDKUseRouteOptimiser; //kDKUseNearestNeighbour; //kDKUseSimulatedAnnealing;
 
 @implementation DKRouteFinder
 
@@ -149,6 +150,7 @@ static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimula
 @synthesize algorithm = mAlgorithm;
 
 @synthesize progressDelegate = mProgressDelegate;
+@synthesize optimiserOptions = mOptimiserOptions;
 #if 0
 - (void)setProgressDelegate:(id)aDelegate
 {
@@ -170,6 +172,7 @@ static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimula
 		NSAssert(array != nil, @"cannot initialise with a nil array");
 
 		mAlgorithm = s_Algorithm;
+		mOptimiserOptions = DKRouteOptimiserDefaultOptions();
 
 		// set the initial search direction - east is good when starting at top, left. Or set
 		// kDirectionAny to use non-directional NN algorithm (which is definitely not as good)
@@ -221,6 +224,22 @@ static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimula
 				mOrder[k] = k;
 			}
 		}
+
+		if ((mAlgorithm & kDKUseRouteOptimiser) != 0) {
+			mPoints = malloc(sizeof(NSPoint) * [array count]);
+
+			NSUInteger k = 0;
+
+			for (NSValue* val in array) {
+				if (strcmp([val objCType], @encode(NSPoint)) != 0) {
+					[NSException raise:NSInternalInconsistencyException
+								format:@"NSValue passed did not contain NSPoint"];
+					return nil;
+				}
+
+				mPoints[k++] = [val pointValue];
+			}
+		}
 	}
 
 	return self;
@@ -236,6 +255,9 @@ static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimula
 
 	if (mOrder)
 		free(mOrder);
+
+	if (mPoints)
+		free(mPoints);
 }
 
 - (void)notifyProgress:(CGFloat)value
@@ -410,6 +432,20 @@ static DKRouteAlgorithmType s_Algorithm = kDKUseNearestNeighbour; //kDKUseSimula
 			[self sortArrayUsingNearestNeighbour:mInput];
 			mPathLength = [self pathLengthOfArray:mVisited];
 		}
+
+		if ((mAlgorithm & kDKUseRouteOptimiser) != 0) {
+			NSUInteger k, n = [mInput count];
+			NSUInteger* order = malloc(sizeof(NSUInteger) * n);
+
+			mPathLength = DKRouteOptimiseOpenPath(mPoints, n, order, mOptimiserOptions, optimiserProgressCallback, (__bridge const void*)(self));
+
+			// mOrder is 1-based, as for the other algorithms
+
+			for (k = 0; k < n; ++k)
+				mOrder[k + 1] = order[k] + 1;
+
+			free(order);
+		}
 	}
 }
 
@@ -423,6 +459,14 @@ void progressCallback(CGFloat iteration, CGFloat maxIterations, const void* cont
 		[rf notifyProgress:iteration / maxIterations];
 }
 
+void optimiserProgressCallback(CGFloat progress, const void* context)
+{
+	DKRouteFinder* rf = (__bridge DKRouteFinder*)context;
+
+	if (rf != nil)
+		[rf notifyProgress:progress];
+}
+
 static DKDirection directionOfAngle(const CGFloat angle)
 {
 	// given an angle in radians, returns its basic direction.
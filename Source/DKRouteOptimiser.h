@@ -0,0 +1,44 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+#import "DKRandom.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** @brief Options for DKRouteOptimiseOpenPath().
+ */
+typedef struct {
+	NSUInteger neighbourCount; ///< how many nearest neighbours of each point are considered by the local search, at most 16
+	NSUInteger restarts; ///< how many perturbed copies of the route are re-optimised, in parallel, keeping the best. 0 for none.
+	DKRandomSeed seed; ///< seed for the perturbations. The result depends only on the points, the options and this seed.
+} DKRouteOptimiserOptions;
+
+/** @brief Returns the default options: 8 neighbours, no restarts and a fixed seed. */
+FOUNDATION_EXTERN DKRouteOptimiserOptions DKRouteOptimiserDefaultOptions(void);
+
+/** @brief A function called as the optimisation proceeds. <progress> is in the range 0..1. */
+typedef void (*DKRouteOptimiserProgressFunction)(CGFloat progress, const void* _Nullable context);
+
+/** @brief Finds a short open path through a set of points, starting at the first point.
+
+ This is intended for ordering large jobs, such as plotter or laser cutter moves, where the points number in the hundreds of thousands.
+ An initial route is built by visiting the nearest unvisited point each time, found with a k-d tree, and is then improved by 2-opt and
+ Or-opt moves between each point and its nearest neighbours until no improving move remains. Optional restarts perturb the route and
+ optimise it again on several threads.
+
+ The path is open - it does not return to the start - and the end point is free.
+ @param points the points
+ @param count the number of points
+ @param order receives the route as indexes into <points>, <count> of them. order[0] is always 0.
+ @param options the optimiser options
+ @param progress a function to call with progress, or NULL. It is only called on the calling thread.
+ @param context passed to <progress>
+ @return the length of the route
+ */
+FOUNDATION_EXTERN CGFloat DKRouteOptimiseOpenPath(const NSPoint* points, NSUInteger count, NSUInteger* order, DKRouteOptimiserOptions options, DKRouteOptimiserProgressFunction _Nullable progress, const void* _Nullable context);
+
+NS_ASSUME_NONNULL_END
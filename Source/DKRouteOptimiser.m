@@ -0,0 +1,723 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKRouteOptimiser.h"
+
+#define DK_ROUTE_DEFAULT_NEIGHBOURS 8
+#define DK_ROUTE_MAX_NEIGHBOURS 16
+#define DK_ROUTE_EPSILON 1e-9
+#define DK_ROUTE_PERTURB_WINDOW 30
+
+// the most elements that one move may reverse or shift. Up to about 100,000 points this is unlimited; beyond that it is limited so that the
+// cost of a move stays bounded, at some cost in the quality of the route.
+
+#define DK_ROUTE_MAX_SHIFT(n) MAX((NSUInteger)50000, (NSUInteger)(5000000000ULL / MAX((n), (NSUInteger)1)))
+
+DKRouteOptimiserOptions DKRouteOptimiserDefaultOptions(void)
+{
+	DKRouteOptimiserOptions options;
+
+	options.neighbourCount = DK_ROUTE_DEFAULT_NEIGHBOURS;
+	options.restarts = 0;
+	options.seed = 0x5EED5EED5EED5EEDULL;
+
+	return options;
+}
+
+#pragma mark - k-d tree
+
+// a k-d tree stored implicitly: each subtree occupies a contiguous range of <items>, with its root at the middle of the range.
+// Points can be removed, and each node counts the points remaining below it so that empty subtrees are skipped.
+
+typedef struct {
+	const double* x;
+	const double* y;
+	NSUInteger* items; // point indexes in tree order
+	uint8_t* axis; // split axis of the node at each slot, 0 = x, 1 = y
+	NSUInteger* live; // points not yet removed in the subtree rooted at each slot
+	NSUInteger* slotOf; // slot of each point
+	BOOL* removed;
+	NSUInteger count;
+} DKRouteTree;
+
+static inline double DKRouteCoord(const DKRouteTree* t, NSUInteger p, uint8_t axis)
+{
+	return axis ? t->y[p] : t->x[p];
+}
+
+// partially sorts items[lo..hi] (inclusive) so that the k'th is in its sorted place, smaller ones before it and larger ones after
+
+static void DKRouteTreeSelect(DKRouteTree* t, NSInteger lo, NSInteger hi, NSInteger k, uint8_t axis)
+{
+	NSUInteger* a = t->items;
+
+	while (hi > lo) {
+		double va = DKRouteCoord(t, a[lo], axis);
+		double vb = DKRouteCoord(t, a[lo + (hi - lo) / 2], axis);
+		double vc = DKRouteCoord(t, a[hi], axis);
+		double pivot = MAX(MIN(va, vb), MIN(MAX(va, vb), vc));
+
+		NSInteger i = lo, j = hi;
+
+		while (i <= j) {
+			while (DKRouteCoord(t, a[i], axis) < pivot)
+				++i;
+			while (DKRouteCoord(t, a[j], axis) > pivot)
+				--j;
+
+			if (i <= j) {
+				NSUInteger temp = a[i];
+				a[i++] = a[j];
+				a[j--] = temp;
+			}
+		}
+
+		if (k <= j)
+			hi = j;
+		else if (k >= i)
+			lo = i;
+		else
+			break;
+	}
+}
+
+static void DKRouteTreeBuild(DKRouteTree* t, NSUInteger lo, NSUInteger hi)
+{
+	if (lo >= hi)
+		return;
+
+	// split across the wider extent of the points in this range
+
+	double minX = HUGE_VAL, maxX = -HUGE_VAL, minY = HUGE_VAL, maxY = -HUGE_VAL;
+	NSUInteger i;
+
+	for (i = lo; i < hi; ++i) {
+		NSUInteger p = t->items[i];
+		minX = MIN(minX, t->x[p]);
+		maxX = MAX(maxX, t->x[p]);
+		minY = MIN(minY, t->y[p]);
+		maxY = MAX(maxY, t->y[p]);
+	}
+
+	uint8_t axis = (maxX - minX >= maxY - minY) ? 0 : 1;
+	NSUInteger mid = lo + (hi - lo) / 2;
+
+	DKRouteTreeSelect(t, (NSInteger)lo, (NSInteger)hi - 1, (NSInteger)mid, axis);
+
+	t->axis[mid] = axis;
+	t->live[mid] = hi - lo;
+	t->slotOf[t->items[mid]] = mid;
+
+	DKRouteTreeBuild(t, lo, mid);
+	DKRouteTreeBuild(t, mid + 1, hi);
+}
+
+static void DKRouteTreeRemove(DKRouteTree* t, NSUInteger p)
+{
+	NSUInteger slot = t->slotOf[p], lo = 0, hi = t->count;
+
+	t->removed[p] = YES;
+
+	while (lo < hi) {
+		NSUInteger mid = lo + (hi - lo) / 2;
+
+		t->live[mid]--;
+
+		if (slot == mid)
+			break;
+		else if (slot < mid)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+}
+
+// finds the nearest point not yet removed. Ties go to the lowest index so the result doesn't depend on the tree's layout.
+
+static void DKRouteTreeNearest(const DKRouteTree* t, NSUInteger lo, NSUInteger hi, double qx, double qy, NSUInteger* best, double* bestDist)
+{
+	if (lo >= hi)
+		return;
+
+	NSUInteger mid = lo + (hi - lo) / 2;
+
+	if (t->live[mid] == 0)
+		return;
+
+	NSUInteger p = t->items[mid];
+
+	if (!t->removed[p]) {
+		double dx = t->x[p] - qx, dy = t->y[p] - qy;
+		double d = dx * dx + dy * dy;
+
+		if (d < *bestDist || (d == *bestDist && p < *best)) {
+			*bestDist = d;
+			*best = p;
+		}
+	}
+
+	double diff = t->axis[mid] ? qy - t->y[p] : qx - t->x[p];
+
+	if (diff < 0) {
+		DKRouteTreeNearest(t, lo, mid, qx, qy, best, bestDist);
+
+		if (diff * diff <= *bestDist)
+			DKRouteTreeNearest(t, mid + 1, hi, qx, qy, best, bestDist);
+	} else {
+		DKRouteTreeNearest(t, mid + 1, hi, qx, qy, best, bestDist);
+
+		if (diff * diff <= *bestDist)
+			DKRouteTreeNearest(t, lo, mid, qx, qy, best, bestDist);
+	}
+}
+
+// finds the <k> nearest points to point <q>, other than <q> itself, in order of increasing distance
+
+static void DKRouteTreeKNearest(const DKRouteTree* t, NSUInteger lo, NSUInteger hi, NSUInteger q, NSUInteger k, NSUInteger* found, double* foundDist, NSUInteger* foundCount)
+{
+	if (lo >= hi)
+		return;
+
+	NSUInteger mid = lo + (hi - lo) / 2;
+	NSUInteger p = t->items[mid];
+	double qx = t->x[q], qy = t->y[q];
+
+	if (p != q) {
+		double dx = t->x[p] - qx, dy = t->y[p] - qy;
+		double d = dx * dx + dy * dy;
+
+		if (*foundCount < k || d < foundDist[*foundCount - 1]) {
+			NSUInteger i = MIN(*foundCount, k - 1);
+
+			while (i > 0 && foundDist[i - 1] > d) {
+				found[i] = found[i - 1];
+				foundDist[i] = foundDist[i - 1];
+				--i;
+			}
+
+			found[i] = p;
+			foundDist[i] = d;
+
+			if (*foundCount < k)
+				++(*foundCount);
+		}
+	}
+
+	double diff = t->axis[mid] ? qy - t->y[p] : qx - t->x[p];
+	NSUInteger nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+	NSUInteger farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+
+	DKRouteTreeKNearest(t, nearLo, nearHi, q, k, found, foundDist, foundCount);
+
+	if (*foundCount < k || diff * diff < foundDist[*foundCount - 1])
+		DKRouteTreeKNearest(t, farLo, farHi, q, k, found, foundDist, foundCount);
+}
+
+#pragma mark - local search
+
+typedef struct {
+	const double* x;
+	const double* y;
+	const NSUInteger* neighbours; // <k> per point, nearest first
+	NSUInteger k;
+	NSUInteger count;
+	NSUInteger maxShift;
+	NSUInteger* tour; // the route, as point indexes
+	NSUInteger* pos; // the position of each point in the route
+	NSUInteger* queue; // points still to be examined, circular
+	BOOL* queued;
+	NSUInteger queueHead;
+	NSUInteger queueCount;
+} DKRouteSearch;
+
+static inline double DKRouteDistance(const DKRouteSearch* s, NSUInteger a, NSUInteger b)
+{
+	return hypot(s->x[a] - s->x[b], s->y[a] - s->y[b]);
+}
+
+static inline void DKRoutePush(DKRouteSearch* s, NSUInteger p)
+{
+	if (p != NSNotFound && !s->queued[p]) {
+		s->queue[(s->queueHead + s->queueCount) % s->count] = p;
+		s->queueCount++;
+		s->queued[p] = YES;
+	}
+}
+
+static inline NSUInteger DKRouteAbsDiff(NSUInteger a, NSUInteger b)
+{
+	return a > b ? a - b : b - a;
+}
+
+static void DKRouteReverse(DKRouteSearch* s, NSUInteger first, NSUInteger last)
+{
+	while (first < last) {
+		NSUInteger a = s->tour[first], b = s->tour[last];
+
+		s->tour[first] = b;
+		s->pos[b] = first++;
+		s->tour[last] = a;
+		s->pos[a] = last--;
+	}
+}
+
+// moves the <len> points at position <i> to follow the point at position <t>, optionally reversing them
+
+static void DKRouteMoveSegment(DKRouteSearch* s, NSUInteger i, NSUInteger len, NSUInteger t, BOOL reversed)
+{
+	NSUInteger seg[3], k, dest;
+
+	for (k = 0; k < len; ++k)
+		seg[k] = s->tour[i + k];
+
+	if (t > i) {
+		memmove(&s->tour[i], &s->tour[i + len], (t - i - len + 1) * sizeof(NSUInteger));
+		dest = t - len + 1;
+
+		for (k = i; k < dest; ++k)
+			s->pos[s->tour[k]] = k;
+	} else {
+		memmove(&s->tour[t + 1 + len], &s->tour[t + 1], (i - t - 1) * sizeof(NSUInteger));
+		dest = t + 1;
+
+		for (k = dest + len; k < i + len; ++k)
+			s->pos[s->tour[k]] = k;
+	}
+
+	for (k = 0; k < len; ++k) {
+		NSUInteger p = seg[reversed ? len - 1 - k : k];
+		s->tour[dest + k] = p;
+		s->pos[p] = dest + k;
+	}
+}
+
+// 2-opt: replaces two edges with two shorter ones, one of which joins <a> to one of its neighbours, by reversing the route between them.
+// The first point of the route never moves.
+
+static BOOL DKRouteTryTwoOpt(DKRouteSearch* s, NSUInteger a)
+{
+	NSUInteger n = s->count, i = s->pos[a], m;
+	const NSUInteger* nb = &s->neighbours[a * s->k];
+
+	// joining <a> to <c>, and their successors to each other
+
+	if (i + 1 < n) {
+		NSUInteger sa = s->tour[i + 1];
+		double da = DKRouteDistance(s, a, sa);
+
+		for (m = 0; m < s->k; ++m) {
+			NSUInteger c = nb[m];
+			double dac = DKRouteDistance(s, a, c);
+
+			if (dac >= da)
+				break;
+
+			NSUInteger j = s->pos[c];
+
+			if (c == sa || DKRouteAbsDiff(i, j) > s->maxShift)
+				continue;
+
+			NSUInteger sc = (j + 1 < n) ? s->tour[j + 1] : NSNotFound;
+			double delta = da - dac;
+
+			if (sc != NSNotFound)
+				delta += DKRouteDistance(s, c, sc) - DKRouteDistance(s, sa, sc);
+
+			if (delta > DK_ROUTE_EPSILON) {
+				if (j > i)
+					DKRouteReverse(s, i + 1, j);
+				else
+					DKRouteReverse(s, j + 1, i);
+
+				DKRoutePush(s, a);
+				DKRoutePush(s, sa);
+				DKRoutePush(s, c);
+				DKRoutePush(s, sc);
+				return YES;
+			}
+		}
+	}
+
+	// joining <a> to <c>, and their predecessors to each other
+
+	if (i > 0) {
+		NSUInteger pa = s->tour[i - 1];
+		double da = DKRouteDistance(s, pa, a);
+
+		for (m = 0; m < s->k; ++m) {
+			NSUInteger c = nb[m];
+			double dac = DKRouteDistance(s, a, c);
+
+			if (dac >= da)
+				break;
+
+			NSUInteger j = s->pos[c];
+
+			if (j == 0 || c == pa || DKRouteAbsDiff(i, j) > s->maxShift)
+				continue;
+
+			NSUInteger pc = s->tour[j - 1];
+			double delta = da - dac + DKRouteDistance(s, pc, c) - DKRouteDistance(s, pa, pc);
+
+			if (delta > DK_ROUTE_EPSILON) {
+				if (j > i)
+					DKRouteReverse(s, i, j - 1);
+				else
+					DKRouteReverse(s, j, i - 1);
+
+				DKRoutePush(s, a);
+				DKRoutePush(s, pa);
+				DKRoutePush(s, c);
+				DKRoutePush(s, pc);
+				return YES;
+			}
+		}
+	}
+
+	return NO;
+}
+
+// Or-opt: moves a run of one to three points starting at <a> to lie next to a neighbour of one of its ends, either way round
+
+static BOOL DKRouteTryOrOpt(DKRouteSearch* s, NSUInteger a)
+{
+	NSUInteger n = s->count, i = s->pos[a], len, end, m;
+
+	if (i == 0)
+		return NO;
+
+	for (len = 1; len <= 3 && i + len <= n; ++len) {
+		NSUInteger s0 = a, sl = s->tour[i + len - 1], p = s->tour[i - 1];
+		NSUInteger q = (i + len < n) ? s->tour[i + len] : NSNotFound;
+		double removeGain = DKRouteDistance(s, p, s0);
+
+		if (q != NSNotFound)
+			removeGain += DKRouteDistance(s, sl, q) - DKRouteDistance(s, p, q);
+
+		if (removeGain <= DK_ROUTE_EPSILON)
+			continue;
+
+		for (end = 0; end < 2; ++end) {
+			NSUInteger e = end ? sl : s0, o = end ? s0 : sl;
+			const NSUInteger* nb = &s->neighbours[e * s->k];
+
+			for (m = 0; m < s->k; ++m) {
+				NSUInteger c = nb[m];
+				double dce = DKRouteDistance(s, c, e);
+
+				if (dce >= removeGain)
+					break;
+
+				NSUInteger j = s->pos[c];
+
+				if ((j >= i && j < i + len) || c == p || c == q || DKRouteAbsDiff(i, j) > s->maxShift)
+					continue;
+
+				// between <c> and its successor, with <e> next to <c>
+
+				NSUInteger cn = (j + 1 < n) ? s->tour[j + 1] : NSNotFound;
+				double add = dce;
+
+				if (cn != NSNotFound)
+					add += DKRouteDistance(s, o, cn) - DKRouteDistance(s, c, cn);
+
+				if (removeGain - add > DK_ROUTE_EPSILON) {
+					DKRouteMoveSegment(s, i, len, j, e != s0);
+					DKRoutePush(s, p);
+					DKRoutePush(s, q);
+					DKRoutePush(s, s0);
+					DKRoutePush(s, sl);
+					DKRoutePush(s, c);
+					DKRoutePush(s, cn);
+					return YES;
+				}
+
+				// between <c>'s predecessor and <c>, with <e> next to <c>. Nothing can go before the first point.
+
+				if (j > 0) {
+					NSUInteger cp = s->tour[j - 1];
+
+					add = DKRouteDistance(s, cp, o) + dce - DKRouteDistance(s, cp, c);
+
+					if (removeGain - add > DK_ROUTE_EPSILON) {
+						DKRouteMoveSegment(s, i, len, j - 1, o != s0);
+						DKRoutePush(s, p);
+						DKRoutePush(s, q);
+						DKRoutePush(s, s0);
+						DKRoutePush(s, sl);
+						DKRoutePush(s, c);
+						DKRoutePush(s, cp);
+						return YES;
+					}
+				}
+			}
+		}
+	}
+
+	return NO;
+}
+
+static void DKRouteLocalSearch(DKRouteSearch* s)
+{
+	while (s->queueCount > 0) {
+		NSUInteger a = s->queue[s->queueHead];
+
+		s->queueHead = (s->queueHead + 1) % s->count;
+		s->queueCount--;
+		s->queued[a] = NO;
+
+		if (DKRouteTryTwoOpt(s, a) || DKRouteTryOrOpt(s, a))
+			DKRoutePush(s, a);
+	}
+}
+
+static double DKRouteLength(const DKRouteSearch* s)
+{
+	double length = 0;
+	NSUInteger k;
+
+	for (k = 1; k < s->count; ++k)
+		length += DKRouteDistance(s, s->tour[k - 1], s->tour[k]);
+
+	return length;
+}
+
+// a double bridge kick within a small window of the route: the window's runs ABC become ACB
+
+static void DKRoutePerturb(DKRouteSearch* s, DKRandomStream* rs, NSUInteger* scratch)
+{
+	NSUInteger n = s->count;
+	NSUInteger w = MIN(n - 1, (NSUInteger)DK_ROUTE_PERTURB_WINDOW);
+	NSUInteger start = 1 + (NSUInteger)(DKRandomStreamNextValue(rs) * (n - w));
+	NSUInteger cut[3], k;
+
+	start = MIN(start, n - w);
+
+	do {
+		for (k = 0; k < 3; ++k)
+			cut[k] = 1 + (NSUInteger)(DKRandomStreamNextValue(rs) * (w - 1));
+	} while (cut[0] == cut[1] || cut[1] == cut[2] || cut[0] == cut[2]);
+
+	// sort the three cuts
+
+	if (cut[0] > cut[1]) {
+		k = cut[0];
+		cut[0] = cut[1];
+		cut[1] = k;
+	}
+	if (cut[1] > cut[2]) {
+		k = cut[1];
+		cut[1] = cut[2];
+		cut[2] = k;
+	}
+	if (cut[0] > cut[1]) {
+		k = cut[0];
+		cut[0] = cut[1];
+		cut[1] = k;
+	}
+
+	NSUInteger a = start + cut[0], b = start + cut[1], c = start + cut[2];
+	NSUInteger out = 0;
+
+	for (k = b; k < c; ++k)
+		scratch[out++] = s->tour[k];
+	for (k = a; k < b; ++k)
+		scratch[out++] = s->tour[k];
+
+	for (k = 0; k < out; ++k) {
+		s->tour[a + k] = scratch[k];
+		s->pos[scratch[k]] = a + k;
+	}
+
+	NSUInteger ends[] = { a - 1, a, a + (c - b) - 1, a + (c - b), c - 1, c };
+
+	for (k = 0; k < 6; ++k) {
+		if (ends[k] < n)
+			DKRoutePush(s, s->tour[ends[k]]);
+	}
+}
+
+#pragma mark - the optimiser
+
+CGFloat DKRouteOptimiseOpenPath(const NSPoint* points, NSUInteger count, NSUInteger* order, DKRouteOptimiserOptions options, DKRouteOptimiserProgressFunction progress, const void* context)
+{
+	NSCParameterAssert(points != NULL || count == 0);
+	NSCParameterAssert(order != NULL || count == 0);
+
+	if (count == 0)
+		return 0;
+
+	if (progress)
+		progress(0, context);
+
+	NSUInteger n = count, i;
+	NSUInteger k = MIN(MAX(options.neighbourCount, (NSUInteger)1), (NSUInteger)DK_ROUTE_MAX_NEIGHBOURS);
+
+	k = MIN(k, n - 1);
+
+	double* x = malloc(sizeof(double) * n);
+	double* y = malloc(sizeof(double) * n);
+
+	for (i = 0; i < n; ++i) {
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+	}
+
+	// build the tree
+
+	DKRouteTree tree;
+
+	tree.x = x;
+	tree.y = y;
+	tree.count = n;
+	tree.items = malloc(sizeof(NSUInteger) * n);
+	tree.axis = malloc(sizeof(uint8_t) * n);
+	tree.live = malloc(sizeof(NSUInteger) * n);
+	tree.slotOf = malloc(sizeof(NSUInteger) * n);
+	tree.removed = calloc(n, sizeof(BOOL));
+
+	for (i = 0; i < n; ++i)
+		tree.items[i] = i;
+
+	DKRouteTreeBuild(&tree, 0, n);
+
+	// each point's nearest neighbours, for the local search
+
+	NSUInteger* neighbours = malloc(sizeof(NSUInteger) * n * MAX(k, (NSUInteger)1));
+
+	if (k > 0) {
+		dispatch_apply(n, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t p) {
+			double dist[DK_ROUTE_MAX_NEIGHBOURS];
+			NSUInteger found = 0;
+
+			DKRouteTreeKNearest(&tree, 0, n, p, k, &neighbours[p * k], dist, &found);
+		});
+	}
+
+	// initial route by nearest neighbour, starting from the first point
+
+	NSUInteger* tour = malloc(sizeof(NSUInteger) * n);
+	NSUInteger* pos = malloc(sizeof(NSUInteger) * n);
+	NSUInteger current = 0;
+	NSUInteger progressStep = MAX(n / 20, (NSUInteger)1);
+
+	DKRouteTreeRemove(&tree, 0);
+	tour[0] = 0;
+
+	for (i = 1; i < n; ++i) {
+		NSUInteger best = NSNotFound;
+		double bestDist = HUGE_VAL;
+
+		DKRouteTreeNearest(&tree, 0, n, x[current], y[current], &best, &bestDist);
+		DKRouteTreeRemove(&tree, best);
+		tour[i] = current = best;
+
+		if (progress && (i % progressStep) == 0)
+			progress(0.4 * i / n, context);
+	}
+
+	for (i = 0; i < n; ++i)
+		pos[tour[i]] = i;
+
+	free(tree.items);
+	free(tree.axis);
+	free(tree.live);
+	free(tree.slotOf);
+	free(tree.removed);
+
+	// improve it until no move between neighbours helps
+
+	DKRouteSearch search;
+
+	search.x = x;
+	search.y = y;
+	search.neighbours = neighbours;
+	search.k = k;
+	search.count = n;
+	search.maxShift = DK_ROUTE_MAX_SHIFT(n);
+	search.tour = tour;
+	search.pos = pos;
+	search.queue = malloc(sizeof(NSUInteger) * n);
+	search.queued = calloc(n, sizeof(BOOL));
+	search.queueHead = 0;
+	search.queueCount = 0;
+
+	if (k > 0) {
+		for (i = 0; i < n; ++i)
+			DKRoutePush(&search, tour[i]);
+
+		DKRouteLocalSearch(&search);
+	}
+
+	double length = DKRouteLength(&search);
+
+	if (progress)
+		progress(0.8, context);
+
+	// restarts: each perturbs its own copy of the route and optimises it again. Each depends only on its own seed, so the result is the
+	// same however many threads run them.
+
+	if (options.restarts > 0 && n >= 8 && k > 0) {
+		NSUInteger restarts = options.restarts;
+		NSUInteger** tours = calloc(restarts, sizeof(NSUInteger*));
+		double* lengths = malloc(sizeof(double) * restarts);
+
+		dispatch_apply(restarts, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t r) {
+			DKRouteSearch rs = search;
+			DKRandomStream stream = DKRandomStreamMake(DKRandomDeriveSeed(options.seed, r));
+			NSUInteger scratch[DK_ROUTE_PERTURB_WINDOW];
+			NSUInteger kick, kicks = MAX(n / 100, (NSUInteger)1);
+
+			rs.tour = malloc(sizeof(NSUInteger) * n);
+			rs.pos = malloc(sizeof(NSUInteger) * n);
+			rs.queue = malloc(sizeof(NSUInteger) * n);
+			rs.queued = calloc(n, sizeof(BOOL));
+			rs.queueHead = rs.queueCount = 0;
+
+			memcpy(rs.tour, search.tour, sizeof(NSUInteger) * n);
+			memcpy(rs.pos, search.pos, sizeof(NSUInteger) * n);
+
+			for (kick = 0; kick < kicks; ++kick)
+				DKRoutePerturb(&rs, &stream, scratch);
+
+			DKRouteLocalSearch(&rs);
+
+			tours[r] = rs.tour;
+			lengths[r] = DKRouteLength(&rs);
+
+			free(rs.pos);
+			free(rs.queue);
+			free(rs.queued);
+		});
+
+		for (i = 0; i < restarts; ++i) {
+			if (lengths[i] < length - DK_ROUTE_EPSILON) {
+				length = lengths[i];
+				memcpy(tour, tours[i], sizeof(NSUInteger) * n);
+			}
+
+			free(tours[i]);
+		}
+
+		free(tours);
+		free(lengths);
+	}
+
+	memcpy(order, tour, sizeof(NSUInteger) * n);
+
+	free(search.queue);
+	free(search.queued);
+	free(tour);
+	free(pos);
+	free(neighbours);
+	free(x);
+	free(y);
+
+	if (progress)
+		progress(1.0, context);
+
+	return length;
+}
@@ -0,0 +1,70 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class DKDrawing;
+
+/** @brief Writes a drawing as an SVG document, streaming it out in a single pass.
+
+ The visible, printable object layers are written from the bottom up, each as a group titled with the layer's name, and their visible
+ objects in drawing order. Each object is written as a path of its rendering path, with groups nested as they are in the drawing. SVG's
+ y axis runs down, as a flipped drawing's does, so the content of a drawing that isn't flipped is wrapped in a group that turns it over.
+
+ Objects do not carry their appearance. Each distinct style is written once, as a CSS class, and every object drawn in that style refers
+ to it, so a drawing of many objects sharing a few styles costs little more than its geometry. Styles are told apart by identity first and
+ then by \c -isEquivalentToObject:, so equal styles that are not shared are still written once. A style with several fills and strokes
+ gets a class for each, and its objects define their path once and draw it once for each class. Gradients are written once each, in the
+ same way.
+
+ Output goes through a buffer of \c bufferSize bytes, and the path of each object is converted in a buffer that is reused, so memory use
+ does not grow with the drawing, only with the number of styles in it. As the styles are only all known at the end, the style sheet and
+ gradient definitions follow the content; they apply to the whole document wherever they are.
+
+ Fills and strokes are written with their colour, gradient, width, dash, caps, joins and mitre limit. Other renderers, such as hatches,
+ pattern fills, shadows and text, have no equivalent here and are left out, as are images and the clipping of group content.
+
+ An exporter is not thread safe, and the drawing must not change while it is being written.
+*/
+@interface DKSVGExporter : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/** @brief Creates an exporter for a drawing. */
+- (instancetype)initWithDrawing:(DKDrawing*)drawing NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, strong, readonly) DKDrawing* drawing;
+
+/** @brief The decimal places coordinates are rounded to. Default is 2, which is a hundredth of a point. */
+@property (nonatomic) NSUInteger precision;
+
+/** @brief The size in bytes of the buffer output is written through. Default is 64KB. */
+@property (nonatomic) NSUInteger bufferSize;
+
+/** @brief The number of objects, not counting groups, written by the last export. */
+@property (nonatomic, readonly) NSUInteger objectCount;
+
+/** @brief The number of distinct styles written by the last export. */
+@property (nonatomic, readonly) NSUInteger styleCount;
+
+/** @brief Writes the document to a stream, opening and closing it if it isn't already open.
+ @param stream the stream
+ @param error set to the stream's error if writing failed
+ @return YES if the whole document was written
+ */
+- (BOOL)writeToStream:(NSOutputStream*)stream error:(NSError**)error;
+
+/** @brief Writes the document to a file. */
+- (BOOL)writeToURL:(NSURL*)url error:(NSError**)error;
+
+/** @brief Returns the document, or nil if it couldn't be written. */
+- (nullable NSData*)SVGData;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,683 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKSVGExporter.h"
+#import "DKDrawing.h"
+#import "DKFill.h"
+#import "DKGradient.h"
+#import "DKObjectOwnerLayer.h"
+#import "DKSVGStream.h"
+#import "DKShapeGroup.h"
+#import "DKStroke.h"
+#import "DKStrokeDash.h"
+#import "DKStyle.h"
+#import "NSBezierPath+Geometry.h"
+
+#define kDKSVGDefaultPrecision 2
+#define kDKSVGDefaultBufferSize 65536
+#define kDKSVGOpacityPrecision 3
+#define kDKSVGTransformPrecision 6
+
+static NSString* DKSVGNumber(CGFloat value, unsigned precision)
+{
+	char text[kDKSVGNumberMaxLength];
+
+	DKSVGFormatNumber(value, precision, text);
+	return @(text);
+}
+
+/** @brief Gets a colour as SVG text and its alpha, returning NO if it has no sRGB equivalent, as for a pattern. */
+static BOOL DKSVGGetColor(NSColor* colour, char text[8], CGFloat* alpha)
+{
+	NSColor* rgb = [colour colorUsingColorSpace:[NSColorSpace sRGBColorSpace]];
+
+	if (rgb == nil)
+		return NO;
+
+	DKSVGFormatColor([rgb redComponent], [rgb greenComponent], [rgb blueComponent], text);
+	*alpha = [rgb alphaComponent];
+	return YES;
+}
+
+static bool DKSVGWriteToOutputStream(const char* bytes, size_t length, void* info)
+{
+	NSOutputStream* stream = (__bridge NSOutputStream*)info;
+
+	while (length > 0) {
+		NSInteger written = [stream write:(const uint8_t*)bytes
+								maxLength:length];
+
+		if (written <= 0)
+			return false;
+
+		bytes += written;
+		length -= (size_t)written;
+	}
+
+	return true;
+}
+
+#pragma mark -
+
+/** @brief A style or gradient that is written once, and the name objects refer to it by. */
+@interface DKSVGDefinition : NSObject
+
+@property (nonatomic, strong) id object;
+@property (nonatomic, copy) NSString* name;
+@property (nonatomic, copy) NSString* text; ///< the CSS rules of a style, or the element of a gradient
+@property (nonatomic) NSUInteger paintCount; ///< for a style, the number of fills and strokes written for each object
+
+@end
+
+@implementation DKSVGDefinition
+@end
+
+/** @brief Finds the definition of an object by identity, then by equivalence. */
+@interface DKSVGDefinitionTable : NSObject
+
+- (DKSVGDefinition*)definitionForObject:(id)object;
+- (void)addDefinition:(DKSVGDefinition*)definition;
+
+@property (nonatomic, readonly) NSArray<DKSVGDefinition*>* definitions;
+
+@end
+
+@implementation DKSVGDefinitionTable {
+	NSMapTable<id, DKSVGDefinition*>* mIdentities;
+	NSMutableDictionary<NSNumber*, NSMutableArray<DKSVGDefinition*>*>* mEquivalents;
+	NSMutableArray<DKSVGDefinition*>* mDefinitions;
+}
+
+@synthesize definitions = mDefinitions;
+
+- (instancetype)init
+{
+	if (self = [super init]) {
+		mIdentities = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+											valueOptions:NSPointerFunctionsStrongMemory];
+		mEquivalents = [NSMutableDictionary dictionary];
+		mDefinitions = [NSMutableArray array];
+	}
+
+	return self;
+}
+
+- (DKSVGDefinition*)definitionForObject:(id)object
+{
+	DKSVGDefinition* definition = [mIdentities objectForKey:object];
+
+	if (definition)
+		return definition;
+
+	for (DKSVGDefinition* candidate in mEquivalents[@([object equivalenceHash])]) {
+		if ([[candidate object] isEquivalentToObject:object]) {
+			[mIdentities setObject:candidate
+							forKey:object];
+			return candidate;
+		}
+	}
+
+	return nil;
+}
+
+- (void)addDefinition:(DKSVGDefinition*)definition
+{
+	id object = [definition object];
+	NSNumber* hash = @([object equivalenceHash]);
+	NSMutableArray<DKSVGDefinition*>* bucket = mEquivalents[hash];
+
+	if (bucket == nil) {
+		bucket = [NSMutableArray array];
+		mEquivalents[hash] = bucket;
+	}
+
+	[bucket addObject:definition];
+	[mDefinitions addObject:definition];
+	[mIdentities setObject:definition
+					forKey:object];
+}
+
+@end
+
+#pragma mark -
+
+@interface DKSVGExporter ()
+
+- (BOOL)writeWithFunction:(DKSVGWriteFunction)function info:(void*)info;
+- (void)writeHeader;
+- (void)writeLayer:(DKObjectOwnerLayer*)layer;
+- (void)writeObject:(DKDrawableObject*)object;
+- (void)writeGroup:(DKShapeGroup*)group;
+- (void)writeDefinitions;
+
+- (DKSVGDefinition*)definitionForStyle:(DKStyle*)style;
+- (void)addPaintsOfGroup:(DKRastGroup*)group to:(NSMutableArray<NSString*>*)paints;
+- (NSString*)paintForFill:(DKFill*)fill;
+- (NSString*)paintForStroke:(DKStroke*)stroke;
+- (NSString*)paint:(NSString*)property colour:(NSColor*)colour;
+- (NSString*)nameForGradient:(DKGradient*)gradient;
+
+@end
+
+@implementation DKSVGExporter {
+	DKSVGStream mStream;
+	DKPathBuffer mPath;
+	DKSVGDefinitionTable* mStyles;
+	DKSVGDefinitionTable* mGradients;
+	NSUInteger mStylesNamed;
+}
+
+@synthesize drawing = mDrawing;
+@synthesize precision = mPrecision;
+@synthesize bufferSize = mBufferSize;
+@synthesize objectCount = mObjectCount;
+@synthesize styleCount = mStyleCount;
+
+- (instancetype)initWithDrawing:(DKDrawing*)drawing
+{
+	NSParameterAssert(drawing != nil);
+
+	if (self = [super init]) {
+		mDrawing = drawing;
+		mPrecision = kDKSVGDefaultPrecision;
+		mBufferSize = kDKSVGDefaultBufferSize;
+	}
+
+	return self;
+}
+
+- (void)setPrecision:(NSUInteger)precision
+{
+	mPrecision = MIN(precision, (NSUInteger)kDKSVGMaximumPrecision);
+}
+
+#pragma mark -
+
+- (BOOL)writeToStream:(NSOutputStream*)stream error:(NSError**)error
+{
+	NSParameterAssert(stream != nil);
+
+	BOOL opens = [stream streamStatus] == NSStreamStatusNotOpen;
+
+	if (opens)
+		[stream open];
+
+	BOOL written = [stream streamStatus] != NSStreamStatusError
+		&& [self writeWithFunction:DKSVGWriteToOutputStream
+							  info:(__bridge void*)stream];
+
+	if (!written && error)
+		*error = [stream streamError] ?: [NSError errorWithDomain:NSCocoaErrorDomain
+															 code:NSFileWriteUnknownError
+														 userInfo:nil];
+
+	if (opens)
+		[stream close];
+
+	return written;
+}
+
+- (BOOL)writeToURL:(NSURL*)url error:(NSError**)error
+{
+	NSOutputStream* stream = [NSOutputStream outputStreamWithURL:url
+														  append:NO];
+
+	if (stream == nil) {
+		if (error)
+			*error = [NSError errorWithDomain:NSCocoaErrorDomain
+										 code:NSFileWriteUnknownError
+									 userInfo:@{ NSURLErrorKey : url }];
+		return NO;
+	}
+
+	return [self writeToStream:stream
+						 error:error];
+}
+
+- (NSData*)SVGData
+{
+	NSOutputStream* stream = [NSOutputStream outputStreamToMemory];
+
+	[stream open];
+
+	NSData* data = nil;
+
+	if ([self writeToStream:stream error:NULL])
+		data = [stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey];
+
+	[stream close];
+	return data;
+}
+
+#pragma mark -
+
+- (BOOL)writeWithFunction:(DKSVGWriteFunction)function info:(void*)info
+{
+	mObjectCount = 0;
+	mStyleCount = 0;
+	mStylesNamed = 0;
+
+	if (!DKSVGStreamInit(&mStream, mBufferSize, (unsigned)mPrecision, function, info)) {
+		DKSVGStreamFree(&mStream);
+		return NO;
+	}
+
+	DKPathBufferInit(&mPath);
+	mStyles = [[DKSVGDefinitionTable alloc] init];
+	mGradients = [[DKSVGDefinitionTable alloc] init];
+
+	[self writeHeader];
+
+	// SVG's y axis runs down the page, as a flipped drawing's does. The content of a drawing that isn't flipped is turned over to match.
+
+	BOOL flip = ![mDrawing isFlipped];
+
+	if (flip) {
+		DKSVGStreamAppendString(&mStream, "<g transform=\"matrix(1 0 0 -1 0 ");
+		DKSVGStreamAppendNumber(&mStream, [mDrawing drawingSize].height);
+		DKSVGStreamAppendString(&mStream, ")\">\n");
+	}
+
+	// layer 0 is the top one, so layers are written in reverse to paint from the bottom up
+
+	for (DKLayer* layer in [[mDrawing flattenedLayers] reverseObjectEnumerator]) {
+		if (mStream.failed)
+			break;
+
+		if ([layer isKindOfClass:[DKObjectOwnerLayer class]] && [layer visible] && [layer shouldDrawToPrinter])
+			[self writeLayer:(DKObjectOwnerLayer*)layer];
+	}
+
+	if (flip)
+		DKSVGStreamAppendString(&mStream, "</g>\n");
+
+	[self writeDefinitions];
+	DKSVGStreamAppendString(&mStream, "</svg>\n");
+
+	BOOL written = DKSVGStreamFlush(&mStream);
+
+	mStyleCount = mStylesNamed;
+	mStyles = nil;
+	mGradients = nil;
+	DKPathBufferFree(&mPath);
+	DKSVGStreamFree(&mStream);
+
+	return written;
+}
+
+- (void)writeHeader
+{
+	NSSize size = [mDrawing drawingSize];
+
+	DKSVGStreamAppendString(&mStream, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+									  "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"");
+	DKSVGStreamAppendNumber(&mStream, size.width);
+	DKSVGStreamAppendString(&mStream, "\" height=\"");
+	DKSVGStreamAppendNumber(&mStream, size.height);
+	DKSVGStreamAppendString(&mStream, "\" viewBox=\"0 0 ");
+	DKSVGStreamAppendNumber(&mStream, size.width);
+	DKSVGStreamAppendString(&mStream, " ");
+	DKSVGStreamAppendNumber(&mStream, size.height);
+	DKSVGStreamAppendString(&mStream, "\">\n");
+
+	char colour[8];
+	CGFloat alpha;
+
+	if ([mDrawing paperColourIsPrinted] && [mDrawing paperColour] && DKSVGGetColor([mDrawing paperColour], colour, &alpha) && alpha > 0) {
+		DKSVGStreamAppendString(&mStream, "<rect width=\"100%\" height=\"100%\" fill=\"");
+		DKSVGStreamAppendString(&mStream, colour);
+
+		if (alpha < 1) {
+			DKSVGStreamAppendString(&mStream, "\" fill-opacity=\"");
+			DKSVGStreamAppendNumberWithPrecision(&mStream, alpha, kDKSVGOpacityPrecision);
+		}
+
+		DKSVGStreamAppendString(&mStream, "\"/>\n");
+	}
+}
+
+- (void)writeLayer:(DKObjectOwnerLayer*)layer
+{
+	DKSVGStreamAppendString(&mStream, "<g>\n<title>");
+	DKSVGStreamAppendEscaped(&mStream, [[layer layerName] UTF8String] ?: "");
+	DKSVGStreamAppendString(&mStream, "</title>\n");
+
+	// the storage's own array is walked, in drawing order, rather than a copy of it
+
+	for (DKDrawableObject* object in [[layer storage] objects]) {
+		if (mStream.failed)
+			break;
+
+		@autoreleasepool {
+			[self writeObject:object];
+		}
+	}
+
+	DKSVGStreamAppendString(&mStream, "</g>\n");
+}
+
+- (void)writeObject:(DKDrawableObject*)object
+{
+	if (![object visible])
+		return;
+
+	if ([object isKindOfClass:[DKShapeGroup class]]) {
+		[self writeGroup:(DKShapeGroup*)object];
+		return;
+	}
+
+	DKStyle* style = [object style];
+
+	if (style == nil)
+		return;
+
+	DKSVGDefinition* definition = [self definitionForStyle:style];
+	NSUInteger paintCount = [definition paintCount];
+
+	if (paintCount == 0)
+		return;
+
+	NSBezierPath* path = [object renderingPath];
+
+	if (path == nil || [path isEmpty])
+		return;
+
+	DKPathBufferClear(&mPath);
+	[path appendElementsToPathBuffer:&mPath];
+
+	if (mPath.failed) {
+		mStream.failed = true;
+		return;
+	}
+
+	const char* name = [[definition name] UTF8String];
+	const char* fillRule = [path windingRule] == NSEvenOddWindingRule ? " fill-rule=\"evenodd\"" : "";
+	char identifier[32] = "";
+
+	++mObjectCount;
+
+	// an object drawn by one fill or stroke is a path of that class. One drawn by several defines its path once, with no style of its own
+	// so that it inherits each class in turn, and uses it once for each
+
+	if (paintCount == 1) {
+		DKSVGStreamAppendString(&mStream, "<path class=\"");
+		DKSVGStreamAppendString(&mStream, name);
+		DKSVGStreamAppendString(&mStream, "\"");
+	} else {
+		snprintf(identifier, sizeof(identifier), "o%lu", (unsigned long)mObjectCount);
+		DKSVGStreamAppendString(&mStream, "<defs><path id=\"");
+		DKSVGStreamAppendString(&mStream, identifier);
+		DKSVGStreamAppendString(&mStream, "\"");
+	}
+
+	DKSVGStreamAppendString(&mStream, fillRule);
+	DKSVGStreamAppendString(&mStream, " d=\"");
+	DKSVGStreamBeginPath(&mStream);
+	DKSVGStreamAppendPathBuffer(&mStream, &mPath);
+	DKSVGStreamAppendString(&mStream, "\"/>");
+
+	if (paintCount > 1) {
+		DKSVGStreamAppendString(&mStream, "</defs>");
+
+		for (NSUInteger i = 0; i < paintCount; ++i) {
+			char suffix[24] = "";
+
+			if (i > 0)
+				snprintf(suffix, sizeof(suffix), "-%lu", (unsigned long)i);
+
+			DKSVGStreamAppendString(&mStream, "<use xlink:href=\"#");
+			DKSVGStreamAppendString(&mStream, identifier);
+			DKSVGStreamAppendString(&mStream, "\" class=\"");
+			DKSVGStreamAppendString(&mStream, name);
+			DKSVGStreamAppendString(&mStream, suffix);
+			DKSVGStreamAppendString(&mStream, "\"/>");
+		}
+	}
+
+	DKSVGStreamAppendString(&mStream, "\n");
+}
+
+- (void)writeGroup:(DKShapeGroup*)group
+{
+	// when a group transforms visually, its objects' paths are in the group's own space, and the group transforms them when drawing
+
+	if ([group transformsVisually]) {
+		NSAffineTransformStruct t = [[group contentTransform] transformStruct];
+
+		DKSVGStreamAppendString(&mStream, "<g transform=\"matrix(");
+		DKSVGStreamAppendNumberWithPrecision(&mStream, t.m11, kDKSVGTransformPrecision);
+		DKSVGStreamAppendString(&mStream, " ");
+		DKSVGStreamAppendNumberWithPrecision(&mStream, t.m12, kDKSVGTransformPrecision);
+		DKSVGStreamAppendString(&mStream, " ");
+		DKSVGStreamAppendNumberWithPrecision(&mStream, t.m21, kDKSVGTransformPrecision);
+		DKSVGStreamAppendString(&mStream, " ");
+		DKSVGStreamAppendNumberWithPrecision(&mStream, t.m22, kDKSVGTransformPrecision);
+		DKSVGStreamAppendString(&mStream, " ");
+		DKSVGStreamAppendNumber(&mStream, t.tX);
+		DKSVGStreamAppendString(&mStream, " ");
+		DKSVGStreamAppendNumber(&mStream, t.tY);
+		DKSVGStreamAppendString(&mStream, ")\">\n");
+	} else
+		DKSVGStreamAppendString(&mStream, "<g>\n");
+
+	for (DKDrawableObject* object in [group groupObjects])
+		[self writeObject:object];
+
+	DKSVGStreamAppendString(&mStream, "</g>\n");
+}
+
+- (void)writeDefinitions
+{
+	NSArray<DKSVGDefinition*>* styles = [mStyles definitions];
+	NSArray<DKSVGDefinition*>* gradients = [mGradients definitions];
+
+	if ([styles count] > 0) {
+		DKSVGStreamAppendString(&mStream, "<style>\n");
+
+		for (DKSVGDefinition* definition in styles)
+			DKSVGStreamAppendString(&mStream, [[definition text] UTF8String]);
+
+		DKSVGStreamAppendString(&mStream, "</style>\n");
+	}
+
+	if ([gradients count] > 0) {
+		DKSVGStreamAppendString(&mStream, "<defs>\n");
+
+		for (DKSVGDefinition* definition in gradients)
+			DKSVGStreamAppendString(&mStream, [[definition text] UTF8String]);
+
+		DKSVGStreamAppendString(&mStream, "</defs>\n");
+	}
+}
+
+#pragma mark -
+
+- (DKSVGDefinition*)definitionForStyle:(DKStyle*)style
+{
+	DKSVGDefinition* definition = [mStyles definitionForObject:style];
+
+	if (definition)
+		return definition;
+
+	NSMutableArray<NSString*>* paints = [NSMutableArray array];
+	NSMutableString* text = [NSMutableString string];
+
+	[self addPaintsOfGroup:style
+						to:paints];
+
+	// a style that draws nothing is remembered so that its objects are skipped quickly, but isn't given a name
+
+	NSString* name = [paints count] > 0 ? [NSString stringWithFormat:@"s%lu", (unsigned long)++mStylesNamed] : @"";
+
+	[paints enumerateObjectsUsingBlock:^(NSString* paint, NSUInteger i, BOOL* stop) {
+		if (i == 0)
+			[text appendFormat:@".%@{%@}\n", name, paint];
+		else
+			[text appendFormat:@".%@-%lu{%@}\n", name, (unsigned long)i, paint];
+	}];
+
+	definition = [[DKSVGDefinition alloc] init];
+	[definition setObject:style];
+	[definition setName:name];
+	[definition setText:text];
+	[definition setPaintCount:[paints count]];
+
+	[mStyles addDefinition:definition];
+	return definition;
+}
+
+- (void)addPaintsOfGroup:(DKRastGroup*)group to:(NSMutableArray<NSString*>*)paints
+{
+	// renderers are drawn in list order, so the first is the bottom one
+
+	for (DKRasterizer* renderer in [group renderList]) {
+		if (![renderer enabled])
+			continue;
+
+		NSString* paint = nil;
+
+		if ([renderer isKindOfClass:[DKRastGroup class]])
+			[self addPaintsOfGroup:(DKRastGroup*)renderer
+								to:paints];
+		else if ([renderer isKindOfClass:[DKFill class]])
+			paint = [self paintForFill:(DKFill*)renderer];
+		else if ([renderer isKindOfClass:[DKStroke class]])
+			paint = [self paintForStroke:(DKStroke*)renderer];
+
+		if (paint)
+			[paints addObject:paint];
+	}
+}
+
+- (NSString*)paintForFill:(DKFill*)fill
+{
+	DKGradient* gradient = [fill gradient];
+
+	// a swept angle gradient has no SVG equivalent, so the fill falls back to its colour
+
+	if (gradient && [gradient gradientType] != kDKGradientTypeSweptAngle && [gradient countOfColorStops] > 0)
+		return [NSString stringWithFormat:@"fill:url(#%@)", [self nameForGradient:gradient]];
+
+	return [self paint:@"fill"
+				colour:[fill colour]];
+}
+
+- (NSString*)paintForStroke:(DKStroke*)stroke
+{
+	NSString* colour = [self paint:@"stroke"
+							colour:[stroke colour]];
+
+	if (colour == nil)
+		return nil;
+
+	unsigned precision = (unsigned)mPrecision;
+	CGFloat width = [stroke width];
+	NSMutableString* paint = [NSMutableString stringWithFormat:@"fill:none;%@", colour];
+
+	if (width != 1.0)
+		[paint appendFormat:@";stroke-width:%@", DKSVGNumber(width, precision)];
+
+	if ([stroke lineCapStyle] == NSRoundLineCapStyle)
+		[paint appendString:@";stroke-linecap:round"];
+	else if ([stroke lineCapStyle] == NSSquareLineCapStyle)
+		[paint appendString:@";stroke-linecap:square"];
+
+	if ([stroke lineJoinStyle] == NSRoundLineJoinStyle)
+		[paint appendString:@";stroke-linejoin:round"];
+	else if ([stroke lineJoinStyle] == NSBevelLineJoinStyle)
+		[paint appendString:@";stroke-linejoin:bevel"];
+	else if ([stroke miterLimit] != 4.0)
+		[paint appendFormat:@";stroke-miterlimit:%@", DKSVGNumber(MAX(1.0, [stroke miterLimit]), precision)];
+
+	DKStrokeDash* dash = [stroke dash];
+
+	if (dash) {
+		CGFloat pattern[8];
+		NSInteger count = 0;
+		CGFloat scale = [dash scalesToLineWidth] ? width : 1.0;
+
+		[dash getDashPattern:pattern
+					   count:&count];
+
+		if (count > 0) {
+			[paint appendString:@";stroke-dasharray:"];
+
+			for (NSInteger i = 0; i < count; ++i)
+				[paint appendFormat:i > 0 ? @",%@" : @"%@", DKSVGNumber(pattern[i] * scale, precision)];
+
+			// as when the dash is applied to a path, the pattern is offset backwards by the phase
+
+			if ([dash phase] != 0.0)
+				[paint appendFormat:@";stroke-dashoffset:%@", DKSVGNumber(-[dash phase] * scale, precision)];
+		}
+	}
+
+	return paint;
+}
+
+- (NSString*)paint:(NSString*)property colour:(NSColor*)colour
+{
+	char text[8];
+	CGFloat alpha;
+
+	if (colour == nil || !DKSVGGetColor(colour, text, &alpha) || alpha <= 0)
+		return nil;
+
+	if (alpha < 1.0)
+		return [NSString stringWithFormat:@"%@:%s;%@-opacity:%@", property, text, property, DKSVGNumber(alpha, kDKSVGOpacityPrecision)];
+
+	return [NSString stringWithFormat:@"%@:%s", property, text];
+}
+
+- (NSString*)nameForGradient:(DKGradient*)gradient
+{
+	DKSVGDefinition* definition = [mGradients definitionForObject:gradient];
+
+	if (definition)
+		return [definition name];
+
+	NSString* name = [NSString stringWithFormat:@"g%lu", (unsigned long)[[mGradients definitions] count] + 1];
+	BOOL radial = [gradient gradientType] == kDKGradientTypeRadial;
+	NSString* element = radial ? @"radialGradient" : @"linearGradient";
+	NSMutableString* text = [NSMutableString stringWithFormat:@"<%@ id=\"%@\"", element, name];
+
+	// gradients are sized to each object's bounds, and a linear one is turned about their centre
+
+	if (!radial && [gradient angle] != 0.0)
+		[text appendFormat:@" gradientTransform=\"rotate(%@ .5 .5)\"", DKSVGNumber([gradient angleInDegrees], kDKSVGOpacityPrecision)];
+
+	[text appendString:@">"];
+
+	NSArray<DKColorStop*>* stops = [[gradient colorStops] sortedArrayUsingComparator:^NSComparisonResult(DKColorStop* a, DKColorStop* b) {
+		return [@([a position]) compare:@([b position])];
+	}];
+
+	for (DKColorStop* stop in stops) {
+		char colour[8] = "#000";
+		CGFloat alpha = 1.0;
+
+		DKSVGGetColor([stop color], colour, &alpha);
+
+		[text appendFormat:@"<stop offset=\"%@\" stop-color=\"%s\"", DKSVGNumber(MIN(1.0, MAX(0.0, [stop position])), kDKSVGOpacityPrecision), colour];
+
+		if (alpha < 1.0)
+			[text appendFormat:@" stop-opacity=\"%@\"", DKSVGNumber(alpha, kDKSVGOpacityPrecision)];
+
+		[text appendString:@"/>"];
+	}
+
+	[text appendFormat:@"</%@>\n", element];
+
+	definition = [[DKSVGDefinition alloc] init];
+	[definition setObject:gradient];
+	[definition setName:name];
+	[definition setText:text];
+
+	[mGradients addDefinition:definition];
+	return name;
+}
+
+@end
@@ -0,0 +1,374 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#include "DKSVGStream.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define kDKSVGStreamMinimumCapacity 256
+#define kDKSVGLargestNumber 1e15
+
+static const double kDKSVGPowersOfTen[kDKSVGMaximumPrecision + 1] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8 };
+
+bool DKSVGStreamInit(DKSVGStream* stream, size_t capacity, unsigned precision, DKSVGWriteFunction write, void* info)
+{
+	memset(stream, 0, sizeof(DKSVGStream));
+
+	if (capacity < kDKSVGStreamMinimumCapacity)
+		capacity = kDKSVGStreamMinimumCapacity;
+
+	stream->buffer = malloc(capacity);
+	stream->capacity = stream->buffer ? capacity : 0;
+	stream->write = write;
+	stream->info = info;
+	stream->precision = precision > kDKSVGMaximumPrecision ? kDKSVGMaximumPrecision : precision;
+	stream->failed = stream->buffer == NULL;
+
+	DKSVGStreamBeginPath(stream);
+	return !stream->failed;
+}
+
+void DKSVGStreamFree(DKSVGStream* stream)
+{
+	free(stream->buffer);
+	stream->buffer = NULL;
+	stream->capacity = 0;
+	stream->length = 0;
+}
+
+static void DKSVGStreamWrite(DKSVGStream* stream, const char* bytes, size_t length)
+{
+	if (length == 0 || stream->failed)
+		return;
+
+	if (stream->write == NULL || !stream->write(bytes, length, stream->info))
+		stream->failed = true;
+	else
+		stream->bytesWritten += length;
+}
+
+bool DKSVGStreamFlush(DKSVGStream* stream)
+{
+	DKSVGStreamWrite(stream, stream->buffer, stream->length);
+	stream->length = 0;
+	return !stream->failed;
+}
+
+size_t DKSVGFormatNumber(double value, unsigned precision, char* text)
+{
+	if (precision > kDKSVGMaximumPrecision)
+		precision = kDKSVGMaximumPrecision;
+
+	if (!isfinite(value))
+		value = 0;
+
+	bool negative = value < 0;
+	double magnitude = fmin(fabs(value), kDKSVGLargestNumber);
+
+	// the whole and fractional parts are rounded separately so that neither overflows, carrying if the fraction rounds up to 1
+
+	double whole = floor(magnitude);
+	int64_t integer = (int64_t)whole;
+	int64_t scale = (int64_t)kDKSVGPowersOfTen[precision];
+	int64_t fraction = (int64_t)llround((magnitude - whole) * kDKSVGPowersOfTen[precision]);
+
+	if (fraction >= scale) {
+		integer += 1;
+		fraction -= scale;
+	}
+
+	size_t length = 0;
+
+	if (integer == 0 && fraction == 0) {
+		text[length++] = '0';
+		text[length] = 0;
+		return length;
+	}
+
+	if (negative)
+		text[length++] = '-';
+
+	if (integer > 0) {
+		char digits[20];
+		size_t count = 0;
+
+		while (integer > 0) {
+			digits[count++] = (char)('0' + integer % 10);
+			integer /= 10;
+		}
+
+		while (count > 0)
+			text[length++] = digits[--count];
+	}
+
+	if (fraction > 0) {
+		// trailing zeros are dropped by dropping the places they would take
+
+		unsigned places = precision;
+
+		while (fraction % 10 == 0) {
+			fraction /= 10;
+			places--;
+		}
+
+		text[length++] = '.';
+
+		for (unsigned i = places; i > 0; --i) {
+			text[length + i - 1] = (char)('0' + fraction % 10);
+			fraction /= 10;
+		}
+
+		length += places;
+	}
+
+	text[length] = 0;
+	return length;
+}
+
+#pragma mark -
+
+void DKSVGStreamAppendBytes(DKSVGStream* stream, const char* bytes, size_t length)
+{
+	if (stream->failed || length == 0)
+		return;
+
+	if (length > stream->capacity - stream->length) {
+		DKSVGStreamFlush(stream);
+
+		// anything too large for the buffer goes straight through
+
+		if (length >= stream->capacity) {
+			DKSVGStreamWrite(stream, bytes, length);
+			return;
+		}
+	}
+
+	memcpy(stream->buffer + stream->length, bytes, length);
+	stream->length += length;
+}
+
+void DKSVGStreamAppendString(DKSVGStream* stream, const char* string)
+{
+	DKSVGStreamAppendBytes(stream, string, strlen(string));
+}
+
+void DKSVGStreamAppendEscaped(DKSVGStream* stream, const char* string)
+{
+	const char* run = string;
+	const char* p;
+
+	for (p = string; *p; ++p) {
+		unsigned char c = (unsigned char)*p;
+		const char* entity = NULL;
+
+		switch (c) {
+		case '&':
+			entity = "&amp;";
+			break;
+		case '<':
+			entity = "&lt;";
+			break;
+		case '>':
+			entity = "&gt;";
+			break;
+		case '"':
+			entity = "&quot;";
+			break;
+		case '\t':
+		case '\n':
+		case '\r':
+			continue;
+		default:
+			if (c >= 0x20)
+				continue;
+			entity = "";
+			break;
+		}
+
+		DKSVGStreamAppendBytes(stream, run, (size_t)(p - run));
+		DKSVGStreamAppendString(stream, entity);
+		run = p + 1;
+	}
+
+	DKSVGStreamAppendBytes(stream, run, (size_t)(p - run));
+}
+
+void DKSVGStreamAppendNumber(DKSVGStream* stream, double value)
+{
+	DKSVGStreamAppendNumberWithPrecision(stream, value, stream->precision);
+}
+
+void DKSVGStreamAppendNumberWithPrecision(DKSVGStream* stream, double value, unsigned precision)
+{
+	char text[kDKSVGNumberMaxLength];
+	size_t length = DKSVGFormatNumber(value, precision, text);
+
+	DKSVGStreamAppendBytes(stream, text, length);
+}
+
+static unsigned DKSVGColorComponent(double value)
+{
+	if (!(value > 0))
+		return 0;
+
+	return value >= 1 ? 255 : (unsigned)lround(value * 255);
+}
+
+size_t DKSVGFormatColor(double red, double green, double blue, char* text)
+{
+	static const char hex[] = "0123456789abcdef";
+	unsigned components[3] = { DKSVGColorComponent(red), DKSVGColorComponent(green), DKSVGColorComponent(blue) };
+	bool shortForm = true;
+	size_t length = 0;
+
+	for (int i = 0; i < 3; ++i)
+		shortForm = shortForm && (components[i] >> 4) == (components[i] & 15);
+
+	text[length++] = '#';
+
+	for (int i = 0; i < 3; ++i) {
+		if (!shortForm)
+			text[length++] = hex[components[i] >> 4];
+		text[length++] = hex[components[i] & 15];
+	}
+
+	text[length] = 0;
+	return length;
+}
+
+void DKSVGStreamAppendColor(DKSVGStream* stream, double red, double green, double blue)
+{
+	char text[8];
+	size_t length = DKSVGFormatColor(red, green, blue, text);
+
+	DKSVGStreamAppendBytes(stream, text, length);
+}
+
+#pragma mark - path data
+
+void DKSVGStreamBeginPath(DKSVGStream* stream)
+{
+	stream->command = 0;
+	stream->separate = false;
+	stream->pointInLast = false;
+	strcpy(stream->currentX, "0");
+	strcpy(stream->currentY, "0");
+	strcpy(stream->startX, "0");
+	strcpy(stream->startY, "0");
+}
+
+static void DKSVGStreamCommand(DKSVGStream* stream, char command)
+{
+	// a repeated moveto would be read as a lineto, and a close takes no numbers, so only the others can be repeated implicitly
+
+	if (command == stream->command && command != 'M' && command != 'Z')
+		return;
+
+	DKSVGStreamAppendBytes(stream, &command, 1);
+	stream->command = command;
+	stream->separate = false;
+}
+
+static void DKSVGStreamPathNumber(DKSVGStream* stream, const char* text)
+{
+	size_t length = strlen(text);
+
+	if (stream->separate && !(text[0] == '-' || (text[0] == '.' && stream->pointInLast)))
+		DKSVGStreamAppendBytes(stream, " ", 1);
+
+	DKSVGStreamAppendBytes(stream, text, length);
+	stream->pointInLast = memchr(text, '.', length) != NULL;
+	stream->separate = true;
+}
+
+void DKSVGStreamMoveTo(DKSVGStream* stream, double x, double y)
+{
+	DKSVGFormatNumber(x, stream->precision, stream->currentX);
+	DKSVGFormatNumber(y, stream->precision, stream->currentY);
+	strcpy(stream->startX, stream->currentX);
+	strcpy(stream->startY, stream->currentY);
+
+	DKSVGStreamCommand(stream, 'M');
+	DKSVGStreamPathNumber(stream, stream->currentX);
+	DKSVGStreamPathNumber(stream, stream->currentY);
+}
+
+void DKSVGStreamLineTo(DKSVGStream* stream, double x, double y)
+{
+	char textX[kDKSVGNumberMaxLength];
+	char textY[kDKSVGNumberMaxLength];
+
+	DKSVGFormatNumber(x, stream->precision, textX);
+	DKSVGFormatNumber(y, stream->precision, textY);
+
+	if (strcmp(textY, stream->currentY) == 0) {
+		DKSVGStreamCommand(stream, 'H');
+		DKSVGStreamPathNumber(stream, textX);
+	} else if (strcmp(textX, stream->currentX) == 0) {
+		DKSVGStreamCommand(stream, 'V');
+		DKSVGStreamPathNumber(stream, textY);
+	} else {
+		DKSVGStreamCommand(stream, 'L');
+		DKSVGStreamPathNumber(stream, textX);
+		DKSVGStreamPathNumber(stream, textY);
+	}
+
+	strcpy(stream->currentX, textX);
+	strcpy(stream->currentY, textY);
+}
+
+void DKSVGStreamCurveTo(DKSVGStream* stream, double x1, double y1, double x2, double y2, double x, double y)
+{
+	char text[kDKSVGNumberMaxLength];
+
+	DKSVGStreamCommand(stream, 'C');
+
+	DKSVGFormatNumber(x1, stream->precision, text);
+	DKSVGStreamPathNumber(stream, text);
+	DKSVGFormatNumber(y1, stream->precision, text);
+	DKSVGStreamPathNumber(stream, text);
+	DKSVGFormatNumber(x2, stream->precision, text);
+	DKSVGStreamPathNumber(stream, text);
+	DKSVGFormatNumber(y2, stream->precision, text);
+	DKSVGStreamPathNumber(stream, text);
+
+	DKSVGFormatNumber(x, stream->precision, stream->currentX);
+	DKSVGFormatNumber(y, stream->precision, stream->currentY);
+	DKSVGStreamPathNumber(stream, stream->currentX);
+	DKSVGStreamPathNumber(stream, stream->currentY);
+}
+
+void DKSVGStreamClose(DKSVGStream* stream)
+{
+	DKSVGStreamCommand(stream, 'Z');
+	strcpy(stream->currentX, stream->startX);
+	strcpy(stream->currentY, stream->startY);
+}
+
+void DKSVGStreamAppendPathBuffer(DKSVGStream* stream, const DKPathBuffer* path)
+{
+	const DKPathPoint* p = path->points;
+
+	for (size_t i = 0; i < path->verbCount; ++i) {
+		switch (path->verbs[i]) {
+		case kDKPathMoveTo:
+			DKSVGStreamMoveTo(stream, p[0].x, p[0].y);
+			break;
+		case kDKPathLineTo:
+			DKSVGStreamLineTo(stream, p[0].x, p[0].y);
+			break;
+		case kDKPathCurveTo:
+			DKSVGStreamCurveTo(stream, p[0].x, p[0].y, p[1].x, p[1].y, p[2].x, p[2].y);
+			break;
+		default:
+			DKSVGStreamClose(stream);
+			break;
+		}
+
+		p += DKPathVerbPointCount(path->verbs[i]);
+	}
+}
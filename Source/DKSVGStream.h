@@ -0,0 +1,113 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#ifndef DKSVGStream_h
+#define DKSVGStream_h
+
+#include "DKPathBuffer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief The longest text DKSVGFormatNumber() writes, including the terminating nul. */
+#define kDKSVGNumberMaxLength 32
+
+/** @brief The most decimal places a number is written with. */
+#define kDKSVGMaximumPrecision 8
+
+/** @brief Receives the bytes of an SVG document as its buffer fills. Returns false if they could not be written. */
+typedef bool (*DKSVGWriteFunction)(const char* bytes, size_t length, void* info);
+
+/** @brief Writes SVG text through a buffer of fixed size, so a document of any length is written in constant memory.
+
+ A stream is a value: it must be set up with DKSVGStreamInit() and released with DKSVGStreamFree(), which does not flush it. Once a write
+ fails, <failed> is set and further output is dropped, so callers can check once at the end.
+
+ Numbers are written rounded to <precision> decimal places, with no trailing zeros, no leading zero before the decimal point and no sign on
+ zero. Path data is written with absolute commands, leaving out repeated command letters, the separator before a number starting with a minus
+ sign or a second decimal point, and the coordinate that a horizontal or vertical line keeps, so that it is as short as the rounding allows.
+ */
+typedef struct {
+	char* buffer;
+	size_t capacity;
+	size_t length;
+	DKSVGWriteFunction write;
+	void* info;
+	unsigned precision; ///< decimal places numbers are rounded to
+	uint64_t bytesWritten; ///< passed to the write function so far
+	bool failed; ///< set if memory could not be had or a write failed
+
+	// path data state, reset by DKSVGStreamBeginPath()
+	char command; ///< the last command letter written, or 0
+	bool separate; ///< whether the next number needs a separator
+	bool pointInLast; ///< whether the last number written has a decimal point
+	char currentX[kDKSVGNumberMaxLength];
+	char currentY[kDKSVGNumberMaxLength];
+	char startX[kDKSVGNumberMaxLength];
+	char startY[kDKSVGNumberMaxLength];
+} DKSVGStream;
+
+/** @brief Sets up a stream.
+ @param stream the stream
+ @param capacity the size of the buffer in bytes, at least 256
+ @param precision the decimal places numbers are rounded to, at most kDKSVGMaximumPrecision
+ @param write called with the buffer's contents each time it fills and when the stream is flushed
+ @param info passed to <write>
+ @return false if the buffer could not be allocated */
+bool DKSVGStreamInit(DKSVGStream* stream, size_t capacity, unsigned precision, DKSVGWriteFunction write, void* info);
+void DKSVGStreamFree(DKSVGStream* stream);
+
+/** @brief Passes whatever is in the buffer to the write function. Returns false if the stream has failed. */
+bool DKSVGStreamFlush(DKSVGStream* stream);
+
+/** @brief Writes <value> rounded to <precision> decimal places in the shortest form, and returns its length.
+
+ Values beyond ±1e15 are clamped to it, and values that are not finite are written as 0, so the text always fits kDKSVGNumberMaxLength.
+ Halfway values round away from zero, the same on every platform. */
+size_t DKSVGFormatNumber(double value, unsigned precision, char* text);
+
+/** @brief Writes an sRGB colour given by components between 0 and 1, as #rgb where that is exact and #rrggbb otherwise, and returns its
+ length. <text> must have room for 8 bytes. */
+size_t DKSVGFormatColor(double red, double green, double blue, char* text);
+
+#pragma mark -
+
+void DKSVGStreamAppendBytes(DKSVGStream* stream, const char* bytes, size_t length);
+void DKSVGStreamAppendString(DKSVGStream* stream, const char* string);
+
+/** @brief Appends UTF-8 text with the characters that are special to XML replaced by entities, so it can be an element's content or an
+ attribute value in double quotes. Control characters that XML does not allow are left out. */
+void DKSVGStreamAppendEscaped(DKSVGStream* stream, const char* string);
+
+/** @brief Appends a number at the stream's precision. */
+void DKSVGStreamAppendNumber(DKSVGStream* stream, double value);
+void DKSVGStreamAppendNumberWithPrecision(DKSVGStream* stream, double value, unsigned precision);
+
+/** @brief Appends a colour as written by DKSVGFormatColor(). */
+void DKSVGStreamAppendColor(DKSVGStream* stream, double red, double green, double blue);
+
+#pragma mark - path data
+
+/** @brief Starts the path data of a new element. */
+void DKSVGStreamBeginPath(DKSVGStream* stream);
+
+void DKSVGStreamMoveTo(DKSVGStream* stream, double x, double y);
+void DKSVGStreamLineTo(DKSVGStream* stream, double x, double y);
+void DKSVGStreamCurveTo(DKSVGStream* stream, double x1, double y1, double x2, double y2, double x, double y);
+void DKSVGStreamClose(DKSVGStream* stream);
+
+/** @brief Appends the elements of a path buffer as path data, after DKSVGStreamBeginPath(). */
+void DKSVGStreamAppendPathBuffer(DKSVGStream* stream, const DKPathBuffer* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DKSVGStream_h */
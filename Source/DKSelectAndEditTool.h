@@ -10,7 +10,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class DKDrawingView, DKStyle, DKObjectDrawingLayer;
+@class DKDrawingView, DKMarqueeSelection, DKStyle, DKObjectDrawingLayer;
 
 //! modes of operation determined by what was hit and what is in the selection
 typedef NS_ENUM(NSInteger, DKEditToolOperation) {
@@ -63,6 +63,7 @@ typedef NS_ENUM(NSInteger, DKEditToolDragPhase) {
 	NSRect mProxyDragDestRect; // where it is drawn
 	NSArray* mDraggedObjects; // cache of objects being dragged
 	BOOL mWasInLockedObject; // YES if initial mouse down was in a locked object
+	DKMarqueeSelection* mMarqueeSelection; // keeps the selection up to date with the marquee during a selection drag
 }
 
 /** @brief Returns the default style to use for drawing the selection marquee
@@ -9,6 +9,7 @@
 #import "DKDrawing.h"
 #import "DKDrawingView.h"
 #import "DKGeometryUtilities.h"
+#import "DKMarqueeSelection.h"
 #import "DKObjectDrawingLayer.h"
 #import "DKStyle.h"
 #import "DKToolController.h"
@@ -29,6 +30,8 @@
 @property (readwrite, copy) NSArray* draggedObjects;
 - (void)proxyDragObjectsAsGroup:(NSArray*)objects inLayer:(DKObjectDrawingLayer*)layer toPoint:(NSPoint)p event:(NSEvent*)event dragPhase:(DKEditToolDragPhase)ph;
 - (BOOL)finishUsingToolInLayer:(DKObjectDrawingLayer*)odl delegate:(id)aDel event:(NSEvent*)event;
+- (DKMarqueeSelection*)marqueeSelectionInLayer:(DKObjectDrawingLayer*)odl;
+- (void)endMarqueeSelection;
 
 @end
 
@@ -661,6 +664,25 @@ static void dragFunction_mouseUp(const void* obj, void* context)
 
 @synthesize draggedObjects = mDraggedObjects;
 
+/** @brief Returns the marquee selection for the current selection drag, starting it from the layer's selection if there isn't one yet
+ */
+- (DKMarqueeSelection*)marqueeSelectionInLayer:(DKObjectDrawingLayer*)odl
+{
+	if (mMarqueeSelection == nil || [mMarqueeSelection layer] != odl) {
+		[self endMarqueeSelection];
+		mMarqueeSelection = [[DKMarqueeSelection alloc] initWithLayer:odl];
+	}
+
+	return mMarqueeSelection;
+}
+
+- (void)endMarqueeSelection
+{
+	[mMarqueeSelection finish];
+	ARCRELEASE(mMarqueeSelection);
+	mMarqueeSelection = nil;
+}
+
 - (BOOL)finishUsingToolInLayer:(DKObjectDrawingLayer*)odl delegate:(id)aDel event:(NSEvent*)event
 {
 	NSArray* sel = nil;
@@ -677,15 +699,24 @@ static void dragFunction_mouseUp(const void* obj, void* context)
 		[self setMarqueeRect:NSRectFromTwoPoints(mAnchorPoint, mLastPoint)
 					 inLayer:odl];
 
+		NSUInteger marqueeCount = 0;
+
 		if (NSIsEmptyRect([self marqueeRect]) && mWasInLockedObject) {
 			obj = [odl hitTest:mLastPoint];
 			[odl replaceSelectionWithObject:obj];
-		} else
-			sel = [odl objectsInRect:[self marqueeRect]];
+		} else {
+			DKMarqueeSelection* marquee = [self marqueeSelectionInLayer:odl];
+
+			[marquee setRect:[self marqueeRect]
+				extendingSelection:extended];
+			marqueeCount = [marquee countOfObjects];
+		}
+
+		[self endMarqueeSelection];
 
 		NSString* undoStr = nil;
 
-		if ([sel count] == 0 && !extended && !mWasInLockedObject) {
+		if (marqueeCount == 0 && !extended && !mWasInLockedObject) {
 			// the marquee hit nothing, so deselect everything
 
 			[odl deselectAll];
@@ -808,6 +839,7 @@ static void dragFunction_mouseUp(const void* obj, void* context)
 	mMouseMoved = NO;
 	mWasInLockedObject = NO;
 	mLastPoint = p;
+	[self endMarqueeSelection];
 
 	LogEvent_(kUserEvent, @"S/E tool mouse down, target = %@, layer = %@, pt = %@", obj, layer, NSStringFromPoint(p));
 
@@ -968,13 +1000,10 @@ static void dragFunction_mouseUp(const void* obj, void* context)
 				[self setMarqueeRect:NSRectFromTwoPoints(mAnchorPoint, p)
 							 inLayer:odl];
 
-				sel = [odl objectsInRect:[self marqueeRect]];
-
-				if (extended)
-					[odl addObjectsToSelectionFromArray:sel];
-				else
-					[odl exchangeSelectionWithObjectsFromArray:sel];
+				// only the objects the marquee's edges have passed over since the last drag are tested and changed
 
+				[[self marqueeSelectionInLayer:odl] setRect:[self marqueeRect]
+										 extendingSelection:extended];
 				break;
 
 			case kDKEditToolMoveObjectsMode:
@@ -1234,6 +1263,7 @@ static void dragFunction_mouseUp(const void* obj, void* context)
 	[mMarqueeStyle release];
 	[mProxyDragImage release];
 	[mDraggedObjects release];
+	[mMarqueeSelection release];
 	[super dealloc];
 }
 #endif
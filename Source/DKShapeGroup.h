@@ -53,6 +53,12 @@ typedef NS_ENUM(NSInteger, DKCreateGroupObjectType) {
 	DKGroupCacheOption mCacheOption; // caching options
 	BOOL mIsWritingToCache; // YES when building cache - modifies transforms
 	BOOL mClipContentToPath; // YES to clip group content to the group's path
+	NSSize mContentCacheScale; // device scale that mContentCache was rendered at
+	NSSize mPendingCacheScale; // device scale of the last uncached draw
+	BOOL mContentCachePending; // YES if the group was last drawn uncached and has not changed since
+	NSUInteger mContentCacheCost; // bytes of the cache memory limit used by this group's cache
+	NSArray<NSBezierPath*>* mHitRegions; // filled and stroked areas of the objects in group coordinates, for hit testing
+	BOOL mHitRegionsBuilt; // YES if mHitRegions is up to date (it is nil if the objects can't be hit tested this way)
 }
 
 // creating new groups:
@@ -193,8 +199,27 @@ typedef NS_ENUM(NSInteger, DKCreateGroupObjectType) {
 
 // caching:
 
+/** @brief How the group caches its content.
+
+ With \c kDKGroupCacheUsingCGLayer, the content is rendered into a layer at the current device scale and redrawn from it while the group is
+ moved or rotated. The cache is rebuilt when the scale changes, but only once the group has been drawn twice at the new scale without changing,
+ so a live resize doesn't rebuild it on every frame. With \c kDKGroupCacheUsingPDF, the content is recorded as PDF, which is independent of
+ scale. Either cache is discarded when any object in the group changes, and is only used when drawing to the screen.
+ */
 @property (nonatomic) DKGroupCacheOption cacheOptions;
 
+/** @brief The total memory that content caches of all groups may use, in bytes.
+
+ A group whose cache would exceed the limit draws its content directly instead. The default is 64MB.
+ */
+@property (class) NSUInteger cacheMemoryLimit;
+
+/** @brief Discards the group's content cache and hit testing regions.
+
+ Called automatically when any object in the group changes.
+ */
+- (void)invalidateCache;
+
 // ungrouping:
 
 /** @brief Unpacks the group back into the nominated layer 
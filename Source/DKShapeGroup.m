@@ -15,13 +15,29 @@
 #import "LogEvent.h"
 #import "NSBezierPath+Geometry.h"
 
+#define DEFAULT_GROUP_CACHE_MEMORY_LIMIT (64 * 1024 * 1024)
+
+static NSUInteger sGroupCacheMemoryLimit = DEFAULT_GROUP_CACHE_MEMORY_LIMIT;
+static NSUInteger sGroupCacheMemoryUsed = 0;
+
 @interface DKShapeGroup ()
-- (void)invalidateCache;
 - (void)updateCache;
 - (void)drawUntransformedContent;
+- (NSRect)contentCacheRect;
+- (NSAffineTransform*)groupToContainerTransform;
+- (BOOL)drawCachedContent;
+- (BOOL)buildContentCacheWithContext:(CGContextRef)context scale:(NSSize)scale;
+- (nullable NSArray<NSBezierPath*>*)hitRegions;
 
 @end
 
+// YES if two device scales are close enough that a cache made at one can be drawn at the other without visible loss
+
+static BOOL DKSameCacheScale(NSSize a, NSSize b)
+{
+	return a.width > 0 && a.height > 0 && fabs(a.width - b.width) <= a.width * 0.01 && fabs(a.height - b.height) <= a.height * 0.01;
+}
+
 @implementation DKShapeGroup
 #pragma mark As a DKShapeGroup
 
@@ -178,6 +194,7 @@
 											object:m_objects];
 
 		m_objects = [objects copy];
+		[self invalidateCache];
 
 		[m_objects makeObjectsPerformSelector:@selector(groupWillAddObject:)
 								   withObject:self];
@@ -382,14 +399,176 @@
 
 @synthesize cacheOptions = mCacheOption;
 
++ (NSUInteger)cacheMemoryLimit
+{
+	return sGroupCacheMemoryLimit;
+}
+
++ (void)setCacheMemoryLimit:(NSUInteger)limit
+{
+	sGroupCacheMemoryLimit = limit;
+}
+
 - (void)updateCache
 {
-	// currently no-op
+	// the cache is built when the group is drawn, as it depends on the scale of the destination
+
+	[self invalidateCache];
 }
 
 - (void)invalidateCache
 {
-	// currently no-op
+	if (mContentCache) {
+		CGLayerRelease(mContentCache);
+		mContentCache = NULL;
+	}
+
+	mPDFContentCache = nil;
+	sGroupCacheMemoryUsed -= MIN(mContentCacheCost, sGroupCacheMemoryUsed);
+	mContentCacheCost = 0;
+	mContentCacheScale = NSZeroSize;
+	mContentCachePending = NO;
+
+	mHitRegions = nil;
+	mHitRegionsBuilt = NO;
+}
+
+/** @brief The area of the group's own coordinate system that the content occupies, including extra space for strokes, shadows, etc. */
+- (NSRect)contentCacheRect
+{
+	NSSize extra = [self extraSpaceNeeded];
+	NSRect cr = NSMakeRect(-mBounds.size.width * 0.5, -mBounds.size.height * 0.5, mBounds.size.width, mBounds.size.height);
+
+	return NSInsetRect(cr, -(extra.width + 1.0), -(extra.height + 1.0));
+}
+
+/** @brief The transform from the group's own coordinate system to its container's, including any containers above it. */
+- (NSAffineTransform*)groupToContainerTransform
+{
+	NSAffineTransform* tfm = [self containerTransform];
+	[tfm prependTransform:[self contentTransform]];
+
+	return tfm;
+}
+
+/** @brief Draws the content from the cache, building the cache first if the group is idle.
+ @return YES if the content was drawn, NO if it must be drawn directly */
+- (BOOL)drawCachedContent
+{
+	if (mCacheOption == kDKGroupCacheNone || mIsWritingToCache || [self isBeingHitTested] || ![NSGraphicsContext currentContextDrawingToScreen])
+		return NO;
+
+	if (mBounds.size.width <= 0 || mBounds.size.height <= 0)
+		return NO;
+
+	CGContextRef context = [[NSGraphicsContext currentContext] graphicsPort];
+	NSAffineTransformStruct ts = [[self groupToContainerTransform] transformStruct];
+	CGAffineTransform tfm = CGAffineTransformMake(ts.m11, ts.m12, ts.m21, ts.m22, ts.tX, ts.tY);
+	CGAffineTransform device = CGAffineTransformConcat(tfm, CGContextGetCTM(context));
+	NSSize scale = NSMakeSize(hypot(device.a, device.b), hypot(device.c, device.d));
+
+	BOOL valid = (mPDFContentCache != nil) || (mContentCache != NULL && DKSameCacheScale(mContentCacheScale, scale));
+
+	if (!valid) {
+		// only build the cache when the group is idle - drawn twice at the same scale with no change in between. Until then, the content
+		// is drawn directly.
+
+		if (!mContentCachePending || !DKSameCacheScale(mPendingCacheScale, scale)) {
+			[self invalidateCache];
+			mContentCachePending = YES;
+			mPendingCacheScale = scale;
+			return NO;
+		}
+
+		if (![self buildContentCacheWithContext:context
+										  scale:scale])
+			return NO;
+	}
+
+	NSRect cr = [self contentCacheRect];
+
+	CGContextSaveGState(context);
+	CGContextConcatCTM(context, tfm);
+
+	if (mContentCache)
+		CGContextDrawLayerInRect(context, NSRectToCGRect(cr), mContentCache);
+	else
+		[mPDFContentCache drawInRect:cr];
+
+	CGContextRestoreGState(context);
+
+	return YES;
+}
+
+- (BOOL)buildContentCacheWithContext:(CGContextRef)context scale:(NSSize)scale
+{
+	[self invalidateCache];
+
+	NSRect cr = [self contentCacheRect];
+	BOOL flipped = [[NSGraphicsContext currentContext] isFlipped];
+	NSUInteger cost;
+
+	if (mCacheOption & kDKGroupCacheUsingCGLayer) {
+		CGSize layerSize = CGSizeMake(ceil(NSWidth(cr) * scale.width), ceil(NSHeight(cr) * scale.height));
+		cost = (NSUInteger)(layerSize.width * layerSize.height * 4);
+
+		if (layerSize.width < 1 || layerSize.height < 1 || sGroupCacheMemoryUsed + cost > sGroupCacheMemoryLimit)
+			return NO;
+
+		mContentCache = CGLayerCreateWithContext(context, layerSize, NULL);
+
+		if (mContentCache == NULL)
+			return NO;
+
+		CGContextRef layerContext = CGLayerGetContext(mContentCache);
+		CGContextScaleCTM(layerContext, scale.width, scale.height);
+		CGContextTranslateCTM(layerContext, -NSMinX(cr), -NSMinY(cr));
+
+		[NSGraphicsContext saveGraphicsState];
+		[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithGraphicsPort:layerContext
+																						flipped:flipped]];
+		[self drawUntransformedContent];
+		[NSGraphicsContext restoreGraphicsState];
+
+		mContentCacheScale = scale;
+	} else {
+		NSMutableData* pdfData = [NSMutableData data];
+		CGDataConsumerRef consumer = CGDataConsumerCreateWithCFData((__bridge CFMutableDataRef)pdfData);
+		CGRect mediaBox = NSRectToCGRect(cr);
+		CGContextRef pdfContext = CGPDFContextCreate(consumer, &mediaBox, NULL);
+
+		CGDataConsumerRelease(consumer);
+
+		if (pdfContext == NULL)
+			return NO;
+
+		CGPDFContextBeginPage(pdfContext, NULL);
+
+		[NSGraphicsContext saveGraphicsState];
+		[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithGraphicsPort:pdfContext
+																						flipped:flipped]];
+		[self drawUntransformedContent];
+		[NSGraphicsContext restoreGraphicsState];
+
+		CGPDFContextEndPage(pdfContext);
+		CGPDFContextClose(pdfContext);
+		CGContextRelease(pdfContext);
+
+		cost = [pdfData length];
+
+		if (sGroupCacheMemoryUsed + cost > sGroupCacheMemoryLimit)
+			return NO;
+
+		mPDFContentCache = [NSPDFImageRep imageRepWithData:pdfData];
+
+		if (mPDFContentCache == nil)
+			return NO;
+	}
+
+	mContentCacheCost = cost;
+	sGroupCacheMemoryUsed += cost;
+
+	return YES;
 }
 
 - (void)drawUntransformedContent
@@ -398,8 +577,80 @@
 	// contents into a cached context.
 
 	mIsWritingToCache = YES;
-	[self drawGroupContent];
-	mIsWritingToCache = NO;
+
+	@try {
+		for (DKDrawableObject* od in [self groupObjects]) {
+			if ([od visible])
+				[od drawContentWithSelectedState:NO];
+		}
+	}
+	@finally {
+		mIsWritingToCache = NO;
+	}
+}
+
+/** @brief Returns the filled and stroked areas of the objects, in the group's own coordinates
+
+ These are used to hit test the group without drawing every object. Each object contributes its path if it is filled and its stroke
+ outline if it is stroked, as hit testing by drawing would. If the group contains objects that don't hit test that way, such as
+ other groups, nil is returned.
+ @return a list of paths, or nil */
+- (NSArray<NSBezierPath*>*)hitRegions
+{
+	if (!mHitRegionsBuilt) {
+		NSMutableArray* regions = [NSMutableArray array];
+
+		mIsWritingToCache = YES;
+
+		@try {
+			for (DKDrawableObject* od in [self groupObjects]) {
+				if (![od visible])
+					continue;
+
+				if ([od isKindOfClass:[DKShapeGroup class]] || !([od isKindOfClass:[DKDrawableShape class]] || [od isKindOfClass:[DKDrawablePath class]])) {
+					regions = nil;
+					break;
+				}
+
+				NSBezierPath* path = [od renderingPath];
+				DKStyle* style = [od style];
+
+				if (path == nil || [path isEmpty])
+					continue;
+
+				BOOL hasStroke = [style hasStroke];
+				BOOL hasFill = !hasStroke || [style hasFill] || [style hasHatch];
+
+				if (hasFill)
+					[regions addObject:path];
+
+				if (hasStroke)
+					[regions addObject:[path strokedPathWithStrokeWidth:MAX(2, [style maxStrokeWidth])]];
+			}
+		}
+		@finally {
+			mIsWritingToCache = NO;
+		}
+
+		mHitRegions = regions;
+		mHitRegionsBuilt = YES;
+	}
+
+	return mHitRegions;
+}
+
+/** @brief A member object changed
+
+ Discards the cache, and passes the change up in case this group is itself in a caching group.
+ @param obj the object that changed */
+- (void)drawableDidChangeVisually:(DKDrawableObject*)obj
+{
+#pragma unused(obj)
+
+	if (!mIsWritingToCache) {
+		[self invalidateCache];
+		[self notifyVisualChange];
+	}
 }
 
 #pragma mark -
@@ -519,6 +770,14 @@
 #pragma mark -
 #pragma mark As a DKDrawableObject
 
+/** @brief Forgets the cached metadata checksums of the group and of the objects in it, as they inherit the group's metadata
+ */
+- (void)invalidateMetadataChecksum
+{
+	[super invalidateMetadataChecksum];
+	[[self groupObjects] makeObjectsPerformSelector:_cmd];
+}
+
 - (NSRect)bounds
 {
 	mBoundsCache = NSZeroRect;
@@ -591,7 +850,8 @@
 	if ([self clipContentToPath])
 		[[self renderingPath] addClip];
 
-	[self drawGroupContent];
+	if (![self drawCachedContent])
+		[self drawGroupContent];
 
 	RESTORE_GRAPHICS_CONTEXT
 }
@@ -628,6 +888,31 @@
 	[super drawSelectedState];
 }
 
+- (BOOL)pointHitsPath:(NSPoint)p
+{
+	if (!NSPointInRect(p, [self bounds]))
+		return NO;
+
+	NSArray* regions = [self hitRegions];
+
+	if (regions == nil)
+		return [super pointHitsPath:p];
+
+	if ([self clipContentToPath] && ![[self renderingPath] containsPoint:p])
+		return NO;
+
+	NSAffineTransform* tfm = [self groupToContainerTransform];
+	[tfm invert];
+	NSPoint gp = [tfm transformPoint:p];
+
+	for (NSBezierPath* region in regions) {
+		if (NSPointInRect(gp, [region bounds]) && [region containsPoint:gp])
+			return YES;
+	}
+
+	return NO;
+}
+
 - (NSSize)extraSpaceNeeded
 {
 	return [self extraSpaceNeededByObjects:[self groupObjects]];
@@ -0,0 +1,73 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class DKDrawableObject, DKObjectOwnerLayer;
+
+/** @brief A spatial index of the points that objects can be snapped to.
+
+ Each object contributes its \c snappingPoints - path vertices, shape handles and so on. The points are bucketed into a uniform grid, so finding
+ the nearest point within a tolerance only looks at the few cells that the tolerance covers, however many objects there are.
+
+ The index is kept up to date incrementally. Objects that change are marked with -objectDidChange:, and their points are gathered again
+ the next time the index is queried, so an object that changes many times between queries is only re-indexed once. An object that is no
+ longer in the index's layer by then is dropped from the index.
+*/
+@interface DKSnapIndex : NSObject {
+@private
+	CGFloat mCellSize;
+	NSMapTable* mCells; // cell key -> buffer of snap points in that cell
+	NSMapTable* mObjectPoints; // object -> buffer of its indexed points
+	NSHashTable* mChangedObjects; // objects whose points must be gathered again
+	NSUInteger mPointCount;
+	DKObjectOwnerLayer* __weak mLayerRef; // the layer whose objects are indexed
+}
+
+/** @brief Creates an index with the given grid cell size.
+ @param cellSize the size of each grid cell, in drawing units. Queries are fastest when this is a little larger than the usual tolerance.
+ @return the index
+ */
+- (instancetype)initWithCellSize:(CGFloat)cellSize NS_DESIGNATED_INITIALIZER;
+
+@property (readonly) CGFloat cellSize;
+
+/** @brief The layer whose objects are indexed. Objects that have left it, including those moved to another layer, are ignored.
+
+ If this is nil, objects in any layer are kept.
+ */
+@property (weak, nullable) DKObjectOwnerLayer* layer;
+
+/** @brief The number of points in the index, not counting changes not yet gathered. */
+@property (readonly) NSUInteger countOfPoints;
+
+/** @brief Adds an object's snapping points to the index. */
+- (void)addObject:(DKDrawableObject*)obj;
+
+/** @brief Removes an object's snapping points from the index. */
+- (void)removeObject:(DKDrawableObject*)obj;
+
+/** @brief Marks an object's points as out of date. The object is added if it is not already in the index. */
+- (void)objectDidChange:(DKDrawableObject*)obj;
+
+- (void)removeAllObjects;
+
+/** @brief Finds the nearest snapping point to a given point.
+
+ Objects that are not visible, or that are no longer in the index's layer, are ignored.
+ @param p the point to snap
+ @param tol the maximum distance from <p> to the snapping point
+ @param except an object to ignore, typically the one being dragged
+ @param object if not NULL, receives the object that the snapping point belongs to
+ @return the nearest snapping point, or <p> unchanged if there is none within <tol>
+ */
+- (NSPoint)nearestPointToPoint:(NSPoint)p tolerance:(CGFloat)tol excludingObject:(nullable DKDrawableObject*)except object:(DKDrawableObject* _Nullable* _Nullable)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
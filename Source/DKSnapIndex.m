@@ -0,0 +1,242 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKSnapIndex.h"
+#import "DKDrawableObject.h"
+
+#define DEFAULT_SNAP_CELL_SIZE 32.0
+
+// one snapping point. The object is retained by the index's object table for as long as any of its points are in a cell.
+
+typedef struct {
+	NSPoint point;
+	__unsafe_unretained DKDrawableObject* object;
+} DKSnapPoint;
+
+static NSInteger DKSnapCellCoordinate(CGFloat v, CGFloat cellSize)
+{
+	CGFloat c = floor(v / cellSize);
+	return (NSInteger)MAX(MIN(c, (CGFloat)INT32_MAX), (CGFloat)INT32_MIN);
+}
+
+// packs a cell's coordinates into a map key. The top bit is always set so the key is never zero, which the map can't hold.
+
+static uintptr_t DKSnapCellKey(NSInteger cx, NSInteger cy)
+{
+	uint64_t key = ((uint64_t)(uint32_t)(int32_t)cx << 32) | (uint32_t)(int32_t)cy;
+	return (uintptr_t)(key | (1ULL << 63));
+}
+
+@interface DKSnapIndex ()
+
+- (BOOL)isMember:(DKDrawableObject*)obj;
+- (void)gatherChangedObjects;
+- (void)insertPointsOfObject:(DKDrawableObject*)obj;
+- (void)removePointsOfObject:(DKDrawableObject*)obj;
+
+@end
+
+#pragma mark -
+
+@implementation DKSnapIndex
+
+- (instancetype)initWithCellSize:(CGFloat)cellSize
+{
+	self = [super init];
+	if (self) {
+		mCellSize = cellSize > 0 ? cellSize : DEFAULT_SNAP_CELL_SIZE;
+		mCells = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality
+										   valueOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality
+											   capacity:0];
+		mObjectPoints = [NSMapTable strongToStrongObjectsMapTable];
+		mChangedObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+													  capacity:0];
+	}
+
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithCellSize:DEFAULT_SNAP_CELL_SIZE];
+}
+
+@synthesize cellSize = mCellSize;
+@synthesize countOfPoints = mPointCount;
+@synthesize layer = mLayerRef;
+
+- (void)addObject:(DKDrawableObject*)obj
+{
+	NSAssert(obj != nil, @"cannot add a nil object to the snap index");
+
+	[mChangedObjects removeObject:obj];
+	[self removePointsOfObject:obj];
+	[self insertPointsOfObject:obj];
+}
+
+- (void)removeObject:(DKDrawableObject*)obj
+{
+	if (obj) {
+		[mChangedObjects removeObject:obj];
+		[self removePointsOfObject:obj];
+	}
+}
+
+- (void)objectDidChange:(DKDrawableObject*)obj
+{
+	if (obj)
+		[mChangedObjects addObject:obj];
+}
+
+- (void)removeAllObjects
+{
+	[mCells removeAllObjects];
+	[mObjectPoints removeAllObjects];
+	[mChangedObjects removeAllObjects];
+	mPointCount = 0;
+}
+
+- (NSPoint)nearestPointToPoint:(NSPoint)p tolerance:(CGFloat)tol excludingObject:(DKDrawableObject*)except object:(DKDrawableObject**)object
+{
+	[self gatherChangedObjects];
+
+	NSPoint nearest = p;
+	DKDrawableObject* nearestObject = nil;
+	CGFloat bestDistance = tol * tol;
+	NSInteger cx, cy;
+	NSInteger minX = DKSnapCellCoordinate(p.x - tol, mCellSize);
+	NSInteger maxX = DKSnapCellCoordinate(p.x + tol, mCellSize);
+	NSInteger minY = DKSnapCellCoordinate(p.y - tol, mCellSize);
+	NSInteger maxY = DKSnapCellCoordinate(p.y + tol, mCellSize);
+
+	for (cx = minX; cx <= maxX; ++cx) {
+		for (cy = minY; cy <= maxY; ++cy) {
+			NSData* cell = NSMapGet(mCells, (const void*)DKSnapCellKey(cx, cy));
+
+			if (cell == nil)
+				continue;
+
+			const DKSnapPoint* sp = [cell bytes];
+			NSUInteger i, count = [cell length] / sizeof(DKSnapPoint);
+
+			for (i = 0; i < count; ++i) {
+				CGFloat dx = sp[i].point.x - p.x;
+				CGFloat dy = sp[i].point.y - p.y;
+				CGFloat d = dx * dx + dy * dy;
+
+				if (d <= bestDistance && sp[i].object != except && [sp[i].object visible] && [self isMember:sp[i].object]) {
+					bestDistance = d;
+					nearest = sp[i].point;
+					nearestObject = sp[i].object;
+				}
+			}
+		}
+	}
+
+	if (object)
+		*object = nearestObject;
+
+	return nearest;
+}
+
+#pragma mark -
+
+- (BOOL)isMember:(DKDrawableObject*)obj
+{
+	DKObjectOwnerLayer* layer = [obj layer];
+
+	return mLayerRef ? layer == mLayerRef : layer != nil;
+}
+
+- (void)gatherChangedObjects
+{
+	if ([mChangedObjects count] == 0)
+		return;
+
+	for (DKDrawableObject* obj in mChangedObjects) {
+		[self removePointsOfObject:obj];
+
+		// objects that have left the layer since they changed, whether or not they are now in another one, are simply dropped
+
+		if ([self isMember:obj])
+			[self insertPointsOfObject:obj];
+	}
+
+	[mChangedObjects removeAllObjects];
+}
+
+- (void)insertPointsOfObject:(DKDrawableObject*)obj
+{
+	NSArray<NSValue*>* points = [obj snappingPoints];
+	NSUInteger count = [points count];
+
+	if (count == 0)
+		return;
+
+	NSMutableData* indexed = [NSMutableData dataWithLength:count * sizeof(NSPoint)];
+	NSPoint* pp = [indexed mutableBytes];
+	NSUInteger i = 0;
+
+	for (NSValue* value in points) {
+		DKSnapPoint sp = { [value pointValue], obj };
+		uintptr_t key = DKSnapCellKey(DKSnapCellCoordinate(sp.point.x, mCellSize), DKSnapCellCoordinate(sp.point.y, mCellSize));
+		NSMutableData* cell = NSMapGet(mCells, (const void*)key);
+
+		if (cell == nil) {
+			cell = [NSMutableData dataWithCapacity:8 * sizeof(DKSnapPoint)];
+			NSMapInsert(mCells, (const void*)key, (__bridge const void*)cell);
+		}
+
+		[cell appendBytes:&sp
+				   length:sizeof(sp)];
+		pp[i++] = sp.point;
+	}
+
+	[mObjectPoints setObject:indexed
+					  forKey:obj];
+	mPointCount += count;
+}
+
+- (void)removePointsOfObject:(DKDrawableObject*)obj
+{
+	NSData* indexed = [mObjectPoints objectForKey:obj];
+
+	if (indexed == nil)
+		return;
+
+	const NSPoint* pp = [indexed bytes];
+	NSUInteger i, count = [indexed length] / sizeof(NSPoint);
+
+	for (i = 0; i < count; ++i) {
+		uintptr_t key = DKSnapCellKey(DKSnapCellCoordinate(pp[i].x, mCellSize), DKSnapCellCoordinate(pp[i].y, mCellSize));
+		NSMutableData* cell = NSMapGet(mCells, (const void*)key);
+
+		if (cell == nil)
+			continue;
+
+		// remove all of this object's points from the cell, filling the gaps from the end
+
+		DKSnapPoint* sp = [cell mutableBytes];
+		NSUInteger j = 0, n = [cell length] / sizeof(DKSnapPoint);
+
+		while (j < n) {
+			if (sp[j].object == obj)
+				sp[j] = sp[--n];
+			else
+				++j;
+		}
+
+		if (n == 0)
+			NSMapRemove(mCells, (const void*)key);
+		else
+			[cell setLength:n * sizeof(DKSnapPoint)];
+	}
+
+	mPointCount -= count;
+	[mObjectPoints removeObjectForKey:obj];
+}
+
+@end
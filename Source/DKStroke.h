@@ -56,6 +56,8 @@ DKStyle can contains a list of strokes without limit.
 
 - (void)strokeRect:(NSRect)rect;
 - (void)applyAttributesToPath:(NSBezierPath*)path;
+/** @brief Returns a copy of the path trimmed, offset and given the stroke's attributes, ready to be stroked. */
+- (NSBezierPath*)strokablePathForPath:(NSBezierPath*)path;
 
 @property (nonatomic) NSLineCapStyle lineCapStyle;
 
@@ -178,10 +178,16 @@
 + (NSArray*)observableKeyPaths
 {
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"width", @"dash",
-		@"shadow", @"lineCapStyle", @"lineJoinStyle",
+		@"shadow", @"lineCapStyle", @"lineJoinStyle", @"miterLimit",
 		@"lateralOffset", @"trimLength"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"colour", @"width", @"dash", @"shadow", @"lineCapStyle", @"lineJoinStyle",
+		@"miterLimit", @"lateralOffset", @"trimLength"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -197,6 +203,8 @@
 			 forKeyPath:@"lineCapStyle"];
 	[self setActionName:@"#kind# Line Join Style"
 			 forKeyPath:@"lineJoinStyle"];
+	[self setActionName:@"#kind# Miter Limit"
+			 forKeyPath:@"miterLimit"];
 	[self setActionName:@"#kind# Stroke Offset"
 			 forKeyPath:@"lateralOffset"];
 	[self setActionName:@"#kind# Trim Length"
@@ -240,7 +248,8 @@
 	RESTORE_GRAPHICS_CONTEXT //[NSGraphicsContext restoreGraphicsState];
 }
 
-- (void)renderPath:(NSBezierPath*)path
+/** returns a copy of <path> trimmed and offset as the stroke requires, with the stroke's attributes applied */
+- (NSBezierPath*)strokablePathForPath:(NSBezierPath*)path
 {
 	// copy path as we are about to change many of its properties
 
@@ -260,9 +269,15 @@
 		[NSBezierPath setDefaultFlatness:savedFlatness];
 	}
 
-	[[self colour] setStroke];
 	[self applyAttributesToPath:pc];
+	return pc;
+}
 
+- (void)renderPath:(NSBezierPath*)path
+{
+	NSBezierPath* pc = [self strokablePathForPath:path];
+
+	[[self colour] setStroke];
 	[pc stroke];
 }
 
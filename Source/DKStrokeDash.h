@@ -56,12 +56,37 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property BOOL isBeingEdited;
 
+/** @brief A hash of the pattern, phase and scaling, for comparing renderers with \c -isEquivalentToObject:. */
+@property (readonly) NSUInteger equivalenceHash;
+
+/** @brief Whether another dash has the same pattern, phase and scaling. */
+- (BOOL)isEquivalentToObject:(nullable id)object;
+
 - (void)applyToPath:(NSBezierPath*)path;
 /** @brief Applies the stroke to <code>path</code>.
  @discussion If scales to line width, use path's line width to multiply each element of the pattern.
  */
 - (void)applyToPath:(NSBezierPath*)path withPhase:(CGFloat)phase;
 
+/** @brief Returns the dashes the pattern makes along <code>path</code> at the dash's own phase. */
+- (NSBezierPath*)dashedPathForPath:(NSBezierPath*)path;
+
+/** @brief Returns the dashes the pattern makes along <code>path</code>, as explicit geometry.
+ @discussion Each dash is an open subpath made of the parts of the path's lines and curves that it covers. The pattern and phase are
+ those \c -applyToPath:withPhase: would set, and the result has the path's width, cap, join and mitre limit but no dash, so stroking it
+ looks the same as stroking the dashed path.
+
+ Dashes are cached by the path's geometry, pattern and phase. The path's measured length is cached separately, so finding the dashes
+ again at a new phase, as when marching ants are animated, only costs the dashes themselves.
+ @param path the path to dash
+ @param phase the phase, ignoring any line width scaling
+ @return a new path
+ */
+- (NSBezierPath*)dashedPathForPath:(NSBezierPath*)path withPhase:(CGFloat)phase;
+
+/** @brief Discards all cached dashes and measured paths. */
++ (void)flushDashCache;
+
 - (NSImage*)dashSwatchImageWithSize:(NSSize)size strokeWidth:(CGFloat)width;
 - (NSImage*)standardDashSwatchImage;
 
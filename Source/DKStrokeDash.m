@@ -6,8 +6,19 @@
 
 #import "DKStrokeDash.h"
 #import "DKDrawKitMacros.h"
+#import "DKInstrumentation.h"
+#import "GCObservableObject.h"
+#import "NSBezierPath+Geometry.h"
+#include "DKPathMeasure.h"
 #include <tgmath.h>
 
+#define DEFAULT_MEASURE_CACHE_LIMIT (16 * 1024 * 1024)
+#define DEFAULT_DASHES_CACHE_LIMIT (8 * 1024 * 1024)
+
+// how closely curves are measured when finding dashes, matching the native stroker's default
+
+#define DASH_MEASURE_TOLERANCE 0.1
+
 #pragma mark Static Vars
 static NSMutableDictionary* sDashDict = nil;
 
@@ -19,6 +30,110 @@ static NSUInteger euclid_hcf(NSUInteger a, NSUInteger b)
 		return euclid_hcf(b, a % b);
 }
 
+#pragma mark -
+
+/** key for the dash caches: a path's checksum and size, and for dashes also the pattern and phase they were found with. Measures are
+ looked up with no pattern. Different paths can share a key, so each entry also keeps the path it was made from to check a hit against. */
+@interface DKDashCacheKey : NSObject <NSCopying> {
+@public
+	uint64_t mChecksum;
+	NSUInteger mElementCount;
+	double mPattern[8];
+	NSUInteger mCount;
+	double mPhase;
+}
+@end
+
+@implementation DKDashCacheKey
+
+- (NSUInteger)hash
+{
+	NSUInteger i, hash = (NSUInteger)(mChecksum ^ (mChecksum >> 32)) ^ (mElementCount * 2654435761U);
+
+	for (i = 0; i < mCount; ++i)
+		hash = GCHashCombine(hash, [@(mPattern[i]) hash]);
+
+	return mCount > 0 ? GCHashCombine(hash, [@(mPhase) hash]) : hash;
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKDashCacheKey class]])
+		return NO;
+
+	DKDashCacheKey* other = object;
+	return other->mChecksum == mChecksum && other->mElementCount == mElementCount && other->mCount == mCount && other->mPhase == mPhase && memcmp(other->mPattern, mPattern, mCount * sizeof(double)) == 0;
+}
+
+- (id)copyWithZone:(NSZone*)zone
+{
+#pragma unused(zone)
+	return self;
+}
+
+@end
+
+/** a path measured along its length, so that it can be dashed again at any phase without measuring it again */
+@interface DKDashMeasureEntry : NSObject {
+@public
+	DKPathBuffer mSource;
+	DKPathMeasure mMeasure;
+}
+@end
+
+@implementation DKDashMeasureEntry
+
+- (void)dealloc
+{
+	DKPathMeasureFree(&mMeasure);
+	DKPathBufferFree(&mSource);
+}
+
+@end
+
+/** the dashes of a path at one pattern and phase */
+@interface DKDashesEntry : NSObject {
+@public
+	DKPathBuffer mSource;
+	DKPathBuffer mDashes;
+}
+@end
+
+@implementation DKDashesEntry
+
+- (void)dealloc
+{
+	DKPathBufferFree(&mDashes);
+	DKPathBufferFree(&mSource);
+}
+
+@end
+
+static size_t DKDashPathBufferMemorySize(const DKPathBuffer* path)
+{
+	return path->verbCapacity + path->pointCapacity * sizeof(DKPathPoint);
+}
+
+static NSCache* sMeasureCache = nil;
+static NSCache* sDashesCache = nil;
+
+static void DKStrokeDashSetUpCaches(void)
+{
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sMeasureCache = [[NSCache alloc] init];
+		[sMeasureCache setName:@"DKStrokeDash.measures"];
+		[sMeasureCache setTotalCostLimit:DEFAULT_MEASURE_CACHE_LIMIT];
+
+		sDashesCache = [[NSCache alloc] init];
+		[sDashesCache setName:@"DKStrokeDash.dashes"];
+		[sDashesCache setTotalCostLimit:DEFAULT_DASHES_CACHE_LIMIT];
+	});
+}
+
 #pragma mark -
 @implementation DKStrokeDash
 #pragma mark As a DKStrokeDash
@@ -185,6 +300,30 @@ static NSUInteger euclid_hcf(NSUInteger a, NSUInteger b)
 @synthesize scalesToLineWidth = m_scaleToLineWidth;
 @synthesize isBeingEdited = mEditing;
 
+#pragma mark -
+- (NSUInteger)equivalenceHash
+{
+	NSUInteger i, hash = GCHashCombine(m_count, [@(m_phase) hash]);
+
+	for (i = 0; i < m_count; ++i)
+		hash = GCHashCombine(hash, [@(m_pattern[i]) hash]);
+
+	return GCHashCombine(hash, m_scaleToLineWidth);
+}
+
+- (BOOL)isEquivalentToObject:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKStrokeDash class]])
+		return NO;
+
+	DKStrokeDash* dash = object;
+
+	return dash->m_count == m_count && dash->m_phase == m_phase && dash->m_scaleToLineWidth == m_scaleToLineWidth && memcmp(dash->m_pattern, m_pattern, m_count * sizeof(CGFloat)) == 0;
+}
+
 #pragma mark -
 - (void)applyToPath:(NSBezierPath*)path
 {
@@ -214,6 +353,128 @@ static NSUInteger euclid_hcf(NSUInteger a, NSUInteger b)
 					phase:-phase];
 }
 
+#pragma mark -
+- (NSBezierPath*)dashedPathForPath:(NSBezierPath*)path
+{
+	return [self dashedPathForPath:path
+						 withPhase:LIMIT([self phase], 0, [self length])];
+}
+
+- (NSBezierPath*)dashedPathForPath:(NSBezierPath*)path withPhase:(CGFloat)phase
+{
+	NSAssert(path != nil, @"can't dash a nil path");
+
+	DKStrokeDashSetUpCaches();
+
+	// the pattern and phase are set up exactly as -applyToPath:withPhase: would set them on the path
+
+	CGFloat scale = [self scalesToLineWidth] ? [path lineWidth] : 1.0;
+	DKDashCacheKey* key = [[DKDashCacheKey alloc] init];
+	DKPathBuffer buffer;
+	NSUInteger i;
+
+	key->mCount = m_count;
+
+	for (i = 0; i < m_count; ++i)
+		key->mPattern[i] = m_pattern[i] * scale;
+
+	// a pattern that can't be used strokes solid, so the dashed path is just the path
+
+	double total = DKPathDashPatternLength(key->mPattern, m_count);
+
+	if (!(total > 0.0) || !isfinite(phase)) {
+		NSBezierPath* result = [path copy];
+
+		[result setLineDash:NULL
+					  count:0
+					  phase:0.0];
+		return result;
+	}
+
+	// phases a whole number of repeats apart give the same dashes, so they share one entry
+
+	key->mPhase = fmod(-phase * scale, total);
+
+	if (key->mPhase < 0.0)
+		key->mPhase += total;
+
+	DKPathBufferInit(&buffer);
+	[path appendElementsToPathBuffer:&buffer];
+
+	key->mChecksum = DKPathBufferChecksum(&buffer);
+	key->mElementCount = buffer.verbCount;
+
+	// a hit only counts if the entry was made from this very path, not just one with the same checksum
+
+	DKDashesEntry* dashes = [sDashesCache objectForKey:key];
+
+	if (dashes && !DKPathBufferIsEqual(&dashes->mSource, &buffer))
+		dashes = nil;
+
+	if (dashes)
+		DK_INSTRUMENT_COUNT("cache", "dash hits", 1);
+	else {
+		DK_INSTRUMENT_COUNT("cache", "dash misses", 1);
+
+		// the measure is shared by every pattern and phase, so a path whose phase is animated is only measured once
+
+		DKDashCacheKey* measureKey = [[DKDashCacheKey alloc] init];
+		measureKey->mChecksum = key->mChecksum;
+		measureKey->mElementCount = key->mElementCount;
+
+		DKDashMeasureEntry* measure = [sMeasureCache objectForKey:measureKey];
+
+		if (measure && !DKPathBufferIsEqual(&measure->mSource, &buffer))
+			measure = nil;
+
+		if (measure == nil) {
+			DK_INSTRUMENT_COUNT("cache", "dash measure misses", 1);
+
+			measure = [[DKDashMeasureEntry alloc] init];
+			DKPathBufferInit(&measure->mSource);
+			DKPathBufferAppend(&measure->mSource, &buffer);
+			DKPathMeasureInit(&measure->mMeasure);
+
+			if (DKPathMeasureSetPath(&measure->mMeasure, &buffer, DASH_MEASURE_TOLERANCE) && !measure->mSource.failed)
+				[sMeasureCache setObject:measure
+								  forKey:measureKey
+									cost:DKPathMeasureMemorySize(&measure->mMeasure) + DKDashPathBufferMemorySize(&measure->mSource)];
+		} else
+			DK_INSTRUMENT_COUNT("cache", "dash measure hits", 1);
+
+		// the entry takes over the path, which is not needed again here
+
+		dashes = [[DKDashesEntry alloc] init];
+		dashes->mSource = buffer;
+		DKPathBufferInit(&buffer);
+		DKPathBufferInit(&dashes->mDashes);
+
+		if (DKPathMeasureDash(&measure->mMeasure, key->mPattern, m_count, key->mPhase, &dashes->mDashes))
+			[sDashesCache setObject:dashes
+							 forKey:key
+							   cost:DKDashPathBufferMemorySize(&dashes->mDashes) + DKDashPathBufferMemorySize(&dashes->mSource)];
+	}
+
+	DKPathBufferFree(&buffer);
+
+	NSBezierPath* result = [NSBezierPath bezierPathWithPathBuffer:&dashes->mDashes];
+
+	[result setLineWidth:[path lineWidth]];
+	[result setLineCapStyle:[path lineCapStyle]];
+	[result setLineJoinStyle:[path lineJoinStyle]];
+	[result setMiterLimit:[path miterLimit]];
+
+	return result;
+}
+
++ (void)flushDashCache
+{
+	DKStrokeDashSetUpCaches();
+
+	[sDashesCache removeAllObjects];
+	[sMeasureCache removeAllObjects];
+}
+
 #pragma mark -
 
 - (NSImage*)dashSwatchImageWithSize:(NSSize)size strokeWidth:(CGFloat)width
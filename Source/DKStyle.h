@@ -40,6 +40,7 @@ typedef NS_ENUM(NSInteger, DKDerivedStyleOptions) {
 	NSTimeInterval m_lastModTime; // timestamp to determine when styles have been updated
 	NSUInteger m_clientCount; // keeps count of the clients using the style
 	NSMutableDictionary* mSwatchCache; // cache of swatches at various sizes previously requested
+	NSUInteger m_equivalenceHash; // cached equivalence hash, or 0 if it must be computed again
 }
 
 // basic standard styles:
@@ -291,6 +292,15 @@ typedef NS_ENUM(NSInteger, DKDerivedStyleOptions) {
  */
 - (BOOL)isEqualToStyle:(DKStyle*)aStyle;
 
+/** @brief Does <code>aStyle</code> draw the same way as this style, whatever their keys and names?
+
+ Styles are equivalent if they have equivalent renderers in the same order and equal text attributes. The style's
+ \c equivalenceHash is cached until the style changes, so styles that differ are usually told apart without looking inside them.
+ @param aStyle A style to compare this with.
+ @return \c YES if the styles are equivalent, \c NO otherwise.
+ */
+- (BOOL)isEquivalentToStyle:(DKStyle*)aStyle;
+
 // undo:
 
 /** @brief Sets the undo manager that style changes will be recorded by.
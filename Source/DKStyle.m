@@ -395,6 +395,8 @@ static BOOL sSubstitute = NO;
 
 	[mSwatchCache removeAllObjects];
 
+	m_equivalenceHash = 0;
+
 	[[NSNotificationCenter defaultCenter] postNotificationName:kDKStyleDidChangeNotification
 														object:self];
 }
@@ -642,6 +644,11 @@ static BOOL sSubstitute = NO;
 	return same;
 }
 
+- (BOOL)isEquivalentToStyle:(DKStyle*)aStyle
+{
+	return [self isEquivalentToObject:aStyle];
+}
+
 #pragma mark -
 #pragma mark - undo
 
@@ -1426,6 +1433,34 @@ static BOOL sSubstitute = NO;
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"locked", @"styleSharable"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	// locking and sharing don't change how a style draws, but its text attributes do
+
+	return [[super equivalenceKeyPaths] arrayByAddingObject:@"textAttributes"];
+}
+
+- (NSUInteger)equivalenceHash
+{
+	// the hash is kept until the style next changes. 0 marks it as not yet computed, so a real hash of 0 is nudged away from it
+
+	if (m_equivalenceHash == 0)
+		m_equivalenceHash = [super equivalenceHash] ?: 1;
+
+	return m_equivalenceHash;
+}
+
+- (BOOL)isEquivalentToObject:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKStyle class]] || [object equivalenceHash] != [self equivalenceHash])
+		return NO;
+
+	return [super isEquivalentToObject:object];
+}
+
 #pragma mark -
 #pragma mark As a NSObject
 
@@ -13,10 +13,16 @@
 	DKParser* mParser;
 }
 
+// scripts are compiled once and cached - see DKCompiledScript
+
 - (id)evaluateScript:(NSString*)script;
+- (id)evaluateContentsOfFile:(NSString*)filename;
 - (id)readContentsOfFile:(NSString*)filenamet;
 - (void)loadBuiltinSymbols;
 
+// a registered class makes its objects from an expression in +instantiateFromExpression: or -initWithExpression:, and must not keep the
+// expression, which compiled scripts reuse
+
 - (void)registerClass:(id)aClass withShortName:(NSString*)sym;
 
 @end
@@ -7,6 +7,7 @@
 
 #import "DKStyleReader.h"
 
+#import "DKCompiledScript.h"
 #import "DKExpression.h"
 #import "DKParser.h"
 #import "DKScriptingAdditions.h"
@@ -17,7 +18,16 @@
 /**  */
 - (id)evaluateScript:(NSString*)script
 {
-	return [self evaluateExpression:[mParser parseString:script]];
+	return [self evaluateCompiledScript:[DKCompiledScript compiledScriptForString:script
+																		  parser:mParser]];
+}
+
+- (id)evaluateContentsOfFile:(NSString*)filename
+{
+	NSString* script = [NSString stringWithContentsOfFile:filename
+												 encoding:NSASCIIStringEncoding
+													error:NULL];
+	return [self evaluateScript:script];
 }
 
 - (id)readContentsOfFile:(NSString*)filename;
@@ -148,6 +158,13 @@
 	return [obj autorelease];
 }
 
+- (BOOL)keepsSimpleExpressions
+{
+	// the expression is only read to make a new object, which keeps its values but not the expression itself
+
+	return NO;
+}
+
 #pragma mark -
 #pragma mark As an NSObject
 - (void)dealloc
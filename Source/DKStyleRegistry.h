@@ -20,7 +20,8 @@ typedef NS_OPTIONS(NSUInteger, DKStyleMergeOptions) {
 	kDKIgnoreUnsharedStyles = (1 << 0), //!< compatibility with old registry - styles with sharing off are ignored
 	kDKReplaceExistingStyles = (1 << 1), //!< styles passed in replace those with the same key (doc -> reg)
 	kDKReturnExistingStyles = (1 << 2), //!< styles in reg with the same keys are returned (reg -> doc)
-	kDKAddStylesAsNewVersions = (1 << 3) //!< styles with the same keys are copied and registered again (reg || doc)
+	kDKAddStylesAsNewVersions = (1 << 3), //!< styles with the same keys are copied and registered again (reg || doc)
+	kDKReuseEquivalentStyles = (1 << 4) //!< styles unknown to reg but equivalent to a registered style are not registered again
 };
 
 /** @brief Values you can test for in result of \c compareStylesInSet:
@@ -116,7 +117,13 @@ typedef NS_ENUM(NSInteger, DKStyleCompare) {
  Cut/Paste: cut and paste of styles works independently of the registry, including dealing with shared styles. See DKStyle for more info.
 */
 @interface DKStyleRegistry : DKCategoryManager <DKStyle*>
-<DKCategoryManagerMenuItemDelegate>
+<DKCategoryManagerMenuItemDelegate> {
+@private
+	NSMutableDictionary<NSNumber*, NSMutableArray<DKStyle*>*>* mEquivalenceIndex; // equivalence hash -> styles indexed under it
+	NSMutableDictionary<NSString*, NSMutableArray<DKStyle*>*>* mNameIndex; // name -> styles indexed under it
+	NSMapTable<DKStyle*, NSArray*>* mIndexEntries; // style -> the hash and name it is indexed under, or nil if the indexes must be built
+	BOOL mNameIndexIsCurrent; // YES while a merge is under way, once styles renamed before it have been reindexed
+}
 
 	// retrieving the registry and styles
 
@@ -241,6 +248,15 @@ typedef NS_ENUM(NSInteger, DKStyleCompare) {
  */
 + (NSDictionary<NSString*, NSNumber*>*)compareStylesInSet:(NSSet<DKStyle*>*)styles;
 
+/** @brief Find the registered styles that are equivalent to each of a set of styles.
+
+ This finds duplicates of registered styles that have different keys, such as copies made in another application, so that a document
+ can use the registered style in their place. See \c -styleEquivalentToStyle:.
+ @param styles A set of styles.
+ @return A dictionary mapping the unique key of each style in <code>styles</code> that has a registered equivalent to that registered style.
+ */
++ (NSDictionary<NSString*, DKStyle*>*)registeredStylesEquivalentToStyles:(NSSet<DKStyle*>*)styles;
+
 // high-level data access
 
 /** @brief Return the entire list of keys of the styles in the registry.
@@ -320,6 +336,16 @@ typedef NS_ENUM(NSInteger, DKStyleCompare) {
  */
 - (nullable DKStyle*)styleForKey:(NSString*)styleID;
 
+/** @brief Return a registered style that draws the same way as the given style.
+
+ Registered styles are indexed by their \c equivalenceHash, so this takes the same time however many styles are registered. The index is
+ updated as styles are registered and unregistered. Registered styles are normally locked; if one is unlocked and edited, it is indexed
+ again when \c +setStyleNotificationsEnabled: is on, and otherwise the next time a lookup comes across it.
+ @param aStyle A style, which need not be registered.
+ @return A registered style other than <code>aStyle</code> that is equivalent to it, or <code>nil</code>.
+ */
+- (nullable DKStyle*)styleEquivalentToStyle:(DKStyle*)aStyle;
+
 /** @brief Return the set of styles in the given categories.
 
  Being a set, the result is unordered. The result may be the empty set if the categories are unknown
@@ -46,6 +46,18 @@ NSString* const kDKStyleWasEditedWhileRegisteredNotification = @"kDKStyleWasEdit
 
 @end
 
+@interface DKStyleRegistry ()
+
+- (void)buildIndexesIfNeeded;
+- (void)invalidateIndexes;
+- (void)indexStyle:(DKStyle*)aStyle;
+- (void)unindexStyle:(DKStyle*)aStyle;
+- (void)reindexRenamedStyles;
+- (void)setNameIndexIsCurrent:(BOOL)current;
+- (BOOL)isStyleNameInUse:(NSString*)name;
+
+@end
+
 #pragma mark -
 
 @implementation DKStyleRegistry
@@ -54,6 +66,7 @@ NSString* const kDKStyleWasEditedWhileRegisteredNotification = @"kDKStyleWasEdit
 
 static DKStyleRegistry* s_styleRegistry = nil;
 static BOOL s_NoDKDefaults = NO;
+static BOOL s_styleNotificationsEnabled = NO;
 
 #pragma mark As a DKStyleRegistry
 
@@ -296,6 +309,11 @@ static BOOL s_NoDKDefaults = NO;
 
 	NSMutableSet* changedStyles = nil;
 
+	// nothing renames a registered style while the merge is going on, so the name index is brought up to date once here rather than each
+	// time a new style's name is checked
+
+	[[self sharedStyleRegistry] setNameIndexIsCurrent:YES];
+
 	for (DKStyle* style in styles) {
 		// this option relates to the old registry's behaviour, and is mostly inappropriate for this one. Whether a style is sharable or not
 		// generally has no connection to how it is registered in the current model.
@@ -308,10 +326,15 @@ static BOOL s_NoDKDefaults = NO;
 
 		DKStyle* regStyle = [self styleForKey:[style uniqueKey]];
 
-		if (regStyle == nil)
+		if (regStyle == nil) {
+			// a style the registry doesn't know by key may still be a copy of one it has, in which case it can be left out
+
+			if ((options & kDKReuseEquivalentStyles) != 0 && [[self sharedStyleRegistry] styleEquivalentToStyle:style] != nil)
+				continue;
+
 			[self registerStyle:style
 				   inCategories:styleCategories];
-		else {
+		} else {
 			if ((options & kDKReplaceExistingStyles) != 0) {
 				// style is known to us, so a merge is required, overwriting the registered style with the new one. Any clients of the
 				// modified style will be updated automatically.
@@ -361,6 +384,7 @@ static BOOL s_NoDKDefaults = NO;
 		}
 	}
 
+	[[self sharedStyleRegistry] setNameIndexIsCurrent:NO];
 	[self setNeedsUIUpdate];
 
 	return changedStyles;
@@ -417,6 +441,28 @@ static BOOL s_NoDKDefaults = NO;
 	return info;
 }
 
+/** @brief Find the registered styles that are equivalent to each of a set of styles
+ @param styles a set of styles
+ @return a dictionary mapping the key of each style that has a registered equivalent to that registered style
+ */
++ (NSDictionary<NSString*, DKStyle*>*)registeredStylesEquivalentToStyles:(NSSet*)styles
+{
+	NSAssert(styles != nil, @"can't look up a nil set");
+
+	NSMutableDictionary<NSString*, DKStyle*>* equivalents = [NSMutableDictionary dictionary];
+	DKStyleRegistry* reg = [self sharedStyleRegistry];
+
+	for (DKStyle* style in styles) {
+		DKStyle* regStyle = [reg styleEquivalentToStyle:style];
+
+		if (regStyle != nil)
+			[equivalents setObject:regStyle
+							forKey:[style uniqueKey]];
+	}
+
+	return equivalents;
+}
+
 /** @brief Return the entire list of keys of the styles in the registry
  @return an array listing all of the keys in the registry
  */
@@ -603,6 +649,30 @@ static BOOL s_NoDKDefaults = NO;
 	return [self objectForKey:styleID];
 }
 
+- (DKStyle*)styleEquivalentToStyle:(DKStyle*)aStyle
+{
+	NSAssert(aStyle != nil, @"can't look up a nil style");
+
+	[self buildIndexesIfNeeded];
+
+	NSUInteger hash = [aStyle equivalenceHash];
+	NSArray* candidates = [[mEquivalenceIndex objectForKey:@(hash)] copy];
+
+	for (DKStyle* candidate in candidates) {
+		// a candidate edited since it was indexed is moved to where it now belongs
+
+		if ([candidate equivalenceHash] != hash) {
+			[self indexStyle:candidate];
+			continue;
+		}
+
+		if (candidate != aStyle && [candidate isEquivalentToStyle:aStyle])
+			return candidate;
+	}
+
+	return nil;
+}
+
 /** @brief Return the set of styles in the given categories
 
  Being a set, the result is unordered. The result may be the empty set if the categories are unknown
@@ -629,18 +699,10 @@ static BOOL s_NoDKDefaults = NO;
 	// if <name> already exists among the registerd styles, append a number to it until it is not found.
 
 	NSInteger numeral = 0;
-	BOOL found = YES;
 	NSString* temp = name;
-	NSArray* keys = [self styleNames];
-
-	while (found) {
-		NSInteger k = [keys indexOfObject:temp];
 
-		if (k == NSNotFound)
-			found = NO;
-		else
-			temp = [NSString stringWithFormat:@"%@ %ld", name, (long)++numeral];
-	}
+	while ([self isStyleNameInUse:temp])
+		temp = [NSString stringWithFormat:@"%@ %ld", name, (long)++numeral];
 
 	return temp;
 }
@@ -851,6 +913,7 @@ static BOOL s_NoDKDefaults = NO;
 			// the existing style retains the same name and other status flags
 
 			[existingStyle notifyClientsAfterChange];
+			[self indexStyle:existingStyle];
 
 			// drawing *should* now replace the temporary styles with the existing ones as returned, but to help prompt the programmer/user
 			// that things haven't gone to plan if this doesn't take place, set the name of the old style to something different
@@ -888,6 +951,8 @@ static BOOL s_NoDKDefaults = NO;
 	// typically the style registry will need to observe style changes but in many cases this isn't needed and adds an overhead that you might
 	// prefer to do without. Thus this must be explicitly enabled as needed. Default is OFF, which differs from b5 and earlier.
 
+	s_styleNotificationsEnabled = enable;
+
 	if (enable) {
 		[[NSNotificationCenter defaultCenter] addObserver:[self sharedStyleRegistry]
 												 selector:@selector(styleDidChange:)
@@ -912,6 +977,7 @@ static BOOL s_NoDKDefaults = NO;
 	NSString* key = [style uniqueKey];
 
 	if ([self styleForKey:key] == style) {
+		[self indexStyle:style];
 		[self updateMenusForKey:key];
 
 		NSDictionary* userInfo = @{ @"style": style };
@@ -994,6 +1060,190 @@ static BOOL s_NoDKDefaults = NO;
 	return [obj uniqueKey];
 }
 
+// the registry's indexes follow the styles added and removed individually. Wholesale changes discard them to be built again when needed.
+
+- (void)addObject:(id)obj forKey:(NSString*)name toCategory:(NSString*)catName createCategory:(BOOL)cg
+{
+	DKStyle* replaced = [self styleForKey:name];
+
+	[super addObject:obj
+				forKey:name
+			toCategory:catName
+		createCategory:cg];
+
+	if (replaced != obj)
+		[self unindexStyle:replaced];
+
+	[self indexStyle:obj];
+}
+
+- (void)addObject:(id)obj forKey:(NSString*)name toCategories:(NSArray*)catNames createCategories:(BOOL)cg
+{
+	DKStyle* replaced = [self styleForKey:name];
+
+	[super addObject:obj
+				  forKey:name
+			toCategories:catNames
+		createCategories:cg];
+
+	if (replaced != obj)
+		[self unindexStyle:replaced];
+
+	[self indexStyle:obj];
+}
+
+- (void)removeObjectForKey:(NSString*)key
+{
+	DKStyle* style = [self styleForKey:key];
+
+	[super removeObjectForKey:key];
+	[self unindexStyle:style];
+}
+
+- (void)removeAllCategories
+{
+	[super removeAllCategories];
+	[self invalidateIndexes];
+}
+
+- (BOOL)replaceContentsWithData:(NSData*)data
+{
+	[self invalidateIndexes];
+	return [super replaceContentsWithData:data];
+}
+
+#pragma mark -
+#pragma mark - indexing styles
+
+- (void)buildIndexesIfNeeded
+{
+	if (mIndexEntries != nil)
+		return;
+
+	mEquivalenceIndex = [NSMutableDictionary dictionary];
+	mNameIndex = [NSMutableDictionary dictionary];
+	mIndexEntries = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+										  valueOptions:NSPointerFunctionsStrongMemory];
+
+	for (DKStyle* style in [self allObjects])
+		[self indexStyle:style];
+}
+
+- (void)invalidateIndexes
+{
+	mEquivalenceIndex = nil;
+	mNameIndex = nil;
+	mIndexEntries = nil;
+}
+
+- (void)indexStyle:(DKStyle*)aStyle
+{
+	// until the indexes are first needed there is nothing to keep up to date
+
+	if (mIndexEntries == nil || aStyle == nil)
+		return;
+
+	[self unindexStyle:aStyle];
+
+	NSNumber* hash = @([aStyle equivalenceHash]);
+	NSString* name = [aStyle name] ?: @"";
+	NSMutableArray* bucket = [mEquivalenceIndex objectForKey:hash];
+
+	if (bucket == nil) {
+		bucket = [NSMutableArray array];
+		[mEquivalenceIndex setObject:bucket
+							  forKey:hash];
+	}
+
+	[bucket addObject:aStyle];
+
+	bucket = [mNameIndex objectForKey:name];
+
+	if (bucket == nil) {
+		bucket = [NSMutableArray array];
+		[mNameIndex setObject:bucket
+					   forKey:name];
+	}
+
+	[bucket addObject:aStyle];
+	[mIndexEntries setObject:@[hash, name]
+					  forKey:aStyle];
+}
+
+- (void)unindexStyle:(DKStyle*)aStyle
+{
+	NSArray* entry = aStyle ? [mIndexEntries objectForKey:aStyle] : nil;
+
+	if (entry == nil)
+		return;
+
+	NSNumber* hash = [entry objectAtIndex:0];
+	NSString* name = [entry objectAtIndex:1];
+	NSMutableArray* bucket = [mEquivalenceIndex objectForKey:hash];
+
+	[bucket removeObjectIdenticalTo:aStyle];
+
+	if ([bucket count] == 0)
+		[mEquivalenceIndex removeObjectForKey:hash];
+
+	bucket = [mNameIndex objectForKey:name];
+	[bucket removeObjectIdenticalTo:aStyle];
+
+	if ([bucket count] == 0)
+		[mNameIndex removeObjectForKey:name];
+
+	[mIndexEntries removeObjectForKey:aStyle];
+}
+
+- (void)reindexRenamedStyles
+{
+	NSMutableArray* renamed = [NSMutableArray array];
+
+	for (DKStyle* style in mIndexEntries) {
+		NSString* indexedName = [[mIndexEntries objectForKey:style] objectAtIndex:1];
+
+		if (![indexedName isEqualToString:[style name] ?: @""])
+			[renamed addObject:style];
+	}
+
+	for (DKStyle* style in renamed)
+		[self indexStyle:style];
+}
+
+- (void)setNameIndexIsCurrent:(BOOL)current
+{
+	if (current) {
+		[self buildIndexesIfNeeded];
+		[self reindexRenamedStyles];
+	}
+
+	mNameIndexIsCurrent = current;
+}
+
+- (BOOL)isStyleNameInUse:(NSString*)name
+{
+	[self buildIndexesIfNeeded];
+
+	// a style renamed since it was indexed is only found under its old name. Unless the registry is told of every rename, or has just been
+	// brought up to date for a merge, the name index is brought up to date before a miss is taken as final.
+
+	if ([mNameIndex objectForKey:name] == nil && !mNameIndexIsCurrent && !(self == s_styleRegistry && s_styleNotificationsEnabled))
+		[self reindexRenamedStyles];
+
+	NSArray* candidates = [[mNameIndex objectForKey:name] copy];
+
+	for (DKStyle* candidate in candidates) {
+		// a style renamed since it was indexed is moved to where it now belongs
+
+		if ([[candidate name] isEqualToString:name])
+			return YES;
+
+		[self indexStyle:candidate];
+	}
+
+	return NO;
+}
+
 #pragma mark -
 #pragma mark - as a CategoryManagerMenuItemDelegate
 
@@ -121,10 +121,11 @@
 				angle = atan2((CGFloat)y - cp.y, (CGFloat)x - cp.x) + M_PI;
 				colour = (NSUInteger)((angle * (CGFloat)nColours) / twopi);
 
-				// add a bit of random dither to the colour
+				// add a bit of random dither to the colour. The dither pattern is a fixed function of the pixel position, so the image is
+				// the same every time it is created.
 
 				if (m_ditherColours)
-					colour = (NSInteger)(colour + [DKRandom randomPositiveOrNegativeNumber] * 2.0) % nColours;
+					colour = (NSInteger)(colour + DKRandomSignedValue(0, (uint64_t)y * width + x) * 2.0) % nColours;
 
 				// write the colour to the image in one fell swoop
 
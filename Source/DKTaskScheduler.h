@@ -0,0 +1,117 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^DKTaskBlock)(void);
+
+/** @brief The lanes that tasks are queued in. A worker always runs any interactive task it can find before a background one. */
+typedef NS_ENUM(NSInteger, DKTaskPriority) {
+	kDKTaskPriorityInteractive = 0, ///< work that someone is waiting for, such as drawing
+	kDKTaskPriorityBackground = 1 ///< work that can wait, such as export or cache building
+};
+
+#define kDKTaskPriorityCount 2
+
+@class DKTaskScheduler;
+
+/** @brief A set of tasks that can be waited for or cancelled together.
+
+ A task added to a group that has been cancelled is not run, unless it had already started. Tasks can check \c isCancelled to stop early.
+ A group can be reused once all of its tasks have finished.
+*/
+@interface DKTaskGroup : NSObject
+
+/** @brief The number of tasks added to the group that have not yet finished, including those waiting on another group. */
+@property (readonly) NSUInteger pendingCount;
+
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+/** @brief Cancels the tasks in the group that have not started. */
+- (void)cancel;
+
+/** @brief Waits until every task in the group has finished, helping to run queued tasks meanwhile. */
+- (void)wait;
+
+@end
+
+#pragma mark -
+
+/** @brief A work-stealing scheduler for running tasks on a fixed set of worker threads.
+
+ Each worker has its own queue of tasks for each priority. A task added from a worker thread goes to the back of that worker's own
+ queue, and the worker takes tasks from the back, so related work tends to stay on one thread while it is still in the cache. A worker
+ that runs out of tasks steals from the front of another worker's queue. Tasks added from other threads go to a shared queue that
+ all the workers take from.
+
+ Waiting for a group - including the wait inside \c -parallelForRange:... - runs queued tasks on the waiting thread rather than
+ blocking it, so tasks may safely wait for other tasks.
+
+ The scheduler uses only pthreads and C11 atomics besides Foundation, so it is not tied to Grand Central Dispatch.
+
+ Nothing in the framework uses the scheduler yet, and nothing uses GCThreadQueue either: DKDrawingView imports it, but its threaded drawing
+ is compiled out. The scheduler is here for client code and for framework work that is later made parallel.
+*/
+@interface DKTaskScheduler : NSObject
+
+/** @brief The scheduler shared by the framework, with one worker per active processor. It is never invalidated. */
+@property (class, readonly, strong) DKTaskScheduler* sharedScheduler;
+
+/** @brief Creates a scheduler.
+
+ A scheduler's workers keep it alive, so a scheduler created this way must be sent \c -invalidate when it is no longer needed.
+ @param count the number of worker threads. If 0, one per active processor.
+ @return the scheduler
+ */
+- (instancetype)initWithWorkerCount:(NSUInteger)count NS_DESIGNATED_INITIALIZER;
+
+@property (readonly) NSUInteger workerCount;
+
+/** @brief Queues a background task, not in any group. */
+- (void)addTask:(DKTaskBlock)task;
+
+/** @brief Queues a task.
+ @param task the task
+ @param priority the lane to queue it in
+ @param group a group to add it to, or nil
+ */
+- (void)addTask:(DKTaskBlock)task priority:(DKTaskPriority)priority group:(nullable DKTaskGroup*)group;
+
+/** @brief Queues a task once every task in another group has finished.
+
+ The task is added to <group> straight away, so waiting for <group> includes waiting for <dependency>.
+ @param task the task
+ @param priority the lane to queue it in
+ @param dependency the group to wait for. If it has no tasks, the task is queued at once.
+ @param group a group to add it to, or nil
+ */
+- (void)addTask:(DKTaskBlock)task priority:(DKTaskPriority)priority afterGroup:(DKTaskGroup*)dependency group:(nullable DKTaskGroup*)group;
+
+/** @brief Waits until every task in a group has finished, running queued tasks on the calling thread meanwhile. */
+- (void)waitForGroup:(DKTaskGroup*)group;
+
+/** @brief Runs a block over every index in a range, dividing the range between the workers and the calling thread.
+
+ Returns when every part of the range has been run, or when <group> is cancelled and the parts already started have finished.
+ @param range the range of indexes
+ @param grain the number of indexes given to the block at a time. If 0, a size giving each worker about eight parts is chosen.
+ @param priority the lane to queue the helper tasks in
+ @param group a group whose cancellation stops the loop, or nil
+ @param body the block, which is passed a part of <range> and must be safe to call concurrently
+ */
+- (void)parallelForRange:(NSRange)range grainSize:(NSUInteger)grain priority:(DKTaskPriority)priority group:(nullable DKTaskGroup*)group body:(void (^)(NSRange subrange))body;
+
+/** @brief Lets the workers finish the tasks already queued, then stops them and waits for them to exit.
+
+ Must not be called from a worker thread. Tasks added afterwards run at once on the adding thread.
+ */
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
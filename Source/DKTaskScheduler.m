@@ -0,0 +1,595 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKTaskScheduler.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+// the worker threads get more stack than the usual secondary thread, as tasks that wait help to run other tasks and so nest
+
+#define DK_TASK_WORKER_STACK_SIZE (4 * 1024 * 1024)
+
+// how long a thread waiting for a group sleeps when there is nothing it can help with before looking for work again
+
+#define DK_TASK_WAIT_INTERVAL_NS 1000000
+
+// a queued task. Both pointers hold a retain, which is handed back to ARC when the task is run.
+
+typedef struct {
+	void* block;
+	void* group;
+} DKTaskItem;
+
+// a growable ring buffer of tasks, used as a deque. Its owner protects it with a lock.
+
+typedef struct {
+	DKTaskItem* items;
+	NSUInteger capacity;
+	NSUInteger head;
+	NSUInteger count;
+} DKTaskRing;
+
+static void DKTaskRingPushBack(DKTaskRing* ring, DKTaskItem item)
+{
+	if (ring->count == ring->capacity) {
+		NSUInteger i, capacity = MAX(ring->capacity * 2, 64);
+		DKTaskItem* items = malloc(capacity * sizeof(DKTaskItem));
+
+		for (i = 0; i < ring->count; ++i)
+			items[i] = ring->items[(ring->head + i) % ring->capacity];
+
+		free(ring->items);
+		ring->items = items;
+		ring->capacity = capacity;
+		ring->head = 0;
+	}
+
+	ring->items[(ring->head + ring->count) % ring->capacity] = item;
+	ring->count++;
+}
+
+static BOOL DKTaskRingPopBack(DKTaskRing* ring, DKTaskItem* item)
+{
+	if (ring->count == 0)
+		return NO;
+
+	ring->count--;
+	*item = ring->items[(ring->head + ring->count) % ring->capacity];
+	return YES;
+}
+
+static BOOL DKTaskRingPopFront(DKTaskRing* ring, DKTaskItem* item)
+{
+	if (ring->count == 0)
+		return NO;
+
+	*item = ring->items[ring->head];
+	ring->head = (ring->head + 1) % ring->capacity;
+	ring->count--;
+	return YES;
+}
+
+// one worker thread and its deques, one per priority
+
+typedef struct {
+	pthread_mutex_t lock;
+	DKTaskRing lanes[kDKTaskPriorityCount];
+	__unsafe_unretained DKTaskScheduler* scheduler;
+	NSUInteger index;
+	pthread_t thread;
+} DKTaskWorker;
+
+// the worker that the current thread is, if any
+
+static __thread DKTaskWorker* sCurrentWorker = NULL;
+
+@interface DKTaskGroup ()
+
+@property (weak) DKTaskScheduler* scheduler;
+
+- (void)taskWillBeAdded;
+- (void)taskDidFinish;
+- (BOOL)addCompletionTask:(DKTaskBlock)task;
+- (void)waitBriefly;
+
+@end
+
+@interface DKTaskScheduler ()
+
+- (void)enqueueItem:(DKTaskItem)item priority:(DKTaskPriority)priority;
+- (BOOL)takeItem:(DKTaskItem*)item forWorker:(DKTaskWorker*)worker;
+- (void)runWorker:(DKTaskWorker*)worker;
+
+@end
+
+// runs a queued task, unless its group has been cancelled, and releases it
+
+static void DKTaskRunItem(DKTaskItem item)
+{
+	DKTaskBlock block = (__bridge_transfer DKTaskBlock)item.block;
+	DKTaskGroup* group = (__bridge_transfer DKTaskGroup*)item.group;
+
+	if (group == nil || ![group isCancelled]) {
+		@autoreleasepool {
+			@try {
+				block();
+			}
+			@catch (NSException* exception) {
+				NSLog(@"DKTaskScheduler: a task raised an exception, ignored: %@", exception);
+			}
+		}
+	}
+
+	[group taskDidFinish];
+}
+
+static void* DKTaskWorkerMain(void* arg)
+{
+	DKTaskWorker* worker = arg;
+
+	sCurrentWorker = worker;
+
+	@autoreleasepool {
+		[[NSThread currentThread] setName:[NSString stringWithFormat:@"DKTaskScheduler worker %lu", (unsigned long)worker->index]];
+		[worker->scheduler runWorker:worker];
+	}
+
+	sCurrentWorker = NULL;
+	return NULL;
+}
+
+#pragma mark -
+
+@implementation DKTaskGroup {
+	atomic_long mPendingCount;
+	atomic_bool mCancelled;
+	pthread_mutex_t mLock;
+	pthread_cond_t mDone;
+	NSMutableArray<DKTaskBlock>* mCompletionTasks; // tasks to queue when the pending count reaches zero
+}
+
+@synthesize scheduler = mScheduler;
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		atomic_init(&mPendingCount, 0);
+		atomic_init(&mCancelled, false);
+		pthread_mutex_init(&mLock, NULL);
+		pthread_cond_init(&mDone, NULL);
+	}
+
+	return self;
+}
+
+- (void)dealloc
+{
+	pthread_cond_destroy(&mDone);
+	pthread_mutex_destroy(&mLock);
+}
+
+- (NSUInteger)pendingCount
+{
+	return (NSUInteger)MAX(atomic_load(&mPendingCount), 0);
+}
+
+- (BOOL)isCancelled
+{
+	return atomic_load(&mCancelled);
+}
+
+- (void)cancel
+{
+	atomic_store(&mCancelled, true);
+}
+
+- (void)wait
+{
+	DKTaskScheduler* scheduler = [self scheduler];
+
+	[scheduler ?: [DKTaskScheduler sharedScheduler] waitForGroup:self];
+}
+
+#pragma mark -
+
+- (void)taskWillBeAdded
+{
+	atomic_fetch_add(&mPendingCount, 1);
+}
+
+- (void)taskDidFinish
+{
+	if (atomic_fetch_sub(&mPendingCount, 1) != 1)
+		return;
+
+	pthread_mutex_lock(&mLock);
+	NSArray<DKTaskBlock>* completionTasks = mCompletionTasks;
+	mCompletionTasks = nil;
+	pthread_cond_broadcast(&mDone);
+	pthread_mutex_unlock(&mLock);
+
+	for (DKTaskBlock task in completionTasks)
+		task();
+}
+
+- (BOOL)addCompletionTask:(DKTaskBlock)task
+{
+	// returns NO if the group has no pending tasks, in which case the caller runs the task itself
+
+	pthread_mutex_lock(&mLock);
+
+	if (atomic_load(&mPendingCount) == 0) {
+		pthread_mutex_unlock(&mLock);
+		return NO;
+	}
+
+	if (mCompletionTasks == nil)
+		mCompletionTasks = [NSMutableArray array];
+
+	[mCompletionTasks addObject:[task copy]];
+	pthread_mutex_unlock(&mLock);
+	return YES;
+}
+
+- (void)waitBriefly
+{
+	pthread_mutex_lock(&mLock);
+
+	if (atomic_load(&mPendingCount) > 0) {
+		struct timespec deadline;
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += DK_TASK_WAIT_INTERVAL_NS;
+
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec += 1;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		pthread_cond_timedwait(&mDone, &mLock, &deadline);
+	}
+
+	pthread_mutex_unlock(&mLock);
+}
+
+@end
+
+#pragma mark -
+
+@implementation DKTaskScheduler {
+	DKTaskWorker* mWorkers;
+	NSUInteger mWorkerCount;
+	pthread_mutex_t mInjectLock; // protects mInjected
+	DKTaskRing mInjected[kDKTaskPriorityCount]; // tasks added from threads that are not workers
+	pthread_mutex_t mSleepLock;
+	pthread_cond_t mWake;
+	atomic_long mSleepers; // workers waiting on mWake
+	atomic_long mQueuedCount; // tasks queued and not yet taken
+	atomic_bool mStopping;
+	BOOL mInvalidated;
+}
+
++ (DKTaskScheduler*)sharedScheduler
+{
+	static DKTaskScheduler* sSharedScheduler = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sSharedScheduler = [[DKTaskScheduler alloc] initWithWorkerCount:0];
+	});
+
+	return sSharedScheduler;
+}
+
+- (instancetype)initWithWorkerCount:(NSUInteger)count
+{
+	self = [super init];
+	if (self) {
+		NSUInteger i;
+
+		if (count == 0)
+			count = MAX([[NSProcessInfo processInfo] activeProcessorCount], 1);
+
+		mWorkerCount = count;
+		mWorkers = calloc(count, sizeof(DKTaskWorker));
+		pthread_mutex_init(&mInjectLock, NULL);
+		pthread_mutex_init(&mSleepLock, NULL);
+		pthread_cond_init(&mWake, NULL);
+		atomic_init(&mSleepers, 0);
+		atomic_init(&mQueuedCount, 0);
+		atomic_init(&mStopping, false);
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setstacksize(&attr, DK_TASK_WORKER_STACK_SIZE);
+
+		// the workers keep the scheduler alive until -invalidate, so that it can't be deallocated by a worker
+
+		for (i = 0; i < count; ++i) {
+			DKTaskWorker* worker = &mWorkers[i];
+
+			pthread_mutex_init(&worker->lock, NULL);
+			worker->scheduler = (__bridge DKTaskScheduler*)(__bridge_retained void*)self;
+			worker->index = i;
+			pthread_create(&worker->thread, &attr, DKTaskWorkerMain, worker);
+		}
+
+		pthread_attr_destroy(&attr);
+	}
+
+	return self;
+}
+
+- (instancetype)init
+{
+	return [self initWithWorkerCount:0];
+}
+
+- (void)dealloc
+{
+	NSUInteger i, p;
+
+	for (i = 0; i < mWorkerCount; ++i) {
+		for (p = 0; p < kDKTaskPriorityCount; ++p)
+			free(mWorkers[i].lanes[p].items);
+
+		pthread_mutex_destroy(&mWorkers[i].lock);
+	}
+
+	for (p = 0; p < kDKTaskPriorityCount; ++p)
+		free(mInjected[p].items);
+
+	free(mWorkers);
+	pthread_cond_destroy(&mWake);
+	pthread_mutex_destroy(&mSleepLock);
+	pthread_mutex_destroy(&mInjectLock);
+}
+
+@synthesize workerCount = mWorkerCount;
+
+- (void)addTask:(DKTaskBlock)task
+{
+	[self addTask:task
+		 priority:kDKTaskPriorityBackground
+			group:nil];
+}
+
+- (void)addTask:(DKTaskBlock)task priority:(DKTaskPriority)priority group:(DKTaskGroup*)group
+{
+	NSAssert(task != nil, @"cannot add a nil task");
+	NSAssert(priority >= 0 && priority < kDKTaskPriorityCount, @"invalid task priority %ld", (long)priority);
+
+	if (group) {
+		[group setScheduler:self];
+		[group taskWillBeAdded];
+	}
+
+	DKTaskItem item;
+	item.block = (__bridge_retained void*)[task copy];
+	item.group = (__bridge_retained void*)group;
+
+	if (atomic_load(&mStopping))
+		DKTaskRunItem(item);
+	else
+		[self enqueueItem:item
+				 priority:priority];
+}
+
+- (void)addTask:(DKTaskBlock)task priority:(DKTaskPriority)priority afterGroup:(DKTaskGroup*)dependency group:(DKTaskGroup*)group
+{
+	NSAssert(dependency != nil, @"cannot depend on a nil group");
+	NSAssert(dependency != group, @"a task cannot wait for its own group");
+
+	// the task joins its group now, and is queued by the dependency when that finishes
+
+	if (group) {
+		[group setScheduler:self];
+		[group taskWillBeAdded];
+	}
+
+	DKTaskBlock queueTask = ^{
+		[self addTask:task
+			 priority:priority
+				group:group];
+		[group taskDidFinish];
+	};
+
+	if (![dependency addCompletionTask:queueTask])
+		queueTask();
+}
+
+- (void)waitForGroup:(DKTaskGroup*)group
+{
+	DKTaskWorker* worker = (sCurrentWorker && sCurrentWorker->scheduler == self) ? sCurrentWorker : NULL;
+	DKTaskItem item;
+
+	while ([group pendingCount] > 0) {
+		if ([self takeItem:&item
+				 forWorker:worker])
+			DKTaskRunItem(item);
+		else
+			[group waitBriefly];
+	}
+}
+
+- (void)parallelForRange:(NSRange)range grainSize:(NSUInteger)grain priority:(DKTaskPriority)priority group:(DKTaskGroup*)group body:(void (^)(NSRange))body
+{
+	if (range.length == 0)
+		return;
+
+	if (grain == 0)
+		grain = MAX(range.length / (8 * (mWorkerCount + 1)), 1);
+
+	// the parts are handed out from a shared counter, so a thread that finishes early simply takes the next one
+
+	NSUInteger partCount = (range.length + grain - 1) / grain;
+	atomic_ulong* nextPart = malloc(sizeof(atomic_ulong));
+	atomic_init(nextPart, 0);
+
+	DKTaskBlock runParts = ^{
+		unsigned long part;
+
+		while ((group == nil || ![group isCancelled]) && (part = atomic_fetch_add(nextPart, 1)) < partCount) {
+			NSUInteger location = range.location + part * grain;
+			body(NSMakeRange(location, MIN(grain, NSMaxRange(range) - location)));
+		}
+	};
+
+	DKTaskGroup* helpers = [[DKTaskGroup alloc] init];
+	NSUInteger i, helperCount = MIN(mWorkerCount, partCount - 1);
+
+	for (i = 0; i < helperCount; ++i)
+		[self addTask:runParts
+			 priority:priority
+				group:helpers];
+
+	@try {
+		runParts();
+	}
+	@finally {
+		// if the body raised, stop handing out parts, but the helpers must still finish before the counter goes
+
+		atomic_store(nextPart, partCount);
+		[self waitForGroup:helpers];
+		free(nextPart);
+	}
+}
+
+- (void)invalidate
+{
+	NSAssert(sCurrentWorker == NULL || sCurrentWorker->scheduler != self, @"a scheduler cannot be invalidated from one of its own workers");
+
+	if (mInvalidated)
+		return;
+
+	mInvalidated = YES;
+	atomic_store(&mStopping, true);
+
+	pthread_mutex_lock(&mSleepLock);
+	pthread_cond_broadcast(&mWake);
+	pthread_mutex_unlock(&mSleepLock);
+
+	NSUInteger i;
+	DKTaskItem item;
+
+	for (i = 0; i < mWorkerCount; ++i)
+		pthread_join(mWorkers[i].thread, NULL);
+
+	// anything added while the workers were stopping is run here, so no group is left waiting
+
+	while ([self takeItem:&item
+				forWorker:NULL])
+		DKTaskRunItem(item);
+
+	for (i = 0; i < mWorkerCount; ++i)
+		CFBridgingRelease((__bridge CFTypeRef)mWorkers[i].scheduler);
+}
+
+#pragma mark -
+
+- (void)enqueueItem:(DKTaskItem)item priority:(DKTaskPriority)priority
+{
+	DKTaskWorker* worker = sCurrentWorker;
+
+	if (worker && worker->scheduler == self) {
+		pthread_mutex_lock(&worker->lock);
+		DKTaskRingPushBack(&worker->lanes[priority], item);
+		pthread_mutex_unlock(&worker->lock);
+	} else {
+		pthread_mutex_lock(&mInjectLock);
+		DKTaskRingPushBack(&mInjected[priority], item);
+		pthread_mutex_unlock(&mInjectLock);
+	}
+
+	// a sleeping worker counts itself before it checks the queued count, and we count the task before we check for sleepers,
+	// so at least one of us sees the other and the task can't be left with every worker asleep
+
+	atomic_fetch_add(&mQueuedCount, 1);
+
+	if (atomic_load(&mSleepers) > 0) {
+		pthread_mutex_lock(&mSleepLock);
+		pthread_cond_signal(&mWake);
+		pthread_mutex_unlock(&mSleepLock);
+	}
+}
+
+- (BOOL)takeItem:(DKTaskItem*)item forWorker:(DKTaskWorker*)worker
+{
+	if (atomic_load(&mQueuedCount) <= 0)
+		return NO;
+
+	NSUInteger p, k;
+	BOOL found = NO;
+
+	for (p = 0; p < kDKTaskPriorityCount && !found; ++p) {
+		// our own newest task first, then the oldest task of another worker, then the oldest task added from outside
+
+		if (worker) {
+			pthread_mutex_lock(&worker->lock);
+			found = DKTaskRingPopBack(&worker->lanes[p], item);
+			pthread_mutex_unlock(&worker->lock);
+		}
+
+		NSUInteger start = worker ? worker->index + 1 : 0;
+
+		for (k = 0; k < mWorkerCount && !found; ++k) {
+			DKTaskWorker* victim = &mWorkers[(start + k) % mWorkerCount];
+
+			if (victim == worker)
+				continue;
+
+			pthread_mutex_lock(&victim->lock);
+			found = DKTaskRingPopFront(&victim->lanes[p], item);
+			pthread_mutex_unlock(&victim->lock);
+		}
+
+		if (!found) {
+			pthread_mutex_lock(&mInjectLock);
+			found = DKTaskRingPopFront(&mInjected[p], item);
+			pthread_mutex_unlock(&mInjectLock);
+		}
+	}
+
+	if (found)
+		atomic_fetch_sub(&mQueuedCount, 1);
+
+	return found;
+}
+
+- (void)runWorker:(DKTaskWorker*)worker
+{
+	DKTaskItem item;
+
+	while (YES) {
+		if ([self takeItem:&item
+				 forWorker:worker]) {
+			DKTaskRunItem(item);
+			continue;
+		}
+
+		if (atomic_load(&mQueuedCount) > 0) {
+			// another thread has counted a task it hasn't queued yet, or took the one we were after
+
+			sched_yield();
+			continue;
+		}
+
+		if (atomic_load(&mStopping))
+			break;
+
+		pthread_mutex_lock(&mSleepLock);
+		atomic_fetch_add(&mSleepers, 1);
+
+		while (atomic_load(&mQueuedCount) <= 0 && !atomic_load(&mStopping))
+			pthread_cond_wait(&mWake, &mSleepLock);
+
+		atomic_fetch_sub(&mSleepers, 1);
+		pthread_mutex_unlock(&mSleepLock);
+	}
+}
+
+@end
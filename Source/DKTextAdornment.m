@@ -17,6 +17,7 @@
 #import "DKShapeGroup.h"
 #import "DKStroke.h"
 #import "DKStyle.h"
+#import "DKTextLayoutCache.h"
 #import "DKTextSubstitutor.h"
 #import "LogEvent.h"
 #import "NSAttributedString+DKAdditions.h"
@@ -28,6 +29,8 @@
 
 - (void)drawText:(NSTextStorage*)contents withObject:(id<DKRenderable>)obj withPath:(NSBezierPath*)path;
 - (void)drawText:(NSTextStorage*)contents withObject:(id<DKRenderable>)obj withPath:(NSBezierPath*)path layoutManager:(NSLayoutManager*)lm;
+- (void)drawText:(NSTextStorage*)contents withObject:(id<DKRenderable>)obj withPath:(NSBezierPath*)path layoutManager:(NSLayoutManager*)lm textSize:(NSSize*)usedSize textOrigin:(NSPoint*)origin;
+- (NSBezierPath*)capturedTextPathForText:(NSTextStorage*)str withObject:(id)object withPath:(NSBezierPath*)path;
 - (void)drawText:(NSTextStorage*)contents centredAtPoint:(NSPoint)p;
 - (NSAffineTransform*)textTransformForObject:(id<DKRenderable>)obj;
 - (void)drawKnockoutWithObject:(id<DKRenderable>)obj;
@@ -57,6 +60,13 @@ static NSString* const kDKTextAdornmentMaskPathCacheKey = @"DKTextAdornmentMaskP
 static NSString* const kDKTextAdornmentMaskObjectChecksumCacheKey = @"DKTextAdornmentMaskObjectChecksum";
 static NSString* const kDKTextAdornmentMetadataChecksumCacheKey = @"DKTextAdornmentMetadataChecksum";
 
+// keys in layouts stored in the shared text layout cache
+
+static NSString* const kDKTextAdornmentLayoutPathKey = @"DKTextAdornmentLayoutPath";
+static NSString* const kDKTextAdornmentLayoutSizeKey = @"DKTextAdornmentLayoutSize";
+static NSString* const kDKTextAdornmentLayoutFittedKey = @"DKTextAdornmentLayoutFitted";
+static NSString* const kDKTextAdornmentLayoutPaddingKey = @"DKTextAdornmentLayoutPadding";
+
 @implementation DKTextAdornment
 
 static CGFloat s_maximumVerticalOffset = DEFAULT_BASELINE_OFFSET_MAX;
@@ -205,29 +215,99 @@ static CGFloat s_maximumVerticalOffset = DEFAULT_BASELINE_OFFSET_MAX;
 		return [path bezierPathWithTextOnPath:str
 									  yOffset:baseOffset];
 	} else {
-		DKBezierLayoutManager* captureLM = sharedCaptureLayoutManager();
-		[[captureLM textPath] removeAllPoints];
+		NSBezierPath* newPath = [self capturedTextPathForText:str
+												   withObject:object
+													 withPath:path];
 
-		// by drawing into a temporary flipped image context, text will be right side up with its lines in the right order
+		// position it aligned with the object
 
-		NSImage* tempImage = [[NSImage alloc] initWithSize:NSMakeSize(1, 1)];
-		[tempImage lockFocusFlipped:YES];
+		NSAffineTransform* tfm = [self textTransformForObject:object];
+		[newPath transformUsingAffineTransform:tfm];
 
-		[self drawText:str
-			   withObject:object
-				 withPath:path
-			layoutManager:captureLM];
-		[tempImage unlockFocus];
+		return newPath;
+	}
+}
 
-		// get the text path and position it aligned with the object
+- (NSBezierPath*)capturedTextPathForText:(NSTextStorage*)str withObject:(id)object withPath:(NSBezierPath*)path
+{
+	// returns the laid out text as a path, not yet transformed to the object. Text laid out in a rectangle only depends on the
+	// string, the container size and whether lines wrap, so the layout (positioned at the origin) is shared with other adornments
+	// through the text layout cache. Only the text origin, which depends on this adornment's alignment settings, is applied here.
+	// Flowed text depends on the path shape so is always laid out afresh.
 
-		NSBezierPath* newPath = [[captureLM textPath] copy];
+	DKBezierLayoutManager* captureLM = sharedCaptureLayoutManager();
+	DKBezierTextContainer* bc = (id)[[captureLM textContainers] lastObject];
+	DKTextLayoutCache* layoutCache = [DKTextLayoutCache sharedTextLayoutCache];
+	BOOL cacheable = ([self layoutMode] == kDKTextLayoutInBoundingRect);
+	NSInteger mode = [self layoutMode] | ([self wrapsLines] ? 0 : kDKTextLayoutFirstLineOnly);
 
-		NSAffineTransform* tfm = [self textTransformForObject:object];
-		[newPath transformUsingAffineTransform:tfm];
+	NSSize osize = object ? [(id<DKRenderable>)object size] : [path bounds].size;
 
-		return newPath;
+	if ([self allowsTextToExtendHorizontally])
+		osize.width = 50000;
+
+	if (cacheable) {
+		NSDictionary* layout = [layoutCache layoutForString:str
+											  containerSize:osize
+												 layoutMode:mode];
+
+		// the padding is a property of the shared container, so must match too
+
+		if (layout && [[layout objectForKey:kDKTextAdornmentLayoutPaddingKey] doubleValue] == [bc lineFragmentPadding]) {
+			NSSize textSize = [[layout objectForKey:kDKTextAdornmentLayoutSizeKey] sizeValue];
+			NSPoint textOrigin = [self textOriginForSize:textSize
+											  objectSize:osize];
+			mLastLayoutFittedAllText = [[layout objectForKey:kDKTextAdornmentLayoutFittedKey] boolValue];
+
+			NSBezierPath* newPath = [[layout objectForKey:kDKTextAdornmentLayoutPathKey] copy];
+			NSAffineTransform* tfm = [NSAffineTransform transform];
+			[tfm translateXBy:textOrigin.x
+						  yBy:textOrigin.y];
+			[newPath transformUsingAffineTransform:tfm];
+
+			return newPath;
+		}
 	}
+
+	[[captureLM textPath] removeAllPoints];
+
+	// by drawing into a temporary flipped image context, text will be right side up with its lines in the right order
+
+	NSSize textSize = NSZeroSize;
+	NSPoint textOrigin = NSZeroPoint;
+	NSImage* tempImage = [[NSImage alloc] initWithSize:NSMakeSize(1, 1)];
+	[tempImage lockFocusFlipped:YES];
+
+	[self drawText:str
+		   withObject:object
+			 withPath:path
+		layoutManager:captureLM
+			 textSize:&textSize
+		   textOrigin:&textOrigin];
+	[tempImage unlockFocus];
+
+	NSBezierPath* newPath = [[captureLM textPath] copy];
+
+	if (cacheable) {
+		NSBezierPath* layoutPath = [newPath copy];
+		NSAffineTransform* tfm = [NSAffineTransform transform];
+		[tfm translateXBy:-textOrigin.x
+					  yBy:-textOrigin.y];
+		[layoutPath transformUsingAffineTransform:tfm];
+
+		NSDictionary* layout = @{ kDKTextAdornmentLayoutPathKey: layoutPath,
+			kDKTextAdornmentLayoutSizeKey: [NSValue valueWithSize:textSize],
+			kDKTextAdornmentLayoutFittedKey: @(mLastLayoutFittedAllText),
+			kDKTextAdornmentLayoutPaddingKey: @([bc lineFragmentPadding]) };
+
+		[layoutCache setLayout:layout
+						  cost:[layoutPath elementCount] * sizeof(NSPoint) * 3
+					 forString:str
+				 containerSize:osize
+					layoutMode:mode];
+	}
+
+	return newPath;
 }
 
 - (NSArray*)textPathsForObject:(id)object usedSize:(NSSize*)aSize
@@ -995,6 +1075,18 @@ static CGFloat s_maximumVerticalOffset = DEFAULT_BASELINE_OFFSET_MAX;
 
 - (void)drawText:(NSTextStorage*)contents withObject:(id<DKRenderable>)obj withPath:(NSBezierPath*)path layoutManager:(NSLayoutManager*)lm
 {
+	[self drawText:contents
+		   withObject:obj
+			 withPath:path
+		layoutManager:lm
+			 textSize:NULL
+		   textOrigin:NULL];
+}
+
+- (void)drawText:(NSTextStorage*)contents withObject:(id<DKRenderable>)obj withPath:(NSBezierPath*)path layoutManager:(NSLayoutManager*)lm textSize:(NSSize*)usedSize textOrigin:(NSPoint*)origin
+{
+	// draws the text, and optionally returns the size of the laid out text and where it was drawn
+
 	NSAssert(lm != nil, @"there must be a valid layout manager when calling -drawText:withObject:withPath:layoutManager:");
 
 	if ([contents length] > 0) {
@@ -1068,6 +1160,12 @@ static CGFloat s_maximumVerticalOffset = DEFAULT_BASELINE_OFFSET_MAX;
 			if ([self layoutMode] == kDKTextLayoutFlowedInPath && [self flowedTextPathInset] != 0.0)
 				textOrigin.y += [self flowedTextPathInset] * 0.5;
 
+			if (usedSize)
+				*usedSize = textSize;
+
+			if (origin)
+				*origin = textOrigin;
+
 			// Thread safety in case we are not on the main thread, per https://developer.apple.com/documentation/uikit/nslayoutmanager
 			[lm setBackgroundLayoutEnabled:[NSThread isMainThread]];
 			[lm drawBackgroundForGlyphRange:grange
@@ -1489,6 +1587,14 @@ static CGFloat s_maximumVerticalOffset = DEFAULT_BASELINE_OFFSET_MAX;
 		@"placeholderString"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"label", @"placeholderString", @"textRect", @"angle", @"appliesObjectAngle",
+		@"wrapsLines", @"allowsTextToExtendHorizontally", @"verticalAlignment", @"verticalAlignmentProportion", @"layoutMode", @"flowedTextPathInset",
+		@"font", @"colour", @"alignment", @"capitalization", @"baseline", @"superscriptAttribute", @"kerning", @"paragraphStyle", @"outlineColour",
+		@"outlineWidth", @"textKnockoutDistance", @"textKnockoutColour", @"textKnockoutStrokeWidth", @"textKnockoutStrokeColour"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
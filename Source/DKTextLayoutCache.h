@@ -0,0 +1,64 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Cocoa/Cocoa.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** @brief A framework-wide cache of glyph outlines and laid-out text.
+
+ Text adornments and text-on-path frequently convert the same strings in the same fonts to paths - part numbers, dimension labels and so on.
+ This cache shares that work between all objects. Glyph outlines are keyed by font and glyph, and are stored with the glyph's origin at 0,0.
+ Layouts are opaque objects supplied by the client, keyed by the attributed string, the size of the container it was laid out in and a layout mode.
+
+ Both caches are bounded by an approximate memory cost and will discard entries as needed, so clients must always be prepared to recompute.
+ Returned objects are shared and must not be mutated - copy them first.
+*/
+@interface DKTextLayoutCache : NSObject {
+@private
+	NSCache* mOutlineCache;
+	NSCache* mLayoutCache;
+}
+
+/** @brief Returns the shared cache. */
+@property (class, readonly, strong) DKTextLayoutCache* sharedTextLayoutCache;
+
+/** @brief Returns the outline of a glyph, with the glyph's origin at 0,0.
+ @param glyph the glyph
+ @param font the font the glyph belongs to. If nil, an empty path is returned.
+ @return a shared path, which must not be mutated
+ */
+- (NSBezierPath*)outlineForGlyph:(NSGlyph)glyph inFont:(nullable NSFont*)font;
+
+/** @brief Returns a layout previously stored for the given string, container size and mode.
+ @param str the attributed string that was laid out
+ @param size the size of the container the string was laid out in
+ @param mode a client-defined layout mode
+ @return the stored layout, or \c nil
+ */
+- (nullable id)layoutForString:(NSAttributedString*)str containerSize:(NSSize)size layoutMode:(NSInteger)mode;
+
+/** @brief Stores a layout for the given string, container size and mode.
+ @param layout any object representing the result of the layout
+ @param cost an estimate of the memory used by <layout>, in bytes
+ @param str the attributed string that was laid out. It is copied.
+ @param size the size of the container the string was laid out in
+ @param mode a client-defined layout mode
+ */
+- (void)setLayout:(id)layout cost:(NSUInteger)cost forString:(NSAttributedString*)str containerSize:(NSSize)size layoutMode:(NSInteger)mode;
+
+/** @brief The approximate memory limit for glyph outlines, in bytes. */
+@property NSUInteger outlineCacheLimit;
+
+/** @brief The approximate memory limit for layouts, in bytes. */
+@property NSUInteger layoutCacheLimit;
+
+/** @brief Discards everything in the cache. */
+- (void)removeAllObjects;
+
+@end
+
+NS_ASSUME_NONNULL_END
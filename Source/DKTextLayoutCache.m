@@ -0,0 +1,222 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKTextLayoutCache.h"
+#import "DKInstrumentation.h"
+
+#define DEFAULT_OUTLINE_CACHE_LIMIT (4 * 1024 * 1024)
+#define DEFAULT_LAYOUT_CACHE_LIMIT (8 * 1024 * 1024)
+
+// approximate memory used by one path element, including its points
+
+#define PATH_ELEMENT_COST 48
+
+/** key for a glyph outline. Fonts compare equal when they have the same name, size and matrix. */
+@interface DKGlyphOutlineKey : NSObject <NSCopying> {
+@public
+	NSFont* mFont;
+	NSGlyph mGlyph;
+}
+@end
+
+@implementation DKGlyphOutlineKey
+
+- (NSUInteger)hash
+{
+	return [mFont hash] ^ (mGlyph * 2654435761U);
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKGlyphOutlineKey class]])
+		return NO;
+
+	DKGlyphOutlineKey* other = object;
+	return other->mGlyph == mGlyph && (other->mFont == mFont || [other->mFont isEqual:mFont]);
+}
+
+- (id)copyWithZone:(NSZone*)zone
+{
+#pragma unused(zone)
+	return self;
+}
+
+@end
+
+#pragma mark -
+
+/** key for a layout. Lookups use a temporary key that refers to the caller's string; stored keys hold an immutable copy. */
+@interface DKTextLayoutKey : NSObject <NSCopying> {
+@public
+	NSAttributedString* mString;
+	NSSize mSize;
+	NSInteger mMode;
+	NSUInteger mHash;
+}
+@end
+
+static NSUInteger DKTextLayoutKeyHash(NSAttributedString* str, NSSize size, NSInteger mode)
+{
+	return [[str string] hash] ^ ((NSUInteger)(size.width * 31.0 + size.height) * 2654435761U) ^ (NSUInteger)mode;
+}
+
+@implementation DKTextLayoutKey
+
+- (NSUInteger)hash
+{
+	return mHash;
+}
+
+- (BOOL)isEqual:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (![object isKindOfClass:[DKTextLayoutKey class]])
+		return NO;
+
+	DKTextLayoutKey* other = object;
+	return other->mHash == mHash && other->mMode == mMode && NSEqualSizes(other->mSize, mSize) && [other->mString isEqualToAttributedString:mString];
+}
+
+- (id)copyWithZone:(NSZone*)zone
+{
+#pragma unused(zone)
+	return self;
+}
+
+@end
+
+#pragma mark -
+
+@implementation DKTextLayoutCache
+
++ (DKTextLayoutCache*)sharedTextLayoutCache
+{
+	static DKTextLayoutCache* sCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sCache = [[DKTextLayoutCache alloc] init];
+	});
+
+	return sCache;
+}
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		mOutlineCache = [[NSCache alloc] init];
+		[mOutlineCache setName:@"DKTextLayoutCache.outlines"];
+		[mOutlineCache setTotalCostLimit:DEFAULT_OUTLINE_CACHE_LIMIT];
+
+		mLayoutCache = [[NSCache alloc] init];
+		[mLayoutCache setName:@"DKTextLayoutCache.layouts"];
+		[mLayoutCache setTotalCostLimit:DEFAULT_LAYOUT_CACHE_LIMIT];
+	}
+
+	return self;
+}
+
+- (NSBezierPath*)outlineForGlyph:(NSGlyph)glyph inFont:(NSFont*)font
+{
+	// without a font there is no outline, but return an empty path so that callers can treat this like any other glyph
+
+	if (font == nil)
+		return [NSBezierPath bezierPath];
+
+	DKGlyphOutlineKey* key = [[DKGlyphOutlineKey alloc] init];
+	key->mFont = font;
+	key->mGlyph = glyph;
+
+	NSBezierPath* outline = [mOutlineCache objectForKey:key];
+
+	if (outline == nil) {
+		DK_INSTRUMENT_COUNT("cache", "glyph outline misses", 1);
+
+		outline = [NSBezierPath bezierPath];
+		[outline moveToPoint:NSZeroPoint];
+		[outline appendBezierPathWithGlyph:glyph
+									inFont:font];
+
+		[mOutlineCache setObject:outline
+						  forKey:key
+							cost:[outline elementCount] * PATH_ELEMENT_COST];
+	} else
+		DK_INSTRUMENT_COUNT("cache", "glyph outline hits", 1);
+
+	return outline;
+}
+
+- (id)layoutForString:(NSAttributedString*)str containerSize:(NSSize)size layoutMode:(NSInteger)mode
+{
+	if (str == nil)
+		return nil;
+
+	DKTextLayoutKey* key = [[DKTextLayoutKey alloc] init];
+	key->mString = str;
+	key->mSize = size;
+	key->mMode = mode;
+	key->mHash = DKTextLayoutKeyHash(str, size, mode);
+
+	id layout = [mLayoutCache objectForKey:key];
+
+	if (layout)
+		DK_INSTRUMENT_COUNT("cache", "text layout hits", 1);
+	else
+		DK_INSTRUMENT_COUNT("cache", "text layout misses", 1);
+
+	return layout;
+}
+
+- (void)setLayout:(id)layout cost:(NSUInteger)cost forString:(NSAttributedString*)str containerSize:(NSSize)size layoutMode:(NSInteger)mode
+{
+	NSAssert(layout != nil, @"cannot cache a nil layout");
+	NSAssert(str != nil, @"cannot cache a layout for a nil string");
+
+	DKTextLayoutKey* key = [[DKTextLayoutKey alloc] init];
+	key->mString = [[NSAttributedString alloc] initWithAttributedString:str];
+	key->mSize = size;
+	key->mMode = mode;
+	key->mHash = DKTextLayoutKeyHash(str, size, mode);
+
+	// the key's copy of the string is counted as well as the layout itself
+
+	[mLayoutCache setObject:layout
+					 forKey:key
+					   cost:cost + [str length] * 4];
+}
+
+- (NSUInteger)outlineCacheLimit
+{
+	return [mOutlineCache totalCostLimit];
+}
+
+- (void)setOutlineCacheLimit:(NSUInteger)limit
+{
+	[mOutlineCache setTotalCostLimit:limit];
+}
+
+- (NSUInteger)layoutCacheLimit
+{
+	return [mLayoutCache totalCostLimit];
+}
+
+- (void)setLayoutCacheLimit:(NSUInteger)limit
+{
+	[mLayoutCache setTotalCostLimit:limit];
+}
+
+- (void)removeAllObjects
+{
+	[mOutlineCache removeAllObjects];
+	[mLayoutCache removeAllObjects];
+}
+
+@end
@@ -18,11 +18,17 @@ NS_ASSUME_NONNULL_BEGIN
  
  A non-property key can also have further flags, called subKeys. These are "." delimited single character attributes which invoke specific behaviours. By default these
  are the digits 0-9 which extract the nth word from the original data, and the flags U, L and C which convert the data to upper, lower and capitalized strings respectively.
+
+ The master string is compiled into a flat list of literal runs and key lookups the first time it is used. Results are cached per object and
+ reused until the object's metadata checksum changes, unless the string contains property keypaths ($-keys), which can change independently of the metadata.
 */
 @interface DKTextSubstitutor : NSObject <NSCoding> {
 	NSAttributedString* mMasterString;
 	NSMutableArray* mKeys;
 	BOOL mNeedsToEvaluate;
+	NSArray* mInstructions; // compiled form of the master string
+	BOOL mHasPropertyKeys; // YES if any key is a property keypath, which disables result caching
+	NSMapTable* mResultCache; // object -> cached substitution result
 }
 
 @property (class, copy, nullable) NSString* delimiterString;
@@ -50,6 +56,15 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSArray<NSString*>*)allKeys;
 
 - (nullable NSAttributedString*)substitutedStringWithObject:(id)anObject;
+
+/** @brief Performs the substitution for each object in turn, compiling the master string once.
+ @param objects a list of objects that implement -metadataObjectForKey:
+ @return a list of substituted strings, in the same order as <objects>
+ */
+- (NSArray<NSAttributedString*>*)substitutedStringsWithObjects:(NSArray*)objects;
+
+/** @brief Discards all cached substitution results. Call this if metadata was changed without going through the metadata API. */
+- (void)invalidateSubstitutionCache;
 - (nullable NSString*)metadataStringFromObject:(id)object;
 
 @end
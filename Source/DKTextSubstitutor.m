@@ -13,6 +13,33 @@ NSString* const kDKTextSubstitutorNewStringNotification = @"kDKTextSubstitutorNe
 
 #define TS_LAZY_EVALUATION 1
 
+static NSString* const kDKTextSubstitutorCacheChecksumKey = @"DKTextSubstitutor_checksum";
+static NSString* const kDKTextSubstitutorCacheResultKey = @"DKTextSubstitutor_result";
+
+/** one step of a compiled substitution: either a literal run of the master string, or a key lookup whose result takes on the
+ attributes the master string has at the start of the key.
+ */
+@interface DKTextSubstitutionInstruction : NSObject {
+@public
+	NSAttributedString* mLiteral;
+	DKTextSubstitutionKey* mKey;
+	NSString* mLookupKey;
+	NSDictionary* mAttributes;
+}
+@end
+
+@implementation DKTextSubstitutionInstruction
+@end
+
+#pragma mark -
+
+@interface DKTextSubstitutor ()
+
+- (void)compileMasterString;
+- (NSAttributedString*)evaluateWithObject:(id)anObject;
+
+@end
+
 @implementation DKTextSubstitutor
 
 static NSString* sDelimiter = DEFAULT_DELIMITER_STRING;
@@ -68,6 +95,8 @@ static NSString* sDelimiter = DEFAULT_DELIMITER_STRING;
 		NSString* oldString = [self string];
 
 		mMasterString = master;
+		mInstructions = nil;
+		[mResultCache removeAllObjects];
 
 		// for lazy evaluation, do not process the string immediately. Instead this will be done when the substitutor is asked to
 		// perform its first substitution. This is only flagged if the actual string content has changed.
@@ -217,6 +246,8 @@ static NSString* sDelimiter = DEFAULT_DELIMITER_STRING;
 	}
 
 	mNeedsToEvaluate = NO;
+	mInstructions = nil;
+	[mResultCache removeAllObjects];
 
 	LogEvent_(kReactiveEvent, @"completed processing of string '%@', result = %@", mMasterString, mKeys);
 }
@@ -226,53 +257,139 @@ static NSString* sDelimiter = DEFAULT_DELIMITER_STRING;
 	return [mKeys valueForKey:@"key"];
 }
 
-- (NSAttributedString*)substitutedStringWithObject:(id)anObject
+- (void)compileMasterString
 {
-// given an object that implements -metadataObjectForKey, this returns a string which is formed by substituting the metadata values in place of
-// the embedded keys in the master string.
-
-// For lazy evaluation, perform the evaluation now if no keys are currently stored.
+	// converts the master string and its keys into a flat list of instructions, so that each substitution only has to look up values
+	// and append runs, rather than rescanning and editing a copy of the master string.
 
 #if TS_LAZY_EVALUATION
 	if ([mKeys count] == 0 && [self masterString] != nil && mNeedsToEvaluate)
 		[self processMasterString];
 #endif
 
-	// even after lazy evaluation there may be no substitutions to do - in which case just return the original string
+	NSMutableArray* instructions = [NSMutableArray arrayWithCapacity:[mKeys count] * 2 + 1];
+	NSAttributedString* master = [self masterString];
+	NSUInteger index = 0;
+
+	mHasPropertyKeys = NO;
+
+	for (DKTextSubstitutionKey* key in mKeys) {
+		NSRange range = [key range];
+		DKTextSubstitutionInstruction* inst;
+
+		if (range.location > index) {
+			inst = [[DKTextSubstitutionInstruction alloc] init];
+			inst->mLiteral = [master attributedSubstringFromRange:NSMakeRange(index, range.location - index)];
+			[instructions addObject:inst];
+		}
+
+		inst = [[DKTextSubstitutionInstruction alloc] init];
+		inst->mKey = key;
+		inst->mAttributes = [master attributesAtIndex:range.location
+									   effectiveRange:NULL];
+
+		inst->mLookupKey = [key key];
+
+		if ([key isPropertyKeyPath])
+			mHasPropertyKeys = YES;
+
+		[instructions addObject:inst];
+		index = NSMaxRange(range);
+	}
+
+	if (index < [master length]) {
+		DKTextSubstitutionInstruction* inst = [[DKTextSubstitutionInstruction alloc] init];
+		inst->mLiteral = [master attributedSubstringFromRange:NSMakeRange(index, [master length] - index)];
+		[instructions addObject:inst];
+	}
+
+	mInstructions = [instructions copy];
+}
+
+- (NSAttributedString*)evaluateWithObject:(id)anObject
+{
+	BOOL canLookUp = [anObject respondsToSelector:@selector(metadataObjectForKey:)];
+	NSMutableAttributedString* newString = [[NSMutableAttributedString alloc] init];
+
+	[newString beginEditing];
+
+	for (DKTextSubstitutionInstruction* inst in mInstructions) {
+		if (inst->mLiteral)
+			[newString appendAttributedString:inst->mLiteral];
+		else if (canLookUp) {
+			id metaObject = [anObject metadataObjectForKey:inst->mLookupKey];
+
+			if (metaObject) {
+				NSString* subString = [inst->mKey stringByApplyingSubkeysToString:[self metadataStringFromObject:metaObject]];
+
+				if ([subString length] > 0) {
+					NSAttributedString* run = [[NSAttributedString alloc] initWithString:subString
+																			  attributes:inst->mAttributes];
+					[newString appendAttributedString:run];
+				}
+			}
+		}
+	}
+
+	[newString endEditing];
+
+	return newString;
+}
+
+- (NSAttributedString*)substitutedStringWithObject:(id)anObject
+{
+	// given an object that implements -metadataObjectForKey, this returns a string which is formed by substituting the metadata values in place of
+	// the embedded keys in the master string.
+
+	if (mInstructions == nil)
+		[self compileMasterString];
+
+	// there may be no substitutions to do - in which case just return the original string
 
 	if ([mKeys count] == 0)
 		return [self masterString];
 
-	// apply keys:
+	// results only depend on the object's metadata unless property keypaths are used, so can be reused until the metadata checksum changes
 
-	NSMutableAttributedString* newString = [[self masterString] mutableCopy];
+	if (mHasPropertyKeys || anObject == nil || ![anObject respondsToSelector:@selector(metadataChecksum)])
+		return [self evaluateWithObject:anObject];
 
-	NSInteger rangeAdjustment = 0;
+	NSUInteger checksum = [anObject metadataChecksum];
+	NSDictionary* entry = [mResultCache objectForKey:anObject];
 
-	for (DKTextSubstitutionKey* key in mKeys) {
-		NSString* subString = @"";
+	if (entry && [[entry objectForKey:kDKTextSubstitutorCacheChecksumKey] unsignedIntegerValue] == checksum)
+		return [entry objectForKey:kDKTextSubstitutorCacheResultKey];
 
-		if ([anObject respondsToSelector:@selector(metadataObjectForKey:)]) {
-			id metaObject = [anObject metadataObjectForKey:[key key]];
+	NSAttributedString* result = [self evaluateWithObject:anObject];
 
-			if (metaObject)
-				subString = [key stringByApplyingSubkeysToString:[self metadataStringFromObject:metaObject]];
-		}
+	if (mResultCache == nil)
+		mResultCache = [NSMapTable weakToStrongObjectsMapTable];
 
-		NSRange range = [key range];
+	[mResultCache setObject:@{ kDKTextSubstitutorCacheChecksumKey: @(checksum),
+		kDKTextSubstitutorCacheResultKey: result }
+					 forKey:anObject];
 
-		// compensate for string length changes:
+	return result;
+}
 
-		range.location += rangeAdjustment;
-		[newString replaceCharactersInRange:range
-								 withString:subString];
+- (NSArray*)substitutedStringsWithObjects:(NSArray*)objects
+{
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[objects count]];
 
-		// work out the range adjustment needed for the next one
+	if (mInstructions == nil)
+		[self compileMasterString];
 
-		rangeAdjustment += [subString length] - range.length;
+	for (id object in objects) {
+		NSAttributedString* str = [self substitutedStringWithObject:object];
+		[results addObject:str ? str : [[NSAttributedString alloc] init]];
 	}
 
-	return newString;
+	return results;
+}
+
+- (void)invalidateSubstitutionCache
+{
+	[mResultCache removeAllObjects];
 }
 
 - (NSString*)metadataStringFromObject:(id)object
@@ -5,6 +5,7 @@
 */
 
 #import "DKZigZagStroke.h"
+#import "DKStrokeDash.h"
 
 #import "NSBezierPath+Geometry.h"
 #import "NSObject+GraphicsAttributes.h"
@@ -35,6 +36,11 @@
 	return [[super observableKeyPaths] arrayByAddingObjectsFromArray:@[@"wavelength", @"amplitude", @"spread"]];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [[super equivalenceKeyPaths] arrayByAddingObjectsFromArray:@[@"wavelength", @"amplitude", @"spread"]];
+}
+
 - (void)registerActionNames
 {
 	[super registerActionNames];
@@ -79,7 +85,17 @@
 		NSBezierPath* rp = [path bezierPathWithWavelength:[self wavelength]
 												amplitude:[self amplitude]
 												   spread:[self spread]];
-		[super renderPath:rp];
+
+		// the zig-zag has many more elements than the path it follows, so rather than have it dashed afresh every time it's stroked,
+		// it's split into cached dashes which are stroked solid
+
+		if ([self dash]) {
+			NSBezierPath* pc = [[self dash] dashedPathForPath:[self strokablePathForPath:rp]];
+
+			[[self colour] setStroke];
+			[pc stroke];
+		} else
+			[super renderPath:rp];
 	} else
 		[super renderPath:path];
 }
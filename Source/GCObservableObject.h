@@ -43,6 +43,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (class, readonly, copy) NSArray<NSString*>* observableKeyPaths;
 
+/** @brief The properties that decide whether two objects are equivalent. The default is \c observableKeyPaths.
+
+ Subclasses can leave out properties that don't affect what the object is for, such as a name.
+ */
+@property (class, readonly, copy) NSArray<NSString*>* equivalenceKeyPaths;
+
+/** @brief A hash of the object's class and the values of its \c equivalenceKeyPaths. Equivalent objects have the same hash. */
+@property (readonly) NSUInteger equivalenceHash;
+
+/** @brief Whether another object is of the same class and has equivalent values for all of the \c equivalenceKeyPaths.
+
+ Values that implement \c -equivalenceHash and \c -isEquivalentToObject: themselves are compared that way, arrays and dictionaries
+ by their contents, and anything else with \c -isEqual:.
+ @param object the object to compare with
+ @return YES if the objects are equivalent
+ */
+- (BOOL)isEquivalentToObject:(nullable id)object;
+
 - (instancetype)init NS_DESIGNATED_INITIALIZER;
 
 - (BOOL)setUpKVOForObserver:(id)object;
@@ -81,6 +99,18 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/** @brief Hashes a property value in the same way as \c -equivalenceHash, for classes that implement equivalence themselves. */
+extern NSUInteger GCEquivalenceHashOfValue(id _Nullable value);
+
+/** @brief Compares two property values in the same way as \c -isEquivalentToObject:. */
+extern BOOL GCValuesAreEquivalent(id _Nullable a, id _Nullable b);
+
+/** @brief Mixes a value into a running hash. */
+static inline NSUInteger GCHashCombine(NSUInteger hash, NSUInteger value)
+{
+	return hash ^ (value + (NSUInteger)0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
 extern NSNotificationName const kDKObserverRelayDidReceiveChange;
 extern NSString* const kDKObservableKeyPath;
 
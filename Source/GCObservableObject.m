@@ -14,6 +14,82 @@ NSString* const kDKObservableKeyPath = @"kDKObservableKeyPath";
 #pragma mark Static Vars
 static NSMutableDictionary* sActionNameRegistry = nil;
 
+#pragma mark -
+#pragma mark Equivalence
+
+NSUInteger GCEquivalenceHashOfValue(id value)
+{
+	if (value == nil)
+		return 0;
+
+	if ([value respondsToSelector:@selector(equivalenceHash)])
+		return [value equivalenceHash];
+
+	if ([value isKindOfClass:[NSArray class]]) {
+		// order matters in an array, such as a list of renderers, so each element is mixed in turn
+
+		NSUInteger hash = [(NSArray*)value count];
+
+		for (id element in value)
+			hash = GCHashCombine(hash, GCEquivalenceHashOfValue(element));
+
+		return hash;
+	}
+
+	if ([value isKindOfClass:[NSDictionary class]]) {
+		// but not in a dictionary, so its entries are simply added
+
+		NSUInteger hash = [(NSDictionary*)value count];
+
+		for (id key in value)
+			hash += GCHashCombine([key hash], GCEquivalenceHashOfValue([value objectForKey:key]));
+
+		return hash;
+	}
+
+	return [value hash];
+}
+
+BOOL GCValuesAreEquivalent(id a, id b)
+{
+	if (a == b)
+		return YES;
+
+	if (a == nil || b == nil)
+		return NO;
+
+	if ([a respondsToSelector:@selector(isEquivalentToObject:)])
+		return [a isEquivalentToObject:b];
+
+	if ([a isKindOfClass:[NSArray class]]) {
+		if (![b isKindOfClass:[NSArray class]] || [(NSArray*)a count] != [(NSArray*)b count])
+			return NO;
+
+		NSUInteger i, count = [(NSArray*)a count];
+
+		for (i = 0; i < count; ++i) {
+			if (!GCValuesAreEquivalent([a objectAtIndex:i], [b objectAtIndex:i]))
+				return NO;
+		}
+
+		return YES;
+	}
+
+	if ([a isKindOfClass:[NSDictionary class]]) {
+		if (![b isKindOfClass:[NSDictionary class]] || [(NSDictionary*)a count] != [(NSDictionary*)b count])
+			return NO;
+
+		for (id key in a) {
+			if (!GCValuesAreEquivalent([a objectForKey:key], [b objectForKey:key]))
+				return NO;
+		}
+
+		return YES;
+	}
+
+	return [a isEqual:b];
+}
+
 #pragma mark -
 @implementation GCObservableObject
 #pragma mark As a GCObservableObject
@@ -56,6 +132,38 @@ static NSMutableDictionary* sActionNameRegistry = nil;
 	return @[];
 }
 
++ (NSArray*)equivalenceKeyPaths
+{
+	return [self observableKeyPaths];
+}
+
+#pragma mark -
+- (NSUInteger)equivalenceHash
+{
+	NSUInteger hash = [[self class] hash];
+
+	for (NSString* keyPath in [[self class] equivalenceKeyPaths])
+		hash = GCHashCombine(hash, GCEquivalenceHashOfValue([self valueForKeyPath:keyPath]));
+
+	return hash;
+}
+
+- (BOOL)isEquivalentToObject:(id)object
+{
+	if (object == self)
+		return YES;
+
+	if (object == nil || [object class] != [self class])
+		return NO;
+
+	for (NSString* keyPath in [[self class] equivalenceKeyPaths]) {
+		if (!GCValuesAreEquivalent([self valueForKeyPath:keyPath], [object valueForKeyPath:keyPath]))
+			return NO;
+	}
+
+	return YES;
+}
+
 #pragma mark -
 - (BOOL)setUpKVOForObserver:(id)object
 {
@@ -8,6 +8,11 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/** @brief A simple blocking queue for handing objects between threads.
+
+ New code that spreads work over several threads should use DKTaskScheduler, which avoids the single lock that every producer and
+ consumer contends for here.
+*/
 @interface GCThreadQueue : NSObject {
 @private
 	NSMutableArray* mQueue;
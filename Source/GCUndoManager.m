@@ -5,6 +5,7 @@
 */
 
 #import "GCUndoManager.h"
+#import "DKInstrumentation.h"
 
 // this proxy object is returned by -prepareWithInvocationTarget: if GCUM_USE_PROXY is 1. This provides a similar behaviour to NSUndoManager
 // on 10.6 so that a wider range of methods can be submitted as undo tasks. Unlike 10.6 however, it does not bypass um's -forwardInvocation:
@@ -558,6 +559,8 @@
 
 	THROW_IF_FALSE(aTask != nil, @"invalid task was nil in -submitUndoTask:");
 
+	DK_INSTRUMENT_COUNT("undo", "tasks submitted", 1);
+
 	// if coalescing, reject invocation that matches an already registered target and selector within the current group.
 	// Coalescing is never done while redoing or undoing. Because this matches any already-registered action, not just the
 	// last action registered, it will also coalesce actions made up of multiple property changes. The match only checks the
@@ -619,6 +622,8 @@
 
 		//NSLog(@"------ undoing ------");
 
+		DK_INSTRUMENT_SCOPE("undo", "undo");
+
 		@try {
 			[group perform];
 		}
@@ -659,6 +664,8 @@
 
 		//NSLog(@"------ redoing ------");
 
+		DK_INSTRUMENT_SCOPE("undo", "redo");
+
 		@try {
 			[group perform];
 		}
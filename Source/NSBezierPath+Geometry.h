@@ -5,6 +5,7 @@
 */
 
 #import <Cocoa/Cocoa.h>
+#import "DKPathBuffer.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -36,8 +37,9 @@ NS_ASSUME_NONNULL_BEGIN
  @discussion Since this can scale differently in \a x and \a y directions, this doesn't call the scale function but works
  very similarly.
 
- Note that due to the mathematics of bezier curves, this may not produce exactly perfect results for some
- curves.
+ When every subpath is closed, the path is offset inwards by \c amount with the same engine as the paralleloid paths, so the
+ result is a true inset whichever way the path is wound; any holes wound the other way grow by the same amount. Other paths are scaled,
+ which may not produce exactly perfect results for some curves.
 
  Positive values of \c amount inset (shrink) the path, negative values outset (grow) the shape.
  */
@@ -66,17 +68,25 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSBezierPath*)bezierPathByIteratingWithDelegate:(id<DKBezierElementIterationDelegate>)delegate contextInfo:(nullable void*)contextInfo;
 
-/** @brief returns a copy of the receiver modified by offsetting all of its control points by \c delta in the direction of the
- normal of the path at the location of the on-path control point.
- 
- Returns a copy of the receiver modified by offsetting all of its control points by \c delta in the direction of the
- normal of the path at the location of the on-path control point. This will create a parallel-ish offset path that works
- for most non-pathological paths. Given that there is no known mathematically correct way to do this (for bezier curves), this works well enough in
- many practical situations. Positive delta moves the path below or to the right, negative is up and left.
+/** @brief returns a copy of the receiver offset by \c delta along its normal.
+
+ Returns a copy of the receiver offset by \c delta along its normal, using the receiver's line join style and miter limit for
+ the outside of corners. Curves are approximated to within 0.1 points, and the loops left where the offset is larger than a curve's
+ radius are removed. Positive delta moves the path below or to the right, negative is up and left.
  */
 - (NSBezierPath*)paralleloidPathWithOffset:(CGFloat)delta;
 - (NSBezierPath*)paralleloidPathWithOffset2:(CGFloat)delta;
 - (NSBezierPath*)paralleloidPathWithOffset22:(CGFloat)delta;
+
+/** @brief returns a copy of the receiver offset by \c delta along its normal, with the given corner treatment and accuracy.
+
+ See DKPathOffset() for how the offset is found.
+ @param delta the distance to offset. Positive delta moves the path below or to the right, negative is up and left.
+ @param js the join used on the outside of corners
+ @param limit the miter limit, as for NSBezierPath
+ @param tol the greatest distance the result may stray from the true offset
+ @return the offset path. This is empty if the offset is so far inside a closed path that nothing is left. */
+- (NSBezierPath*)bezierPathByOffsettingPath:(CGFloat)delta lineJoinStyle:(NSLineJoinStyle)js miterLimit:(CGFloat)limit tolerance:(CGFloat)tol;
 - (NSBezierPath*)offsetPathWithStartingOffset:(CGFloat)delta1 endingOffset:(CGFloat)delta2;
 - (NSBezierPath*)offsetPathWithStartingOffset2:(CGFloat)delta1 endingOffset:(CGFloat)delta2;
 
@@ -92,6 +102,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSBezierPath*)bezierPathByRandomisingPoints:(CGFloat)maxAmount;
 - (nullable NSBezierPath*)bezierPathWithRoughenedStrokeOutline:(CGFloat)amount;
+
+/** @brief As -bezierPathByRandomisingPoints:, but the offsets are derived from <seed>, so the same seed always gives the same result. */
+- (NSBezierPath*)bezierPathByRandomisingPoints:(CGFloat)maxAmount seed:(uint64_t)seed;
+
+/** @brief As -bezierPathWithRoughenedStrokeOutline:, but the roughening is derived from <seed>, so the same seed always gives the same result. */
+- (nullable NSBezierPath*)bezierPathWithRoughenedStrokeOutline:(CGFloat)amount seed:(uint64_t)seed;
 - (NSBezierPath*)bezierPathWithFragmentedLineSegments:(CGFloat)flatness;
 
 // zig-zags and waves
@@ -101,14 +117,31 @@ NS_ASSUME_NONNULL_BEGIN
 
 // getting the outline of a stroked path:
 
+/** @brief returns the outline of the receiver's stroke, using its current width, caps, joins, miter limit and dash.
+
+ The outline is found from the path's geometry by DKPathStroke(), without a graphics context, and must be filled using the nonzero
+ winding rule, which the result is set to use.
+ */
 @property (readonly, copy) NSBezierPath* strokedPath;
 - (NSBezierPath*)strokedPathWithStrokeWidth:(CGFloat)width;
 
+/** @brief returns whether a point lies within the receiver's stroke, as set up by its current stroke settings.
+
+ Only the parts of the stroke near the point are outlined, so this is much cheaper than testing the point against \c strokedPath.
+ */
+- (BOOL)strokedPathContainsPoint:(NSPoint)p;
+
 // breaking a path apart:
 
 @property (readonly, copy) NSArray<NSBezierPath*>* subPaths;
 @property (readonly) NSInteger countSubPaths;
 
+// converting to and from path buffers, as used by the C geometry engines
+
+- (void)appendElementsToPathBuffer:(DKPathBuffer*)buffer;
+- (void)appendPathBuffer:(const DKPathBuffer*)buffer;
++ (NSBezierPath*)bezierPathWithPathBuffer:(const DKPathBuffer*)buffer;
+
 // converting to and from Core Graphics paths
 
 - (nullable CGPathRef)newQuartzPath CF_RETURNS_RETAINED;
@@ -6,6 +6,8 @@
 
 #import "DKDrawKitMacros.h"
 #import "DKGeometryUtilities.h"
+#import "DKPathOffset.h"
+#import "DKPathStroke.h"
 #import "DKRandom.h"
 #import "LogEvent.h"
 #import "NSBezierPath+Editing.h"
@@ -17,6 +19,14 @@
 
 #define USE_OMNI_METHODS 0
 
+// the greatest distance the paralleloid paths and insets may stray from the true offset
+
+#define DEFAULT_OFFSET_TOLERANCE 0.1
+
+// the longest dash pattern the native stroker is given. Paths with longer patterns are outlined as if solid.
+
+#define kDKMaximumStrokeDashCount 32
+
 #if USE_OMNI_METHODS
 #import "NSBezierPath-OAExtensions.h"
 #endif
@@ -31,25 +41,9 @@ static inline CGFloat distanceBetween(NSPoint a, NSPoint b);
  before it can add the curve segment.
  */
 static void InterpolatePoints(const NSPoint pointsIn[3], NSPoint* cp1, NSPoint* cp2, const CGFloat smooth_value);
-/** given 3 points in <code>pointsIn</code>, this returns the point that bisects the angle between the vertices, and is extended to intercept the \c offset
- parallel up to <code>miterLimit</code>. This is used to compute the correct location of a vertex for a parallel offset path.
- for zero offset, result is simply second point.
- The three points are three consecutive vertices from the original path.
- */
-static NSPoint CornerPoint(const NSPoint pointsIn[3], CGFloat offset, CGFloat miterLimit);
-/** Returns an arc segment that is centred at the middle vertex having a radius of \c offset and a start point and end point such that the offset normals to the original
- edges are joined by the arc. If the vertex is an inside bend, returns \c nil in which case the \c CornerPoint should be used.
- */
-static BOOL CornerArc(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath* newPath);
-/** Appends a bevel segment that is centred at the middle vertex having a radius of \c offset and a start point and end point such that the offset normals to the original
- edges are joined by the arc. If the vertex is an inside bend, returns \c nil in which case the \c CornerPoint should be used.
- */
-static BOOL CornerBevel(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath* newPath);
 
-@interface NSBezierPath (Geometry_Private)
-- (NSBezierPath*)paralleloidPathWithOffset3:(CGFloat)delta lineJoinStyle:(NSLineJoinStyle)js;
-
-@end
+/** sets up the native stroker's settings from the path's own. <dashes> receives the dash pattern, and must last as long as <style>. */
+static void GetPathStrokeStyle(NSBezierPath* path, DKPathStrokeStyle* style, double dashes[kDKMaximumStrokeDashCount]);
 
 #pragma mark -
 @implementation NSBezierPath (Geometry)
@@ -107,28 +101,58 @@ static BOOL CornerBevel(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath*
 {
 	if (amount == 0.0)
 		return self;
-	else {
-		NSRect r = NSInsetRect([self bounds], amount, amount);
-		CGFloat xs, ys;
 
-		xs = r.size.width / [self bounds].size.width;
-		ys = r.size.height / [self bounds].size.height;
+	// a path made only of closed subpaths is offset exactly, inwards whichever way round it runs. Holes wound the other way grow.
 
-		NSBezierPath* copy = [self copy];
-		NSPoint cp = [copy centreOfBounds];
+	DKPathBuffer buffer;
+	BOOL closed = NO;
+	size_t i;
 
-		NSAffineTransform* xfm = [NSAffineTransform transform];
-		[xfm translateXBy:cp.x
-					  yBy:cp.y];
-		[xfm scaleXBy:xs
-				  yBy:ys];
-		[xfm translateXBy:-cp.x
-					  yBy:-cp.y];
+	DKPathBufferInit(&buffer);
+	[self appendElementsToPathBuffer:&buffer];
 
-		[copy transformUsingAffineTransform:xfm];
+	for (i = 0; i < buffer.verbCount; ++i) {
+		if (buffer.verbs[i] == kDKPathClose)
+			closed = YES;
+		else if (buffer.verbs[i] == kDKPathMoveTo && i > 0 && !closed)
+			break;
+		else if (buffer.verbs[i] == kDKPathMoveTo)
+			closed = NO;
+	}
 
-		return [copy autorelease];
+	closed = closed && i == buffer.verbCount;
+
+	double area = DKPathBufferSignedArea(&buffer);
+
+	DKPathBufferFree(&buffer);
+
+	if (closed && area != 0.0) {
+		return [self bezierPathByOffsettingPath:area > 0.0 ? amount : -amount
+								  lineJoinStyle:[self lineJoinStyle]
+									 miterLimit:[self miterLimit]
+									  tolerance:DEFAULT_OFFSET_TOLERANCE];
 	}
+
+	NSRect r = NSInsetRect([self bounds], amount, amount);
+	CGFloat xs, ys;
+
+	xs = r.size.width / [self bounds].size.width;
+	ys = r.size.height / [self bounds].size.height;
+
+	NSBezierPath* copy = [self copy];
+	NSPoint cp = [copy centreOfBounds];
+
+	NSAffineTransform* xfm = [NSAffineTransform transform];
+	[xfm translateXBy:cp.x
+				  yBy:cp.y];
+	[xfm scaleXBy:xs
+			  yBy:ys];
+	[xfm translateXBy:-cp.x
+				  yBy:-cp.y];
+
+	[copy transformUsingAffineTransform:xfm];
+
+	return [copy autorelease];
 }
 
 - (NSBezierPath*)horizontallyFlippedPathAboutPoint:(NSPoint)cp
@@ -334,359 +358,50 @@ static BOOL CornerBevel(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath*
 #pragma mark -
 - (NSBezierPath*)paralleloidPathWithOffset:(CGFloat)delta
 {
-	NSBezierPath* newPath = [NSBezierPath bezierPath];
-
-	if (![self isEmpty]) {
-		NSInteger i, count = [self elementCount];
-		NSPoint ap[3], np[3], p0, p1;
-		NSBezierPathElement kind, nextKind;
-		CGFloat slope, dx, dy, pdx, pdy;
-
-		pdx = pdy = 0;
-
-		for (i = 0; i < count; ++i) {
-			kind = [self elementAtIndex:i
-					   associatedPoints:ap];
-
-			if (i < count - 1) {
-				[self elementAtIndex:i + 1
-					associatedPoints:np];
-
-				// calculate the slope of the on-path point
-
-				if (kind != NSCurveToBezierPathElement) {
-					p0 = ap[0];
-					p1 = np[0];
-				} else {
-					p0 = ap[2];
-					p1 = np[0];
-				}
-			} else {
-				if (kind == NSCurveToBezierPathElement) {
-					p1 = ap[2];
-					p0 = ap[1];
-				} else {
-					p1 = ap[0];
-
-					nextKind = [self elementAtIndex:i - 1
-								   associatedPoints:np];
-
-					if (nextKind != NSCurveToBezierPathElement)
-						p0 = np[0];
-					else
-						p0 = np[2];
-				}
-			}
-
-			slope = atan2(p1.y - p0.y, p1.x - p0.x) + (M_PI_2);
-
-			// calculate the position of the modified point
-
-			dx = delta * cos(slope);
-			dy = delta * sin(slope);
-
-			switch (kind) {
-			case NSMoveToBezierPathElement:
-				ap[0].x += dx;
-				ap[0].y += dy;
-				[newPath moveToPoint:ap[0]];
-				break;
-
-			case NSLineToBezierPathElement:
-				ap[0].x += dx;
-				ap[0].y += dy;
-				[newPath lineToPoint:ap[0]];
-				break;
-
-			case NSCurveToBezierPathElement:
-				ap[0].x += pdx;
-				ap[0].y += pdy;
-				ap[1].x += dx;
-				ap[1].y += dy;
-				ap[2].x += dx;
-				ap[2].y += dy;
-				[newPath curveToPoint:ap[2]
-						controlPoint1:ap[0]
-						controlPoint2:ap[1]];
-				break;
-
-			case NSClosePathBezierPathElement:
-				[newPath closePath];
-				break;
-
-			default:
-				break;
-			}
-
-			pdx = dx;
-			pdy = dy;
-		}
-	}
-
-	return newPath;
-}
-
-static NSPoint CornerPoint(const NSPoint pointsIn[3], CGFloat offset, CGFloat miterLimit)
-{
-	if (offset == 0.0)
-		return pointsIn[1];
-
-	NSPoint rp;
-	CGFloat relAngle, r, s1, s2, angle;
-
-	s1 = Slope(pointsIn[0], pointsIn[1]);
-	s2 = Slope(pointsIn[1], pointsIn[2]);
-
-	relAngle = (s2 - s1) * 0.5;
-	r = offset / cos(relAngle);
-	angle = s1 + relAngle + NINETY_DEGREES;
-
-	CGFloat maxR = fabs(miterLimit * offset);
-
-	if (r > maxR)
-		r = maxR;
-
-	if (r < -maxR)
-		r = -maxR;
-
-	rp.x = pointsIn[1].x + r * cos(angle);
-	rp.y = pointsIn[1].y + r * sin(angle);
-
-	return rp;
-}
-
-static BOOL CornerArc(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath* newPath)
-{
-	if (offset == 0.0)
-		return NO;
-
-	CGFloat s1, s2, ra;
-
-	s1 = Slope(pointsIn[0], pointsIn[1]);
-	s2 = Slope(pointsIn[2], pointsIn[1]);
-
-	// only the arc that goes around the "outside" of the bend is required, so we need a way to detect which side of the line we are offsetting to
-	// and only append an arc for the outside case.
-
-	ra = s2 - s1;
-
-	if (ra > M_PI)
-		ra = M_PI - ra;
-
-	if (ra < -M_PI)
-		ra = -M_PI - ra;
-
-	//NSLog(@"ra = %f, offset = %f", ra, offset );
-
-	if ((ra < 0 && offset > 0) || (ra > 0 && offset < 0))
-		return NO;
-
-	s2 = Slope(pointsIn[1], pointsIn[2]);
-
-	[newPath appendBezierPathWithArcWithCenter:pointsIn[1]
-										radius:offset
-									startAngle:RADIANS_TO_DEGREES(s1 + NINETY_DEGREES)
-									  endAngle:RADIANS_TO_DEGREES(s2 + NINETY_DEGREES)
-									 clockwise:offset > 0];
-
-	return YES;
-}
-
-static BOOL CornerBevel(const NSPoint pointsIn[3], CGFloat offset, NSBezierPath* newPath)
-{
-	if (offset == 0.0)
-		return NO;
-
-	CGFloat s1, s2, ra;
-
-	s1 = Slope(pointsIn[0], pointsIn[1]);
-	s2 = Slope(pointsIn[2], pointsIn[1]);
-
-	// only the arc that goes around the "outside" of the bend is required, so we need a way to detect which side of the line we are offsetting to
-	// and only append an arc for the outside case.
-
-	ra = s2 - s1;
-
-	if (ra > M_PI)
-		ra = M_PI - ra;
-
-	if (ra < -M_PI)
-		ra = -M_PI - ra;
-
-	//NSLog(@"ra = %f, offset = %f", ra, offset );
-
-	if ((ra < 0 && offset > 0) || (ra > 0 && offset < 0))
-		return NO;
-
-	NSPoint pa, pb;
-
-	pa.x = pointsIn[1].x + offset * cos(s1 + NINETY_DEGREES);
-	pa.y = pointsIn[1].y + offset * sin(s1 + NINETY_DEGREES);
-	pb.x = pointsIn[1].x + offset * cos(s2 - NINETY_DEGREES);
-	pb.y = pointsIn[1].y + offset * sin(s2 - NINETY_DEGREES);
-
-	[newPath lineToPoint:pa];
-	[newPath lineToPoint:pb];
-
-	return YES;
+	return [self bezierPathByOffsettingPath:delta
+							  lineJoinStyle:[self lineJoinStyle]
+								 miterLimit:[self miterLimit]
+								  tolerance:DEFAULT_OFFSET_TOLERANCE];
 }
 
 - (NSBezierPath*)paralleloidPathWithOffset2:(CGFloat)delta
 {
-	// returns a path offset by <delta>, using the paralleloidPathWithOffset method above on a flattened version of the path. If the caller sets the
-	// default flatness prior to calling this they can control the fineness of the offset path. The offset joins are set to match the current line join style.
-
-	if (delta == 0.0)
-		return self;
-
-	NSBezierPath* temp;
-	temp = [self bezierPathByFlatteningPath];
-	temp = [temp paralleloidPathWithOffset:delta];
-
-	return temp;
+	return [self paralleloidPathWithOffset:delta];
 }
 
 - (NSBezierPath*)paralleloidPathWithOffset22:(CGFloat)delta
 {
-	// returns a path offset by <delta>, using the paralleloidPathWithOffset3 method below on a flattened version of the path. If the caller sets the
-	// default flatness prior to calling this they can control the fineness of the offset path. The offset joins are set to match the current line join style.
-
-	if (delta == 0.0)
-		return self;
-
-	NSBezierPath* temp;
-	temp = [self bezierPathByFlatteningPath];
-	temp = [temp paralleloidPathWithOffset3:delta
-							  lineJoinStyle:[self lineJoinStyle]];
-
-	return temp;
+	return [self paralleloidPathWithOffset:delta];
 }
 
-- (NSBezierPath*)paralleloidPathWithOffset3:(CGFloat)delta lineJoinStyle:(NSLineJoinStyle)js
+- (NSBezierPath*)bezierPathByOffsettingPath:(CGFloat)delta lineJoinStyle:(NSLineJoinStyle)js miterLimit:(CGFloat)limit tolerance:(CGFloat)tol
 {
-	// requires flattened path, calculates correct points at the corners
+	if (delta == 0.0)
+		return self;
 
 	NSBezierPath* newPath = [NSBezierPath bezierPath];
-	NSInteger i, m = [self elementCount], spc = 0, spStartIndex = 0;
-	NSBezierPathElement element;
-	NSPoint ap[3];
-	NSPoint v[3];
-	NSPoint fp, op, sop;
-	CGFloat slope;
-
-	v[0] = v[1] = v[2] = sop = op = fp = NSZeroPoint;
-
-	for (i = 0; i < m; ++i) {
-		element = [self elementAtIndex:i
-					  associatedPoints:ap];
-
-		switch (element) {
-		case NSMoveToBezierPathElement:
-			// starting a new subpath - don't start the new path yet as we need the next point to know the slope
-
-			fp = v[0] = ap[0];
-			spc = 0;
-			break;
 
-		case NSLineToBezierPathElement:
-			if (spc == 0) {
-				// recently started a new subpath, so set 2nd vertex
-				v[1] = ap[0];
-				spc++;
-
-				// ok, we have enough to work out the slope and start the new path
-
-				slope = Slope(v[0], v[1]) + M_PI_2;
-				op.x = v[0].x + delta * cos(slope);
-				op.y = v[0].y + delta * sin(slope);
-				[newPath moveToPoint:op];
-				spStartIndex = [newPath elementCount] - 1;
-			} else {
-				v[2] = ap[0];
+	if ([self isEmpty])
+		return newPath;
 
-				// we have three vertices, so we can calculate the required corner point
+	DKPathOffsetOptions options = DKPathOffsetDefaultOptions();
+	DKPathBuffer source, offset;
 
-				op = CornerPoint(v, delta, [self miterLimit]);
-				if (js == NSMiterLineJoinStyle)
-					[newPath lineToPoint:op];
-				else if (js == NSBevelLineJoinStyle) {
-					if (!CornerBevel(v, delta, newPath))
-						[newPath lineToPoint:op];
-				} else {
-					if (!CornerArc(v, delta, newPath))
-						[newPath lineToPoint:op];
-				}
+	options.join = (DKPathJoin)js;
+	options.miterLimit = limit;
 
-				if (spc == 1)
-					sop = op;
+	if (tol > 0.0)
+		options.tolerance = tol;
 
-				// shift vertex array
+	DKPathBufferInit(&source);
+	DKPathBufferInit(&offset);
+	[self appendElementsToPathBuffer:&source];
 
-				v[0] = v[1];
-				v[1] = v[2];
-				spc++;
-			}
-			break;
+	if (DKPathOffset(&source, delta, &options, &offset))
+		[newPath appendPathBuffer:&offset];
 
-		case NSCurveToBezierPathElement:
-			NSAssert(NO, @"paralleloidPathWithOffset3 requires a flattened path");
-			break;
-
-		case NSClosePathBezierPathElement:
-			// close the path by curving back to the first point
-			v[2] = fp;
-
-			op = CornerPoint(v, delta, [self miterLimit]);
-			if (js == NSMiterLineJoinStyle)
-				[newPath lineToPoint:op];
-			else if (js == NSBevelLineJoinStyle) {
-				if (!CornerBevel(v, delta, newPath))
-					[newPath lineToPoint:op];
-			} else {
-				if (!CornerArc(v, delta, newPath))
-					[newPath lineToPoint:op];
-			}
-			v[0] = v[1];
-			v[1] = v[2];
-			v[2] = sop;
-
-			op = CornerPoint(v, delta, [self miterLimit]);
-			op.y = newPath.bounds.origin.y;
-			if (js == NSMiterLineJoinStyle) {
-				[newPath lineToPoint:op];
-				[newPath setAssociatedPoints:&op
-									 atIndex:spStartIndex];
-			} else if (js == NSBevelLineJoinStyle) {
-				if (!CornerBevel(v, delta, newPath)) {
-					[newPath lineToPoint:op];
-					[newPath setAssociatedPoints:&op
-										 atIndex:spStartIndex];
-				}
-			} else {
-				if (!CornerArc(v, delta, newPath)) {
-					[newPath lineToPoint:op];
-					[newPath setAssociatedPoints:&op
-										 atIndex:spStartIndex];
-				}
-			}
-			spc = 0;
-
-			[newPath closePath];
-			break;
-
-		default:
-			break;
-		}
-	}
-
-	if (spc > 0) {
-		// open-ended path, place last offset point
-
-		slope = Slope(v[0], v[1]) + M_PI_2;
-		op.x = v[1].x + delta * cos(slope);
-		op.y = v[1].y + delta * sin(slope);
-		[newPath lineToPoint:op];
-	}
+	DKPathBufferFree(&source);
+	DKPathBufferFree(&offset);
 
 	return newPath;
 }
@@ -1011,6 +726,15 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 #pragma mark -
 - (NSBezierPath*)bezierPathByRandomisingPoints:(CGFloat)maxAmount
 {
+	return [self bezierPathByRandomisingPoints:maxAmount
+										  seed:DKRandomSeedMake()];
+}
+
+- (NSBezierPath*)bezierPathByRandomisingPoints:(CGFloat)maxAmount seed:(uint64_t)seed
+{
+	// each element takes six consecutive values from the counter-based generator, whether it uses them or not, so that the offset
+	// applied to a point depends only on the seed and the element's index.
+
 	NSBezierPath* newPath = [self copy];
 
 	if (![self isEmpty]) {
@@ -1021,6 +745,7 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 		NSPoint ap[3];
 		NSBezierPathElement kind;
 		CGFloat dx, dy;
+		CGFloat rv[6];
 
 		[newPath removeAllPoints];
 
@@ -1028,8 +753,10 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 			kind = [self elementAtIndex:i
 					   associatedPoints:ap];
 
-			dx = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
-			dy = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
+			DKRandomFillSignedValues(seed, (uint64_t)i * 6, rv, 6);
+
+			dx = rv[0] * maxAmount;
+			dy = rv[1] * maxAmount;
 
 			//LogEvent_(kInfoEvent, @"random amount = {%f, %f}", dx, dy );
 
@@ -1047,12 +774,12 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 			case NSCurveToBezierPathElement:
 				ap[0].x += dx;
 				ap[0].y += dy;
-				dx = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
-				dy = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
+				dx = rv[2] * maxAmount;
+				dy = rv[3] * maxAmount;
 				ap[1].x += dx;
 				ap[1].y += dy;
-				dx = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
-				dy = [DKRandom randomPositiveOrNegativeNumber] * maxAmount;
+				dx = rv[4] * maxAmount;
+				dy = rv[5] * maxAmount;
 				ap[2].x += dx;
 				ap[2].y += dy;
 				[newPath curveToPoint:ap[2]
@@ -1074,6 +801,12 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 }
 
 - (NSBezierPath*)bezierPathWithRoughenedStrokeOutline:(CGFloat)amount
+{
+	return [self bezierPathWithRoughenedStrokeOutline:amount
+												 seed:DKRandomSeedMake()];
+}
+
+- (NSBezierPath*)bezierPathWithRoughenedStrokeOutline:(CGFloat)amount seed:(uint64_t)seed
 {
 	// given the path, this returns the outline of the path stroke roughened by the given amount. Roughening works by first taking the stroke outline at the
 	// current stroke width, inserting a large number of redundant points and then randomly offsetting each one by a small amount. The result is a path that, when
@@ -1081,7 +814,7 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 
 	NSBezierPath* newPath = [self strokedPath];
 
-	if (newPath != nil && amount > 0.0) {
+	if (![newPath isEmpty] && amount > 0.0) {
 		// work out the desired flatness by getting the average length of the elements and dividing that down:
 
 		CGFloat flatness = 4.0 / ([newPath length] / [newPath elementCount]);
@@ -1101,7 +834,8 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 
 		// randomise the positions of the points
 
-		newPath = [newPath bezierPathByRandomisingPoints:amount];
+		newPath = [newPath bezierPathByRandomisingPoints:amount
+												   seed:seed];
 	}
 
 	return newPath; //[newPath bezierPathByUnflatteningPath];
@@ -1341,46 +1075,53 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 - (NSBezierPath*)strokedPath
 {
 	// returns a path representing the stroked edge of the receiver, taking into account its current width and other
-	// stroke settings. This works by converting to a quartz path and using the similar system function there.
-
-	// this creates an offscreen graphics context to support the CG function used, but the context itself does not
-	// need to actually draw anything, therefore a simple 1x1 bitmap is used and reused for this context.
-
-	NSBezierPath* path = nil;
-	NSGraphicsContext* ctx = nil;
-	static NSBitmapImageRep* rep = nil;
-
-	if (rep == nil) {
-		rep = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
-													  pixelsWide:1
-													  pixelsHigh:1
-												   bitsPerSample:8
-												 samplesPerPixel:3
-														hasAlpha:NO
-														isPlanar:NO
-												  colorSpaceName:NSCalibratedRGBColorSpace
-													 bytesPerRow:4
-													bitsPerPixel:32];
-	}
+	// stroke settings. The outline is found directly from the path's geometry, so no graphics context is needed.
 
-	ctx = [NSGraphicsContext graphicsContextWithBitmapImageRep:rep];
+	NSBezierPath* path = [NSBezierPath bezierPath];
+	DKPathBuffer source, outline;
+	double dashes[kDKMaximumStrokeDashCount];
+	DKPathStrokeStyle style;
+
+	GetPathStrokeStyle(self, &style, dashes);
+
+	DKPathBufferInit(&source);
+	DKPathBufferInit(&outline);
+	[self appendElementsToPathBuffer:&source];
+
+	if (DKPathStroke(&source, &style, &outline))
+		[path appendPathBuffer:&outline];
+
+	DKPathBufferFree(&source);
+	DKPathBufferFree(&outline);
 
-	NSAssert(ctx != nil, @"no context for -strokedPath");
+	[path setWindingRule:NSNonZeroWindingRule];
+	return path;
+}
+
+- (BOOL)strokedPathContainsPoint:(NSPoint)p
+{
+	if (![self isEmpty]) {
+		CGFloat extra = MAX([self lineWidth], 1.0) * MAX([self miterLimit], 2.0);
 
-	SAVE_GRAPHICS_CONTEXT //[NSGraphicsContext saveGraphicsState];
-		[NSGraphicsContext setCurrentContext:ctx];
+		if (!NSPointInRect(p, NSInsetRect([self controlPointBounds], -extra, -extra)))
+			return NO;
 
-	CGContextRef context = [self setQuartzPath];
+		DKPathBuffer source;
+		double dashes[kDKMaximumStrokeDashCount];
+		DKPathStrokeStyle style;
 
-	path = self;
+		GetPathStrokeStyle(self, &style, dashes);
 
-	if (context) {
-		CGContextReplacePathWithStrokedPath(context);
-		path = [NSBezierPath bezierPathWithPathFromContext:context];
+		DKPathBufferInit(&source);
+		[self appendElementsToPathBuffer:&source];
+
+		BOOL hit = DKPathStrokeContainsPoint(&source, &style, (DKPathPoint){ p.x, p.y });
+
+		DKPathBufferFree(&source);
+		return hit;
 	}
 
-	RESTORE_GRAPHICS_CONTEXT //[NSGraphicsContext restoreGraphicsState];
-		return path;
+	return NO;
 }
 
 - (NSBezierPath*)strokedPathWithStrokeWidth:(CGFloat)width
@@ -1468,6 +1209,78 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 	return spc;
 }
 
+#pragma mark -
+#pragma mark - converting to and from path buffers
+
+- (void)appendElementsToPathBuffer:(DKPathBuffer*)buffer
+{
+	NSInteger i, count = [self elementCount];
+	NSPoint ap[3];
+
+	DKPathBufferReserve(buffer, count, count * 3);
+
+	for (i = 0; i < count; ++i) {
+		switch ([self elementAtIndex:i
+					associatedPoints:ap]) {
+		case NSMoveToBezierPathElement:
+			DKPathBufferMoveTo(buffer, (DKPathPoint){ ap[0].x, ap[0].y });
+			break;
+
+		case NSLineToBezierPathElement:
+			DKPathBufferLineTo(buffer, (DKPathPoint){ ap[0].x, ap[0].y });
+			break;
+
+		case NSCurveToBezierPathElement:
+			DKPathBufferCurveTo(buffer, (DKPathPoint){ ap[0].x, ap[0].y }, (DKPathPoint){ ap[1].x, ap[1].y }, (DKPathPoint){ ap[2].x, ap[2].y });
+			break;
+
+		case NSClosePathBezierPathElement:
+			DKPathBufferClose(buffer);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+- (void)appendPathBuffer:(const DKPathBuffer*)buffer
+{
+	const DKPathPoint* pp = buffer->points;
+	size_t i;
+
+	for (i = 0; i < buffer->verbCount; ++i) {
+		switch (buffer->verbs[i]) {
+		case kDKPathMoveTo:
+			[self moveToPoint:NSMakePoint(pp[0].x, pp[0].y)];
+			break;
+
+		case kDKPathLineTo:
+			[self lineToPoint:NSMakePoint(pp[0].x, pp[0].y)];
+			break;
+
+		case kDKPathCurveTo:
+			[self curveToPoint:NSMakePoint(pp[2].x, pp[2].y)
+				 controlPoint1:NSMakePoint(pp[0].x, pp[0].y)
+				 controlPoint2:NSMakePoint(pp[1].x, pp[1].y)];
+			break;
+
+		case kDKPathClose:
+			[self closePath];
+			break;
+		}
+
+		pp += DKPathVerbPointCount(buffer->verbs[i]);
+	}
+}
+
++ (NSBezierPath*)bezierPathWithPathBuffer:(const DKPathBuffer*)buffer
+{
+	NSBezierPath* path = [NSBezierPath bezierPath];
+	[path appendPathBuffer:buffer];
+	return path;
+}
+
 #pragma mark -
 #pragma mark - converting to and from Core Graphics paths
 
@@ -1773,6 +1586,36 @@ static void InterpolatePoints(const NSPoint v[3], NSPoint* cp1, NSPoint* cp2, co
 
 #pragma mark -
 
+static void GetPathStrokeStyle(NSBezierPath* path, DKPathStrokeStyle* style, double dashes[kDKMaximumStrokeDashCount])
+{
+	CGFloat pattern[kDKMaximumStrokeDashCount];
+	NSInteger i, count = 0;
+	CGFloat phase = 0.0;
+
+	*style = DKPathStrokeDefaultStyle();
+	style->width = [path lineWidth];
+	style->cap = (DKPathCap)[path lineCapStyle];
+	style->join = (DKPathJoin)[path lineJoinStyle];
+	style->miterLimit = [path miterLimit];
+
+	[path getLineDash:NULL
+				count:&count
+				phase:NULL];
+
+	if (count > 0 && count <= kDKMaximumStrokeDashCount) {
+		[path getLineDash:pattern
+					count:&count
+					phase:&phase];
+
+		for (i = 0; i < count; ++i)
+			dashes[i] = pattern[i];
+
+		style->dash = dashes;
+		style->dashCount = count;
+		style->dashPhase = phase;
+	}
+}
+
 static void ConvertPathApplierFunction(void* info, const CGPathElement* element)
 {
 	NSBezierPath* np = (NSBezierPath*)info;
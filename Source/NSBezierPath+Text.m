@@ -6,6 +6,7 @@
 
 #import "DKBezierLayoutManager.h"
 #import "DKGeometryUtilities.h"
+#import "DKTextLayoutCache.h"
 #import "NSBezierPath+Editing.h"
 #import "NSBezierPath+Geometry.h"
 #import "NSBezierPath+Text.h"
@@ -1527,12 +1528,10 @@ static NSInteger SortPointsHorizontally(NSValue* value1, NSValue* value2, void*
 
 	CGFloat base = [lm locationForGlyphAtIndex:glyphIndex].y;
 
-	// get the path of the glyph
+	// get the path of the glyph from the shared outline cache. The outline has its origin at 0,0 so is offset to the baseline here
 
-	NSBezierPath* glyphTemp = [[NSBezierPath alloc] init];
-	[glyphTemp moveToPoint:NSMakePoint(0, dy - base)];
-	[glyphTemp appendBezierPathWithGlyph:glyph
-								  inFont:font];
+	NSBezierPath* glyphTemp = [[[DKTextLayoutCache sharedTextLayoutCache] outlineForGlyph:glyph
+																					inFont:font] copy];
 
 	// set up a transform to rotate the glyph to the path's local angle and flip it vertically
 
@@ -1542,6 +1541,8 @@ static NSInteger SortPointsHorizontally(NSValue* value1, NSValue* value2, void*
 	[transform rotateByRadians:angle];
 	[transform scaleXBy:1
 					yBy:-1]; // assumes destination is flipped
+	[transform translateXBy:0
+						yBy:dy - base];
 
 	[glyphTemp transformUsingAffineTransform:transform];
 
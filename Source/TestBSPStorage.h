@@ -23,6 +23,9 @@ Unit Test for the BSP storage sub-system. This works by populating a storage ins
 - (void)testBSPStorage;
 - (void)testIndexedBSPStorage;
 
+/** unit test for the \c DKBSPIndex both storage classes partition the canvas with, comparing the leaves it finds with a brute-force search. */
+- (void)testBSPIndex;
+
 - (void)populateStorage:(id<DKObjectStorage>)storage canvasSize:(NSSize)canvasSize;
 - (void)deletionTest:(id<DKObjectStorage>)storage;
 - (void)insertionTest:(id<DKObjectStorage>)storage canvasSize:(NSSize)canvasSize;
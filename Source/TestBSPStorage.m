@@ -39,6 +39,36 @@ static NSUInteger randomUnsigned(NSUInteger minVal, NSUInteger maxVal)
 	return minVal + ru;
 }
 
+// the rect of every leaf of an index, found by halving the canvas the same way it does
+
+static void leafRects(NSRect rect, NSUInteger depth, BOOL acrossY, NSRect** rects)
+{
+	if (depth == 0) {
+		*(*rects)++ = rect;
+		return;
+	}
+
+	NSRect lower = rect, upper = rect;
+
+	if (acrossY) {
+		lower.size.height *= 0.5;
+		upper.origin.y = NSMaxY(lower);
+		upper.size.height = NSHeight(rect) - NSHeight(lower);
+	} else {
+		lower.size.width *= 0.5;
+		upper.origin.x = NSMaxX(lower);
+		upper.size.width = NSWidth(rect) - NSWidth(lower);
+	}
+
+	leafRects(lower, depth - 1, !acrossY, rects);
+	leafRects(upper, depth - 1, !acrossY, rects);
+}
+
+static void addLeaf(size_t leaf, void* info)
+{
+	[(__bridge NSMutableIndexSet*)info addIndex:leaf];
+}
+
 @implementation TestBSPStorage
 
 #define NUMBER_OF_OBJECTS 300
@@ -236,6 +266,56 @@ static NSUInteger randomUnsigned(NSUInteger minVal, NSUInteger maxVal)
 	NSLog(@"testIndexedBSPStorage complete.");
 }
 
+- (void)testBSPIndex
+{
+	// the leaves an index finds for a rect must be exactly those whose rects it meets, counting edges, and a point must be in the leaf found for it
+
+	srandomdev();
+
+	NSSize canvasSize = NSMakeSize(2000, 1500);
+	const NSUInteger depth = 7;
+	DKBSPIndex index;
+
+	DKBSPIndexInit(&index);
+	XCTAssertTrue(DKBSPIndexIsEmpty(&index), @"a new index has leaves");
+	XCTAssertTrue(DKBSPIndexSetDepth(&index, canvasSize.width, canvasSize.height, depth), @"the index could not be made");
+	XCTAssertEqual(index.leafCount, (size_t)1 << depth, @"the index has the wrong number of leaves");
+
+	NSRect* rects = malloc(index.leafCount * sizeof(NSRect));
+	NSRect* next = rects;
+
+	leafRects(NSMakeRect(0, 0, canvasSize.width, canvasSize.height), depth, YES, &next);
+
+	NSUInteger i, leaf;
+
+	for (i = 0; i < NUMBER_OF_OBJECTS; ++i) {
+		NSRect r = NSMakeRect(randomFloat(0, canvasSize.width), randomFloat(0, canvasSize.height), randomFloat(0, MAX_OBJECT_SIZE), randomFloat(0, MAX_OBJECT_SIZE));
+		NSMutableIndexSet* found = [NSMutableIndexSet indexSet];
+		NSMutableIndexSet* expected = [NSMutableIndexSet indexSet];
+
+		DKBSPIndexVisitRect(&index, NSMinX(r), NSMinY(r), NSWidth(r), NSHeight(r), addLeaf, (__bridge void*)found);
+
+		for (leaf = 0; leaf < index.leafCount; ++leaf) {
+			NSRect lr = rects[leaf];
+
+			if ((NSMinX(lr) == 0 || NSMaxX(r) >= NSMinX(lr)) && (NSMaxX(lr) == canvasSize.width || NSMinX(r) < NSMaxX(lr)) && (NSMinY(lr) == 0 || NSMaxY(r) >= NSMinY(lr))
+				&& (NSMaxY(lr) == canvasSize.height || NSMinY(r) < NSMaxY(lr)))
+				[expected addIndex:leaf];
+		}
+
+		XCTAssertEqualObjects(found, expected, @"the index found the wrong leaves for %@", NSStringFromRect(r));
+
+		NSPoint p = NSMakePoint(randomFloat(0, canvasSize.width), randomFloat(0, canvasSize.height));
+
+		leaf = DKBSPIndexLeafAtPoint(&index, p.x, p.y);
+		XCTAssertTrue(NSPointInRect(p, rects[leaf]), @"%@ is not in the leaf found for it, %@", NSStringFromPoint(p), NSStringFromRect(rects[leaf]));
+	}
+
+	free(rects);
+	DKBSPIndexFree(&index);
+	XCTAssertTrue(DKBSPIndexIsEmpty(&index), @"a freed index has leaves");
+}
+
 - (void)populateStorage:(id<DKObjectStorage>)storage canvasSize:(NSSize)canvasSize
 {
 	NSUInteger i, m = NUMBER_OF_OBJECTS;
@@ -0,0 +1,47 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKBSPDirectObjectStorage.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Performance benchmarks for the storage, geometry, drawing, serialization and export sub-systems.
+
+ Each test times one sub-system through the portable suite in DKBenchmark.h, on synthetic drawings laid out uniformly, in clusters, piled up
+ in the middle and in deeply nested groups. Storage is exercised with the same dummy storable objects as TestBSPStorage, so that only the
+ storage is being timed. The portable engines - geometry, the BSP index beneath the storage, and the SVG stream - are benchmarked by the
+ driver in Benchmarks/, which also runs on Linux.
+
+ The tests run at a tenth of the full sizes by default. These environment variables change how they run:
+
+ - DK_BENCHMARK_SCALE: the factor to scale sizes by; 1 for the full sizes
+ - DK_BENCHMARK_SAMPLES: timed runs of each benchmark, 5 by default
+ - DK_BENCHMARK_FILTER: only run benchmarks whose name or variant contains this
+ - DK_BENCHMARK_OUTPUT: a file to write the results to, for use as a baseline
+ - DK_BENCHMARK_BASELINE: a file of earlier results. A benchmark that is slower by more than the tolerance fails. Allocations aren't counted
+   here, as they are by the driver on Linux, so only times are compared.
+ - DK_BENCHMARK_TOLERANCE: the tolerance, as a fraction, 0.1 by default
+
+ Every result is printed in a table when the tests finish.
+*/
+@interface TestDKBenchmarks : XCTestCase
+
+- (void)testStorage;
+- (void)testLinearStorageReordering;
+- (void)testKnobDrawing;
+- (void)testSnapping;
+- (void)testGroupDragging;
+- (void)testRouteOptimiser;
+- (void)testTaskScheduler;
+- (void)testStyleMerging;
+- (void)testStyleScripts;
+- (void)testDashing;
+- (void)testGridScrolling;
+- (void)testUndo;
+- (void)testArchiving;
+- (void)testSVGExport;
+- (void)testMarqueeSelection;
+
+@end
@@ -0,0 +1,1219 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKBenchmarks.h"
+#import "TestBSPStorage.h"
+#import "DKBenchmark.h"
+#import "parser/DKCompiledScript.h"
+#import "parser/DKEvaluator.h"
+#import "parser/DKParser.h"
+#import <DKDrawKit/DKBSPObjectStorage.h>
+#import <DKDrawKit/DKDrawableShape.h>
+#import <DKDrawKit/DKFill.h>
+#import <DKDrawKit/DKDrawing.h>
+#import <DKDrawKit/DKDrawingView.h>
+#import <DKDrawKit/DKGridLayer.h>
+#import <DKDrawKit/DKKnob.h>
+#import <DKDrawKit/DKLinearObjectStorage.h>
+#import <DKDrawKit/DKMarqueeSelection.h>
+#import <DKDrawKit/DKObjectDrawingLayer.h>
+#import <DKDrawKit/DKRouteOptimiser.h>
+#import <DKDrawKit/DKSVGExporter.h>
+#import <DKDrawKit/DKShapeGroup.h>
+#import <DKDrawKit/DKStrokeDash.h>
+#import <DKDrawKit/DKStyle.h>
+#import <DKDrawKit/DKStyleRegistry.h>
+#import <DKDrawKit/DKTaskScheduler.h>
+#import <DKDrawKit/GCThreadQueue.h>
+#import <DKDrawKit/GCUndoManager.h>
+#include <stdatomic.h>
+
+#define BENCHMARK_SEED 0x5EEDD4A3ull
+#define BENCHMARK_CANVAS 10000.0
+#define BENCHMARK_DEFAULT_SCALE 0.1
+#define BENCHMARK_DEFAULT_SAMPLES 5
+#define BENCHMARK_DEFAULT_TOLERANCE 0.1
+#define BENCHMARK_BITMAP_SIZE 1024
+
+static DKBenchmarkSuite* sSuite = NULL;
+static char* sFilter = NULL;
+static double sTolerance = BENCHMARK_DEFAULT_TOLERANCE;
+
+// the suite takes C functions, so each benchmark's blocks are passed to it through these
+
+typedef struct {
+	void (^setup)(void);
+	void (^body)(void);
+} DKTestBenchmarkBlocks;
+
+static void DKTestBenchmarkSetup(void* context)
+{
+	@autoreleasepool {
+		((DKTestBenchmarkBlocks*)context)->setup();
+	}
+}
+
+static void DKTestBenchmarkBody(void* context)
+{
+	@autoreleasepool {
+		((DKTestBenchmarkBlocks*)context)->body();
+	}
+}
+
+static NSRect DKTestRectFromBenchmarkRect(const DKBenchmarkRect* r)
+{
+	return NSMakeRect(r->x, r->y, r->width, r->height);
+}
+
+static NSBitmapImageRep* DKTestBenchmarkBitmap(void)
+{
+	return [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+													pixelsWide:BENCHMARK_BITMAP_SIZE
+													pixelsHigh:BENCHMARK_BITMAP_SIZE
+												 bitsPerSample:8
+											   samplesPerPixel:4
+													  hasAlpha:YES
+													  isPlanar:NO
+												colorSpaceName:NSCalibratedRGBColorSpace
+												   bytesPerRow:0
+												  bitsPerPixel:0] autorelease];
+}
+
+// the queue's consumers are plain threads that run the blocks they take from it, until they take NSNull
+
+@interface GCThreadQueue (DKTestBenchmarks)
+
+- (void)runQueuedTasks:(id)unused;
+
+@end
+
+@implementation GCThreadQueue (DKTestBenchmarks)
+
+- (void)runQueuedTasks:(id)unused
+{
+#pragma unused(unused)
+
+	for (;;) {
+		@autoreleasepool {
+			id task = [self dequeue];
+
+			if (task == [NSNull null])
+				break;
+
+			((DKTaskBlock)task)();
+		}
+	}
+}
+
+@end
+
+#pragma mark -
+
+@interface TestDKBenchmarks ()
+
+- (DKBenchmarkResult*)runBenchmark:(const char*)name variant:(const char*)variant size:(size_t)size setup:(void (^)(void))setup body:(void (^)(void))body;
+- (void)checkResultsFromIndex:(size_t)first;
+- (DKDrawing*)drawingWithShapes:(size_t)count distribution:(DKBenchmarkDistribution)distribution layer:(DKObjectDrawingLayer**)layer;
+- (void)runTasks:(size_t)count onQueue:(GCThreadQueue*)queue body:(void (^)(size_t task))body;
+
+@end
+
+@implementation TestDKBenchmarks
+
++ (void)setUp
+{
+	[super setUp];
+
+	NSDictionary* env = [[NSProcessInfo processInfo] environment];
+	DKBenchmarkOptions options = DKBenchmarkDefaultOptions();
+
+	options.scale = env[@"DK_BENCHMARK_SCALE"] ? [env[@"DK_BENCHMARK_SCALE"] doubleValue] : BENCHMARK_DEFAULT_SCALE;
+	options.samples = env[@"DK_BENCHMARK_SAMPLES"] ? (size_t)[env[@"DK_BENCHMARK_SAMPLES"] integerValue] : BENCHMARK_DEFAULT_SAMPLES;
+
+	if (env[@"DK_BENCHMARK_FILTER"]) {
+		sFilter = strdup([env[@"DK_BENCHMARK_FILTER"] UTF8String]);
+		options.filter = sFilter;
+	}
+
+	if (env[@"DK_BENCHMARK_TOLERANCE"])
+		sTolerance = [env[@"DK_BENCHMARK_TOLERANCE"] doubleValue];
+
+	sSuite = DKBenchmarkSuiteCreate(&options);
+
+	NSString* baseline = env[@"DK_BENCHMARK_BASELINE"];
+
+	if (baseline && !DKBenchmarkSuiteLoadBaseline(sSuite, [baseline fileSystemRepresentation]))
+		NSLog(@"can't read the benchmark baseline '%@'; results won't be compared", baseline);
+}
+
++ (void)tearDown
+{
+	DKBenchmarkSuiteReport(sSuite, sTolerance, stdout);
+	fflush(stdout);
+
+	NSString* output = [[NSProcessInfo processInfo] environment][@"DK_BENCHMARK_OUTPUT"];
+
+	if (output && !DKBenchmarkSuiteWriteResults(sSuite, [output fileSystemRepresentation]))
+		NSLog(@"can't write the benchmark results to '%@'", output);
+
+	DKBenchmarkSuiteFree(sSuite);
+	sSuite = NULL;
+	free(sFilter);
+	sFilter = NULL;
+
+	[super tearDown];
+}
+
+- (DKBenchmarkResult*)runBenchmark:(const char*)name variant:(const char*)variant size:(size_t)size setup:(void (^)(void))setup body:(void (^)(void))body
+{
+	DKTestBenchmarkBlocks blocks = { setup, body };
+
+	return DKBenchmarkSuiteRun(sSuite, name, variant, size, setup ? DKTestBenchmarkSetup : NULL, DKTestBenchmarkBody, &blocks);
+}
+
+- (void)checkResultsFromIndex:(size_t)first
+{
+	size_t i, n = DKBenchmarkSuiteResultCount(sSuite);
+
+	for (i = first; i < n; ++i) {
+		const DKBenchmarkResult* r = DKBenchmarkSuiteResult(sSuite, i);
+		const DKBenchmarkResult* b = DKBenchmarkSuiteBaselineFor(sSuite, r);
+
+		XCTAssertFalse(DKBenchmarkSuiteResultRegressed(sSuite, r, sTolerance), @"%s (%s, %zu) regressed: %g s against %g s, %g allocations against %g", r->name,
+			r->variant, r->size, r->median, b->median, r->allocations, b->allocations);
+	}
+}
+
+- (DKDrawing*)drawingWithShapes:(size_t)count distribution:(DKBenchmarkDistribution)distribution layer:(DKObjectDrawingLayer**)layer
+{
+	DKBenchmarkRect* rects = malloc(count * sizeof(DKBenchmarkRect));
+	NSMutableArray* shapes = [NSMutableArray arrayWithCapacity:count];
+	size_t i;
+
+	DKBenchmarkGenerateRects(distribution, count, BENCHMARK_CANVAS, BENCHMARK_CANVAS, BENCHMARK_SEED, rects);
+
+	for (i = 0; i < count; ++i)
+		[shapes addObject:[DKDrawableShape drawableShapeWithRect:DKTestRectFromBenchmarkRect(&rects[i])]];
+
+	free(rects);
+
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(BENCHMARK_CANVAS, BENCHMARK_CANVAS)];
+	DKObjectDrawingLayer* odl = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+
+	[odl addObjectsFromArray:shapes];
+
+	if (layer)
+		*layer = odl;
+
+	return drawing;
+}
+
+- (void)runTasks:(size_t)count onQueue:(GCThreadQueue*)queue body:(void (^)(size_t task))body
+{
+	// each task is a block of its own, as a client of the queue would enqueue, and the last to finish signals the wait
+
+	dispatch_semaphore_t done = dispatch_semaphore_create(0);
+	atomic_size_t remaining;
+	atomic_size_t* remainingRef = &remaining;
+	size_t t;
+
+	atomic_init(&remaining, count);
+
+	for (t = 0; t < count; ++t) {
+		DKTaskBlock task = [^{
+			body(t);
+
+			if (atomic_fetch_sub(remainingRef, 1) == 1)
+				dispatch_semaphore_signal(done);
+		} copy];
+
+		[queue enqueue:task];
+		[task release];
+	}
+
+	if (count > 0)
+		dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+
+	dispatch_release(done);
+}
+
+#pragma mark -
+
+- (void)testStorage
+{
+	// inserting objects into each kind of storage, then finding them by rect and by point, for each layout of objects
+
+	const char* storageNames[] = { "linear", "bsp", "bsp-direct" };
+	Class storageClasses[] = { [DKLinearObjectStorage class], [DKBSPObjectStorage class], [DKBSPDirectObjectStorage class] };
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	const size_t queries = 200, pointQueries = 1000;
+	NSSize canvasSize = NSMakeSize(BENCHMARK_CANVAS, BENCHMARK_CANVAS);
+	DKBenchmarkRect* rects = malloc(count * sizeof(DKBenchmarkRect));
+	NSRect* queryRects = malloc(queries * sizeof(NSRect));
+	NSPoint* queryPoints = malloc(pointQueries * sizeof(NSPoint));
+	uint64_t state = BENCHMARK_SEED;
+	size_t i;
+	int d, s;
+
+	for (d = 0; d < kDKBenchmarkDistributionCount; ++d) {
+		NSMutableArray* objects = [NSMutableArray arrayWithCapacity:count];
+
+		DKBenchmarkGenerateRects((DKBenchmarkDistribution)d, count, BENCHMARK_CANVAS, BENCHMARK_CANVAS, BENCHMARK_SEED, rects);
+
+		for (i = 0; i < count; ++i) {
+			testStorableObject* tso = [[testStorableObject alloc] init];
+
+			[tso setBounds:DKTestRectFromBenchmarkRect(&rects[i])];
+			[objects addObject:tso];
+			[tso release];
+		}
+
+		// queries are the size of a window onto the drawing, half of them centred on an object, so that each layout is looked at where its
+		// objects are as well as where they aren't
+
+		for (i = 0; i < queries; ++i) {
+			const DKBenchmarkRect* r = &rects[DKBenchmarkRandom(&state) % count];
+			NSPoint c = (i & 1) ? NSMakePoint(DKBenchmarkRandomUnit(&state) * BENCHMARK_CANVAS, DKBenchmarkRandomUnit(&state) * BENCHMARK_CANVAS)
+								: NSMakePoint(r->x + r->width * 0.5, r->y + r->height * 0.5);
+
+			queryRects[i] = NSMakeRect(c.x - BENCHMARK_CANVAS / 20, c.y - BENCHMARK_CANVAS / 20, BENCHMARK_CANVAS / 10, BENCHMARK_CANVAS / 10);
+		}
+
+		for (i = 0; i < pointQueries; ++i) {
+			const DKBenchmarkRect* r = &rects[DKBenchmarkRandom(&state) % count];
+
+			queryPoints[i] = NSMakePoint(r->x + r->width * DKBenchmarkRandomUnit(&state), r->y + r->height * DKBenchmarkRandomUnit(&state));
+		}
+
+		for (s = 0; s < 3; ++s) {
+			char variant[32];
+			__block id<DKObjectStorage> storage = nil;
+			__block NSUInteger found = 0;
+			Class storageClass = storageClasses[s];
+			DKBenchmarkResult* result;
+
+			snprintf(variant, sizeof(variant), "%s/%s", storageNames[s], DKBenchmarkDistributionName((DKBenchmarkDistribution)d));
+
+			void (^makeStorage)(void) = ^{
+				[storage release];
+				storage = [[storageClass alloc] init];
+				[storage setCanvasSize:canvasSize];
+			};
+
+			void (^insertObjects)(void) = ^{
+				NSUInteger n = 0;
+
+				for (testStorableObject* tso in objects)
+					[storage insertObject:tso
+						inObjectsAtIndex:n++];
+			};
+
+			[self runBenchmark:"storage-insert"
+					   variant:variant
+						  size:count
+						 setup:makeStorage
+						  body:insertObjects];
+
+			if ([storage countOfObjects] != count) {
+				makeStorage();
+				insertObjects();
+			}
+
+			result = [self runBenchmark:"storage-rect-query"
+								variant:variant
+								   size:count
+								  setup:nil
+								   body:^{
+									   found = 0;
+
+									   for (size_t q = 0; q < queries; ++q)
+										   found += [[storage objectsIntersectingRect:queryRects[q]
+																			   inView:nil
+																			  options:0] count];
+								   }];
+
+			if (result) {
+				result->metric = (double)found / queries;
+				snprintf(result->metricName, sizeof(result->metricName), "found/query");
+			}
+
+			result = [self runBenchmark:"storage-point-query"
+								variant:variant
+								   size:count
+								  setup:nil
+								   body:^{
+									   found = 0;
+
+									   for (size_t q = 0; q < pointQueries; ++q)
+										   found += [[storage objectsContainingPoint:queryPoints[q]] count];
+								   }];
+
+			if (result) {
+				result->metric = (double)found / pointQueries;
+				snprintf(result->metricName, sizeof(result->metricName), "found/query");
+			}
+
+			[storage release];
+		}
+	}
+
+	free(queryPoints);
+	free(queryRects);
+	free(rects);
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testLinearStorageReordering
+{
+	// moving objects to new places in the stacking order of a large linear storage, and looking up the indexes of many objects at once
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	size_t moves = DKBenchmarkSuiteScaledSize(sSuite, 10000);
+	DKLinearObjectStorage* storage = [[DKLinearObjectStorage alloc] init];
+	NSUInteger* from = malloc(moves * sizeof(NSUInteger));
+	NSUInteger* to = malloc(moves * sizeof(NSUInteger));
+	NSMutableArray* some = [NSMutableArray arrayWithCapacity:moves];
+	uint64_t state = BENCHMARK_SEED;
+	size_t i;
+
+	for (i = 0; i < count; ++i) {
+		testStorableObject* tso = [[testStorableObject alloc] init];
+
+		[tso setBounds:NSMakeRect(DKBenchmarkRandomUnit(&state) * BENCHMARK_CANVAS, DKBenchmarkRandomUnit(&state) * BENCHMARK_CANVAS, 20, 20)];
+		[storage insertObject:tso
+			 inObjectsAtIndex:i];
+		[tso release];
+	}
+
+	for (i = 0; i < moves; ++i) {
+		from[i] = (NSUInteger)(DKBenchmarkRandom(&state) % count);
+		to[i] = (NSUInteger)(DKBenchmarkRandom(&state) % count);
+		[some addObject:[storage objectInObjectsAtIndex:from[i]]];
+	}
+
+	[self runBenchmark:"linear-storage-move"
+			   variant:NULL
+				  size:count
+				 setup:nil
+				  body:^{
+					  for (size_t m = 0; m < moves; ++m)
+						  [storage moveObject:[some objectAtIndex:m]
+									  toIndex:to[m]];
+				  }];
+
+	[self runBenchmark:"linear-storage-indexes"
+			   variant:NULL
+				  size:count
+				 setup:nil
+				  body:^{
+					  [storage indexesOfObjects:some];
+				  }];
+
+	XCTAssertEqual([storage countOfObjects], count, @"moving objects changed how many there are");
+
+	free(to);
+	free(from);
+	[storage release];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testKnobDrawing
+{
+	// drawing a huge selection's knobs into a bitmap one at a time, and batched by handle type
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	NSPoint* points = malloc(count * sizeof(NSPoint));
+	NSGraphicsContext* context = [NSGraphicsContext graphicsContextWithBitmapImageRep:DKTestBenchmarkBitmap()];
+	DKKnob* knobs = [[DKKnob alloc] init];
+	uint64_t state = BENCHMARK_SEED;
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+		points[i] = NSMakePoint(DKBenchmarkRandomUnit(&state) * BENCHMARK_BITMAP_SIZE, DKBenchmarkRandomUnit(&state) * BENCHMARK_BITMAP_SIZE);
+
+	void (^drawKnobs)(BOOL) = ^(BOOL batched) {
+		[NSGraphicsContext saveGraphicsState];
+		[NSGraphicsContext setCurrentContext:context];
+
+		if (batched)
+			[knobs beginKnobBatch];
+
+		for (size_t k = 0; k < count; ++k)
+			[knobs drawKnobAtPoint:points[k]
+							ofType:(k & 1) ? kDKBoundingRectKnobType : kDKControlPointKnobType
+						  userInfo:nil];
+
+		if (batched)
+			[knobs flushKnobBatch];
+
+		[NSGraphicsContext restoreGraphicsState];
+	};
+
+	[self runBenchmark:"knob-draw"
+			   variant:"unbatched"
+				  size:count
+				 setup:nil
+				  body:^{
+					  drawKnobs(NO);
+				  }];
+
+	[self runBenchmark:"knob-draw"
+			   variant:"batched"
+				  size:count
+				 setup:nil
+				  body:^{
+					  drawKnobs(YES);
+				  }];
+
+	[knobs release];
+	free(points);
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testSnapping
+{
+	// snapping points near objects' corners to them, as a drag does on every mouse event
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	const size_t snaps = 1000;
+	NSPoint* points = malloc(snaps * sizeof(NSPoint));
+	uint64_t state = BENCHMARK_SEED;
+	int d;
+
+	for (d = 0; d < kDKBenchmarkDistributionCount; ++d) {
+		DKObjectDrawingLayer* layer = nil;
+		DKDrawing* drawing = [self drawingWithShapes:count
+										distribution:(DKBenchmarkDistribution)d
+											   layer:&layer];
+		NSArray* objects = [layer objects];
+		__block NSUInteger snapped = 0;
+		size_t i;
+
+		[layer setAllowsSnapToObjects:YES];
+
+		for (i = 0; i < snaps; ++i) {
+			NSRect br = [[objects objectAtIndex:(NSUInteger)(DKBenchmarkRandom(&state) % count)] bounds];
+
+			points[i] = NSMakePoint(NSMinX(br) + DKBenchmarkRandomUnit(&state) * 4 - 2, NSMinY(br) + DKBenchmarkRandomUnit(&state) * 4 - 2);
+		}
+
+		DKBenchmarkResult* result = [self runBenchmark:"snap-to-object"
+											   variant:DKBenchmarkDistributionName((DKBenchmarkDistribution)d)
+												  size:count
+												 setup:nil
+												  body:^{
+													  snapped = 0;
+
+													  for (size_t k = 0; k < snaps; ++k) {
+														  NSPoint sp = [layer snapPoint:points[k]
+																	  toAnyObjectExcept:nil
+																		  snapTolerance:4];
+
+														  if (!NSEqualPoints(sp, points[k]))
+															  ++snapped;
+													  }
+												  }];
+
+		if (result) {
+			result->metric = result->median / snaps * 1.0e6;
+			snprintf(result->metricName, sizeof(result->metricName), "us/snap");
+			XCTAssertGreaterThan(snapped, (NSUInteger)0, @"nothing snapped");
+		}
+
+	}
+
+	free(points);
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testGroupDragging
+{
+	// dragging a large group about, drawing it and hit testing it on each frame, with and without its content cache
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 5000);
+	const size_t frames = 20;
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithShapes:count
+									distribution:kDKBenchmarkClustered
+										   layer:&layer];
+	NSArray* shapes = [[[layer objects] copy] autorelease];
+	NSGraphicsContext* context = [NSGraphicsContext graphicsContextWithBitmapImageRep:DKTestBenchmarkBitmap()];
+
+	[layer removeObjectsInArray:shapes];
+
+	DKShapeGroup* group = [DKShapeGroup groupWithObjects:shapes];
+
+	[layer addObject:group];
+
+	const DKGroupCacheOption options[] = { kDKGroupCacheNone, kDKGroupCacheUsingCGLayer };
+	const char* variants[] = { "uncached", "cglayer" };
+	int v;
+
+	for (v = 0; v < 2; ++v) {
+		[group setCacheOptions:options[v]];
+
+		[self runBenchmark:"group-drag"
+				   variant:variants[v]
+					  size:count
+					 setup:nil
+					  body:^{
+						  [NSGraphicsContext saveGraphicsState];
+						  [NSGraphicsContext setCurrentContext:context];
+
+						  // the view shows the group at a tenth of its size, so all of it is drawn
+
+						  NSAffineTransform* view = [NSAffineTransform transform];
+
+						  [view scaleBy:BENCHMARK_BITMAP_SIZE / BENCHMARK_CANVAS];
+						  [view concat];
+
+						  for (size_t f = 0; f < frames; ++f) {
+							  CGFloat dx = (f & 1) ? -5 : 5;
+
+							  [group offsetLocationByX:dx
+												   byY:dx];
+							  [group drawContentWithSelectedState:NO];
+							  [group hitPart:[group location]];
+						  }
+
+						  [NSGraphicsContext restoreGraphicsState];
+					  }];
+	}
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testRouteOptimiser
+{
+	// ordering plotter moves: the time taken and the length of the route found
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	DKBenchmarkRect* rects = malloc(count * sizeof(DKBenchmarkRect));
+	NSPoint* points = malloc(count * sizeof(NSPoint));
+	NSUInteger* order = malloc(count * sizeof(NSUInteger));
+	int d;
+
+	// jobs are usually spread out, or gathered into a few areas of detail
+
+	for (d = kDKBenchmarkUniform; d <= kDKBenchmarkClustered; ++d) {
+		__block CGFloat length = 0;
+		size_t i;
+
+		DKBenchmarkGenerateRects((DKBenchmarkDistribution)d, count, BENCHMARK_CANVAS, BENCHMARK_CANVAS, BENCHMARK_SEED, rects);
+
+		for (i = 0; i < count; ++i)
+			points[i] = NSMakePoint(rects[i].x, rects[i].y);
+
+		DKBenchmarkResult* result = [self runBenchmark:"route-optimise"
+											   variant:DKBenchmarkDistributionName((DKBenchmarkDistribution)d)
+												  size:count
+												 setup:nil
+												  body:^{
+													  length = DKRouteOptimiseOpenPath(points, count, order, DKRouteOptimiserDefaultOptions(), NULL, NULL);
+												  }];
+
+		if (result) {
+			result->metric = length;
+			snprintf(result->metricName, sizeof(result->metricName), "length");
+		}
+	}
+
+	free(order);
+	free(points);
+	free(rects);
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testTaskScheduler
+{
+	// the scheduler against the queue it replaces, served by as many threads as the scheduler has workers, and against dispatch, for a
+	// parallel loop of small pieces of work and for many tiny tasks
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t loopCount = DKBenchmarkSuiteScaledSize(sSuite, 10000000);
+	size_t taskCount = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	const size_t grain = 4096;
+	DKTaskScheduler* scheduler = [DKTaskScheduler sharedScheduler];
+	dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0);
+	GCThreadQueue* threadQueue = [[GCThreadQueue alloc] init];
+	double* out = calloc((loopCount + grain - 1) / grain, sizeof(double));
+	double* taskOut = calloc(taskCount, sizeof(double));
+	NSUInteger w;
+
+	for (w = 0; w < [scheduler workerCount]; ++w)
+		[NSThread detachNewThreadSelector:@selector(runQueuedTasks:)
+								 toTarget:threadQueue
+							   withObject:nil];
+
+	[self runBenchmark:"parallel-for"
+			   variant:"scheduler"
+				  size:loopCount
+				 setup:nil
+				  body:^{
+					  [scheduler parallelForRange:NSMakeRange(0, loopCount)
+										grainSize:grain
+										 priority:kDKTaskPriorityInteractive
+											group:nil
+											 body:^(NSRange subrange) {
+												 double s = 0;
+
+												 for (NSUInteger k = subrange.location; k < NSMaxRange(subrange); ++k)
+													 s += sqrt((double)k);
+
+												 out[subrange.location / grain] = s;
+											 }];
+				  }];
+
+	[self runBenchmark:"parallel-for"
+			   variant:"thread-queue"
+				  size:loopCount
+				 setup:nil
+				  body:^{
+					  [self runTasks:(loopCount + grain - 1) / grain
+							 onQueue:threadQueue
+								body:^(size_t chunk) {
+									double s = 0;
+									size_t end = MIN((chunk + 1) * grain, loopCount);
+
+									for (size_t k = chunk * grain; k < end; ++k)
+										s += sqrt((double)k);
+
+									out[chunk] = s;
+								}];
+				  }];
+
+	[self runBenchmark:"parallel-for"
+			   variant:"dispatch"
+				  size:loopCount
+				 setup:nil
+				  body:^{
+					  dispatch_apply((loopCount + grain - 1) / grain, queue, ^(size_t chunk) {
+						  double s = 0;
+						  size_t end = MIN((chunk + 1) * grain, loopCount);
+
+						  for (size_t k = chunk * grain; k < end; ++k)
+							  s += sqrt((double)k);
+
+						  out[chunk] = s;
+					  });
+				  }];
+
+	[self runBenchmark:"tiny-tasks"
+			   variant:"scheduler"
+				  size:taskCount
+				 setup:nil
+				  body:^{
+					  DKTaskGroup* group = [[DKTaskGroup alloc] init];
+
+					  for (size_t t = 0; t < taskCount; ++t)
+						  [scheduler addTask:^{
+							  taskOut[t] = sqrt((double)t);
+						  }
+									priority:kDKTaskPriorityInteractive
+									   group:group];
+
+					  [group wait];
+					  [group release];
+				  }];
+
+	[self runBenchmark:"tiny-tasks"
+			   variant:"thread-queue"
+				  size:taskCount
+				 setup:nil
+				  body:^{
+					  [self runTasks:taskCount
+							 onQueue:threadQueue
+								body:^(size_t t) {
+									taskOut[t] = sqrt((double)t);
+								}];
+				  }];
+
+	[self runBenchmark:"tiny-tasks"
+			   variant:"dispatch"
+				  size:taskCount
+				 setup:nil
+				  body:^{
+					  dispatch_group_t group = dispatch_group_create();
+
+					  for (size_t t = 0; t < taskCount; ++t)
+						  dispatch_group_async(group, queue, ^{
+							  taskOut[t] = sqrt((double)t);
+						  });
+
+					  dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+					  dispatch_release(group);
+				  }];
+
+	for (w = 0; w < [scheduler workerCount]; ++w)
+		[threadQueue enqueue:[NSNull null]];
+
+	[threadQueue release];
+	free(taskOut);
+	free(out);
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testStyleMerging
+{
+	// merging a document's styles into a large registry, half of them equivalent to registered styles
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t registered = DKBenchmarkSuiteScaledSize(sSuite, 20000);
+	size_t incoming = DKBenchmarkSuiteScaledSize(sSuite, 1000);
+	NSMutableArray* registry = [NSMutableArray arrayWithCapacity:registered];
+	NSMutableSet* document = [NSMutableSet setWithCapacity:incoming];
+	size_t i;
+
+	for (i = 0; i < registered; ++i) {
+		NSColor* fill = [NSColor colorWithCalibratedHue:(i % 360) / 360.0
+											 saturation:0.8
+											 brightness:0.3 + (i / 360 % 7) * 0.1
+												  alpha:1.0];
+
+		[registry addObject:[DKStyle styleWithFillColour:fill
+											strokeColour:[NSColor blackColor]
+											 strokeWidth:1.0 + i / 2520]];
+	}
+
+	for (i = 0; i < incoming; ++i) {
+		// even styles repeat a registered style's settings in a new object; odd ones are new
+
+		size_t j = (i & 1) ? registered + i : (i * 7919) % registered;
+		NSColor* fill = [NSColor colorWithCalibratedHue:(j % 360) / 360.0
+											 saturation:0.8
+											 brightness:0.3 + (j / 360 % 7) * 0.1
+												  alpha:1.0];
+
+		[document addObject:[DKStyle styleWithFillColour:fill
+											strokeColour:[NSColor blackColor]
+											 strokeWidth:1.0 + j / 2520]];
+	}
+
+	[self runBenchmark:"style-merge"
+			   variant:"reuse-equivalent"
+				  size:registered
+				 setup:^{
+					 [DKStyleRegistry resetRegistry];
+					 [DKStyleRegistry registerStylesFromArray:registry
+												 inCategories:nil
+									   ignoringDuplicateNames:YES];
+				 }
+				  body:^{
+					  [DKStyleRegistry mergeStyles:document
+									  inCategories:nil
+										   options:kDKReuseEquivalentStyles
+									 mergeDelegate:nil];
+				  }];
+
+	[DKStyleRegistry resetRegistry];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testStyleScripts
+{
+	// reading a library of style definitions written as a style script: parsing it and walking the tree, compiling and running it, and
+	// running it again once it is in the compiled script cache
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 10000);
+	NSMutableString* library = [NSMutableString stringWithString:@"{\n"];
+	DKParser* parser = [[[DKParser alloc] init] autorelease];
+	DKEvaluator* evaluator = [[[DKEvaluator alloc] init] autorelease];
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+		[library appendFormat:@"(style name: 'style %lu' (fill colour: (colour red: %.3f green: %.3f blue: 0.5)) (stroke width: %lu colour: ink) "
+							  @"(hatch angle: %lu spacing: 4 colour: ink))\n",
+			(unsigned long)i, (i % 256) / 255.0, (i / 256 % 256) / 255.0, (unsigned long)(1 + i % 8), (unsigned long)(i % 180)];
+
+	[library appendString:@"}\n"];
+	[evaluator addValue:[NSColor blackColor]
+			  forSymbol:@"ink"];
+
+	[self runBenchmark:"style-script"
+			   variant:"parse-evaluate-tree"
+				  size:count
+				 setup:nil
+				  body:^{
+					  XCTAssertNotNil([evaluator evaluateExpression:[parser parseString:library]]);
+				  }];
+
+	[self runBenchmark:"style-script"
+			   variant:"parse-compile-evaluate"
+				  size:count
+				 setup:^{
+					 [DKCompiledScript flushCache];
+				 }
+				  body:^{
+					  XCTAssertNotNil([evaluator evaluateCompiledScript:[DKCompiledScript compiledScriptForString:library
+																										  parser:parser]]);
+				  }];
+
+	[self runBenchmark:"style-script"
+			   variant:"cached-evaluate"
+				  size:count
+				 setup:^{
+					 [DKCompiledScript compiledScriptForString:library
+														parser:parser];
+				 }
+				  body:^{
+					  XCTAssertNotNil([evaluator evaluateCompiledScript:[DKCompiledScript compiledScriptForString:library
+																										  parser:parser]]);
+				  }];
+
+	[DKCompiledScript flushCache];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testDashing
+{
+	// dashing a long path at a run of animated phases, with its measure cached, and measured afresh for each frame
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 10000);
+	const size_t frames = 10;
+	const size_t perRow = 500;
+	const CGFloat step = BENCHMARK_CANVAS / perRow;
+	NSBezierPath* path = [NSBezierPath bezierPath];
+	CGFloat pattern[] = { 12, 4, 2, 4 };
+	DKStrokeDash* dash = [DKStrokeDash dashWithPattern:pattern
+												 count:4];
+	__block NSUInteger frame = 0;
+	size_t i;
+
+	// a serpentine of curves, as the geometry driver uses
+
+	[path moveToPoint:NSZeroPoint];
+
+	for (i = 0; i < count; ++i) {
+		CGFloat dir = ((i / perRow) & 1) ? -1 : 1;
+		NSPoint p = [path currentPoint];
+		CGFloat bulge = (i & 1) ? 8 : -8;
+
+		[path curveToPoint:NSMakePoint(p.x + dir * step, p.y + ((i % perRow) == perRow - 1 ? 40 : 0))
+			 controlPoint1:NSMakePoint(p.x + dir * step / 3, p.y + bulge)
+			 controlPoint2:NSMakePoint(p.x + dir * step * 2 / 3, p.y + bulge)];
+	}
+
+	// the phase steps by an amount that never repeats, so no frame is found in the cache of finished dashes
+
+	void (^dashFrames)(BOOL) = ^(BOOL remeasure) {
+		for (size_t f = 0; f < frames; ++f) {
+			if (remeasure)
+				[DKStrokeDash flushDashCache];
+
+			[dash dashedPathForPath:path
+						  withPhase:++frame * 1.37];
+		}
+	};
+
+	[self runBenchmark:"dash-10-frames"
+			   variant:"measure-cached"
+				  size:count
+				 setup:nil
+				  body:^{
+					  dashFrames(NO);
+				  }];
+
+	[self runBenchmark:"dash-10-frames"
+			   variant:"remeasured"
+				  size:count
+				 setup:nil
+				  body:^{
+					  dashFrames(YES);
+				  }];
+
+	[DKStrokeDash flushDashCache];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testGridScrolling
+{
+	// scrolling a window across a 10m x 10m drawing's grid at several zooms, drawn into a bitmap
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	const size_t frames = 30;
+	const CGFloat side = 10000.0 / 25.4 * 72.0;
+	const CGFloat zooms[] = { 0.25, 1.0, 4.0 };
+	const char* variants[] = { "zoom-25%", "zoom-100%", "zoom-400%" };
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(side, side)];
+	DKGridLayer* grid = [drawing gridLayer];
+	DKDrawingView* view = [[DKDrawingView alloc] initWithFrame:NSMakeRect(0, 0, BENCHMARK_BITMAP_SIZE, BENCHMARK_BITMAP_SIZE)];
+	NSGraphicsContext* context = [NSGraphicsContext graphicsContextWithBitmapImageRep:DKTestBenchmarkBitmap()];
+	int z;
+
+	XCTAssertNotNil(grid, @"the default drawing has no grid");
+
+	for (z = 0; z < 3; ++z) {
+		CGFloat zoom = zooms[z];
+
+		[view zoomViewToAbsoluteScale:zoom];
+
+		[self runBenchmark:"grid-scroll"
+				   variant:variants[z]
+					  size:frames
+					 setup:nil
+					  body:^{
+						  [NSGraphicsContext saveGraphicsState];
+						  [NSGraphicsContext setCurrentContext:context];
+
+						  for (size_t f = 0; f < frames; ++f) {
+							  // scroll 37 pixels down and across each frame, starting near the middle of the drawing
+
+							  NSRect visible = NSMakeRect(side * 0.4 + f * 37 / zoom, side * 0.4 + f * 37 / zoom, BENCHMARK_BITMAP_SIZE / zoom,
+								  BENCHMARK_BITMAP_SIZE / zoom);
+							  NSAffineTransform* tfm = [NSAffineTransform transform];
+
+							  [NSGraphicsContext saveGraphicsState];
+							  [tfm scaleBy:zoom];
+							  [tfm translateXBy:-NSMinX(visible)
+											yBy:-NSMinY(visible)];
+							  [tfm concat];
+							  [grid drawRect:visible
+									  inView:view];
+							  [NSGraphicsContext restoreGraphicsState];
+						  }
+
+						  [NSGraphicsContext restoreGraphicsState];
+					  }];
+	}
+
+	[view release];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testUndo
+{
+	// undoing one group of a move of every object in a drawing
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithShapes:count
+									distribution:kDKBenchmarkUniform
+										   layer:&layer];
+	GCUndoManager* um = [[GCUndoManager alloc] init];
+	NSArray* objects = [layer objects];
+
+	[um setGroupsByEvent:NO];
+	[drawing setUndoManager:um];
+
+	[self runBenchmark:"undo-move-all"
+			   variant:NULL
+				  size:count
+				 setup:^{
+					 [um beginUndoGrouping];
+
+					 for (DKDrawableObject* obj in objects)
+						 [obj offsetLocationByX:10
+											byY:10];
+
+					 [um endUndoGrouping];
+				 }
+				  body:^{
+					  [um undo];
+				  }];
+
+	XCTAssertFalse([um canUndo], @"everything should have been undone");
+
+	[drawing setUndoManager:nil];
+	[um release];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testArchiving
+{
+	// archiving a large drawing, and unarchiving it again
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	DKDrawing* drawing = [self drawingWithShapes:count
+									distribution:kDKBenchmarkUniform
+										   layer:NULL];
+	__block NSData* data = nil;
+	DKBenchmarkResult* result;
+
+	result = [self runBenchmark:"archive-encode"
+						variant:NULL
+						   size:count
+						  setup:nil
+						   body:^{
+							   [data release];
+							   data = [[drawing drawingData] retain];
+						   }];
+
+	if (data == nil)
+		data = [[drawing drawingData] retain];
+
+	if (result) {
+		result->metric = [data length];
+		snprintf(result->metricName, sizeof(result->metricName), "bytes");
+	}
+
+	[self runBenchmark:"archive-decode"
+			   variant:NULL
+				  size:count
+				 setup:nil
+				  body:^{
+					  XCTAssertNotNil([DKDrawing drawingWithData:data], @"the archive could not be read");
+				  }];
+
+	[data release];
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testSVGExport
+{
+	// streaming a large drawing out as SVG, with every object sharing one style, and with 16 styles that are equal but not shared
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 100000);
+	const char* variants[] = { "shared-style", "16-styles" };
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithShapes:count
+									distribution:kDKBenchmarkUniform
+										   layer:&layer];
+	DKSVGExporter* exporter = [[[DKSVGExporter alloc] initWithDrawing:drawing] autorelease];
+	DKBenchmarkResult* result;
+	int v;
+
+	for (v = 0; v < 2; ++v) {
+		if (v == 1) {
+			NSUInteger i = 0;
+
+			for (DKDrawableObject* object in [layer objects]) {
+				DKStyle* style = [[[DKStyle alloc] init] autorelease];
+
+				[style addRenderer:[DKFill fillWithColour:[NSColor colorWithSRGBRed:(i++ % 16) / 15.0
+																			  green:0.5
+																			   blue:0.5
+																			  alpha:1]]];
+				[object setStyle:style];
+			}
+		}
+
+		result = [self runBenchmark:"svg-export"
+							variant:variants[v]
+							   size:count
+							  setup:nil
+							   body:^{
+								   NSOutputStream* stream = [NSOutputStream outputStreamToFileAtPath:@"/dev/null"
+																							  append:NO];
+
+								   XCTAssertTrue([exporter writeToStream:stream
+																   error:NULL]);
+							   }];
+
+		if (result) {
+			result->metric = [exporter styleCount];
+			snprintf(result->metricName, sizeof(result->metricName), "styles");
+			XCTAssertEqual([exporter styleCount], (NSUInteger)(v == 0 ? 1 : 16), @"styles were not written once each");
+		}
+	}
+
+	[self checkResultsFromIndex:first];
+}
+
+- (void)testMarqueeSelection
+{
+	// sweeping a marquee out across a drawing and back, as a selection drag does, finding the objects in the whole marquee and exchanging
+	// the selection on every step, and changing only those the marquee's edges pass over
+
+	size_t first = DKBenchmarkSuiteResultCount(sSuite);
+	size_t count = DKBenchmarkSuiteScaledSize(sSuite, 200000);
+	const size_t steps = 200;
+	const NSPoint anchor = NSMakePoint(BENCHMARK_CANVAS * 0.1, BENCHMARK_CANVAS * 0.1);
+	NSRect* marquees = malloc(steps * sizeof(NSRect));
+	size_t i;
+	int d;
+
+	for (i = 0; i < steps; ++i) {
+		CGFloat t = (i < steps / 2 ? i + 1 : steps - i) / (CGFloat)(steps / 2);
+		NSPoint p = NSMakePoint(anchor.x + BENCHMARK_CANVAS * 0.8 * t, anchor.y + BENCHMARK_CANVAS * 0.8 * t);
+
+		marquees[i] = NSRectFromTwoPoints(anchor, p);
+	}
+
+	for (d = 0; d < kDKBenchmarkDistributionCount; ++d) {
+		const char* distribution = DKBenchmarkDistributionName((DKBenchmarkDistribution)d);
+		DKObjectDrawingLayer* layer = nil;
+		DKDrawing* drawing = [self drawingWithShapes:count
+										distribution:(DKBenchmarkDistribution)d
+											   layer:&layer];
+		__block NSSet* rescanned = nil;
+		__block NSUInteger tested = 0;
+		char variant[64];
+
+		snprintf(variant, sizeof(variant), "rescan-%s", distribution);
+
+		[self runBenchmark:"marquee-sweep"
+				   variant:variant
+					  size:count
+					 setup:^{
+						 [layer deselectAll];
+					 }
+					  body:^{
+						  for (size_t k = 0; k < steps; ++k)
+							  [layer exchangeSelectionWithObjectsFromArray:[layer objectsInRect:marquees[k]]];
+					  }];
+
+		rescanned = [[layer selection] retain];
+		snprintf(variant, sizeof(variant), "incremental-%s", distribution);
+
+		DKBenchmarkResult* result = [self runBenchmark:"marquee-sweep"
+											   variant:variant
+												  size:count
+												 setup:^{
+													 [layer deselectAll];
+												 }
+												  body:^{
+													  DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+
+													  tested = 0;
+
+													  for (size_t k = 0; k < steps; ++k) {
+														  [marquee setRect:marquees[k]
+															  extendingSelection:NO];
+														  tested += [marquee countOfObjectsTested];
+													  }
+
+													  [marquee finish];
+													  [marquee release];
+												  }];
+
+		if (result) {
+			result->metric = (double)tested / steps;
+			snprintf(result->metricName, sizeof(result->metricName), "tests/step");
+			XCTAssertEqualObjects([layer selection], rescanned, @"the marquee selected different objects from a rescan");
+		}
+
+		[rescanned release];
+	}
+
+	free(marquees);
+
+	[self checkResultsFromIndex:first];
+}
+
+@end
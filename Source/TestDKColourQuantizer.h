@@ -0,0 +1,21 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKColourQuantizer.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the colour quantizers.
+
+ These quantize a synthetic 24-megapixel image held in memory, and check the error of the resulting palette against the uniform
+ quantizer and the time taken. They need no window server.
+*/
+@interface TestDKColourQuantizer : XCTestCase
+
+- (void)testOctreeQuantizesLargeImage;
+- (void)testMedianCutQuantizesLargeImage;
+- (void)testBitmapMatchesPixelBuffer;
+
+@end
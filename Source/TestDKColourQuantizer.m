@@ -0,0 +1,238 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKColourQuantizer.h"
+
+#define IMAGE_WIDTH 6000
+#define IMAGE_HEIGHT 4000
+#define MAX_COLOURS 256
+
+// the whole analysis and mapping of the 24 megapixel image must take less than this, in seconds
+
+#define MAX_QUANTIZE_TIME 10.0
+
+@interface TestDKColourQuantizer ()
+
+- (DKPixelBuffer)pixelBufferWithWidth:(NSUInteger)width height:(NSUInteger)height;
+- (CGFloat)rmsErrorOfQuantizer:(DKColourQuantizer*)quantizer buffer:(DKPixelBuffer)buffer indexes:(const uint8_t*)indexes;
+- (CGFloat)quantizeWithQuantizer:(DKColourQuantizer*)quantizer buffer:(DKPixelBuffer)buffer name:(NSString*)name;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKColourQuantizer
+
+- (DKPixelBuffer)pixelBufferWithWidth:(NSUInteger)width height:(NSUInteger)height
+{
+	// a smooth image that uses colours from all over the colour cube: red varies across, green down and blue diagonally
+
+	DKPixelBuffer buffer;
+	uint8_t* data = malloc(width * height * 4);
+	NSUInteger x, y;
+
+	for (y = 0; y < height; ++y) {
+		uint8_t* p = data + y * width * 4;
+		CGFloat fy = (CGFloat)y / height;
+
+		for (x = 0; x < width; ++x, p += 4) {
+			CGFloat fx = (CGFloat)x / width;
+
+			p[0] = (uint8_t)(255.0 * fx);
+			p[1] = (uint8_t)(255.0 * fy);
+			p[2] = (uint8_t)(127.5 + 127.0 * sin(2.0 * M_PI * (fx + fy)));
+			p[3] = 255;
+		}
+	}
+
+	buffer.data = data;
+	buffer.width = width;
+	buffer.height = height;
+	buffer.bytesPerRow = width * 4;
+	buffer.bytesPerPixel = 4;
+	buffer.redOffset = 0;
+
+	return buffer;
+}
+
+- (CGFloat)rmsErrorOfQuantizer:(DKColourQuantizer*)quantizer buffer:(DKPixelBuffer)buffer indexes:(const uint8_t*)indexes
+{
+	NSArray* colours = [quantizer colourTable];
+	NSUInteger i, count = [colours count];
+	CGFloat palette[MAX_COLOURS][3];
+
+	for (i = 0; i < count; ++i) {
+		NSColor* colour = [[colours objectAtIndex:i] colorUsingColorSpace:[NSColorSpace genericRGBColorSpace]];
+
+		palette[i][0] = [colour redComponent] * 255.0;
+		palette[i][1] = [colour greenComponent] * 255.0;
+		palette[i][2] = [colour blueComponent] * 255.0;
+	}
+
+	double error = 0;
+	NSUInteger x, y, c;
+
+	for (y = 0; y < buffer.height; ++y) {
+		const uint8_t* p = buffer.data + y * buffer.bytesPerRow;
+
+		for (x = 0; x < buffer.width; ++x, p += buffer.bytesPerPixel) {
+			NSUInteger index = indexes[y * buffer.width + x];
+
+			XCTAssertLessThan(index, count, @"pixel %lu, %lu mapped to an index beyond the palette", (unsigned long)x, (unsigned long)y);
+
+			if (index >= count)
+				return HUGE_VAL;
+
+			for (c = 0; c < 3; ++c)
+				error += (p[c] - palette[index][c]) * (p[c] - palette[index][c]);
+		}
+	}
+
+	return sqrt(error / (3.0 * buffer.width * buffer.height));
+}
+
+- (CGFloat)quantizeWithQuantizer:(DKColourQuantizer*)quantizer buffer:(DKPixelBuffer)buffer name:(NSString*)name
+{
+	uint8_t* indexes = malloc(buffer.width * buffer.height);
+	NSDate* start = [NSDate date];
+
+	[quantizer analysePixelBuffer:buffer];
+	[quantizer mapPixelBuffer:buffer
+					toIndexes:indexes];
+
+	NSTimeInterval elapsed = -[start timeIntervalSinceNow];
+	CGFloat error = [self rmsErrorOfQuantizer:quantizer
+									   buffer:buffer
+									  indexes:indexes];
+
+	NSLog(@"%@: %lu colours, rms error %.2f, %.2f s (%.1f megapixels/s)", name, (unsigned long)[[quantizer colourTable] count], error, elapsed, (buffer.width * buffer.height) / (elapsed * 1.0e6));
+
+	XCTAssertLessThan(elapsed, MAX_QUANTIZE_TIME, @"%@ took too long to quantize %lu pixels", name, (unsigned long)(buffer.width * buffer.height));
+	XCTAssertLessThanOrEqual([[quantizer colourTable] count], (NSUInteger)MAX_COLOURS, @"%@ made too many colours", name);
+
+	free(indexes);
+
+	return error;
+}
+
+- (void)testOctreeQuantizesLargeImage
+{
+	DKPixelBuffer buffer = [self pixelBufferWithWidth:IMAGE_WIDTH
+											   height:IMAGE_HEIGHT];
+	NSBitmapImageRep* rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																	  pixelsWide:1
+																	  pixelsHigh:1
+																   bitsPerSample:8
+																 samplesPerPixel:4
+																		hasAlpha:YES
+																		isPlanar:NO
+																  colorSpaceName:NSCalibratedRGBColorSpace
+																	 bytesPerRow:0
+																	bitsPerPixel:32] autorelease];
+
+	DKColourQuantizer* uniform = [[[DKColourQuantizer alloc] initWithBitmapImageRep:rep
+																		 maxColours:MAX_COLOURS
+																		 colourBits:8] autorelease];
+	DKOctreeQuantizer* octree = [[[DKOctreeQuantizer alloc] initWithBitmapImageRep:rep
+																		maxColours:MAX_COLOURS
+																		colourBits:8] autorelease];
+
+	CGFloat uniformError = [self quantizeWithQuantizer:uniform
+												buffer:buffer
+												  name:@"uniform"];
+	CGFloat octreeError = [self quantizeWithQuantizer:octree
+											   buffer:buffer
+												 name:@"octree"];
+
+	XCTAssertGreaterThan([octree numberOfColours], (NSUInteger)(MAX_COLOURS / 2), @"octree made too few colours");
+	XCTAssertLessThan(octreeError, uniformError * 0.75, @"octree palette is not much better than a uniform one");
+
+	free((void*)buffer.data);
+}
+
+- (void)testMedianCutQuantizesLargeImage
+{
+	DKPixelBuffer buffer = [self pixelBufferWithWidth:IMAGE_WIDTH
+											   height:IMAGE_HEIGHT];
+	NSBitmapImageRep* rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																	  pixelsWide:1
+																	  pixelsHigh:1
+																   bitsPerSample:8
+																 samplesPerPixel:4
+																		hasAlpha:YES
+																		isPlanar:NO
+																  colorSpaceName:NSCalibratedRGBColorSpace
+																	 bytesPerRow:0
+																	bitsPerPixel:32] autorelease];
+
+	DKMedianCutQuantizer* medianCut = [[[DKMedianCutQuantizer alloc] initWithBitmapImageRep:rep
+																				  maxColours:MAX_COLOURS
+																				  colourBits:8] autorelease];
+
+	[medianCut setRefinementIterations:0];
+
+	CGFloat cutError = [self quantizeWithQuantizer:medianCut
+											buffer:buffer
+											  name:@"median cut"];
+
+	[medianCut setRefinementIterations:2];
+
+	CGFloat refinedError = [self quantizeWithQuantizer:medianCut
+												buffer:buffer
+												  name:@"median cut + k-means"];
+
+	// a uniform 3-3-2 palette gives about 19 on this image
+
+	XCTAssertEqual([medianCut numberOfColours], (NSUInteger)MAX_COLOURS, @"median cut did not use the whole palette");
+	XCTAssertLessThan(cutError, 10.0, @"median cut palette error is too high");
+	XCTAssertLessThanOrEqual(refinedError, cutError + 0.01, @"k-means refinement made the palette worse");
+
+	free((void*)buffer.data);
+}
+
+- (void)testBitmapMatchesPixelBuffer
+{
+	// analysing a bitmap must read the same pixels as analysing its buffer directly
+
+	NSBitmapImageRep* rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																	  pixelsWide:256
+																	  pixelsHigh:128
+																   bitsPerSample:8
+																 samplesPerPixel:4
+																		hasAlpha:YES
+																		isPlanar:NO
+																  colorSpaceName:NSCalibratedRGBColorSpace
+																	 bytesPerRow:0
+																	bitsPerPixel:32] autorelease];
+	DKPixelBuffer source = [self pixelBufferWithWidth:256
+											   height:128];
+	DKPixelBuffer buffer;
+	NSUInteger row;
+
+	for (row = 0; row < 128; ++row)
+		memcpy([rep bitmapData] + row * [rep bytesPerRow], source.data + row * source.bytesPerRow, source.bytesPerRow);
+
+	XCTAssertTrue(DKPixelBufferFromBitmapImageRep(rep, &buffer), @"meshed 8-bit RGBA bitmap was not readable directly");
+	XCTAssertEqual(buffer.width, (NSUInteger)256, @"wrong buffer width");
+	XCTAssertEqual(buffer.height, (NSUInteger)128, @"wrong buffer height");
+	XCTAssertEqual(buffer.bytesPerPixel, (NSUInteger)4, @"wrong bytes per pixel");
+
+	DKMedianCutQuantizer* fromRep = [[[DKMedianCutQuantizer alloc] initWithBitmapImageRep:rep
+																				maxColours:64
+																				colourBits:8] autorelease];
+	DKMedianCutQuantizer* fromBuffer = [[[DKMedianCutQuantizer alloc] initWithBitmapImageRep:rep
+																				   maxColours:64
+																				   colourBits:8] autorelease];
+
+	[fromRep analyse:rep];
+	[fromBuffer analysePixelBuffer:source];
+
+	XCTAssertEqualObjects([fromRep colourTable], [fromBuffer colourTable], @"bitmap and buffer gave different palettes");
+
+	free((void*)source.data);
+}
+
+@end
@@ -0,0 +1,23 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for compiled style scripts.
+
+ Each script is evaluated both by walking its parse tree and by running its compiled form, with the same evaluator, and the results must
+ be the same. The scripting classes are built into the test bundle with their sources, as they are not part of the framework.
+*/
+@interface TestDKCompiledScript : XCTestCase
+
+- (void)testMatchesTreeEvaluation;
+- (void)testSymbolChangesAreSeen;
+- (void)testKeyPathChangesAreSeen;
+- (void)testResultsDontChangeTheScript;
+- (void)testReusedExpressions;
+- (void)testSharedCache;
+
+@end
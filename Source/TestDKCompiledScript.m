@@ -0,0 +1,189 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKCompiledScript.h"
+#import "parser/DKCompiledScript.h"
+#import "parser/DKEvaluator.h"
+#import "parser/DKExpression.h"
+#import "parser/DKParser.h"
+#import "parser/DKSymbol.h"
+
+/** an evaluator that describes each expression rather than keeping it, as DKStyleReader makes objects from them */
+@interface TestDKDescribingEvaluator : DKEvaluator
+@end
+
+@implementation TestDKDescribingEvaluator
+
+- (id)evaluateSimpleExpression:(DKExpression*)expr
+{
+	return [expr description];
+}
+
+- (BOOL)keepsSimpleExpressions
+{
+	return NO;
+}
+
+@end
+
+#pragma mark -
+
+@interface TestDKCompiledScript ()
+
+- (void)checkScript:(NSString*)script evaluator:(DKEvaluator*)evaluator;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKCompiledScript
+
+- (void)checkScript:(NSString*)script evaluator:(DKEvaluator*)evaluator
+{
+	DKParser* parser = [[[DKParser alloc] init] autorelease];
+	id tree = [parser parseString:script];
+
+	XCTAssertNotNil(tree, @"%@ did not parse", script);
+
+	NSString* expected = [[evaluator evaluateExpression:tree] description];
+	DKCompiledScript* compiled = [[[DKCompiledScript alloc] initWithParseTree:tree] autorelease];
+
+	XCTAssertEqualObjects([[compiled evaluateWithEvaluator:evaluator] description], expected, @"%@", script);
+	XCTAssertEqualObjects([[compiled evaluateWithEvaluator:evaluator] description], expected, @"%@ evaluated again", script);
+}
+
+#pragma mark -
+
+- (void)testMatchesTreeEvaluation
+{
+	DKEvaluator* evaluator = [[[DKEvaluator alloc] init] autorelease];
+
+	[evaluator addValue:@"resolved"
+			  forSymbol:@"known"];
+
+	[self checkScript:@"(fill)"
+			evaluator:evaluator];
+	[self checkScript:@"(fill 1 2.5 'text')"
+			evaluator:evaluator];
+	[self checkScript:@"(stroke width: 2 colour: known dash: unknown)"
+			evaluator:evaluator];
+	[self checkScript:@"(style (fill colour: (colour red: 1 green: known blue: -0.5)) (stroke width: known) #(1 2 3) [known size: 2])"
+			evaluator:evaluator];
+	[self checkScript:@"{(fill colour: known) (stroke) {(hatch angle: 45)}}"
+			evaluator:evaluator];
+}
+
+- (void)testSymbolChangesAreSeen
+{
+	DKEvaluator* evaluator = [[[DKEvaluator alloc] init] autorelease];
+	DKParser* parser = [[[DKParser alloc] init] autorelease];
+	DKCompiledScript* compiled = [[[DKCompiledScript alloc] initWithParseTree:[parser parseString:@"(fill colour: paint)"]] autorelease];
+
+	XCTAssertEqual([[compiled symbols] count], (NSUInteger)2);
+
+	[evaluator addValue:@"red"
+			  forSymbol:@"paint"];
+	XCTAssertEqualObjects([[compiled evaluateWithEvaluator:evaluator] valueForKey:@"colour"], @"red");
+
+	// resolved symbols are remembered only until the symbol table changes
+
+	[evaluator addValue:@"blue"
+			  forSymbol:@"paint"];
+	XCTAssertEqualObjects([[compiled evaluateWithEvaluator:evaluator] valueForKey:@"colour"], @"blue");
+}
+
+- (void)testKeyPathChangesAreSeen
+{
+	// the value of a key path can change without the symbol table changing, so it is never remembered
+
+	DKEvaluator* evaluator = [[[DKEvaluator alloc] init] autorelease];
+	NSMutableDictionary* paint = [NSMutableDictionary dictionaryWithObject:@"red"
+																	forKey:@"name"];
+	DKSymbol* name = [DKSymbol symbolForString:@"paint.name"];
+
+	[evaluator addValue:paint
+			  forSymbol:@"paint"];
+	XCTAssertTrue([name isKeyPath]);
+	XCTAssertEqualObjects([evaluator valueForSymbol:name], @"red");
+
+	[paint setObject:@"blue"
+			  forKey:@"name"];
+	XCTAssertEqualObjects([evaluator valueForSymbol:name], @"blue");
+}
+
+- (void)testResultsDontChangeTheScript
+{
+	// a compiled script is shared through the cache, so changing what one evaluation returned must not change the next
+
+	DKEvaluator* evaluator = [[[DKEvaluator alloc] init] autorelease];
+	DKParser* parser = [[[DKParser alloc] init] autorelease];
+	NSArray* scripts = @[@"(fill #(1 2 3) colour: #(4 5))", @"#(1 2 3)"];
+
+	for (NSString* script in scripts) {
+		DKCompiledScript* compiled = [[[DKCompiledScript alloc] initWithParseTree:[parser parseString:script]] autorelease];
+		DKExpression* result = [compiled evaluateWithEvaluator:evaluator];
+		NSString* expected = [result description];
+		NSEnumerator* curs = [result objectEnumerator];
+		id item;
+
+		while ((item = [curs nextObject])) {
+			if ([item isKindOfClass:[DKExpressionPair class]])
+				item = [item value];
+
+			if ([item isKindOfClass:[DKExpression class]])
+				[item addObject:@"changed"];
+		}
+
+		[result addObject:@"changed"];
+		XCTAssertEqualObjects([[compiled evaluateWithEvaluator:evaluator] description], expected, @"%@", script);
+	}
+}
+
+- (void)testReusedExpressions
+{
+	// an evaluator that doesn't keep its expressions is given the same one over and over, which must hold each node's values in turn
+
+	DKEvaluator* evaluator = [[[TestDKDescribingEvaluator alloc] init] autorelease];
+
+	[evaluator addValue:@"resolved"
+			  forSymbol:@"known"];
+
+	[self checkScript:@"(fill 1 2.5 'text')"
+			evaluator:evaluator];
+	[self checkScript:@"(style (fill colour: (colour red: 1 green: known blue: -0.5)) (stroke width: known) #(1 2 3) [known size: 2])"
+			evaluator:evaluator];
+	[self checkScript:@"{(fill colour: known) (stroke) {(hatch angle: 45)}}"
+			evaluator:evaluator];
+}
+
+- (void)testSharedCache
+{
+	DKParser* parser = [[[DKParser alloc] init] autorelease];
+	NSString* script = @"(fill colour: (colour red: 1))";
+	NSString* sameScript = [NSMutableString stringWithString:script];
+
+	[DKCompiledScript flushCache];
+
+	DKCompiledScript* compiled = [DKCompiledScript compiledScriptForString:script
+																	parser:parser];
+
+	XCTAssertNotNil(compiled);
+	XCTAssertEqual([DKCompiledScript compiledScriptForString:sameScript
+													  parser:parser],
+		compiled, @"equal sources share a compiled script");
+	XCTAssertNotEqual([DKCompiledScript compiledScriptForString:@"(fill colour: (colour red: 0))"
+														 parser:parser],
+		compiled);
+
+	[DKCompiledScript flushCache];
+	XCTAssertNotEqual([DKCompiledScript compiledScriptForString:script
+														 parser:parser],
+		compiled);
+	XCTAssertNil([DKCompiledScript compiledScriptForString:nil
+													parser:parser]);
+}
+
+@end
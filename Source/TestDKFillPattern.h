@@ -0,0 +1,21 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKFillPattern.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for filling patterns from a cached tile.
+
+ A rotated pattern is drawn into a bitmap once from its tile and once by placing each motif, and the two must give the same pixels. The
+ bitmap is opaque on one half and clear on the other, so that a difference in how the motifs are composited shows as well as a difference
+ in how they are turned.
+*/
+@interface TestDKFillPattern : XCTestCase
+
+- (void)testTileMatchesMotifsAtAngle;
+- (void)testTileMatchesMotifsNormalToPath;
+
+@end
@@ -0,0 +1,205 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKFillPattern.h"
+
+#define PATTERN_BITMAP_SIZE 200
+
+// the fill pattern's choice between the tile and placing each motif, made by the test instead
+
+@interface DKFillPattern (TestDKFillPattern)
+
+- (BOOL)patternRequiresPerMotifDrawing;
+- (BOOL)drawTiledPatternInPath:(NSBezierPath*)aPath centre:(NSPoint)cp interval:(NSSize)interval angle:(CGFloat)angle motifAngle:(CGFloat)mangle;
+
+@end
+
+@interface DKTestFillPattern : DKFillPattern {
+@public
+	BOOL mPerMotif;
+	BOOL mTileUsed;
+}
+
+@end
+
+@implementation DKTestFillPattern
+
+- (BOOL)patternRequiresPerMotifDrawing
+{
+	return mPerMotif;
+}
+
+- (BOOL)drawTiledPatternInPath:(NSBezierPath*)aPath centre:(NSPoint)cp interval:(NSSize)interval angle:(CGFloat)angle motifAngle:(CGFloat)mangle
+{
+	BOOL drawn = [super drawTiledPatternInPath:aPath
+										centre:cp
+									  interval:interval
+										 angle:angle
+									motifAngle:mangle];
+
+	mTileUsed |= drawn;
+	return drawn;
+}
+
+@end
+
+#pragma mark -
+
+@interface TestDKFillPattern ()
+
+- (NSImage*)motifImage;
+- (DKTestFillPattern*)patternAtAngle:(CGFloat)degrees;
+- (NSBitmapImageRep*)renderPattern:(DKTestFillPattern*)pattern perMotif:(BOOL)perMotif;
+- (double)meanDifferenceBetween:(NSBitmapImageRep*)a and:(NSBitmapImageRep*)b;
+- (void)checkTileMatchesMotifs:(DKTestFillPattern*)pattern;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKFillPattern
+
+- (NSImage*)motifImage
+{
+	// an opaque red bar with a blue block at one end, so that any turn or flip of the motif changes the pixels
+
+	NSBitmapImageRep* rep = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																	 pixelsWide:20
+																	 pixelsHigh:10
+																  bitsPerSample:8
+																samplesPerPixel:4
+																	   hasAlpha:YES
+																	   isPlanar:NO
+																 colorSpaceName:NSCalibratedRGBColorSpace
+																	bytesPerRow:0
+																   bitsPerPixel:0] autorelease];
+	NSInteger x, y;
+
+	for (y = 0; y < 10; ++y) {
+		for (x = 0; x < 20; ++x) {
+			unsigned char* p = [rep bitmapData] + y * [rep bytesPerRow] + x * 4;
+
+			p[0] = x < 14 ? 255 : 0;
+			p[1] = 0;
+			p[2] = x < 14 ? 0 : 255;
+			p[3] = 255;
+		}
+	}
+
+	NSImage* image = [[[NSImage alloc] initWithSize:NSMakeSize(20, 10)] autorelease];
+
+	[image addRepresentation:rep];
+	return image;
+}
+
+- (DKTestFillPattern*)patternAtAngle:(CGFloat)degrees
+{
+	DKTestFillPattern* pattern = [DKTestFillPattern fillPatternWithImage:[self motifImage]];
+
+	[pattern setAngleInDegrees:degrees];
+	[pattern setInterval:6];
+	return pattern;
+}
+
+- (NSBitmapImageRep*)renderPattern:(DKTestFillPattern*)pattern perMotif:(BOOL)perMotif
+{
+	NSBitmapImageRep* bitmap = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																		pixelsWide:PATTERN_BITMAP_SIZE
+																		pixelsHigh:PATTERN_BITMAP_SIZE
+																	 bitsPerSample:8
+																   samplesPerPixel:4
+																		  hasAlpha:YES
+																		  isPlanar:NO
+																	colorSpaceName:NSCalibratedRGBColorSpace
+																	   bytesPerRow:0
+																	  bitsPerPixel:0] autorelease];
+
+	pattern->mPerMotif = perMotif;
+	pattern->mTileUsed = NO;
+
+	[NSGraphicsContext saveGraphicsState];
+	[NSGraphicsContext setCurrentContext:[NSGraphicsContext graphicsContextWithBitmapImageRep:bitmap]];
+
+	// the left half is opaque and the right half clear, where motifs drawn source-atop leave nothing
+
+	[[NSColor whiteColor] set];
+	NSRectFill(NSMakeRect(0, 0, PATTERN_BITMAP_SIZE / 2, PATTERN_BITMAP_SIZE));
+
+	[pattern renderPath:[NSBezierPath bezierPathWithOvalInRect:NSMakeRect(20, 20, PATTERN_BITMAP_SIZE - 40, PATTERN_BITMAP_SIZE - 40)]];
+
+	[NSGraphicsContext restoreGraphicsState];
+
+	return bitmap;
+}
+
+- (double)meanDifferenceBetween:(NSBitmapImageRep*)a and:(NSBitmapImageRep*)b
+{
+	double total = 0;
+	NSInteger x, y, c;
+
+	for (y = 0; y < PATTERN_BITMAP_SIZE; ++y) {
+		const unsigned char* pa = [a bitmapData] + y * [a bytesPerRow];
+		const unsigned char* pb = [b bitmapData] + y * [b bytesPerRow];
+
+		for (x = 0; x < PATTERN_BITMAP_SIZE; ++x) {
+			for (c = 0; c < 4; ++c)
+				total += ABS((int)pa[x * 4 + c] - (int)pb[x * 4 + c]);
+		}
+	}
+
+	return total / (PATTERN_BITMAP_SIZE * PATTERN_BITMAP_SIZE * 4);
+}
+
+- (void)checkTileMatchesMotifs:(DKTestFillPattern*)pattern
+{
+	NSBitmapImageRep* motifs = [self renderPattern:pattern
+										  perMotif:YES];
+
+	XCTAssertFalse(pattern->mTileUsed, @"motifs were not placed one by one");
+
+	NSBitmapImageRep* tiled = [self renderPattern:pattern
+										 perMotif:NO];
+
+	XCTAssertTrue(pattern->mTileUsed, @"the tile was not used");
+
+	// the tile is resampled as it is drawn, so edges differ a little. A motif turned or composited differently changes whole motifs, which
+	// is checked against the same pattern drawn unrotated
+
+	NSBitmapImageRep* unrotated = [self renderPattern:[self patternAtAngle:0]
+											 perMotif:YES];
+	double difference = [self meanDifferenceBetween:motifs
+												and:tiled];
+	double rotation = [self meanDifferenceBetween:motifs
+											  and:unrotated];
+
+	XCTAssertGreaterThan(rotation, 10.0, @"rotating the pattern made no difference, so the comparison can't detect one");
+	XCTAssertLessThan(difference, 2.0, @"the tile drew different pixels from placing each motif (mean difference %g)", difference);
+}
+
+#pragma mark -
+
+- (void)testTileMatchesMotifsAtAngle
+{
+	// not normal to the path, so each motif stays upright while the pattern as a whole is turned
+
+	DKTestFillPattern* pattern = [self patternAtAngle:30];
+
+	[pattern setNormalToPath:NO];
+	[self checkTileMatchesMotifs:pattern];
+}
+
+- (void)testTileMatchesMotifsNormalToPath
+{
+	DKTestFillPattern* pattern = [self patternAtAngle:30];
+
+	[pattern setNormalToPath:YES];
+	[pattern setMotifAngleInDegrees:15];
+	[pattern setLateralOffset:3];
+	[pattern setLateralOffsetAlternates:YES];
+	[self checkTileMatchesMotifs:pattern];
+}
+
+@end
@@ -0,0 +1,23 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKInstrumentation.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the performance instrumentation.
+
+ These check that timers, counters and histograms record what they are given, that nothing is recorded while disabled, that the trace
+ exports as valid Chrome trace JSON, and that enabling instrumentation adds less than 1% to the time taken to draw a drawing of a
+ few thousand styled shapes, with all of the framework's own probes firing.
+*/
+@interface TestDKInstrumentation : XCTestCase
+
+- (void)testTimersCountersAndHistograms;
+- (void)testDisabledRecordsNothing;
+- (void)testTraceExport;
+- (void)testOverheadUnderOnePercent;
+
+@end
@@ -0,0 +1,249 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKInstrumentation.h"
+#import <DKDrawKit/DKDrawableShape.h>
+#import <DKDrawKit/DKDrawing.h>
+#import <DKDrawKit/DKObjectDrawingLayer.h>
+#import <DKDrawKit/DKStyle.h>
+
+// a drawing of shapes with a fill and a stroke, drawn whole into a bitmap, so that the drawing, layer, storage and renderer probes all fire
+
+#define OVERHEAD_CANVAS 1000.0
+#define OVERHEAD_BITMAP_SIZE 500
+#define OVERHEAD_SHAPES_PER_SIDE 40
+#define OVERHEAD_FRAMES 4
+#define OVERHEAD_ROUNDS 9
+
+@interface TestDKInstrumentation ()
+
+- (DKDrawing*)overheadDrawing;
+- (NSGraphicsContext*)overheadContext;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKInstrumentation
+
+- (void)tearDown
+{
+	[DKInstrumentation setEnabled:NO];
+	[DKInstrumentation reset];
+	[super tearDown];
+}
+
+- (void)testTimersCountersAndHistograms
+{
+	NSUInteger i;
+
+	[DKInstrumentation setEnabled:YES];
+	[DKInstrumentation reset];
+
+	for (i = 0; i < 100; ++i) {
+		DK_INSTRUMENT_SCOPE("test", "timed");
+		DK_INSTRUMENT_COUNT("test", "counted", 2);
+		DK_INSTRUMENT_VALUE("test", "values", (int64_t)i + 1);
+	}
+
+	NSDictionary* timed = [DKInstrumentation statisticsForMetricNamed:@"timed"
+															 category:@"test"];
+	NSDictionary* counted = [DKInstrumentation statisticsForMetricNamed:@"counted"
+															   category:@"test"];
+	NSDictionary* values = [DKInstrumentation statisticsForMetricNamed:@"values"
+															  category:@"test"];
+
+	XCTAssertEqual([timed[kDKInstrumentCountKey] integerValue], 100, @"every scope should be timed");
+	XCTAssertGreaterThanOrEqual([timed[kDKInstrumentMaximumKey] doubleValue], [timed[kDKInstrumentMinimumKey] doubleValue], @"max below min");
+	XCTAssertEqual([counted[kDKInstrumentCountKey] integerValue], 100, @"wrong number of increments");
+	XCTAssertEqual([counted[kDKInstrumentTotalKey] integerValue], 200, @"wrong counter total");
+
+	XCTAssertEqual([values[kDKInstrumentMinimumKey] doubleValue], 1.0, @"wrong minimum");
+	XCTAssertEqual([values[kDKInstrumentMaximumKey] doubleValue], 100.0, @"wrong maximum");
+	XCTAssertEqualWithAccuracy([values[kDKInstrumentMeanKey] doubleValue], 50.5, 1e-9, @"wrong mean");
+	XCTAssertEqualWithAccuracy([values[kDKInstrumentMedianKey] doubleValue], 50.0, 50.0 * 0.2, @"median outside bucket accuracy");
+	XCTAssertEqualWithAccuracy([values[kDKInstrumentPercentile90Key] doubleValue], 90.0, 90.0 * 0.2, @"p90 outside bucket accuracy");
+
+	NSString* table = [DKInstrumentation summaryTable];
+
+	XCTAssertTrue([table rangeOfString:@"timed"].location != NSNotFound, @"summary is missing the timer");
+	XCTAssertTrue([table rangeOfString:@"counted"].location != NSNotFound, @"summary is missing the counter");
+
+	[DKInstrumentation reset];
+	XCTAssertNil([DKInstrumentation statisticsForMetricNamed:@"timed"
+													category:@"test"],
+				 @"reset should clear the metric");
+}
+
+- (void)testDisabledRecordsNothing
+{
+	NSUInteger i;
+
+	[DKInstrumentation setEnabled:NO];
+	[DKInstrumentation reset];
+
+	for (i = 0; i < 100; ++i) {
+		DK_INSTRUMENT_SCOPE("test", "disabled timer");
+		DK_INSTRUMENT_COUNT("test", "disabled counter", 1);
+	}
+
+	XCTAssertNil([DKInstrumentation statisticsForMetricNamed:@"disabled timer"
+													category:@"test"],
+				 @"disabled scope was timed");
+	XCTAssertNil([DKInstrumentation statisticsForMetricNamed:@"disabled counter"
+													category:@"test"],
+				 @"disabled counter was counted");
+}
+
+- (void)testTraceExport
+{
+	NSUInteger i;
+
+	[DKInstrumentation setEnabled:YES];
+	[DKInstrumentation reset];
+
+	// a name that needs escaping, and scopes on another thread
+
+	for (i = 0; i < 10; ++i) {
+		DK_INSTRUMENT_SCOPE("test", "trace \"quoted\"");
+		DK_INSTRUMENT_COUNT("test", "trace counter", 1);
+	}
+
+	dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t n) {
+#pragma unused(n)
+		DKInstrumentScope scope = DKInstrumentScopeBeginForClass("test", [NSString class]);
+		DKInstrumentScopeEnd(&scope);
+	});
+
+	NSError* error = nil;
+	NSDictionary* trace = [NSJSONSerialization JSONObjectWithData:[DKInstrumentation traceData]
+														  options:0
+															error:&error];
+
+	XCTAssertNotNil(trace, @"trace is not valid JSON: %@", error);
+
+	NSUInteger complete = 0, counters = 0, classEvents = 0;
+
+	for (NSDictionary* event in trace[@"traceEvents"]) {
+		if ([event[@"ph"] isEqualToString:@"X"]) {
+			++complete;
+
+			if ([event[@"name"] isEqualToString:@"NSString"])
+				++classEvents;
+			else
+				XCTAssertEqualObjects(event[@"name"], @"trace \"quoted\"", @"name not escaped correctly");
+
+			XCTAssertGreaterThanOrEqual([event[@"dur"] doubleValue], 0.0, @"negative duration");
+		} else if ([event[@"ph"] isEqualToString:@"C"]) {
+			++counters;
+			XCTAssertEqual([event[@"args"][@"value"] integerValue], 10, @"wrong counter value");
+		}
+	}
+
+	XCTAssertEqual(complete, (NSUInteger)14, @"every scope should be a complete event");
+	XCTAssertEqual(classEvents, (NSUInteger)4, @"every thread's scope should be traced");
+	XCTAssertEqual(counters, (NSUInteger)1, @"the counter should be exported once");
+}
+
+- (DKDrawing*)overheadDrawing
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(OVERHEAD_CANVAS, OVERHEAD_CANVAS)];
+	DKObjectDrawingLayer* layer = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+	DKStyle* style = [DKStyle styleWithFillColour:[NSColor colorWithCalibratedRed:0.2
+																			 green:0.5
+																			  blue:0.8
+																			 alpha:0.5]
+									 strokeColour:[NSColor blackColor]
+									  strokeWidth:2.0];
+	CGFloat pitch = OVERHEAD_CANVAS / OVERHEAD_SHAPES_PER_SIDE;
+	NSUInteger x, y;
+
+	for (y = 0; y < OVERHEAD_SHAPES_PER_SIDE; ++y) {
+		for (x = 0; x < OVERHEAD_SHAPES_PER_SIDE; ++x) {
+			DKDrawableShape* shape = [DKDrawableShape drawableShapeWithOvalInRect:NSMakeRect(x * pitch + 2, y * pitch + 2, pitch * 1.5, pitch - 4)];
+
+			[shape setStyle:style];
+			[shape rotateByAngle:(x + y) * 0.1];
+			[layer addObject:shape];
+		}
+	}
+
+	return drawing;
+}
+
+- (NSGraphicsContext*)overheadContext
+{
+	NSBitmapImageRep* bitmap = [[[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+																		pixelsWide:OVERHEAD_BITMAP_SIZE
+																		pixelsHigh:OVERHEAD_BITMAP_SIZE
+																	 bitsPerSample:8
+																   samplesPerPixel:4
+																		  hasAlpha:YES
+																		  isPlanar:NO
+																	colorSpaceName:NSCalibratedRGBColorSpace
+																	   bytesPerRow:0
+																	  bitsPerPixel:0] autorelease];
+
+	return [NSGraphicsContext graphicsContextWithBitmapImageRep:bitmap];
+}
+
+- (void)testOverheadUnderOnePercent
+{
+	DKDrawing* drawing = [self overheadDrawing];
+	NSGraphicsContext* context = [self overheadContext];
+	NSRect all = NSMakeRect(0, 0, OVERHEAD_CANVAS, OVERHEAD_CANVAS);
+	NSTimeInterval best[2] = { INFINITY, INFINITY };
+	NSUInteger round, enabled, frame;
+
+	// enabled and disabled runs alternate, and the best of each is compared, so that noise from the machine affects both alike. A frame
+	// is drawn first so that caches are warm and every class metric is registered before timing starts
+
+	for (round = 0; round <= OVERHEAD_ROUNDS; ++round) {
+		for (enabled = 0; enabled < 2; ++enabled) {
+			[DKInstrumentation setEnabled:enabled != 0];
+			[DKInstrumentation reset];
+
+			@autoreleasepool {
+				[NSGraphicsContext saveGraphicsState];
+				[NSGraphicsContext setCurrentContext:context];
+
+				NSAffineTransform* scale = [NSAffineTransform transform];
+
+				[scale scaleBy:OVERHEAD_BITMAP_SIZE / OVERHEAD_CANVAS];
+				[scale concat];
+
+				NSTimeInterval start = [[NSProcessInfo processInfo] systemUptime];
+
+				for (frame = 0; frame < OVERHEAD_FRAMES; ++frame)
+					[drawing drawRect:all
+							   inView:nil];
+
+				NSTimeInterval elapsed = [[NSProcessInfo processInfo] systemUptime] - start;
+
+				[NSGraphicsContext restoreGraphicsState];
+
+				if (round > 0)
+					best[enabled] = MIN(best[enabled], elapsed);
+			}
+		}
+
+		// every frame passes through the drawing's own scope, and each shape's fill and stroke through a renderer's
+
+		XCTAssertEqual([[DKInstrumentation statisticsForMetricNamed:@"drawing"
+														   category:@"draw"][kDKInstrumentCountKey] integerValue],
+					   OVERHEAD_FRAMES, @"enabled drawing was not recorded");
+		XCTAssertGreaterThanOrEqual([[DKInstrumentation statisticsForMetricNamed:@"DKFill"
+																		category:@"render"][kDKInstrumentCountKey] integerValue],
+									OVERHEAD_FRAMES * OVERHEAD_SHAPES_PER_SIDE * OVERHEAD_SHAPES_PER_SIDE, @"fills were not recorded");
+	}
+
+	double overhead = best[1] / best[0] - 1.0;
+
+	NSLog(@"instrumentation overhead %.3f%% (%.2fms disabled, %.2fms enabled)", overhead * 100.0, best[0] * 1000.0, best[1] * 1000.0);
+	XCTAssertLessThan(overhead, 0.01, @"enabled instrumentation added %.2f%% to drawing", overhead * 100.0);
+}
+
+@end
@@ -0,0 +1,23 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKMarqueeSelection.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the incremental marquee selection.
+
+ These drag a marquee over a grid of shapes and check the layer's selection against the objects a full rescan of the marquee finds.
+*/
+@interface TestDKMarqueeSelection : XCTestCase
+
+- (void)testSweepMatchesRescan;
+- (void)testSmallStepTestsFewObjects;
+- (void)testExtendingKeepsInitialSelection;
+- (void)testTogglingExtend;
+- (void)testEmptyMarqueeDeselects;
+- (void)testChangeSelectionReportsChanges;
+
+@end
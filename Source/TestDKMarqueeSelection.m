@@ -0,0 +1,219 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKMarqueeSelection.h"
+#import <DKDrawKit/DKDrawableShape.h>
+#import <DKDrawKit/DKDrawing.h>
+#import <DKDrawKit/DKObjectDrawingLayer.h>
+
+// a grid of 20 x 20 shapes, 40 points square on a 50 point pitch
+
+#define kGridCount 20
+#define kGridPitch 50.0
+#define kGridShapeSize 40.0
+
+@interface TestDKMarqueeSelection ()
+
+- (DKDrawing*)drawingWithGridInLayer:(DKObjectDrawingLayer**)layer;
+- (NSSet*)objectsInRect:(NSRect)rect layer:(DKObjectDrawingLayer*)layer;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKMarqueeSelection
+
+- (DKDrawing*)drawingWithGridInLayer:(DKObjectDrawingLayer**)layer
+{
+	NSMutableArray* shapes = [NSMutableArray arrayWithCapacity:kGridCount * kGridCount];
+	NSInteger i, j;
+
+	for (j = 0; j < kGridCount; ++j) {
+		for (i = 0; i < kGridCount; ++i) {
+			NSRect r = NSMakeRect(10 + i * kGridPitch, 10 + j * kGridPitch, kGridShapeSize, kGridShapeSize);
+			[shapes addObject:[DKDrawableShape drawableShapeWithRect:r]];
+		}
+	}
+
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(kGridCount * kGridPitch + 20, kGridCount * kGridPitch + 20)];
+	DKObjectDrawingLayer* odl = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+
+	[odl addObjectsFromArray:shapes];
+	*layer = odl;
+
+	return drawing;
+}
+
+- (NSSet*)objectsInRect:(NSRect)rect layer:(DKObjectDrawingLayer*)layer
+{
+	return [NSSet setWithArray:[layer objectsInRect:rect]];
+}
+
+- (void)testSweepMatchesRescan
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+	const NSPoint anchor = NSMakePoint(515, 485);
+	NSInteger i;
+
+	XCTAssertNotNil(drawing);
+
+	// out to each corner in turn and back through the anchor, so that the marquee flips from one side of it to the other
+
+	NSPoint corners[4] = { { 990, 990 }, { 20, 990 }, { 20, 20 }, { 990, 20 } };
+
+	for (NSInteger c = 0; c < 4; ++c) {
+		for (i = 0; i <= 40; ++i) {
+			CGFloat t = (i <= 20 ? i : 40 - i) / 20.0;
+			NSPoint p = NSMakePoint(anchor.x + (corners[c].x - anchor.x) * t, anchor.y + (corners[c].y - anchor.y) * t);
+			NSRect rect = NSRectFromTwoPoints(anchor, p);
+
+			[marquee setRect:rect
+				extendingSelection:NO];
+
+			NSSet* expected = [self objectsInRect:rect
+											layer:layer];
+
+			XCTAssertEqualObjects([layer selection], expected, @"marquee selection differs from a rescan at %@", NSStringFromRect(rect));
+			XCTAssertEqual([marquee countOfObjects], [expected count]);
+		}
+	}
+
+	[marquee finish];
+	[marquee release];
+}
+
+- (void)testSmallStepTestsFewObjects
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+
+	XCTAssertNotNil(drawing);
+
+	[marquee setRect:NSMakeRect(0, 0, 785, 785)
+		extendingSelection:NO];
+	XCTAssertEqual([marquee countOfObjects], (NSUInteger)(16 * 16));
+
+	// moving one edge by a point only looks at the column of shapes along it
+
+	[marquee setRect:NSMakeRect(0, 0, 786, 785)
+		extendingSelection:NO];
+	XCTAssertEqual([marquee countOfObjects], (NSUInteger)(16 * 16));
+	XCTAssertLessThan([marquee countOfObjectsTested], (NSUInteger)(16 * 16) / 4, @"a small step tested too many objects");
+
+	[marquee finish];
+	[marquee release];
+}
+
+- (void)testExtendingKeepsInitialSelection
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	NSSet* initial = [self objectsInRect:NSMakeRect(900, 900, 100, 100)
+								   layer:layer];
+
+	XCTAssertNotNil(drawing);
+	[layer exchangeSelectionWithObjectsFromArray:[initial allObjects]];
+
+	DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+	NSRect rect = NSMakeRect(0, 0, 200, 200);
+
+	[marquee setRect:rect
+		extendingSelection:YES];
+	XCTAssertEqualObjects([layer selection], [initial setByAddingObjectsFromSet:[self objectsInRect:rect layer:layer]]);
+
+	// the marquee passing over an initially selected object and leaving it again doesn't deselect it
+
+	rect = NSMakeRect(0, 0, 1000, 1000);
+	[marquee setRect:rect
+		extendingSelection:YES];
+	rect = NSMakeRect(0, 0, 100, 100);
+	[marquee setRect:rect
+		extendingSelection:YES];
+	XCTAssertEqualObjects([layer selection], [initial setByAddingObjectsFromSet:[self objectsInRect:rect layer:layer]]);
+
+	[marquee finish];
+	[marquee release];
+}
+
+- (void)testTogglingExtend
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	NSSet* initial = [self objectsInRect:NSMakeRect(900, 900, 100, 100)
+								   layer:layer];
+	NSRect rect = NSMakeRect(0, 0, 300, 300);
+
+	XCTAssertNotNil(drawing);
+	[layer exchangeSelectionWithObjectsFromArray:[initial allObjects]];
+
+	DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+	NSSet* inMarquee = [self objectsInRect:rect
+									 layer:layer];
+
+	[marquee setRect:rect
+		extendingSelection:NO];
+	XCTAssertEqualObjects([layer selection], inMarquee);
+
+	[marquee setRect:rect
+		extendingSelection:YES];
+	XCTAssertEqualObjects([layer selection], [initial setByAddingObjectsFromSet:inMarquee]);
+
+	[marquee setRect:rect
+		extendingSelection:NO];
+	XCTAssertEqualObjects([layer selection], inMarquee);
+
+	[marquee finish];
+	[marquee release];
+}
+
+- (void)testEmptyMarqueeDeselects
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	DKMarqueeSelection* marquee = [[DKMarqueeSelection alloc] initWithLayer:layer];
+
+	XCTAssertNotNil(drawing);
+
+	XCTAssertTrue([marquee setRect:NSMakeRect(100, 100, 400, 400) extendingSelection:NO]);
+	XCTAssertGreaterThan([layer countOfSelection], (NSUInteger)0);
+
+	XCTAssertTrue([marquee setRect:NSMakeRect(100, 100, 0, 0) extendingSelection:NO]);
+	XCTAssertEqual([layer countOfSelection], (NSUInteger)0);
+	XCTAssertEqual([marquee countOfObjects], (NSUInteger)0);
+
+	// nothing left to deselect
+
+	XCTAssertFalse([marquee setRect:NSMakeRect(100, 100, 0, 0) extendingSelection:NO]);
+
+	[marquee finish];
+	[marquee release];
+}
+
+- (void)testChangeSelectionReportsChanges
+{
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithGridInLayer:&layer];
+	NSArray* some = [layer objectsInRect:NSMakeRect(0, 0, 200, 200)];
+
+	XCTAssertNotNil(drawing);
+
+	XCTAssertTrue([layer changeSelectionByAddingObjectsFromArray:some removingObjectsInArray:@[]]);
+	XCTAssertEqualObjects([layer selection], [NSSet setWithArray:some]);
+
+	// adding what is already selected, or removing what isn't, changes nothing
+
+	XCTAssertFalse([layer changeSelectionByAddingObjectsFromArray:some removingObjectsInArray:@[]]);
+	XCTAssertFalse([layer changeSelectionByAddingObjectsFromArray:@[]
+										   removingObjectsInArray:[layer objectsInRect:NSMakeRect(600, 600, 200, 200)]]);
+
+	XCTAssertTrue([layer changeSelectionByAddingObjectsFromArray:@[] removingObjectsInArray:some]);
+	XCTAssertEqual([layer countOfSelection], (NSUInteger)0);
+}
+
+@end
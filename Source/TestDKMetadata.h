@@ -0,0 +1,21 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKDrawableObject+Metadata.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for metadata inherited from an object's container.
+
+ These check that changing an inherited item changes only the object it is changed through, and that its siblings go on seeing the
+ container's item.
+*/
+@interface TestDKMetadata : XCTestCase
+
+- (void)testChangingInheritedValue;
+- (void)testChangingInheritedType;
+- (void)testChangingContainerItem;
+
+@end
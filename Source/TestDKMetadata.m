@@ -0,0 +1,128 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKMetadata.h"
+#import <DKDrawKit/DKDrawableShape.h>
+#import <DKDrawKit/DKDrawing.h>
+#import <DKDrawKit/DKLayer+Metadata.h>
+#import <DKDrawKit/DKMetadataItem.h>
+#import <DKDrawKit/DKObjectDrawingLayer.h>
+
+@interface TestDKMetadata ()
+
+- (DKDrawing*)drawingWithSiblings:(NSArray**)siblings layer:(DKObjectDrawingLayer**)layer;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKMetadata
+
+- (DKDrawing*)drawingWithSiblings:(NSArray**)siblings layer:(DKObjectDrawingLayer**)layer
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(500, 500)];
+	DKObjectDrawingLayer* odl = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+	NSMutableArray* shapes = [NSMutableArray array];
+	NSInteger i;
+
+	for (i = 0; i < 3; ++i)
+		[shapes addObject:[DKDrawableShape drawableShapeWithRect:NSMakeRect(10 + i * 100, 10, 50, 50)]];
+
+	[odl addObjectsFromArray:shapes];
+	[odl setString:@"red"
+			forKey:@"tint"];
+
+	*siblings = shapes;
+	*layer = odl;
+
+	return drawing;
+}
+
+- (void)testChangingInheritedValue
+{
+	NSArray* siblings = nil;
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithSiblings:&siblings
+											 layer:&layer];
+	DKDrawableObject* a = siblings[0];
+	DKDrawableObject* b = siblings[1];
+
+	XCTAssertNotNil(drawing);
+
+	// reading through the container first fills each sibling's cache of inherited items
+
+	XCTAssertEqualObjects([a stringForKey:@"tint"], @"red");
+	XCTAssertEqualObjects([b stringForKey:@"tint"], @"red");
+	XCTAssertNil([a metadataItemForKey:@"tint" limitToLocalSearch:YES]);
+
+	NSUInteger checksum = [b metadataChecksum];
+
+	[a setMetadataItemValue:@"blue"
+					 forKey:@"tint"];
+
+	XCTAssertEqualObjects([a stringForKey:@"tint"], @"blue");
+	XCTAssertNotNil([a metadataItemForKey:@"tint" limitToLocalSearch:YES], @"the inherited item was copied into the object changing it");
+	XCTAssertEqualObjects([b stringForKey:@"tint"], @"red", @"a sibling still sees the container's item");
+	XCTAssertEqualObjects([layer stringForKey:@"tint"], @"red", @"the container's item is unchanged");
+	XCTAssertEqual([b metadataChecksum], checksum, @"nothing b inherits has changed");
+
+	// b's checksum is cached, so the layer must tell it when its own metadata changes
+
+	[layer setString:@"green"
+			  forKey:@"tint"];
+
+	XCTAssertNotEqual([b metadataChecksum], checksum, @"the container's metadata has changed");
+	XCTAssertEqualObjects([b stringForKey:@"tint"], @"green");
+}
+
+- (void)testChangingInheritedType
+{
+	NSArray* siblings = nil;
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithSiblings:&siblings
+											 layer:&layer];
+	DKDrawableObject* a = siblings[0];
+	DKDrawableObject* b = siblings[1];
+
+	XCTAssertNotNil(drawing);
+	XCTAssertEqual([[b metadataItemForKey:@"tint"] type], DKMetadataTypeString);
+
+	[a setMetadataItemType:DKMetadataTypeAttributedString
+					forKey:@"tint"];
+
+	XCTAssertEqual([[a metadataItemForKey:@"tint"] type], DKMetadataTypeAttributedString);
+	XCTAssertEqual([[b metadataItemForKey:@"tint"] type], DKMetadataTypeString, @"a sibling still sees the container's item");
+	XCTAssertEqual([[layer metadataItemForKey:@"tint"] type], DKMetadataTypeString, @"the container's item is unchanged");
+}
+
+- (void)testChangingContainerItem
+{
+	NSArray* siblings = nil;
+	DKObjectDrawingLayer* layer = nil;
+	DKDrawing* drawing = [self drawingWithSiblings:&siblings
+											 layer:&layer];
+	DKDrawableObject* a = siblings[0];
+	DKDrawableObject* b = siblings[1];
+	DKDrawableObject* c = siblings[2];
+
+	XCTAssertNotNil(drawing);
+
+	[a setMetadataItemValue:@"blue"
+					 forKey:@"tint"];
+	XCTAssertEqualObjects([b stringForKey:@"tint"], @"red");
+	XCTAssertEqualObjects([c stringForKey:@"tint"], @"red");
+
+	// changing the container's own item is seen by every sibling that still inherits it, but not by one with its own copy
+
+	[layer setMetadataItemValue:@"green"
+						 forKey:@"tint"];
+
+	XCTAssertEqualObjects([a stringForKey:@"tint"], @"blue");
+	XCTAssertEqualObjects([b stringForKey:@"tint"], @"green");
+	XCTAssertEqualObjects([c stringForKey:@"tint"], @"green");
+}
+
+@end
@@ -0,0 +1,24 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKPathOffset.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the offset engine.
+
+ These check the area of the offsets of simple closed shapes, whose true offsets are known, and in particular that an inset as deep as the
+ shape or deeper leaves nothing rather than a stray loop. Offsets of random smooth shapes are checked for loops left behind by finding
+ how near the shape each comes.
+*/
+@interface TestDKPathOffset : XCTestCase
+
+- (void)testSquareInset;
+- (void)testSquareInsetToNothing;
+- (void)testSquareOutset;
+- (void)testClockwiseSquareInset;
+- (void)testRandomBlobOffsetsKeepTheirDistance;
+
+@end
@@ -0,0 +1,215 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKPathOffset.h"
+
+@interface TestDKPathOffset ()
+
+- (void)appendSquareOfSide:(double)side clockwise:(BOOL)clockwise toPath:(DKPathBuffer*)path;
+- (double)areaOfOffset:(double)offset ofSquareOfSide:(double)side clockwise:(BOOL)clockwise isEmpty:(BOOL*)isEmpty;
+- (void)appendRandomBlobWithCorners:(int)corners toPath:(DKPathBuffer*)path;
+- (double)distanceFromPoint:(DKPathPoint)p toPath:(const DKPathBuffer*)path;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKPathOffset
+
+- (void)appendSquareOfSide:(double)side clockwise:(BOOL)clockwise toPath:(DKPathBuffer*)path
+{
+	DKPathPoint corners[4] = { { 0, 0 }, { side, 0 }, { side, side }, { 0, side } };
+	int k;
+
+	DKPathBufferMoveTo(path, corners[0]);
+
+	for (k = 1; k < 4; ++k)
+		DKPathBufferLineTo(path, corners[clockwise ? 4 - k : k]);
+
+	DKPathBufferClose(path);
+}
+
+- (double)areaOfOffset:(double)offset ofSquareOfSide:(double)side clockwise:(BOOL)clockwise isEmpty:(BOOL*)isEmpty
+{
+	DKPathBuffer square, result;
+
+	DKPathBufferInit(&square);
+	DKPathBufferInit(&result);
+	[self appendSquareOfSide:side clockwise:clockwise toPath:&square];
+
+	XCTAssertTrue(DKPathOffset(&square, offset, NULL, &result));
+
+	double area = DKPathBufferSignedArea(&result);
+
+	if (isEmpty)
+		*isEmpty = DKPathBufferIsEmpty(&result);
+
+	DKPathBufferFree(&square);
+	DKPathBufferFree(&result);
+	return area;
+}
+
+- (void)appendRandomBlobWithCorners:(int)corners toPath:(DKPathBuffer*)path
+{
+	// a smooth closed curve through points at random distances from the origin, taken in turn round it so that it doesn't cross itself
+
+	DKPathPoint v[16];
+	int k;
+
+	for (k = 0; k < corners; ++k) {
+		double angle = 2.0 * M_PI * (k + 0.3 * random() / (double)INT32_MAX) / corners;
+		double radius = 60.0 + 40.0 * random() / (double)INT32_MAX;
+
+		v[k] = (DKPathPoint){ radius * cos(angle), radius * sin(angle) };
+	}
+
+	DKPathBufferMoveTo(path, v[0]);
+
+	for (k = 0; k < corners; ++k) {
+		DKPathPoint p0 = v[(k + corners - 1) % corners], p1 = v[k], p2 = v[(k + 1) % corners], p3 = v[(k + 2) % corners];
+
+		DKPathBufferCurveTo(path, (DKPathPoint){ p1.x + (p2.x - p0.x) / 6, p1.y + (p2.y - p0.y) / 6 }, (DKPathPoint){ p2.x - (p3.x - p1.x) / 6, p2.y - (p3.y - p1.y) / 6 }, p2);
+	}
+
+	DKPathBufferClose(path);
+}
+
+- (double)distanceFromPoint:(DKPathPoint)p toPath:(const DKPathBuffer*)path
+{
+	// measured to the curves flattened far more finely than the offset's tolerance
+
+	const DKPathPoint* points = path->points;
+	DKPathPoint current = { 0, 0 };
+	double best = INFINITY;
+	size_t v;
+	int i;
+
+	for (v = 0; v < path->verbCount; ++v) {
+		if (path->verbs[v] == kDKPathCurveTo) {
+			DKPathPoint c[4] = { current, points[0], points[1], points[2] };
+			DKPathPoint a = current;
+
+			for (i = 1; i <= 256; ++i) {
+				DKPathPoint b = DKCubicPointAt(c, i / 256.0);
+				double dx = b.x - a.x, dy = b.y - a.y, lengthSquared = dx * dx + dy * dy;
+				double t = lengthSquared > 0 ? fmax(0, fmin(1, ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSquared)) : 0;
+
+				best = fmin(best, hypot(a.x + t * dx - p.x, a.y + t * dy - p.y));
+				a = b;
+			}
+		}
+
+		if (DKPathVerbPointCount(path->verbs[v]) > 0)
+			current = points[DKPathVerbPointCount(path->verbs[v]) - 1];
+
+		points += DKPathVerbPointCount(path->verbs[v]);
+	}
+
+	return best;
+}
+
+#pragma mark -
+
+- (void)testSquareInset
+{
+	// positive offsets are to the left, so inside a square drawn anticlockwise in y-up terms
+
+	XCTAssertEqualWithAccuracy([self areaOfOffset:25 ofSquareOfSide:100 clockwise:NO isEmpty:NULL], 2500, 0.01);
+	XCTAssertEqualWithAccuracy([self areaOfOffset:49 ofSquareOfSide:100 clockwise:NO isEmpty:NULL], 4, 0.01);
+}
+
+- (void)testSquareInsetToNothing
+{
+	// insetting by half the side or more must leave nothing, not a sliver or a loop running the wrong way
+
+	double offsets[] = { 49.9, 50, 50.1, 60 };
+	size_t k;
+
+	for (k = 0; k < sizeof(offsets) / sizeof(offsets[0]); ++k) {
+		BOOL isEmpty = NO;
+		double area = [self areaOfOffset:offsets[k] ofSquareOfSide:100 clockwise:NO isEmpty:&isEmpty];
+
+		if (offsets[k] < 50)
+			XCTAssertEqualWithAccuracy(area, 0, 0.05, @"inset by %g", offsets[k]);
+		else
+			XCTAssertTrue(isEmpty, @"inset by %g left area %g", offsets[k], area);
+
+		XCTAssertGreaterThanOrEqual(area, -0.001, @"inset by %g ran the wrong way", offsets[k]);
+	}
+}
+
+- (void)testSquareOutset
+{
+	// miter joins keep the corners square
+
+	XCTAssertEqualWithAccuracy([self areaOfOffset:-50 ofSquareOfSide:100 clockwise:NO isEmpty:NULL], 40000, 0.01);
+}
+
+- (void)testClockwiseSquareInset
+{
+	XCTAssertEqualWithAccuracy([self areaOfOffset:-25 ofSquareOfSide:100 clockwise:YES isEmpty:NULL], -2500, 0.01);
+	XCTAssertEqualWithAccuracy([self areaOfOffset:25 ofSquareOfSide:100 clockwise:YES isEmpty:NULL], -22500, 0.01);
+
+	BOOL isEmpty = NO;
+	[self areaOfOffset:-50 ofSquareOfSide:100 clockwise:YES isEmpty:&isEmpty];
+	XCTAssertTrue(isEmpty);
+}
+
+- (void)testRandomBlobOffsetsKeepTheirDistance
+{
+	// a loop left in the offset comes nearer the shape than the offset distance, so every point of the offset, and the middle of every
+	// curve, must be at least that far away, give or take a few times the tolerance
+
+	DKPathOffsetOptions options = DKPathOffsetDefaultOptions();
+	int shape, side;
+
+	options.join = kDKPathJoinRound;
+	srandom(1);
+
+	for (shape = 0; shape < 300; ++shape) {
+		DKPathBuffer blob;
+		double distance = 40.0 * random() / (double)INT32_MAX;
+
+		DKPathBufferInit(&blob);
+		[self appendRandomBlobWithCorners:4 + (int)(random() % 8)
+								   toPath:&blob];
+
+		for (side = -1; side <= 1; side += 2) {
+			DKPathBuffer result;
+			const DKPathPoint* points;
+			DKPathPoint current = { 0, 0 };
+			double nearest = INFINITY;
+			size_t v;
+
+			DKPathBufferInit(&result);
+			XCTAssertTrue(DKPathOffset(&blob, side * distance, &options, &result));
+			points = result.points;
+
+			for (v = 0; v < result.verbCount; ++v) {
+				size_t count = DKPathVerbPointCount(result.verbs[v]);
+
+				if (result.verbs[v] == kDKPathCurveTo) {
+					DKPathPoint c[4] = { current, points[0], points[1], points[2] };
+					nearest = fmin(nearest, [self distanceFromPoint:DKCubicPointAt(c, 0.5) toPath:&blob]);
+				}
+
+				if (count > 0) {
+					current = points[count - 1];
+					nearest = fmin(nearest, [self distanceFromPoint:current toPath:&blob]);
+				}
+
+				points += count;
+			}
+
+			XCTAssertGreaterThanOrEqual(nearest, distance - 5 * options.tolerance, @"shape %d offset by %g", shape, side * distance);
+			DKPathBufferFree(&result);
+		}
+
+		DKPathBufferFree(&blob);
+	}
+}
+
+@end
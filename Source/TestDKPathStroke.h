@@ -0,0 +1,28 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKPathStroke.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the native stroker.
+
+ These check stroke outlines point by point: corners and ends against their known shapes, and round-jointed strokes of curves against
+ the reference set of points within half the stroke width of the path. They need no graphics context.
+*/
+@interface TestDKPathStroke : XCTestCase
+
+- (void)testJoins;
+- (void)testCaps;
+- (void)testDashes;
+- (void)testMeasuredDashes;
+- (void)testStrokeDashDashedPath;
+- (void)testRoundStrokeMatchesReference;
+- (void)testStrokeWiderThanClosedPath;
+- (void)testClosedSelfIntersectingPath;
+- (void)testBezierPathStrokeSettings;
+- (void)testDrawablePathHitTesting;
+
+@end
@@ -0,0 +1,582 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKPathStroke.h"
+#import <DKDrawKit/DKDrawablePath.h>
+#import <DKDrawKit/DKPathMeasure.h>
+#import <DKDrawKit/DKStroke.h>
+#import <DKDrawKit/DKStrokeDash.h>
+#import <DKDrawKit/DKStyle.h>
+#import <DKDrawKit/NSBezierPath+Geometry.h>
+
+// points closer than this to the edge of the reference are not tested, since the outline may stray from it by the tolerance
+
+#define EDGE_MARGIN 0.15
+#define SAMPLE_COUNT 5000
+
+@interface TestDKPathStroke ()
+
+- (DKPathStrokeStyle)styleWithWidth:(double)width cap:(DKPathCap)cap join:(DKPathJoin)join;
+- (BOOL)stroke:(const DKPathBuffer*)path style:(const DKPathStrokeStyle*)style containsX:(double)x y:(double)y;
+- (double)distanceFromPath:(const DKPathBuffer*)path x:(double)x y:(double)y;
+- (void)checkRoundStrokeOfPath:(const DKPathBuffer*)path width:(double)width bounds:(NSRect)bounds name:(NSString*)name;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKPathStroke
+
+- (DKPathStrokeStyle)styleWithWidth:(double)width cap:(DKPathCap)cap join:(DKPathJoin)join
+{
+	DKPathStrokeStyle style = DKPathStrokeDefaultStyle();
+
+	style.width = width;
+	style.cap = cap;
+	style.join = join;
+	return style;
+}
+
+- (BOOL)stroke:(const DKPathBuffer*)path style:(const DKPathStrokeStyle*)style containsX:(double)x y:(double)y
+{
+	// the quick test and the whole outline must agree
+
+	DKPathPoint p = { x, y };
+	DKPathBuffer outline;
+
+	DKPathBufferInit(&outline);
+	XCTAssertTrue(DKPathStroke(path, style, &outline));
+
+	BOOL inOutline = DKPathBufferWindingNumber(&outline, p, 0.01) != 0;
+	BOOL contains = DKPathStrokeContainsPoint(path, style, p);
+
+	DKPathBufferFree(&outline);
+
+	XCTAssertEqual(inOutline, contains, @"hit test and outline disagree at %g, %g", x, y);
+	return contains;
+}
+
+- (double)distanceFromPath:(const DKPathBuffer*)path x:(double)x y:(double)y
+{
+	// the distance to the path flattened very finely
+
+	DKPathPoint start = { 0, 0 }, current = { 0, 0 };
+	const DKPathPoint* pp = path->points;
+	double best = INFINITY;
+	size_t v;
+
+	for (v = 0; v < path->verbCount; ++v) {
+		DKPathPoint points[257];
+		NSUInteger i, count = 0;
+
+		switch (path->verbs[v]) {
+		case kDKPathMoveTo:
+			start = current = pp[0];
+			points[count++] = current;
+			break;
+
+		case kDKPathLineTo:
+			points[count++] = current;
+			points[count++] = current = pp[0];
+			break;
+
+		case kDKPathCurveTo: {
+			DKPathPoint c[4] = { current, pp[0], pp[1], pp[2] };
+
+			for (i = 0; i <= 256; ++i)
+				points[count++] = DKCubicPointAt(c, i / 256.0);
+			current = pp[2];
+			break;
+		}
+
+		case kDKPathClose:
+			points[count++] = current;
+			points[count++] = current = start;
+			break;
+		}
+
+		best = MIN(best, hypot(points[0].x - x, points[0].y - y));
+
+		for (i = 1; i < count; ++i) {
+			double dx = points[i].x - points[i - 1].x, dy = points[i].y - points[i - 1].y;
+			double ll = dx * dx + dy * dy;
+			double t = ll > 0.0 ? ((x - points[i - 1].x) * dx + (y - points[i - 1].y) * dy) / ll : 0.0;
+
+			t = MAX(0.0, MIN(1.0, t));
+			best = MIN(best, hypot(points[i - 1].x + t * dx - x, points[i - 1].y + t * dy - y));
+		}
+
+		pp += DKPathVerbPointCount(path->verbs[v]);
+	}
+
+	return best;
+}
+
+- (void)checkRoundStrokeOfPath:(const DKPathBuffer*)path width:(double)width bounds:(NSRect)bounds name:(NSString*)name
+{
+	// with round caps and joins, the stroke is exactly the set of points within half its width of the path
+
+	DKPathStrokeStyle style = [self styleWithWidth:width
+											   cap:kDKPathCapRound
+											  join:kDKPathJoinRound];
+	DKPathBuffer outline;
+	NSUInteger i, wrong = 0;
+
+	style.tolerance = 0.05;
+	srandom(1);
+
+	DKPathBufferInit(&outline);
+	XCTAssertTrue(DKPathStroke(path, &style, &outline));
+
+	for (i = 0; i < SAMPLE_COUNT; ++i) {
+		double x = NSMinX(bounds) + NSWidth(bounds) * random() / (double)INT32_MAX;
+		double y = NSMinY(bounds) + NSHeight(bounds) * random() / (double)INT32_MAX;
+		double distance = [self distanceFromPath:path
+											   x:x
+											   y:y];
+
+		if (fabs(distance - width * 0.5) < EDGE_MARGIN)
+			continue;
+
+		if ((distance < width * 0.5) != (DKPathBufferWindingNumber(&outline, (DKPathPoint){ x, y }, 0.01) != 0))
+			++wrong;
+	}
+
+	DKPathBufferFree(&outline);
+	XCTAssertEqual(wrong, (NSUInteger)0, @"%@: %lu points misplaced", name, (unsigned long)wrong);
+}
+
+#pragma mark -
+
+- (void)testJoins
+{
+	DKPathBuffer square;
+	DKPathStrokeStyle style;
+
+	DKPathBufferInit(&square);
+	DKPathBufferMoveTo(&square, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 100, 0 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 100, 100 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 0, 100 });
+	DKPathBufferClose(&square);
+
+	style = [self styleWithWidth:10
+							 cap:kDKPathCapButt
+							join:kDKPathJoinMiter];
+
+	XCTAssertTrue([self stroke:&square style:&style containsX:50 y:2]);
+	XCTAssertTrue([self stroke:&square style:&style containsX:50 y:-4]);
+	XCTAssertFalse([self stroke:&square style:&style containsX:50 y:-6]);
+	XCTAssertFalse([self stroke:&square style:&style containsX:50 y:50], @"the middle of a closed stroke is empty");
+	XCTAssertTrue([self stroke:&square style:&style containsX:-4 y:-4]);
+	XCTAssertTrue([self stroke:&square style:&style containsX:104 y:104]);
+
+	style.join = kDKPathJoinBevel;
+	XCTAssertTrue([self stroke:&square style:&style containsX:-2 y:-2]);
+	XCTAssertFalse([self stroke:&square style:&style containsX:-4 y:-4]);
+
+	style.join = kDKPathJoinRound;
+	XCTAssertTrue([self stroke:&square style:&style containsX:-3 y:-3]);
+	XCTAssertFalse([self stroke:&square style:&style containsX:-4 y:-4]);
+
+	// a miter limit below the miter's length gives a bevel
+
+	style.join = kDKPathJoinMiter;
+	style.miterLimit = 1.2;
+	XCTAssertFalse([self stroke:&square style:&style containsX:-4 y:-4]);
+
+	DKPathBufferFree(&square);
+}
+
+- (void)testCaps
+{
+	DKPathBuffer line;
+	DKPathStrokeStyle style;
+
+	DKPathBufferInit(&line);
+	DKPathBufferMoveTo(&line, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&line, (DKPathPoint){ 100, 0 });
+
+	style = [self styleWithWidth:10
+							 cap:kDKPathCapButt
+							join:kDKPathJoinMiter];
+	XCTAssertTrue([self stroke:&line style:&style containsX:1 y:4]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:-1 y:0]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:101 y:0]);
+
+	style.cap = kDKPathCapSquare;
+	XCTAssertTrue([self stroke:&line style:&style containsX:-4 y:4]);
+	XCTAssertTrue([self stroke:&line style:&style containsX:104 y:-4]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:-6 y:0]);
+
+	style.cap = kDKPathCapRound;
+	XCTAssertTrue([self stroke:&line style:&style containsX:-4 y:0]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:-4 y:4]);
+
+	DKPathBufferFree(&line);
+}
+
+- (void)testDashes
+{
+	DKPathBuffer line, dashed;
+	DKPathStrokeStyle style;
+	double pattern[2] = { 10, 10 };
+	size_t i, dashCount = 0;
+
+	DKPathBufferInit(&line);
+	DKPathBufferInit(&dashed);
+	DKPathBufferMoveTo(&line, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&line, (DKPathPoint){ 100, 0 });
+
+	XCTAssertTrue(DKPathDash(&line, pattern, 2, 0, 0.1, &dashed));
+
+	for (i = 0; i < dashed.verbCount; ++i)
+		dashCount += dashed.verbs[i] == kDKPathMoveTo;
+
+	XCTAssertEqual(dashCount, (size_t)5);
+	XCTAssertEqualWithAccuracy(dashed.points[2].x, 20.0, 1e-9);
+	XCTAssertEqualWithAccuracy(dashed.points[3].x, 30.0, 1e-9);
+
+	style = [self styleWithWidth:4
+							 cap:kDKPathCapButt
+							join:kDKPathJoinMiter];
+	style.dash = pattern;
+	style.dashCount = 2;
+
+	XCTAssertTrue([self stroke:&line style:&style containsX:5 y:0]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:15 y:0]);
+	XCTAssertTrue([self stroke:&line style:&style containsX:85 y:0]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:95 y:0]);
+
+	style.dashPhase = 5;
+	XCTAssertTrue([self stroke:&line style:&style containsX:2 y:0]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:7 y:0]);
+	XCTAssertTrue([self stroke:&line style:&style containsX:17 y:0]);
+
+	// dashes of no length are dots when the caps are round
+
+	double dots[2] = { 0, 10 };
+
+	style.dash = dots;
+	style.dashPhase = 0;
+	style.cap = kDKPathCapRound;
+	XCTAssertTrue([self stroke:&line style:&style containsX:10 y:1.5]);
+	XCTAssertFalse([self stroke:&line style:&style containsX:5 y:0]);
+
+	DKPathBufferFree(&line);
+	DKPathBufferFree(&dashed);
+}
+
+- (void)testMeasuredDashes
+{
+	DKPathBuffer square, dashed, piece;
+	DKPathMeasure measure;
+	double pattern[2] = { 10, 10 };
+	size_t i, dashCount;
+
+	DKPathBufferInit(&square);
+	DKPathBufferInit(&dashed);
+	DKPathBufferInit(&piece);
+	DKPathMeasureInit(&measure);
+
+	DKPathBufferMoveTo(&square, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 100, 0 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 100, 100 });
+	DKPathBufferLineTo(&square, (DKPathPoint){ 0, 100 });
+	DKPathBufferClose(&square);
+
+	XCTAssertTrue(DKPathMeasureSetPath(&measure, &square, 0.1));
+	XCTAssertEqual(measure.subpathCount, (size_t)1);
+	XCTAssertEqualWithAccuracy(measure.length, 400.0, 1e-9);
+
+	// the piece between two distances runs round the corner
+
+	XCTAssertTrue(DKPathMeasureAppendPiece(&measure, 0, 50, 150, &piece));
+	XCTAssertEqual(piece.verbCount, (size_t)3);
+	XCTAssertEqualWithAccuracy(piece.points[0].x, 50.0, 1e-9);
+	XCTAssertEqualWithAccuracy(piece.points[2].y, 50.0, 1e-9);
+
+	// the same measure dashes at any phase, and gives the same dashes as measuring afresh
+
+	for (i = 0; i < 4; ++i) {
+		double phase = i * 2.5;
+		DKPathBuffer fresh;
+
+		DKPathBufferInit(&fresh);
+		DKPathBufferClear(&dashed);
+
+		XCTAssertTrue(DKPathMeasureDash(&measure, pattern, 2, phase, &dashed));
+		XCTAssertTrue(DKPathDash(&square, pattern, 2, phase, 0.1, &fresh));
+		XCTAssertEqual(dashed.verbCount, fresh.verbCount);
+		XCTAssertEqual(memcmp(dashed.points, fresh.points, dashed.pointCount * sizeof(DKPathPoint)), 0);
+
+		XCTAssertEqualWithAccuracy(dashed.points[0].x, 0.0, 1e-9);
+		XCTAssertEqualWithAccuracy(dashed.points[1].x, 10.0 - phase, 1e-9);
+
+		DKPathBufferFree(&fresh);
+	}
+
+	// only the dashes near a point are found, but they fall where they would in the whole path
+
+	DKPathBufferClear(&dashed);
+	XCTAssertTrue(DKPathMeasureDashNear(&measure, pattern, 2, 0, (DKPathPoint){ 100, 45 }, 5, &dashed));
+
+	for (i = 0, dashCount = 0; i < dashed.verbCount; ++i)
+		dashCount += dashed.verbs[i] == kDKPathMoveTo;
+
+	XCTAssertEqual(dashCount, (size_t)5);
+	XCTAssertEqualWithAccuracy(dashed.points[0].x, 100.0, 1e-9);
+	XCTAssertEqualWithAccuracy(dashed.points[0].y, 0.0, 1e-9);
+
+	DKPathMeasureFree(&measure);
+	DKPathBufferFree(&square);
+	DKPathBufferFree(&dashed);
+	DKPathBufferFree(&piece);
+}
+
+- (void)testStrokeDashDashedPath
+{
+	NSBezierPath* path = [NSBezierPath bezierPath];
+	CGFloat pattern[2] = { 2, 2 };
+	DKStrokeDash* dash = [DKStrokeDash dashWithPattern:pattern
+												 count:2];
+
+	[path moveToPoint:NSMakePoint(0, 0)];
+	[path lineToPoint:NSMakePoint(100, 0)];
+	[path setLineWidth:5];
+
+	[DKStrokeDash flushDashCache];
+
+	// the pattern is scaled by the line width, so each dash is 10 long
+
+	NSBezierPath* dashed = [dash dashedPathForPath:path
+										 withPhase:0];
+	NSPoint points[3];
+
+	XCTAssertEqual([dashed elementCount], (NSInteger)10);
+	XCTAssertEqual([dashed lineWidth], 5.0);
+	[dashed elementAtIndex:1
+		  associatedPoints:points];
+	XCTAssertEqualWithAccuracy(points[0].x, 10.0, 1e-9);
+
+	// the phase moves the dashes along the path as -applyToPath:withPhase: does, and repeats after the pattern's length
+
+	dashed = [dash dashedPathForPath:path
+						   withPhase:1];
+	[dashed elementAtIndex:0
+		  associatedPoints:points];
+	XCTAssertEqualWithAccuracy(points[0].x, 5.0, 1e-9);
+	[dashed elementAtIndex:1
+		  associatedPoints:points];
+	XCTAssertEqualWithAccuracy(points[0].x, 15.0, 1e-9);
+
+	NSBezierPath* repeated = [dash dashedPathForPath:path
+										   withPhase:5];
+
+	XCTAssertEqualObjects([repeated description], [dashed description]);
+
+	XCTAssertTrue([dashed strokedPathContainsPoint:NSMakePoint(10, 2)]);
+	XCTAssertFalse([dashed strokedPathContainsPoint:NSMakePoint(20, 0)]);
+
+	// cached dashes are only reused for the very path they were made from, which is checked point by point on every hit
+
+	DKPathBuffer a, b;
+
+	DKPathBufferInit(&a);
+	DKPathBufferInit(&b);
+	DKPathBufferMoveTo(&a, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&a, (DKPathPoint){ 100, 0 });
+	DKPathBufferMoveTo(&b, (DKPathPoint){ -0.0, 0 });
+	DKPathBufferLineTo(&b, (DKPathPoint){ 100, 0 });
+	XCTAssertTrue(DKPathBufferIsEqual(&a, &b));
+
+	b.points[1].y = 1e-12;
+	XCTAssertFalse(DKPathBufferIsEqual(&a, &b));
+
+	DKPathBufferFree(&a);
+	DKPathBufferFree(&b);
+
+	NSBezierPath* shorter = [NSBezierPath bezierPath];
+
+	[shorter moveToPoint:NSMakePoint(0, 0)];
+	[shorter lineToPoint:NSMakePoint(50, 0)];
+	[shorter setLineWidth:5];
+	XCTAssertEqual([[dash dashedPathForPath:shorter
+								  withPhase:0] elementCount],
+		(NSInteger)6);
+}
+
+- (void)testRoundStrokeMatchesReference
+{
+	DKPathBuffer wave, zigzag;
+	NSInteger i;
+
+	DKPathBufferInit(&wave);
+	DKPathBufferMoveTo(&wave, (DKPathPoint){ 0, 0 });
+
+	for (i = 0; i < 8; ++i) {
+		double x = i * 50, y = (i & 1) ? -60 : 60;
+		DKPathBufferCurveTo(&wave, (DKPathPoint){ x + 15, y }, (DKPathPoint){ x + 35, y }, (DKPathPoint){ x + 50, 0 });
+	}
+
+	[self checkRoundStrokeOfPath:&wave
+						   width:8
+						  bounds:NSMakeRect(-20, -80, 440, 160)
+							name:@"thin wave"];
+
+	// wider than the curves' radius, so the inner sides of the peaks turn inside out
+
+	[self checkRoundStrokeOfPath:&wave
+						   width:40
+						  bounds:NSMakeRect(-30, -90, 460, 180)
+							name:@"wide wave"];
+
+	DKPathBufferInit(&zigzag);
+	DKPathBufferMoveTo(&zigzag, (DKPathPoint){ 0, 0 });
+
+	for (i = 1; i < 12; ++i)
+		DKPathBufferLineTo(&zigzag, (DKPathPoint){ i * 10, (i & 1) ? 50 : 0 });
+
+	[self checkRoundStrokeOfPath:&zigzag
+						   width:12
+						  bounds:NSMakeRect(-10, -10, 140, 70)
+							name:@"zigzag"];
+
+	DKPathBufferFree(&wave);
+	DKPathBufferFree(&zigzag);
+}
+
+- (void)testStrokeWiderThanClosedPath
+{
+	// a circle of radius 50 stroked 120 wide has no hole left in the middle
+
+	DKPathBuffer circle;
+	double k = 0.5522847498 * 50;
+
+	DKPathBufferInit(&circle);
+	DKPathBufferMoveTo(&circle, (DKPathPoint){ 50, 0 });
+	DKPathBufferCurveTo(&circle, (DKPathPoint){ 50, k }, (DKPathPoint){ k, 50 }, (DKPathPoint){ 0, 50 });
+	DKPathBufferCurveTo(&circle, (DKPathPoint){ -k, 50 }, (DKPathPoint){ -50, k }, (DKPathPoint){ -50, 0 });
+	DKPathBufferCurveTo(&circle, (DKPathPoint){ -50, -k }, (DKPathPoint){ -k, -50 }, (DKPathPoint){ 0, -50 });
+	DKPathBufferCurveTo(&circle, (DKPathPoint){ k, -50 }, (DKPathPoint){ 50, -k }, (DKPathPoint){ 50, 0 });
+	DKPathBufferClose(&circle);
+
+	[self checkRoundStrokeOfPath:&circle
+						   width:10
+						  bounds:NSMakeRect(-60, -60, 120, 120)
+							name:@"circle"];
+	[self checkRoundStrokeOfPath:&circle
+						   width:120
+						  bounds:NSMakeRect(-120, -120, 240, 240)
+							name:@"wide circle"];
+
+	DKPathBufferFree(&circle);
+}
+
+- (void)testClosedSelfIntersectingPath
+{
+	// the inside of a closed path that crosses itself is not a hole, so both sides must reach right into the corners
+
+	DKPathBuffer quad;
+	DKPathJoin join;
+
+	DKPathBufferInit(&quad);
+	DKPathBufferMoveTo(&quad, (DKPathPoint){ 43.52, 96.79 });
+	DKPathBufferLineTo(&quad, (DKPathPoint){ 57.95, 9.13 });
+	DKPathBufferLineTo(&quad, (DKPathPoint){ 38.18, 67.84 });
+	DKPathBufferLineTo(&quad, (DKPathPoint){ 92.64, 84.45 });
+	DKPathBufferClose(&quad);
+
+	for (join = kDKPathJoinMiter; join <= kDKPathJoinBevel; ++join) {
+		DKPathStrokeStyle style = [self styleWithWidth:4.33 cap:kDKPathCapButt join:join];
+
+		XCTAssertTrue([self stroke:&quad style:&style containsX:40.10 y:70.22], @"join %d", (int)join);
+		XCTAssertTrue([self stroke:&quad style:&style containsX:53.57 y:16.73], @"join %d", (int)join);
+		XCTAssertFalse([self stroke:&quad style:&style containsX:55 y:70], @"join %d", (int)join);
+	}
+
+	[self checkRoundStrokeOfPath:&quad
+						   width:4.33
+						  bounds:NSMakeRect(30, 0, 70, 105)
+							name:@"self-intersecting quad"];
+	[self checkRoundStrokeOfPath:&quad
+						   width:30
+						  bounds:NSMakeRect(15, -20, 100, 140)
+							name:@"wide self-intersecting quad"];
+
+	DKPathBufferFree(&quad);
+}
+
+- (void)testBezierPathStrokeSettings
+{
+	NSBezierPath* path = [NSBezierPath bezierPath];
+	CGFloat pattern[2] = { 10, 10 };
+
+	[path moveToPoint:NSMakePoint(0, 0)];
+	[path lineToPoint:NSMakePoint(100, 0)];
+	[path setLineWidth:10];
+	[path setLineCapStyle:NSSquareLineCapStyle];
+
+	NSBezierPath* outline = [path strokedPath];
+
+	XCTAssertEqual([outline windingRule], NSNonZeroWindingRule);
+	XCTAssertTrue([outline containsPoint:NSMakePoint(-4, 4)]);
+	XCTAssertFalse([outline containsPoint:NSMakePoint(50, 6)]);
+	XCTAssertTrue([path strokedPathContainsPoint:NSMakePoint(104, 0)]);
+
+	[path setLineDash:pattern
+				count:2
+				phase:0];
+	XCTAssertFalse([path strokedPathContainsPoint:NSMakePoint(15, 0)]);
+	XCTAssertFalse([[path strokedPath] containsPoint:NSMakePoint(15, 0)]);
+
+	XCTAssertTrue([[path strokedPathWithStrokeWidth:20] containsPoint:NSMakePoint(5, 9)]);
+	XCTAssertEqual([path lineWidth], 10.0, @"the path's own width is put back");
+}
+
+- (void)testDrawablePathHitTesting
+{
+	// hit testing takes each stroke as centre-aligned and at least 4pt wide, as the hit-testing bitmap did, so thin and offset paths can be
+	// clicked on the line itself
+
+	NSBezierPath* path = [NSBezierPath bezierPath];
+
+	[path moveToPoint:NSMakePoint(0, 0)];
+	[path lineToPoint:NSMakePoint(100, 0)];
+	[path lineToPoint:NSMakePoint(100, 100)];
+
+	DKDrawablePath* thin = [DKDrawablePath drawablePathWithBezierPath:path
+															withStyle:[DKStyle styleWithFillColour:nil
+																					  strokeColour:[NSColor blackColor]
+																					   strokeWidth:0.5]];
+
+	XCTAssertTrue([thin pointHitsPath:NSMakePoint(50, 1.5)], @"a 0.5pt path is hit within 2pt of the line");
+	XCTAssertFalse([thin pointHitsPath:NSMakePoint(50, 3)]);
+
+	DKStyle* offsetStyle = [[[DKStyle alloc] init] autorelease];
+	DKStroke* offsetStroke = [[DKStroke alloc] initWithWidth:2
+													  colour:[NSColor blackColor]];
+
+	[offsetStroke setLateralOffset:10];
+	[offsetStyle addRenderer:offsetStroke];
+	[offsetStroke release];
+
+	DKDrawablePath* offset = [DKDrawablePath drawablePathWithBezierPath:path
+															  withStyle:offsetStyle];
+
+	XCTAssertTrue([offset pointHitsPath:NSMakePoint(50, 1)], @"an offset stroke is hit on the path itself");
+	XCTAssertFalse([offset pointHitsPath:NSMakePoint(50, -10)]);
+
+	DKDrawablePath* clear = [DKDrawablePath drawablePathWithBezierPath:path
+															 withStyle:[DKStyle styleWithFillColour:[NSColor clearColor]
+																					   strokeColour:[NSColor clearColor]
+																						strokeWidth:10]];
+
+	XCTAssertFalse([clear pointHitsPath:NSMakePoint(50, 1)], @"a transparent stroke isn't hit");
+	XCTAssertFalse([clear pointHitsPath:NSMakePoint(90, 10)], @"a transparent fill isn't hit");
+}
+
+@end
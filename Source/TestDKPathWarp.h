@@ -0,0 +1,23 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKPathWarp.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the envelope warp.
+
+ These check warped points against bilinear interpolation of the envelope worked out directly, and warped paths against the true warp of
+ points sampled along them.
+*/
+@interface TestDKPathWarp : XCTestCase
+
+- (void)testCornersAndCentre;
+- (void)testWarpPointsMatchesWarpPoint;
+- (void)testAffineEnvelopeKeepsLines;
+- (void)testWarpedPathWithinTolerance;
+- (void)testDistortionTransform;
+
+@end
@@ -0,0 +1,293 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKPathWarp.h"
+#import <DKDrawKit/DKDistortionTransform.h>
+
+@interface TestDKPathWarp ()
+
+- (DKPathPoint)bilinearPoint:(DKPathPoint)p inRect:(NSRect)rect envelope:(const DKPathPoint[4])envelope;
+- (double)distanceFromPath:(const DKPathBuffer*)path x:(double)x y:(double)y;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKPathWarp
+
+static const DKPathPoint sKeystone[4] = { { 0, 0 }, { 300, 40 }, { 260, 250 }, { -20, 200 } };
+
+- (DKPathPoint)bilinearPoint:(DKPathPoint)p inRect:(NSRect)rect envelope:(const DKPathPoint[4])envelope
+{
+	double u = (p.x - NSMinX(rect)) / NSWidth(rect);
+	double v = (p.y - NSMinY(rect)) / NSHeight(rect);
+	DKPathPoint r;
+
+	r.x = (1 - u) * (1 - v) * envelope[0].x + u * (1 - v) * envelope[1].x + u * v * envelope[2].x + (1 - u) * v * envelope[3].x;
+	r.y = (1 - u) * (1 - v) * envelope[0].y + u * (1 - v) * envelope[1].y + u * v * envelope[2].y + (1 - u) * v * envelope[3].y;
+	return r;
+}
+
+- (double)distanceFromPath:(const DKPathBuffer*)path x:(double)x y:(double)y
+{
+	// the distance to the path flattened very finely, measured to the flattened lines rather than their ends
+
+	DKPathPoint start = { 0, 0 }, current = { 0, 0 };
+	const DKPathPoint* pp = path->points;
+	double best = INFINITY;
+	size_t v;
+	NSUInteger i;
+
+	for (v = 0; v < path->verbCount; ++v) {
+		DKPathPoint c[4];
+
+		switch (path->verbs[v]) {
+		case kDKPathMoveTo:
+			start = current = pp[0];
+			++pp;
+			continue;
+
+		case kDKPathLineTo:
+			c[0] = current;
+			c[1] = current;
+			c[2] = pp[0];
+			c[3] = current = pp[0];
+			break;
+
+		case kDKPathCurveTo:
+			c[0] = current;
+			c[1] = pp[0];
+			c[2] = pp[1];
+			c[3] = current = pp[2];
+			break;
+
+		default:
+			c[0] = current;
+			c[1] = current;
+			c[2] = start;
+			c[3] = current = start;
+			break;
+		}
+
+		DKPathPoint a = c[0];
+
+		for (i = 1; i <= 256; ++i) {
+			DKPathPoint b = DKCubicPointAt(c, i / 256.0);
+			double dx = b.x - a.x, dy = b.y - a.y;
+			double lengthSquared = dx * dx + dy * dy;
+			double t = lengthSquared > 0 ? ((x - a.x) * dx + (y - a.y) * dy) / lengthSquared : 0;
+
+			t = MAX(0, MIN(t, 1));
+			best = MIN(best, hypot(a.x + dx * t - x, a.y + dy * t - y));
+			a = b;
+		}
+
+		pp += DKPathVerbPointCount(path->verbs[v]);
+	}
+
+	return best;
+}
+
+- (void)testCornersAndCentre
+{
+	NSRect rect = NSMakeRect(10, 20, 100, 50);
+	DKPathPoint corners[4] = { { 10, 20 }, { 110, 20 }, { 110, 70 }, { 10, 70 } };
+	DKPathWarp warp;
+	NSUInteger i;
+
+	DKPathWarpInit(&warp, (DKPathPoint){ NSMinX(rect), NSMinY(rect) }, NSWidth(rect), NSHeight(rect), sKeystone);
+
+	for (i = 0; i < 4; ++i) {
+		DKPathPoint p = DKPathWarpPoint(&warp, corners[i]);
+
+		XCTAssertEqualWithAccuracy(p.x, sKeystone[i].x, 1e-9, @"corner %lu", (unsigned long)i);
+		XCTAssertEqualWithAccuracy(p.y, sKeystone[i].y, 1e-9, @"corner %lu", (unsigned long)i);
+	}
+
+	DKPathPoint centre = DKPathWarpPoint(&warp, (DKPathPoint){ 60, 45 });
+
+	XCTAssertEqualWithAccuracy(centre.x, (0 + 300 + 260 - 20) / 4.0, 1e-9);
+	XCTAssertEqualWithAccuracy(centre.y, (0 + 40 + 250 + 200) / 4.0, 1e-9);
+
+	// an empty rect puts every point halfway across it
+
+	DKPathWarpInit(&warp, (DKPathPoint){ 10, 20 }, 0, 50, sKeystone);
+	DKPathPoint p = DKPathWarpPoint(&warp, (DKPathPoint){ 1000, 20 });
+
+	XCTAssertEqualWithAccuracy(p.x, 150, 1e-9);
+	XCTAssertEqualWithAccuracy(p.y, 20, 1e-9);
+}
+
+- (void)testWarpPointsMatchesWarpPoint
+{
+	// batches must agree with single points, including when warping in place
+
+	NSRect rect = NSMakeRect(-0.5, -0.5, 1, 1);
+	DKPathPoint points[101], warped[101];
+	DKPathWarp warp;
+	NSUInteger i;
+
+	DKPathWarpInit(&warp, (DKPathPoint){ NSMinX(rect), NSMinY(rect) }, NSWidth(rect), NSHeight(rect), sKeystone);
+
+	for (i = 0; i < 101; ++i)
+		points[i] = (DKPathPoint){ (i % 13) / 12.0 - 0.5, (i % 7) / 6.0 - 0.5 };
+
+	DKPathWarpPoints(&warp, points, 101, warped);
+
+	for (i = 0; i < 101; ++i) {
+		DKPathPoint expected = [self bilinearPoint:points[i] inRect:rect envelope:sKeystone];
+
+		XCTAssertEqualWithAccuracy(warped[i].x, expected.x, 1e-9, @"point %lu", (unsigned long)i);
+		XCTAssertEqualWithAccuracy(warped[i].y, expected.y, 1e-9, @"point %lu", (unsigned long)i);
+	}
+
+	DKPathWarpPoints(&warp, points, 101, points);
+	XCTAssertEqual(memcmp(points, warped, sizeof(points)), 0);
+}
+
+- (void)testAffineEnvelopeKeepsLines
+{
+	// a parallelogram is an affine warp, under which a rectangle stays four lines and a curve stays one curve
+
+	DKPathPoint parallelogram[4] = { { 0, 0 }, { 200, 30 }, { 260, 130 }, { 60, 100 } };
+	DKPathBuffer path, result;
+	DKPathWarp warp;
+
+	DKPathWarpInit(&warp, (DKPathPoint){ 0, 0 }, 100, 100, parallelogram);
+	DKPathBufferInit(&path);
+	DKPathBufferInit(&result);
+
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 10, 10 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 90, 10 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 90, 90 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 10, 90 });
+	DKPathBufferClose(&path);
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 20, 50 });
+	DKPathBufferCurveTo(&path, (DKPathPoint){ 20, 80 }, (DKPathPoint){ 80, 80 }, (DKPathPoint){ 80, 50 });
+
+	XCTAssertTrue(DKPathWarpPath(&warp, &path, 0.01, &result));
+	XCTAssertEqual(result.verbCount, path.verbCount);
+	XCTAssertEqual(memcmp(result.verbs, path.verbs, path.verbCount), 0);
+
+	size_t i;
+
+	for (i = 0; i < path.pointCount; ++i) {
+		DKPathPoint expected = [self bilinearPoint:path.points[i] inRect:NSMakeRect(0, 0, 100, 100) envelope:parallelogram];
+
+		XCTAssertEqualWithAccuracy(result.points[i].x, expected.x, 1e-9, @"point %lu", (unsigned long)i);
+		XCTAssertEqualWithAccuracy(result.points[i].y, expected.y, 1e-9, @"point %lu", (unsigned long)i);
+	}
+
+	DKPathBufferFree(&path);
+	DKPathBufferFree(&result);
+}
+
+- (void)testWarpedPathWithinTolerance
+{
+	// a diagonal, a closing edge and a curve under a keystone all bend; the result must follow their true warp and use more elements for
+	// a tighter tolerance
+
+	static const double tolerances[3] = { 1.0, 0.1, 0.01 };
+	NSRect rect = NSMakeRect(10, 20, 100, 50);
+	DKPathBuffer path, result;
+	DKPathWarp warp;
+	size_t previousCount = 0;
+	NSUInteger t, i;
+
+	DKPathWarpInit(&warp, (DKPathPoint){ NSMinX(rect), NSMinY(rect) }, NSWidth(rect), NSHeight(rect), sKeystone);
+	DKPathBufferInit(&path);
+	DKPathBufferInit(&result);
+
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 10, 20 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 110, 70 });
+	DKPathBufferCurveTo(&path, (DKPathPoint){ 80, 80 }, (DKPathPoint){ 20, 30 }, (DKPathPoint){ 60, 25 });
+	DKPathBufferClose(&path);
+
+	for (t = 0; t < 3; ++t) {
+		DKPathBufferClear(&result);
+		XCTAssertTrue(DKPathWarpPath(&warp, &path, tolerances[t], &result));
+		XCTAssertEqual(result.verbs[result.verbCount - 1], kDKPathClose);
+		XCTAssertGreaterThan(result.verbCount, previousCount);
+		previousCount = result.verbCount;
+
+		for (i = 0; i <= 100; ++i) {
+			DKPathPoint lines[2][2] = { { path.points[0], path.points[1] }, { path.points[4], path.points[0] } };
+			DKPathPoint curve[4] = { path.points[1], path.points[2], path.points[3], path.points[4] };
+			double s = i / 100.0;
+			DKPathPoint samples[3];
+			NSUInteger k;
+
+			samples[0] = (DKPathPoint){ lines[0][0].x + (lines[0][1].x - lines[0][0].x) * s, lines[0][0].y + (lines[0][1].y - lines[0][0].y) * s };
+			samples[1] = (DKPathPoint){ lines[1][0].x + (lines[1][1].x - lines[1][0].x) * s, lines[1][0].y + (lines[1][1].y - lines[1][0].y) * s };
+			samples[2] = DKCubicPointAt(curve, s);
+
+			for (k = 0; k < 3; ++k) {
+				DKPathPoint truth = DKPathWarpPoint(&warp, samples[k]);
+
+				XCTAssertLessThanOrEqual([self distanceFromPath:&result x:truth.x y:truth.y], tolerances[t] + 1e-3, @"segment %lu at %g",
+					(unsigned long)k, s);
+			}
+		}
+	}
+
+	DKPathBufferFree(&path);
+	DKPathBufferFree(&result);
+}
+
+- (void)testDistortionTransform
+{
+	NSPoint envelope[4] = { { -0.5, -0.5 }, { 0.7, -0.3 }, { 0.4, 0.6 }, { -0.6, 0.5 } };
+	DKPathPoint quad[4] = { { -0.5, -0.5 }, { 0.7, -0.3 }, { 0.4, 0.6 }, { -0.6, 0.5 } };
+	NSRect unit = NSMakeRect(-0.5, -0.5, 1, 1);
+	DKDistortionTransform* transform = [[[DKDistortionTransform alloc] initWithEnvelope:envelope] autorelease];
+
+	XCTAssertEqualWithAccuracy([transform flatness], 1.0 / 2000.0, 1e-12);
+
+	NSPoint p = [transform transformPoint:NSMakePoint(0.25, -0.1) fromRect:unit];
+	DKPathPoint expected = [self bilinearPoint:(DKPathPoint){ 0.25, -0.1 } inRect:unit envelope:quad];
+
+	XCTAssertEqualWithAccuracy(p.x, expected.x, 1e-9);
+	XCTAssertEqualWithAccuracy(p.y, expected.y, 1e-9);
+
+	// the cached warp must follow changes to the envelope
+
+	[transform offsetByX:1
+					 byY:2];
+	p = [transform transformPoint:NSMakePoint(0.25, -0.1) fromRect:unit];
+	XCTAssertEqualWithAccuracy(p.x, expected.x + 1, 1e-9);
+	XCTAssertEqualWithAccuracy(p.y, expected.y + 2, 1e-9);
+	[transform setEnvelopePoints:envelope];
+
+	// a diagonal from corner to corner bends, and the path keeps its settings
+
+	NSBezierPath* path = [NSBezierPath bezierPath];
+
+	[path moveToPoint:NSMakePoint(-0.5, -0.5)];
+	[path lineToPoint:NSMakePoint(0.5, 0.5)];
+	[path setLineWidth:3];
+
+	NSBezierPath* warped = [transform transformBezierPath:path];
+	NSPoint points[3];
+
+	XCTAssertEqual([warped lineWidth], 3.0);
+	XCTAssertEqual([warped elementCount], 2);
+	XCTAssertEqual([warped elementAtIndex:1 associatedPoints:points], NSCurveToBezierPathElement);
+	XCTAssertEqualWithAccuracy(points[2].x, 0.4, 1e-9);
+	XCTAssertEqualWithAccuracy(points[2].y, 0.6, 1e-9);
+
+	// flatness is archived and copied
+
+	[transform setFlatness:0.01];
+
+	DKDistortionTransform* copy = [[transform copy] autorelease];
+	DKDistortionTransform* decoded = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:transform]];
+
+	XCTAssertEqualWithAccuracy([copy flatness], 0.01, 1e-12);
+	XCTAssertEqualWithAccuracy([decoded flatness], 0.01, 1e-12);
+	XCTAssertTrue([[transform transformBezierPath:[NSBezierPath bezierPath]] isEmpty]);
+}
+
+@end
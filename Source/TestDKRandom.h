@@ -0,0 +1,25 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKRandom.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the counter-based random generator.
+
+ These tests check that random values are a pure function of their seed and counter, so that the same values result however the work is
+ divided between threads. They need no window server.
+*/
+@interface TestDKRandom : XCTestCase
+
+- (void)testValuesAreStateless;
+- (void)testBatchMatchesScalar;
+- (void)testStreamMatchesCounter;
+- (void)testDerivedSeedsAreIndependent;
+- (void)testReproducibleAcrossThreadCounts;
+- (void)testRandomisedPathReproducibleAcrossThreadCounts;
+- (void)testHatchingSeedIsArchivedAndCopied;
+
+@end
@@ -0,0 +1,227 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKRandom.h"
+#import <DKDrawKit/DKHatching.h>
+#import <DKDrawKit/NSBezierPath+Geometry.h>
+
+#define NUMBER_OF_VALUES 100000
+#define NUMBER_OF_PATHS 64
+#define TEST_SEED 0x0123456789ABCDEFULL
+
+static const NSUInteger sThreadCounts[] = { 1, 2, 3, 4, 8, 16 };
+
+@interface TestDKRandom ()
+
+- (BOOL)path:(NSBezierPath*)a isIdenticalToPath:(NSBezierPath*)b;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKRandom
+
+- (BOOL)path:(NSBezierPath*)a isIdenticalToPath:(NSBezierPath*)b
+{
+	NSInteger e, count = [a elementCount];
+
+	if (count != [b elementCount])
+		return NO;
+
+	for (e = 0; e < count; ++e) {
+		NSPoint pa[3], pb[3];
+		NSBezierPathElement ka = [a elementAtIndex:e
+								  associatedPoints:pa];
+		NSBezierPathElement kb = [b elementAtIndex:e
+								  associatedPoints:pb];
+		NSUInteger np = (ka == NSCurveToBezierPathElement) ? 3 : ((ka == NSClosePathBezierPathElement) ? 0 : 1);
+
+		if (ka != kb || (np > 0 && memcmp(pa, pb, sizeof(NSPoint) * np) != 0))
+			return NO;
+	}
+
+	return YES;
+}
+
+- (void)testValuesAreStateless
+{
+	NSUInteger i;
+
+	for (i = 0; i < 1000; ++i) {
+		CGFloat a = DKRandomValue(TEST_SEED, i);
+		CGFloat b = DKRandomValue(TEST_SEED, i);
+
+		XCTAssertEqual(a, b, @"value for counter %lu is not repeatable", (unsigned long)i);
+		XCTAssertTrue(a >= 0.0 && a < 1.0, @"value %f is out of range", a);
+
+		CGFloat s = DKRandomSignedValue(TEST_SEED, i);
+		XCTAssertEqual(s, a - 0.5, @"signed value does not match unsigned value");
+	}
+
+	// the generator doesn't have to be good, but it must not be degenerate
+
+	CGFloat sum = 0;
+
+	for (i = 0; i < NUMBER_OF_VALUES; ++i)
+		sum += DKRandomValue(TEST_SEED, i);
+
+	XCTAssertEqualWithAccuracy(sum / NUMBER_OF_VALUES, 0.5, 0.01, @"mean of values is badly biased");
+}
+
+- (void)testBatchMatchesScalar
+{
+	CGFloat* values = malloc(sizeof(CGFloat) * NUMBER_OF_VALUES);
+	CGFloat* signedValues = malloc(sizeof(CGFloat) * NUMBER_OF_VALUES);
+	NSUInteger i;
+
+	DKRandomFillValues(TEST_SEED, 17, values, NUMBER_OF_VALUES);
+	DKRandomFillSignedValues(TEST_SEED, 17, signedValues, NUMBER_OF_VALUES);
+
+	for (i = 0; i < NUMBER_OF_VALUES; ++i) {
+		XCTAssertEqual(values[i], DKRandomValue(TEST_SEED, 17 + i), @"batch value %lu differs from scalar value", (unsigned long)i);
+		XCTAssertEqual(signedValues[i], DKRandomSignedValue(TEST_SEED, 17 + i), @"batch signed value %lu differs from scalar value", (unsigned long)i);
+	}
+
+	free(values);
+	free(signedValues);
+}
+
+- (void)testStreamMatchesCounter
+{
+	DKRandomStream stream = DKRandomStreamMake(TEST_SEED);
+	NSUInteger i;
+
+	for (i = 0; i < 1000; ++i)
+		XCTAssertEqual(DKRandomStreamNextValue(&stream), DKRandomValue(TEST_SEED, i), @"stream value %lu differs from counter value", (unsigned long)i);
+
+	XCTAssertEqual(stream.counter, (uint64_t)1000, @"stream counter did not advance once per value");
+}
+
+- (void)testDerivedSeedsAreIndependent
+{
+	DKRandomSeed a = DKRandomDeriveSeed(TEST_SEED, 0);
+	DKRandomSeed b = DKRandomDeriveSeed(TEST_SEED, 1);
+
+	XCTAssertNotEqual(a, b, @"derived seeds for different streams are equal");
+	XCTAssertEqual(a, DKRandomDeriveSeed(TEST_SEED, 0), @"derived seed is not repeatable");
+	XCTAssertEqual(DKRandomSeedFromString(@"DKRoughStroke"), DKRandomSeedFromString(@"DKRoughStroke"), @"string seed is not repeatable");
+	XCTAssertNotEqual(DKRandomSeedFromString(@"a"), DKRandomSeedFromString(@"b"), @"string seeds for different strings are equal");
+
+	// sub-streams should not simply be shifted copies of each other
+
+	NSUInteger i, matches = 0;
+
+	for (i = 0; i < 1000; ++i) {
+		if (DKRandomBits(a, i + 1) == DKRandomBits(b, i))
+			++matches;
+	}
+
+	XCTAssertEqual(matches, (NSUInteger)0, @"derived streams overlap");
+}
+
+- (void)testReproducibleAcrossThreadCounts
+{
+	// fill the same range of counters with the work split into chunks executed concurrently, and check the result is bit-identical
+	// to filling it in one go on one thread
+
+	CGFloat* reference = malloc(sizeof(CGFloat) * NUMBER_OF_VALUES);
+	CGFloat* values = malloc(sizeof(CGFloat) * NUMBER_OF_VALUES);
+	NSUInteger t;
+
+	DKRandomFillSignedValues(TEST_SEED, 0, reference, NUMBER_OF_VALUES);
+
+	for (t = 0; t < sizeof(sThreadCounts) / sizeof(sThreadCounts[0]); ++t) {
+		NSUInteger threads = sThreadCounts[t];
+		NSUInteger chunk = (NUMBER_OF_VALUES + threads - 1) / threads;
+
+		memset(values, 0, sizeof(CGFloat) * NUMBER_OF_VALUES);
+
+		dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t n) {
+			NSUInteger first = n * chunk;
+			NSUInteger count = MIN(chunk, NUMBER_OF_VALUES - first);
+
+			DKRandomFillSignedValues(TEST_SEED, first, values + first, count);
+		});
+
+		XCTAssertTrue(memcmp(reference, values, sizeof(CGFloat) * NUMBER_OF_VALUES) == 0, @"values differ when computed on %lu threads", (unsigned long)threads);
+	}
+
+	free(reference);
+	free(values);
+}
+
+- (void)testRandomisedPathReproducibleAcrossThreadCounts
+{
+	// randomise a set of paths, each with its own derived seed, dividing the paths between different numbers of threads. Every
+	// element of every path must be identical to the single-threaded result.
+
+	NSBezierPath* source = [NSBezierPath bezierPath];
+	NSUInteger i, t;
+
+	[source moveToPoint:NSZeroPoint];
+
+	for (i = 1; i < 200; ++i) {
+		if (i % 3)
+			[source lineToPoint:NSMakePoint(i * 5.0, (i % 7) * 11.0)];
+		else
+			[source curveToPoint:NSMakePoint(i * 5.0, 0)
+				   controlPoint1:NSMakePoint(i * 5.0 - 3.0, 20.0)
+				   controlPoint2:NSMakePoint(i * 5.0 - 1.0, -20.0)];
+	}
+	[source closePath];
+
+	NSMutableArray* reference = [NSMutableArray array];
+
+	for (i = 0; i < NUMBER_OF_PATHS; ++i)
+		[reference addObject:[source bezierPathByRandomisingPoints:4.0
+															  seed:DKRandomDeriveSeed(TEST_SEED, i)]];
+
+	for (t = 0; t < sizeof(sThreadCounts) / sizeof(sThreadCounts[0]); ++t) {
+		NSUInteger threads = sThreadCounts[t];
+		__block NSBezierPath* results[NUMBER_OF_PATHS];
+
+		dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t n) {
+			NSUInteger k;
+
+			for (k = n; k < NUMBER_OF_PATHS; k += threads)
+				results[k] = [[source bezierPathByRandomisingPoints:4.0
+															   seed:DKRandomDeriveSeed(TEST_SEED, k)] retain];
+		});
+
+		for (i = 0; i < NUMBER_OF_PATHS; ++i) {
+			XCTAssertTrue([self path:[reference objectAtIndex:i] isIdenticalToPath:results[i]], @"path %lu differs on %lu threads", (unsigned long)i, (unsigned long)threads);
+			[results[i] release];
+		}
+	}
+}
+
+- (void)testHatchingSeedIsArchivedAndCopied
+{
+	// a wobbly hatch is derived from the hatching's seed, so it must look the same after saving and loading, and in a copy
+
+	NSBezierPath* square = [NSBezierPath bezierPathWithRect:NSMakeRect(0, 0, 200, 200)];
+	DKHatching* hatching = [DKHatching hatchingWithLineWidth:1
+													 spacing:10
+													   angle:0.3];
+
+	[hatching setWobblyness:0.5];
+	[hatching setSeed:TEST_SEED];
+
+	NSBezierPath* reference = [hatching hatchPathForPath:square
+											 objectAngle:0];
+	DKHatching* archived = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:hatching]];
+	DKHatching* copy = [[hatching copy] autorelease];
+
+	XCTAssertEqual([archived seed], (DKRandomSeed)TEST_SEED, @"seed was not archived");
+	XCTAssertEqual([copy seed], (DKRandomSeed)TEST_SEED, @"seed was not copied");
+	XCTAssertTrue([self path:reference isIdenticalToPath:[archived hatchPathForPath:square objectAngle:0]], @"hatch differs after archiving");
+	XCTAssertTrue([self path:reference isIdenticalToPath:[copy hatchPathForPath:square objectAngle:0]], @"hatch differs in a copy");
+
+	[copy setSeed:DKRandomDeriveSeed(TEST_SEED, 1)];
+	XCTAssertFalse([self path:reference isIdenticalToPath:[copy hatchPathForPath:square objectAngle:0]], @"a different seed should wobble differently");
+}
+
+@end
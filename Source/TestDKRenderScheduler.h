@@ -0,0 +1,24 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKRenderScheduler.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the progressive refinement render scheduler.
+
+ The scheduler is driven by a simulated clock and a cost model that charges a fixed time per unit of area, so the tests can check which
+ quality each draw gets and which tiles are refined in each frame without drawing anything or waiting.
+*/
+@interface TestDKRenderScheduler : XCTestCase
+
+- (void)testSmallUpdatesDrawAtFullQuality;
+- (void)testDraftsAreRefinedWithinBudgetOnceQuiet;
+- (void)testRefinementOrder;
+- (void)testStaleRefinementsAreCancelled;
+- (void)testTilesCutByVisibleRectAreRefined;
+- (void)testLearnsCostWithoutModel;
+
+@end
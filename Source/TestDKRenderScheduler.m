@@ -0,0 +1,307 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKRenderScheduler.h"
+
+// each tile is 100 x 100 and costs 5ms to draw at full quality, and a frame has 8.3ms, so one tile is refined per frame
+
+#define TEST_TILE_SIZE 100.0
+#define TEST_COST_PER_AREA 5.0e-7
+
+static NSTimeInterval sTestNow = 0;
+
+/** @brief Charges a fixed time per unit of area, a quarter of it for drafts, and counts the draws it is told about. */
+@interface DKTestRenderCostModel : NSObject <DKRenderCostModel> {
+@public
+	NSUInteger drawCount;
+}
+@end
+
+@implementation DKTestRenderCostModel
+
+- (NSTimeInterval)renderScheduler:(DKRenderScheduler*)scheduler estimatedTimeToDrawRect:(NSRect)rect quality:(DKRenderQuality)quality
+{
+#pragma unused(scheduler)
+	double cost = NSWidth(rect) * NSHeight(rect) * TEST_COST_PER_AREA;
+
+	return quality == kDKRenderQualityFull ? cost : cost * 0.25;
+}
+
+- (void)renderScheduler:(DKRenderScheduler*)scheduler didDrawRect:(NSRect)rect quality:(DKRenderQuality)quality duration:(NSTimeInterval)duration
+{
+#pragma unused(scheduler, rect, quality, duration)
+	++drawCount;
+}
+
+@end
+
+#pragma mark -
+
+@interface TestDKRenderScheduler ()
+
+// returns a scheduler over a 1000 x 1000 drawing, timed by sTestNow, which is reset to 0
+
+- (DKRenderScheduler*)schedulerWithCostModel:(id<DKRenderCostModel>)model;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKRenderScheduler
+
+- (DKRenderScheduler*)schedulerWithCostModel:(id<DKRenderCostModel>)model
+{
+	DKRenderScheduler* scheduler = [[DKRenderScheduler alloc] initWithBounds:NSMakeRect(0, 0, 1000, 1000)
+																	tileSize:TEST_TILE_SIZE];
+
+	sTestNow = 0;
+	[scheduler setClock:^{
+		return sTestNow;
+	}];
+	[scheduler setCostModel:model];
+	[scheduler setFrameBudget:1.0 / 120.0];
+	[scheduler setQuietInterval:0.2];
+
+	return [scheduler autorelease];
+}
+
+- (void)testSmallUpdatesDrawAtFullQuality
+{
+	DKTestRenderCostModel* model = [[[DKTestRenderCostModel alloc] init] autorelease];
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:model];
+
+	XCTAssertEqual([scheduler qualityForDrawingRect:NSMakeRect(10, 10, 50, 50)], kDKRenderQualityFull, @"an update that fits the budget should be drawn properly");
+	XCTAssertEqual([scheduler qualityForDrawingRect:NSMakeRect(0, 0, 500, 500)], kDKRenderQualityDraft, @"an update over budget should be a draft");
+	XCTAssertEqual([scheduler qualityForDrawingRect:NSMakeRect(2000, 2000, 500, 500)], kDKRenderQualityFull, @"an update outside the drawing costs nothing");
+
+	[scheduler didDrawRect:NSMakeRect(10, 10, 50, 50)
+				   quality:kDKRenderQualityFull
+				  duration:0.001];
+
+	XCTAssertFalse([scheduler hasPendingRefinements], @"a full quality draw leaves nothing to refine");
+	XCTAssertEqual(model->drawCount, (NSUInteger)1, @"the cost model was not told about the draw");
+}
+
+- (void)testDraftsAreRefinedWithinBudgetOnceQuiet
+{
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:[[[DKTestRenderCostModel alloc] init] autorelease]];
+	NSUInteger frames = 0, refined = 0;
+
+	[scheduler setFrameBudget:0.012];
+
+	// a draft over six tiles, the first with a ragged edge
+
+	[scheduler didDrawRect:NSMakeRect(50, 0, 250, 200)
+				   quality:kDKRenderQualityDraft
+				  duration:0.004];
+
+	XCTAssertEqual([scheduler pendingTileCount], (NSUInteger)6, @"draft should leave six tiles to refine");
+
+	sTestNow = 0.1;
+	XCTAssertEqual([[scheduler rectsToRefine] count], (NSUInteger)0, @"tiles refined before they were quiet");
+
+	sTestNow = 0.25;
+
+	while ([scheduler hasPendingRefinements] && frames < 10) {
+		NSArray<NSValue*>* rects = [scheduler rectsToRefine];
+
+		XCTAssertEqual([rects count], (NSUInteger)2, @"frame %lu should refine two tiles", (unsigned long)frames);
+
+		for (NSValue* value in rects) {
+			NSRect r = [value rectValue];
+
+			XCTAssertEqual([scheduler qualityForDrawingRect:r], kDKRenderQualityFull, @"refinement should draw at full quality");
+			[scheduler didDrawRect:r
+						   quality:kDKRenderQualityFull
+						  duration:0.005];
+			++refined;
+		}
+
+		++frames;
+		sTestNow += 1.0 / 60.0;
+	}
+
+	XCTAssertEqual(frames, (NSUInteger)3, @"six tiles at two per frame should take three frames");
+	XCTAssertEqual(refined, (NSUInteger)6, @"every tile should be refined once");
+}
+
+- (void)testRefinementOrder
+{
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:[[[DKTestRenderCostModel alloc] init] autorelease]];
+	NSArray<NSValue*>* rects;
+
+	[scheduler setFrameBudget:1.0];
+
+	// three tiles drafted in turn - the last changed is refined first
+
+	[scheduler didDrawRect:NSMakeRect(0, 0, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	sTestNow = 0.05;
+	[scheduler didDrawRect:NSMakeRect(500, 500, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	sTestNow = 0.1;
+	[scheduler didDrawRect:NSMakeRect(900, 900, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+
+	sTestNow = 0.5;
+	rects = [scheduler rectsToRefine];
+
+	XCTAssertEqual([rects count], (NSUInteger)3, @"all three tiles fit the budget");
+	XCTAssertEqual([rects[0] rectValue].origin.x, 900.0, @"most recent change should come first");
+	XCTAssertEqual([rects[1] rectValue].origin.x, 500.0, @"wrong order");
+	XCTAssertEqual([rects[2] rectValue].origin.x, 0.0, @"oldest change should come last");
+
+	// with the cursor near the oldest, it goes first
+
+	[scheduler cancelAllRefinements];
+	sTestNow = 0;
+	[scheduler didDrawRect:NSMakeRect(0, 0, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	sTestNow = 0.05;
+	[scheduler didDrawRect:NSMakeRect(500, 500, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	sTestNow = 0.1;
+	[scheduler didDrawRect:NSMakeRect(900, 900, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	[scheduler setCursorPoint:NSMakePoint(40, 60)];
+
+	sTestNow = 0.5;
+	rects = [scheduler rectsToRefine];
+
+	XCTAssertEqual([rects count], (NSUInteger)3, @"all three tiles fit the budget");
+	XCTAssertEqual([rects[0] rectValue].origin.x, 0.0, @"tile under the cursor should come first");
+	XCTAssertEqual([rects[1] rectValue].origin.x, 500.0, @"nearer tile should come next");
+	XCTAssertEqual([rects[2] rectValue].origin.x, 900.0, @"farthest tile should come last");
+}
+
+- (void)testStaleRefinementsAreCancelled
+{
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:[[[DKTestRenderCostModel alloc] init] autorelease]];
+	NSRect tile = NSMakeRect(0, 0, 100, 100);
+	NSRect bigger = NSMakeRect(0, 0, 300, 300);
+
+	[scheduler didDrawRect:bigger
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+
+	sTestNow = 0.3;
+	XCTAssertTrue(NSEqualRects([[scheduler rectsToRefine][0] rectValue], tile), @"first tile should be refined first");
+
+	// the tile changes again before its refinement is drawn, so the refinement is cancelled until it is quiet again
+
+	sTestNow = 0.31;
+	XCTAssertEqual([scheduler qualityForDrawingRect:bigger], kDKRenderQualityDraft, @"an update over waiting tiles is not a refinement");
+	[scheduler didDrawRect:bigger
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+
+	sTestNow = 0.35;
+	XCTAssertEqual([[scheduler rectsToRefine] count], (NSUInteger)0, @"a tile that changed again should not be refined yet");
+
+	// a requested refinement that is never drawn is requested again
+
+	sTestNow = 0.6;
+	XCTAssertEqual([[scheduler rectsToRefine] count], (NSUInteger)1, @"one tile per frame");
+	sTestNow = 0.7;
+	NSUInteger count = [[scheduler rectsToRefine] count];
+	XCTAssertEqual(count, (NSUInteger)1, @"next frame should refine the next tile");
+	sTestNow = 2.0;
+
+	NSUInteger total = 0;
+
+	while ([[scheduler rectsToRefine] count] > 0 && total < 20)
+		++total;
+
+	XCTAssertEqual(total, (NSUInteger)9, @"lost refinements should be requested again, one per frame");
+
+	// tiles that have scrolled out of view are dropped
+
+	[scheduler cancelAllRefinements];
+	sTestNow = 3.0;
+	[scheduler didDrawRect:tile
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	[scheduler didDrawRect:NSMakeRect(600, 600, 100, 100)
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	[scheduler setVisibleRects:@[ [NSValue valueWithRect:NSMakeRect(500, 500, 500, 500)] ]];
+
+	sTestNow = 3.5;
+	NSArray<NSValue*>* rects = [scheduler rectsToRefine];
+
+	XCTAssertEqual([rects count], (NSUInteger)1, @"only the visible tile should be refined");
+	XCTAssertEqual([rects[0] rectValue].origin.x, 600.0, @"wrong tile refined");
+	XCTAssertEqual([scheduler pendingTileCount], (NSUInteger)1, @"hidden tile should have been dropped");
+}
+
+- (void)testTilesCutByVisibleRectAreRefined
+{
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:[[[DKTestRenderCostModel alloc] init] autorelease]];
+	NSRect visible = NSMakeRect(0, 0, 250, 250);
+	NSUInteger frames = 0;
+
+	[scheduler setFrameBudget:1.0];
+	[scheduler setVisibleRects:@[ [NSValue valueWithRect:visible] ]];
+
+	// the view only draws what can be seen, so the tiles the visible rect cuts through are only ever drawn in part
+
+	[scheduler didDrawRect:visible
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	XCTAssertEqual([scheduler pendingTileCount], (NSUInteger)9, @"draft should leave nine tiles to refine");
+
+	sTestNow = 0.5;
+
+	while ([scheduler hasPendingRefinements] && frames < 10) {
+		for (NSValue* value in [scheduler rectsToRefine])
+			[scheduler didDrawRect:NSIntersectionRect([value rectValue], visible)
+						   quality:kDKRenderQualityFull
+						  duration:0];
+
+		++frames;
+		sTestNow += 1.0 / 60.0;
+	}
+
+	XCTAssertFalse([scheduler hasPendingRefinements], @"tiles cut by the visible rect should be refined once their visible part is drawn");
+	XCTAssertEqual(frames, (NSUInteger)1, @"all nine tiles fit in one frame");
+
+	// a full quality draw of only part of a tile's visible part leaves it waiting
+
+	[scheduler didDrawRect:visible
+				   quality:kDKRenderQualityDraft
+				  duration:0];
+	[scheduler didDrawRect:NSMakeRect(200, 200, 25, 25)
+				   quality:kDKRenderQualityFull
+				  duration:0];
+	XCTAssertEqual([scheduler pendingTileCount], (NSUInteger)9, @"a tile is only refined when all of its visible part is drawn");
+}
+
+- (void)testLearnsCostWithoutModel
+{
+	DKRenderScheduler* scheduler = [self schedulerWithCostModel:nil];
+	NSRect tile = NSMakeRect(0, 0, 100, 100);
+	NSUInteger i;
+
+	XCTAssertEqual([scheduler qualityForDrawingRect:tile], kDKRenderQualityFull, @"a tile should start out cheap");
+
+	// every tile takes 50ms, so the scheduler should learn to draft them
+
+	for (i = 0; i < 20; ++i)
+		[scheduler didDrawRect:tile
+					   quality:kDKRenderQualityFull
+					  duration:0.05];
+
+	XCTAssertEqual([scheduler qualityForDrawingRect:tile], kDKRenderQualityDraft, @"a slow tile should be drafted once its cost is learned");
+	XCTAssertEqual([scheduler qualityForDrawingRect:NSMakeRect(0, 0, 10, 10)], kDKRenderQualityFull, @"a small area should still fit the budget");
+}
+
+@end
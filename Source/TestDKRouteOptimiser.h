@@ -0,0 +1,22 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKRouteOptimiser.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the route optimiser.
+
+ Points are generated from a fixed seed, spread evenly or gathered into clusters. Each route must visit every point once, starting at the
+ first, and be no longer than the route DKRouteFinder's nearest neighbour search finds for the same points, which was its default before
+ the optimiser.
+*/
+@interface TestDKRouteOptimiser : XCTestCase
+
+- (void)testRouteVisitsEveryPointOnce;
+- (void)testRestartsDoNotLengthenRoute;
+- (void)testNoLongerThanNearestNeighbour;
+
+@end
@@ -0,0 +1,180 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKRouteOptimiser.h"
+#import <DKDrawKit/DKRouteFinder.h>
+
+#define ROUTE_SEED 0x0DEC0DEULL
+#define ROUTE_CANVAS 1000.0
+#define ROUTE_CLUSTERS 5
+
+@interface TestDKRouteOptimiser ()
+
+- (NSPoint*)pointsWithCount:(NSUInteger)count clustered:(BOOL)clustered;
+- (CGFloat)checkRoute:(const NSUInteger*)order ofPoints:(const NSPoint*)points count:(NSUInteger)count;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKRouteOptimiser
+
+- (NSPoint*)pointsWithCount:(NSUInteger)count clustered:(BOOL)clustered
+{
+	// the caller frees the points
+
+	NSPoint* points = malloc(sizeof(NSPoint) * MAX(count, (NSUInteger)1));
+	NSUInteger i;
+
+	for (i = 0; i < count; ++i) {
+		CGFloat u = DKRandomValue(ROUTE_SEED, 2 * i);
+		CGFloat v = DKRandomValue(ROUTE_SEED, 2 * i + 1);
+
+		if (clustered) {
+			NSUInteger c = i % ROUTE_CLUSTERS;
+
+			points[i].x = (c + 0.5) * ROUTE_CANVAS / ROUTE_CLUSTERS + (u - 0.5) * 60.0;
+			points[i].y = ((c & 1) ? 0.75 : 0.25) * ROUTE_CANVAS + (v - 0.5) * 60.0;
+		} else {
+			points[i].x = u * ROUTE_CANVAS;
+			points[i].y = v * ROUTE_CANVAS;
+		}
+	}
+
+	return points;
+}
+
+- (CGFloat)checkRoute:(const NSUInteger*)order ofPoints:(const NSPoint*)points count:(NSUInteger)count
+{
+	// checks that <order> is a permutation starting at the first point, and returns the length of the open path it describes
+
+	BOOL* seen = calloc(MAX(count, (NSUInteger)1), sizeof(BOOL));
+	CGFloat length = 0;
+	NSUInteger i;
+
+	if (count > 0)
+		XCTAssertEqual(order[0], (NSUInteger)0, @"route of %lu points does not start at the first", (unsigned long)count);
+
+	for (i = 0; i < count; ++i) {
+		XCTAssertLessThan(order[i], count, @"route of %lu points has an index out of range", (unsigned long)count);
+
+		if (order[i] >= count)
+			break;
+
+		XCTAssertFalse(seen[order[i]], @"route of %lu points visits point %lu twice", (unsigned long)count, (unsigned long)order[i]);
+		seen[order[i]] = YES;
+
+		if (i > 0)
+			length += hypot(points[order[i]].x - points[order[i - 1]].x, points[order[i]].y - points[order[i - 1]].y);
+	}
+
+	free(seen);
+	return length;
+}
+
+#pragma mark -
+
+- (void)testRouteVisitsEveryPointOnce
+{
+	const NSUInteger sizes[] = { 1, 2, 3, 4, 7, 8, 50, 500 };
+	NSUInteger s;
+	int clustered;
+
+	for (clustered = 0; clustered < 2; ++clustered) {
+		for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+			NSUInteger count = sizes[s];
+			NSPoint* points = [self pointsWithCount:count
+										  clustered:clustered];
+			NSUInteger* order = malloc(sizeof(NSUInteger) * count);
+
+			CGFloat length = DKRouteOptimiseOpenPath(points, count, order, DKRouteOptimiserDefaultOptions(), NULL, NULL);
+			CGFloat measured = [self checkRoute:order
+									   ofPoints:points
+										  count:count];
+
+			XCTAssertEqualWithAccuracy(length, measured, 1e-6 * MAX(measured, 1.0), @"returned length is not that of the route for %lu points", (unsigned long)count);
+
+			free(order);
+			free(points);
+		}
+	}
+}
+
+- (void)testRestartsDoNotLengthenRoute
+{
+	const NSUInteger count = 500;
+	NSPoint* points = [self pointsWithCount:count
+								  clustered:NO];
+	NSUInteger* order = malloc(sizeof(NSUInteger) * count);
+	DKRouteOptimiserOptions options = DKRouteOptimiserDefaultOptions();
+
+	CGFloat plain = DKRouteOptimiseOpenPath(points, count, order, options, NULL, NULL);
+
+	options.restarts = 4;
+
+	CGFloat restarted = DKRouteOptimiseOpenPath(points, count, order, options, NULL, NULL);
+	CGFloat measured = [self checkRoute:order
+							   ofPoints:points
+								  count:count];
+
+	XCTAssertEqualWithAccuracy(restarted, measured, 1e-6 * measured, @"returned length is not that of the restarted route");
+	XCTAssertLessThanOrEqual(restarted, plain + 1e-6, @"restarts made the route longer");
+
+	free(order);
+	free(points);
+}
+
+- (void)testNoLongerThanNearestNeighbour
+{
+	// DKRouteFinder's default is the optimiser. Its route is compared with the one its nearest neighbour search, the previous default, finds
+
+	XCTAssertEqual([DKRouteFinder algorithm], kDKUseRouteOptimiser, @"the optimiser is not the default algorithm");
+
+	const NSUInteger count = 400;
+	DKRouteAlgorithmType saved = [DKRouteFinder algorithm];
+	int clustered;
+
+	for (clustered = 0; clustered < 2; ++clustered) {
+		NSPoint* points = [self pointsWithCount:count
+									  clustered:clustered];
+		NSMutableArray* values = [NSMutableArray arrayWithCapacity:count];
+		NSUInteger i;
+
+		for (i = 0; i < count; ++i)
+			[values addObject:[NSValue valueWithPoint:points[i]]];
+
+		[DKRouteFinder setAlgorithm:kDKUseNearestNeighbour];
+		DKRouteFinder* nearest = [DKRouteFinder routeFinderWithArrayOfPoints:values];
+
+		[DKRouteFinder setAlgorithm:saved];
+		DKRouteFinder* optimised = [DKRouteFinder routeFinderWithArrayOfPoints:values];
+
+		XCTAssertEqual([optimised algorithm], kDKUseRouteOptimiser, @"route finder is not using the optimiser");
+
+		NSArray<NSNumber*>* routeOrder = [optimised shortestRouteOrder];
+		NSUInteger* order = malloc(sizeof(NSUInteger) * count);
+
+		XCTAssertEqual([routeOrder count], count, @"route finder's route is the wrong length");
+
+		for (i = 0; i < count && i < [routeOrder count]; ++i)
+			order[i] = [routeOrder[i] unsignedIntegerValue];
+
+		CGFloat measured = [self checkRoute:order
+								   ofPoints:points
+									  count:count];
+
+		XCTAssertEqualWithAccuracy([optimised pathLength], measured, 1e-6 * measured, @"path length is not that of the route");
+		XCTAssertLessThanOrEqual([optimised pathLength], [nearest pathLength], @"optimised route (%g) is longer than nearest neighbour's (%g)",
+			[optimised pathLength], [nearest pathLength]);
+
+		free(order);
+		free(points);
+	}
+
+	[DKRouteFinder setAlgorithm:saved];
+}
+
+@end
@@ -0,0 +1,27 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKSVGExporter.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the SVG exporter and the stream it writes through.
+
+ Numbers, path data and a whole document are checked byte for byte. The document is built in code with explicit sRGB colours, so the
+ output does not depend on any defaults.
+*/
+@interface TestDKSVGExporter : XCTestCase
+
+- (void)testNumberFormatting;
+- (void)testColourFormatting;
+- (void)testPathData;
+- (void)testEscaping;
+- (void)testBoundedBuffer;
+- (void)testDocument;
+- (void)testGroupsAndHiddenContent;
+- (void)testUnflippedDrawing;
+- (void)testWriteToURL;
+
+@end
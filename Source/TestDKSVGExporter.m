@@ -0,0 +1,411 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKSVGExporter.h"
+#import <DKDrawKit/DKDrawablePath.h>
+#import <DKDrawKit/DKDrawableShape.h>
+#import <DKDrawKit/DKDrawing+Export.h>
+#import <DKDrawKit/DKDrawing.h>
+#import <DKDrawKit/DKFill.h>
+#import <DKDrawKit/DKObjectDrawingLayer.h>
+#import <DKDrawKit/DKSVGStream.h>
+#import <DKDrawKit/DKShapeGroup.h>
+#import <DKDrawKit/DKStroke.h>
+#import <DKDrawKit/DKStrokeDash.h>
+#import <DKDrawKit/DKStyle.h>
+
+typedef struct {
+	NSMutableData* data;
+	size_t largestWrite;
+	size_t writes;
+	size_t failAfter; ///< writes after which the function fails, or 0 never to fail
+} DKTestSVGSink;
+
+static bool DKTestSVGWrite(const char* bytes, size_t length, void* info)
+{
+	DKTestSVGSink* sink = info;
+
+	if (sink->failAfter > 0 && sink->writes >= sink->failAfter)
+		return false;
+
+	[sink->data appendBytes:bytes
+					 length:length];
+	sink->largestWrite = MAX(sink->largestWrite, length);
+	sink->writes++;
+	return true;
+}
+
+static NSString* DKTestSVGString(NSData* data)
+{
+	return [[[NSString alloc] initWithData:data
+								  encoding:NSUTF8StringEncoding] autorelease];
+}
+
+static DKStyle* DKTestSVGFillStyle(CGFloat red, CGFloat green, CGFloat blue, CGFloat alpha)
+{
+	DKStyle* style = [[[DKStyle alloc] init] autorelease];
+
+	[style addRenderer:[DKFill fillWithColour:[NSColor colorWithSRGBRed:red
+																   green:green
+																	blue:blue
+																   alpha:alpha]]];
+	return style;
+}
+
+static DKStroke* DKTestSVGStroke(CGFloat width, NSColor* colour)
+{
+	DKStroke* stroke = [DKStroke strokeWithWidth:width
+										  colour:colour];
+
+	[stroke setLineCapStyle:NSButtLineCapStyle];
+	[stroke setLineJoinStyle:NSMiterLineJoinStyle];
+	[stroke setMiterLimit:4.0];
+	return stroke;
+}
+
+@implementation TestDKSVGExporter
+
+- (void)testNumberFormatting
+{
+	struct {
+		double value;
+		unsigned precision;
+		const char* text;
+	} cases[] = {
+		{ 0, 2, "0" },
+		{ -0.0, 2, "0" },
+		{ -0.001, 2, "0" },
+		{ 0.5, 2, ".5" },
+		{ -0.5, 2, "-.5" },
+		{ 1.25, 2, "1.25" },
+		{ 1.2500001, 2, "1.25" },
+		{ 0.125, 2, ".13" },
+		{ -12.999, 2, "-13" },
+		{ 100, 2, "100" },
+		{ 10.1, 3, "10.1" },
+		{ 2.5, 0, "3" },
+		{ 0.00005, 4, ".0001" },
+		{ 3.14159265, 8, "3.14159265" },
+		{ 3.14159265, 20, "3.14159265" },
+		{ 1e300, 0, "1000000000000000" },
+		{ -1e300, 2, "-1000000000000000" },
+		{ NAN, 2, "0" },
+		{ INFINITY, 2, "0" },
+	};
+	char text[kDKSVGNumberMaxLength];
+	size_t i;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+		size_t length = DKSVGFormatNumber(cases[i].value, cases[i].precision, text);
+
+		XCTAssertEqualObjects(@(text), @(cases[i].text), @"%g at %u places", cases[i].value, cases[i].precision);
+		XCTAssertEqual(length, strlen(cases[i].text));
+	}
+}
+
+- (void)testColourFormatting
+{
+	char text[8];
+
+	DKSVGFormatColor(1, 0, 0.2, text);
+	XCTAssertEqualObjects(@(text), @"#f03");
+
+	DKSVGFormatColor(0.5, 0.5, 0.5, text);
+	XCTAssertEqualObjects(@(text), @"#808080");
+
+	DKSVGFormatColor(-1, 2, NAN, text);
+	XCTAssertEqualObjects(@(text), @"#0f0");
+}
+
+- (void)testPathData
+{
+	DKTestSVGSink sink = { [NSMutableData data], 0, 0, 0 };
+	DKSVGStream stream;
+	DKPathBuffer path;
+
+	// command letters are repeated only where needed, and separators are left out before a minus sign or a second decimal point
+
+	XCTAssertTrue(DKSVGStreamInit(&stream, 256, 2, DKTestSVGWrite, &sink));
+	DKSVGStreamBeginPath(&stream);
+	DKSVGStreamMoveTo(&stream, 10, 10);
+	DKSVGStreamLineTo(&stream, 20, 10);
+	DKSVGStreamLineTo(&stream, 20, -5.5);
+	DKSVGStreamLineTo(&stream, 0.5, 0.25);
+	DKSVGStreamLineTo(&stream, 0.75, -1);
+	DKSVGStreamCurveTo(&stream, 1, 2, 3, 4, 5, 6);
+	DKSVGStreamCurveTo(&stream, 0.5, 0.5, -1, -1, 7, 8);
+	DKSVGStreamClose(&stream);
+	DKSVGStreamLineTo(&stream, 10, 3);
+	XCTAssertTrue(DKSVGStreamFlush(&stream));
+	XCTAssertEqualObjects(DKTestSVGString(sink.data), @"M10 10H20V-5.5L.5.25.75-1C1 2 3 4 5 6 .5.5-1-1 7 8ZV3");
+
+	// lines that differ by less than the rounding are horizontal or vertical, and subpaths each start with a moveto
+
+	[sink.data setLength:0];
+	DKPathBufferInit(&path);
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 0, 0 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 10.001, 0.004 });
+	DKPathBufferLineTo(&path, (DKPathPoint){ 9.998, 10 });
+	DKPathBufferClose(&path);
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 20, 20 });
+	DKPathBufferMoveTo(&path, (DKPathPoint){ 30, 30 });
+
+	DKSVGStreamBeginPath(&stream);
+	DKSVGStreamAppendPathBuffer(&stream, &path);
+	XCTAssertTrue(DKSVGStreamFlush(&stream));
+	XCTAssertEqualObjects(DKTestSVGString(sink.data), @"M0 0H10V10ZM20 20M30 30");
+
+	DKPathBufferFree(&path);
+	DKSVGStreamFree(&stream);
+}
+
+- (void)testEscaping
+{
+	DKTestSVGSink sink = { [NSMutableData data], 0, 0, 0 };
+	DKSVGStream stream;
+
+	DKSVGStreamInit(&stream, 256, 2, DKTestSVGWrite, &sink);
+	DKSVGStreamAppendEscaped(&stream, "a<b & \"c\"\x01>\tz\xc3\xa9");
+	DKSVGStreamFlush(&stream);
+	DKSVGStreamFree(&stream);
+
+	XCTAssertEqualObjects(DKTestSVGString(sink.data), @"a&lt;b &amp; &quot;c&quot;&gt;\tzé");
+}
+
+- (void)testBoundedBuffer
+{
+	DKTestSVGSink sink = { [NSMutableData data], 0, 0, 0 };
+	NSMutableString* expected = [NSMutableString string];
+	DKSVGStream stream;
+	char large[1000];
+	NSUInteger i;
+
+	// everything passes through the buffer in pieces no larger than it, except what is too large for it, which goes straight through
+
+	memset(large, 'x', sizeof(large) - 1);
+	large[sizeof(large) - 1] = 0;
+
+	DKSVGStreamInit(&stream, 256, 2, DKTestSVGWrite, &sink);
+
+	for (i = 0; i < 1000; ++i) {
+		DKSVGStreamAppendNumber(&stream, i * 0.25);
+		DKSVGStreamAppendString(&stream, ",");
+
+		char text[kDKSVGNumberMaxLength];
+		DKSVGFormatNumber(i * 0.25, 2, text);
+		[expected appendFormat:@"%s,", text];
+	}
+
+	XCTAssertLessThanOrEqual(sink.largestWrite, (size_t)256);
+	XCTAssertEqual(stream.length + [sink.data length], [expected length]);
+
+	DKSVGStreamAppendString(&stream, large);
+	[expected appendString:@(large)];
+
+	XCTAssertTrue(DKSVGStreamFlush(&stream));
+	XCTAssertEqualObjects(DKTestSVGString(sink.data), expected);
+	XCTAssertEqual(stream.bytesWritten, (uint64_t)[expected length]);
+	DKSVGStreamFree(&stream);
+
+	// a failed write stops all further output
+
+	DKTestSVGSink failing = { [NSMutableData data], 0, 0, 2 };
+
+	DKSVGStreamInit(&stream, 256, 2, DKTestSVGWrite, &failing);
+
+	for (i = 0; i < 1000; ++i)
+		DKSVGStreamAppendString(&stream, "0123456789");
+
+	XCTAssertTrue(stream.failed);
+	XCTAssertFalse(DKSVGStreamFlush(&stream));
+	XCTAssertEqual([failing.data length], (NSUInteger)500);
+	XCTAssertEqual(stream.bytesWritten, (uint64_t)500);
+	DKSVGStreamFree(&stream);
+}
+
+- (void)testDocument
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(200, 100)];
+	DKObjectDrawingLayer* layer = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+	DKStyle* stroked = [[[DKStyle alloc] init] autorelease];
+	DKStyle* both = DKTestSVGFillStyle(0, 1, 0, 0.5);
+	DKStroke* stroke = DKTestSVGStroke(2, [NSColor colorWithSRGBRed:0
+															  green:0
+															   blue:1
+															  alpha:1]);
+	DKStroke* dashed = DKTestSVGStroke(1, [NSColor colorWithSRGBRed:0
+															  green:0
+															   blue:0
+															  alpha:1]);
+	CGFloat pattern[2] = { 4, 2 };
+	DKStrokeDash* dash = [DKStrokeDash dashWithPattern:pattern
+												 count:2];
+	NSBezierPath* line = [NSBezierPath bezierPath];
+
+	[drawing setPaperColour:[NSColor colorWithSRGBRed:1
+												green:1
+												 blue:1
+												alpha:1]];
+	[drawing setPaperColourIsPrinted:YES];
+	[layer setLayerName:@"Shapes & <Paths>"];
+
+	[stroke setLineCapStyle:NSRoundLineCapStyle];
+	[stroked addRenderer:stroke];
+
+	[dash setScalesToLineWidth:NO];
+	[dashed setDash:dash];
+	[both addRenderer:dashed];
+
+	[line moveToPoint:NSMakePoint(10, 90)];
+	[line lineToPoint:NSMakePoint(190, 90)];
+
+	// the first two shapes have separate but equal styles, which are written once
+
+	[layer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(10, 20, 30, 40)]
+														withStyle:DKTestSVGFillStyle(1, 0, 0, 1)]];
+	[layer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(50, 20, 30, 40)]
+														withStyle:DKTestSVGFillStyle(1, 0, 0, 1)]];
+	[layer addObject:[DKDrawablePath drawablePathWithBezierPath:line
+													  withStyle:stroked]];
+	[layer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(100, 10.123, 40.5, 20)]
+														withStyle:both]];
+
+	DKSVGExporter* exporter = [[[DKSVGExporter alloc] initWithDrawing:drawing] autorelease];
+	NSString* svg = DKTestSVGString([exporter SVGData]);
+	NSString* expected = @"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+						 @"<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"200\" height=\"100\" "
+						 @"viewBox=\"0 0 200 100\">\n"
+						 @"<rect width=\"100%\" height=\"100%\" fill=\"#fff\"/>\n"
+						 @"<g>\n"
+						 @"<title>Shapes &amp; &lt;Paths&gt;</title>\n"
+						 @"<path class=\"s1\" d=\"M10 20H40V60H10Z\"/>\n"
+						 @"<path class=\"s1\" d=\"M50 20H80V60H50Z\"/>\n"
+						 @"<path class=\"s2\" d=\"M10 90H190\"/>\n"
+						 @"<defs><path id=\"o4\" d=\"M100 10.12H140.5V30.12H100Z\"/></defs><use xlink:href=\"#o4\" class=\"s3\"/>"
+						 @"<use xlink:href=\"#o4\" class=\"s3-1\"/>\n"
+						 @"</g>\n"
+						 @"<style>\n"
+						 @".s1{fill:#f00}\n"
+						 @".s2{fill:none;stroke:#00f;stroke-width:2;stroke-linecap:round}\n"
+						 @".s3{fill:#0f0;fill-opacity:.5}\n"
+						 @".s3-1{fill:none;stroke:#000;stroke-dasharray:4,2}\n"
+						 @"</style>\n"
+						 @"</svg>\n";
+
+	XCTAssertEqualObjects(svg, expected);
+	XCTAssertEqual([exporter objectCount], (NSUInteger)4);
+	XCTAssertEqual([exporter styleCount], (NSUInteger)3);
+
+	// the buffer size changes how the output is written, not what is written
+
+	[exporter setBufferSize:256];
+	XCTAssertEqualObjects(DKTestSVGString([exporter SVGData]), expected);
+	XCTAssertEqualObjects(DKTestSVGString([drawing SVGData]), expected);
+}
+
+- (void)testGroupsAndHiddenContent
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(200, 100)];
+	DKObjectDrawingLayer* layer = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+	DKObjectDrawingLayer* hiddenLayer = [[[DKObjectDrawingLayer alloc] init] autorelease];
+	DKStyle* style = DKTestSVGFillStyle(0, 0, 1, 1);
+	DKDrawableShape* a = [DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(10, 10, 20, 20)]
+															withStyle:style];
+	DKDrawableShape* b = [DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(40, 10, 20, 20)]
+															withStyle:style];
+	DKDrawableShape* hidden = [DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(70, 10, 20, 20)]
+																 withStyle:style];
+	DKDrawableShape* unstyled = [DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(100, 10, 20, 20)]
+																   withStyle:[[[DKStyle alloc] init] autorelease]];
+
+	[drawing setPaperColourIsPrinted:NO];
+	[layer addObject:hidden];
+	[layer addObject:unstyled];
+	[layer addObject:[DKShapeGroup groupWithObjects:@[ a, b ]]];
+	[hidden setVisible:NO];
+
+	[hiddenLayer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(10, 50, 20, 20)]
+															  withStyle:style]];
+	[drawing addLayer:hiddenLayer];
+	[hiddenLayer setVisible:NO];
+
+	// hidden objects and layers, and objects whose style draws nothing, are left out; grouped objects are nested
+
+	DKSVGExporter* exporter = [[[DKSVGExporter alloc] initWithDrawing:drawing] autorelease];
+	NSString* svg = DKTestSVGString([exporter SVGData]);
+
+	XCTAssertNotNil(svg);
+	XCTAssertEqual([exporter objectCount], (NSUInteger)2);
+	XCTAssertEqual([[svg componentsSeparatedByString:@"<path class=\"s1\""] count], (NSUInteger)3);
+	XCTAssertEqual([exporter styleCount], (NSUInteger)1);
+	XCTAssertEqual([[svg componentsSeparatedByString:@"<g"] count], (NSUInteger)3);
+	XCTAssertNotEqual([svg rangeOfString:@"</title>\n<g"].location, (NSUInteger)NSNotFound);
+	XCTAssertEqual([svg rangeOfString:@"<rect"].location, (NSUInteger)NSNotFound);
+	XCTAssertTrue([svg hasSuffix:@"</style>\n</svg>\n"]);
+}
+
+- (void)testUnflippedDrawing
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(200, 100)];
+	DKObjectDrawingLayer* layer = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+
+	[drawing setPaperColourIsPrinted:NO];
+	[layer setLayerName:@"Layer"];
+	[layer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(10, 20, 30, 40)]
+														withStyle:DKTestSVGFillStyle(1, 0, 0, 1)]];
+
+	// a flipped drawing's y axis already runs down, as SVG's does
+
+	NSString* svg = DKTestSVGString([drawing SVGData]);
+
+	XCTAssertEqual([svg rangeOfString:@"transform"].location, (NSUInteger)NSNotFound);
+
+	// an unflipped drawing's content is turned over within its height, leaving the paths and styles as they are
+
+	[drawing setFlipped:NO];
+	svg = DKTestSVGString([drawing SVGData]);
+
+	NSString* expected = @"viewBox=\"0 0 200 100\">\n"
+						 @"<g transform=\"matrix(1 0 0 -1 0 100)\">\n"
+						 @"<g>\n"
+						 @"<title>Layer</title>\n"
+						 @"<path class=\"s1\" d=\"M10 20H40V60H10Z\"/>\n"
+						 @"</g>\n"
+						 @"</g>\n"
+						 @"<style>\n";
+
+	XCTAssertNotEqual([svg rangeOfString:expected].location, (NSUInteger)NSNotFound, @"%@", svg);
+}
+
+- (void)testWriteToURL
+{
+	DKDrawing* drawing = [DKDrawing defaultDrawingWithSize:NSMakeSize(200, 100)];
+	DKObjectDrawingLayer* layer = [drawing activeLayerOfClass:[DKObjectDrawingLayer class]];
+	NSURL* url = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+	NSError* error = nil;
+	NSUInteger i;
+
+	for (i = 0; i < 1000; ++i)
+		[layer addObject:[DKDrawableShape drawableShapeWithBezierPath:[NSBezierPath bezierPathWithRect:NSMakeRect(i % 190, i / 10, 10, 10)]
+															withStyle:DKTestSVGFillStyle(i % 2, 0, 0, 1)]];
+
+	XCTAssertTrue([drawing writeSVGToURL:url
+								   error:&error], @"%@", error);
+	XCTAssertEqualObjects([NSData dataWithContentsOfURL:url], [drawing SVGData]);
+	[[NSFileManager defaultManager] removeItemAtURL:url
+											  error:NULL];
+
+	// a stream that can't be opened reports its error
+
+	NSURL* bad = [NSURL fileURLWithPath:@"/nonexistent-directory/drawing.svg"];
+
+	error = nil;
+	XCTAssertFalse([drawing writeSVGToURL:bad
+									error:&error]);
+	XCTAssertNotNil(error);
+}
+
+@end
@@ -0,0 +1,20 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKStyleRegistry.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the style registry's name and equivalence indexes. */
+@interface TestDKStyleRegistry : XCTestCase
+
+- (void)testUniqueNames;
+- (void)testRenamingWithoutNotifications;
+- (void)testRenamingWithNotifications;
+- (void)testEquivalentStyles;
+- (void)testSeedsDecideEquivalence;
+- (void)testMergeReusesEquivalentStyles;
+
+@end
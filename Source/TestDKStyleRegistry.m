@@ -0,0 +1,201 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKStyleRegistry.h"
+#import <DKDrawKit/DKStyle.h>
+#import <DKDrawKit/DKHatching.h>
+#import <DKDrawKit/DKPathDecorator.h>
+#import <DKDrawKit/DKRoughStroke.h>
+
+@interface TestDKStyleRegistry ()
+
+- (DKStyle*)testStyle;
+- (DKStyle*)registeredStyleNamed:(NSString*)name;
+- (void)renameStyle:(DKStyle*)style to:(NSString*)name;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKStyleRegistry
+
+- (void)setUp
+{
+	[super setUp];
+	[DKStyleRegistry resetRegistry];
+}
+
+- (void)tearDown
+{
+	[DKStyleRegistry setStyleNotificationsEnabled:NO];
+	[DKStyleRegistry resetRegistry];
+	[super tearDown];
+}
+
+- (DKStyle*)testStyle
+{
+	// an unusual colour, so as not to match any of the default styles
+
+	return [DKStyle styleWithFillColour:[NSColor colorWithCalibratedRed:0.1
+																 green:0.2
+																  blue:0.3
+																 alpha:1.0]
+						   strokeColour:[NSColor blackColor]
+							strokeWidth:1.0];
+}
+
+- (DKStyle*)registeredStyleNamed:(NSString*)name
+{
+	DKStyle* style = [self testStyle];
+
+	[style setName:name];
+	[DKStyleRegistry registerStyle:style];
+	return style;
+}
+
+- (void)renameStyle:(DKStyle*)style to:(NSString*)name
+{
+	// registered styles are locked, so renaming one is a deliberate act
+
+	[style setLocked:NO];
+	[style setName:name];
+	[style setLocked:YES];
+}
+
+#pragma mark -
+
+- (void)testUniqueNames
+{
+	DKStyleRegistry* reg = [DKStyleRegistry sharedStyleRegistry];
+	DKStyle* first = [self registeredStyleNamed:@"Test Style"];
+	DKStyle* second = [self registeredStyleNamed:@"Test Style"];
+
+	XCTAssertEqualObjects([first name], @"Test Style");
+	XCTAssertEqualObjects([second name], @"Test Style 1");
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Test Style"], @"Test Style 2");
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Unused Test Style"], @"Unused Test Style");
+}
+
+- (void)testRenamingWithoutNotifications
+{
+	// the registry isn't told of the rename, so its name index must notice it for itself
+
+	DKStyleRegistry* reg = [DKStyleRegistry sharedStyleRegistry];
+	DKStyle* style = [self registeredStyleNamed:@"Test Style"];
+
+	[DKStyleRegistry setStyleNotificationsEnabled:NO];
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Test Style"], @"Test Style 1");
+
+	[self renameStyle:style
+				   to:@"Renamed Test Style"];
+
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Renamed Test Style"], @"Renamed Test Style 1");
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Test Style"], @"Test Style");
+
+	DKStyle* other = [self registeredStyleNamed:@"Renamed Test Style"];
+	XCTAssertEqualObjects([other name], @"Renamed Test Style 1");
+}
+
+- (void)testRenamingWithNotifications
+{
+	DKStyleRegistry* reg = [DKStyleRegistry sharedStyleRegistry];
+	DKStyle* style = [self registeredStyleNamed:@"Test Style"];
+
+	[DKStyleRegistry setStyleNotificationsEnabled:YES];
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Test Style"], @"Test Style 1");
+
+	[self renameStyle:style
+				   to:@"Renamed Test Style"];
+
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Renamed Test Style"], @"Renamed Test Style 1");
+	XCTAssertEqualObjects([reg uniqueNameForName:@"Test Style"], @"Test Style");
+}
+
+- (void)testEquivalentStyles
+{
+	DKStyleRegistry* reg = [DKStyleRegistry sharedStyleRegistry];
+	DKStyle* style = [self registeredStyleNamed:@"Test Style"];
+	DKStyle* copy = [self testStyle];
+	DKStyle* different = [DKStyle styleWithFillColour:[NSColor colorWithCalibratedRed:0.3
+																		  green:0.2
+																		   blue:0.1
+																		  alpha:1.0]
+										 strokeColour:[NSColor blackColor]
+										  strokeWidth:1.0];
+
+	XCTAssertEqual([reg styleEquivalentToStyle:copy], style);
+	XCTAssertNil([reg styleEquivalentToStyle:different]);
+	XCTAssertNil([reg styleEquivalentToStyle:style], @"a style is not its own equivalent");
+}
+
+- (void)testSeedsDecideEquivalence
+{
+	// renderers that differ only in their random seed draw differently, so must not be merged
+
+	NSArray* renderers = @[[[[DKRoughStroke alloc] init] autorelease], [[[DKHatching alloc] init] autorelease], [[[DKPathDecorator alloc] init] autorelease]];
+
+	for (DKRasterizer* renderer in renderers) {
+		DKRasterizer* copy = [[renderer copy] autorelease];
+		NSString* seedKey = [renderer isKindOfClass:[DKPathDecorator class]] ? @"randomSeed" : @"seed";
+
+		XCTAssertTrue([copy isEquivalentToObject:renderer], @"%@ copy is not equivalent", [renderer className]);
+
+		[copy setValue:@([[renderer valueForKey:seedKey] unsignedLongLongValue] + 1)
+				forKey:seedKey];
+		XCTAssertFalse([copy isEquivalentToObject:renderer], @"%@ with another seed is equivalent", [renderer className]);
+	}
+
+	// the same goes for styles, whose cached hashes must notice the change
+
+	DKStyle* style = [self testStyle];
+	DKStyle* copy = [self testStyle];
+	DKRoughStroke* rough = [[[DKRoughStroke alloc] init] autorelease];
+	DKRoughStroke* roughCopy = [[rough copy] autorelease];
+
+	[style addRenderer:rough];
+	[style setName:@"Rough Style"];
+	[DKStyleRegistry registerStyle:style];
+	[copy addRenderer:roughCopy];
+	XCTAssertEqual([[DKStyleRegistry sharedStyleRegistry] styleEquivalentToStyle:copy], style);
+
+	[roughCopy setSeed:[rough seed] + 1];
+	XCTAssertNil([[DKStyleRegistry sharedStyleRegistry] styleEquivalentToStyle:copy], @"a style with a differently seeded stroke was reused");
+}
+
+- (void)testMergeReusesEquivalentStyles
+{
+	// merging many styles looks up each one's name, which must not search the whole registry every time
+
+	NSMutableSet* incoming = [NSMutableSet set];
+	NSUInteger i;
+
+	for (i = 0; i < 50; ++i) {
+		DKStyle* style = [DKStyle styleWithFillColour:[NSColor colorWithCalibratedRed:i / 50.0
+																				green:0.5
+																				 blue:0.5
+																				alpha:1.0]
+										 strokeColour:nil];
+
+		[style setName:@"Merged Style"];
+		[incoming addObject:style];
+	}
+
+	[incoming addObject:[self testStyle]];
+	[self registeredStyleNamed:@"Merged Style"];
+
+	[DKStyleRegistry mergeStyles:incoming
+					inCategories:nil
+						 options:kDKReuseEquivalentStyles
+				   mergeDelegate:nil];
+
+	DKStyleRegistry* reg = [DKStyleRegistry sharedStyleRegistry];
+	NSSet* names = [NSSet setWithArray:[reg styleNames]];
+
+	XCTAssertTrue([names containsObject:@"Merged Style 50"], @"each incoming style should get its own name");
+	XCTAssertFalse([names containsObject:@"Merged Style 51"], @"the copy of the registered style should have been reused");
+}
+
+@end
@@ -0,0 +1,24 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <DKDrawKit/DKTaskScheduler.h>
+#import <XCTest/XCTest.h>
+
+/** @brief Unit Test for the work-stealing task scheduler.
+
+ These tests run many small tasks from many threads at once, so that the deques are contended and tasks are stolen, and check that every
+ task runs exactly once and that groups, cancellation, dependencies and priorities behave. They need no window server.
+*/
+@interface TestDKTaskScheduler : XCTestCase
+
+- (void)testEveryTaskRunsOnceUnderContention;
+- (void)testNestedTasksCanWait;
+- (void)testParallelForCoversRangeOnce;
+- (void)testCancelSkipsTasksNotStarted;
+- (void)testTaskAfterGroupRunsLast;
+- (void)testInteractiveTasksRunFirst;
+
+@end
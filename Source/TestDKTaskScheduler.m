@@ -0,0 +1,316 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "TestDKTaskScheduler.h"
+#include <stdatomic.h>
+
+#define TASK_COUNT 200000
+#define SUBMITTER_COUNT 8
+#define WORKER_COUNT 4
+
+// sums lo..hi-1 by splitting the range in two, running one half as a task and waiting for it, so that workers wait inside tasks
+
+static NSUInteger DKTestNestedSum(DKTaskScheduler* scheduler, NSUInteger lo, NSUInteger hi)
+{
+	if (hi - lo <= 1000) {
+		NSUInteger i, sum = 0;
+
+		for (i = lo; i < hi; ++i)
+			sum += i;
+
+		return sum;
+	}
+
+	NSUInteger mid = lo + (hi - lo) / 2;
+	__block NSUInteger left = 0;
+	DKTaskGroup* group = [[DKTaskGroup alloc] init];
+
+	[scheduler addTask:^{
+		left = DKTestNestedSum(scheduler, lo, mid);
+	}
+			  priority:kDKTaskPriorityInteractive
+				 group:group];
+
+	NSUInteger right = DKTestNestedSum(scheduler, mid, hi);
+
+	[scheduler waitForGroup:group];
+	[group release];
+
+	return left + right;
+}
+
+@interface TestDKTaskScheduler ()
+
+// adds a task that stops the scheduler's only worker until the returned semaphore is signalled
+
+- (dispatch_semaphore_t)blockWorkerOfScheduler:(DKTaskScheduler*)scheduler;
+
+@end
+
+#pragma mark -
+
+@implementation TestDKTaskScheduler
+
+- (dispatch_semaphore_t)blockWorkerOfScheduler:(DKTaskScheduler*)scheduler
+{
+	dispatch_semaphore_t started = dispatch_semaphore_create(0);
+	dispatch_semaphore_t gate = dispatch_semaphore_create(0);
+
+	[scheduler addTask:^{
+		dispatch_semaphore_signal(started);
+		dispatch_semaphore_wait(gate, DISPATCH_TIME_FOREVER);
+	}];
+
+	dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+	dispatch_release(started);
+
+	return [(id)gate autorelease];
+}
+
+- (void)testEveryTaskRunsOnceUnderContention
+{
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:WORKER_COUNT];
+	DKTaskGroup* group = [[DKTaskGroup alloc] init];
+	atomic_int* runs = calloc(TASK_COUNT, sizeof(atomic_int));
+
+	// several threads add tasks at once, and half of the tasks add another from a worker, which other workers may steal
+
+	dispatch_apply(SUBMITTER_COUNT, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t submitter) {
+		NSUInteger i;
+
+		for (i = submitter; i < TASK_COUNT / 2; i += SUBMITTER_COUNT) {
+			[scheduler addTask:^{
+				atomic_fetch_add(&runs[i], 1);
+
+				[scheduler addTask:^{
+					atomic_fetch_add(&runs[i + TASK_COUNT / 2], 1);
+				}
+						  priority:(i & 1) ? kDKTaskPriorityBackground : kDKTaskPriorityInteractive
+							 group:group];
+			}
+					  priority:(i & 2) ? kDKTaskPriorityBackground : kDKTaskPriorityInteractive
+						 group:group];
+		}
+	});
+
+	[group wait];
+
+	NSUInteger i, wrong = 0;
+
+	for (i = 0; i < TASK_COUNT; ++i) {
+		if (atomic_load(&runs[i]) != 1)
+			++wrong;
+	}
+
+	XCTAssertEqual(wrong, (NSUInteger)0, @"%lu tasks did not run exactly once", (unsigned long)wrong);
+	XCTAssertEqual([group pendingCount], (NSUInteger)0, @"group still has pending tasks after waiting");
+
+	free(runs);
+	[group release];
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+- (void)testNestedTasksCanWait
+{
+	// fewer workers than levels of nesting, so waiting tasks must help rather than block
+
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:2];
+	NSUInteger n = 1000000;
+
+	XCTAssertEqual(DKTestNestedSum(scheduler, 0, n), n * (n - 1) / 2, @"nested sum was wrong");
+
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+- (void)testParallelForCoversRangeOnce
+{
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:WORKER_COUNT];
+	NSRange range = NSMakeRange(7, 100003);
+	NSUInteger grains[] = { 0, 1, 37, 1000000 };
+	NSUInteger g, i;
+	atomic_int* visits = calloc(NSMaxRange(range) + 7, sizeof(atomic_int));
+
+	for (g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g) {
+		for (i = 0; i < NSMaxRange(range) + 7; ++i)
+			atomic_store(&visits[i], 0);
+
+		[scheduler parallelForRange:range
+						  grainSize:grains[g]
+						   priority:kDKTaskPriorityInteractive
+							  group:nil
+							   body:^(NSRange subrange) {
+								   NSUInteger j;
+
+								   for (j = subrange.location; j < NSMaxRange(subrange); ++j)
+									   atomic_fetch_add(&visits[j], 1);
+							   }];
+
+		NSUInteger wrong = 0;
+
+		for (i = 0; i < NSMaxRange(range) + 7; ++i) {
+			if (atomic_load(&visits[i]) != (NSLocationInRange(i, range) ? 1 : 0))
+				++wrong;
+		}
+
+		XCTAssertEqual(wrong, (NSUInteger)0, @"grain %lu: %lu indexes not visited exactly once", (unsigned long)grains[g], (unsigned long)wrong);
+	}
+
+	free(visits);
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+- (void)testCancelSkipsTasksNotStarted
+{
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:1];
+	DKTaskGroup* group = [[DKTaskGroup alloc] init];
+	dispatch_semaphore_t gate = [self blockWorkerOfScheduler:scheduler];
+	atomic_int runs;
+	atomic_int* runCount = &runs;
+	NSUInteger i;
+
+	atomic_init(runCount, 0);
+
+	for (i = 0; i < 1000; ++i) {
+		[scheduler addTask:^{
+			atomic_fetch_add(runCount, 1);
+		}
+				  priority:kDKTaskPriorityBackground
+					 group:group];
+	}
+
+	XCTAssertEqual([group pendingCount], (NSUInteger)1000, @"group did not count its tasks");
+
+	[group cancel];
+	dispatch_semaphore_signal(gate);
+	[group wait];
+
+	XCTAssertTrue([group isCancelled], @"group was not marked as cancelled");
+	XCTAssertEqual(atomic_load(runCount), 0, @"cancelled tasks were run");
+	XCTAssertEqual([group pendingCount], (NSUInteger)0, @"cancelled tasks were not finished");
+
+	// a cancelled parallel loop stops handing out parts
+
+	DKTaskGroup* loopGroup = [[DKTaskGroup alloc] init];
+	atomic_int partCount;
+	atomic_int* parts = &partCount;
+
+	atomic_init(parts, 0);
+
+	[scheduler parallelForRange:NSMakeRange(0, 1000)
+					  grainSize:1
+					   priority:kDKTaskPriorityInteractive
+						  group:loopGroup
+						   body:^(NSRange subrange) {
+							   if (atomic_fetch_add(parts, 1) == 9)
+								   [loopGroup cancel];
+						   }];
+
+	XCTAssertLessThan(atomic_load(parts), 1000, @"cancelled loop ran every part");
+
+	[loopGroup release];
+	[group release];
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+- (void)testTaskAfterGroupRunsLast
+{
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:WORKER_COUNT];
+	DKTaskGroup* first = [[DKTaskGroup alloc] init];
+	DKTaskGroup* second = [[DKTaskGroup alloc] init];
+	atomic_int doneCount;
+	atomic_int* done = &doneCount;
+	__block int seen = -1;
+	NSUInteger i;
+
+	atomic_init(done, 0);
+
+	for (i = 0; i < 100; ++i) {
+		[scheduler addTask:^{
+			usleep(100);
+			atomic_fetch_add(done, 1);
+		}
+				  priority:kDKTaskPriorityBackground
+					 group:first];
+	}
+
+	[scheduler addTask:^{
+		seen = atomic_load(done);
+	}
+			  priority:kDKTaskPriorityInteractive
+			afterGroup:first
+				 group:second];
+
+	[second wait];
+
+	XCTAssertEqual(seen, 100, @"dependent task ran before its group finished");
+	XCTAssertEqual([first pendingCount], (NSUInteger)0, @"waiting for the dependent task did not wait for its group");
+
+	// a group with no tasks doesn't hold anything up
+
+	seen = -1;
+	[scheduler addTask:^{
+		seen = 0;
+	}
+			  priority:kDKTaskPriorityInteractive
+			afterGroup:first
+				 group:second];
+
+	[second wait];
+	XCTAssertEqual(seen, 0, @"task after an empty group did not run");
+
+	[first release];
+	[second release];
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+- (void)testInteractiveTasksRunFirst
+{
+	DKTaskScheduler* scheduler = [[DKTaskScheduler alloc] initWithWorkerCount:1];
+	dispatch_semaphore_t gate = [self blockWorkerOfScheduler:scheduler];
+	dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+	DKTaskPriority orderBuffer[100];
+	DKTaskPriority* order = orderBuffer;
+	atomic_int runCount;
+	atomic_int* count = &runCount;
+	NSUInteger i;
+
+	atomic_init(count, 0);
+
+	// the background tasks are queued first, but while the worker is busy, so it finds the interactive ones waiting too
+
+	for (i = 0; i < 100; ++i) {
+		DKTaskPriority priority = (i < 50) ? kDKTaskPriorityBackground : kDKTaskPriorityInteractive;
+
+		[scheduler addTask:^{
+			order[atomic_fetch_add(count, 1)] = priority;
+		}
+				  priority:priority
+					 group:nil];
+	}
+
+	[scheduler addTask:^{
+		dispatch_semaphore_signal(finished);
+	}];
+
+	dispatch_semaphore_signal(gate);
+	dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+	dispatch_release(finished);
+
+	XCTAssertEqual(atomic_load(count), 100, @"not all tasks ran");
+
+	for (i = 0; i < 100; ++i)
+		XCTAssertEqual(order[i], (i < 50) ? kDKTaskPriorityInteractive : kDKTaskPriorityBackground, @"task %lu ran in the wrong order", (unsigned long)i);
+
+	[scheduler invalidate];
+	[scheduler release];
+}
+
+@end
@@ -0,0 +1,76 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import <Foundation/Foundation.h>
+
+@class DKEvaluator, DKExpression, DKParser;
+
+// the instructions of a compiled script
+
+typedef NS_ENUM(uint8_t, DKScriptOpcode) {
+	kDKScriptPushConstant = 0, // push constant <operand>
+	kDKScriptPushSymbol, // push the value of symbol slot <operand>
+	kDKScriptMakePair, // pop a value and push it as a pair with the key in constant <operand>
+	kDKScriptBuildExpression, // pop <count> items into an expression of the type in constant <operand>, and push its evaluation
+	kDKScriptEvaluateConstant, // push the evaluation of the literal expression in constant <operand>
+	kDKScriptPushConstantCopy // push a copy of the literal expression or pair in constant <operand>
+};
+
+typedef struct {
+	DKScriptOpcode opcode;
+	uint32_t count;
+	NSUInteger operand;
+} DKScriptInstruction;
+
+/** @brief A parsed style script compiled to a flat list of instructions.
+
+ Evaluating a DKExpression tree walks it recursively, asking each item whether it is literal, and looks up every symbol through
+ \c valueForKeyPath:. A compiled script has made those decisions once. Literal values become constants, and each distinct symbol gets
+ a slot whose value the evaluator resolves once and then caches until its symbol table changes. Evaluation runs the instructions
+ against a stack, producing exactly what DKEvaluator's \c -evaluateExpression: would for the same tree.
+
+ Compiled scripts are immutable, so they can be shared between evaluators and threads. \c +compiledScriptForString:parser: keeps them in
+ a shared cache keyed by the script source, so a script that is evaluated again is neither parsed nor compiled again. Literal values
+ are copied from the parse tree when the script is compiled and shared between evaluations rather than freshly parsed each time; literal
+ expressions and pairs, which could be changed, are copied again for each evaluation that can see them.
+
+ An evaluator whose \c -keepsSimpleExpressions is NO is handed one expression for every node, emptied and filled again each time,
+ so evaluating the script builds no expressions at all.
+*/
+@interface DKCompiledScript : NSObject {
+	DKScriptInstruction* mInstructions;
+	NSUInteger mInstructionCount;
+	NSUInteger mMaxStackDepth;
+	NSMutableArray* mConstants; // literal values, expression types and pair keys
+	NSMutableArray* mSymbols; // the symbol in each slot
+}
+
+/** @brief Returns the compiled form of a script, parsing and compiling it only if it is not already in the shared cache.
+ @param source the script
+ @param parser the parser to use if the script must be parsed
+ @return the compiled script, or nil if the script did not parse
+ */
++ (DKCompiledScript*)compiledScriptForString:(NSString*)source parser:(DKParser*)parser;
+
+/** @brief Empties the shared cache of compiled scripts. */
++ (void)flushCache;
+
+/** @brief Compiles a parsed script.
+ @param root the root of the parse tree - normally a DKExpression
+ @return the compiled script
+ */
+- (id)initWithParseTree:(id)root;
+
+/** @brief Evaluates the script.
+ @param evaluator the evaluator, which supplies symbol values and evaluates each simple expression
+ @return the result, as DKEvaluator's \c -evaluateExpression: would return for the parse tree
+ */
+- (id)evaluateWithEvaluator:(DKEvaluator*)evaluator;
+
+- (NSUInteger)instructionCount;
+- (NSArray*)symbols;
+
+@end
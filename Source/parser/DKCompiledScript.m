@@ -0,0 +1,299 @@
+/**
+ @author Contributions from the community; see CONTRIBUTORS.md
+ @date 2005-2016
+ @copyright MPL2; see LICENSE.txt
+*/
+
+#import "DKCompiledScript.h"
+
+#import "DKEvaluator.h"
+#import "DKExpression.h"
+#import "DKParser.h"
+#import "DKSymbol.h"
+
+// the shared cache is limited by the total length of the sources it holds
+
+#define kDKCompiledScriptCacheLimit (8 * 1024 * 1024)
+
+#pragma mark Static Vars
+static NSCache* sCompiledScriptCache = nil;
+
+// the cache is made once, however many threads ask for it first
+
+static NSCache* DKCompiledScriptCache(void)
+{
+	static dispatch_once_t once;
+
+	dispatch_once(&once, ^{
+		sCompiledScriptCache = [[NSCache alloc] init];
+		[sCompiledScriptCache setTotalCostLimit:kDKCompiledScriptCacheLimit];
+	});
+
+	return sCompiledScriptCache;
+}
+
+@interface DKCompiledScript (Private)
+
+- (void)emit:(DKScriptOpcode)opcode operand:(NSUInteger)operand count:(NSUInteger)count;
+- (NSUInteger)indexOfConstant:(id)value;
+- (NSUInteger)slotForSymbol:(DKSymbol*)symbol;
+- (void)compileObject:(id)anObject depth:(NSUInteger)depth;
+- (void)compileExpression:(DKExpression*)expr depth:(NSUInteger)depth;
+
+@end
+
+#pragma mark -
+@implementation DKCompiledScript
+#pragma mark As a DKCompiledScript
++ (DKCompiledScript*)compiledScriptForString:(NSString*)source parser:(DKParser*)parser
+{
+	if (source == nil)
+		return nil;
+
+	// NSCache hashes the source, and compares it only with sources of the same hash
+
+	NSCache* cache = DKCompiledScriptCache();
+	DKCompiledScript* script = [cache objectForKey:source];
+
+	if (script == nil) {
+		id root = [parser parseString:source];
+
+		if (root == nil)
+			return nil;
+
+		script = [[[DKCompiledScript alloc] initWithParseTree:root] autorelease];
+
+		[cache setObject:script
+								 forKey:[[source copy] autorelease]
+								   cost:[source length]];
+	}
+
+	return script;
+}
+
++ (void)flushCache
+{
+	[DKCompiledScriptCache() removeAllObjects];
+}
+
+#pragma mark -
+- (id)initWithParseTree:(id)root
+{
+	self = [super init];
+	if (self != nil) {
+		mConstants = [[NSMutableArray alloc] init];
+		mSymbols = [[NSMutableArray alloc] init];
+
+		// the root is always evaluated as an expression, even if it is literal
+
+		if ([root isKindOfClass:[DKExpression class]])
+			[self compileExpression:root
+							  depth:0];
+		else
+			[self emit:kDKScriptEvaluateConstant
+				operand:[self indexOfConstant:root]
+				  count:0];
+
+		mMaxStackDepth = MAX(mMaxStackDepth, (NSUInteger)1);
+	}
+	return self;
+}
+
+- (id)evaluateWithEvaluator:(DKEvaluator*)evaluator
+{
+	NSMutableArray* stack = [[NSMutableArray alloc] initWithCapacity:mMaxStackDepth];
+	BOOL keeps = [evaluator keepsSimpleExpressions];
+	DKExpression* scratch = keeps ? nil : [[DKExpression alloc] init];
+	NSUInteger i;
+	id result;
+
+	for (i = 0; i < mInstructionCount; ++i) {
+		DKScriptInstruction* ins = &mInstructions[i];
+
+		switch (ins->opcode) {
+		case kDKScriptPushConstant:
+			[stack addObject:[mConstants objectAtIndex:ins->operand]];
+			break;
+
+		case kDKScriptPushConstantCopy: {
+			id copy = [[mConstants objectAtIndex:ins->operand] copy];
+			[stack addObject:copy];
+			[copy release];
+		} break;
+
+		case kDKScriptPushSymbol:
+			[stack addObject:[evaluator valueForSymbol:[mSymbols objectAtIndex:ins->operand]]];
+			break;
+
+		case kDKScriptMakePair: {
+			DKExpressionPair* pair = [[DKExpressionPair alloc] initWithKey:[mConstants objectAtIndex:ins->operand]
+																	 value:[stack lastObject]];
+			[stack replaceObjectAtIndex:[stack count] - 1
+							 withObject:pair];
+			[pair release];
+		} break;
+
+		case kDKScriptBuildExpression: {
+			// only one expression is ever being evaluated at a time, so an evaluator that doesn't keep them can be given the same one
+			// for every node
+
+			DKExpression* expr = keeps ? [[DKExpression alloc] init] : [scratch retain];
+			NSUInteger k, first = [stack count] - ins->count;
+
+			[expr removeAllObjects];
+			[expr setType:[mConstants objectAtIndex:ins->operand]];
+
+			for (k = first; k < first + ins->count; ++k)
+				[expr addObject:[stack objectAtIndex:k]];
+
+			[stack removeObjectsInRange:NSMakeRange(first, ins->count)];
+			[stack addObject:[evaluator evaluateSimpleExpression:expr]];
+			[expr release];
+		} break;
+
+		case kDKScriptEvaluateConstant: {
+			DKExpression* literal = [mConstants objectAtIndex:ins->operand];
+
+			if (keeps)
+				literal = [[literal copy] autorelease];
+
+			[stack addObject:[evaluator evaluateSimpleExpression:literal]];
+		} break;
+		}
+	}
+
+	result = [[stack lastObject] retain];
+	[scratch release];
+	[stack release];
+
+	return [result autorelease];
+}
+
+#pragma mark -
+- (NSUInteger)instructionCount
+{
+	return mInstructionCount;
+}
+
+- (NSArray*)symbols
+{
+	return mSymbols;
+}
+
+#pragma mark -
+#pragma mark As an NSObject
+- (void)dealloc
+{
+	free(mInstructions);
+	[mConstants release];
+	[mSymbols release];
+
+	[super dealloc];
+}
+
+- (NSString*)description
+{
+	return [NSString stringWithFormat:@"<%@ %p: %lu instructions, %lu symbols>", NSStringFromClass([self class]), self, (unsigned long)mInstructionCount, (unsigned long)[mSymbols count]];
+}
+
+@end
+
+#pragma mark -
+@implementation DKCompiledScript (Private)
+
+- (void)emit:(DKScriptOpcode)opcode operand:(NSUInteger)operand count:(NSUInteger)count
+{
+	if ((mInstructionCount & 63) == 0)
+		mInstructions = realloc(mInstructions, sizeof(DKScriptInstruction) * (mInstructionCount + 64));
+
+	mInstructions[mInstructionCount].opcode = opcode;
+	mInstructions[mInstructionCount].operand = operand;
+	mInstructions[mInstructionCount].count = (uint32_t)count;
+	mInstructionCount++;
+}
+
+- (NSUInteger)indexOfConstant:(id)value
+{
+	// constants are copied so that changes to the parse tree don't reach the script, and mutable strings and arrays become immutable.
+	// They are not merged - equal literals may still be distinct objects, and evaluation must see distinct objects as the tree does
+
+	id constant = [value conformsToProtocol:@protocol(NSCopying)] ? [value copy] : [value retain];
+
+	[mConstants addObject:constant];
+	[constant release];
+	return [mConstants count] - 1;
+}
+
+- (NSUInteger)slotForSymbol:(DKSymbol*)symbol
+{
+	// symbols are unique, so identity is enough
+
+	NSUInteger slot = [mSymbols indexOfObjectIdenticalTo:symbol];
+
+	if (slot == NSNotFound) {
+		[mSymbols addObject:symbol];
+		slot = [mSymbols count] - 1;
+	}
+
+	return slot;
+}
+
+- (void)compileObject:(id)anObject depth:(NSUInteger)depth
+{
+	// mirrors DKEvaluator's -evaluateObject:. Literal expressions and pairs become part of the result, so each evaluation gets its own
+	// copy to change as it likes
+
+	BOOL isContainer = [anObject isKindOfClass:[DKExpression class]] || [anObject isKindOfClass:[DKExpressionPair class]];
+
+	mMaxStackDepth = MAX(mMaxStackDepth, depth + 1);
+
+	if ([anObject isLiteralValue])
+		[self emit:isContainer ? kDKScriptPushConstantCopy : kDKScriptPushConstant
+			operand:[self indexOfConstant:anObject]
+			  count:0];
+	else if ([anObject isKindOfClass:[DKSymbol class]])
+		[self emit:kDKScriptPushSymbol
+			operand:[self slotForSymbol:anObject]
+			  count:0];
+	else if ([anObject isKindOfClass:[DKExpression class]])
+		[self compileExpression:anObject
+						  depth:depth];
+	else if ([anObject isKindOfClass:[DKExpressionPair class]]) {
+		[self compileObject:[(DKExpressionPair*)anObject value]
+					  depth:depth];
+		[self emit:kDKScriptMakePair
+			operand:[self indexOfConstant:[(DKExpressionPair*)anObject key]]
+			  count:0];
+	} else
+		[self emit:kDKScriptPushConstant
+			operand:[self indexOfConstant:anObject]
+			  count:0];
+}
+
+- (void)compileExpression:(DKExpression*)expr depth:(NSUInteger)depth
+{
+	// mirrors DKEvaluator's -evaluateExpression:
+
+	mMaxStackDepth = MAX(mMaxStackDepth, depth + 1);
+
+	if ([expr isLiteralValue]) {
+		[self emit:kDKScriptEvaluateConstant
+			operand:[self indexOfConstant:expr]
+			  count:0];
+		return;
+	}
+
+	NSEnumerator* curs = [expr objectEnumerator];
+	NSUInteger count = 0;
+	id item;
+
+	while ((item = [curs nextObject]))
+		[self compileObject:item
+					  depth:depth + count++];
+
+	[self emit:kDKScriptBuildExpression
+		operand:[self indexOfConstant:[expr type] ? [expr type] : @"expr"]
+		  count:count];
+}
+
+@end
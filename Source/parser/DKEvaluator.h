@@ -7,17 +7,32 @@
 
 #import <Cocoa/Cocoa.h>
 
-@class DKExpression;
+@class DKCompiledScript, DKExpression, DKSymbol;
 
 @interface DKEvaluator : NSObject {
 	NSMutableDictionary* mSymbolTable;
+	id* mResolvedSymbols; // resolved value of each symbol, by symbol index, or nil
+	NSUInteger mResolvedSymbolCapacity;
 }
 
 - (void)addValue:(id)value forSymbol:(NSString*)symbol;
 
 - (id)evaluateSymbol:(NSString*)symbol;
+
+// as -evaluateSymbol:, but resolved once and remembered until the symbol table changes. A key path's value can change without the table
+// changing, so key paths are resolved afresh every time
+
+- (id)valueForSymbol:(DKSymbol*)symbol;
+- (void)flushResolvedSymbols;
+
+- (id)evaluateCompiledScript:(DKCompiledScript*)script;
 - (id)evaluateObject:(id)anObject;
 - (id)evaluateExpression:(DKExpression*)expr;
 - (id)evaluateSimpleExpression:(DKExpression*)expr;
 
+// YES if -evaluateSimpleExpression: can return or keep the expression it is given, or change it. If not, compiled scripts hand it the same
+// expression over and over, filled with the values of each node in turn
+
+- (BOOL)keepsSimpleExpressions;
+
 @end
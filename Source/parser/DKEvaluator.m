@@ -7,6 +7,7 @@
 
 #import "DKEvaluator.h"
 
+#import "DKCompiledScript.h"
 #import "DKExpression.h"
 #import "DKSymbol.h"
 
@@ -16,6 +17,7 @@
 {
 	[mSymbolTable setValue:value
 					forKey:symbol];
+	[self flushResolvedSymbols];
 }
 
 #pragma mark -
@@ -25,13 +27,49 @@
 	return (sym ? sym : symbol);
 }
 
+- (id)valueForSymbol:(DKSymbol*)symbol
+{
+	if ([symbol isKeyPath])
+		return [self evaluateSymbol:symbol];
+
+	NSUInteger ndx = [symbol index];
+
+	if (ndx >= mResolvedSymbolCapacity) {
+		NSUInteger capacity = MAX(ndx + 1, mResolvedSymbolCapacity * 2);
+
+		mResolvedSymbols = realloc(mResolvedSymbols, sizeof(id) * capacity);
+		memset(mResolvedSymbols + mResolvedSymbolCapacity, 0, sizeof(id) * (capacity - mResolvedSymbolCapacity));
+		mResolvedSymbolCapacity = capacity;
+	}
+
+	if (mResolvedSymbols[ndx] == nil)
+		mResolvedSymbols[ndx] = [[self evaluateSymbol:symbol] retain];
+
+	return mResolvedSymbols[ndx];
+}
+
+- (void)flushResolvedSymbols
+{
+	NSUInteger i;
+
+	for (i = 0; i < mResolvedSymbolCapacity; ++i) {
+		[mResolvedSymbols[i] release];
+		mResolvedSymbols[i] = nil;
+	}
+}
+
+- (id)evaluateCompiledScript:(DKCompiledScript*)script
+{
+	return [script evaluateWithEvaluator:self];
+}
+
 - (id)evaluateObject:(id)anObject
 {
 	if ([anObject isLiteralValue])
 		return anObject;
 
 	if ([anObject isKindOfClass:[DKSymbol class]])
-		return [self evaluateSymbol:anObject];
+		return [self valueForSymbol:anObject];
 
 	if ([anObject isKindOfClass:[DKExpression class]])
 		return [self evaluateExpression:anObject];
@@ -71,10 +109,17 @@
 	return expr;
 }
 
+- (BOOL)keepsSimpleExpressions
+{
+	return YES;
+}
+
 #pragma mark -
 #pragma mark As an NSObject
 - (void)dealloc
 {
+	[self flushResolvedSymbols];
+	free(mResolvedSymbols);
 	[mSymbolTable release];
 
 	[super dealloc];
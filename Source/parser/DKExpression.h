@@ -7,7 +7,7 @@
 
 #import <Foundation/Foundation.h>
 
-@interface DKExpression : NSObject {
+@interface DKExpression : NSObject <NSCopying> {
 	NSString* mType;
 	NSMutableArray* mValues;
 }
@@ -32,6 +32,7 @@
 
 - (void)addObject:(id)aValue;
 - (void)addObject:(id)aValue forKey:(NSString*)key;
+- (void)removeAllObjects;
 
 - (void)applyKeyedValuesTo:(id)anObject;
 
@@ -43,7 +44,7 @@
 
 @end
 
-@interface DKExpressionPair : NSObject {
+@interface DKExpressionPair : NSObject <NSCopying> {
 	NSString* key;
 	id value;
 }
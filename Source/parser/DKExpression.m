@@ -7,6 +7,16 @@
 
 #import "DKExpression.h"
 
+// copies of expressions copy the expressions and pairs within them, so that changing a copy at any depth leaves the original alone
+
+static id DKExpressionItemCopy(id item, NSZone* zone)
+{
+	if ([item isKindOfClass:[DKExpression class]] || [item isKindOfClass:[DKExpressionPair class]])
+		return [item copyWithZone:zone];
+
+	return [item retain];
+}
+
 @implementation DKExpression
 #pragma mark As a DKExpression
 - (void)setType:(NSString*)aType
@@ -118,6 +128,11 @@
 	[pair release];
 }
 
+- (void)removeAllObjects
+{
+	[mValues removeAllObjects];
+}
+
 #pragma mark -
 - (void)applyKeyedValuesTo:(id)anObject
 {
@@ -207,6 +222,24 @@
 	return desc;
 }
 
+- (id)copyWithZone:(NSZone*)zone
+{
+	DKExpression* copy = [[[self class] allocWithZone:zone] init];
+	NSEnumerator* curs = [mValues objectEnumerator];
+	id item;
+
+	[copy setType:mType];
+
+	while ((item = [curs nextObject])) {
+		id itemCopy = DKExpressionItemCopy(item, zone);
+
+		[copy addObject:itemCopy];
+		[itemCopy release];
+	}
+
+	return copy;
+}
+
 - (id)init
 {
 	self = [super init];
@@ -273,6 +306,17 @@
 	return [NSString stringWithFormat:@"%@: %@", key, value];
 }
 
+#pragma mark -
+#pragma mark As part of NSCopying Protocol
+- (id)copyWithZone:(NSZone*)zone
+{
+	id valueCopy = DKExpressionItemCopy(value, zone);
+	DKExpressionPair* copy = [[[self class] allocWithZone:zone] initWithKey:key
+																	 value:valueCopy];
+	[valueCopy release];
+	return copy;
+}
+
 @end
 
 #pragma mark -
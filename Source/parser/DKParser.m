@@ -54,8 +54,13 @@ NSInteger dk_lex(id* val, YYLTYPE* yloc, void* reader)
 
 - parseString:(NSString*)inString;
 {
-	NSData* input = [inString dataUsingEncoding:NSASCIIStringEncoding
-						   allowLossyConversion:YES];
+	// the scanner stops at a nul, which NSData doesn't supply
+
+	NSMutableData* input = [[[inString dataUsingEncoding:NSASCIIStringEncoding
+									allowLossyConversion:YES] mutableCopy] autorelease];
+	const char* term = "\0";
+	[input appendBytes:term
+				length:1];
 	return [self parseData:input];
 }
 
@@ -10,6 +10,7 @@
 @interface DKSymbol : NSString <NSCopying> {
 	NSString* mString;
 	NSInteger mIndex;
+	BOOL mIsKeyPath;
 }
 
 + (NSMutableDictionary*)symbolMap;
@@ -21,4 +22,8 @@
 - (NSInteger)index;
 - (NSString*)string;
 
+// YES if the symbol names a key path, such as "colour.red", whose value can change without the symbol table changing
+
+- (BOOL)isKeyPath;
+
 @end
@@ -53,6 +53,7 @@ static NSInteger sSymCounter = 0;
 	if (self != nil) {
 		mString = [str retain];
 		mIndex = ndx;
+		mIsKeyPath = [str rangeOfString:@"."].location != NSNotFound;
 
 		if (mString == nil) {
 			[self autorelease];
@@ -67,6 +68,11 @@ static NSInteger sSymCounter = 0;
 	return mIndex;
 }
 
+- (BOOL)isKeyPath
+{
+	return mIsKeyPath;
+}
+
 #pragma mark -
 #pragma mark As an NSString
 - (unichar)characterAtIndex:(NSUInteger)ndx